@@ -41,6 +41,7 @@
 #include "TAppDecCfg.h"
 #include "TAppCommon/program_options_lite.h"
 #include "TLibCommon/TComChromaFormat.h"
+#include "TLibVideoIO/TVideoIOYuv.h"
 #ifdef WIN32
 #define strdup _strdup
 #endif
@@ -65,6 +66,9 @@ Bool TAppDecCfg::parseCfg( Int argc, Char* argv[] )
   string cfg_ReconFile;
   string cfg_TargetDecLayerIdSetFile;
   string outputColourSpaceConvert;
+#if PIP
+  string cfg_PIPStats;
+#endif
   Int warnUnknowParameter = 0;
 
   po::Options opts;
@@ -73,7 +77,7 @@ Bool TAppDecCfg::parseCfg( Int argc, Char* argv[] )
 
   ("help",                      do_help,                               false,      "this help text")
   ("BitstreamFile,b",           cfg_BitstreamFile,                     string(""), "bitstream input file name")
-  ("ReconFile,o",               cfg_ReconFile,                         string(""), "reconstructed YUV output file name\n"
+  ("ReconFile,o",               cfg_ReconFile,                         string(""), "reconstructed YUV output file name, \"-\" for stdout, Y4M if it ends in .y4m\n"
                                                                                    "YUV writing is skipped if omitted")
   ("WarnUnknowParameter,w",     warnUnknowParameter,                                  0, "warn for unknown configuration parameters instead of failing")
   ("SkipFrames,s",              m_iSkipFrame,                          0,          "number of frames to skip before random access")
@@ -92,6 +96,12 @@ Bool TAppDecCfg::parseCfg( Int argc, Char* argv[] )
 #endif
   ("OutputDecodedSEIMessagesFilename",  m_outputDecodedSEIMessagesFilename,    string(""), "When non empty, output decoded SEI messages to the indicated file. If file is '-', then output to stdout\n")
   ("ClipOutputVideoToRec709Range",      m_bClipOutputVideoToRec709Range,  false, "If true then clip output video to the Rec. 709 Range on saving")
+  ("OutputQueue",                       m_outputQueue,                    2u,    "Number of decoded pictures queued to a writer thread (0: write on the decoding thread)")
+#if PIP
+  ("PIPStats,pip-stats",                cfg_PIPStats,                     string("none"), "Report of the PIP bin counters at the end of decoding: none, text or json")
+  ("PIPCodebookDir",                    m_PIPCodebookDir,                 string("../../../CB/"), "Directory of the PIP text codebooks")
+  ("PIPCodebookFile",                   m_PIPCodebookFile,                string(""), "Binary PIP codebook container (pipcbconv), mapped instead of the text files")
+#endif
   ;
 
   po::setDefaults(opts);
@@ -124,10 +134,22 @@ Bool TAppDecCfg::parseCfg( Int argc, Char* argv[] )
     fprintf(stderr, "Bad output colour space conversion string\n");
     return false;
   }
+#if PIP
+  if (!TComPIPStats::parseFormat(cfg_PIPStats, m_PIPStatsFormat))
+  {
+    fprintf(stderr, "Bad PIP statistics format `%s' (none, text or json)\n", cfg_PIPStats.c_str());
+    return false;
+  }
+#endif
 
   /* convert std::string to c string for compatability */
   m_pchBitstreamFile = cfg_BitstreamFile.empty() ? NULL : strdup(cfg_BitstreamFile.c_str());
   m_pchReconFile = cfg_ReconFile.empty() ? NULL : strdup(cfg_ReconFile.c_str());
+  if (cfg_ReconFile == "-")
+  {
+    // the messages go to stderr from here on
+    TVideoIOYuv::takeStdout();
+  }
 
   if (!m_pchBitstreamFile)
   {
@@ -43,6 +43,9 @@
 #endif // _MSC_VER > 1000
 
 #include "TLibCommon/CommonDef.h"
+#if PIP
+#include "TLibCommon/TComPIPContext.h"
+#endif
 #include <vector>
 
 //! \ingroup TAppDecoder
@@ -72,6 +75,12 @@ protected:
 #endif
   std::string   m_outputDecodedSEIMessagesFilename;   ///< filename to output decoded SEI messages to. If '-', then use stdout. If empty, do not output details.
   Bool          m_bClipOutputVideoToRec709Range;      ///< If true, clip the output video to the Rec 709 range on saving.
+  UInt          m_outputQueue;                        ///< decoded pictures queued to the writer thread, 0: written at once
+#if PIP
+  PIPStatsFormat m_PIPStatsFormat;                    ///< report of the PIP bin counters at the end of decoding
+  std::string   m_PIPCodebookDir;                     ///< directory of the PIP text codebooks
+  std::string   m_PIPCodebookFile;                    ///< binary PIP codebook container, mapped instead of the text files
+#endif
 
 public:
   TAppDecCfg()
@@ -83,8 +92,12 @@ public:
   , m_decodedPictureHashSEIEnabled(0)
   , m_decodedNoDisplaySEIEnabled(false)
   , m_respectDefDispWindow(0)
+  , m_outputQueue(2)
 #if O0043_BEST_EFFORT_DECODING
   , m_forceDecodeBitDepth(0)
+#endif
+#if PIP
+  , m_PIPStatsFormat(PIP_STATS_NONE)
 #endif
   {
     for (UInt channelTypeIndex = 0; channelTypeIndex < MAX_NUM_CHANNEL_TYPE; channelTypeIndex++)
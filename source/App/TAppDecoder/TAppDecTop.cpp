@@ -46,16 +46,6 @@
 #include "TLibDecoder/NALread.h"
 #if RExt__DECODER_DEBUG_BIT_STATISTICS
 #include "TLibCommon/TComCodingStatistics.h"
-#endif
-
-#if PIP
-Int*** Codebooks;
-Int*** nextCodebooks;
-Int**  nextCodebooksCnt;
-Char* InCBDir = "../../../CB/CB";
-
-
-
 #endif
 
 //! \ingroup TAppDecoder
@@ -67,6 +57,10 @@ Char* InCBDir = "../../../CB/CB";
 
 TAppDecTop::TAppDecTop()
 : m_iPOCLastDisplay(-MAX_INT)
+#if PIP
+, m_PIPSpQ(7)
+, m_PIPQP(22)
+#endif
 {
 }
 
@@ -106,15 +100,19 @@ Void TAppDecTop::decode()
   Int                 poc;
   TComList<TComPic*>* pcListPic = NULL;
 
-  ifstream bitstreamFile(m_pchBitstreamFile, ifstream::in | ifstream::binary);
-  if (!bitstreamFile)
+  // the bitstream is mapped; a file that cannot be mapped is read into memory
+  InputByteBuffer bytestream;
+  if (!bytestream.open(m_pchBitstreamFile))
   {
-    fprintf(stderr, "\nfailed to open bitstream file `%s' for reading\n", m_pchBitstreamFile);
-    exit(EXIT_FAILURE);
+    ifstream bitstreamFile(m_pchBitstreamFile, ifstream::in | ifstream::binary);
+    if (!bitstreamFile)
+    {
+      fprintf(stderr, "\nfailed to open bitstream file `%s' for reading\n", m_pchBitstreamFile);
+      exit(EXIT_FAILURE);
+    }
+    bytestream.read(bitstreamFile);
   }
 
-  InputByteStream bytestream(bitstreamFile);
-
   if (!m_outputDecodedSEIMessagesFilename.empty() && m_outputDecodedSEIMessagesFilename!="-")
   {
     m_seiMessageFileStream.open(m_outputDecodedSEIMessagesFilename.c_str(), std::ios::out);
@@ -136,76 +134,23 @@ Void TAppDecTop::decode()
 
   // PIP
 #if PIP
+  TComPIPContext& rcPIPContext = m_cTDecTop.getPIPContext();
+  rcPIPContext.setSpQ(m_PIPSpQ);
+  rcPIPContext.setSpQOffsets(m_PIPQP);
 
-
-  // read the codebooks
-  UInt base = log2((UInt)CUMAX) - 1, w, h;
-  UInt codebookCnt = base * base;
-  Codebooks = new Int**[codebookCnt];
-  nextCodebooks = new Int**[codebookCnt];
-  nextCodebooksCnt = new Int*[codebookCnt];
-
-  Char InAddr[256], buf[20];
-  for (UInt i = 0; i < base; i++)
-	  for (UInt j = 0; j < base; j++)
-	  {
-		  h = 1 << (i + 2);
-		  w = 1 << (j + 2);
-		  Codebooks[base*i + j] = new Int*[h*w*CBf];
-		  nextCodebooks[base*i + j] = new Int*[h*w*CBf];
-		  nextCodebooksCnt[base*i + j] = new Int[h*w*CBf];
-		  for (UInt CBi = 0; CBi < h*w*CBf; CBi++)
-		  {
-			  Codebooks[base*i + j][CBi] = new Int[w*h];
-			  nextCodebooks[base*i + j][CBi] = new Int[w*h];
-		  }
-		  // Read the codebook from the text file with address InCBDir/_CB<w>x<h>_CBf<CBf>.txt
-		  int QP = 22;
-
-
-		  strcpy(InAddr, InCBDir);
-		  strcat(InAddr, "0iTQ/0_Q");
-		  if (false)
-			  strcat(InAddr, itoa(QP, buf, 10));
-		  else
-			  strcat(InAddr, "27");
-		  strcat(InAddr, "_CBf"); strcat(InAddr, itoa(CBf, buf, 10)); strcat(InAddr, "_"); strcat(InAddr, itoa(h, buf, 10)); strcat(InAddr, "x"); strcat(InAddr, itoa(w, buf, 10)); strcat(InAddr, ".txt");
-		  ifstream inCB(InAddr, ios::in);
-		  if (inCB.is_open())
-		  {
-			  string line;
-			  string delimiter = ",", token;
-			  int vCnt = 0;
-			  while (getline(inCB, line))
-			  {
-				  int pCnt = 0;
-				  int p;
-				  while (pCnt < w*h)
-				  {
-					  token = line.substr(0, line.find(delimiter));
-					  int l = token.length();
-					  line.erase(0, line.find(delimiter) + 1);
-					  p = atoi(token.c_str());
-					  Codebooks[base*i + j][vCnt][pCnt] = p;
-					  nextCodebooks[base*i + j][vCnt][pCnt] = 0;
-					  pCnt++;
-				  }
-				  nextCodebooksCnt[base*i + j][vCnt] = 0;
-				  vCnt++;
-			  }
-			  // cout << endl << "Read: Successfully read the codebook at: " << InAddr << endl;
-			  inCB.close();
-		  }
-		  else
-		  {
-			  // cout << "Error reading inCB file: " << InAddr << endl;
-			  // assert(false);
-		  }
-	  }
+  // read the codebooks (the ones trained at QP 27 serve all the QPs)
+  rcPIPContext.setCodebookDir(m_PIPCodebookDir);
+  if (!m_PIPCodebookFile.empty() && !rcPIPContext.openCodebookFile(m_PIPCodebookFile))
+  {
+    fprintf(stderr, "\nUnable to map the PIP codebook file `%s'\n", m_PIPCodebookFile.c_str());
+    exit(EXIT_FAILURE);
+  }
+  rcPIPContext.loadCodebooks(27);
 #endif
   
 
-  while (!!bitstreamFile)
+  Bool bEof = bytestream.isEof();
+  while (!bEof)
   {
     /* location serves to work around a design fault in the decoder, whereby
      * the process of reading a new slice that is the first slice of a new frame
@@ -213,18 +158,18 @@ Void TAppDecTop::decode()
      * nal unit. */
 #if RExt__DECODER_DEBUG_BIT_STATISTICS
     TComCodingStatistics::TComCodingStatisticsData backupStats(TComCodingStatistics::GetStatistics());
-    streampos location = bitstreamFile.tellg() - streampos(bytestream.GetNumBufferedBytes());
-#else
-    streampos location = bitstreamFile.tellg();
 #endif
+    const size_t location = bytestream.getPosition();
     AnnexBStats stats = AnnexBStats();
 
     InputNALUnit nalu;
-    byteStreamNALUnit(bytestream, nalu.getBitstream().getFifo(), stats);
+    const uint8_t* pNalUnit = NULL;
+    UInt numNalUnitBytes = 0;
+    bEof = byteStreamNALUnit(bytestream, pNalUnit, numNalUnitBytes, stats);
 
     // call actual decoding function
     Bool bNewPicture = false;
-    if (nalu.getBitstream().getFifo().empty())
+    if (numNalUnitBytes == 0)
     {
       /* this can happen if the following occur:
        *  - empty input file
@@ -235,7 +180,7 @@ Void TAppDecTop::decode()
     }
     else
     {
-      read(nalu);
+      read(nalu, pNalUnit, numNalUnitBytes);
       if( (m_iMaxTemporalLayer >= 0 && nalu.m_temporalId > m_iMaxTemporalLayer) || !isNaluWithinTargetDecLayerIdSet(&nalu)  )
       {
         bNewPicture = false;
@@ -249,27 +194,20 @@ Void TAppDecTop::decode()
 #endif
         if (bNewPicture)
         {
-          bitstreamFile.clear();
-          /* location points to the current nalunit payload[1] due to the
-           * need for the annexB parser to read three extra bytes.
-           * [1] except for the first NAL unit in the file
-           *     (but bNewPicture doesn't happen then) */
+          // location is the first byte after the previous nal unit
+          bytestream.setPosition(location);
+          bEof = false;
 #if RExt__DECODER_DEBUG_BIT_STATISTICS
-          bitstreamFile.seekg(location);
-          bytestream.reset();
           TComCodingStatistics::SetStatistics(backupStats);
-#else
-          bitstreamFile.seekg(location-streamoff(3));
-          bytestream.reset();
 #endif
         }
       }
     }
 
-    if ( (bNewPicture || !bitstreamFile || nalu.m_nalUnitType == NAL_UNIT_EOS) &&
+    if ( (bNewPicture || bEof || nalu.m_nalUnitType == NAL_UNIT_EOS) &&
         !m_cTDecTop.getFirstSliceInSequence () )
     {
-      if (!loopFiltered || bitstreamFile)
+      if (!loopFiltered || !bEof)
       {
         m_cTDecTop.executeLoopFilters(poc, pcListPic);
       }
@@ -279,7 +217,7 @@ Void TAppDecTop::decode()
         m_cTDecTop.setFirstSliceInSequence(true);
       }
     }
-    else if ( (bNewPicture || !bitstreamFile || nalu.m_nalUnitType == NAL_UNIT_EOS ) &&
+    else if ( (bNewPicture || bEof || nalu.m_nalUnitType == NAL_UNIT_EOS ) &&
               m_cTDecTop.getFirstSliceInSequence () ) 
     {
       m_cTDecTop.setFirstSliceInPicture (true);
@@ -298,7 +236,14 @@ Void TAppDecTop::decode()
           }
         }
 
+        const TComSPS &activeSPS = pcListPic->front()->getPicSym()->getSPS();
+        if ( activeSPS.getVuiParametersPresentFlag() && activeSPS.getVuiParameters()->getTimingInfo()->getTimingInfoPresentFlag() )
+        {
+          const TimingInfo *timingInfo = activeSPS.getVuiParameters()->getTimingInfo();
+          m_cTVideoIOYuvReconFile.setY4MFrameRate( timingInfo->getTimeScale(), timingInfo->getNumUnitsInTick() );
+        }
         m_cTVideoIOYuvReconFile.open( m_pchReconFile, true, m_outputBitDepth, m_outputBitDepth, bitDepths.recon ); // write mode
+        m_cOutputWriter.start( m_outputQueue );
         openedReconFile = true;
       }
       // write reconstruction to file
@@ -334,11 +279,16 @@ Void TAppDecTop::decode()
   }
 
   xFlushOutput( pcListPic );
+  m_cOutputWriter.stop();
   // delete buffers
   m_cTDecTop.deletePicBuffer();
 
   // destroy internal classes
   xDestroyDecLib();
+
+#if PIP
+  m_cTDecTop.getPIPContext().getTotalStats().report(stdout, m_PIPStatsFormat, true);
+#endif
 }
 
 // ====================================================================================================================
@@ -477,12 +427,12 @@ Void TAppDecTop::xWriteOutput( TComList<TComPic*>* pcListPic, UInt tId )
 
           if (display)
           {
-            m_cTVideoIOYuvReconFile.write( pcPicTop->getPicYuvRec(), pcPicBottom->getPicYuvRec(),
-                                           m_outputColourSpaceConvert,
-                                           conf.getWindowLeftOffset() + defDisp.getWindowLeftOffset(),
-                                           conf.getWindowRightOffset() + defDisp.getWindowRightOffset(),
-                                           conf.getWindowTopOffset() + defDisp.getWindowTopOffset(),
-                                           conf.getWindowBottomOffset() + defDisp.getWindowBottomOffset(), NUM_CHROMA_FORMAT, isTff );
+            const TVideoIOYuvWriter::WriteParams cParams = { m_outputColourSpaceConvert,
+                                                             conf.getWindowLeftOffset() + defDisp.getWindowLeftOffset(),
+                                                             conf.getWindowRightOffset() + defDisp.getWindowRightOffset(),
+                                                             conf.getWindowTopOffset() + defDisp.getWindowTopOffset(),
+                                                             conf.getWindowBottomOffset() + defDisp.getWindowBottomOffset(), NUM_CHROMA_FORMAT, false };
+            m_cOutputWriter.write( &m_cTVideoIOYuvReconFile, pcPicTop->getPicYuvRec(), pcPicBottom->getPicYuvRec(), cParams, isTff );
           }
         }
 
@@ -532,13 +482,13 @@ Void TAppDecTop::xWriteOutput( TComList<TComPic*>* pcListPic, UInt tId )
           const Window &conf    = pcPic->getConformanceWindow();
           const Window  defDisp = m_respectDefDispWindow ? pcPic->getDefDisplayWindow() : Window();
 
-          m_cTVideoIOYuvReconFile.write( pcPic->getPicYuvRec(),
-                                         m_outputColourSpaceConvert,
-                                         conf.getWindowLeftOffset() + defDisp.getWindowLeftOffset(),
-                                         conf.getWindowRightOffset() + defDisp.getWindowRightOffset(),
-                                         conf.getWindowTopOffset() + defDisp.getWindowTopOffset(),
-                                         conf.getWindowBottomOffset() + defDisp.getWindowBottomOffset(),
-                                         NUM_CHROMA_FORMAT, m_bClipOutputVideoToRec709Range  );
+          const TVideoIOYuvWriter::WriteParams cParams = { m_outputColourSpaceConvert,
+                                                           conf.getWindowLeftOffset() + defDisp.getWindowLeftOffset(),
+                                                           conf.getWindowRightOffset() + defDisp.getWindowRightOffset(),
+                                                           conf.getWindowTopOffset() + defDisp.getWindowTopOffset(),
+                                                           conf.getWindowBottomOffset() + defDisp.getWindowBottomOffset(),
+                                                           NUM_CHROMA_FORMAT, m_bClipOutputVideoToRec709Range };
+          m_cOutputWriter.write( &m_cTVideoIOYuvReconFile, pcPic->getPicYuvRec(), cParams );
         }
 
         // update POC of display order
@@ -592,12 +542,12 @@ Void TAppDecTop::xFlushOutput( TComList<TComPic*>* pcListPic )
           const Window &conf = pcPicTop->getConformanceWindow();
           const Window  defDisp = m_respectDefDispWindow ? pcPicTop->getDefDisplayWindow() : Window();
           const Bool isTff = pcPicTop->isTopField();
-          m_cTVideoIOYuvReconFile.write( pcPicTop->getPicYuvRec(), pcPicBottom->getPicYuvRec(),
-                                         m_outputColourSpaceConvert,
-                                         conf.getWindowLeftOffset() + defDisp.getWindowLeftOffset(),
-                                         conf.getWindowRightOffset() + defDisp.getWindowRightOffset(),
-                                         conf.getWindowTopOffset() + defDisp.getWindowTopOffset(),
-                                         conf.getWindowBottomOffset() + defDisp.getWindowBottomOffset(), NUM_CHROMA_FORMAT, isTff );
+          const TVideoIOYuvWriter::WriteParams cParams = { m_outputColourSpaceConvert,
+                                                           conf.getWindowLeftOffset() + defDisp.getWindowLeftOffset(),
+                                                           conf.getWindowRightOffset() + defDisp.getWindowRightOffset(),
+                                                           conf.getWindowTopOffset() + defDisp.getWindowTopOffset(),
+                                                           conf.getWindowBottomOffset() + defDisp.getWindowBottomOffset(), NUM_CHROMA_FORMAT, false };
+          m_cOutputWriter.write( &m_cTVideoIOYuvReconFile, pcPicTop->getPicYuvRec(), pcPicBottom->getPicYuvRec(), cParams, isTff );
         }
 
         // update POC of display order
@@ -650,13 +600,13 @@ Void TAppDecTop::xFlushOutput( TComList<TComPic*>* pcListPic )
           const Window &conf    = pcPic->getConformanceWindow();
           const Window  defDisp = m_respectDefDispWindow ? pcPic->getDefDisplayWindow() : Window();
 
-          m_cTVideoIOYuvReconFile.write( pcPic->getPicYuvRec(),
-                                         m_outputColourSpaceConvert,
-                                         conf.getWindowLeftOffset() + defDisp.getWindowLeftOffset(),
-                                         conf.getWindowRightOffset() + defDisp.getWindowRightOffset(),
-                                         conf.getWindowTopOffset() + defDisp.getWindowTopOffset(),
-                                         conf.getWindowBottomOffset() + defDisp.getWindowBottomOffset(),
-                                         NUM_CHROMA_FORMAT, m_bClipOutputVideoToRec709Range );
+          const TVideoIOYuvWriter::WriteParams cParams = { m_outputColourSpaceConvert,
+                                                           conf.getWindowLeftOffset() + defDisp.getWindowLeftOffset(),
+                                                           conf.getWindowRightOffset() + defDisp.getWindowRightOffset(),
+                                                           conf.getWindowTopOffset() + defDisp.getWindowTopOffset(),
+                                                           conf.getWindowBottomOffset() + defDisp.getWindowBottomOffset(),
+                                                           NUM_CHROMA_FORMAT, m_bClipOutputVideoToRec709Range };
+          m_cOutputWriter.write( &m_cTVideoIOYuvReconFile, pcPic->getPicYuvRec(), cParams );
         }
 
         // update POC of display order
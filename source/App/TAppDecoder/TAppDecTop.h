@@ -43,6 +43,7 @@
 #endif // _MSC_VER > 1000
 
 #include "TLibVideoIO/TVideoIOYuv.h"
+#include "TLibVideoIO/TVideoIOYuvWriter.h"
 #include "TLibCommon/TComList.h"
 #include "TLibCommon/TComPicYuv.h"
 #include "TLibDecoder/TDecTop.h"
@@ -62,12 +63,17 @@ private:
   // class interface
   TDecTop                         m_cTDecTop;                     ///< decoder class
   TVideoIOYuv                     m_cTVideoIOYuvReconFile;        ///< reconstruction YUV class
+  TVideoIOYuvWriter               m_cOutputWriter;                ///< writer of the reconstruction
 #if VCEG_AZ07_BAC_ADAPT_WDOW || VCEG_AZ07_INIT_PREVFRAME
   TComStats*                      m_apcStats;                     
 #endif
   // for output control
   Int                             m_iPOCLastDisplay;              ///< last POC in display order
   std::ofstream                   m_seiMessageFileStream;         ///< Used for outputing SEI messages.
+#if PIP
+  Int                             m_PIPSpQ;                       ///< spatial quantization step of the PIP residual
+  Int                             m_PIPQP;                        ///< QP selecting the per block size offsets of the step
+#endif
 
 public:
   TAppDecTop();
@@ -77,6 +83,9 @@ public:
   Void  destroy           (); ///< destroy internal members
   Void  decode            (); ///< main decoding function
   UInt  getNumberOfChecksumErrorsDetected() const { return m_cTDecTop.getNumberOfChecksumErrorsDetected(); }
+#if PIP
+  Void  setPIPSpatialStep ( Int spQ, Int iQP ) { m_PIPSpQ = spQ; m_PIPQP = iQP; }
+#endif
 
 protected:
   Void  xCreateDecLib     (); ///< create internal classes
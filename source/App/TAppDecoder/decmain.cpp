@@ -44,30 +44,13 @@
 //! \{
 
 #if PIP
-int spQ = 7; // 7	16	26	44
 int SP_QOFFSET;
 //int SP_QOFFSET = 1;
 bool multipred = false;
 Bool LGB4x8 = true, LGB8x4 = true, LGB8x8 = true, LGB4x4 = true;
-TCoeff TMPSpR1[16] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
 Bool SpatialCodeCoeffNxN = false;
 Bool firstFrate = true;
 
-int m_cCUQtCbfSCModelPIP_counter[5]		= { 0, 0, 0, 0, 0 };
-int m_cCUPIPflag_counter[5]				= { 0, 0, 0, 0, 0 };
-int m_cCUR1SpGr_counter[16]				= { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
-int m_cCUR1SpSign_counter				= 0;
-
-int m_cCUQtCbfSCModelPIP_ones[5]		= { 0, 0, 0, 0, 0 };
-int m_cCUPIPflag_ones[5]				= { 0, 0, 0, 0, 0 };
-int m_cCUR1SpGr_ones[16]				= { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
-int m_cCUR1SpSign_ones					= 0;
-
-int offset4x4 = 0;
-int offset4x8 = 0;
-int offset8x4 = 0;
-int offset8x8 = 0;
-
 int m_iQP = 22;
 Bool depth10 = true;
 
@@ -170,59 +153,28 @@ int main(int argc, char* argv[])
 	FILE* fout = fopen("log.txt", "w");
 	fclose(fout);
 
+	int spQ = 7; // 7	16	26	44
 	if (m_iQP == 22)
 	{
 		spQ = 7 + SPQ_DEALTA;
-		
-		if (CUMAX == 8)
-		{
-			offset4x4 = 2;
-			offset4x8 = 1;
-			offset8x4 = 2;
-			offset8x8 = 1;
-		}
 		SP_QOFFSET = 2;
 	}
 
 	if (m_iQP == 27)
 	{
 		spQ = 15 + SPQ_DEALTA;
-		
-		if (CUMAX == 8)
-		{
-			offset4x4 = -1;
-			offset4x8 = -1;
-			offset8x4 = -2;
-			offset8x8 = -2;
-		}
 		SP_QOFFSET = 5;
 	}
 
 	if (m_iQP == 32)
 	{
 		spQ = 27 + SPQ_DEALTA;
-		
-		if (CUMAX == 8)
-		{			
-			offset4x4 = 2;
-			offset4x8 = 1;
-			offset8x4 = -2;
-			offset8x8 = 2;
-		}
 		SP_QOFFSET = 8;
 	}
 
 	if (m_iQP == 37)
 	{
 		spQ = 45 + SPQ_DEALTA;
-		
-		if (CUMAX == 8)
-		{
-			offset4x4 = 1;
-			offset4x8 = 2;
-			offset8x4 = 2;
-			offset8x8 = 1;
-		}
 		SP_QOFFSET = 10;
 	}
 
@@ -236,16 +188,11 @@ int main(int argc, char* argv[])
   Int returnCode = EXIT_SUCCESS;
   TAppDecTop  cTAppDecTop;
 
-  // print information
-  fprintf( stdout, "\n" );
-  fprintf( stdout, "HM software: Decoder Version [%s] (including RExt)", NV_VERSION );
-  fprintf( stdout, NVM_ONOS );
-  fprintf( stdout, NVM_COMPILEDBY );
-  fprintf( stdout, NVM_BITS );
-  fprintf( stdout, "\n" );
-
   // create application decoder class
   cTAppDecTop.create();
+#if PIP
+  cTAppDecTop.setPIPSpatialStep(spQ, m_iQP);
+#endif
 
   // parse configuration
   if(!cTAppDecTop.parseCfg( argc, argv ))
@@ -255,6 +202,14 @@ int main(int argc, char* argv[])
     return returnCode;
   }
 
+  // print information (after the configuration: a reconstruction on stdout sends it to stderr)
+  fprintf( stdout, "\n" );
+  fprintf( stdout, "HM software: Decoder Version [%s] (including RExt)", NV_VERSION );
+  fprintf( stdout, NVM_ONOS );
+  fprintf( stdout, NVM_COMPILEDBY );
+  fprintf( stdout, NVM_BITS );
+  fprintf( stdout, "\n" );
+
   // starting time
   Double dResult;
   clock_t lBefore = clock();
@@ -47,6 +47,7 @@
 #endif
 #include "TAppEncCfg.h"
 #include "TAppCommon/program_options_lite.h"
+#include "TLibVideoIO/TVideoIOYuv.h"
 #include "TLibEncoder/TEncRateCtrl.h"
 #ifdef WIN32
 #define strdup _strdup
@@ -689,6 +690,9 @@ Bool TAppEncCfg::parseCfg( Int argc, Char* argv[] )
   Int tmpInputChromaFormat;
   Int tmpConstraintChromaFormat;
   string inputColourSpaceConvert;
+#if PIP
+  string cfg_PIPStats;
+#endif
   ExtendedProfileName extendedProfile;
   Int saoOffsetBitShift[MAX_NUM_CHANNEL_TYPE];
 
@@ -736,9 +740,9 @@ Bool TAppEncCfg::parseCfg( Int argc, Char* argv[] )
 #endif
 
   // File, I/O and source parameters
-  ("InputFile,i",                                     cfg_InputFile,                               string(""), "Original YUV input file name")
+  ("InputFile,i",                                     cfg_InputFile,                               string(""), "Original YUV or Y4M input file name, \"-\" for stdin")
   ("BitstreamFile,b",                                 cfg_BitstreamFile,                           string(""), "Bitstream output file name")
-  ("ReconFile,o",                                     cfg_ReconFile,                               string(""), "Reconstructed YUV output file name")
+  ("ReconFile,o",                                     cfg_ReconFile,                               string(""), "Reconstructed YUV output file name, \"-\" for stdout, Y4M if it ends in .y4m")
 #if JVET_D0186_PRECISEPSNR
   ("PreciseLog,p",                                    cfg_PreciseLogFile,                          string(""), "Log for precise metrics")
 #endif
@@ -782,6 +786,9 @@ Bool TAppEncCfg::parseCfg( Int argc, Char* argv[] )
   ("FrameSkip,-fs",                                   m_FrameSkip,                                         0u, "Number of frames to skip at start of input YUV")
   ("TemporalSubsampleRatio,-ts",                      m_temporalSubsampleRatio,                            1u, "Temporal sub-sample ratio when reading input YUV")
   ("FramesToBeEncoded,f",                             m_framesToBeEncoded,                                  0, "Number of frames to be encoded (default=all)")
+  ("InputPrefetch",                                   m_inputPrefetch,                                     1u, "Number of input frames read ahead of the encoder on a reader thread (0: read when needed)")
+  ("OutputQueue",                                     m_outputQueue,                                       2u, "Number of output writes queued to a writer thread (0: write on the encoding thread)")
+  ("ParallelSegments,parallel-segments",              m_parallelSegments,                                   0, "Number of intra period segments encoded concurrently and joined into one bitstream as with parcat (0: sequential encoding)")
   ("ClipInputVideoToRec709Range",                     m_bClipInputVideoToRec709Range,                   false, "If true then clip input video to the Rec. 709 Range on loading when InternalBitDepth is less than MSBExtendedBitDepth")
   ("ClipOutputVideoToRec709Range",                    m_bClipOutputVideoToRec709Range,                  false, "If true then clip output video to the Rec. 709 Range on saving when OutputBitDepth is less than InternalBitDepth")
   ("SummaryOutFilename",                              m_summaryOutFilename,                          string(), "Filename to use for producing summary output file. If empty, do not produce a file.")
@@ -965,6 +972,20 @@ Bool TAppEncCfg::parseCfg( Int argc, Char* argv[] )
   ("TileRowHeightArray",                              cfg_RowHeight,                            cfg_RowHeight, "Array containing tile row height values in units of CTU")
   ("LFCrossTileBoundaryFlag",                         m_bLFCrossTileBoundaryFlag,                        true, "1: cross-tile-boundary loop filtering. 0:non-cross-tile-boundary loop filtering")
   ("WaveFrontSynchro",                                m_iWaveFrontSynchro,                                  0, "0: no synchro; 1 synchro with top-right-right")
+#if WPP_PARALLEL_CTU_ROWS
+  ("WppThreads",                                      m_iWppThreads,                                        1, "WaveFrontSynchro: threads compressing the CTU rows of a slice (1: serial)")
+  ("WppRateCtrlRows",                                 m_bWppRateCtrlRows,                               false, "WaveFrontSynchro with CTU level rate control: share the bits of the slice between its CTU rows, so that WppThreads can compress them (changes the output; 0: serial rows)")
+#endif
+#if TILE_PARALLEL_COMPRESSION
+  ("TileThreads",                                     m_iTileThreads,                                       1, "Tiles: threads compressing the tiles of a slice (1: serial)")
+#endif
+#if FRAME_PARALLEL_GOP
+  ("FrameThreads",                                    m_iFrameThreads,                                      1, "threads compressing the pictures of a GOP that do not reference each other (1: serial); from 2 on, their RD search starts from the previous-frame CABAC statistics available before the first of them, so the bitstream differs from 1 but not between values of 2 or more")
+#endif
+#if QTBT_PARALLEL_SPLIT
+  ("SplitThreads",                                    m_iSplitThreads,                                      1, "threads compressing the BT-V and QT split candidates of large CUs after BT-H (1: serial)")
+  ("SplitTaskMinSize",                                m_uiSplitTaskMinSize,                               64u, "SplitThreads: smallest CU size whose split candidates are compressed as tasks")
+#endif
   ("ScalingList",                                     m_useScalingListId,                    SCALING_LIST_OFF, "0/off: no scaling list, 1/default: default scaling lists, 2/file: scaling lists specified in ScalingListFile")
   ("ScalingListFile",                                 cfg_ScalingListFile,                         string(""), "Scaling list file name. Use an empty string to produce help.")
   ("SignHideFlag,-SBH",                               m_signHideFlag,                                    true)
@@ -1180,6 +1201,9 @@ Bool TAppEncCfg::parseCfg( Int argc, Char* argv[] )
                                                                          "\t2:  Enable only Inter KLT\n"
                                                                          "\t3:  Enable both Intra & Inter KLT\n")
 #endif
+#if VCEG_AZ08_KLT_COMMON && KLT_DETERMINISTIC_BASIS
+  ("KLTDeterministicBasis",                           m_KLTDeterministicBasis, false, "KLT: derive the basis with the platform independent eigensolver instead of the Eigen library (signalled in the SPS)")
+#endif
 
 #if COM16_C806_LARGE_CTU
   ("LCTUFast" ,                                       m_useFastLCTU , 1 , "Fast methods for large CTU" )
@@ -1220,10 +1244,23 @@ Bool TAppEncCfg::parseCfg( Int argc, Char* argv[] )
 #if JVET_D0033_ADAPTIVE_CLIPPING
   ("AClip,-aclip", m_ClipParam.isActive, true, "Slice Level Adpative Clipping (Automated by default)")
 #if PIP
-  ("spq22",                                       spQ22,           7 + SPQ_DEALTA, "Position dependent intra prediction combination")	// 7
-  ("spq27",                                       spQ27,           15 + SPQ_DEALTA, "Position dependent intra prediction combination")	// 15
-  ("spq32",                                       spQ32,           27 + SPQ_DEALTA, "Position dependent intra prediction combination")	// 27
-  ("spq37",                                       spQ37,           45 + SPQ_DEALTA, "Position dependent intra prediction combination")	// 45
+  ("spq22",                                       m_PIPSpQ[0],     7 + SPQ_DEALTA, "Position dependent intra prediction combination")	// 7
+  ("spq27",                                       m_PIPSpQ[1],     15 + SPQ_DEALTA, "Position dependent intra prediction combination")	// 15
+  ("spq32",                                       m_PIPSpQ[2],     27 + SPQ_DEALTA, "Position dependent intra prediction combination")	// 27
+  ("spq37",                                       m_PIPSpQ[3],     45 + SPQ_DEALTA, "Position dependent intra prediction combination")	// 45
+  ("spqDelta",                                    m_PIPDeltaSpQ,   0,               "PIP: offset added to the spatial step of the QP")
+#if SRDOQ_INCREMENTAL
+  ("PIPFastRate",                                 m_PIPFastRateEst, false,          "PIP search: table-driven rate estimate instead of the exact R1 rate")
+#endif
+#if PIP_PARALLEL_PRED
+  ("PIPThreads",                                  m_PIPThreads,    1,               "PIP search: threads evaluating the predictors of a block of 8x8 samples or more, so with CUMAX 8 only (1: serial); the CTU workers of WppThreads, TileThreads, FrameThreads and SplitThreads share them")
+#endif
+#if PIP_R1_HT_BINARIZATION
+  ("PIPR1HighThroughput",                         m_PIPR1HighThroughput, false,     "PIP R1: two context bins per sample, bypass coded remainders and signs (signalled in the SPS)")
+#endif
+  ("PIPStats,pip-stats",                          cfg_PIPStats,    string("text"),  "Report of the PIP counters at the end of encoding: none, text or json")
+  ("PIPCodebookDir",                              m_PIPCodebookDir, string("../../../CB/"), "Directory of the PIP text codebooks and training blocks")
+  ("PIPCodebookFile",                             m_PIPCodebookFile, string(""),    "Binary PIP codebook container (pipcbconv), mapped instead of the text files")
 #endif
 #endif
   ;
@@ -1266,11 +1303,31 @@ Bool TAppEncCfg::parseCfg( Int argc, Char* argv[] )
   m_pchInputFile = cfg_InputFile.empty() ? NULL : strdup(cfg_InputFile.c_str());
   m_pchBitstreamFile = cfg_BitstreamFile.empty() ? NULL : strdup(cfg_BitstreamFile.c_str());
   m_pchReconFile = cfg_ReconFile.empty() ? NULL : strdup(cfg_ReconFile.c_str());
+  if (cfg_ReconFile == "-")
+  {
+    // the messages go to stderr from here on
+    TVideoIOYuv::takeStdout();
+  }
 #if JVET_D0186_PRECISEPSNR
   m_pchPreciseLogFile = cfg_PreciseLogFile.empty() ? NULL : strdup(cfg_PreciseLogFile.c_str());
 #endif
   m_pchdQPFile = cfg_dQPFile.empty() ? NULL : strdup(cfg_dQPFile.c_str());
 
+  /* a Y4M input gives the source size, format, bit depth and frame rate */
+  TVideoIOYuv::Y4MHeader y4mHeader;
+  if (m_pchInputFile && TVideoIOYuv::readY4MHeader(m_pchInputFile, y4mHeader))
+  {
+    m_iSourceWidth                         = y4mHeader.width;
+    m_iSourceHeight                        = y4mHeader.height;
+    tmpInputChromaFormat                   = y4mHeader.chromaFormat == CHROMA_400 ? 400 : y4mHeader.chromaFormat == CHROMA_420 ? 420 : y4mHeader.chromaFormat == CHROMA_422 ? 422 : 444;
+    m_inputBitDepth[CHANNEL_TYPE_LUMA  ]   = y4mHeader.bitDepth;
+    m_inputBitDepth[CHANNEL_TYPE_CHROMA]   = y4mHeader.bitDepth;
+    if (y4mHeader.frameRateNum > 0)
+    {
+      m_iFrameRate = (y4mHeader.frameRateNum + y4mHeader.frameRateDen / 2) / y4mHeader.frameRateDen;
+    }
+  }
+
   m_framesToBeEncoded = ( m_framesToBeEncoded + m_temporalSubsampleRatio - 1 ) / m_temporalSubsampleRatio;
 
 #if PIP
@@ -1477,6 +1534,13 @@ Bool TAppEncCfg::parseCfg( Int argc, Char* argv[] )
 
 
   m_inputColourSpaceConvert = stringToInputColourSpaceConvert(inputColourSpaceConvert, true);
+#if PIP
+  if (!TComPIPStats::parseFormat(cfg_PIPStats, m_PIPStatsFormat))
+  {
+    fprintf(stderr, "Bad PIP statistics format `%s' (none, text or json)\n", cfg_PIPStats.c_str());
+    return false;
+  }
+#endif
 
   switch (m_conformanceWindowMode)
   {
@@ -1867,6 +1931,15 @@ Void TAppEncCfg::xCheckParameter()
   xConfirmPara( m_iGOPSize > 1 &&  m_iGOPSize % 2,                                          "GOP Size must be a multiple of 2, if GOP Size is greater than 1" );
   xConfirmPara( (m_iIntraPeriod > 0 && m_iIntraPeriod < m_iGOPSize) || m_iIntraPeriod == 0, "Intra period must be more than GOP size, or -1 , not 0" );
   xConfirmPara( m_iDecodingRefreshType < 0 || m_iDecodingRefreshType > 3,                   "Decoding Refresh Type must be comprised between 0 and 3 included" );
+  xConfirmPara( m_parallelSegments < 0,                                                     "ParallelSegments must not be negative" );
+  if (m_parallelSegments > 0)
+  {
+    xConfirmPara( m_iIntraPeriod <= 0,                                                      "ParallelSegments requires a positive intra period" );
+    xConfirmPara( m_iDecodingRefreshType != 1,                                              "ParallelSegments requires CRA intra pictures (DecodingRefreshType 1), the segments start at them" );
+    xConfirmPara( m_isField,                                                                "ParallelSegments does not support field coding" );
+    xConfirmPara( m_pchInputFile && !strcmp( m_pchInputFile, "-" ),                         "ParallelSegments requires a seekable input file" );
+    xConfirmPara( m_iQP != m_fQP || m_pchdQPFile,                                           "ParallelSegments does not support a QP switch or a dQP file" );
+  }
   if(m_iDecodingRefreshType == 3)
   {
     xConfirmPara( !m_recoveryPointSEIEnabled,                                               "When using RecoveryPointSEI messages as RA points, recoveryPointSEI must be enabled" );
@@ -2531,6 +2604,19 @@ Void TAppEncCfg::xCheckParameter()
   }
 
   xConfirmPara( m_iWaveFrontSynchro < 0, "WaveFrontSynchro cannot be negative" );
+#if WPP_PARALLEL_CTU_ROWS
+  xConfirmPara( m_iWppThreads < 1 || m_iWppThreads > MAX_NUM_CTU_WORKERS, "WppThreads must be in the range of 1 to 64" );
+#endif
+#if TILE_PARALLEL_COMPRESSION
+  xConfirmPara( m_iTileThreads < 1 || m_iTileThreads > MAX_NUM_CTU_WORKERS, "TileThreads must be in the range of 1 to 64" );
+#endif
+#if FRAME_PARALLEL_GOP
+  xConfirmPara( m_iFrameThreads < 1 || m_iFrameThreads > MAX_NUM_CTU_WORKERS, "FrameThreads must be in the range of 1 to 64" );
+#endif
+#if QTBT_PARALLEL_SPLIT
+  xConfirmPara( m_iSplitThreads < 1 || m_iSplitThreads > 2, "SplitThreads must be 1 or 2" );
+  xConfirmPara( m_uiSplitTaskMinSize < 8 || m_uiSplitTaskMinSize > m_uiCTUSize || ( m_uiSplitTaskMinSize & ( m_uiSplitTaskMinSize - 1 ) ), "SplitTaskMinSize must be a power of 2 from 8 to the CTU size" );
+#endif
 
   xConfirmPara( m_decodedPictureHashSEIEnabled<0 || m_decodedPictureHashSEIEnabled>3, "this hash type is not correct!\n");
 
@@ -2633,6 +2719,9 @@ Void TAppEncCfg::xPrintParameter()
   printf("Reconstruction File                    : %s\n", m_pchReconFile          );
   printf("Real     Format                        : %dx%d %gHz\n", m_iSourceWidth - m_confWinLeft - m_confWinRight, m_iSourceHeight - m_confWinTop - m_confWinBottom, (Double)m_iFrameRate/m_temporalSubsampleRatio );
   printf("Internal Format                        : %dx%d %gHz\n", m_iSourceWidth, m_iSourceHeight, (Double)m_iFrameRate/m_temporalSubsampleRatio );
+  printf("Input prefetch                         : %u frames\n", m_inputPrefetch );
+  printf("Output queue                           : %u writes\n", m_outputQueue );
+  printf("Parallel segments                      : %d\n", m_parallelSegments );
   printf("Sequence PSNR output                   : %s\n", (m_printMSEBasedSequencePSNR ? "Linear average, MSE-based" : "Linear average only") );
   printf("Sequence MSE output                    : %s\n", (m_printSequenceMSE ? "Enabled" : "Disabled") );
 #if JVET_D0134_PSNR
@@ -2730,10 +2819,22 @@ Void TAppEncCfg::xPrintParameter()
   printf("persistent_rice_adaptation_enabled_flag: %s\n", (m_persistentRiceAdaptationEnabledFlag     ? "Enabled" : "Disabled") );
   printf("cabac_bypass_alignment_enabled_flag    : %s\n", (m_cabacBypassAlignmentEnabledFlag         ? "Enabled" : "Disabled") );
 #if PIP
-  printf("spQ22								     : %d\n", spQ22 );
-  printf("spQ27								     : %d\n", spQ27);
-  printf("spQ32								     : %d\n", spQ32);
-  printf("spQ37								     : %d\n", spQ37);
+  printf("spQ22								     : %d\n", m_PIPSpQ[0]);
+  printf("spQ27								     : %d\n", m_PIPSpQ[1]);
+  printf("spQ32								     : %d\n", m_PIPSpQ[2]);
+  printf("spQ37								     : %d\n", m_PIPSpQ[3]);
+  printf("spQDelta							     : %d\n", m_PIPDeltaSpQ);
+#if SRDOQ_INCREMENTAL
+  printf("PIPFastRate							     : %d\n", m_PIPFastRateEst);
+#endif
+#if PIP_PARALLEL_PRED
+  printf("PIPThreads							     : %d\n", m_PIPThreads);
+#endif
+#if PIP_R1_HT_BINARIZATION
+  printf("PIPR1HighThroughput					     : %d\n", m_PIPR1HighThroughput);
+#endif
+  printf("PIPStats							     : %s\n", m_PIPStatsFormat == PIP_STATS_JSON ? "json" : m_PIPStatsFormat == PIP_STATS_TEXT ? "text" : "none");
+  printf("PIPCodebook							     : %s\n", m_PIPCodebookFile.empty() ? m_PIPCodebookDir.c_str() : m_PIPCodebookFile.c_str());
 #endif
   if (m_bUseSAO)
   {
@@ -2826,6 +2927,18 @@ Void TAppEncCfg::xPrintParameter()
 #endif
   printf(" WaveFrontSynchro:%d WaveFrontSubstreams:%d",
           m_iWaveFrontSynchro, iWaveFrontSubstreams);
+#if WPP_PARALLEL_CTU_ROWS
+  printf(" WppThreads:%d WppRateCtrlRows:%d", m_iWppThreads, m_bWppRateCtrlRows ? 1 : 0);
+#endif
+#if TILE_PARALLEL_COMPRESSION
+  printf(" TileThreads:%d", m_iTileThreads);
+#endif
+#if FRAME_PARALLEL_GOP
+  printf(" FrameThreads:%d", m_iFrameThreads);
+#endif
+#if QTBT_PARALLEL_SPLIT
+  printf(" SplitThreads:%d SplitTaskMinSize:%d", m_iSplitThreads, m_uiSplitTaskMinSize);
+#endif
   printf(" ScalingList:%d ", m_useScalingListId );
   printf("TMVPMode:%d ", m_TMVPModeId     );
 #if ADAPTIVE_QP_SELECTION
@@ -2870,6 +2983,9 @@ Void TAppEncCfg::xPrintParameter()
 #if VCEG_AZ08_USE_KLT
   printf(" KLT: %1d(intra) %1d(inter) ", m_useKLT & 1, (m_useKLT >> 1) & 1);
 #endif
+#if VCEG_AZ08_KLT_COMMON && KLT_DETERMINISTIC_BASIS
+  printf("KLTDeterministicBasis:%d ", m_KLTDeterministicBasis);
+#endif
 #if VCEG_AZ07_INTRA_4TAP_FILTER
   printf( "Intra4TapFilter:%d " , m_useIntra4TapFilter );
 #endif
@@ -41,6 +41,9 @@
 #include "TLibCommon/CommonDef.h"
 
 #include "TLibEncoder/TEncCfg.h"
+#if PIP
+#include "TLibCommon/TComPIPContext.h"
+#endif
 #include <sstream>
 #include <vector>
 //! \ingroup TAppEncoder
@@ -66,6 +69,9 @@ protected:
   Int       m_iFrameRate;                                     ///< source frame-rates (Hz)
   UInt      m_FrameSkip;                                      ///< number of skipped frames from the beginning
   UInt      m_temporalSubsampleRatio;                         ///< temporal subsample ratio, 2 means code every two frames
+  UInt      m_inputPrefetch;                                  ///< input frames read ahead of the encoder, 0: read when needed
+  UInt      m_outputQueue;                                    ///< reconstructed frames and access units queued to the writer, 0: written at once
+  Int       m_parallelSegments;                               ///< intra period segments encoded concurrently into one bitstream, 0: sequential encoding
   Int       m_iSourceWidth;                                   ///< source width in pixel
   Int       m_iSourceHeight;                                  ///< source height in pixel (when interlaced = field height)
 
@@ -276,6 +282,20 @@ protected:
   std::vector<Int> m_tileRowHeight;
   Int       m_iWaveFrontSynchro; //< 0: no WPP. >= 1: WPP is enabled, the "Top right" from which inheritance occurs is this LCU offset in the line above the current.
   Int       m_iWaveFrontFlush; //< enable(1)/disable(0) the CABAC flush at the end of each line of LCUs.
+#if WPP_PARALLEL_CTU_ROWS
+  Int       m_iWppThreads;                                    ///< threads compressing the CTU rows of a WPP slice, 1: serial
+  Bool      m_bWppRateCtrlRows;                               ///< CTU level rate control of a WPP slice per CTU row
+#endif
+#if TILE_PARALLEL_COMPRESSION
+  Int       m_iTileThreads;                                   ///< threads compressing the tiles of a slice, 1: serial
+#endif
+#if FRAME_PARALLEL_GOP
+  Int       m_iFrameThreads;                                  ///< threads compressing the pictures of a GOP, 1: serial
+#endif
+#if QTBT_PARALLEL_SPLIT
+  Int       m_iSplitThreads;                                  ///< threads compressing the split candidates of a CU, 1: serial
+  UInt      m_uiSplitTaskMinSize;                             ///< smallest CU size whose split candidates are compressed as tasks
+#endif
 
   Bool      m_bUseConstrainedIntraPred;                       ///< flag for using constrained intra prediction
   Bool      m_bFastUDIUseMPMEnabled;
@@ -443,6 +463,9 @@ protected:
 #if VCEG_AZ08_USE_KLT
   Int       m_useKLT;                                         
 #endif
+#if VCEG_AZ08_KLT_COMMON && KLT_DETERMINISTIC_BASIS
+  Bool      m_KLTDeterministicBasis;                          ///< KLT basis from TComKLTBasis instead of Eigen (SPS flag)
+#endif
 
 #if VCEG_AZ07_INTRA_4TAP_FILTER
   Bool      m_useIntra4TapFilter;
@@ -475,6 +498,22 @@ protected:
 #endif
 #if JVET_D0033_ADAPTIVE_CLIPPING
   ClipParam m_ClipParam;
+#endif
+#if PIP
+  Int       m_PIPSpQ[4];                                      ///< spatial step of the PIP residual for QP 22, 27, 32, 37
+  Int       m_PIPDeltaSpQ;                                    ///< offset added to the spatial step
+#if SRDOQ_INCREMENTAL
+  Bool      m_PIPFastRateEst;                                 ///< table-driven PIP rate, no context adaptation inside the block
+#endif
+#if PIP_PARALLEL_PRED
+  Int       m_PIPThreads;                                     ///< threads of the PIP predictor search, 1: serial
+#endif
+#if PIP_R1_HT_BINARIZATION
+  Bool      m_PIPR1HighThroughput;                            ///< R1 with two context bins per sample, the rest bypass coded (SPS flag)
+#endif
+  PIPStatsFormat m_PIPStatsFormat;                            ///< report of the PIP counters at the end of encoding
+  std::string m_PIPCodebookDir;                               ///< directory of the text codebooks and training blocks
+  std::string m_PIPCodebookFile;                              ///< binary codebook container, mapped instead of the text files
 #endif
   std::string m_summaryOutFilename;                           ///< filename to use for producing summary output file.
   std::string m_summaryPicFilenameBase;                       ///< Base filename to use for producing summary picture output files. The actual filenames used will have I.txt, P.txt and B.txt appended.
@@ -42,27 +42,55 @@
 #include <fcntl.h>
 #include <assert.h>
 #include <iomanip>
+#include <memory>
+#include <algorithm>
+#include <thread>
 
 #include "TAppEncTop.h"
 #include "TLibEncoder/AnnexBwrite.h"
+#include "TAppCommon/parcat_segment.h"
 
 using namespace std;
 
 #if PIP
-Int*** Codebooks;
-double** Rates;
-Int*** nextCodebooks;
-Int**  nextCodebooksCnt;
-Char* InCBDir = "../../../CB/CB";
 Char* MinResAddress = "MinRes";
 Char	InAddr[512] = "";
 Char	OutAddr[512] = "";
-Int**	PIPStats;
 #endif
 
 //! \ingroup TAppEncoder
 //! \{
 
+/// slices and parameter sets: the bytes of "SPS/PPS/Slice" in the rate summary
+static Bool isEssentialNalUnit(NalUnitType eNalUnitType)
+{
+  switch (eNalUnitType)
+  {
+  case NAL_UNIT_CODED_SLICE_TRAIL_R:
+  case NAL_UNIT_CODED_SLICE_TRAIL_N:
+  case NAL_UNIT_CODED_SLICE_TSA_R:
+  case NAL_UNIT_CODED_SLICE_TSA_N:
+  case NAL_UNIT_CODED_SLICE_STSA_R:
+  case NAL_UNIT_CODED_SLICE_STSA_N:
+  case NAL_UNIT_CODED_SLICE_BLA_W_LP:
+  case NAL_UNIT_CODED_SLICE_BLA_W_RADL:
+  case NAL_UNIT_CODED_SLICE_BLA_N_LP:
+  case NAL_UNIT_CODED_SLICE_IDR_W_RADL:
+  case NAL_UNIT_CODED_SLICE_IDR_N_LP:
+  case NAL_UNIT_CODED_SLICE_CRA:
+  case NAL_UNIT_CODED_SLICE_RADL_N:
+  case NAL_UNIT_CODED_SLICE_RADL_R:
+  case NAL_UNIT_CODED_SLICE_RASL_N:
+  case NAL_UNIT_CODED_SLICE_RASL_R:
+  case NAL_UNIT_VPS:
+  case NAL_UNIT_SPS:
+  case NAL_UNIT_PPS:
+    return true;
+  default:
+    return false;
+  }
+}
+
 // ====================================================================================================================
 // Constructor / destructor / initialization / destroy
 // ====================================================================================================================
@@ -384,6 +412,20 @@ Void TAppEncTop::xInitLibCfg()
   }
   m_cTEncTop.setLFCrossTileBoundaryFlag                           ( m_bLFCrossTileBoundaryFlag );
   m_cTEncTop.setWaveFrontSynchro                                  ( m_iWaveFrontSynchro );
+#if WPP_PARALLEL_CTU_ROWS
+  m_cTEncTop.setWppThreads                                        ( m_iWppThreads );
+  m_cTEncTop.setWppRateCtrlRows                                   ( m_bWppRateCtrlRows );
+#endif
+#if TILE_PARALLEL_COMPRESSION
+  m_cTEncTop.setTileThreads                                       ( m_iTileThreads );
+#endif
+#if FRAME_PARALLEL_GOP
+  m_cTEncTop.setFrameThreads                                      ( m_iFrameThreads );
+#endif
+#if QTBT_PARALLEL_SPLIT
+  m_cTEncTop.setSplitThreads                                      ( m_iSplitThreads );
+  m_cTEncTop.setSplitTaskMinSize                                  ( m_uiSplitTaskMinSize );
+#endif
   m_cTEncTop.setTMVPModeId                                        ( m_TMVPModeId );
   m_cTEncTop.setUseScalingListId                                  ( m_useScalingListId  );
   m_cTEncTop.setScalingListFile                                   ( m_scalingListFile   );
@@ -473,6 +515,9 @@ Void TAppEncTop::xInitLibCfg()
   m_cTEncTop.setUseInterKLT                                       ( (m_useKLT >> 1) & 1 );
   m_cTEncTop.setUseKLT                                            ( m_useKLT );
 #endif
+#if VCEG_AZ08_KLT_COMMON && KLT_DETERMINISTIC_BASIS
+  m_cTEncTop.setKLTDeterministicBasis                             ( m_KLTDeterministicBasis );
+#endif
 
 #if VCEG_AZ07_INTRA_4TAP_FILTER
   m_cTEncTop.setUseIntra4TapFilter(m_useIntra4TapFilter);
@@ -508,6 +553,24 @@ Void TAppEncTop::xInitLibCfg()
 #endif
 #if JVET_D0033_ADAPTIVE_CLIPPING
   m_cTEncTop.setTchClipParam(m_ClipParam);
+#endif
+#if PIP
+  for (Int i = 0; i < 4; i++)
+  {
+    m_cTEncTop.setPIPSpQ(i, m_PIPSpQ[i]);
+  }
+  m_cTEncTop.setPIPDeltaSpQ(m_PIPDeltaSpQ);
+#if SRDOQ_INCREMENTAL
+  m_cTEncTop.setPIPFastRateEst(m_PIPFastRateEst);
+#endif
+#if PIP_PARALLEL_PRED
+  m_cTEncTop.setPIPThreads(m_PIPThreads);
+#endif
+#if PIP_R1_HT_BINARIZATION
+  m_cTEncTop.setPIPR1HighThroughput(m_PIPR1HighThroughput);
+#endif
+  m_cTEncTop.setPIPCodebookDir(m_PIPCodebookDir);
+  m_cTEncTop.setPIPCodebookFile(m_PIPCodebookFile);
 #endif
   m_cTEncTop.setSummaryOutFilename                                ( m_summaryOutFilename );
   m_cTEncTop.setSummaryPicFilenameBase                            ( m_summaryPicFilenameBase );
@@ -522,6 +585,7 @@ Void TAppEncTop::xCreateLib()
 
   if (m_pchReconFile)
   {
+    m_cTVideoIOYuvReconFile.setY4MFrameRate(m_iFrameRate, m_temporalSubsampleRatio);
     m_cTVideoIOYuvReconFile.open(m_pchReconFile, true, m_outputBitDepth, m_outputBitDepth, m_internalBitDepth);  // write mode
   }
 
@@ -580,7 +644,15 @@ Void TAppEncTop::encode()
     exit(EXIT_FAILURE);
   }
 
-  TComPicYuv*       pcPicYuvOrg = new TComPicYuv;
+  if ( m_parallelSegments > 0 )
+  {
+    xInitLibCfg();
+    printChromaFormat();
+    xEncodeSegments( bitstreamFile );
+    printRateSummary();
+    return;
+  }
+
   TComPicYuv*       pcPicYuvRec = NULL;
 
   // initialize internal class & member variables
@@ -600,42 +672,49 @@ Void TAppEncTop::encode()
 
   list<AccessUnit> outputAccessUnits; ///< list of access units to write out.  is populated by the encoding process
 
-  TComPicYuv cPicYuvTrueOrg;
-
-  // allocate original YUV buffer
-#if JVET_C0024_QTBT
-  if( m_isField )
+  // allocate original YUV buffers: the picture being encoded and the ones read ahead of it
+  const Int iSourceHeightOrg = m_isField ? m_iSourceHeightOrg : m_iSourceHeight;
+  std::vector<TComPicYuv*> cPicYuvOrg( m_inputPrefetch + 1 );
+  std::vector<TComPicYuv*> cPicYuvTrueOrg( m_inputPrefetch + 1 );
+  for ( UInt i = 0; i <= m_inputPrefetch; i++ )
   {
-    pcPicYuvOrg->create  ( m_iSourceWidth, m_iSourceHeightOrg, m_chromaFormatIDC, m_uiCTUSize, m_uiCTUSize, m_uiMaxTotalCUDepth, true );
-    cPicYuvTrueOrg.create(m_iSourceWidth, m_iSourceHeightOrg, m_chromaFormatIDC, m_uiCTUSize, m_uiCTUSize, m_uiMaxTotalCUDepth, true);
-  }
-  else
-  {
-    pcPicYuvOrg->create  ( m_iSourceWidth, m_iSourceHeight, m_chromaFormatIDC, m_uiCTUSize, m_uiCTUSize, m_uiMaxTotalCUDepth, true );
-    cPicYuvTrueOrg.create(m_iSourceWidth, m_iSourceHeight, m_chromaFormatIDC, m_uiCTUSize, m_uiCTUSize, m_uiMaxTotalCUDepth, true );
-  }
+    cPicYuvOrg[i]     = new TComPicYuv;
+    cPicYuvTrueOrg[i] = new TComPicYuv;
+#if JVET_C0024_QTBT
+    cPicYuvOrg[i]->create    ( m_iSourceWidth, iSourceHeightOrg, m_chromaFormatIDC, m_uiCTUSize, m_uiCTUSize, m_uiMaxTotalCUDepth, true );
+    cPicYuvTrueOrg[i]->create( m_iSourceWidth, iSourceHeightOrg, m_chromaFormatIDC, m_uiCTUSize, m_uiCTUSize, m_uiMaxTotalCUDepth, true );
 #else
-  if( m_isField )
-  {
-    pcPicYuvOrg->create  ( m_iSourceWidth, m_iSourceHeightOrg, m_chromaFormatIDC, m_uiMaxCUWidth, m_uiMaxCUHeight, m_uiMaxTotalCUDepth, true );
-    cPicYuvTrueOrg.create(m_iSourceWidth, m_iSourceHeightOrg, m_chromaFormatIDC, m_uiMaxCUWidth, m_uiMaxCUHeight, m_uiMaxTotalCUDepth, true);
-  }
-  else
-  {
-    pcPicYuvOrg->create  ( m_iSourceWidth, m_iSourceHeight, m_chromaFormatIDC, m_uiMaxCUWidth, m_uiMaxCUHeight, m_uiMaxTotalCUDepth, true );
-    cPicYuvTrueOrg.create(m_iSourceWidth, m_iSourceHeight, m_chromaFormatIDC, m_uiMaxCUWidth, m_uiMaxCUHeight, m_uiMaxTotalCUDepth, true );
-  }
+    cPicYuvOrg[i]->create    ( m_iSourceWidth, iSourceHeightOrg, m_chromaFormatIDC, m_uiMaxCUWidth, m_uiMaxCUHeight, m_uiMaxTotalCUDepth, true );
+    cPicYuvTrueOrg[i]->create( m_iSourceWidth, iSourceHeightOrg, m_chromaFormatIDC, m_uiMaxCUWidth, m_uiMaxCUHeight, m_uiMaxTotalCUDepth, true );
 #endif
+  }
 
-  
+  // read the input YUV file ahead of the encoder
+  TVideoIOYuvPrefetch::ReadParams cReadParams;
+  cReadParams.ipCSC         = ipCSC;
+  cReadParams.aiPad[0]      = m_aiPad[0];
+  cReadParams.aiPad[1]      = m_aiPad[1];
+  cReadParams.fileFormat    = m_InputChromaFormatIDC;
+  cReadParams.bClipToRec709 = m_bClipInputVideoToRec709Range;
+  cReadParams.skipFrames    = m_temporalSubsampleRatio - 1;       // temporally skip frames
+  cReadParams.skipWidth     = m_iSourceWidth - m_aiPad[0];
+  cReadParams.skipHeight    = m_iSourceHeight - m_aiPad[1];
+  const Int iFramesToRead   = m_isField ? ( m_framesToBeEncoded >> 1 ) : m_framesToBeEncoded;
+  TVideoIOYuvPrefetch cInputPrefetch;
+  cInputPrefetch.start( &m_cTVideoIOYuvInputFile, iFramesToRead > 0 ? iFramesToRead : MAX_INT, cReadParams, cPicYuvOrg, cPicYuvTrueOrg );
+
+  // write the reconstruction and the bitstream behind the encoder
+  m_cOutputWriter.start( m_outputQueue );
 
   while ( !bEos )
   {
     // get buffers
     xGetBuffer(pcPicYuvRec);
 
-    // read input YUV file
-    m_cTVideoIOYuvInputFile.read( pcPicYuvOrg, &cPicYuvTrueOrg, ipCSC, m_aiPad, m_InputChromaFormatIDC, m_bClipInputVideoToRec709Range );
+    // get the next picture of the input YUV file
+    TComPicYuv* pcPicYuvOrg     = NULL;
+    TComPicYuv* pcPicYuvTrueOrg = NULL;
+    const Bool  bRead           = cInputPrefetch.getPicture( pcPicYuvOrg, pcPicYuvTrueOrg );
 
     // increase number of received frames
     m_iFrameRcvd++;
@@ -644,7 +723,7 @@ Void TAppEncTop::encode()
 
     Bool flush = 0;
     // if end of file (which is only detected on a read failure) flush the encoder of any queued pictures
-    if (m_cTVideoIOYuvInputFile.isEof())
+    if (!bRead)
     {
       flush = true;
       bEos = true;
@@ -656,33 +735,32 @@ Void TAppEncTop::encode()
     if ( m_isField )
     {
 #if VCEG_AZ07_BAC_ADAPT_WDOW || VCEG_AZ07_INIT_PREVFRAME
-      m_cTEncTop.encode( bEos, flush ? 0 : pcPicYuvOrg, flush ? 0 : &cPicYuvTrueOrg, snrCSC, m_cListPicYuvRec, outputAccessUnits, iNumEncoded, m_isTopFieldFirst, m_apcStats);
+      m_cTEncTop.encode( bEos, flush ? 0 : pcPicYuvOrg, flush ? 0 : pcPicYuvTrueOrg, snrCSC, m_cListPicYuvRec, outputAccessUnits, iNumEncoded, m_isTopFieldFirst, m_apcStats);
 #else
-      m_cTEncTop.encode( bEos, flush ? 0 : pcPicYuvOrg, flush ? 0 : &cPicYuvTrueOrg, snrCSC, m_cListPicYuvRec, outputAccessUnits, iNumEncoded, m_isTopFieldFirst );
+      m_cTEncTop.encode( bEos, flush ? 0 : pcPicYuvOrg, flush ? 0 : pcPicYuvTrueOrg, snrCSC, m_cListPicYuvRec, outputAccessUnits, iNumEncoded, m_isTopFieldFirst );
 #endif
     }
     else
     {
 #if VCEG_AZ07_BAC_ADAPT_WDOW || VCEG_AZ07_INIT_PREVFRAME
-      m_cTEncTop.encode( bEos, flush ? 0 : pcPicYuvOrg, flush ? 0 : &cPicYuvTrueOrg, snrCSC, m_cListPicYuvRec, outputAccessUnits, iNumEncoded, m_apcStats);
+      m_cTEncTop.encode( bEos, flush ? 0 : pcPicYuvOrg, flush ? 0 : pcPicYuvTrueOrg, snrCSC, m_cListPicYuvRec, outputAccessUnits, iNumEncoded, m_apcStats);
 #else
-      m_cTEncTop.encode( bEos, flush ? 0 : pcPicYuvOrg, flush ? 0 : &cPicYuvTrueOrg, snrCSC, m_cListPicYuvRec, outputAccessUnits, iNumEncoded );
+      m_cTEncTop.encode( bEos, flush ? 0 : pcPicYuvOrg, flush ? 0 : pcPicYuvTrueOrg, snrCSC, m_cListPicYuvRec, outputAccessUnits, iNumEncoded );
 #endif
     }
 
+    // the encoder has copied the picture
+    cInputPrefetch.releasePicture();
+
     // write bistream to file if necessary
     if ( iNumEncoded > 0 )
     {
       xWriteOutput(bitstreamFile, iNumEncoded, outputAccessUnits);
       outputAccessUnits.clear();
     }
-
-    // temporally skip frames
-    if( m_temporalSubsampleRatio > 1 )
-    {
-      m_cTVideoIOYuvInputFile.skipFrames(m_temporalSubsampleRatio-1, m_iSourceWidth - m_aiPad[0], m_iSourceHeight - m_aiPad[1], m_InputChromaFormatIDC);
-    }
   }
+  cInputPrefetch.stop();
+  m_cOutputWriter.stop();
 
   m_cTEncTop.printSummary(m_isField);
 #if JVET_D0186_PRECISEPSNR
@@ -691,47 +769,23 @@ Void TAppEncTop::encode()
     m_cTEncTop.printPreciseSummary(m_pchPreciseLogFile, m_isField);
   }
 #endif  
-// delete original YUV buffer
-  pcPicYuvOrg->destroy();
-  delete pcPicYuvOrg;
-  pcPicYuvOrg = NULL;
+// delete original YUV buffers
+  for ( UInt i = 0; i <= m_inputPrefetch; i++ )
+  {
+    cPicYuvOrg[i]->destroy();
+    delete cPicYuvOrg[i];
+    cPicYuvTrueOrg[i]->destroy();
+    delete cPicYuvTrueOrg[i];
+  }
   // delete used buffers in encoder class
   m_cTEncTop.deletePicBuffer();
-  cPicYuvTrueOrg.destroy();
   // delete buffers & classes
   xDeleteBuffer();
   xDestroyLib();
   printRateSummary();
 
 #if PIP
-  cout << "All Luma CUs:" << AllCUCount << endl;
-  cout << "All PIP valid CUs:" << PIPValudCUCount << endl;
-  cout << "All PIP CUs:" << PIPCUcount << endl;
-  fprintf(stdout, "%f\n", (float)PIPCUcount / (float)PIPValudCUCount);
-  fprintf(stdout, "%f\n", (float)PIPCUcount / (float)AllCUCount);
-
-  // new stats 
-  int base = log2(CUMAX) - 1;
-  cout << endl << endl;
-  cout << "------------------------------" << endl;  
-  for (int j = 0; j < base; j++)
-	  for (int i = 0; i < base; i++)
-		  fprintf(stdout, "%dx%d\t\t\t", (1 << j + 2), (1 << i + 2));
-		  //cout << (1 << j + 2) << "x" << (1 << i + 2) << "\t\t\t";
-  	  
-	
-  fprintf(stdout, "\n");
-
-  for (int j = 0; j < 3; j++)
-  {
-	  if (j < 2)
-		  for (int i = 0; i < (1 << base); i++)
-			  fprintf(stdout, "%5d\t\t", PIPStats[j][i]);// cout << PIPStats[j][i] << "\t\t\t";	  
-	  else
-		  for (int i = 0; i < (1 << base); i++)	  
-			  fprintf(stdout, "%1.2f\t\t", PIPStats[0][i] > 0 ? (double)PIPStats[1][i] / (double)PIPStats[0][i] : 0);//cout << (double)PIPStats[1][i] / (double)PIPStats[0][i] << "\t\t\t";			  
-	  fprintf(stdout, "\n\t");
-  }
+  m_cTEncTop.getPIPContext().getTotalStats().report(stdout, m_PIPStatsFormat, false);
 #endif
 
   return;
@@ -747,14 +801,14 @@ Void TAppEncTop::encode()
  - end of the list has the latest picture
  .
  */
-Void TAppEncTop::xGetBuffer( TComPicYuv*& rpcPicYuvRec)
+Void TAppEncTop::xGetBuffer( TComList<TComPicYuv*>& rcListPicYuvRec, TComPicYuv*& rpcPicYuvRec)
 {
   assert( m_iGOPSize > 0 );
 
   // org. buffer
-  if ( m_cListPicYuvRec.size() >= (UInt)m_iGOPSize ) // buffer will be 1 element longer when using field coding, to maintain first field whilst processing second.
+  if ( rcListPicYuvRec.size() >= (UInt)m_iGOPSize ) // buffer will be 1 element longer when using field coding, to maintain first field whilst processing second.
   {
-    rpcPicYuvRec = m_cListPicYuvRec.popFront();
+    rpcPicYuvRec = rcListPicYuvRec.popFront();
 
   }
   else
@@ -768,14 +822,14 @@ Void TAppEncTop::xGetBuffer( TComPicYuv*& rpcPicYuvRec)
 #endif
 
   }
-  m_cListPicYuvRec.pushBack( rpcPicYuvRec );
+  rcListPicYuvRec.pushBack( rpcPicYuvRec );
 }
 
-Void TAppEncTop::xDeleteBuffer( )
+Void TAppEncTop::xDeleteBuffer( TComList<TComPicYuv*>& rcListPicYuvRec )
 {
-  TComList<TComPicYuv*>::iterator iterPicYuvRec  = m_cListPicYuvRec.begin();
+  TComList<TComPicYuv*>::iterator iterPicYuvRec  = rcListPicYuvRec.begin();
 
-  Int iSize = Int( m_cListPicYuvRec.size() );
+  Int iSize = Int( rcListPicYuvRec.size() );
 
   for ( Int i = 0; i < iSize; i++ )
   {
@@ -783,7 +837,239 @@ Void TAppEncTop::xDeleteBuffer( )
     pcPicYuvRec->destroy();
     delete pcPicYuvRec; pcPicYuvRec = NULL;
   }
+  rcListPicYuvRec.clear();
+}
+
+/**
+ - the input is split at the intra periods as in the parallel simulations of JVET-B0036: segment k encodes the
+   frames k*IntraPeriod to (k+1)*IntraPeriod, its last frame is coded again as the first frame of segment k+1
+ - up to ParallelSegments segments are encoded at a time, each on its own thread with its own encoder
+ - the segments are joined in order with the filtering of parcat as they finish, so the bitstream is the one of
+   parcat applied to the bitstreams of the separate encodings
+ - the reconstruction of a segment is written when it is joined; the first frame of the following segments is
+   dropped as their IDR picture is by parcat
+ .
+ */
+Void TAppEncTop::xEncodeSegments(std::ostream& bitstreamFile)
+{
+  if (m_pchReconFile)
+  {
+    m_cTVideoIOYuvReconFile.setY4MFrameRate(m_iFrameRate, m_temporalSubsampleRatio);
+    m_cTVideoIOYuvReconFile.open(m_pchReconFile, true, m_outputBitDepth, m_outputBitDepth, m_internalBitDepth);  // write mode
+  }
+#if JVET_D0186_PRECISEPSNR
+  if (m_pchPreciseLogFile != NULL)
+  {
+    fprintf(stderr, "Warning: the precise PSNR log is not written with ParallelSegments\n");
+  }
+#endif
+
+  // the input file is shared by the segments, each read seeks to its frame
+  m_cTVideoIOYuvInputFile.open( m_pchInputFile, false, m_inputBitDepth, m_MSBExtendedBitDepth, m_internalBitDepth );  // read  mode
+  std::mutex cInputMutex;
+
+  const Int iNumSegments = std::max( 1, ( m_framesToBeEncoded - 1 + m_iIntraPeriod - 1 ) / m_iIntraPeriod );
+  std::vector<Segment*> apcSegments( iNumSegments );
+  std::vector<std::thread> cThreads( iNumSegments );
+  Int iNumStarted = 0;
+
+  Int iPOCBase = 0;
+  Int iLastIDRPOC = 0;
+#if PIP
+  TComPIPStats cPIPStats;
+#endif
+
+  for ( Int iSegment = 0; iSegment < iNumSegments; iSegment++ )
+  {
+    // keep ParallelSegments segments in flight, the encoders are kept until their segment is joined
+    for ( ; iNumStarted < iNumSegments && iNumStarted < iSegment + m_parallelSegments; iNumStarted++ )
+    {
+      Segment* pcSegment      = new Segment;
+      pcSegment->pcEncTop     = new TEncTop;
+      static_cast<TEncCfg&>( *pcSegment->pcEncTop ) = m_cTEncTop;
+      pcSegment->uiFirstFrame = m_FrameSkip + iNumStarted * m_iIntraPeriod * m_temporalSubsampleRatio;
+      pcSegment->iNumFrames   = std::min( m_iIntraPeriod + 1, m_framesToBeEncoded - iNumStarted * m_iIntraPeriod );
+      pcSegment->iFrameRcvd   = 0;
+      pcSegment->pcEncTop->setFrameSkip         ( pcSegment->uiFirstFrame );
+      pcSegment->pcEncTop->setFramesToBeEncoded ( pcSegment->iNumFrames );
+
+      apcSegments[iNumStarted] = pcSegment;
+      cThreads[iNumStarted]    = std::thread( &TAppEncTop::xEncodeSegment, this, std::ref( *pcSegment ), std::ref( cInputMutex ) );
+    }
+
+    cThreads[iSegment].join();
+    Segment* pcSegment = apcSegments[iSegment];
+
+    pcSegment->pcEncTop->printSummary(false);
+#if PIP
+    cPIPStats.merge( pcSegment->pcEncTop->getPIPContext().getTotalStats() );
+#endif
+    m_iFrameRcvd = std::max<Int>( m_iFrameRcvd, iSegment * m_iIntraPeriod + pcSegment->iFrameRcvd );
+
+    // parcat: the parameter sets and the IDR picture of the following segments are dropped, the POCs continue
+    const std::string cSegmentBytes = pcSegment->cBitstream.str();
+    if ( !cSegmentBytes.empty() )
+    {
+      const std::vector<uint8_t> cBytes( cSegmentBytes.begin(), cSegmentBytes.end() );
+      const std::vector<uint8_t> cJoined = parcat::filter_segment( cBytes, iSegment + 1, &iPOCBase, &iLastIDRPOC );
+      bitstreamFile.write( reinterpret_cast<const Char*>( cJoined.data() ), cJoined.size() );
+
+      // rate statistics of the joined NAL units, start codes included
+      const uint8_t* pNalu = cJoined.data();
+      Int iSize = Int( cJoined.size() );
+      Int iNalStart, iNalEnd;
+      while ( iSize > 4 && parcat::find_nal_unit( pNalu, iSize, &iNalStart, &iNalEnd ) > 0 )
+      {
+        if ( isEssentialNalUnit( NalUnitType( pNalu[iNalStart] >> 1 ) ) )
+        {
+          m_essentialBytes += iNalEnd;
+        }
+        pNalu += iNalEnd;
+        iSize -= iNalEnd;
+      }
+      m_totalBytes += UInt( cJoined.size() );
+    }
+
+    const InputColourSpaceConversion ipCSC = (!m_outputInternalColourSpace) ? m_inputColourSpaceConvert : IPCOLOURSPACE_UNCHANGED;
+    for ( size_t i = 0; i < pcSegment->cRecon.size(); i++ )
+    {
+      if ( i > 0 || iSegment == 0 )
+      {
+        m_cTVideoIOYuvReconFile.write( pcSegment->cRecon[i], ipCSC, m_confWinLeft, m_confWinRight, m_confWinTop, m_confWinBottom, NUM_CHROMA_FORMAT, m_bClipOutputVideoToRec709Range );
+      }
+      pcSegment->cRecon[i]->destroy();
+      delete pcSegment->cRecon[i];
+    }
+
+    pcSegment->pcEncTop->deletePicBuffer();
+    xDeleteBuffer( pcSegment->cListPicYuvRec );
+#if VCEG_AZ07_BAC_ADAPT_WDOW || VCEG_AZ07_INIT_PREVFRAME
+    delete pcSegment->pcStats;
+#endif
+    pcSegment->pcEncTop->destroy();
+    delete pcSegment->pcEncTop;
+    delete pcSegment;
+    apcSegments[iSegment] = NULL;
+  }
 
+  m_cTVideoIOYuvInputFile.close();
+  m_cTVideoIOYuvReconFile.close();
+
+#if PIP
+  cPIPStats.report(stdout, m_PIPStatsFormat, false);
+#endif
+}
+
+Void TAppEncTop::xEncodeSegment(Segment& rcSegment, std::mutex& rcInputMutex)
+{
+  TEncTop& rcEncTop = *rcSegment.pcEncTop;
+  rcEncTop.create();
+#if VCEG_AZ07_INIT_PREVFRAME
+  rcSegment.pcStats = new TComStats (1, NUM_CTX_PBSLICE);
+#elif VCEG_AZ07_BAC_ADAPT_WDOW
+  rcSegment.pcStats = new TComStats ();
+#endif
+  rcEncTop.init(false);
+
+  const InputColourSpaceConversion ipCSC  =  m_inputColourSpaceConvert;
+  const InputColourSpaceConversion snrCSC = (!m_snrInternalColourSpace) ? m_inputColourSpaceConvert : IPCOLOURSPACE_UNCHANGED;
+
+  std::vector<TComPicYuv*> cPicYuvOrg( m_inputPrefetch + 1 );
+  std::vector<TComPicYuv*> cPicYuvTrueOrg( m_inputPrefetch + 1 );
+  for ( UInt i = 0; i <= m_inputPrefetch; i++ )
+  {
+    cPicYuvOrg[i]     = new TComPicYuv;
+    cPicYuvTrueOrg[i] = new TComPicYuv;
+#if JVET_C0024_QTBT
+    cPicYuvOrg[i]->create    ( m_iSourceWidth, m_iSourceHeight, m_chromaFormatIDC, m_uiCTUSize, m_uiCTUSize, m_uiMaxTotalCUDepth, true );
+    cPicYuvTrueOrg[i]->create( m_iSourceWidth, m_iSourceHeight, m_chromaFormatIDC, m_uiCTUSize, m_uiCTUSize, m_uiMaxTotalCUDepth, true );
+#else
+    cPicYuvOrg[i]->create    ( m_iSourceWidth, m_iSourceHeight, m_chromaFormatIDC, m_uiMaxCUWidth, m_uiMaxCUHeight, m_uiMaxTotalCUDepth, true );
+    cPicYuvTrueOrg[i]->create( m_iSourceWidth, m_iSourceHeight, m_chromaFormatIDC, m_uiMaxCUWidth, m_uiMaxCUHeight, m_uiMaxTotalCUDepth, true );
+#endif
+  }
+
+  TVideoIOYuvPrefetch::ReadParams cReadParams;
+  cReadParams.ipCSC         = ipCSC;
+  cReadParams.aiPad[0]      = m_aiPad[0];
+  cReadParams.aiPad[1]      = m_aiPad[1];
+  cReadParams.fileFormat    = m_InputChromaFormatIDC;
+  cReadParams.bClipToRec709 = m_bClipInputVideoToRec709Range;
+  cReadParams.skipFrames    = m_temporalSubsampleRatio - 1;
+  cReadParams.skipWidth     = m_iSourceWidth - m_aiPad[0];
+  cReadParams.skipHeight    = m_iSourceHeight - m_aiPad[1];
+  TVideoIOYuvPrefetch cInputPrefetch;
+  cInputPrefetch.start( &m_cTVideoIOYuvInputFile, rcSegment.iNumFrames, cReadParams, cPicYuvOrg, cPicYuvTrueOrg, &rcInputMutex, rcSegment.uiFirstFrame );
+
+  list<AccessUnit> outputAccessUnits;
+  Int  iNumEncoded = 0;
+  Bool bEos = false;
+
+  while ( !bEos )
+  {
+    TComPicYuv* pcPicYuvRec = NULL;
+    xGetBuffer( rcSegment.cListPicYuvRec, pcPicYuvRec );
+
+    TComPicYuv* pcPicYuvOrg     = NULL;
+    TComPicYuv* pcPicYuvTrueOrg = NULL;
+    const Bool  bRead           = cInputPrefetch.getPicture( pcPicYuvOrg, pcPicYuvTrueOrg );
+
+    rcSegment.iFrameRcvd++;
+    bEos = rcSegment.iFrameRcvd == rcSegment.iNumFrames;
+
+    Bool flush = false;
+    if (!bRead)
+    {
+      flush = true;
+      bEos = true;
+      rcSegment.iFrameRcvd--;
+      rcEncTop.setFramesToBeEncoded(rcSegment.iFrameRcvd);
+    }
+
+#if VCEG_AZ07_BAC_ADAPT_WDOW || VCEG_AZ07_INIT_PREVFRAME
+    rcEncTop.encode( bEos, flush ? 0 : pcPicYuvOrg, flush ? 0 : pcPicYuvTrueOrg, snrCSC, rcSegment.cListPicYuvRec, outputAccessUnits, iNumEncoded, rcSegment.pcStats);
+#else
+    rcEncTop.encode( bEos, flush ? 0 : pcPicYuvOrg, flush ? 0 : pcPicYuvTrueOrg, snrCSC, rcSegment.cListPicYuvRec, outputAccessUnits, iNumEncoded );
+#endif
+    cInputPrefetch.releasePicture();
+
+    if ( iNumEncoded > 0 && m_pchReconFile )
+    {
+      // the buffers of the list are reused, the frames are kept until the segment is joined
+      TComList<TComPicYuv*>::iterator iterPicYuvRec = rcSegment.cListPicYuvRec.end();
+      std::advance( iterPicYuvRec, -iNumEncoded );
+      for ( ; iterPicYuvRec != rcSegment.cListPicYuvRec.end(); iterPicYuvRec++ )
+      {
+        TComPicYuv* pcRecon = new TComPicYuv;
+#if JVET_C0024_QTBT
+        pcRecon->create( m_iSourceWidth, m_iSourceHeight, m_chromaFormatIDC, m_uiCTUSize, m_uiCTUSize, m_uiMaxTotalCUDepth, true );
+#else
+        pcRecon->create( m_iSourceWidth, m_iSourceHeight, m_chromaFormatIDC, m_uiMaxCUWidth, m_uiMaxCUHeight, m_uiMaxTotalCUDepth, true );
+#endif
+        (*iterPicYuvRec)->copyToPic( pcRecon );
+        rcSegment.cRecon.push_back( pcRecon );
+      }
+    }
+
+    if ( iNumEncoded > 0 )
+    {
+      list<AccessUnit>::const_iterator it = outputAccessUnits.begin();
+      for ( Int i = 0; i < iNumEncoded && it != outputAccessUnits.end(); i++, it++ )
+      {
+        writeAnnexB( rcSegment.cBitstream, *it );
+      }
+      outputAccessUnits.clear();
+    }
+  }
+  cInputPrefetch.stop();
+
+  for ( UInt i = 0; i <= m_inputPrefetch; i++ )
+  {
+    cPicYuvOrg[i]->destroy();
+    delete cPicYuvOrg[i];
+    cPicYuvTrueOrg[i]->destroy();
+    delete cPicYuvTrueOrg[i];
+  }
 }
 
 /** 
@@ -792,16 +1078,17 @@ Void TAppEncTop::xDeleteBuffer( )
   \param iNumEncoded    number of encoded frames
   \param accessUnits    list of access units to be written
  */
-Void TAppEncTop::xWriteOutput(std::ostream& bitstreamFile, Int iNumEncoded, const std::list<AccessUnit>& accessUnits)
+Void TAppEncTop::xWriteOutput(std::ostream& bitstreamFile, Int iNumEncoded, std::list<AccessUnit>& accessUnits)
 {
   const InputColourSpaceConversion ipCSC = (!m_outputInternalColourSpace) ? m_inputColourSpaceConvert : IPCOLOURSPACE_UNCHANGED;
+  Int numAccessUnits = iNumEncoded;
 
   if (m_isField)
   {
     //Reinterlace fields
     Int i;
     TComList<TComPicYuv*>::iterator iterPicYuvRec = m_cListPicYuvRec.end();
-    list<AccessUnit>::const_iterator iterBitstream = accessUnits.begin();
+    const TVideoIOYuvWriter::WriteParams cParams = { ipCSC, m_confWinLeft, m_confWinRight, m_confWinTop, m_confWinBottom, NUM_CHROMA_FORMAT, false };
 
     for ( i = 0; i < iNumEncoded; i++ )
     {
@@ -815,24 +1102,17 @@ Void TAppEncTop::xWriteOutput(std::ostream& bitstreamFile, Int iNumEncoded, cons
 
       if (m_pchReconFile)
       {
-        m_cTVideoIOYuvReconFile.write( pcPicYuvRecTop, pcPicYuvRecBottom, ipCSC, m_confWinLeft, m_confWinRight, m_confWinTop, m_confWinBottom, NUM_CHROMA_FORMAT, m_isTopFieldFirst );
+        m_cOutputWriter.write( &m_cTVideoIOYuvReconFile, pcPicYuvRecTop, pcPicYuvRecBottom, cParams, m_isTopFieldFirst );
       }
-
-      const AccessUnit& auTop = *(iterBitstream++);
-      const vector<UInt>& statsTop = writeAnnexB(bitstreamFile, auTop);
-      rateStatsAccum(auTop, statsTop);
-
-      const AccessUnit& auBottom = *(iterBitstream++);
-      const vector<UInt>& statsBottom = writeAnnexB(bitstreamFile, auBottom);
-      rateStatsAccum(auBottom, statsBottom);
     }
+    numAccessUnits = iNumEncoded/2*2;
   }
   else
   {
     Int i;
 
     TComList<TComPicYuv*>::iterator iterPicYuvRec = m_cListPicYuvRec.end();
-    list<AccessUnit>::const_iterator iterBitstream = accessUnits.begin();
+    const TVideoIOYuvWriter::WriteParams cParams = { ipCSC, m_confWinLeft, m_confWinRight, m_confWinTop, m_confWinBottom, NUM_CHROMA_FORMAT, m_bClipOutputVideoToRec709Range };
 
     for ( i = 0; i < iNumEncoded; i++ )
     {
@@ -844,15 +1124,26 @@ Void TAppEncTop::xWriteOutput(std::ostream& bitstreamFile, Int iNumEncoded, cons
       TComPicYuv*  pcPicYuvRec  = *(iterPicYuvRec++);
       if (m_pchReconFile)
       {
-        m_cTVideoIOYuvReconFile.write( pcPicYuvRec, ipCSC, m_confWinLeft, m_confWinRight, m_confWinTop, m_confWinBottom,
-            NUM_CHROMA_FORMAT, m_bClipOutputVideoToRec709Range  );
+        m_cOutputWriter.write( &m_cTVideoIOYuvReconFile, pcPicYuvRec, cParams );
       }
-
-      const AccessUnit& au = *(iterBitstream++);
-      const vector<UInt>& stats = writeAnnexB(bitstreamFile, au);
-      rateStatsAccum(au, stats);
     }
   }
+
+  // the access units move to the writer, which writes them and accumulates the rate statistics
+  std::shared_ptr< std::list<AccessUnit> > pcAccessUnits( new std::list<AccessUnit> );
+  list<AccessUnit>::iterator iterBitstream = accessUnits.begin();
+  std::advance( iterBitstream, std::min<size_t>( numAccessUnits, accessUnits.size() ) );
+  pcAccessUnits->splice( pcAccessUnits->end(), accessUnits, accessUnits.begin(), iterBitstream );
+
+  std::ostream* pcBitstreamFile = &bitstreamFile;
+  m_cOutputWriter.post( [this, pcBitstreamFile, pcAccessUnits]()
+  {
+    for ( list<AccessUnit>::const_iterator it = pcAccessUnits->begin(); it != pcAccessUnits->end(); it++ )
+    {
+      const vector<UInt>& stats = writeAnnexB(*pcBitstreamFile, *it);
+      rateStatsAccum(*it, stats);
+    }
+  } );
 }
 
 /**
@@ -865,31 +1156,9 @@ Void TAppEncTop::rateStatsAccum(const AccessUnit& au, const std::vector<UInt>& a
 
   for (; it_au != au.end(); it_au++, it_stats++)
   {
-    switch ((*it_au)->m_nalUnitType)
+    if (isEssentialNalUnit((*it_au)->m_nalUnitType))
     {
-    case NAL_UNIT_CODED_SLICE_TRAIL_R:
-    case NAL_UNIT_CODED_SLICE_TRAIL_N:
-    case NAL_UNIT_CODED_SLICE_TSA_R:
-    case NAL_UNIT_CODED_SLICE_TSA_N:
-    case NAL_UNIT_CODED_SLICE_STSA_R:
-    case NAL_UNIT_CODED_SLICE_STSA_N:
-    case NAL_UNIT_CODED_SLICE_BLA_W_LP:
-    case NAL_UNIT_CODED_SLICE_BLA_W_RADL:
-    case NAL_UNIT_CODED_SLICE_BLA_N_LP:
-    case NAL_UNIT_CODED_SLICE_IDR_W_RADL:
-    case NAL_UNIT_CODED_SLICE_IDR_N_LP:
-    case NAL_UNIT_CODED_SLICE_CRA:
-    case NAL_UNIT_CODED_SLICE_RADL_N:
-    case NAL_UNIT_CODED_SLICE_RADL_R:
-    case NAL_UNIT_CODED_SLICE_RASL_N:
-    case NAL_UNIT_CODED_SLICE_RASL_R:
-    case NAL_UNIT_VPS:
-    case NAL_UNIT_SPS:
-    case NAL_UNIT_PPS:
       m_essentialBytes += *it_stats;
-      break;
-    default:
-      break;
     }
 
     m_totalBytes += *it_stats;
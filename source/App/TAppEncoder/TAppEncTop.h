@@ -40,9 +40,13 @@
 
 #include <list>
 #include <ostream>
+#include <sstream>
+#include <mutex>
 
 #include "TLibEncoder/TEncTop.h"
 #include "TLibVideoIO/TVideoIOYuv.h"
+#include "TLibVideoIO/TVideoIOYuvPrefetch.h"
+#include "TLibVideoIO/TVideoIOYuvWriter.h"
 #include "TLibCommon/AccessUnit.h"
 #include "TAppEncCfg.h"
 
@@ -61,6 +65,7 @@ private:
   TEncTop                    m_cTEncTop;                    ///< encoder class
   TVideoIOYuv                m_cTVideoIOYuvInputFile;       ///< input YUV file
   TVideoIOYuv                m_cTVideoIOYuvReconFile;       ///< output reconstruction file
+  TVideoIOYuvWriter          m_cOutputWriter;               ///< writer of the reconstruction and the bitstream
 #if VCEG_AZ07_BAC_ADAPT_WDOW || VCEG_AZ07_INIT_PREVFRAME
   TComStats*                 m_apcStats;                    ///< class
 #endif  
@@ -72,6 +77,21 @@ private:
   UInt m_essentialBytes;
   UInt m_totalBytes;
 
+  /// one intra period of --parallel-segments, encoded by its own encoder into its own bitstream
+  struct Segment
+  {
+    TEncTop*                 pcEncTop;
+#if VCEG_AZ07_BAC_ADAPT_WDOW || VCEG_AZ07_INIT_PREVFRAME
+    TComStats*               pcStats;
+#endif
+    TComList<TComPicYuv*>    cListPicYuvRec;
+    std::vector<TComPicYuv*> cRecon;                        ///< with a reconstruction file: copies of the reconstructed frames in output order
+    std::ostringstream       cBitstream;
+    UInt                     uiFirstFrame;                  ///< first frame of the segment in the input file
+    Int                      iNumFrames;                    ///< frames of the segment, the last one is the first of the next segment
+    Int                      iFrameRcvd;                    ///< frames read, fewer than iNumFrames at the end of the input file
+  };
+
 protected:
   // initialization
   Void  xCreateLib        ();                               ///< create files & encoder class
@@ -80,13 +100,19 @@ protected:
   Void  xDestroyLib       ();                               ///< destroy encoder class
 
   /// obtain required buffers
-  Void xGetBuffer(TComPicYuv*& rpcPicYuvRec);
+  Void xGetBuffer(TComPicYuv*& rpcPicYuvRec)                { xGetBuffer( m_cListPicYuvRec, rpcPicYuvRec ); }
+  Void xGetBuffer(TComList<TComPicYuv*>& rcListPicYuvRec, TComPicYuv*& rpcPicYuvRec);
 
   /// delete allocated buffers
-  Void  xDeleteBuffer     ();
+  Void  xDeleteBuffer     ()                                { xDeleteBuffer( m_cListPicYuvRec ); }
+  Void  xDeleteBuffer     (TComList<TComPicYuv*>& rcListPicYuvRec);
+
+  // encoding of the intra period segments (--parallel-segments)
+  Void  xEncodeSegments   (std::ostream& bitstreamFile);    ///< encodes the segments concurrently and joins them into bitstreamFile as parcat does
+  Void  xEncodeSegment    (Segment& rcSegment, std::mutex& rcInputMutex); ///< encodes one segment, reading the input file under rcInputMutex
 
   // file I/O
-  Void xWriteOutput(std::ostream& bitstreamFile, Int iNumEncoded, const std::list<AccessUnit>& accessUnits); ///< write bitstream to file
+  Void xWriteOutput(std::ostream& bitstreamFile, Int iNumEncoded, std::list<AccessUnit>& accessUnits); ///< queue bitstream and reconstruction for writing, the access units are moved
   Void rateStatsAccum(const AccessUnit& au, const std::vector<UInt>& stats);
   Void printRateSummary();
   Void printChromaFormat();
@@ -48,38 +48,14 @@
 #if PIP
 #include <algorithm>
 #include "TLibCommon\TComDataCU.h"
-Int  AllCUCount = 0;
-Int	 PIPValudCUCount = 0;
-Int	 PIPCUcount = 0;
 Int CBiter;
 Bool CBloopEnable = false;
 Bool LGB4x8 = true, LGB8x4 = true, LGB8x8 = true, LGB4x4 = true;
-int spQ = 20;
-int spQ22 = 8;
-int spQ27 = 16;
-int spQ32 = 16;
-int spQ37 = 32;
 int SP_QOFFSET;
 bool multipred = false;
 
-// =================
-int offset4x4 = 0;
-int offset4x8 = 0;
-int offset8x4 = 0;
-int offset8x8 = 0;
-// =================
-
-
 Bool SpatialCodeCoeffNxN = false;
-Bool SpatialCodeCoeffNxN_2 = false;
-TCoeff TMPSpR1[16] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
-Int cbfStats[4] = { 0, 0, 0, 0 };
-
 
-Double	totalPIPbits = 0;
-Double	totalAllbits = 0;
-
-int							deltaSQP;		// -6, -3, +3, +6
 int							combIdx = 23;	// between 0 and 23 for 24 different combination
 
 
@@ -327,11 +303,6 @@ int cbf2x2BlMap8x8[16*4] = {
 	54, 55, 62, 63 };
 #endif
 
-Bool tmpFlag = false;
-UInt							Bits1=0, Bits2=0;
-Bool							maxExceeded = false;
-UInt								sigCnt = 0;
-UInt							EMTlog = 0;
 #endif
 
 // ====================================================================================================================
@@ -398,14 +369,6 @@ int main(int argc, char* argv[])
 #endif
 		TAppEncTop  cTAppEncTop;
 
-		// print information
-		fprintf(stdout, "\n");
-		fprintf(stdout, "HM software: Encoder Version [%s] (including RExt)", NV_VERSION);
-		fprintf(stdout, NVM_ONOS);
-		fprintf(stdout, NVM_COMPILEDBY);
-		fprintf(stdout, NVM_BITS);
-		fprintf(stdout, "\n\n");
-
 		// create application encoder class
 		cTAppEncTop.create();
 
@@ -427,6 +390,14 @@ int main(int argc, char* argv[])
 			return 1;
 		}
 
+		// print information (after the configuration: a reconstruction on stdout sends it to stderr)
+		fprintf(stdout, "\n");
+		fprintf(stdout, "HM software: Encoder Version [%s] (including RExt)", NV_VERSION);
+		fprintf(stdout, NVM_ONOS);
+		fprintf(stdout, NVM_COMPILEDBY);
+		fprintf(stdout, NVM_BITS);
+		fprintf(stdout, "\n\n");
+
 #if PRINT_MACRO_VALUES
 		printMacroSettings();
 #endif
@@ -447,8 +418,13 @@ int main(int argc, char* argv[])
 		printf("\n Total Time: %12.3f sec.\n", dResult);
 
 #if PIP	
+		TComPIPContext& rcPIPContext = cTAppEncTop.getTEncTop().getPIPContext();
+		TComPIPStats&   rcPIPStats   = rcPIPContext.getTotalStats();
 		if (txtWrite)
 		{
+			Int***  Codebooks        = rcPIPContext.getCodebooks();
+			Int***  nextCodebooks    = rcPIPContext.getNextCodebooks();
+			Int**   nextCodebooksCnt = rcPIPContext.getNextCodebooksCnt();
 			Char curOutAddr[512], buf[20];
 			FILE* outCB;
 			int base = log2((int)CUMAX) - 1, w, h, i, j, r, v, index, emptyCnt;
@@ -518,9 +494,9 @@ int main(int argc, char* argv[])
 					}
 					fclose(outCB);
 				}
-			AllCUCount = 0;
-			PIPValudCUCount = 0;
-			PIPCUcount = 0;
+			rcPIPStats.allCUCount = 0;
+			rcPIPStats.validCUCount = 0;
+			rcPIPStats.pipCUCount = 0;
 			for (int line = 0; line < 5; line++)
 			{
 				for (int sym = 0; sym < 150; sym++)
@@ -531,14 +507,10 @@ int main(int argc, char* argv[])
 
 
 
-		// print out CBF stats 
-		fprintf(stdout, "JEM blocks count: %6d, CBF1 rate: %f\nPIP blocks count: %6d, CBF1 rate: %f\n", cbfStats[0], (double)cbfStats[2] / (double)cbfStats[0], cbfStats[1], (double)cbfStats[3] / (double)cbfStats[1]);
-		fprintf(stdout, "Total PIP Bits: %f\nTotal All Bits: %f\n", totalPIPbits, totalAllbits);
-
 		fout = fopen("log2.txt", "a");
 		if (fout)
 		{
-			fprintf(fout, "\n Final: \n%10d\t%10d", (Int)totalPIPbits, (Int)totalAllbits);
+			fprintf(fout, "\n Final: \n%10d\t%10d", (Int)rcPIPStats.totalPIPbits, (Int)rcPIPStats.totalAllbits);
 			fclose(fout);
 		}
 
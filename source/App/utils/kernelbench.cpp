@@ -0,0 +1,549 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2015, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     kernelbench.cpp
+    \brief    checks the SIMD kernels of the codec against their reference loops and prints their speed
+*/
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "TLibCommon/TComEmulationPrevention.h"
+#include "TLibCommon/TComKLTBasis.h"
+#include "TLibCommon/TComPIPDPCM.h"
+#include "TLibCommon/TComSpatialQuant.h"
+#include "TAppCommon/program_options_lite.h"
+
+using namespace std;
+namespace po = df::program_options_lite;
+
+// ====================================================================================================================
+// Emulation prevention
+// ====================================================================================================================
+
+/// the byte loop of convertPayloadToRBSP
+static size_t xRemoveRef( std::vector<uint8_t>& rBuf, std::vector<UInt>& rLocations )
+{
+  UInt zeroCount = 0;
+  UInt pos       = 0;
+  std::vector<uint8_t>::iterator itRead, itWrite;
+  for( itRead = itWrite = rBuf.begin(); itRead != rBuf.end(); itRead++, itWrite++, pos++ )
+  {
+    if( zeroCount == 2 && *itRead == 0x03 )
+    {
+      rLocations.push_back( pos );
+      pos++;
+      itRead++;
+      zeroCount = 0;
+      if( itRead == rBuf.end() )
+      {
+        break;
+      }
+    }
+    zeroCount = ( *itRead == 0x00 ) ? zeroCount + 1 : 0;
+    *itWrite  = *itRead;
+  }
+  return size_t( itWrite - rBuf.begin() );
+}
+
+/// the byte loop of write(ostream&, OutputNALUnit&)
+static size_t xInsertRef( const std::vector<uint8_t>& rRbsp, std::vector<uint8_t>& rOut )
+{
+  size_t outputAmount = 0;
+  Int    zeroCount    = 0;
+  for( std::vector<uint8_t>::const_iterator it = rRbsp.begin(); it != rRbsp.end(); it++ )
+  {
+    const uint8_t v = *it;
+    if( zeroCount == 2 && v <= 3 )
+    {
+      rOut[outputAmount++] = 0x03;
+      zeroCount = 0;
+    }
+    zeroCount = v == 0 ? zeroCount + 1 : 0;
+    rOut[outputAmount++] = v;
+  }
+  if( zeroCount > 0 )
+  {
+    rOut[outputAmount++] = 0x03;
+  }
+  return outputAmount;
+}
+
+/// checks the emulation prevention kernels against the byte loops and prints their throughput for several
+/// zero densities
+static Void xBenchEmulationPrevention()
+{
+  typedef std::chrono::high_resolution_clock Clock;
+  static const Int  zeroPer256[5] = { 0, 1, 16, 64, 128 };   ///< probability of a zero byte, in 1/256 (1: about uniform bytes)
+  static const Int  numRuns       = 64;
+  const size_t      size          = 1 << 20;
+
+  std::vector<uint8_t> rbsp( size ), nal( TComEmulationPrevention::maxInsertSize( size ) ), refNal( nal.size() ), buf, refBuf;
+  std::vector<UInt>    locations, refLocations;
+  UInt seed = 1;
+
+  printf( "\nEmulation prevention: GB/s of RBSP inserted / NAL unit removed, 1 MB payloads (byte loop -> kernel)\n" );
+  for( Int d = 0; d < 5; d++ )
+  {
+    for( size_t i = 0; i < size; i++ )
+    {
+      seed = seed * 1103515245 + 12345;
+      const UInt r = seed >> 16;
+      rbsp[i] = ( r & 0xff ) < UInt( zeroPer256[d] ) ? 0 : uint8_t( 1 + ( ( r >> 8 ) % 255 ) );
+    }
+
+    Double seconds[4] = { 0, 0, 0, 0 };
+    size_t nalSize = 0, refNalSize = 0, rbspSize = 0, refRbspSize = 0;
+    for( Int run = 0; run < numRuns; run++ )
+    {
+      Clock::time_point t0 = Clock::now();
+      refNalSize = xInsertRef( rbsp, refNal );
+      Clock::time_point t1 = Clock::now();
+      nalSize = TComEmulationPrevention::insertThreeBytes( &nal[0], &rbsp[0], size );
+      Clock::time_point t2 = Clock::now();
+
+      refBuf.assign( refNal.begin(), refNal.begin() + refNalSize );
+      refLocations.clear();
+      Clock::time_point t3 = Clock::now();
+      refRbspSize = xRemoveRef( refBuf, refLocations );
+      Clock::time_point t4 = Clock::now();
+      buf.resize( nalSize );
+      locations.clear();
+      Clock::time_point t5 = Clock::now();
+      rbspSize = TComEmulationPrevention::removeThreeBytes( &buf[0], &nal[0], nalSize, locations );
+      Clock::time_point t6 = Clock::now();
+
+      seconds[0] += std::chrono::duration<Double>( t1 - t0 ).count();
+      seconds[1] += std::chrono::duration<Double>( t2 - t1 ).count();
+      seconds[2] += std::chrono::duration<Double>( t4 - t3 ).count();
+      seconds[3] += std::chrono::duration<Double>( t6 - t5 ).count();
+    }
+
+    const Bool bMatch = nalSize == refNalSize && !memcmp( &nal[0], &refNal[0], nalSize )
+                     && rbspSize == refRbspSize && !memcmp( &buf[0], &refBuf[0], rbspSize ) && locations == refLocations;
+    const Double gb = Double( numRuns ) * size / 1e9;
+    printf( "  zeros %3d/256: %6d three bytes  insert %6.2f -> %6.2f  remove %6.2f -> %6.2f  %s\n",
+            zeroPer256[d], Int( locations.size() ), gb / seconds[0], gb / seconds[1], gb / seconds[2], gb / seconds[3],
+            bMatch ? "match" : "MISMATCH" );
+  }
+}
+
+#if VCEG_AZ08_KLT_COMMON && KLT_DETERMINISTIC_BASIS
+// ====================================================================================================================
+// KLT basis
+// ====================================================================================================================
+
+/// checks the eigen decomposition on random candidates and prints the time of the derivations per block
+/// size and number of candidates
+static Void xBenchKLTBasis()
+{
+  static const Int blkSizes[4]    = { 4, 8, 16, 32 };
+  static const Int candiNums[5]   = { 8, 16, 32, 64, MAX_CANDI_NUM };
+  static const Int workPerSize[4] = { 4000, 400, 100, 30 };      ///< derivations of 100 candidates timed per size
+  const Int        maxDim         = blkSizes[3] * blkSizes[3];
+
+  TComKLTBasis        basis;
+  std::vector<Short>  samples( MAX_CANDI_NUM * maxDim );
+  std::vector<Short*> rows( MAX_CANDI_NUM );
+  std::vector<Short>  basisBuf[2];
+  std::vector<Short*> basisRows[2];
+  std::vector<Int>    gramBuf( maxDim * maxDim );
+  std::vector<Double> matrix( maxDim * maxDim ), values( maxDim ), vectors( maxDim * maxDim );
+  for( Int b = 0; b < 2; b++ )
+  {
+    basisBuf[b].resize( maxDim * maxDim );
+    basisRows[b].resize( maxDim );
+    for( Int r = 0; r < maxDim; r++ )
+    {
+      basisRows[b][r] = &basisBuf[b][r * maxDim];
+    }
+  }
+  for( Int k = 0; k < MAX_CANDI_NUM; k++ )
+  {
+    rows[k] = &samples[k * maxDim];
+  }
+  UInt seed = 1;
+
+  printf( "\nKLT basis: time per derivation (us), eigen decomposition share, eigen residual and orthogonality\n" );
+  for( Int s = 0; s < 4; s++ )
+  {
+    const Int  blkSize = blkSizes[s];
+    const Int  dim     = blkSize * blkSize;
+    const Bool bGram   = blkSize >= 16;                      ///< the split of TComTrQuant::deriveKLT
+    for( Int n = 0; n < 5; n++ )
+    {
+      const Int numSamples = candiNums[n];
+      const Int order      = bGram ? numSamples : dim;
+      const Int runs       = std::max( 1, workPerSize[s] * MAX_CANDI_NUM / numSamples );
+
+      // residuals of a smooth gradient of random direction and strength plus noise, as left by a prediction
+      for( Int k = 0; k < numSamples; k++ )
+      {
+        seed = seed * 1103515245 + 12345;
+        const Int gx = Int( ( seed >> 8 ) % 9 ) - 4;
+        seed = seed * 1103515245 + 12345;
+        const Int gy = Int( ( seed >> 8 ) % 9 ) - 4;
+        for( Int y = 0; y < blkSize; y++ )
+        {
+          for( Int x = 0; x < blkSize; x++ )
+          {
+            seed = seed * 1103515245 + 12345;
+            rows[k][y * blkSize + x] = Short( gx * ( 2 * x - blkSize ) + gy * ( 2 * y - blkSize ) + Int( ( seed >> 16 ) % 33 ) - 16 );
+          }
+        }
+      }
+
+      // the same samples twice give the same basis
+      Bool bRepeatable = true;
+      for( Int b = 0; b < 2; b++ )
+      {
+        if( bGram )
+        {
+          basis.deriveFromGram( &rows[0], numSamples, blkSize, FORCE_BASIS_NUM, &basisRows[b][0] );
+        }
+        else
+        {
+          basis.deriveFromCovariance( &rows[0], numSamples, blkSize, &basisRows[b][0] );
+        }
+      }
+      for( Int r = 0; r < dim; r++ )
+      {
+        bRepeatable = bRepeatable && !memcmp( basisRows[0][r], basisRows[1][r], dim * sizeof( Short ) );
+      }
+
+      // max |A v - lambda v| relative to the largest eigenvalue, and max |v_i.v_j - delta_ij|
+      std::vector<const Short*> gramRows( order );
+      if( bGram )
+      {
+        TComKLTBasis::gram( &rows[0], numSamples, dim, &gramBuf[0] );
+      }
+      else
+      {
+        std::vector<Short> transposed( dim * numSamples );
+        for( Int d = 0; d < dim; d++ )
+        {
+          for( Int k = 0; k < numSamples; k++ )
+          {
+            transposed[d * numSamples + k] = rows[k][d];
+          }
+          gramRows[d] = &transposed[d * numSamples];
+        }
+        TComKLTBasis::gram( &gramRows[0], dim, numSamples, &gramBuf[0] );
+      }
+      for( Int i = 0; i < order * order; i++ )
+      {
+        matrix[i] = Double( gramBuf[i] );
+      }
+      basis.eigen( &matrix[0], order, &values[0], &vectors[0] );
+      Double residual = 0, orthogonality = 0;
+      for( Int k = 0; k < order; k++ )
+      {
+        const Double* v = &vectors[k * order];
+        for( Int i = 0; i < order; i++ )
+        {
+          Double av = 0;
+          for( Int j = 0; j < order; j++ )
+          {
+            av += gramBuf[i * order + j] * v[j];
+          }
+          residual = std::max( residual, fabs( av - values[k] * v[i] ) / fabs( values[0] ) );
+        }
+        for( Int l = 0; l <= k; l++ )
+        {
+          Double dot = 0;
+          for( Int i = 0; i < order; i++ )
+          {
+            dot += v[i] * vectors[l * order + i];
+          }
+          orthogonality = std::max( orthogonality, fabs( dot - ( k == l ? 1.0 : 0.0 ) ) );
+        }
+      }
+
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      for( Int run = 0; run < runs; run++ )
+      {
+        if( bGram )
+        {
+          basis.deriveFromGram( &rows[0], numSamples, blkSize, FORCE_BASIS_NUM, &basisRows[0][0] );
+        }
+        else
+        {
+          basis.deriveFromCovariance( &rows[0], numSamples, blkSize, &basisRows[0][0] );
+        }
+      }
+      const Double timeDerive = std::chrono::duration<Double, std::micro>( std::chrono::steady_clock::now() - start ).count() / runs;
+
+      start = std::chrono::steady_clock::now();
+      for( Int run = 0; run < runs; run++ )
+      {
+        for( Int i = 0; i < order * order; i++ )
+        {
+          matrix[i] = Double( gramBuf[i] );
+        }
+        basis.eigen( &matrix[0], order, &values[0], &vectors[0] );
+      }
+      const Double timeEigen = std::chrono::duration<Double, std::micro>( std::chrono::steady_clock::now() - start ).count() / runs;
+
+      printf( "%2dx%-2d %3d candidates (%s %4dx%-4d): %9.1f us, eigen %3.0f%%, residual %.1e, orthogonality %.1e%s\n",
+              blkSize, blkSize, numSamples, bGram ? "X X^T" : "X^T X", order, order, timeDerive,
+              100.0 * std::min( 1.0, timeEigen / timeDerive ), residual, orthogonality, bRepeatable ? "" : "  NOT REPEATABLE" );
+    }
+  }
+  printf( "\n" );
+}
+#endif
+
+#if PIP_DPCM_WAVEFRONT && COM16_C806_SIMD_OPT
+// ====================================================================================================================
+// PIP wavefront DPCM
+// ====================================================================================================================
+
+/// scalar DPCM of TComPrediction::DPCMPred and xPIPQuantizeDPCM (without NOISE_MARK), the reference of the benchmark
+static Void xQuantizeScalar( const Float* filter, const Int* qMap, Int startIdx, Int endIdx, Int width, Int height,
+                             Pel* predBuffer, Int* res, Pel* prediction, Int* spQR1, const Pel* piOrg, Int orgStride,
+                             Int qStep, Float* qMapCmp )
+{
+  const TComSpatialQuant spQuant( qStep );
+  Int stride = width + 1, row = startIdx / width, col = startIdx % width;
+  Int offset = ( row + 1 ) * stride + 1, offsetPP = row * width;
+  for( Int pos = startIdx; pos < endIdx; pos++ )
+  {
+    Pel A = predBuffer[offset + col - 1] + ( col ? res[offsetPP + col - 1] : 0 );
+    Pel B = predBuffer[offset + col - stride - 1] + ( col && row ? res[offsetPP + col - width - 1] : 0 );
+    Pel C = predBuffer[offset + col - stride] + ( row ? res[offsetPP + col - width] : 0 );
+    Pel D = col < width - 1 ? Pel( predBuffer[offset + col - stride + 1] + ( row ? res[offsetPP + col - width + 1] : 0 ) ) : C;
+    Pel Ap = col ? Pel( predBuffer[offset + col - 2] + ( col > 1 ? res[offsetPP + col - 2] : 0 ) ) : A;
+    Pel Cp = row ? Pel( predBuffer[offset + col - 2 * stride] + ( row > 1 ? res[offsetPP + col - 2 * width] : 0 ) ) : C;
+    Pel X;
+    if( !filter )
+    {
+      X = ( B >= std::max( A, C ) ? std::min( A, C ) : ( B <= std::min( A, C ) ? std::max( A, C ) : ( A + C - B ) ) );
+    }
+    else
+    {
+      X = filter[0] * A + filter[1] * B + filter[2] * C + filter[3] * D + filter[4] * Ap + filter[5] * Cp;
+    }
+    X = ClipA( X, COMPONENT_Y );
+    predBuffer[offset + col] = X;
+    prediction[row * width + col] = X;
+
+    if( qMap )
+    {
+      const Int qR = piOrg[row * orgStride + col] - X;
+      Int curQres = spQuant.level( abs( qR ), qMap[row * width + col] );
+      if( qMapCmp )
+      {
+        const Int curQresRnd = spQuant.roundLevel( abs( qR ) );
+        qMapCmp[row * width + col] = ( ( curQres != curQresRnd ) ? 1 : -1 ) * ( Float( abs( abs( qR ) - curQresRnd * qStep ) ) / Float( qStep ) );
+      }
+      curQres = std::min( curQres, COEFF_LIMIT ) * ( qR < 0 ? -1 : 1 ) * qStep;
+      res[offsetPP + col] = curQres;
+      spQR1[row * width + col] = curQres;
+    }
+
+    if( ++col == width )
+    {
+      col = 0;
+      row++;
+      offset += stride;
+      offsetPP += width;
+    }
+  }
+}
+
+/// checks the wavefront DPCM against the scalar loops on random blocks and prints the time per block
+static Void xBenchPIPDPCM()
+{
+  static const Int    MAX_SIZE    = TComPIPDPCM::MAX_SIZE;
+  static const Int    sizes[4][2] = { { 4, 4 }, { 4, 8 }, { 8, 4 }, { 8, 8 } };
+  static const Int    iterations  = 200000;
+  static const Float  filters[9][6] =
+  {
+    { 0.5, 0.5, 0.0, 0.0, 0.0, 0.0 }, { 0.0, 0.5, 0.5, 0.0, 0.0, 0.0 }, { 0.0, 0.0, 0.5, 0.5, 0.0, 0.0 },
+    { 1.0, 0.0, 0.0, 0.0, 0.0, 0.0 }, { 0.0, 1.0, 0.0, 0.0, 0.0, 0.0 }, { 0.0, 0.0, 1.0, 0.0, 0.0, 0.0 },
+    { 0.0, 0.0, 0.0, 1.0, 0.0, 0.0 }, { 2.0, 0.0, 0.0, 0.0, -1.0, 0.0 }, { 0.0, 0.0, 2.0, 0.0, 0.0, -1.0 }
+  };
+  // the clipping bounds of a 10-bit sequence
+  g_ClipParam.Y().m = 0;
+  g_ClipParam.Y().M = 1023;
+  const Int  maxVal = g_ClipParam.Y().M;
+  UInt       seed   = 1;
+  Int        mismatches = 0;
+
+  const Int  bufSize = ( MAX_SIZE + 1 ) * ( MAX_SIZE + 1 );
+  Pel   border[bufSize], bufRef[bufSize], bufWf[bufSize], predRef[MAX_SIZE * MAX_SIZE], predWf[MAX_SIZE * MAX_SIZE];
+  Pel   org[MAX_SIZE * MAX_SIZE], resPel[MAX_SIZE * MAX_SIZE];
+  Int   qMap[MAX_SIZE * MAX_SIZE], resRef[MAX_SIZE * MAX_SIZE], resWf[MAX_SIZE * MAX_SIZE], spRef[MAX_SIZE * MAX_SIZE], spWf[MAX_SIZE * MAX_SIZE];
+  Float cmpRef[MAX_SIZE * MAX_SIZE], cmpWf[MAX_SIZE * MAX_SIZE];
+
+  printf( "\nPIP wavefront DPCM: bit-exactness and time per block (scalar / wavefront, ns)\n" );
+  for( Int s = 0; s < 4; s++ )
+  {
+    const Int width = sizes[s][0], height = sizes[s][1], stride = width + 1, numPix = width * height;
+    Double timeRef[2] = { 0, 0 }, timeWf[2] = { 0, 0 };
+
+    for( Int predictor = 0; predictor < 10; predictor++ )
+    {
+      const Float* filter = predictor ? filters[predictor - 1] : NULL;
+      const Int    runs   = iterations / 10;
+
+      // random borders, residual, original and quantizer decisions of the same content for both paths
+      for( Int i = 0; i < bufSize; i++ )
+      {
+        seed = seed * 1103515245 + 12345;
+        border[i] = Pel( ( seed >> 8 ) % ( maxVal + 1 ) );
+      }
+      for( Int i = 0; i < numPix; i++ )
+      {
+        seed = seed * 1103515245 + 12345;
+        org[i]    = Pel( ( seed >> 8 ) % ( maxVal + 1 ) );
+        resPel[i] = Pel( Int( ( seed >> 20 ) % 65 ) - 32 );
+        qMap[i]   = Int( ( seed >> 4 ) % 4 ) - 1;
+      }
+      const Int qStep = 1 + Int( ( seed >> 12 ) % 60 );
+
+      // decoder: prediction from the residual
+      // the borders are never written and the inner pixels are all rewritten by every run
+      memcpy( bufRef, border, sizeof( bufRef ) );
+      memcpy( bufWf, border, sizeof( bufWf ) );
+      for( Int i = 0; i < numPix; i++ )
+      {
+        resRef[i] = resPel[i];
+      }
+      std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+      for( Int it = 0; it < runs; it++ )
+      {
+        xQuantizeScalar( filter, NULL, 0, numPix, width, height, bufRef, resRef, predRef, NULL, NULL, 0, 1, NULL );
+      }
+      std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+      for( Int it = 0; it < runs; it++ )
+      {
+        TComPIPDPCM::predict( filter, width, height, border + 1, border + stride, stride, resPel, predWf );
+      }
+      std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+      timeRef[0] += std::chrono::duration<Double, std::nano>( t1 - t0 ).count();
+      timeWf[0]  += std::chrono::duration<Double, std::nano>( t2 - t1 ).count();
+      mismatches += memcmp( predRef, predWf, sizeof( Pel ) * numPix ) != 0;
+
+      // encoder: prediction and spatial quantization of the whole block
+      t0 = std::chrono::steady_clock::now();
+      for( Int it = 0; it < runs; it++ )
+      {
+        xQuantizeScalar( filter, qMap, 0, numPix, width, height, bufRef, resRef, predRef, spRef, org, width, qStep, cmpRef );
+      }
+      t1 = std::chrono::steady_clock::now();
+      for( Int it = 0; it < runs; it++ )
+      {
+        TComPIPDPCM::quantize( filter, qMap, 0, numPix, width, height, bufWf, resWf, predWf, spWf, org, width, qStep, cmpWf );
+      }
+      t2 = std::chrono::steady_clock::now();
+      timeRef[1] += std::chrono::duration<Double, std::nano>( t1 - t0 ).count();
+      timeWf[1]  += std::chrono::duration<Double, std::nano>( t2 - t1 ).count();
+      mismatches += memcmp( bufRef, bufWf, sizeof( Pel ) * stride * ( height + 1 ) ) != 0;
+      mismatches += memcmp( predRef, predWf, sizeof( Pel ) * numPix ) != 0;
+      mismatches += memcmp( resRef, resWf, sizeof( Int ) * numPix ) != 0;
+      mismatches += memcmp( spRef, spWf, sizeof( Int ) * numPix ) != 0;
+      mismatches += memcmp( cmpRef, cmpWf, sizeof( Float ) * numPix ) != 0;
+
+      // encoder: re-quantization from every pixel on, as done by the spatial RDOQ
+      for( Int startIdx = 1; startIdx < numPix; startIdx++ )
+      {
+        qMap[startIdx] = ( qMap[startIdx] + 2 ) % 4 - 1;
+        xQuantizeScalar( filter, qMap, startIdx, numPix, width, height, bufRef, resRef, predRef, spRef, org, width, qStep, NULL );
+        TComPIPDPCM::quantize( filter, qMap, startIdx, numPix, width, height, bufWf, resWf, predWf, spWf, org, width, qStep, NULL );
+        mismatches += memcmp( resRef, resWf, sizeof( Int ) * numPix ) != 0;
+        mismatches += memcmp( predRef, predWf, sizeof( Pel ) * numPix ) != 0;
+      }
+    }
+    printf( "%dx%d  decoder %7.1f / %7.1f  encoder %7.1f / %7.1f\n", width, height,
+      timeRef[0] / iterations, timeWf[0] / iterations, timeRef[1] / iterations, timeWf[1] / iterations );
+  }
+  printf( "mismatches: %d\n\n", mismatches );
+}
+#endif
+
+Int main(Int argc, const char** argv)
+{
+  Bool do_help;
+  Bool emulationPrevention, kltBasis, pipDPCM;
+
+  po::Options opts;
+  opts.addOptions()
+  ("help", do_help, false, "this help text")
+  ("EmulationPrevention", emulationPrevention, true, "emulation_prevention_three_byte insertion and removal (TComEmulationPrevention)")
+  ("KLTBasis", kltBasis, true, "KLT basis derivation (TComKLTBasis)")
+  ("PIPDPCM", pipDPCM, true, "wavefront DPCM of the PIP blocks (TComPIPDPCM)")
+  ;
+
+  po::setDefaults(opts);
+  po::scanArgv(opts, argc, argv);
+
+  if (do_help)
+  {
+    po::doHelp(cout, opts);
+    return EXIT_SUCCESS;
+  }
+
+  if (emulationPrevention)
+  {
+    xBenchEmulationPrevention();
+  }
+#if VCEG_AZ08_KLT_COMMON && KLT_DETERMINISTIC_BASIS
+  if (kltBasis)
+  {
+    xBenchKLTBasis();
+  }
+#else
+  if (kltBasis)
+  {
+    printf("KLT basis: not compiled (KLT_DETERMINISTIC_BASIS 0)\n");
+  }
+#endif
+#if PIP_DPCM_WAVEFRONT && COM16_C806_SIMD_OPT
+  if (pipDPCM)
+  {
+    xBenchPIPDPCM();
+  }
+#else
+  if (pipDPCM)
+  {
+    printf("PIP wavefront DPCM: not compiled (PIP_DPCM_WAVEFRONT 0)\n");
+  }
+#endif
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,127 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2015, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     pipcbconv.cpp
+    \brief    converts the PIP text codebooks and training blocks into the binary container
+*/
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+
+#include "TLibCommon/TComPIPCodebookFile.h"
+#include "TAppCommon/program_options_lite.h"
+
+using namespace std;
+namespace po = df::program_options_lite;
+
+Int main(Int argc, const char** argv)
+{
+  Bool do_help;
+  string dir, filename_out;
+  Bool blocks;
+
+  po::Options opts;
+  opts.addOptions()
+  ("help", do_help, false, "this help text")
+  ("CodebookDir,d", dir, string("../../../CB/"), "directory of the text files (CB0iTQ/0_Q<qp>_CBf<n>_<h>x<w>.txt, Blocks<h>x<w>_<qp>_CBf<n>.txt)")
+  ("OutputFile,o", filename_out, string(""), "binary codebook file")
+  ("Blocks", blocks, true, "also store the training blocks")
+  ;
+
+  po::setDefaults(opts);
+  po::scanArgv(opts, argc, argv);
+
+  if (argc == 1 || do_help || filename_out.empty())
+  {
+    /* argc == 1: no options have been specified */
+    po::doHelp(cout, opts);
+    return EXIT_FAILURE;
+  }
+
+  // every QP and size found in the directory, W,H <= CUMAX
+  static const Int qps[] = { 22, 27, 32, 37 };
+  vector<TComPIPCodebookFile::Section> sections;
+  for (UInt q = 0; q < sizeof(qps) / sizeof(qps[0]); q++)
+  {
+    for (UInt h = 4; h <= CUMAX; h <<= 1)
+    {
+      for (UInt w = 4; w <= CUMAX; w <<= 1)
+      {
+        TComPIPCodebookFile::Section section;
+        const string cbName = TComPIPCodebookFile::textCodebookName(dir, qps[q], w, h);
+        if (TComPIPCodebookFile::readTextCodebook(cbName, qps[q], w, h, section))
+        {
+          printf("%s: %d vectors\n", cbName.c_str(), section.rows);
+          sections.push_back(section);
+        }
+        const string blName = TComPIPCodebookFile::textBlocksName(dir, qps[q], w, h);
+        if (blocks && TComPIPCodebookFile::readTextBlocks(blName, qps[q], w, h, section))
+        {
+          printf("%s: %d blocks\n", blName.c_str(), section.rows);
+          sections.push_back(section);
+        }
+      }
+    }
+  }
+
+  if (sections.empty())
+  {
+    fprintf(stderr, "No codebook found in `%s'\n", dir.c_str());
+    return EXIT_FAILURE;
+  }
+  if (!TComPIPCodebookFile::write(filename_out, sections))
+  {
+    fprintf(stderr, "Unable to write `%s'\n", filename_out.c_str());
+    return EXIT_FAILURE;
+  }
+
+  // read the container back through the mapping
+  TComPIPCodebookFile file;
+  if (!file.open(filename_out))
+  {
+    return EXIT_FAILURE;
+  }
+  for (size_t s = 0; s < sections.size(); s++)
+  {
+    UInt rows, rowLen;
+    const Short* pData = file.getSection(TComPIPCodebookFile::SectionKind(sections[s].kind), sections[s].qp, sections[s].width, sections[s].height, rows, rowLen);
+    if (!pData || rows != sections[s].rows || rowLen != sections[s].rowLen || (rows && memcmp(pData, &sections[s].data[0], rows * rowLen * sizeof(Short))))
+    {
+      fprintf(stderr, "Section %d differs in `%s'\n", (Int)s, filename_out.c_str());
+      return EXIT_FAILURE;
+    }
+  }
+  printf("%s: %d sections\n", filename_out.c_str(), (Int)sections.size());
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,165 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2015, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     pipcbtrain.cpp
+    \brief    trains a PIP codebook on the training blocks of one QP and block size
+*/
+
+#include <cstdlib>
+#include <cstdio>
+#include <ctime>
+
+#include "TLibCommon/TComPIPCodebookFile.h"
+#include "TLibCommon/TComPIPCodebookTrainer.h"
+#include "TAppCommon/program_options_lite.h"
+
+using namespace std;
+namespace po = df::program_options_lite;
+
+Int main(Int argc, const char** argv)
+{
+  Bool do_help;
+  string dir, filename_in, filename_out, init;
+  Int qp, width, height, numCodewords, threads, iterations, splitIterations;
+  Double threshold;
+
+  po::Options opts;
+  opts.addOptions()
+  ("help", do_help, false, "this help text")
+  ("CodebookDir,d", dir, string("../../../CB/"), "directory of the text training blocks and codebooks")
+  ("CodebookFile,i", filename_in, string(""), "binary codebook container (pipcbconv); its blocks are streamed from the mapping instead of read into memory")
+  ("OutputFile,o", filename_out, string(""), "trained codebook, text: one comma separated vector per line")
+  ("QP,q", qp, 27, "QP of the training blocks")
+  ("Width", width, 4, "block width")
+  ("Height", height, 4, "block height")
+  ("Codewords", numCodewords, 0, "codebook size, 0: CBf*W*H")
+  ("Init", init, string("split"), "initial codebook: split (LGB splitting from the mean) or codebook (the codebook of the QP and size)")
+  ("SplitIterations", splitIterations, 2, "iterations after each split")
+  ("Iterations", iterations, 20, "maximum number of iterations")
+  ("Threshold", threshold, 0.001, "stop when the distortion decreases by less than this fraction")
+  ("Threads,t", threads, 1, "training threads; the codebook does not depend on it")
+  ;
+
+  po::setDefaults(opts);
+  po::scanArgv(opts, argc, argv);
+
+  if (argc == 1 || do_help || filename_out.empty())
+  {
+    /* argc == 1: no options have been specified */
+    po::doHelp(cout, opts);
+    return EXIT_FAILURE;
+  }
+  if (width * height > TComPIPCodebookTrainer::MAX_SIZE || (width * height) % 8)
+  {
+    fprintf(stderr, "Unsupported block size %dx%d\n", width, height);
+    return EXIT_FAILURE;
+  }
+  if (!numCodewords)
+  {
+    numCodewords = CBf * width * height;
+  }
+
+  // training blocks and initial codebook
+  TComPIPCodebookFile file;
+  TComPIPCodebookFile::Section textBlocks, textCodebook;
+  const Short* blocks = NULL;
+  const Short* codebook = NULL;
+  UInt numBlocks = 0, rowLen = 0, numVectors = 0, vecLen = 0;
+  if (!filename_in.empty())
+  {
+    if (!file.open(filename_in))
+    {
+      fprintf(stderr, "Unable to map `%s'\n", filename_in.c_str());
+      return EXIT_FAILURE;
+    }
+    blocks   = file.getSection(TComPIPCodebookFile::SECTION_BLOCKS, qp, width, height, numBlocks, rowLen);
+    codebook = file.getSection(TComPIPCodebookFile::SECTION_CODEBOOK, qp, width, height, numVectors, vecLen);
+  }
+  else
+  {
+    if (TComPIPCodebookFile::readTextBlocks(TComPIPCodebookFile::textBlocksName(dir, qp, width, height), qp, width, height, textBlocks) && textBlocks.rows)
+    {
+      blocks    = &textBlocks.data[0];
+      numBlocks = textBlocks.rows;
+      rowLen    = textBlocks.rowLen;
+    }
+    if (init == "codebook" && TComPIPCodebookFile::readTextCodebook(TComPIPCodebookFile::textCodebookName(dir, qp, width, height), qp, width, height, textCodebook) && textCodebook.rows)
+    {
+      codebook   = &textCodebook.data[0];
+      numVectors = textCodebook.rows;
+      vecLen     = textCodebook.rowLen;
+    }
+  }
+  if (!blocks)
+  {
+    fprintf(stderr, "No training blocks of QP %d and size %dx%d\n", qp, width, height);
+    return EXIT_FAILURE;
+  }
+
+  TComPIPCodebookTrainer trainer;
+  trainer.create(width, height, numCodewords, threads);
+  const clock_t start = clock();
+  if (init == "codebook")
+  {
+    if (!codebook || numVectors < UInt(numCodewords) || vecLen != UInt(width * height))
+    {
+      fprintf(stderr, "No initial codebook of %d vectors for QP %d and size %dx%d\n", numCodewords, qp, width, height);
+      return EXIT_FAILURE;
+    }
+    trainer.initCodebook(codebook);
+  }
+  else
+  {
+    trainer.initBySplitting(blocks, numBlocks, rowLen, splitIterations);
+  }
+  const Double dist = trainer.train(blocks, numBlocks, rowLen, iterations, threshold);
+  printf("%dx%d QP %d: %u blocks, %d codewords, mean squared residual %.3f, %.1f s\n", width, height, qp, numBlocks, numCodewords, dist, Double(clock() - start) / CLOCKS_PER_SEC);
+
+  FILE* fp = fopen(filename_out.c_str(), "w");
+  if (!fp)
+  {
+    fprintf(stderr, "Unable to write `%s'\n", filename_out.c_str());
+    return EXIT_FAILURE;
+  }
+  for (Int c = 0; c < numCodewords; c++)
+  {
+    const Short* cw = trainer.getCodeword(c);
+    for (Int p = 0; p < width * height; p++)
+    {
+      fprintf(fp, "%d,", cw[p]);
+    }
+    fprintf(fp, "\n");
+  }
+  fclose(fp);
+  return EXIT_SUCCESS;
+}
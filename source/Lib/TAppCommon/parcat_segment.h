@@ -0,0 +1,69 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2015, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     parcat_segment.h
+    \brief    filtering of the segments of a parallel simulation (JVET-B0036) into one bitstream
+*/
+
+#ifndef __PARCAT_SEGMENT__
+#define __PARCAT_SEGMENT__
+
+#include <stdint.h>
+#include <vector>
+
+//! \ingroup TAppCommon
+//! \{
+
+namespace parcat
+{
+  /**
+   Find the beginning and end of a NAL (Network Abstraction Layer) unit in a byte buffer containing H264 bitstream data.
+   @param[in]   buf        the buffer
+   @param[in]   size       the size of the buffer
+   @param[out]  nal_start  the beginning offset of the nal
+   @param[out]  nal_end    the end offset of the nal
+   @return                 the length of the nal, or 0 if did not find start of nal, or -1 if did not find end of nal
+   */
+  int find_nal_unit(const uint8_t* buf, int size, int* nal_start, int* nal_end);
+
+  /**
+   Filter the bitstream of segment idx (1 for the first one) of a parallel simulation: the parameter sets, the IDR
+   picture and its suffix SEI of all the segments but the first are removed and the POCs continue the ones of the
+   previous segments. poc_base and last_idr_poc carry the numbering from one segment to the next, both start at 0.
+   */
+  std::vector<uint8_t> filter_segment(const std::vector<uint8_t> & v, int idx, int * poc_base, int * last_idr_poc);
+}
+
+//! \}
+
+#endif // __PARCAT_SEGMENT__
@@ -132,6 +132,7 @@ static const Int SEARCHRANGEINTRA =                                64; ///< Intr
 #if VCEG_AZ08_INTER_KLT
 static const Int SEARCHRANGE =                                     32; ///< (default 32) Search range for inter coding (-SEARCHRANGE,+SEARCHRANGE)
 static const Int SEARCH_SIZE =                                     ((SEARCHRANGE << 1) + 1)*((SEARCHRANGE << 1) + 1);
+static const Int KLT_SUBPEL_CACHE_TILES =                         256; ///< Budget of sub-pel tiles (TComSubPelCache) per reference picture
 #endif
 
 #if VCEG_AZ08_KLT_COMMON
@@ -167,6 +168,8 @@ static const Int MAX_TLAYER =                                       7; ///< Expl
 
 static const Int ADAPT_SR_SCALE =                                   1; ///< division factor for adaptive search range
 
+static const Int MAX_NUM_CTU_WORKERS =                             64; ///< max. number of CTU rows compressed concurrently (WppThreads)
+
 static const Int MAX_NUM_PICS_IN_SOP =                           1024;
 
 static const Int MAX_NESTING_NUM_OPS =                           1024;
@@ -600,7 +603,7 @@ inline void setOff(ClipParam &prm) {
     prm.isChromaActive=false;
 }
 
-extern ClipParam g_ClipParam;
+extern thread_local ClipParam g_ClipParam;   ///< clipping range of the picture being coded, set by each coding thread
 
 template <typename T> T ClipA(const T x, const ComponentID compID)
 {
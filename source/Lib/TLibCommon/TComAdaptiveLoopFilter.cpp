@@ -754,6 +754,10 @@ TComAdaptiveLoopFilter::TComAdaptiveLoopFilter()
   m_filterCoeffShort = NULL;
   m_alfClipTable = NULL;
   m_alfClipOffset = 0;
+#if FIX_TICKET12
+  m_bPendingRefresh = false;
+  m_iPocLastCRA = 0;
+#endif
 }
 
 Void TComAdaptiveLoopFilter:: xError(const char *text, int code)
@@ -3335,26 +3339,24 @@ Void TComAdaptiveLoopFilter::setAlfCtrlFlags(ALFParam *pAlfParam, TComDataCU *pc
 #if FIX_TICKET12
 Bool TComAdaptiveLoopFilter::refreshAlfTempPred( NalUnitType naluType , Int poc )
 {
-  static bool pendingRefresh = false;
-  static Int pocLastCRA = 0;
   Bool refresh = false;
 
-  if( pendingRefresh == true && pocLastCRA < poc )
+  if( m_bPendingRefresh == true && m_iPocLastCRA < poc )
   {
     refresh = true;
-    pendingRefresh = false;   
+    m_bPendingRefresh = false;   
   }
 
   if( NAL_UNIT_CODED_SLICE_BLA_W_LP <= naluType && naluType <= NAL_UNIT_CODED_SLICE_IDR_N_LP )
   {
     refresh = true;
-    pendingRefresh = true;
-    pocLastCRA = poc;
+    m_bPendingRefresh = true;
+    m_iPocLastCRA = poc;
   }
   else if( naluType == NAL_UNIT_CODED_SLICE_CRA )
   {
-    pendingRefresh = true;
-    pocLastCRA = poc;
+    m_bPendingRefresh = true;
+    m_iPocLastCRA = poc;
   }
 
   return( refresh );
@@ -181,6 +181,12 @@ public:
   // temporary picture buffer
   TComPicYuv*   m_pcTempPicYuv;                                                     ///< temporary picture buffer for ALF processing
 
+#if FIX_TICKET12
+  // refresh of the temporal prediction of the filters after an IRAP picture
+  Bool          m_bPendingRefresh;
+  Int           m_iPocLastCRA;
+#endif
+
 public:
   static const Int* m_pDepthIntTab[m_NO_TEST_FILT];
 #if JVET_C0038_GALF
@@ -62,6 +62,8 @@ TComOutputBitstream::~TComOutputBitstream()
 
 TComInputBitstream::TComInputBitstream()
 : m_fifo()
+, m_pView(NULL)
+, m_viewSize(0)
 , m_emulationPreventionByteLocation()
 , m_fifo_idx(0)
 , m_num_held_bits(0)
@@ -71,6 +73,8 @@ TComInputBitstream::TComInputBitstream()
 
 TComInputBitstream::TComInputBitstream(const TComInputBitstream &src)
 : m_fifo(src.m_fifo)
+, m_pView(src.m_pView)
+, m_viewSize(src.m_viewSize)
 , m_emulationPreventionByteLocation(src.m_emulationPreventionByteLocation)
 , m_fifo_idx(src.m_fifo_idx)
 , m_num_held_bits(src.m_num_held_bits)
@@ -90,6 +94,26 @@ Void TComInputBitstream::resetToStart()
   m_numBitsRead=0;
 }
 
+Void TComInputBitstream::setView( const uint8_t* pData, UInt size )
+{
+  assert(pData != NULL);
+  m_fifo.clear();
+  m_pView    = pData;
+  m_viewSize = size;
+  resetToStart();
+}
+
+std::vector<uint8_t>& TComInputBitstream::getFifo()
+{
+  if (m_pView)
+  {
+    m_fifo.assign(m_pView, m_pView + m_viewSize);
+    m_pView    = NULL;
+    m_viewSize = 0;
+  }
+  return m_fifo;
+}
+
 Char* TComOutputBitstream::getByteStream() const
 {
   return (Char*) &m_fifo.front();
@@ -290,14 +314,15 @@ Void TComInputBitstream::read (UInt uiNumberOfBits, UInt& ruiBits)
    */
   UInt aligned_word = 0;
   UInt num_bytes_to_load = (uiNumberOfBits - 1) >> 3;
-  assert(m_fifo_idx + num_bytes_to_load < m_fifo.size());
+  assert(m_fifo_idx + num_bytes_to_load < getBufferSize());
+  const uint8_t* pBuf = getBuffer();
 
   switch (num_bytes_to_load)
   {
-  case 3: aligned_word  = m_fifo[m_fifo_idx++] << 24;
-  case 2: aligned_word |= m_fifo[m_fifo_idx++] << 16;
-  case 1: aligned_word |= m_fifo[m_fifo_idx++] <<  8;
-  case 0: aligned_word |= m_fifo[m_fifo_idx++];
+  case 3: aligned_word  = pBuf[m_fifo_idx++] << 24;
+  case 2: aligned_word |= pBuf[m_fifo_idx++] << 16;
+  case 1: aligned_word |= pBuf[m_fifo_idx++] <<  8;
+  case 0: aligned_word |= pBuf[m_fifo_idx++];
   }
 
   /* resolve remainder bits */
@@ -360,15 +385,26 @@ TComInputBitstream *TComInputBitstream::extractSubstream( UInt uiNumBits )
   UInt uiNumBytes = uiNumBits/8;
   TComInputBitstream *pResult = new TComInputBitstream;
 
+  // a whole number of bytes at a byte position of a view is a view of the same memory
+  if (m_pView && m_num_held_bits == 0 && (uiNumBits & 0x7) == 0 && uiNumBytes <= m_viewSize - m_fifo_idx)
+  {
+    pResult->setView(m_pView + m_fifo_idx, uiNumBytes);
+    m_fifo_idx += uiNumBytes;
+    return pResult;
+  }
+
   std::vector<uint8_t> &buf = pResult->getFifo();
   buf.reserve((uiNumBits+7)>>3);
 
   if (m_num_held_bits == 0)
   {
     std::size_t currentOutputBufferSize=buf.size();
-    const UInt uiNumBytesToReadFromFifo = std::min<UInt>(uiNumBytes, (UInt)m_fifo.size() - m_fifo_idx);
+    const UInt uiNumBytesToReadFromFifo = std::min<UInt>(uiNumBytes, getBufferSize() - m_fifo_idx);
     buf.resize(currentOutputBufferSize+uiNumBytes);
-    memcpy(&(buf[currentOutputBufferSize]), &(m_fifo[m_fifo_idx]), uiNumBytesToReadFromFifo); m_fifo_idx+=uiNumBytesToReadFromFifo;
+    if (uiNumBytesToReadFromFifo)
+    {
+      memcpy(&(buf[currentOutputBufferSize]), getBuffer() + m_fifo_idx, uiNumBytesToReadFromFifo); m_fifo_idx+=uiNumBytesToReadFromFifo;
+    }
     if (uiNumBytesToReadFromFifo != uiNumBytes)
     {
       memset(&(buf[currentOutputBufferSize+uiNumBytesToReadFromFifo]), 0, uiNumBytes - uiNumBytesToReadFromFifo);
@@ -429,6 +465,7 @@ TComStats::TComStats()
 #if VCEG_AZ07_INIT_PREVFRAME
 #if VCEG_AZ07_INIT_PREVFRAME_FIX
     m_uiLastIPOC = 0;
+    m_bClearPrevFlag = false;
 #else
     m_uiLastIPOC = -1;
 #endif
@@ -81,6 +81,9 @@ public:
 #if VCEG_AZ07_INIT_PREVFRAME
   UShort** m_uiCtxProbIdx[2][NUM_QP_PROB]; //[B/PSlice][QPindex][NUM_LCU][MAX_NUM_CTX_MOD]
   UInt     m_uiLastIPOC;
+#if VCEG_AZ07_INIT_PREVFRAME_FIX
+  Bool     m_bClearPrevFlag;                                    ///< the stored contexts were reset after the last IRAP picture
+#endif
 #endif
 };
 #endif
@@ -207,6 +210,8 @@ class TComInputBitstream
 {
 protected:
   std::vector<uint8_t> m_fifo; /// FIFO for storage of complete bytes
+  const uint8_t*       m_pView; /// bytes read instead of m_fifo, owned by the caller (NULL: read m_fifo)
+  UInt                 m_viewSize;
   std::vector<UInt>    m_emulationPreventionByteLocation;
 
   UInt m_fifo_idx; /// Read index into m_fifo
@@ -230,14 +235,14 @@ public:
   Void        read            ( UInt uiNumberOfBits, UInt& ruiBits );
   Void        readByte        ( UInt &ruiBits )
   {
-    assert(m_fifo_idx < m_fifo.size());
-    ruiBits = m_fifo[m_fifo_idx++];
+    assert(m_fifo_idx < getBufferSize());
+    ruiBits = getBuffer()[m_fifo_idx++];
   }
 
   Void        peekPreviousByte( UInt &byte )
   {
     assert(m_fifo_idx > 0);
-    byte = m_fifo[m_fifo_idx - 1];
+    byte = getBuffer()[m_fifo_idx - 1];
   }
 
   UInt        readOutTrailingBits ();
@@ -252,7 +257,7 @@ public:
   UInt read(UInt numberOfBits) { UInt tmp; read(numberOfBits, tmp); return tmp; }
   UInt     readByte() { UInt tmp; readByte( tmp ); return tmp; }
   UInt getNumBitsUntilByteAligned() { return m_num_held_bits & (0x7); }
-  UInt getNumBitsLeft() { return 8*((UInt)m_fifo.size() - m_fifo_idx) + m_num_held_bits; }
+  UInt getNumBitsLeft() { return 8*(getBufferSize() - m_fifo_idx) + m_num_held_bits; }
   TComInputBitstream *extractSubstream( UInt uiNumBits ); // Read the nominated number of bits, and return as a bitstream.
   UInt  getNumBitsRead() { return m_numBitsRead; }
   UInt readByteAlignment();
@@ -264,8 +269,20 @@ public:
   Void      clearEmulationPreventionByteLocation()                                   { m_emulationPreventionByteLocation.clear();          }
   Void      setEmulationPreventionByteLocation  ( const std::vector<UInt> &vec )     { m_emulationPreventionByteLocation = vec;            }
 
-  const std::vector<uint8_t> &getFifo() const { return m_fifo; }
-        std::vector<uint8_t> &getFifo()       { return m_fifo; }
+  /**
+   * Read size bytes of memory owned by the caller instead of the fifo, without copying them.
+   * The memory must outlive this bitstream and its copies.
+   */
+  Void setView( const uint8_t* pData, UInt size );
+  Bool isView() const { return m_pView != NULL; }
+
+  /** bytes being read: the view, or the fifo */
+  const uint8_t* getBuffer    () const { return m_pView ? m_pView : ( m_fifo.empty() ? NULL : &m_fifo.front() ); }
+  UInt           getBufferSize() const { return m_pView ? m_viewSize : UInt(m_fifo.size()); }
+
+  const std::vector<uint8_t> &getFifo() const { assert(!m_pView); return m_fifo; }
+  /** the fifo, for writing; a view is first copied into it */
+        std::vector<uint8_t> &getFifo();
 };
 
 //! \}
@@ -476,6 +476,19 @@ Void TComDataCU::create( ChromaFormat chromaFormatIDC, UInt uiNumPartition, UInt
 #endif
 }
 
+#if ADAPTIVE_QP_SELECTION && WPP_PARALLEL_CTU_ROWS
+Void TComDataCU::setArlCoeffBuffer( TCoeff* pcBuffer, ChromaFormat chromaFormatIDC, UInt uiWidth, UInt uiHeight )
+{
+  assert( m_ArlCoeffIsAliasedAllocation );
+  for( UInt comp = 0; comp < MAX_NUM_COMPONENT; comp++ )
+  {
+    const ComponentID compID = ComponentID(comp);
+    m_pcArlCoeff[compID] = pcBuffer;
+    pcBuffer += (uiWidth * uiHeight) >> (getComponentScaleX(compID, chromaFormatIDC) + getComponentScaleY(compID, chromaFormatIDC));
+  }
+}
+#endif
+
 Void TComDataCU::destroy()
 {
   // encoder-side buffer free
@@ -2365,6 +2378,170 @@ Void TComDataCU::copySameSizeCUFrom(TComDataCU* pcCU, UInt uiPartUnitIdx, UInt u
 
 #endif
 
+#if QTBT_PARALLEL_SPLIT
+/** Copies the whole state of a CTU, the descriptors and all the per-partition arrays of both channel
+ *  types but not the coefficients, into this CTU, which is created like the CTUs of TComPicSym.
+ *  A split task codes into such a copy, so the CTU of the picture is not written concurrently.
+ */
+Void TComDataCU::copyCUFrom( const TComDataCU* pcCU )
+{
+  const UInt numPart = pcCU->getPic()->getNumPartitionsInCtu();
+
+  m_pcPic              = pcCU->m_pcPic;
+  m_pcSlice            = pcCU->m_pcSlice;
+  m_ctuRsAddr          = pcCU->m_ctuRsAddr;
+  m_absZIdxInCtu       = pcCU->m_absZIdxInCtu;
+  m_uiCUPelX           = pcCU->m_uiCUPelX;
+  m_uiCUPelY           = pcCU->m_uiCUPelY;
+  m_uiNumPartition     = pcCU->m_uiNumPartition;
+  m_dTotalCost         = pcCU->m_dTotalCost;
+  m_uiTotalDistortion  = pcCU->m_uiTotalDistortion;
+  m_uiTotalBits        = pcCU->m_uiTotalBits;
+  m_uiTotalBins        = pcCU->m_uiTotalBins;
+  m_codedChromaQpAdj   = pcCU->m_codedChromaQpAdj;
+#if JVET_C0024_DELTA_QP_FIX
+  m_uiQuPartIdx        = pcCU->m_uiQuPartIdx;
+  m_QuLastCodedQP      = pcCU->m_QuLastCodedQP;
+  for( UInt ch = 0; ch < MAX_NUM_CHANNEL_TYPE; ch++ )
+  {
+    m_codedQP[ch]      = pcCU->m_codedQP[ch];
+  }
+#else
+  m_codedQP            = pcCU->m_codedQP;
+#endif
+#if JVET_C0024_BT_RMV_REDUNDANT
+  m_uiSplitConstrain   = pcCU->m_uiSplitConstrain;
+#endif
+#if JVET_C0024_PBINTRA_FAST
+  m_uiInterHAD         = pcCU->m_uiInterHAD;
+#endif
+
+  m_pCtuAboveLeft      = pcCU->m_pCtuAboveLeft;
+  m_pCtuAboveRight     = pcCU->m_pCtuAboveRight;
+  m_pCtuAbove          = pcCU->m_pCtuAbove;
+  m_pCtuLeft           = pcCU->m_pCtuLeft;
+
+  for( UInt ch = 0; ch < MAX_NUM_CHANNEL_TYPE; ch++ )
+  {
+#if JVET_C0024_DELTA_QP_FIX
+    memcpy( m_phQP[ch],              pcCU->m_phQP[ch],              sizeof( Char  ) * numPart );
+#endif
+#if JVET_C0024_QTBT
+    memcpy( m_puhDepth[ch],          pcCU->m_puhDepth[ch],          sizeof( UChar ) * numPart );
+    memcpy( m_puhWidth[ch],          pcCU->m_puhWidth[ch],          sizeof( UChar ) * numPart );
+    memcpy( m_puhHeight[ch],         pcCU->m_puhHeight[ch],         sizeof( UChar ) * numPart );
+    memcpy( m_puhBTSplitMode[ch][0], pcCU->m_puhBTSplitMode[ch][0], sizeof( UChar ) * numPart );
+    memcpy( m_puhBTSplitMode[ch][1], pcCU->m_puhBTSplitMode[ch][1], sizeof( UChar ) * numPart );
+#endif
+#if (VCEG_AZ05_ROT_TR || COM16_C1044_NSST) && JVET_C0024_QTBT
+    memcpy( m_ROTIdx[ch],            pcCU->m_ROTIdx[ch],            sizeof( Char  ) * numPart );
+#endif
+    memcpy( m_puhIntraDir[ch],       pcCU->m_puhIntraDir[ch],       sizeof( UChar ) * numPart );
+  }
+#if !JVET_C0024_DELTA_QP_FIX
+  memcpy( m_phQP,                    pcCU->m_phQP,                  sizeof( Char  ) * numPart );
+#endif
+#if !JVET_C0024_QTBT
+  memcpy( m_puhDepth,                pcCU->m_puhDepth,              sizeof( *m_puhDepth  ) * numPart );
+  memcpy( m_puhWidth,                pcCU->m_puhWidth,              sizeof( *m_puhWidth  ) * numPart );
+  memcpy( m_puhHeight,               pcCU->m_puhHeight,             sizeof( *m_puhHeight ) * numPart );
+  memcpy( m_pePartSize,              pcCU->m_pePartSize,            sizeof( Char  ) * numPart );
+  memcpy( m_puhTrIdx,                pcCU->m_puhTrIdx,              sizeof( UChar ) * numPart );
+#endif
+#if (VCEG_AZ05_ROT_TR || COM16_C1044_NSST) && !JVET_C0024_QTBT
+  memcpy( m_ROTIdx,                  pcCU->m_ROTIdx,                sizeof( Char  ) * numPart );
+#endif
+
+  memcpy( m_skipFlag,                pcCU->m_skipFlag,              sizeof( Bool  ) * numPart );
+#if VCEG_AZ05_INTRA_MPI
+  memcpy( m_MPIIdx,                  pcCU->m_MPIIdx,                sizeof( Char  ) * numPart );
+#endif
+#if COM16_C1046_PDPC_INTRA
+  memcpy( m_PDPCIdx,                 pcCU->m_PDPCIdx,               sizeof( Char  ) * numPart );
+#endif
+#if PIP
+  memcpy( m_PIPflag,                 pcCU->m_PIPflag,               sizeof( Char  ) * numPart );
+  memcpy( m_PIPCBidx,                pcCU->m_PIPCBidx,              sizeof( Int   ) * numPart );
+  memcpy( m_PIPCost,                 pcCU->m_PIPCost,               sizeof( Int   ) * numPart );
+  memcpy( m_JEMCost,                 pcCU->m_JEMCost,               sizeof( Int   ) * numPart );
+  memcpy( m_PIPBits,                 pcCU->m_PIPBits,               sizeof( Int   ) * numPart );
+  memcpy( m_JEMBits,                 pcCU->m_JEMBits,               sizeof( Int   ) * numPart );
+  memcpy( m_PIPDist,                 pcCU->m_PIPDist,               sizeof( Int   ) * numPart );
+  memcpy( m_JEMDist,                 pcCU->m_JEMDist,               sizeof( Int   ) * numPart );
+  memcpy( m_PIPspQIsChangedFlag,     pcCU->m_PIPspQIsChangedFlag,   sizeof( Char  ) * numPart );
+  memcpy( m_PIPspQChange,            pcCU->m_PIPspQChange,          sizeof( Char  ) * numPart );
+#endif
+  memcpy( m_pePredMode,              pcCU->m_pePredMode,            sizeof( Char  ) * numPart );
+  memcpy( m_CUTransquantBypass,      pcCU->m_CUTransquantBypass,    sizeof( Bool  ) * numPart );
+  memcpy( m_ChromaQpAdj,             pcCU->m_ChromaQpAdj,           sizeof( UChar ) * numPart );
+  memcpy( m_pbMergeFlag,             pcCU->m_pbMergeFlag,           sizeof( Bool  ) * numPart );
+  memcpy( m_puhMergeIndex,           pcCU->m_puhMergeIndex,         sizeof( UChar ) * numPart );
+#if COM16_C806_VCEG_AZ10_SUB_PU_TMVP
+  memcpy( m_peMergeType,             pcCU->m_peMergeType,           sizeof( UChar ) * numPart );
+#endif
+#if COM16_C806_OBMC
+  memcpy( m_OBMCFlag,                pcCU->m_OBMCFlag,              sizeof( Bool  ) * numPart );
+#endif
+#if COM16_C983_RSAF
+  memcpy( m_puhIntraFiltFlag,        pcCU->m_puhIntraFiltFlag,      sizeof( UChar ) * numPart );
+  memcpy( m_pbFiltFlagHidden,        pcCU->m_pbFiltFlagHidden,      sizeof( Bool  ) * numPart );
+#endif
+#if VCEG_AZ07_FRUC_MERGE
+  memcpy( m_puhFRUCMgrMode,          pcCU->m_puhFRUCMgrMode,        sizeof( UChar ) * numPart );
+#endif
+#if VCEG_AZ07_IMV
+  memcpy( m_iMVFlag,                 pcCU->m_iMVFlag,               sizeof( *m_iMVFlag ) * numPart );
+  memcpy( m_piMVCandNum,             pcCU->m_piMVCandNum,           sizeof( Char  ) * numPart );
+#endif
+#if VCEG_AZ06_IC
+  memcpy( m_pbICFlag,                pcCU->m_pbICFlag,              sizeof( Bool  ) * numPart );
+#endif
+#if ALF_HM3_REFACTOR
+#if JVET_C0024_QTBT
+  memcpy( m_puhAlfCtrlFlag,          pcCU->m_puhAlfCtrlFlag,        sizeof( UChar ) * numPart );
+#else
+  memcpy( m_puiAlfCtrlFlag,          pcCU->m_puiAlfCtrlFlag,        sizeof( UInt  ) * numPart );
+#endif
+#endif
+#if COM16_C806_EMT
+  memcpy( m_puhEmtTuIdx,             pcCU->m_puhEmtTuIdx,           sizeof( UChar ) * numPart );
+  memcpy( m_puhEmtCuFlag,            pcCU->m_puhEmtCuFlag,          sizeof( UChar ) * numPart );
+#endif
+#if COM16_C1016_AFFINE
+  memcpy( m_affineFlag,              pcCU->m_affineFlag,            sizeof( Bool  ) * numPart );
+#endif
+  memcpy( m_puhInterDir,             pcCU->m_puhInterDir,           sizeof( UChar ) * numPart );
+  memcpy( m_pbIPCMFlag,              pcCU->m_pbIPCMFlag,            sizeof( Bool  ) * numPart );
+
+  for( UInt comp = 0; comp < MAX_NUM_COMPONENT; comp++ )
+  {
+    memcpy( m_crossComponentPredictionAlpha[comp], pcCU->m_crossComponentPredictionAlpha[comp], sizeof( Char  ) * numPart );
+    memcpy( m_puhTransformSkip[comp],              pcCU->m_puhTransformSkip[comp],              sizeof( UChar ) * numPart );
+    memcpy( m_puhCbf[comp],                        pcCU->m_puhCbf[comp],                        sizeof( UChar ) * numPart );
+    memcpy( m_explicitRdpcmMode[comp],             pcCU->m_explicitRdpcmMode[comp],             sizeof( UChar ) * numPart );
+#if VCEG_AZ08_KLT_COMMON
+    memcpy( m_puhKLTFlag[comp],                    pcCU->m_puhKLTFlag[comp],                    sizeof( UChar ) * numPart );
+#endif
+#if JVET_C0024_ITSKIP
+    memcpy( m_puiSkipWidth[comp],                  pcCU->m_puiSkipWidth[comp],                  sizeof( UInt  ) * numPart );
+    memcpy( m_puiSkipHeight[comp],                 pcCU->m_puiSkipHeight[comp],                 sizeof( UInt  ) * numPart );
+#endif
+  }
+
+  for( UInt i = 0; i < NUM_REF_PIC_LIST_01; i++ )
+  {
+    const RefPicList rpl = RefPicList( i );
+    memcpy( m_apiMVPIdx[rpl], pcCU->m_apiMVPIdx[rpl], sizeof( Char ) * numPart );
+    memcpy( m_apiMVPNum[rpl], pcCU->m_apiMVPNum[rpl], sizeof( Char ) * numPart );
+    m_apcCUColocated[rpl] = pcCU->m_apcCUColocated[rpl];
+    m_acCUMvField[rpl].copyFrom( &pcCU->m_acCUMvField[rpl], numPart, 0 );
+#if VCEG_AZ07_FRUC_MERGE
+    m_acFRUCUniLateralMVField[i].copyFrom( &pcCU->m_acFRUCUniLateralMVField[i], numPart, 0 );
+#endif
+  }
+}
+#endif
+
 // Copy small CU to bigger CU.
 // One of quarter parts overwritten by predicted sub part.
 #if JVET_C0024_QTBT 
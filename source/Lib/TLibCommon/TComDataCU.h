@@ -362,6 +362,9 @@ public:
 #if VCEG_AZ08_INTER_KLT 
   Void          copySameSizeCUFrom    ( TComDataCU* pcCU, UInt uiPartUnitIdx, UInt uiDepth);
 #endif
+#if QTBT_PARALLEL_SPLIT
+  Void          copyCUFrom            ( const TComDataCU* pcCU );
+#endif
 #if !JVET_C0024_QTBT
   Void          copyToPic             ( UChar uiDepth );
 #endif
@@ -653,6 +656,10 @@ public:
 
 #if ADAPTIVE_QP_SELECTION
   TCoeff*       getArlCoeff           ( ComponentID component ) { return m_pcArlCoeff[component]; }
+#if WPP_PARALLEL_CTU_ROWS
+  /// aliases the ARL coefficients of a CTU of uiWidth x uiHeight to pcBuffer, as create() does with a parent buffer
+  Void          setArlCoeffBuffer     ( TCoeff* pcBuffer, ChromaFormat chromaFormatIDC, UInt uiWidth, UInt uiHeight );
+#endif
 #endif
   Pel*          getPCMSample          ( ComponentID component ) { return m_pcIPCMSample[component]; }
 
@@ -1108,10 +1115,6 @@ public:
 #endif
 
   UInt          getCoefScanIdx(const UInt uiAbsPartIdx, const UInt uiWidth, const UInt uiHeight, const ComponentID compID) const ;
-
-#if VCEG_AZ08_INTER_KLT
-  Void          interpolatePic                 ( TComPic* pcPic );
-#endif
 };
 
 namespace RasterAddress
@@ -0,0 +1,176 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2015, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TComEmulationPrevention.cpp
+    \brief    start code scan and emulation prevention of NAL unit payloads
+*/
+
+#include "TComEmulationPrevention.h"
+#include <cstring>
+#include <emmintrin.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+//! \ingroup TLibCommon
+//! \{
+
+/// index of the lowest set bit of a non-zero mask
+static inline Int xFirstBit( UInt mask )
+{
+#if defined(_MSC_VER)
+  unsigned long idx;
+  _BitScanForward( &idx, mask );
+  return Int( idx );
+#else
+  return __builtin_ctz( mask );
+#endif
+}
+
+const uint8_t* TComEmulationPrevention::findZeroZeroByte( const uint8_t* pBegin, const uint8_t* pEnd, uint8_t maxThirdByte )
+{
+  if( pEnd - pBegin < 3 )
+  {
+    return pEnd;
+  }
+  const uint8_t* p     = pBegin;
+  const uint8_t* pLast = pEnd - 2;                            ///< last position a three-byte sequence starts at
+
+  // the loads at p, p+1 and p+2 hold the first, second and third byte of the sequences starting at p, p+1, ...
+#if defined(__AVX2__)
+  const __m256i zero32     = _mm256_setzero_si256();
+  const __m256i maxThird32 = _mm256_set1_epi8( Char( maxThirdByte ) );
+  while( pEnd - p >= 34 )
+  {
+    const __m256i b0 = _mm256_loadu_si256( (const __m256i*)p );
+    const __m256i b1 = _mm256_loadu_si256( (const __m256i*)( p + 1 ) );
+    const __m256i b2 = _mm256_loadu_si256( (const __m256i*)( p + 2 ) );
+    __m256i hit = _mm256_and_si256( _mm256_cmpeq_epi8( b0, zero32 ), _mm256_cmpeq_epi8( b1, zero32 ) );
+    hit = _mm256_and_si256( hit, _mm256_cmpeq_epi8( _mm256_min_epu8( b2, maxThird32 ), b2 ) );
+    const UInt mask = UInt( _mm256_movemask_epi8( hit ) );
+    if( mask )
+    {
+      return p + xFirstBit( mask );
+    }
+    p += 32;
+  }
+#endif
+  const __m128i zero     = _mm_setzero_si128();
+  const __m128i maxThird = _mm_set1_epi8( Char( maxThirdByte ) );
+  while( pEnd - p >= 18 )
+  {
+    const __m128i b0 = _mm_loadu_si128( (const __m128i*)p );
+    const __m128i b1 = _mm_loadu_si128( (const __m128i*)( p + 1 ) );
+    const __m128i b2 = _mm_loadu_si128( (const __m128i*)( p + 2 ) );
+    __m128i hit = _mm_and_si128( _mm_cmpeq_epi8( b0, zero ), _mm_cmpeq_epi8( b1, zero ) );
+    hit = _mm_and_si128( hit, _mm_cmpeq_epi8( _mm_min_epu8( b2, maxThird ), b2 ) );
+    const UInt mask = UInt( _mm_movemask_epi8( hit ) );
+    if( mask )
+    {
+      return p + xFirstBit( mask );
+    }
+    p += 16;
+  }
+
+  // the tail
+  for( ; p < pLast; p++ )
+  {
+    if( p[0] == 0 && p[1] == 0 && p[2] <= maxThirdByte )
+    {
+      return p;
+    }
+  }
+  return pEnd;
+}
+
+size_t TComEmulationPrevention::removeThreeBytes( uint8_t* pDst, const uint8_t* pSrc, size_t size, std::vector<UInt>& rLocations )
+{
+  const uint8_t* pEnd = pSrc + size;
+  const uint8_t* p    = pSrc;                                 ///< first byte not copied yet
+  uint8_t*       q    = pDst;
+
+  const uint8_t* pHit = findZeroZeroByte( p, pEnd, 0x03 );
+  while( pHit != pEnd )
+  {
+    if( pHit[2] != 0x03 )
+    {
+      // 0x000000, 0x000001 and 0x000002 do not occur inside a NAL unit
+      assert( 0 );
+      pHit = findZeroZeroByte( pHit + 1, pEnd, 0x03 );
+      continue;
+    }
+    const size_t n = size_t( pHit + 2 - p );
+    memmove( q, p, n );
+    q += n;
+    rLocations.push_back( UInt( pHit + 2 - pSrc ) );
+    p    = pHit + 3;
+    pHit = findZeroZeroByte( p, pEnd, 0x03 );
+  }
+  const size_t n = size_t( pEnd - p );
+  memmove( q, p, n );
+  return size_t( q + n - pDst );
+}
+
+size_t TComEmulationPrevention::insertThreeBytes( uint8_t* pDst, const uint8_t* pSrc, size_t size )
+{
+  const uint8_t* pEnd = pSrc + size;
+  const uint8_t* p    = pSrc;
+  uint8_t*       q    = pDst;
+
+  // the byte after an inserted 0x03 starts the next zero run
+  const uint8_t* pHit = findZeroZeroByte( p, pEnd, 0x03 );
+  while( pHit != pEnd )
+  {
+    const size_t n = size_t( pHit + 2 - p );
+    memcpy( q, p, n );
+    q   += n;
+    *q++ = 0x03;
+    p    = pHit + 2;
+    pHit = findZeroZeroByte( p, pEnd, 0x03 );
+  }
+  const size_t n = size_t( pEnd - p );
+  memcpy( q, p, n );
+  q += n;
+
+  // 7.4.1.1: an RBSP that ends in a cabac_zero_word gets a final 0x03
+  if( size && pEnd[-1] == 0x00 )
+  {
+    *q++ = 0x03;
+  }
+  return size_t( q - pDst );
+}
+
+//! \}
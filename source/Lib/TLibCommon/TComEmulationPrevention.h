@@ -0,0 +1,73 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2015, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TComEmulationPrevention.h
+    \brief    start code scan and emulation prevention of NAL unit payloads
+*/
+
+#ifndef __TCOMEMULATIONPREVENTION__
+#define __TCOMEMULATIONPREVENTION__
+
+#include <stdint.h>
+#include <vector>
+#include "CommonDef.h"
+
+//! \ingroup TLibCommon
+//! \{
+
+/** Byte-aligned 0x0000xx sequences of a NAL unit payload, found 16 (32 with AVX2) positions at a
+ *  time; the bytes between two sequences are moved with memcpy/memmove.
+ */
+class TComEmulationPrevention
+{
+public:
+  /// first p with p[0] == 0, p[1] == 0 and p[2] <= maxThirdByte in [pBegin, pEnd), or pEnd
+  static const uint8_t* findZeroZeroByte( const uint8_t* pBegin, const uint8_t* pEnd, uint8_t maxThirdByte );
+
+  /** Copies the size bytes of a NAL unit to the RBSP at pDst without the emulation_prevention_three_bytes
+   *  and returns the RBSP size. pDst may be pSrc. The positions of the removed bytes in the NAL unit are
+   *  appended to rLocations.
+   */
+  static size_t removeThreeBytes( uint8_t* pDst, const uint8_t* pSrc, size_t size, std::vector<UInt>& rLocations );
+
+  /** Copies the size bytes of an RBSP to the NAL unit at pDst with the emulation_prevention_three_bytes
+   *  (and the 0x03 after a final zero byte) and returns the NAL unit size. pDst holds maxInsertSize( size ).
+   */
+  static size_t insertThreeBytes( uint8_t* pDst, const uint8_t* pSrc, size_t size );
+  static size_t maxInsertSize   ( size_t size )               { return size + size / 2 + 1; }
+
+};
+
+//! \}
+
+#endif // __TCOMEMULATIONPREVENTION__
@@ -0,0 +1,653 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2015, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TComKLTBasis.cpp
+    \brief    derivation of the KLT basis from the candidate samples
+*/
+
+#include "TComKLTBasis.h"
+
+#if VCEG_AZ08_KLT_COMMON && KLT_DETERMINISTIC_BASIS
+
+// The basis is normative: a multiply-add contracted into an FMA by one compiler and not by another would
+// change it, so contraction is disabled for this file.
+#if defined(__clang__)
+#pragma clang fp contract(off)
+#elif defined(__GNUC__)
+#pragma GCC optimize ("fp-contract=off")
+#endif
+
+#include <cmath>
+#include <cfloat>
+#include <cstring>
+#if COM16_C806_SIMD_OPT
+#include <smmintrin.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#endif
+
+//! \ingroup TLibCommon
+//! \{
+
+/// bound of the QL iterations of one eigenvalue, as in EISPACK; 2 or 3 are the rule
+static const Int KLT_QL_MAX_ITER = 30;
+
+/// rounding of TComTrQuant (MY_INT), half away from zero
+static inline Short xRound( Double x )
+{
+  return Short( x < 0 ? Int( x - 0.5 ) : Int( x + 0.5 ) );
+}
+
+/// sqrt(a^2 + b^2) without overflow, with sqrt as the only library call (std::hypot is not correctly rounded everywhere)
+static inline Double xHypot( Double a, Double b )
+{
+  a = fabs( a );
+  b = fabs( b );
+  if( a > b )
+  {
+    const Double r = b / a;
+    return a * sqrt( 1.0 + r * r );
+  }
+  if( b != 0.0 )
+  {
+    const Double r = a / b;
+    return b * sqrt( 1.0 + r * r );
+  }
+  return 0.0;
+}
+
+/// sums[0..3] = a0.b0, a0.b1, a1.b0, a1.b1 over len samples
+static inline Void xDot2x2( const Short* a0, const Short* a1, const Short* b0, const Short* b1, Int len, Int* sums )
+{
+  Int k = 0;
+#if COM16_C806_SIMD_OPT
+  __m128i s00 = _mm_setzero_si128(), s01 = _mm_setzero_si128(), s10 = _mm_setzero_si128(), s11 = _mm_setzero_si128();
+#if defined(__AVX2__)
+  if( len >= 16 )
+  {
+    __m256i t00 = _mm256_setzero_si256(), t01 = _mm256_setzero_si256(), t10 = _mm256_setzero_si256(), t11 = _mm256_setzero_si256();
+    for( ; k + 16 <= len; k += 16 )
+    {
+      const __m256i va0 = _mm256_loadu_si256( ( const __m256i* )( a0 + k ) );
+      const __m256i va1 = _mm256_loadu_si256( ( const __m256i* )( a1 + k ) );
+      const __m256i vb0 = _mm256_loadu_si256( ( const __m256i* )( b0 + k ) );
+      const __m256i vb1 = _mm256_loadu_si256( ( const __m256i* )( b1 + k ) );
+      t00 = _mm256_add_epi32( t00, _mm256_madd_epi16( va0, vb0 ) );
+      t01 = _mm256_add_epi32( t01, _mm256_madd_epi16( va0, vb1 ) );
+      t10 = _mm256_add_epi32( t10, _mm256_madd_epi16( va1, vb0 ) );
+      t11 = _mm256_add_epi32( t11, _mm256_madd_epi16( va1, vb1 ) );
+    }
+    s00 = _mm_add_epi32( _mm256_castsi256_si128( t00 ), _mm256_extracti128_si256( t00, 1 ) );
+    s01 = _mm_add_epi32( _mm256_castsi256_si128( t01 ), _mm256_extracti128_si256( t01, 1 ) );
+    s10 = _mm_add_epi32( _mm256_castsi256_si128( t10 ), _mm256_extracti128_si256( t10, 1 ) );
+    s11 = _mm_add_epi32( _mm256_castsi256_si128( t11 ), _mm256_extracti128_si256( t11, 1 ) );
+  }
+#endif
+  for( ; k + 8 <= len; k += 8 )
+  {
+    const __m128i va0 = _mm_loadu_si128( ( const __m128i* )( a0 + k ) );
+    const __m128i va1 = _mm_loadu_si128( ( const __m128i* )( a1 + k ) );
+    const __m128i vb0 = _mm_loadu_si128( ( const __m128i* )( b0 + k ) );
+    const __m128i vb1 = _mm_loadu_si128( ( const __m128i* )( b1 + k ) );
+    s00 = _mm_add_epi32( s00, _mm_madd_epi16( va0, vb0 ) );
+    s01 = _mm_add_epi32( s01, _mm_madd_epi16( va0, vb1 ) );
+    s10 = _mm_add_epi32( s10, _mm_madd_epi16( va1, vb0 ) );
+    s11 = _mm_add_epi32( s11, _mm_madd_epi16( va1, vb1 ) );
+  }
+  _mm_storeu_si128( ( __m128i* )sums, _mm_hadd_epi32( _mm_hadd_epi32( s00, s01 ), _mm_hadd_epi32( s10, s11 ) ) );
+#else
+  sums[0] = sums[1] = sums[2] = sums[3] = 0;
+#endif
+  for( ; k < len; k++ )
+  {
+    sums[0] += a0[k] * b0[k];
+    sums[1] += a0[k] * b1[k];
+    sums[2] += a1[k] * b0[k];
+    sums[3] += a1[k] * b1[k];
+  }
+}
+
+// The vector kernels below compute every element with the operations of the scalar loop, in the same order,
+// so the SIMD and the scalar builds give the same bits. Sums over k (dot products) stay scalar for that reason.
+
+/// x[k] += alpha * a[k]
+static inline Void xAxpy( Double* x, const Double* a, Double alpha, Int n )
+{
+  Int k = 0;
+#if COM16_C806_SIMD_OPT
+#if defined(__AVX2__)
+  const __m256d va4 = _mm256_set1_pd( alpha );
+  for( ; k + 4 <= n; k += 4 )
+  {
+    _mm256_storeu_pd( x + k, _mm256_add_pd( _mm256_loadu_pd( x + k ), _mm256_mul_pd( va4, _mm256_loadu_pd( a + k ) ) ) );
+  }
+#endif
+  const __m128d va = _mm_set1_pd( alpha );
+  for( ; k + 2 <= n; k += 2 )
+  {
+    _mm_storeu_pd( x + k, _mm_add_pd( _mm_loadu_pd( x + k ), _mm_mul_pd( va, _mm_loadu_pd( a + k ) ) ) );
+  }
+#endif
+  for( ; k < n; k++ )
+  {
+    x[k] += alpha * a[k];
+  }
+}
+
+/// x[k] -= f * a[k] + g * b[k]
+static inline Void xRank2( Double* x, const Double* a, const Double* b, Double f, Double g, Int n )
+{
+  Int k = 0;
+#if COM16_C806_SIMD_OPT
+#if defined(__AVX2__)
+  const __m256d vf4 = _mm256_set1_pd( f ), vg4 = _mm256_set1_pd( g );
+  for( ; k + 4 <= n; k += 4 )
+  {
+    const __m256d t = _mm256_add_pd( _mm256_mul_pd( vf4, _mm256_loadu_pd( a + k ) ), _mm256_mul_pd( vg4, _mm256_loadu_pd( b + k ) ) );
+    _mm256_storeu_pd( x + k, _mm256_sub_pd( _mm256_loadu_pd( x + k ), t ) );
+  }
+#endif
+  const __m128d vf = _mm_set1_pd( f ), vg = _mm_set1_pd( g );
+  for( ; k + 2 <= n; k += 2 )
+  {
+    const __m128d t = _mm_add_pd( _mm_mul_pd( vf, _mm_loadu_pd( a + k ) ), _mm_mul_pd( vg, _mm_loadu_pd( b + k ) ) );
+    _mm_storeu_pd( x + k, _mm_sub_pd( _mm_loadu_pd( x + k ), t ) );
+  }
+#endif
+  for( ; k < n; k++ )
+  {
+    x[k] -= ( f * a[k] + g * b[k] );
+  }
+}
+
+/// plane rotation of the columns x and y: (x, y) = (c x - s y, s x + c y)
+static inline Void xRotate( Double* x, Double* y, Double c, Double s, Int n )
+{
+  Int k = 0;
+#if COM16_C806_SIMD_OPT
+#if defined(__AVX2__)
+  const __m256d vc4 = _mm256_set1_pd( c ), vs4 = _mm256_set1_pd( s );
+  for( ; k + 4 <= n; k += 4 )
+  {
+    const __m256d vx = _mm256_loadu_pd( x + k ), vy = _mm256_loadu_pd( y + k );
+    _mm256_storeu_pd( y + k, _mm256_add_pd( _mm256_mul_pd( vs4, vx ), _mm256_mul_pd( vc4, vy ) ) );
+    _mm256_storeu_pd( x + k, _mm256_sub_pd( _mm256_mul_pd( vc4, vx ), _mm256_mul_pd( vs4, vy ) ) );
+  }
+#endif
+  const __m128d vc = _mm_set1_pd( c ), vs = _mm_set1_pd( s );
+  for( ; k + 2 <= n; k += 2 )
+  {
+    const __m128d vx = _mm_loadu_pd( x + k ), vy = _mm_loadu_pd( y + k );
+    _mm_storeu_pd( y + k, _mm_add_pd( _mm_mul_pd( vs, vx ), _mm_mul_pd( vc, vy ) ) );
+    _mm_storeu_pd( x + k, _mm_sub_pd( _mm_mul_pd( vc, vx ), _mm_mul_pd( vs, vy ) ) );
+  }
+#endif
+  for( ; k < n; k++ )
+  {
+    const Double t = y[k];
+    y[k] = s * x[k] + c * t;
+    x[k] = c * x[k] - s * t;
+  }
+}
+
+/// proj[c] += v * sample[c], the product in float as in TComTrQuant
+static inline Void xProject( Double* proj, const Short* sample, Float v, Int n )
+{
+  Int k = 0;
+#if COM16_C806_SIMD_OPT
+  const __m128 vv = _mm_set1_ps( v );
+  for( ; k + 4 <= n; k += 4 )
+  {
+    const __m128 p = _mm_mul_ps( vv, _mm_cvtepi32_ps( _mm_cvtepi16_epi32( _mm_loadl_epi64( ( const __m128i* )( sample + k ) ) ) ) );
+    _mm_storeu_pd( proj + k,     _mm_add_pd( _mm_loadu_pd( proj + k ),     _mm_cvtps_pd( p ) ) );
+    _mm_storeu_pd( proj + k + 2, _mm_add_pd( _mm_loadu_pd( proj + k + 2 ), _mm_cvtps_pd( _mm_movehl_ps( p, p ) ) ) );
+  }
+#endif
+  for( ; k < n; k++ )
+  {
+    proj[k] += v * sample[k];
+  }
+}
+
+/** Householder reduction of the symmetric matrix V to a tridiagonal matrix (diagonal d, off-diagonal e[1..n-1]),
+ *  V is replaced by the orthogonal transform. tred2 of EISPACK (JAMA form); V is stored by columns, so all the
+ *  inner loops run over contiguous samples. N is the order when it is known at compile time, 0 otherwise.
+ */
+template <Int N>
+static Void xTridiagonalize( Double* V, Int n, Double* d, Double* e )
+{
+  const Int dim = N ? N : n;
+
+  for( Int j = 0; j < dim; j++ )
+  {
+    d[j] = V[j * dim + dim - 1];
+  }
+
+  for( Int i = dim - 1; i > 0; i-- )
+  {
+    Double* colI  = V + i * dim;
+    Double  scale = 0.0;
+    Double  h     = 0.0;
+    for( Int k = 0; k < i; k++ )
+    {
+      scale += fabs( d[k] );
+    }
+    if( scale == 0.0 )
+    {
+      e[i] = d[i - 1];
+      for( Int j = 0; j < i; j++ )
+      {
+        d[j] = V[j * dim + i - 1];
+        V[j * dim + i] = 0.0;
+        colI[j] = 0.0;
+      }
+    }
+    else
+    {
+      for( Int k = 0; k < i; k++ )
+      {
+        d[k] /= scale;
+        h += d[k] * d[k];
+      }
+      Double f = d[i - 1];
+      Double g = sqrt( h );
+      if( f > 0 )
+      {
+        g = -g;
+      }
+      e[i] = scale * g;
+      h = h - f * g;
+      d[i - 1] = f - g;
+      for( Int j = 0; j < i; j++ )
+      {
+        e[j] = 0.0;
+      }
+
+      for( Int j = 0; j < i; j++ )
+      {
+        const Double* colJ = V + j * dim;
+        f = d[j];
+        colI[j] = f;
+        g = e[j] + colJ[j] * f;
+        for( Int k = j + 1; k <= i - 1; k++ )
+        {
+          g += colJ[k] * d[k];
+        }
+        xAxpy( e + j + 1, colJ + j + 1, f, i - 1 - j );
+        e[j] = g;
+      }
+      f = 0.0;
+      for( Int j = 0; j < i; j++ )
+      {
+        e[j] /= h;
+        f += e[j] * d[j];
+      }
+      const Double hh = f / ( h + h );
+      for( Int j = 0; j < i; j++ )
+      {
+        e[j] -= hh * d[j];
+      }
+      for( Int j = 0; j < i; j++ )
+      {
+        Double* colJ = V + j * dim;
+        f = d[j];
+        g = e[j];
+        xRank2( colJ + j, e + j, d + j, f, g, i - j );
+        d[j] = colJ[i - 1];
+        colJ[i] = 0.0;
+      }
+    }
+    d[i] = h;
+  }
+
+  // accumulate the transforms
+  for( Int i = 0; i < dim - 1; i++ )
+  {
+    Double* colI  = V + i * dim;
+    Double* colI1 = colI + dim;
+    colI[dim - 1] = colI[i];
+    colI[i] = 1.0;
+    const Double h = d[i + 1];
+    if( h != 0.0 )
+    {
+      for( Int k = 0; k <= i; k++ )
+      {
+        d[k] = colI1[k] / h;
+      }
+      for( Int j = 0; j <= i; j++ )
+      {
+        Double* colJ = V + j * dim;
+        Double  g    = 0.0;
+        for( Int k = 0; k <= i; k++ )
+        {
+          g += colI1[k] * colJ[k];
+        }
+        xAxpy( colJ, d, -g, i + 1 );
+      }
+    }
+    for( Int k = 0; k <= i; k++ )
+    {
+      colI1[k] = 0.0;
+    }
+  }
+  for( Int j = 0; j < dim; j++ )
+  {
+    d[j] = V[j * dim + dim - 1];
+    V[j * dim + dim - 1] = 0.0;
+  }
+  V[dim * dim - 1] = 1.0;
+  e[0] = 0.0;
+}
+
+/** Eigenvalues (d) and eigenvectors (the columns of V) of the tridiagonal matrix left by xTridiagonalize, with
+ *  implicit QL iterations: tql2 of EISPACK (JAMA form). The number of iterations depends on the data only.
+ */
+template <Int N>
+static Void xQL( Double* V, Int n, Double* d, Double* e )
+{
+  const Int dim = N ? N : n;
+
+  for( Int i = 1; i < dim; i++ )
+  {
+    e[i - 1] = e[i];
+  }
+  e[dim - 1] = 0.0;
+
+  Double f    = 0.0;
+  Double tst1 = 0.0;
+  for( Int l = 0; l < dim; l++ )
+  {
+    // find a small off-diagonal element
+    tst1 = std::max( tst1, fabs( d[l] ) + fabs( e[l] ) );
+    Int m = l;
+    while( m < dim - 1 && fabs( e[m] ) > DBL_EPSILON * tst1 )
+    {
+      m++;
+    }
+
+    if( m > l )
+    {
+      Int iter = 0;
+      do
+      {
+        iter++;
+        // implicit shift
+        Double g = d[l];
+        Double p = ( d[l + 1] - g ) / ( 2.0 * e[l] );
+        Double r = xHypot( p, 1.0 );
+        if( p < 0 )
+        {
+          r = -r;
+        }
+        d[l] = e[l] / ( p + r );
+        d[l + 1] = e[l] * ( p + r );
+        const Double dl1 = d[l + 1];
+        Double h = g - d[l];
+        for( Int i = l + 2; i < dim; i++ )
+        {
+          d[i] -= h;
+        }
+        f = f + h;
+
+        p = d[m];
+        Double c = 1.0, c2 = c, c3 = c;
+        const Double el1 = e[l + 1];
+        Double s = 0.0, s2 = 0.0;
+        for( Int i = m - 1; i >= l; i-- )
+        {
+          c3 = c2;
+          c2 = c;
+          s2 = s;
+          g = c * e[i];
+          h = c * p;
+          r = xHypot( p, e[i] );
+          e[i + 1] = s * r;
+          s = e[i] / r;
+          c = p / r;
+          p = c * d[i] - s * g;
+          d[i + 1] = h + s * ( c * g + s * d[i] );
+
+          xRotate( V + i * dim, V + ( i + 1 ) * dim, c, s, dim );
+        }
+        p = -s * s2 * c3 * el1 * e[l] / dl1;
+        e[l] = s * p;
+        d[l] = c * p;
+      }
+      while( fabs( e[l] ) > DBL_EPSILON * tst1 && iter < KLT_QL_MAX_ITER );
+    }
+    d[l] = d[l] + f;
+    e[l] = 0.0;
+  }
+}
+
+TComKLTBasis::TComKLTBasis()
+{
+}
+
+Void TComKLTBasis::xSetSize( Int order, Int len )
+{
+  if( Int( m_diag.size() ) < order )
+  {
+    m_gram        .resize( order * order );
+    m_matrix      .resize( order * order );
+    m_eigenVectors.resize( order * order );
+    m_eigenValues .resize( order );
+    m_diag        .resize( order );
+    m_offDiag     .resize( order );
+    m_order       .resize( order );
+    m_rows        .resize( order );
+  }
+  if( Int( m_projection.size() ) < len )
+  {
+    m_projection.resize( len );
+  }
+}
+
+Void TComKLTBasis::gram( const Short* const* ppRows, Int numRows, Int len, Int* pGram )
+{
+  Int sums[4];
+  for( Int i = 0; i < numRows; i += 2 )
+  {
+    const Bool   bPair = i + 1 < numRows;
+    const Short* a0    = ppRows[i];
+    const Short* a1    = bPair ? ppRows[i + 1] : a0;
+    for( Int j = 0; j <= i; j += 2 )
+    {
+      const Short* b0 = ppRows[j];
+      const Short* b1 = j + 1 < numRows ? ppRows[j + 1] : b0;
+      xDot2x2( a0, a1, b0, b1, len, sums );
+      pGram[i * numRows + j] = sums[0];
+      if( j + 1 < numRows )
+      {
+        pGram[i * numRows + j + 1] = sums[1];
+      }
+      if( bPair )
+      {
+        pGram[( i + 1 ) * numRows + j]     = sums[2];
+        pGram[( i + 1 ) * numRows + j + 1] = sums[3];
+      }
+    }
+  }
+  for( Int i = 0; i < numRows; i++ )
+  {
+    for( Int j = i + 1; j < numRows; j++ )
+    {
+      pGram[i * numRows + j] = pGram[j * numRows + i];
+    }
+  }
+}
+
+Void TComKLTBasis::eigen( Double* pA, Int n, Double* pEigenValues, Double* pEigenVectors )
+{
+  xSetSize( n, 0 );
+  Double* d = &m_diag[0];
+  Double* e = &m_offDiag[0];
+
+  // pA is symmetric: stored by rows it is also stored by columns
+  switch( n )
+  {
+  case 16:
+    xTridiagonalize<16>( pA, n, d, e );
+    xQL<16>( pA, n, d, e );
+    break;
+  case 64:
+    xTridiagonalize<64>( pA, n, d, e );
+    xQL<64>( pA, n, d, e );
+    break;
+  default:
+    xTridiagonalize<0>( pA, n, d, e );
+    xQL<0>( pA, n, d, e );
+    break;
+  }
+
+  // stable sort by decreasing magnitude, the order of OrderData
+  Int* order = &m_order[0];
+  for( Int i = 0; i < n; i++ )
+  {
+    Int j = i;
+    for( ; j > 0 && fabs( d[i] ) > fabs( d[order[j - 1]] ); j-- )
+    {
+      order[j] = order[j - 1];
+    }
+    order[j] = i;
+  }
+
+  for( Int k = 0; k < n; k++ )
+  {
+    const Double* col = pA + order[k] * n;
+    Double*       row = pEigenVectors + k * n;
+    Int           largest = 0;
+    for( Int i = 1; i < n; i++ )
+    {
+      if( fabs( col[i] ) > fabs( col[largest] ) )
+      {
+        largest = i;
+      }
+    }
+    const Double sign = col[largest] < 0 ? -1.0 : 1.0;
+    for( Int i = 0; i < n; i++ )
+    {
+      row[i] = sign * col[i];
+    }
+    pEigenValues[k] = d[order[k]];
+  }
+}
+
+Void TComKLTBasis::deriveFromCovariance( const Short* const* ppSamples, Int numSamples, UInt blkSize, Short** ppBasis )
+{
+  const Int dim    = blkSize * blkSize;
+  const Int stride = ( numSamples + 15 ) & ~15;
+  xSetSize( dim, 0 );
+  if( Int( m_transposed.size() ) < dim * stride )
+  {
+    m_transposed.resize( dim * stride );
+  }
+
+  // the samples of one dimension are contiguous in a row of m_transposed, the zero padding adds nothing
+  for( Int d = 0; d < dim; d++ )
+  {
+    Short* row = &m_transposed[d * stride];
+    for( Int k = 0; k < numSamples; k++ )
+    {
+      row[k] = ppSamples[k][d];
+    }
+    memset( row + numSamples, 0, ( stride - numSamples ) * sizeof( Short ) );
+    m_rows[d] = row;
+  }
+  gram( &m_rows[0], dim, stride, &m_gram[0] );
+  for( Int i = 0; i < dim * dim; i++ )
+  {
+    m_matrix[i] = Double( m_gram[i] ) / numSamples;
+  }
+
+  eigen( &m_matrix[0], dim, &m_eigenValues[0], &m_eigenVectors[0] );
+
+  const Float scale = Float( blkSize << KLTBASIS_SHIFTBIT );
+  for( Int r = 0; r < dim; r++ )
+  {
+    const Double* vector = &m_eigenVectors[r * dim];
+    for( Int c = 0; c < dim; c++ )
+    {
+      ppBasis[r][c] = xRound( Float( vector[c] ) * scale );
+    }
+  }
+}
+
+Void TComKLTBasis::deriveFromGram( const Short* const* ppSamples, Int numSamples, UInt blkSize, Int maxBasis, Short** ppBasis )
+{
+  const Int dim = blkSize * blkSize;
+  xSetSize( numSamples, dim );
+
+  gram( ppSamples, numSamples, dim, &m_gram[0] );
+  for( Int i = 0; i < numSamples * numSamples; i++ )
+  {
+    m_matrix[i] = Double( m_gram[i] );
+  }
+
+  eigen( &m_matrix[0], numSamples, &m_eigenValues[0], &m_eigenVectors[0] );
+
+  // the basis vector r is X^T v_r / sqrt(lambda_r): the samples weighted by v_r, accumulated over the columns
+  // in the order of the samples
+  const Float scale    = Float( blkSize << KLTBASIS_SHIFTBIT );
+  const Int   numBasis = std::min( numSamples, maxBasis );
+  Double*     proj     = &m_projection[0];
+  Int         r        = 0;
+  for( ; r < numBasis; r++ )
+  {
+    const Double lambda = fabs( m_eigenValues[r] );
+    if( lambda < IGNORE_THRESHOULD_OF_LARGEST )
+    {
+      break;
+    }
+    const Double* vector = &m_eigenVectors[r * numSamples];
+    memset( proj, 0, dim * sizeof( Double ) );
+    for( Int k = 0; k < numSamples; k++ )
+    {
+      xProject( proj, ppSamples[k], Float( vector[k] ), dim );
+    }
+    const Double norm = sqrt( lambda );
+    for( Int c = 0; c < dim; c++ )
+    {
+      ppBasis[r][c] = xRound( Float( proj[c] / norm ) * scale );
+    }
+  }
+  for( ; r < dim; r++ )
+  {
+    memset( ppBasis[r], 0, dim * sizeof( Short ) );
+  }
+}
+
+//! \}
+
+#endif
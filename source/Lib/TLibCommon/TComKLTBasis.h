@@ -0,0 +1,98 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2015, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TComKLTBasis.h
+    \brief    derivation of the KLT basis from the candidate samples (header)
+*/
+
+#ifndef __TCOMKLTBASIS__
+#define __TCOMKLTBASIS__
+
+#include "CommonDef.h"
+#include <vector>
+
+//! \ingroup TLibCommon
+//! \{
+
+#if VCEG_AZ08_KLT_COMMON && KLT_DETERMINISTIC_BASIS
+
+/** KLT basis of a block from the residuals of its candidates, run by both the encoder and the decoder.
+ *
+ *  The correlation of the samples is an integer Gram matrix computed with SSE4.1 (AVX2 when the compiler
+ *  targets it) over 2x2 tiles of rows, so it is exact. Its eigenvectors come from a Householder reduction to
+ *  a tridiagonal matrix and implicit QL iterations in double precision, specialized for the 16 and 64
+ *  dimensions of the 4x4 and 8x8 covariance. The order of every floating point operation is fixed and none
+ *  is contracted into a fused multiply-add, every eigenvector is given the sign that makes its largest
+ *  component positive, and no library function other than sqrt is called, so the integer basis is the same
+ *  on every IEEE-754 platform that evaluates double in double (SSE2, not x87).
+ */
+class TComKLTBasis
+{
+public:
+  TComKLTBasis();
+
+  /// basis of a blkSize x blkSize block from the eigenvectors of the covariance X^T X / N of the numSamples
+  /// candidates (derive1DimKLT): blkSize^2 rows of ppBasis, ordered by decreasing eigenvalue
+  Void   deriveFromCovariance ( const Short* const* ppSamples, Int numSamples, UInt blkSize, Short** ppBasis );
+
+  /// basis of a blkSize x blkSize block from the eigenvectors of the Gram matrix X X^T of the numSamples
+  /// candidates (derive1DimKLT_Fast): at most maxBasis rows, the other rows of ppBasis are cleared
+  Void   deriveFromGram       ( const Short* const* ppSamples, Int numSamples, UInt blkSize, Int maxBasis, Short** ppBasis );
+
+  /// pGram[i * numRows + j] = sum of ppRows[i][k] * ppRows[j][k], k < len
+  static Void gram            ( const Short* const* ppRows, Int numRows, Int len, Int* pGram );
+
+  /// eigenvalues of the symmetric n x n matrix pA, which is destroyed, sorted by decreasing magnitude; row k
+  /// of pEigenVectors (n x n) is the unit eigenvector of pEigenValues[k]
+  Void   eigen                ( Double* pA, Int n, Double* pEigenValues, Double* pEigenVectors );
+
+private:
+  Void   xSetSize             ( Int order, Int len );
+
+  std::vector<Short>  m_transposed;                             ///< samples of one dimension per row, zero padded
+  std::vector<const Short*> m_rows;
+  std::vector<Int>    m_gram;
+  std::vector<Double> m_matrix;
+  std::vector<Double> m_eigenValues;
+  std::vector<Double> m_eigenVectors;
+  std::vector<Double> m_diag;                                   ///< diagonal and off-diagonal of the tridiagonal matrix
+  std::vector<Double> m_offDiag;
+  std::vector<Int>    m_order;
+  std::vector<Double> m_projection;
+};
+
+#endif
+
+//! \}
+
+#endif // __TCOMKLTBASIS__
@@ -0,0 +1,137 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2015, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TComMappedFile.cpp
+    \brief    read-only memory mapping of a file
+*/
+
+#include "TComMappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//! \ingroup TLibCommon
+//! \{
+
+TComMappedFile::TComMappedFile()
+: m_pBase   ( NULL )
+, m_size    ( 0 )
+#ifdef _WIN32
+, m_hFile   ( NULL )
+, m_hMapping( NULL )
+#endif
+{
+}
+
+TComMappedFile::~TComMappedFile()
+{
+  close();
+}
+
+Bool TComMappedFile::open( const std::string& fileName )
+{
+  close();
+
+#ifdef _WIN32
+  HANDLE hFile = CreateFileA( fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+  if( hFile == INVALID_HANDLE_VALUE )
+  {
+    return false;
+  }
+  LARGE_INTEGER fileSize;
+  GetFileSizeEx( hFile, &fileSize );
+  HANDLE hMapping = fileSize.QuadPart ? CreateFileMappingA( hFile, NULL, PAGE_READONLY, 0, 0, NULL ) : NULL;
+  const Void* pBase = hMapping ? MapViewOfFile( hMapping, FILE_MAP_READ, 0, 0, 0 ) : NULL;
+  if( !pBase )
+  {
+    if( hMapping )
+    {
+      CloseHandle( hMapping );
+    }
+    CloseHandle( hFile );
+    return false;
+  }
+  m_hFile    = hFile;
+  m_hMapping = hMapping;
+  m_size     = size_t( fileSize.QuadPart );
+#else
+  const Int fd = ::open( fileName.c_str(), O_RDONLY );
+  if( fd < 0 )
+  {
+    return false;
+  }
+  struct stat st;
+  Void* pBase = MAP_FAILED;
+  if( fstat( fd, &st ) == 0 && S_ISREG( st.st_mode ) && st.st_size > 0 )
+  {
+    pBase = mmap( NULL, size_t( st.st_size ), PROT_READ, MAP_PRIVATE, fd, 0 );
+  }
+  ::close( fd );
+  if( pBase == MAP_FAILED )
+  {
+    return false;
+  }
+#if defined(POSIX_MADV_SEQUENTIAL)
+  posix_madvise( pBase, size_t( st.st_size ), POSIX_MADV_SEQUENTIAL );
+#endif
+  m_size = size_t( st.st_size );
+#endif
+  m_pBase = (const UChar*)pBase;
+  return true;
+}
+
+Void TComMappedFile::close()
+{
+  if( m_pBase )
+  {
+#ifdef _WIN32
+    UnmapViewOfFile( m_pBase );
+    CloseHandle( m_hMapping );
+    CloseHandle( m_hFile );
+    m_hMapping = NULL;
+    m_hFile    = NULL;
+#else
+    munmap( (Void*)m_pBase, m_size );
+#endif
+  }
+  m_pBase = NULL;
+  m_size  = 0;
+}
+
+//! \}
@@ -0,0 +1,77 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2015, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TComMappedFile.h
+    \brief    read-only memory mapping of a file
+*/
+
+#ifndef __TCOMMAPPEDFILE__
+#define __TCOMMAPPEDFILE__
+
+#include "CommonDef.h"
+#include <string>
+
+//! \ingroup TLibCommon
+//! \{
+
+/** Maps a whole file read-only (mmap, or a file mapping on Windows). An empty file, a pipe or any
+ *  other file that cannot be mapped fails to open; the caller then falls back to reading it.
+ */
+class TComMappedFile
+{
+public:
+  TComMappedFile();
+  ~TComMappedFile();
+
+  Bool         open    ( const std::string& fileName );
+  Void         close   ();
+  Bool         isOpen  ()                         const { return m_pBase != NULL; }
+
+  const UChar* getData ()                         const { return m_pBase; }
+  size_t       getSize ()                         const { return m_size; }
+
+private:
+  TComMappedFile( const TComMappedFile& );
+  TComMappedFile& operator=( const TComMappedFile& );
+
+  const UChar* m_pBase;
+  size_t       m_size;
+#ifdef _WIN32
+  Void*        m_hFile;
+  Void*        m_hMapping;
+#endif
+};
+
+//! \}
+
+#endif // __TCOMMAPPEDFILE__
@@ -0,0 +1,260 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2015, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TComPIPCodebookFile.cpp
+    \brief    binary container of the PIP codebooks and training blocks
+*/
+
+#include "TComPIPCodebookFile.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+//! \ingroup TLibCommon
+//! \{
+
+static const Char   PIPB_MAGIC[4]     = { 'P', 'I', 'P', 'B' };
+static const size_t PIPB_HEADER_SIZE  = 16;
+static const size_t PIPB_ENTRY_SIZE   = 32;
+static const size_t PIPB_DATA_ALIGN   = 32;
+
+static inline UInt xReadUInt( const UChar* p )
+{
+  return UInt( p[0] ) | ( UInt( p[1] ) << 8 ) | ( UInt( p[2] ) << 16 ) | ( UInt( p[3] ) << 24 );
+}
+
+static inline Void xWriteUInt( FILE* fp, UInt v )
+{
+  const UChar b[4] = { UChar( v ), UChar( v >> 8 ), UChar( v >> 16 ), UChar( v >> 24 ) };
+  fwrite( b, 1, 4, fp );
+}
+
+TComPIPCodebookFile::TComPIPCodebookFile()
+: m_pBase( NULL )
+, m_size ( 0 )
+{
+}
+
+TComPIPCodebookFile::~TComPIPCodebookFile()
+{
+  close();
+}
+
+Bool TComPIPCodebookFile::open( const std::string& fileName )
+{
+  close();
+
+  if( !m_file.open( fileName ) )
+  {
+    return false;
+  }
+  m_pBase = m_file.getData();
+  m_size  = m_file.getSize();
+
+  // header
+  if( m_size < PIPB_HEADER_SIZE || memcmp( m_pBase, PIPB_MAGIC, 4 ) || xReadUInt( m_pBase + 4 ) != VERSION )
+  {
+    fprintf( stderr, "%s: not a PIP codebook file of version %d\n", fileName.c_str(), VERSION );
+    close();
+    return false;
+  }
+  const UInt numSections = xReadUInt( m_pBase + 8 );
+  if( m_size < PIPB_HEADER_SIZE + numSections * PIPB_ENTRY_SIZE )
+  {
+    fprintf( stderr, "%s: truncated section table\n", fileName.c_str() );
+    close();
+    return false;
+  }
+
+  // section table
+  m_sections.resize( numSections );
+  for( UInt s = 0; s < numSections; s++ )
+  {
+    const UChar* p = m_pBase + PIPB_HEADER_SIZE + s * PIPB_ENTRY_SIZE;
+    SectionEntry& e = m_sections[s];
+    e.kind   = xReadUInt( p );
+    e.qp     = Int( xReadUInt( p + 4 ) );
+    e.width  = xReadUInt( p + 8 );
+    e.height = xReadUInt( p + 12 );
+    e.rows   = xReadUInt( p + 16 );
+    e.rowLen = xReadUInt( p + 20 );
+    e.offset = UInt64( xReadUInt( p + 24 ) ) | ( UInt64( xReadUInt( p + 28 ) ) << 32 );
+    if( e.offset % PIPB_DATA_ALIGN || e.offset + UInt64( e.rows ) * e.rowLen * sizeof( Short ) > m_size )
+    {
+      fprintf( stderr, "%s: section %d is out of the file\n", fileName.c_str(), s );
+      close();
+      return false;
+    }
+  }
+  return true;
+}
+
+Void TComPIPCodebookFile::close()
+{
+  m_file.close();
+  m_pBase = NULL;
+  m_size  = 0;
+  m_sections.clear();
+}
+
+const Short* TComPIPCodebookFile::getSection( SectionKind eKind, Int qp, UInt width, UInt height, UInt& rRows, UInt& rRowLen ) const
+{
+  for( size_t s = 0; s < m_sections.size(); s++ )
+  {
+    const SectionEntry& e = m_sections[s];
+    if( e.kind == UInt( eKind ) && e.qp == qp && e.width == width && e.height == height )
+    {
+      rRows   = e.rows;
+      rRowLen = e.rowLen;
+      return (const Short*)( m_pBase + e.offset );
+    }
+  }
+  rRows   = 0;
+  rRowLen = 0;
+  return NULL;
+}
+
+Bool TComPIPCodebookFile::write( const std::string& fileName, const std::vector<Section>& rcSections )
+{
+  FILE* fp = fopen( fileName.c_str(), "wb" );
+  if( !fp )
+  {
+    return false;
+  }
+  fwrite( PIPB_MAGIC, 1, 4, fp );
+  xWriteUInt( fp, VERSION );
+  xWriteUInt( fp, UInt( rcSections.size() ) );
+  xWriteUInt( fp, 0 );
+
+  UInt64 offset = PIPB_HEADER_SIZE + rcSections.size() * PIPB_ENTRY_SIZE;
+  std::vector<UInt64> offsets( rcSections.size() );
+  for( size_t s = 0; s < rcSections.size(); s++ )
+  {
+    const Section& rcSec = rcSections[s];
+    offset     = ( offset + PIPB_DATA_ALIGN - 1 ) / PIPB_DATA_ALIGN * PIPB_DATA_ALIGN;
+    offsets[s] = offset;
+    xWriteUInt( fp, rcSec.kind );
+    xWriteUInt( fp, UInt( rcSec.qp ) );
+    xWriteUInt( fp, rcSec.width );
+    xWriteUInt( fp, rcSec.height );
+    xWriteUInt( fp, rcSec.rows );
+    xWriteUInt( fp, rcSec.rowLen );
+    xWriteUInt( fp, UInt( offset ) );
+    xWriteUInt( fp, UInt( offset >> 32 ) );
+    offset += UInt64( rcSec.rows ) * rcSec.rowLen * sizeof( Short );
+  }
+
+  static const UChar zeros[PIPB_DATA_ALIGN] = { 0 };
+  UInt64 pos = PIPB_HEADER_SIZE + rcSections.size() * PIPB_ENTRY_SIZE;
+  for( size_t s = 0; s < rcSections.size(); s++ )
+  {
+    const Section& rcSec = rcSections[s];
+    fwrite( zeros, 1, size_t( offsets[s] - pos ), fp );
+    // the samples are stored little endian, as laid out in memory on the x86 and ARM targets
+    if( !rcSec.data.empty() )
+    {
+      fwrite( &rcSec.data[0], sizeof( Short ), rcSec.data.size(), fp );
+    }
+    pos = offsets[s] + rcSec.data.size() * sizeof( Short );
+  }
+  const Bool ok = !ferror( fp );
+  fclose( fp );
+  return ok;
+}
+
+/// parses up to rSection.rowLen integers of each line of a text file into rows of rSection
+static Bool xReadTextRows( const std::string& fileName, Char delimiter, TComPIPCodebookFile::Section& rSection )
+{
+  std::ifstream in( fileName.c_str(), std::ios::in );
+  if( !in.is_open() )
+  {
+    return false;
+  }
+  std::string line;
+  rSection.rows = 0;
+  rSection.data.clear();
+  while( getline( in, line ) )
+  {
+    if( line.find_first_not_of( " \t\r" ) == std::string::npos )
+    {
+      continue;
+    }
+    const Char* p = line.c_str();
+    for( UInt i = 0; i < rSection.rowLen; i++ )
+    {
+      Char* end;
+      const long v = strtol( p, &end, 10 );
+      rSection.data.push_back( Short( v ) );
+      p = *end ? end + ( *end == delimiter ) : end;
+    }
+    rSection.rows++;
+  }
+  return true;
+}
+
+Bool TComPIPCodebookFile::readTextCodebook( const std::string& fileName, Int qp, UInt width, UInt height, Section& rSection )
+{
+  rSection.kind   = SECTION_CODEBOOK;
+  rSection.qp     = qp;
+  rSection.width  = width;
+  rSection.height = height;
+  rSection.rowLen = width * height;
+  return xReadTextRows( fileName, ',', rSection );
+}
+
+Bool TComPIPCodebookFile::readTextBlocks( const std::string& fileName, Int qp, UInt width, UInt height, Section& rSection )
+{
+  rSection.kind   = SECTION_BLOCKS;
+  rSection.qp     = qp;
+  rSection.width  = width;
+  rSection.height = height;
+  rSection.rowLen = width + height + 1 + width * height;
+  return xReadTextRows( fileName, '\t', rSection );
+}
+
+std::string TComPIPCodebookFile::textCodebookName( const std::string& dir, Int qp, UInt width, UInt height )
+{
+  Char name[64];
+  sprintf( name, "CB0iTQ/0_Q%d_CBf%d_%dx%d.txt", qp, CBf, height, width );
+  return dir + name;
+}
+
+std::string TComPIPCodebookFile::textBlocksName( const std::string& dir, Int qp, UInt width, UInt height )
+{
+  Char name[64];
+  sprintf( name, "Blocks%dx%d_%d_CBf%d.txt", height, width, qp, CBf );
+  return dir + name;
+}
+
+//! \}
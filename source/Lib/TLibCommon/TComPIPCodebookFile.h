@@ -0,0 +1,124 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2015, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TComPIPCodebookFile.h
+    \brief    binary container of the PIP codebooks and training blocks
+*/
+
+#ifndef __TCOMPIPCODEBOOKFILE__
+#define __TCOMPIPCODEBOOKFILE__
+
+#include "CommonDef.h"
+#include "TComMappedFile.h"
+#include <string>
+#include <vector>
+
+//! \ingroup TLibCommon
+//! \{
+
+/** Versioned binary container of PIP data, mapped read-only by the encoder and the decoder.
+ *
+ *  Layout (little endian):
+ *  - header: magic "PIPB", version, number of sections, reserved (4 x 32 bit)
+ *  - section table: kind, QP, width, height, rows, samples per row (6 x 32 bit), byte offset (64 bit)
+ *  - section data: rows x samples Short, contiguous, each section aligned to 32 bytes
+ *
+ *  A codebook section holds CBf*W*H vectors of W*H samples. A training block section holds one row
+ *  per block: the above-left, above and left references (W+H+1) followed by the original (W*H).
+ */
+class TComPIPCodebookFile
+{
+public:
+  enum SectionKind
+  {
+    SECTION_CODEBOOK = 0,
+    SECTION_BLOCKS   = 1
+  };
+
+  /// one section of the container, as written by the converter
+  struct Section
+  {
+    UInt               kind;
+    Int                qp;
+    UInt               width;
+    UInt               height;
+    UInt               rows;
+    UInt               rowLen;
+    std::vector<Short> data;
+  };
+
+  TComPIPCodebookFile();
+  ~TComPIPCodebookFile();
+
+  /// maps the file read-only and checks the header and the section table
+  Bool   open       ( const std::string& fileName );
+  Void   close      ();
+  Bool   isOpen     ()                        const { return m_pBase != NULL; }
+
+  /// rows x rowLen samples of one section, NULL if the file has no such section
+  const Short* getSection( SectionKind eKind, Int qp, UInt width, UInt height, UInt& rRows, UInt& rRowLen ) const;
+
+  static Bool write            ( const std::string& fileName, const std::vector<Section>& rcSections );
+  /// parses a text codebook (one comma separated vector per line)
+  static Bool readTextCodebook ( const std::string& fileName, Int qp, UInt width, UInt height, Section& rSection );
+  /// parses a text training block file (one tab separated block per line)
+  static Bool readTextBlocks   ( const std::string& fileName, Int qp, UInt width, UInt height, Section& rSection );
+
+  /// <dir>CB0iTQ/0_Q<qp>_CBf<CBf>_<h>x<w>.txt, the initial codebook of the text layout
+  static std::string textCodebookName( const std::string& dir, Int qp, UInt width, UInt height );
+  /// <dir>Blocks<h>x<w>_<qp>_CBf<CBf>.txt
+  static std::string textBlocksName  ( const std::string& dir, Int qp, UInt width, UInt height );
+
+  static const UInt VERSION = 1;
+
+private:
+  struct SectionEntry
+  {
+    UInt   kind;
+    Int    qp;
+    UInt   width;
+    UInt   height;
+    UInt   rows;
+    UInt   rowLen;
+    UInt64 offset;
+  };
+
+  TComMappedFile            m_file;
+  const UChar*              m_pBase;
+  size_t                    m_size;
+  std::vector<SectionEntry> m_sections;
+};
+
+//! \}
+
+#endif // __TCOMPIPCODEBOOKFILE__
@@ -0,0 +1,324 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2015, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TComPIPCodebookTrainer.cpp
+    \brief    LGB (generalized Lloyd) training of the PIP codebooks
+*/
+
+#include "TComPIPCodebookTrainer.h"
+#include <algorithm>
+
+#if COM16_C806_SIMD_OPT
+#include <smmintrin.h>
+#endif
+
+//! \ingroup TLibCommon
+//! \{
+
+static inline Short xClipRes( Int v )
+{
+  return Short( std::min( std::max( v, -TComPIPCodebookTrainer::MAX_ABS ), TComPIPCodebookTrainer::MAX_ABS ) );
+}
+
+TComPIPCodebookTrainer::TComPIPCodebookTrainer()
+: m_width       ( 0 )
+, m_height      ( 0 )
+, m_size        ( 0 )
+, m_numCodewords( 0 )
+, m_numActive   ( 0 )
+, m_lastDist    ( 0 )
+{
+}
+
+TComPIPCodebookTrainer::~TComPIPCodebookTrainer()
+{
+  destroy();
+}
+
+Void TComPIPCodebookTrainer::create( Int width, Int height, Int numCodewords, Int numThreads )
+{
+  assert( width * height <= MAX_SIZE && ( width * height ) % 8 == 0 && numCodewords > 0 );
+  m_width        = width;
+  m_height       = height;
+  m_size         = width * height;
+  m_numCodewords = numCodewords;
+  m_numActive    = numCodewords;
+  m_codebook.assign( numCodewords * m_size, 0 );
+  m_counts.assign( numCodewords, 0 );
+  m_cPool.create( numThreads );
+  m_acc.resize( std::max( numThreads, 1 ) );
+  for( size_t t = 0; t < m_acc.size(); t++ )
+  {
+    m_acc[t].sums.resize( numCodewords * m_size );
+    m_acc[t].counts.resize( numCodewords );
+  }
+}
+
+Void TComPIPCodebookTrainer::destroy()
+{
+  m_cPool.destroy();
+  m_acc.clear();
+  m_codebook.clear();
+  m_counts.clear();
+}
+
+Void TComPIPCodebookTrainer::initCodebook( const Short* codebook )
+{
+  for( Int i = 0; i < m_numCodewords * m_size; i++ )
+  {
+    m_codebook[i] = xClipRes( codebook[i] );
+  }
+  m_numActive = m_numCodewords;
+}
+
+Void TComPIPCodebookTrainer::initBySplitting( const Short* blocks, UInt numBlocks, UInt rowLen, Int iterationsPerSplit )
+{
+  // one codeword: the centroid of all the blocks
+  m_numActive = 1;
+  std::fill( m_codebook.begin(), m_codebook.begin() + m_size, 0 );
+  iterate( blocks, numBlocks, rowLen );
+
+  while( m_numActive < m_numCodewords )
+  {
+    // c -> c - 1, c + 1
+    const Int numSplit = std::min( m_numActive, m_numCodewords - m_numActive );
+    for( Int c = 0; c < numSplit; c++ )
+    {
+      Short* pSrc = &m_codebook[c * m_size];
+      Short* pDst = &m_codebook[( m_numActive + c ) * m_size];
+      for( Int p = 0; p < m_size; p++ )
+      {
+        pDst[p] = xClipRes( pSrc[p] + 1 );
+        pSrc[p] = xClipRes( pSrc[p] - 1 );
+      }
+    }
+    m_numActive += numSplit;
+    for( Int l = 0; l < iterationsPerSplit; l++ )
+    {
+      iterate( blocks, numBlocks, rowLen );
+    }
+  }
+}
+
+Void TComPIPCodebookTrainer::getMinResidual( const Short* row, Int width, Int height, Short* res )
+{
+  // row: corner, above (width), left (height), original (width x height)
+  const Short* above = row + 1;
+  const Short* left  = row + 1 + width;
+  const Short* org   = row + 1 + width + height;
+  for( Int y = 0; y < height; y++ )
+  {
+    for( Int x = 0; x < width; x++ )
+    {
+      const Int A = x ? org[y * width + x - 1] : left[y];
+      const Int B = x && y ? org[( y - 1 ) * width + x - 1] : y ? left[y - 1] : x ? above[x - 1] : row[0];
+      const Int C = y ? org[( y - 1 ) * width + x] : above[x];
+      const Int X = B >= std::max( A, C ) ? std::min( A, C ) : B <= std::min( A, C ) ? std::max( A, C ) : A + C - B;
+      res[y * width + x] = xClipRes( org[y * width + x] - X );
+    }
+  }
+}
+
+Int TComPIPCodebookTrainer::findNearest( const Short* vec, const Short* codebook, Int numCodewords, Int size, UInt& rDist )
+{
+  // |a - b| <= 2 * MAX_ABS, so a squared distance of MAX_SIZE samples fits in 31 bits
+  UInt bestDist = MAX_UINT;
+  Int  bestIdx  = 0;
+#if COM16_C806_SIMD_OPT
+  __m128i v[MAX_SIZE / 8];
+  for( Int k = 0; k < size / 8; k++ )
+  {
+    v[k] = _mm_loadu_si128( ( const __m128i* )( vec + 8 * k ) );
+  }
+  for( Int c = 0; c < numCodewords; c++ )
+  {
+    const Short* cw  = codebook + c * size;
+    __m128i      acc = _mm_setzero_si128();
+    UInt         dist = 0;
+    Int          k    = 0;
+    while( k < size / 8 )
+    {
+      const __m128i d = _mm_sub_epi16( v[k], _mm_loadu_si128( ( const __m128i* )( cw + 8 * k ) ) );
+      acc = _mm_add_epi32( acc, _mm_madd_epi16( d, d ) );
+      k++;
+      // early termination every 16 samples
+      if( !( k & 1 ) || k == size / 8 )
+      {
+        __m128i s = _mm_add_epi32( acc, _mm_shuffle_epi32( acc, 0x4E ) );
+        s    = _mm_add_epi32( s, _mm_shuffle_epi32( s, 0xB1 ) );
+        dist = UInt( _mm_cvtsi128_si32( s ) );
+        if( dist >= bestDist )
+        {
+          break;
+        }
+      }
+    }
+    if( dist < bestDist )
+    {
+      bestDist = dist;
+      bestIdx  = c;
+    }
+  }
+#else
+  for( Int c = 0; c < numCodewords; c++ )
+  {
+    const Short* cw   = codebook + c * size;
+    UInt         dist = 0;
+    for( Int p = 0; p < size && dist < bestDist; p++ )
+    {
+      const Int d = vec[p] - cw[p];
+      dist += UInt( d * d );
+    }
+    if( dist < bestDist )
+    {
+      bestDist = dist;
+      bestIdx  = c;
+    }
+  }
+#endif
+  rDist = bestDist;
+  return bestIdx;
+}
+
+Void TComPIPCodebookTrainer::xAssign( const Short* blocks, UInt firstBlock, UInt endBlock, UInt rowLen, Accumulator& rAcc ) const
+{
+  std::fill( rAcc.sums.begin(), rAcc.sums.begin() + m_numActive * m_size, 0 );
+  std::fill( rAcc.counts.begin(), rAcc.counts.begin() + m_numActive, 0 );
+  rAcc.dist = 0;
+
+  Short res[MAX_SIZE];
+  for( UInt b = firstBlock; b < endBlock; b++ )
+  {
+    getMinResidual( blocks + size_t( b ) * rowLen, m_width, m_height, res );
+    UInt      dist;
+    const Int c = findNearest( res, &m_codebook[0], m_numActive, m_size, dist );
+    Int64* pSum = &rAcc.sums[c * m_size];
+    for( Int p = 0; p < m_size; p++ )
+    {
+      pSum[p] += res[p];
+    }
+    rAcc.counts[c]++;
+    rAcc.dist += dist;
+  }
+}
+
+Void TComPIPCodebookTrainer::xUpdate( Int numCodewords )
+{
+  // centroids: sums over all the tasks, rounded half away from zero; integer sums do not depend
+  // on how the blocks were split between the tasks
+  const Int numTasks = Int( m_acc.size() );
+  m_cPool.parallelFor( numTasks, [&]( Int task )
+  {
+    const Int first = numCodewords * task / numTasks;
+    const Int end   = numCodewords * ( task + 1 ) / numTasks;
+    for( Int c = first; c < end; c++ )
+    {
+      UInt count = 0;
+      for( Int t = 0; t < numTasks; t++ )
+      {
+        count += m_acc[t].counts[c];
+      }
+      m_counts[c] = count;
+      if( !count )
+      {
+        continue;
+      }
+      for( Int p = 0; p < m_size; p++ )
+      {
+        Int64 sum = 0;
+        for( Int t = 0; t < numTasks; t++ )
+        {
+          sum += m_acc[t].sums[c * m_size + p];
+        }
+        const Int64 mean = ( 2 * ( sum < 0 ? -sum : sum ) + count ) / ( 2 * Int64( count ) );
+        m_codebook[c * m_size + p] = xClipRes( Int( sum < 0 ? -mean : mean ) );
+      }
+    }
+  } );
+
+  // an empty cell takes half of the most populated one
+  for( Int c = 0; c < numCodewords; c++ )
+  {
+    if( m_counts[c] )
+    {
+      continue;
+    }
+    const Int donor = Int( std::max_element( m_counts.begin(), m_counts.begin() + numCodewords ) - m_counts.begin() );
+    if( !m_counts[donor] )
+    {
+      break;
+    }
+    for( Int p = 0; p < m_size; p++ )
+    {
+      m_codebook[c * m_size + p]     = xClipRes( m_codebook[donor * m_size + p] + 1 );
+      m_codebook[donor * m_size + p] = xClipRes( m_codebook[donor * m_size + p] - 1 );
+    }
+    m_counts[c]     = m_counts[donor] / 2;
+    m_counts[donor] = m_counts[donor] - m_counts[c];
+  }
+}
+
+Double TComPIPCodebookTrainer::iterate( const Short* blocks, UInt numBlocks, UInt rowLen )
+{
+  assert( rowLen == UInt( m_width + m_height + 1 + m_size ) );
+  const Int numTasks = Int( m_acc.size() );
+  m_cPool.parallelFor( numTasks, [&]( Int task )
+  {
+    xAssign( blocks, UInt( UInt64( numBlocks ) * task / numTasks ), UInt( UInt64( numBlocks ) * ( task + 1 ) / numTasks ), rowLen, m_acc[task] );
+  } );
+
+  m_lastDist = 0;
+  for( Int t = 0; t < numTasks; t++ )
+  {
+    m_lastDist += m_acc[t].dist;
+  }
+  xUpdate( m_numActive );
+  return numBlocks ? Double( m_lastDist ) / ( Double( numBlocks ) * m_size ) : 0;
+}
+
+Double TComPIPCodebookTrainer::train( const Short* blocks, UInt numBlocks, UInt rowLen, Int maxIterations, Double threshold )
+{
+  Double dist = MAX_DOUBLE;
+  for( Int l = 0; l < maxIterations; l++ )
+  {
+    const Double lastDist = dist;
+    dist = iterate( blocks, numBlocks, rowLen );
+    if( lastDist < MAX_DOUBLE && lastDist - dist <= threshold * lastDist )
+    {
+      break;
+    }
+  }
+  return dist;
+}
+
+//! \}
@@ -0,0 +1,120 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2015, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TComPIPCodebookTrainer.h
+    \brief    LGB (generalized Lloyd) training of the PIP codebooks
+*/
+
+#ifndef __TCOMPIPCODEBOOKTRAINER__
+#define __TCOMPIPCODEBOOKTRAINER__
+
+#include "CommonDef.h"
+#include "TComThreadPool.h"
+#include <vector>
+
+//! \ingroup TLibCommon
+//! \{
+
+/** LGB training of the codebook of one PIP block size, the engine of CodebookConstruction without
+ *  the encoder around it. The training vector of a block is its minimum residual: the original
+ *  minus the MED prediction from the original neighbours (the references on the block borders).
+ *
+ *  The blocks are read in one sequential pass per iteration (rows of TComPIPCodebookFile: W+H+1
+ *  references then W*H original samples, usually straight from the mapped container) and nothing
+ *  is kept per block, so the number of blocks is not limited by the memory. Each thread assigns a
+ *  contiguous range of blocks to their nearest codewords (SSE4.1 squared distance with early
+ *  termination) and sums them per codeword; the sums are integers, so the centroids, and thus the
+ *  codebooks, are the same for any number of threads. Ties go to the lowest codeword index.
+ */
+class TComPIPCodebookTrainer
+{
+public:
+  /// training vectors and codewords are clipped to +-MAX_ABS (residuals of up to 12-bit video)
+  static const Int MAX_ABS  = 2047;
+  /// W*H is a multiple of 8 and at most MAX_SIZE, so a squared distance fits in 32 bits
+  static const Int MAX_SIZE = 64;
+
+  TComPIPCodebookTrainer();
+  ~TComPIPCodebookTrainer();
+
+  Void   create          ( Int width, Int height, Int numCodewords, Int numThreads );
+  Void   destroy         ();
+
+  /// starts from a given codebook of numCodewords vectors
+  Void   initCodebook    ( const Short* codebook );
+  /// starts from the mean of the blocks and splits every codeword in two until there are numCodewords
+  /// (iterationsPerSplit LGB iterations after each split)
+  Void   initBySplitting ( const Short* blocks, UInt numBlocks, UInt rowLen, Int iterationsPerSplit );
+
+  /// one LGB iteration: assignment and centroid update; returns the mean squared distance per sample
+  Double iterate         ( const Short* blocks, UInt numBlocks, UInt rowLen );
+  /// iterates until the relative distortion decrease is below threshold or maxIterations is reached
+  Double train           ( const Short* blocks, UInt numBlocks, UInt rowLen, Int maxIterations, Double threshold );
+
+  Int    getNumCodewords ()                     const { return m_numCodewords; }
+  const Short* getCodeword( Int i )             const { return &m_codebook[i * m_size]; }
+  /// blocks assigned to each codeword by the last iteration
+  const std::vector<UInt>& getCounts()          const { return m_counts; }
+
+  /// minimum residual of one block row (W+H+1 references, then the original)
+  static Void  getMinResidual( const Short* row, Int width, Int height, Short* res );
+  /// index of the nearest codeword and its squared distance
+  static Int   findNearest   ( const Short* vec, const Short* codebook, Int numCodewords, Int size, UInt& rDist );
+
+private:
+  /// sums of one range of blocks
+  struct Accumulator
+  {
+    std::vector<Int64> sums;                             ///< numCodewords x size
+    std::vector<UInt>  counts;
+    Int64              dist;
+  };
+
+  Void   xAssign         ( const Short* blocks, UInt firstBlock, UInt endBlock, UInt rowLen, Accumulator& rAcc ) const;
+  Void   xUpdate         ( Int numCodewords );
+
+  Int                      m_width;
+  Int                      m_height;
+  Int                      m_size;
+  Int                      m_numCodewords;
+  Int                      m_numActive;                  ///< codewords in use while splitting
+  std::vector<Short>       m_codebook;
+  std::vector<UInt>        m_counts;
+  std::vector<Accumulator> m_acc;                        ///< one per task
+  Int64                    m_lastDist;
+  TComThreadPool           m_cPool;
+};
+
+//! \}
+
+#endif // __TCOMPIPCODEBOOKTRAINER__
@@ -0,0 +1,524 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2015, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TComPIPContext.cpp
+    \brief    state of the progressive intra prediction (PIP) of one encoder or decoder instance
+*/
+
+#include "TComPIPContext.h"
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+//! \ingroup TLibCommon
+//! \{
+
+#if PIP
+
+// ====================================================================================================================
+// TComPIPStats
+// ====================================================================================================================
+
+Void TComPIPStats::reset()
+{
+  memset( cbfStats, 0, sizeof( cbfStats ) );
+  totalPIPbits = 0;
+  totalAllbits = 0;
+  allCUCount   = 0;
+  validCUCount = 0;
+  pipCUCount   = 0;
+  memset( sizeStats, 0, sizeof( sizeStats ) );
+#if PIP_RATE_EST_CHECK
+  rateEstMaxDev = 0;
+  rateEstSumDev = 0;
+  rateEstCount  = 0;
+#endif
+#if SRDOQ_TIMING
+  memset( searchTime, 0, sizeof( searchTime ) );
+  memset( searchCount, 0, sizeof( searchCount ) );
+#endif
+
+  memset( qtCbfBins, 0, sizeof( qtCbfBins ) );
+  memset( qtCbfOnes, 0, sizeof( qtCbfOnes ) );
+  memset( pipFlagBins, 0, sizeof( pipFlagBins ) );
+  memset( pipFlagOnes, 0, sizeof( pipFlagOnes ) );
+  memset( r1GrBins, 0, sizeof( r1GrBins ) );
+  memset( r1GrOnes, 0, sizeof( r1GrOnes ) );
+  r1SignBins = 0;
+  r1SignOnes = 0;
+}
+
+Void TComPIPStats::merge( const TComPIPStats& rcStats )
+{
+  for( Int i = 0; i < 4; i++ )
+  {
+    cbfStats[i] += rcStats.cbfStats[i];
+  }
+  totalPIPbits += rcStats.totalPIPbits;
+  totalAllbits += rcStats.totalAllbits;
+  allCUCount   += rcStats.allCUCount;
+  validCUCount += rcStats.validCUCount;
+  pipCUCount   += rcStats.pipCUCount;
+  for( Int i = 0; i < PIP_NUM_SIZE_STATS; i++ )
+  {
+    sizeStats[0][i] += rcStats.sizeStats[0][i];
+    sizeStats[1][i] += rcStats.sizeStats[1][i];
+  }
+#if PIP_RATE_EST_CHECK
+  rateEstMaxDev  = std::max( rateEstMaxDev, rcStats.rateEstMaxDev );
+  rateEstSumDev += rcStats.rateEstSumDev;
+  rateEstCount  += rcStats.rateEstCount;
+#endif
+#if SRDOQ_TIMING
+  for( Int i = 0; i < 4; i++ )
+  {
+    searchTime[i]  += rcStats.searchTime[i];
+    searchCount[i] += rcStats.searchCount[i];
+  }
+#endif
+
+  for( Int i = 0; i < 5; i++ )
+  {
+    qtCbfBins[i]   += rcStats.qtCbfBins[i];
+    qtCbfOnes[i]   += rcStats.qtCbfOnes[i];
+    pipFlagBins[i] += rcStats.pipFlagBins[i];
+    pipFlagOnes[i] += rcStats.pipFlagOnes[i];
+  }
+  for( Int i = 0; i < 16; i++ )
+  {
+    r1GrBins[i] += rcStats.r1GrBins[i];
+    r1GrOnes[i] += rcStats.r1GrOnes[i];
+  }
+  r1SignBins += rcStats.r1SignBins;
+  r1SignOnes += rcStats.r1SignOnes;
+}
+
+Bool TComPIPStats::parseFormat( const std::string& rcName, PIPStatsFormat& reFormat )
+{
+  if( rcName == "none" )
+  {
+    reFormat = PIP_STATS_NONE;
+  }
+  else if( rcName == "text" )
+  {
+    reFormat = PIP_STATS_TEXT;
+  }
+  else if( rcName == "json" )
+  {
+    reFormat = PIP_STATS_JSON;
+  }
+  else
+  {
+    return false;
+  }
+  return true;
+}
+
+static inline Double xRatio( Double num, Double den )
+{
+  return den > 0 ? num / den : 0;
+}
+
+/// bins of one group of contexts as a JSON array of {bins, ones}
+static Void xJsonBins( FILE* fp, const Char* name, const Int* bins, const Int* ones, Int num, Bool last )
+{
+  fprintf( fp, "    \"%s\": [", name );
+  for( Int c = 0; c < num; c++ )
+  {
+    fprintf( fp, "%s{ \"bins\": %d, \"ones\": %d }", c ? ", " : "", bins[c], ones[c] );
+  }
+  fprintf( fp, "]%s\n", last ? "" : "," );
+}
+
+static Void xTextBins( FILE* fp, const Char* name, const Int* bins, const Int* ones, Int num )
+{
+  fprintf( fp, "%-10s", name );
+  for( Int c = 0; c < num; c++ )
+  {
+    fprintf( fp, "  %1.3f (%6d)", xRatio( ones[c], bins[c] ), bins[c] );
+  }
+  fprintf( fp, "\n" );
+}
+
+Void TComPIPStats::report( FILE* fp, PIPStatsFormat eFormat, Bool bDecoder ) const
+{
+  if( eFormat == PIP_STATS_NONE )
+  {
+    return;
+  }
+  const Int base = Int( log2( (Double)CUMAX ) ) - 1;
+
+  if( eFormat == PIP_STATS_JSON )
+  {
+    fprintf( fp, "{\n  \"pipStats\": %s,\n", PIP_STATS ? "true" : "false" );
+    if( bDecoder )
+    {
+      fprintf( fp, "  \"decoder\": {\n" );
+      xJsonBins( fp, "qtCbf",   qtCbfBins,   qtCbfOnes,   5,  false );
+      xJsonBins( fp, "pipFlag", pipFlagBins, pipFlagOnes, 5,  false );
+      xJsonBins( fp, "r1Level", r1GrBins,    r1GrOnes,    16, false );
+      xJsonBins( fp, "r1Sign",  &r1SignBins, &r1SignOnes, 1,  true );
+      fprintf( fp, "  }\n}\n" );
+      return;
+    }
+    fprintf( fp, "  \"encoder\": {\n" );
+    fprintf( fp, "    \"lumaCUs\": %d,\n    \"pipValidCUs\": %d,\n    \"pipCUs\": %d,\n", allCUCount, validCUCount, pipCUCount );
+    fprintf( fp, "    \"sizes\": [" );
+    for( Int j = 0; j < base; j++ )
+    {
+      for( Int i = 0; i < base; i++ )
+      {
+        const Int idx = base * j + i;
+        fprintf( fp, "%s{ \"width\": %d, \"height\": %d, \"cus\": %d, \"pipCUs\": %d }", idx ? ", " : "", 1 << ( i + 2 ), 1 << ( j + 2 ), sizeStats[0][idx], sizeStats[1][idx] );
+      }
+    }
+    fprintf( fp, "],\n" );
+    fprintf( fp, "    \"jemBlocks\": %d,\n    \"jemCbf1\": %d,\n    \"pipBlocks\": %d,\n    \"pipCbf1\": %d,\n", cbfStats[0], cbfStats[2], cbfStats[1], cbfStats[3] );
+#if PIP_RATE_EST_CHECK
+    fprintf( fp, "    \"rateEstimate\": { \"candidates\": %d, \"maxDeviation\": %.3f, \"meanDeviation\": %.3f },\n", rateEstCount, rateEstMaxDev, xRatio( rateEstSumDev, rateEstCount ) );
+#endif
+#if SRDOQ_TIMING
+    fprintf( fp, "    \"searchTime\": [" );
+    for( Int i = 0; i < 4; i++ )
+    {
+      fprintf( fp, "%s{ \"width\": %d, \"height\": %d, \"blocks\": %d, \"seconds\": %.3f }", i ? ", " : "", 4 << ( i >> 1 ), 4 << ( i & 1 ), searchCount[i], searchTime[i] );
+    }
+    fprintf( fp, "],\n" );
+#endif
+    fprintf( fp, "    \"pipBits\": %.0f,\n    \"allBits\": %.0f\n  }\n}\n", totalPIPbits, totalAllbits );
+    return;
+  }
+
+  if( bDecoder )
+  {
+    fprintf( fp, "\nPIP bins: rate of ones (bins) per context\n" );
+    xTextBins( fp, "qtCbf",   qtCbfBins,   qtCbfOnes,   5 );
+    xTextBins( fp, "pipFlag", pipFlagBins, pipFlagOnes, 5 );
+    xTextBins( fp, "r1Level", r1GrBins,    r1GrOnes,    16 );
+    xTextBins( fp, "r1Sign",  &r1SignBins, &r1SignOnes, 1 );
+    return;
+  }
+
+  fprintf( fp, "All Luma CUs:%d\n", allCUCount );
+  fprintf( fp, "All PIP valid CUs:%d\n", validCUCount );
+  fprintf( fp, "All PIP CUs:%d\n", pipCUCount );
+  fprintf( fp, "%f\n", xRatio( pipCUCount, validCUCount ) );
+  fprintf( fp, "%f\n", xRatio( pipCUCount, allCUCount ) );
+
+  fprintf( fp, "\n\n------------------------------\n" );
+  for( Int j = 0; j < base; j++ )
+  {
+    for( Int i = 0; i < base; i++ )
+    {
+      fprintf( fp, "%dx%d\t\t\t", 1 << ( i + 2 ), 1 << ( j + 2 ) );
+    }
+  }
+  fprintf( fp, "all\n" );
+  // rows: CUs, PIP CUs and the PIP rate of each size, then of all the luma CUs
+  for( Int k = 0; k < 3; k++ )
+  {
+    for( Int idx = 0; idx <= base * base; idx++ )
+    {
+      const Int  s    = idx < base * base ? idx : 1 << base;
+      const Char sep  = idx < base * base ? '\t' : '\n';
+      if( k < 2 )
+      {
+        fprintf( fp, "%5d\t\t%c", sizeStats[k][s], sep );
+      }
+      else
+      {
+        fprintf( fp, "%1.2f\t\t%c", xRatio( sizeStats[1][s], sizeStats[0][s] ), sep );
+      }
+    }
+  }
+#if PIP_RATE_EST_CHECK
+  fprintf( fp, "\nPIP rate estimate: %d candidates, max deviation %.3f bits, mean %.3f bits\n", rateEstCount, rateEstMaxDev, xRatio( rateEstSumDev, rateEstCount ) );
+#endif
+#if SRDOQ_TIMING
+  fprintf( fp, "\nPIP search time\n" );
+  for( Int i = 0; i < 4; i++ )
+  {
+    if( searchCount[i] )
+    {
+      fprintf( fp, "%dx%d\t%8d blocks\t%9.3f s\t%8.2f us/block\n", 4 << ( i >> 1 ), 4 << ( i & 1 ), searchCount[i], searchTime[i], 1e6 * searchTime[i] / searchCount[i] );
+    }
+  }
+#endif
+  fprintf( fp, "\nJEM blocks count: %6d, CBF1 rate: %f\nPIP blocks count: %6d, CBF1 rate: %f\n", cbfStats[0], xRatio( cbfStats[2], cbfStats[0] ), cbfStats[1], xRatio( cbfStats[3], cbfStats[1] ) );
+  fprintf( fp, "Total PIP Bits: %f\nTotal All Bits: %f\n", totalPIPbits, totalAllbits );
+}
+
+// ====================================================================================================================
+// TComPIPContext
+// ====================================================================================================================
+
+TComPIPContext::TComPIPContext()
+: m_spQ                 ( 20 )
+, m_codebooks           ( NULL )
+, m_nextCodebooks       ( NULL )
+, m_nextCodebooksCnt    ( NULL )
+, m_rates               ( NULL )
+, m_codebookDir         ( "../../../CB/" )
+, m_fastRateEst         ( false )
+#if PIP_R1_HT_BINARIZATION
+, m_r1HighThroughput    ( false )
+#endif
+{
+  memset( m_spQOffset, 0, sizeof( m_spQOffset ) );
+  createThreadStats( 1 );
+}
+
+TComPIPContext::~TComPIPContext()
+{
+  destroy();
+}
+
+Void TComPIPContext::destroy()
+{
+  const Int base = Int( log2( (Double)CUMAX ) ) - 1;
+  if( m_codebooks )
+  {
+    for( Int i = 0; i < base; i++ )
+    {
+      for( Int j = 0; j < base; j++ )
+      {
+        const Int idx   = base * i + j;
+        const Int count = ( 1 << ( i + 2 ) ) * ( 1 << ( j + 2 ) ) * CBf;
+        for( Int v = 0; v < count; v++ )
+        {
+          delete[] m_codebooks[idx][v];
+          delete[] m_nextCodebooks[idx][v];
+        }
+        delete[] m_codebooks[idx];
+        delete[] m_nextCodebooks[idx];
+        delete[] m_nextCodebooksCnt[idx];
+      }
+    }
+    delete[] m_codebooks;
+    delete[] m_nextCodebooks;
+    delete[] m_nextCodebooksCnt;
+    m_codebooks        = NULL;
+    m_nextCodebooks    = NULL;
+    m_nextCodebooksCnt = NULL;
+  }
+  m_codebookFile.close();
+  m_textBlocks.clear();
+  if( m_rates )
+  {
+    for( Int q = 0; q < 9; q++ )
+    {
+      delete[] m_rates[q];
+    }
+    delete[] m_rates;
+    m_rates = NULL;
+  }
+}
+
+Void TComPIPContext::setSpQOffsets( Int iQP )
+{
+  memset( m_spQOffset, 0, sizeof( m_spQOffset ) );
+#if CUMAX == 8
+  static const Int offsets[4][4] =
+  {
+    {  2,  1,  2,  1 }, // QP 22
+    { -1, -1, -2, -2 }, // QP 27
+    {  2,  1, -2,  2 }, // QP 32
+    {  1,  2,  2,  1 }, // QP 37
+  };
+  const Int qpIdx = iQP == 22 ? 0 : iQP == 27 ? 1 : iQP == 32 ? 2 : iQP == 37 ? 3 : -1;
+  if( qpIdx >= 0 )
+  {
+    memcpy( m_spQOffset, offsets[qpIdx], sizeof( m_spQOffset ) );
+  }
+#endif
+}
+
+Int TComPIPContext::getSpQOffset( Int w, Int h ) const
+{
+  if( ( w != 4 && w != 8 ) || ( h != 4 && h != 8 ) )
+  {
+    return 0;
+  }
+  return m_spQOffset[( w == 8 ) * 2 + ( h == 8 )];
+}
+
+Void TComPIPContext::createCodebooks()
+{
+  if( m_codebooks )
+  {
+    return;
+  }
+  const Int base = Int( log2( (Double)CUMAX ) ) - 1;
+  m_codebooks        = new Int**[base * base];
+  m_nextCodebooks    = new Int**[base * base];
+  m_nextCodebooksCnt = new Int*[base * base];
+  for( Int i = 0; i < base; i++ )
+  {
+    for( Int j = 0; j < base; j++ )
+    {
+      const Int h     = 1 << ( i + 2 );
+      const Int w     = 1 << ( j + 2 );
+      const Int idx   = base * i + j;
+      const Int count = h * w * CBf;
+      m_codebooks[idx]        = new Int*[count];
+      m_nextCodebooks[idx]    = new Int*[count];
+      m_nextCodebooksCnt[idx] = new Int[count];
+      memset( m_nextCodebooksCnt[idx], 0, count * sizeof( Int ) );
+      for( Int v = 0; v < count; v++ )
+      {
+        m_codebooks[idx][v]     = new Int[w * h];
+        m_nextCodebooks[idx][v] = new Int[w * h];
+        memset( m_codebooks[idx][v], 0, w * h * sizeof( Int ) );
+        memset( m_nextCodebooks[idx][v], 0, w * h * sizeof( Int ) );
+      }
+    }
+  }
+}
+
+Bool TComPIPContext::loadCodebooks( Int qp )
+{
+  createCodebooks();
+  const Int base = Int( log2( (Double)CUMAX ) ) - 1;
+  Bool      ok   = true;
+  for( Int i = 0; i < base; i++ )
+  {
+    for( Int j = 0; j < base; j++ )
+    {
+      const UInt h     = 1 << ( i + 2 );
+      const UInt w     = 1 << ( j + 2 );
+      const Int  idx   = base * i + j;
+      const UInt count = h * w * CBf;
+
+      // the codebooks are copied: the training updates them in place
+      TComPIPCodebookFile::Section textSection;
+      UInt         rows = 0, rowLen = 0;
+      const Short* pSrc = m_codebookFile.isOpen() ? m_codebookFile.getSection( TComPIPCodebookFile::SECTION_CODEBOOK, qp, w, h, rows, rowLen ) : NULL;
+      if( !pSrc && !m_codebookFile.isOpen() && TComPIPCodebookFile::readTextCodebook( TComPIPCodebookFile::textCodebookName( m_codebookDir, qp, w, h ), qp, w, h, textSection ) && textSection.rows )
+      {
+        pSrc   = &textSection.data[0];
+        rows   = textSection.rows;
+        rowLen = textSection.rowLen;
+      }
+      if( !pSrc || rowLen != w * h )
+      {
+        ok = false;
+        continue;
+      }
+      for( UInt v = 0; v < std::min( rows, count ); v++ )
+      {
+        for( UInt p = 0; p < w * h; p++ )
+        {
+          m_codebooks[idx][v][p]     = pSrc[v * rowLen + p];
+          m_nextCodebooks[idx][v][p] = 0;
+        }
+        m_nextCodebooksCnt[idx][v] = 0;
+      }
+    }
+  }
+  return ok;
+}
+
+const Short* TComPIPContext::getTrainingBlocks( Int qp, UInt width, UInt height, UInt& rNumBlocks, UInt& rRowLen )
+{
+  if( m_codebookFile.isOpen() )
+  {
+    return m_codebookFile.getSection( TComPIPCodebookFile::SECTION_BLOCKS, qp, width, height, rNumBlocks, rRowLen );
+  }
+  for( size_t s = 0; s < m_textBlocks.size(); s++ )
+  {
+    const TComPIPCodebookFile::Section& rcSec = m_textBlocks[s];
+    if( rcSec.qp == qp && rcSec.width == width && rcSec.height == height )
+    {
+      rNumBlocks = rcSec.rows;
+      rRowLen    = rcSec.rowLen;
+      return rcSec.rows ? &rcSec.data[0] : NULL;
+    }
+  }
+  TComPIPCodebookFile::Section section;
+  if( !TComPIPCodebookFile::readTextBlocks( TComPIPCodebookFile::textBlocksName( m_codebookDir, qp, width, height ), qp, width, height, section ) )
+  {
+    rNumBlocks = 0;
+    rRowLen    = 0;
+    return NULL;
+  }
+  m_textBlocks.push_back( section );
+  return getTrainingBlocks( qp, width, height, rNumBlocks, rRowLen );
+}
+
+Void TComPIPContext::loadRates( const Char* fileName )
+{
+  if( !m_rates )
+  {
+    m_rates = new Double*[9];
+    for( Int q = 0; q < 9; q++ )
+    {
+      m_rates[q] = new Double[1 << ( q + 1 )];
+    }
+  }
+
+  std::ifstream inRates( fileName, std::ios::in );
+  if( inRates.is_open() )
+  {
+    std::string line, delimiter = "\t", token;
+    Int qCnt = 0;
+    while( qCnt < 9 && getline( inRates, line ) )
+    {
+      for( Int rCnt = 0; rCnt < ( 1 << ( qCnt + 1 ) ); rCnt++ )
+      {
+        token = line.substr( 0, line.find( delimiter ) );
+        line.erase( 0, line.find( delimiter ) + 1 );
+        m_rates[qCnt][rCnt] = atof( token.c_str() );
+      }
+      qCnt++;
+    }
+  }
+}
+
+Void TComPIPContext::createThreadStats( Int numThreads )
+{
+  m_threadStats.assign( std::max( numThreads, 1 ), TComPIPStats() );
+}
+
+Void TComPIPContext::mergePictureStats()
+{
+  for( size_t t = 0; t < m_threadStats.size(); t++ )
+  {
+    m_totalStats.merge( m_threadStats[t] );
+    m_threadStats[t].reset();
+  }
+}
+
+#endif
+
+//! \}
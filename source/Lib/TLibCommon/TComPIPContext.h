@@ -0,0 +1,221 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2015, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TComPIPContext.h
+    \brief    state of the progressive intra prediction (PIP) of one encoder or decoder instance
+*/
+
+#ifndef __TCOMPIPCONTEXT__
+#define __TCOMPIPCONTEXT__
+
+#include "CommonDef.h"
+#include "TComPIPCodebookFile.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+//! \ingroup TLibCommon
+//! \{
+
+#if PIP
+
+class TEncSearch;
+
+/// number of PIP block sizes (WxH with W,H <= CUMAX) plus one entry for all the luma CUs
+static const Int PIP_NUM_SIZE_STATS = CUMAX / 2 + 1;
+
+/// output of the PIP statistics report (--pip-stats)
+enum PIPStatsFormat
+{
+  PIP_STATS_NONE = 0,
+  PIP_STATS_TEXT,
+  PIP_STATS_JSON
+};
+
+/** Update policy of the PIP counters. The coders count through PIPStatsPolicy only; with PIP_STATS 0
+ *  it is the empty specialization and the counting is compiled out of the coding loops.
+ */
+template <Bool bEnabled>
+struct TComPIPStatsPolicy
+{
+  template <typename T>
+  static Void add   ( T& rCounter, T value )                { rCounter += value; }
+  static Void inc   ( Int& rCounter )                       { rCounter++; }
+  static Void addBin( Int& rBins, Int& rOnes, UInt uiBin )  { rBins++; rOnes += Int( uiBin ); }
+};
+
+template <>
+struct TComPIPStatsPolicy<false>
+{
+  template <typename T>
+  static Void add   ( T&, T )                               {}
+  static Void inc   ( Int& )                                {}
+  static Void addBin( Int&, Int&, UInt )                    {}
+};
+
+typedef TComPIPStatsPolicy<PIP_STATS != 0> PIPStatsPolicy;
+
+/** Counters of the PIP tools. Every coding thread writes to its own set; the sets are merged into
+ *  the totals of the context at picture end, so no counter is shared between threads.
+ */
+struct TComPIPStats
+{
+  TComPIPStats()                                    { reset(); }
+
+  Void reset();
+  Void merge( const TComPIPStats& rcStats );
+  /// prints the encoder or the decoder counters
+  Void report( FILE* fp, PIPStatsFormat eFormat, Bool bDecoder ) const;
+
+  /// "none", "text" or "json"; returns false for any other name
+  static Bool parseFormat( const std::string& rcName, PIPStatsFormat& reFormat );
+
+  // encoder
+  Int    cbfStats[4];                                    ///< [0] JEM / [1] PIP luma blocks, [2] JEM / [3] PIP blocks with CBF 1
+  Double totalPIPbits;                                   ///< bits of the logged 4x4 PIP residuals
+  Double totalAllbits;                                   ///< bits of the coded pictures
+  Int    allCUCount;                                     ///< luma CUs
+  Int    validCUCount;                                   ///< luma CUs of a PIP size
+  Int    pipCUCount;                                     ///< luma CUs coded with PIP
+  Int    sizeStats[2][PIP_NUM_SIZE_STATS];               ///< [0] CUs, [1] PIP CUs of each size; last entry: all sizes
+#if PIP_RATE_EST_CHECK
+  Double rateEstMaxDev;                                  ///< bits
+  Double rateEstSumDev;
+  Int    rateEstCount;
+#endif
+#if SRDOQ_TIMING
+  Double searchTime[4];                                  ///< 4x4, 4x8, 8x4, 8x8
+  Int    searchCount[4];
+#endif
+
+  // decoder: bins and ones of the PIP context models
+  Int    qtCbfBins[5],  qtCbfOnes[5];
+  Int    pipFlagBins[5], pipFlagOnes[5];
+  Int    r1GrBins[16],  r1GrOnes[16];
+  Int    r1SignBins,    r1SignOnes;
+};
+
+/** Flags shared between the search and the entropy coders of the encoder, set and reset around their
+ *  calls. TEncTop and every TEncCtuWorker own one and hand it to their search and coders, so the CTU
+ *  rows coded concurrently do not see each other's flags.
+ */
+struct TComPIPCoderState
+{
+  TComPIPCoderState() : encodeTime( false ), tmpFlag( false ), spatialCodeCoeffNxN2( false ) {}
+
+  Bool   encodeTime;                                     ///< the CTU is coded into the bitstream, not estimated
+  Bool   tmpFlag;                                        ///< performILRBlock_r1CodecoeffNxN() is coding a block (R1_CODECOEFFNXN_TEST)
+  Bool   spatialCodeCoeffNxN2;                           ///< the coefficients of tmpSpR1 are coded instead of the block
+  TCoeff tmpSpR1[CUMAX*CUMAX];
+};
+
+/** PIP state of one TEncTop or TDecTop: spatial quantizer, codebooks, rate tables and the statistics.
+ *  Nothing of it is process global, so several encoders and decoders can run in one process.
+ */
+class TComPIPContext
+{
+public:
+  TComPIPContext();
+  ~TComPIPContext();
+
+  Void   destroy             ();
+
+  // spatial quantizer
+  Void   setSpQ              ( Int spQ )              { m_spQ = spQ; }
+  Int    getSpQ              ()                 const { return m_spQ; }
+  Void   setSpQOffsets       ( Int iQP );             ///< per block size offsets of the spatial step (CUMAX 8)
+  Int    getSpQOffset        ( Int w, Int h )   const;
+  Int    getQStep            ( Int w, Int h )   const { return m_spQ + getSpQOffset( w, h ); }
+
+  // codebooks and rate tables
+  Void   createCodebooks     ();
+  Int*** getCodebooks        ()                       { return m_codebooks; }
+  Int*** getNextCodebooks    ()                       { return m_nextCodebooks; }
+  Int**  getNextCodebooksCnt ()                       { return m_nextCodebooksCnt; }
+  Void   loadRates           ( const Char* fileName );
+  Double** getRates          ()                       { return m_rates; }
+
+  // codebook and training block files
+  Void   setCodebookDir      ( const std::string& dir ) { m_codebookDir = dir; }
+  const std::string& getCodebookDir()           const { return m_codebookDir; }
+  /// maps a binary container (TComPIPCodebookFile); without one the text files of the codebook directory are read
+  Bool   openCodebookFile    ( const std::string& fileName ) { return m_codebookFile.open( fileName ); }
+  const TComPIPCodebookFile& getCodebookFile()  const { return m_codebookFile; }
+  /// fills the codebooks of all the sizes with the ones of a QP and clears the next codebooks; false if one is missing
+  Bool   loadCodebooks       ( Int qp );
+  /// training blocks of a QP and size, rowLen = W+H+1 references followed by W*H original samples
+  const Short* getTrainingBlocks( Int qp, UInt width, UInt height, UInt& rNumBlocks, UInt& rRowLen );
+
+  // encoder options
+  Void   setFastRateEst      ( Bool b )               { m_fastRateEst = b; }
+  Bool   getFastRateEst      ()                 const { return m_fastRateEst; }
+#if PIP_R1_HT_BINARIZATION
+  /// R1 binarization of the active SPS: two context bins per sample, bypass remainders and signs
+  Void   setR1HighThroughput ( Bool b )               { m_r1HighThroughput = b; }
+  Bool   getR1HighThroughput ()                 const { return m_r1HighThroughput; }
+#endif
+
+  // statistics
+  Void   createThreadStats   ( Int numThreads );
+  Int    getNumThreadStats   ()                 const { return Int( m_threadStats.size() ); }
+  TComPIPStats* getThreadStats( Int threadId )        { return &m_threadStats[threadId]; }
+  Void   mergePictureStats   ();                      ///< adds the per thread counters to the totals and clears them
+  TComPIPStats& getTotalStats()                       { return m_totalStats; }
+
+private:
+  Int      m_spQ;
+  Int      m_spQOffset[4];                               ///< 4x4, 4x8, 8x4, 8x8
+
+  Int***   m_codebooks;                                  ///< one codebook of CBf*W*H vectors for each <W,H>, W,H <= CUMAX
+  Int***   m_nextCodebooks;
+  Int**    m_nextCodebooksCnt;
+  Double** m_rates;
+
+  std::string                               m_codebookDir;
+  TComPIPCodebookFile                       m_codebookFile;
+  std::vector<TComPIPCodebookFile::Section> m_textBlocks;   ///< training blocks parsed from text, when no container is mapped
+
+  Bool     m_fastRateEst;
+#if PIP_R1_HT_BINARIZATION
+  Bool     m_r1HighThroughput;
+#endif
+
+  std::vector<TComPIPStats> m_threadStats;
+  TComPIPStats              m_totalStats;
+};
+
+#endif
+
+//! \}
+
+#endif // __TCOMPIPCONTEXT__
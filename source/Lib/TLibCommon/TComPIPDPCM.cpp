@@ -0,0 +1,358 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2015, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TComPIPDPCM.cpp
+    \brief    anti-diagonal (wavefront) SIMD DPCM of the PIP blocks
+*/
+
+#include "TComPIPDPCM.h"
+#include "TComSpatialQuant.h"
+
+#if PIP_DPCM_WAVEFRONT && COM16_C806_SIMD_OPT
+#include <smmintrin.h>
+
+//! \ingroup TLibCommon
+//! \{
+
+// The diagonal d is held as its rows, 4 rows per vector: lane r holds the pixel (r, d - 2r). Then A and
+// A' are the diagonals d-1 and d-2 on the same lanes, and C, B, D and C' are the diagonals d-2, d-3,
+// d-1 and d-4 moved down by one or two rows; the rows -1 and -2 shifted in are the top row. Lanes left
+// of the block (column -1 or -2) hold the left column, lanes right of or below it are never read.
+static const Int WF_ROWS  = TComPIPDPCM::MAX_SIZE;
+static const Int WF_SKEW  = 4;
+static const Int WF_DIAGS = 3 * TComPIPDPCM::MAX_SIZE + WF_SKEW;
+
+/// position of the pixel (r, c) in a buffer of diagonals
+static inline Int xSkew( Int r, Int c )
+{
+  return ( c + 2 * r + WF_SKEW ) * WF_ROWS + r;
+}
+
+/// aligned buffer of diagonals, WF_ROWS values per diagonal from the diagonal -WF_SKEW on
+template<typename T>
+class TComPIPDiagBuf
+{
+public:
+  T*             operator()( Int d, Int h )       { return ( T* )m_data + ( d + WF_SKEW ) * WF_ROWS + 4 * h; }
+  T&             operator[]( Int s )              { return ( ( T* )m_data )[s]; }
+  __m128i        load( Int d, Int h )             { return _mm_load_si128( ( const __m128i* )( *this )( d, h ) ); }
+  Void           store( Int d, Int h, __m128i v ) { _mm_store_si128( ( __m128i* )( *this )( d, h ), v ); }
+
+private:
+  __m128i        m_data[WF_DIAGS * WF_ROWS / 4];
+};
+
+/// predictor of a diagonal: MED, or the filter10 taps doubled so that the sum is an integer
+class TComPIPDPCMPredictor
+{
+public:
+  TComPIPDPCMPredictor( const Float* filter, Int width, Int height, const Pel* top, const Pel* left, Int leftStride )
+  : m_med( filter == NULL )
+  , m_lastCol( _mm_set1_epi32( width - 1 ) )
+  , m_clipMin( _mm_set1_epi32( g_ClipParam.Y().m ) )
+  , m_clipMax( _mm_set1_epi32( g_ClipParam.Y().M ) )
+  {
+    Int taps[6] = { 0, 0, 0, 0, 0, 0 };
+    for( Int i = 0; i < 6 && !m_med; i++ )
+    {
+      taps[i] = Int( filter[i] * 2 );
+      assert( Float( taps[i] ) == filter[i] * 2 );
+    }
+    for( Int i = 0; i < 3; i++ )
+    {
+      m_taps[i] = _mm_set1_epi32( Int( ( UInt( taps[2 * i] ) & 0xFFFF ) | ( UInt( taps[2 * i + 1] ) << 16 ) ) );
+    }
+
+    // rows -2 and -1 of the diagonal d in the lanes 2 and 3: (d + 4, -2) and (d + 2, -1); the row -2
+    // repeats the top row (C' = C at row 0), columns past the block are never read
+    const Int dLast = width - 1 + 2 * ( height - 1 );
+    for( Int d = -WF_SKEW; d <= dLast; d++ )
+    {
+      m_top[d + WF_SKEW] = _mm_setr_epi32( 0, 0, top[std::min( d + 4, width - 1 )], top[std::max( std::min( d + 2, width - 1 ), -1 )] );
+    }
+    for( Int r = 0; r < WF_ROWS; r++ )
+    {
+      m_leftCol[r] = r < height ? left[r * leftStride] : 0;
+    }
+  }
+
+  /// the left column in the lanes of the rows [4h, 4h + 3]
+  __m128i left( Int h ) const { return _mm_loadu_si128( ( const __m128i* )( m_leftCol + 4 * h ) ); }
+
+  /// the diagonal d' moved down by n rows
+  template<Int n>
+  __m128i down( TComPIPDiagBuf<Int>& V, Int d, Int h ) const
+  {
+    const __m128i above = h ? V.load( d, h - 1 ) : m_top[d + WF_SKEW];
+    return _mm_alignr_epi8( V.load( d, h ), above, 16 - 4 * n );
+  }
+
+  /// X of the rows [4h, 4h + 3] of the diagonal d; col holds the column of each row
+  __m128i predict( TComPIPDiagBuf<Int>& V, Int d, Int h, __m128i col ) const
+  {
+    const __m128i A = V.load( d - 1, h );
+    const __m128i B = down<1>( V, d - 3, h );
+    const __m128i C = down<1>( V, d - 2, h );
+    __m128i X;
+    if( m_med )
+    {
+      const __m128i mx = _mm_max_epi32( A, C );
+      const __m128i mn = _mm_min_epi32( A, C );
+      X = _mm_sub_epi32( _mm_add_epi32( A, C ), B );
+      X = _mm_blendv_epi8( X, mx, _mm_cmpeq_epi32( _mm_min_epi32( B, mn ), B ) );   // B <= min(A, C)
+      X = _mm_blendv_epi8( X, mn, _mm_cmpeq_epi32( _mm_max_epi32( B, mx ), B ) );   // B >= max(A, C) wins
+    }
+    else
+    {
+      const __m128i Ap = V.load( d - 2, h );
+      const __m128i Cp = down<2>( V, d - 4, h );
+      const __m128i D  = _mm_blendv_epi8( down<1>( V, d - 1, h ), C, _mm_cmpeq_epi32( col, m_lastCol ) );
+      // the values fit 16 bits: two taps per madd on (A, B), (C, D) and (A', C') packed in one lane
+      __m128i sum = _mm_madd_epi16( _mm_blend_epi16( A, _mm_slli_epi32( B, 16 ), 0xAA ), m_taps[0] );
+      sum = _mm_add_epi32( sum, _mm_madd_epi16( _mm_blend_epi16( C, _mm_slli_epi32( D, 16 ), 0xAA ), m_taps[1] ) );
+      sum = _mm_add_epi32( sum, _mm_madd_epi16( _mm_blend_epi16( Ap, _mm_slli_epi32( Cp, 16 ), 0xAA ), m_taps[2] ) );
+      // the float to Pel conversion truncates toward zero
+      X = _mm_srai_epi32( _mm_sub_epi32( sum, _mm_srai_epi32( sum, 31 ) ), 1 );
+    }
+    return _mm_min_epi32( _mm_max_epi32( X, m_clipMin ), m_clipMax );
+  }
+
+private:
+  Bool    m_med;
+  __m128i m_lastCol;
+  __m128i m_clipMin;
+  __m128i m_clipMax;
+  __m128i m_taps[3];
+  __m128i m_top[WF_DIAGS];
+  Int     m_leftCol[WF_ROWS];
+};
+
+/// halves [hFirst, hLast] of the diagonal d that hold rows with a column in [-2, width - 1]
+static inline Void xHalves( Int d, Int width, Int height, Int& hFirst, Int& hLast )
+{
+  hFirst = std::max( 0, d - width + 2 ) / 2 / 4;
+  hLast  = std::min( height - 1, ( d + 2 ) / 2 ) / 4;
+}
+
+/// the diagonals before the block hold the left column (their lanes inside the block are never read)
+static Void xInitDiagonals( TComPIPDiagBuf<Int>& V, const TComPIPDPCMPredictor& pred )
+{
+  for( Int d = -WF_SKEW; d < 0; d++ )
+  {
+    for( Int h = 0; h < WF_ROWS / 4; h++ )
+    {
+      V.store( d, h, pred.left( h ) );
+    }
+  }
+}
+
+Void TComPIPDPCM::predict( const Float* filter, Int width, Int height, const Pel* top, const Pel* left, Int leftStride,
+                           const Pel* res, Pel* prediction )
+{
+  assert( isSupported( width, height ) );
+
+  TComPIPDiagBuf<Int> V, XS, RS;
+  for( Int r = 0, idx = 0; r < height; r++ )
+  {
+    for( Int c = 0; c < width; c++, idx++ )
+    {
+      RS[xSkew( r, c )] = res[idx];
+    }
+  }
+
+  const TComPIPDPCMPredictor pred( filter, width, height, top, left, leftStride );
+  const Int     dLast  = width - 1 + 2 * ( height - 1 );
+  const __m128i zero   = _mm_setzero_si128();
+  const __m128i lane2  = _mm_setr_epi32( 0, 2, 4, 6 );
+  xInitDiagonals( V, pred );
+
+  for( Int d = 0; d <= dLast; d++ )
+  {
+    Int hFirst, hLast;
+    xHalves( d, width, height, hFirst, hLast );
+    for( Int h = hFirst; h <= hLast; h++ )
+    {
+      const __m128i col = _mm_sub_epi32( _mm_set1_epi32( d - 8 * h ), lane2 );
+      const __m128i X   = pred.predict( V, d, h, col );
+      const __m128i rec = _mm_add_epi32( X, RS.load( d, h ) );
+      V.store( d, h, _mm_blendv_epi8( rec, pred.left( h ), _mm_cmpgt_epi32( zero, col ) ) );
+      XS.store( d, h, X );
+    }
+  }
+
+  for( Int r = 0, idx = 0; r < height; r++ )
+  {
+    for( Int c = 0; c < width; c++, idx++ )
+    {
+      prediction[idx] = Pel( XS[xSkew( r, c )] );
+    }
+  }
+}
+
+Void TComPIPDPCM::quantize( const Float* filter, const Int* qMap, Int startIdx, Int endIdx, Int width, Int height,
+                            Pel* predBuffer, Int* res, Pel* prediction, Int* spQR1, const Pel* piOrg, Int orgStride,
+                            Int qStep, Float* qMapCmp )
+{
+  assert( isSupported( width, height ) && startIdx < endIdx );
+
+  const Int stride = width + 1;
+  TComPIPDiagBuf<Int>   V, XS, RS, OS, MS;
+  TComPIPDiagBuf<Float> QS;
+
+  // the pixels before startIdx keep their reconstruction, the others get the original and the decision
+  for( Int r = 0, idx = 0; idx < endIdx; r++ )
+  {
+    for( Int c = 0; c < width && idx < endIdx; c++, idx++ )
+    {
+      const Int s = xSkew( r, c );
+      if( idx < startIdx )
+      {
+        RS[s] = Pel( predBuffer[( r + 1 ) * stride + c + 1] + res[idx] );
+      }
+      else
+      {
+        OS[s] = piOrg[r * orgStride + c];
+        MS[s] = qMap[idx];
+      }
+    }
+  }
+
+  const TComPIPDPCMPredictor pred( filter, width, height, predBuffer + 1, predBuffer + stride, stride );
+  const TComSpatialQuant     spQuant( qStep );
+  const __m128i lane2     = _mm_setr_epi32( 0, 2, 4, 6 );
+  const __m128i zero      = _mm_setzero_si128();
+  const __m128i one       = _mm_set1_epi32( 1 );
+  const __m128i ones      = _mm_set1_epi32( -1 );
+  const __m128i q         = _mm_set1_epi32( qStep );
+  const __m128i qMinus1   = _mm_set1_epi32( qStep - 1 );
+  const __m128i scale     = _mm_set1_epi32( Int( UInt( spQuant.getScale() ) ) );
+  const __m128i limit     = _mm_set1_epi32( COEFF_LIMIT );
+  const __m128i modeTop   = _mm_set1_epi32( SPQ_TOP );
+  const __m128i modeBot   = _mm_set1_epi32( SPQ_BOTTOM );
+  const __m128i modeBot1  = _mm_set1_epi32( SPQ_BOTTOM_1 );
+  const __m128  qf        = _mm_set1_ps( Float( qStep ) );
+  const __m128  signBit   = _mm_set1_ps( -0.0f );
+  const __m128i vStart    = _mm_set1_epi32( startIdx );
+  const __m128i idxStep   = _mm_setr_epi32( 0, width - 2, 2 * ( width - 2 ), 3 * ( width - 2 ) );
+  const Bool    unitStep  = qStep == 1;   // the scale 2^32 does not fit the 32-bit multiply
+  xInitDiagonals( V, pred );
+
+  // the diagonals that hold pixels of [startIdx, endIdx)
+  const Int rs = startIdx / width, cs = startIdx % width;
+  const Int re = ( endIdx - 1 ) / width, ce = ( endIdx - 1 ) % width;
+  const Int dFirst = 2 * rs + std::min( cs, 2 );
+  const Int dLast  = std::min( width - 1 + 2 * ( height - 1 ), std::max( ce + 2 * re, width - 3 + 2 * re ) );
+
+  for( Int d = 0; d < dFirst; d++ )
+  {
+    Int hFirst, hLast;
+    xHalves( d, width, height, hFirst, hLast );
+    for( Int h = hFirst; h <= hLast; h++ )
+    {
+      const __m128i col = _mm_sub_epi32( _mm_set1_epi32( d - 8 * h ), lane2 );
+      V.store( d, h, _mm_blendv_epi8( RS.load( d, h ), pred.left( h ), _mm_cmpgt_epi32( zero, col ) ) );
+    }
+  }
+
+  for( Int d = dFirst; d <= dLast; d++ )
+  {
+    Int hFirst, hLast;
+    xHalves( d, width, height, hFirst, hLast );
+    for( Int h = hFirst; h <= hLast; h++ )
+    {
+      const __m128i col = _mm_sub_epi32( _mm_set1_epi32( d - 8 * h ), lane2 );
+      // raster index of the lanes: r * width + d - 2 * r
+      const __m128i idx = _mm_add_epi32( _mm_set1_epi32( d + 4 * h * ( width - 2 ) ), idxStep );
+      const __m128i X   = pred.predict( V, d, h, col );
+
+      // spatial quantization, see TComSpatialQuant
+      const __m128i qR  = _mm_sub_epi32( OS.load( d, h ), X );
+      const __m128i a   = _mm_abs_epi32( qR );
+      __m128i fl;
+      if( unitStep )
+      {
+        fl = a;
+      }
+      else
+      {
+        const __m128i even = _mm_mul_epu32( a, scale );
+        const __m128i odd  = _mm_mul_epu32( _mm_srli_epi64( a, 32 ), scale );
+        fl = _mm_blend_epi16( _mm_srli_epi64( even, 32 ), odd, 0xCC );
+      }
+      // the levels and the step fit 16 bits, so the products are one madd with the step in the low half
+      const __m128i rem  = _mm_sub_epi32( a, _mm_madd_epi16( fl, q ) );
+      const __m128i rnd  = _mm_sub_epi32( fl, _mm_cmpgt_epi32( _mm_slli_epi32( rem, 1 ), qMinus1 ) );
+      const __m128i ceil = _mm_sub_epi32( fl, _mm_andnot_si128( _mm_cmpeq_epi32( rem, zero ), ones ) );
+      const __m128i bot1 = _mm_max_epi32( _mm_sub_epi32( fl, one ), zero );
+      const __m128i mode = MS.load( d, h );
+      __m128i level = rnd;
+      level = _mm_blendv_epi8( level, ceil, _mm_cmpeq_epi32( mode, modeTop ) );
+      level = _mm_blendv_epi8( level, fl,   _mm_cmpeq_epi32( mode, modeBot ) );
+      level = _mm_blendv_epi8( level, bot1, _mm_cmpeq_epi32( mode, modeBot1 ) );
+
+      if( qMapCmp )
+      {
+        const __m128i dist = _mm_abs_epi32( _mm_sub_epi32( a, _mm_madd_epi16( rnd, q ) ) );
+        const __m128  neg  = _mm_and_ps( _mm_castsi128_ps( _mm_cmpeq_epi32( level, rnd ) ), signBit );
+        _mm_store_ps( QS( d, h ), _mm_xor_ps( _mm_div_ps( _mm_cvtepi32_ps( dist ), qf ), neg ) );
+      }
+
+      const __m128i R   = _mm_sign_epi32( _mm_madd_epi16( _mm_min_epi32( level, limit ), q ), qR );
+      __m128i rec = _mm_blendv_epi8( _mm_add_epi32( X, R ), RS.load( d, h ), _mm_cmpgt_epi32( vStart, idx ) );
+      rec = _mm_blendv_epi8( rec, pred.left( h ), _mm_cmpgt_epi32( zero, col ) );
+      V.store( d, h, rec );
+      XS.store( d, h, X );
+      RS.store( d, h, R );
+    }
+  }
+
+  for( Int r = rs, c = cs, idx = startIdx; idx < endIdx; idx++ )
+  {
+    const Int s = xSkew( r, c );
+    prediction[idx] = predBuffer[( r + 1 ) * stride + c + 1] = Pel( XS[s] );
+    res[idx] = spQR1[idx] = RS[s];
+    if( qMapCmp )
+    {
+      qMapCmp[idx] = QS[s];
+    }
+    if( ++c == width )
+    {
+      c = 0;
+      r++;
+    }
+  }
+}
+
+//! \}
+
+#endif
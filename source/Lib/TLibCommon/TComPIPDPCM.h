@@ -0,0 +1,83 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2015, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TComPIPDPCM.h
+    \brief    anti-diagonal (wavefront) SIMD DPCM of the PIP blocks
+*/
+
+#ifndef __TCOMPIPDPCM__
+#define __TCOMPIPDPCM__
+
+#include "CommonDef.h"
+
+//! \ingroup TLibCommon
+//! \{
+
+#if PIP_DPCM_WAVEFRONT && COM16_C806_SIMD_OPT
+
+/** DPCM of a PIP block along the anti-diagonals d = col + 2*row. The causal neighbours of a pixel
+ *  (A, B, C, D, A', C') all lie on the diagonals d-1 to d-4, so the pixels of one diagonal are
+ *  independent and are predicted together with SSE4.1, one row per lane. The MED and filter10
+ *  predictions, the clipping and the spatial quantization are bit-exact with the scalar loops of
+ *  TComPrediction: the filter10 taps are multiples of 0.5, so the float sum is exact and is
+ *  evaluated as an integer sum of doubled taps halved toward zero.
+ *
+ *  The top row (top[-1] is the corner) and the left column are the unfiltered neighbours of the
+ *  block; filter is the filter10 row of the predictor, or NULL for the MED.
+ */
+class TComPIPDPCM
+{
+public:
+  static const Int MAX_SIZE = 8;
+
+  static Bool isSupported ( Int width, Int height )   { return width <= MAX_SIZE && height <= MAX_SIZE; }
+
+  /// 4-wide blocks have 2 pixels per diagonal at most: the scalar loop is as fast there
+  static Bool isPreferred ( Int width, Int height )   { return width == MAX_SIZE && isSupported( width, height ); }
+
+  /// decoder: prediction of a block from its reconstructed R1 residual
+  static Void predict     ( const Float* filter, Int width, Int height, const Pel* top, const Pel* left, Int leftStride,
+                            const Pel* res, Pel* prediction );
+
+  /// encoder: prediction and spatial quantization of the pixels [startIdx, endIdx), same contract as
+  /// TComPrediction::xPIPQuantizeDPCM (predBuffer has a stride of width + 1 and holds the borders)
+  static Void quantize    ( const Float* filter, const Int* qMap, Int startIdx, Int endIdx, Int width, Int height,
+                            Pel* predBuffer, Int* res, Pel* prediction, Int* spQR1, const Pel* piOrg, Int orgStride,
+                            Int qStep, Float* qMapCmp );
+};
+
+#endif
+
+//! \}
+
+#endif // __TCOMPIPDPCM__
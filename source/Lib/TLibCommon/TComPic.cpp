@@ -41,6 +41,19 @@
 //! \ingroup TLibCommon
 //! \{
 
+#if JVET_C0024_QTBT
+thread_local const TComPic* TComPic::s_pcThreadScratchPic = NULL;
+thread_local TComCtuScratch* TComPic::s_pcThreadScratch   = NULL;
+#endif
+#if QTBT_PARALLEL_SPLIT
+thread_local const TComPic* TComPic::s_pcThreadCtuCopyPic  = NULL;
+thread_local UInt        TComPic::s_uiThreadCtuCopyAddr    = 0;
+thread_local TComDataCU* TComPic::s_pcThreadCtuCopy        = NULL;
+thread_local TComPicYuv* TComPic::s_pcThreadPicYuvRec      = NULL;
+thread_local TComPicYuv* TComPic::s_pcThreadPicYuvPred     = NULL;
+thread_local TComCtuScratchReads* TComPic::s_pcThreadScratchReads = NULL;
+#endif
+
 // ====================================================================================================================
 // Constructor / destructor / create / destroy
 // ====================================================================================================================
@@ -61,10 +74,10 @@ TComPic::TComPic()
     m_apcPicYuv[i]      = NULL;
   }
 #if VCEG_AZ08_INTER_KLT
-  m_apcQuaPicYuv[0][0] = NULL; m_apcQuaPicYuv[0][1] = NULL; m_apcQuaPicYuv[0][2] = NULL; m_apcQuaPicYuv[0][3] = NULL;
-  m_apcQuaPicYuv[1][0] = NULL; m_apcQuaPicYuv[1][1] = NULL; m_apcQuaPicYuv[1][2] = NULL; m_apcQuaPicYuv[1][3] = NULL;
-  m_apcQuaPicYuv[2][0] = NULL; m_apcQuaPicYuv[2][1] = NULL; m_apcQuaPicYuv[2][2] = NULL; m_apcQuaPicYuv[2][3] = NULL;
-  m_apcQuaPicYuv[3][0] = NULL; m_apcQuaPicYuv[3][1] = NULL; m_apcQuaPicYuv[3][2] = NULL; m_apcQuaPicYuv[3][3] = NULL;
+  for(UInt i=0; i<MAX_NUM_CTU_WORKERS; i++)
+  {
+    m_apcWorkerSubPelCache[i] = NULL;
+  }
 #endif
 }
 
@@ -106,21 +119,7 @@ Void TComPic::create( const TComSPS &sps, const TComPPS &pps, const Bool bIsVirt
   if (sps.getUseInterKLT())
   {
 #endif
-      for (UInt uiRow = 0; uiRow < 4; uiRow++)
-      {
-          for (UInt uiCol = 0; uiCol < 4; uiCol++)
-          {
-              if (uiRow == 0 && uiCol == 0)
-              {
-                  m_apcQuaPicYuv[uiRow][uiCol] = m_apcPicYuv[PIC_YUV_REC];
-              }
-              else
-              {
-                  m_apcQuaPicYuv[uiRow][uiCol] = new TComPicYuv;
-                  m_apcQuaPicYuv[uiRow][uiCol]->create(iWidth, iHeight, chromaFormatIDC, uiMaxCuWidth, uiMaxCuHeight, uiMaxDepth, true);
-              }
-          }
-      }
+      m_subPelCache.create( KLT_SUBPEL_CACHE_TILES );
 #if VCEG_AZ08_USE_KLT
   }
 #endif
@@ -149,26 +148,56 @@ Void TComPic::destroy()
   }
 
 #if VCEG_AZ08_INTER_KLT
-  for (UInt uiRow = 0; uiRow < 4; uiRow++)
+  m_subPelCache.destroy();
+  for(UInt i=0; i<MAX_NUM_CTU_WORKERS; i++)
   {
-      for (UInt uiCol = 0; uiCol < 4; uiCol++)
-      {
-          if (uiRow == 0 && uiCol == 0)
-          {
-              continue;
-          }
-          if (m_apcQuaPicYuv[uiRow][uiCol])
-          {
-              m_apcQuaPicYuv[uiRow][uiCol]->destroy();
-              delete m_apcQuaPicYuv[uiRow][uiCol];
-              m_apcQuaPicYuv[uiRow][uiCol] = NULL;
-          }
-      }
+    delete m_apcWorkerSubPelCache[i];
+    m_apcWorkerSubPelCache[i] = NULL;
   }
 #endif
   deleteSEIs(m_SEIs);
 }
 
+#if VCEG_AZ08_INTER_KLT
+/** Called when the reconstruction is final: extends the border of the luma plane and drops the sub-pel
+ *  tiles of the former content. The tiles take the clipping range in force now.
+ */
+Void TComPic::resetSubPelCache()
+{
+  TComPicYuv* pcRecYuv = getPicYuvRec();
+  pcRecYuv->setBorderExtension( false );
+  pcRecYuv->extendPicBorder();
+#if JVET_D0033_ADAPTIVE_CLIPPING
+  m_subPelCache.setSource( pcRecYuv, getChromaFormat(), getSlice( 0 )->getSPS()->getBitDepth( CHANNEL_TYPE_LUMA ), g_ClipParam );
+#else
+  m_subPelCache.setSource( pcRecYuv, getChromaFormat(), getSlice( 0 )->getSPS()->getBitDepth( CHANNEL_TYPE_LUMA ) );
+#endif
+  for(UInt i=0; i<MAX_NUM_CTU_WORKERS; i++)
+  {
+    if( m_apcWorkerSubPelCache[i] )
+    {
+      m_apcWorkerSubPelCache[i]->setSource( m_subPelCache );
+    }
+  }
+}
+
+TComSubPelCache* TComPic::getSubPelCache( UInt slot )
+{
+  if( slot == 0 )
+  {
+    return &m_subPelCache;
+  }
+  TComSubPelCache*& rpcCache = m_apcWorkerSubPelCache[slot - 1];
+  if( rpcCache == NULL && m_subPelCache.isCreated() )
+  {
+    rpcCache = new TComSubPelCache;
+    rpcCache->create( KLT_SUBPEL_CACHE_TILES );
+    rpcCache->setSource( m_subPelCache );
+  }
+  return rpcCache;
+}
+#endif
+
 Void TComPic::compressMotion()
 {
   TComPicSym* pPicSym = getPicSym();
@@ -318,104 +347,224 @@ ClipParam TComPic::computeTchClipParam(Int &delta_disto_luma,Int &delta_disto_ch
 #if JVET_C0024_QTBT
 Void TComPic::setCodedBlkInCTU(Bool bCoded, UInt uiBlkX, UInt uiBlkY, UInt uiWidth, UInt uiHeight)
 {
-  assert(sizeof(**m_bCodedBlkInCTU)==1);
+  assert(sizeof(**xGetCtuScratch().m_bCodedBlkInCTU)==1);
   for (UInt i=uiBlkY; i<uiBlkY+uiHeight; i++)
   {
-    memset(&m_bCodedBlkInCTU[i][uiBlkX], bCoded, uiWidth);
+    memset(&xGetCtuScratch().m_bCodedBlkInCTU[i][uiBlkX], bCoded, uiWidth);
   }
 }
 Int TComPic::getCodedAreaInCTU()
 {
-  return m_iCodedArea;
+  return xGetCtuScratch().m_iCodedArea;
 }
 
 Void TComPic::setCodedAreaInCTU(Int iArea)
 {
-  m_iCodedArea = iArea;
+  xGetCtuScratch().m_iCodedArea = iArea;
 }
 
 Void TComPic::addCodedAreaInCTU(Int iArea)
 {
-  m_iCodedArea += iArea;
-  assert(m_iCodedArea>=0);
+  xGetCtuScratch().m_iCodedArea += iArea;
+  assert(xGetCtuScratch().m_iCodedArea>=0);
 }
 
 Void  TComPic::setSkiped(UInt uiZorder, UInt uiWidth, UInt uiHeight, Bool bSkiped)
 {
   UInt uiWIdx = g_aucConvertToBit[uiWidth];
   UInt uiHIdx = g_aucConvertToBit[uiHeight];
-  m_bSkiped[uiZorder][uiWIdx][uiHIdx] = bSkiped;  
+#if QTBT_PARALLEL_SPLIT
+  xWriteCtuScratch( uiZorder, uiWIdx, uiHIdx, TComCtuScratchReads::SKIPED );
+#endif
+  xGetCtuScratch().m_bSkiped[uiZorder][uiWIdx][uiHIdx] = bSkiped;  
 }
 Bool  TComPic::getSkiped(UInt uiZorder, UInt uiWidth, UInt uiHeight)
 {
   UInt uiWIdx = g_aucConvertToBit[uiWidth];
   UInt uiHIdx = g_aucConvertToBit[uiHeight];
-  return m_bSkiped[uiZorder][uiWIdx][uiHIdx];
+#if QTBT_PARALLEL_SPLIT
+  xReadCtuScratch( uiZorder, uiWIdx, uiHIdx, TComCtuScratchReads::SKIPED );
+#endif
+  return xGetCtuScratch().m_bSkiped[uiZorder][uiWIdx][uiHIdx];
 }
 Void  TComPic::clearAllSkiped()
 {
-  memset(m_bSkiped, 0, (1<<((MAX_CU_DEPTH-MIN_CU_LOG2)<<1))*(MAX_CU_DEPTH-MIN_CU_LOG2+1)*(MAX_CU_DEPTH-MIN_CU_LOG2+1)*sizeof(Bool));
+  memset(xGetCtuScratch().m_bSkiped, 0, (1<<((MAX_CU_DEPTH-MIN_CU_LOG2)<<1))*(MAX_CU_DEPTH-MIN_CU_LOG2+1)*(MAX_CU_DEPTH-MIN_CU_LOG2+1)*sizeof(Bool));
 }
 
 Void  TComPic::setInter(UInt uiZorder, UInt uiWidth, UInt uiHeight, Bool bInter)
 {
   UInt uiWIdx = g_aucConvertToBit[uiWidth];
   UInt uiHIdx = g_aucConvertToBit[uiHeight];
-  m_bInter[uiZorder][uiWIdx][uiHIdx] = bInter; 
+#if QTBT_PARALLEL_SPLIT
+  xWriteCtuScratch( uiZorder, uiWIdx, uiHIdx, TComCtuScratchReads::INTER );
+#endif
+  xGetCtuScratch().m_bInter[uiZorder][uiWIdx][uiHIdx] = bInter; 
 }
 Bool  TComPic::getInter(UInt uiZorder, UInt uiWidth, UInt uiHeight)
 {
   UInt uiWIdx = g_aucConvertToBit[uiWidth];
   UInt uiHIdx = g_aucConvertToBit[uiHeight];
-  return m_bInter[uiZorder][uiWIdx][uiHIdx];
+#if QTBT_PARALLEL_SPLIT
+  xReadCtuScratch( uiZorder, uiWIdx, uiHIdx, TComCtuScratchReads::INTER );
+#endif
+  return xGetCtuScratch().m_bInter[uiZorder][uiWIdx][uiHIdx];
 }
 Void  TComPic::clearAllInter()
 {
-  memset(m_bInter, 0, (1<<((MAX_CU_DEPTH-MIN_CU_LOG2)<<1))*(MAX_CU_DEPTH-MIN_CU_LOG2+1)*(MAX_CU_DEPTH-MIN_CU_LOG2+1)*sizeof(Bool));
+  memset(xGetCtuScratch().m_bInter, 0, (1<<((MAX_CU_DEPTH-MIN_CU_LOG2)<<1))*(MAX_CU_DEPTH-MIN_CU_LOG2+1)*(MAX_CU_DEPTH-MIN_CU_LOG2+1)*sizeof(Bool));
 }
 
 Void  TComPic::setIntra(UInt uiZorder, UInt uiWidth, UInt uiHeight, Bool bIntra)
 {
   UInt uiWIdx = g_aucConvertToBit[uiWidth];
   UInt uiHIdx = g_aucConvertToBit[uiHeight];
-  m_bIntra[uiZorder][uiWIdx][uiHIdx] = bIntra; 
+#if QTBT_PARALLEL_SPLIT
+  xWriteCtuScratch( uiZorder, uiWIdx, uiHIdx, TComCtuScratchReads::INTRA );
+#endif
+  xGetCtuScratch().m_bIntra[uiZorder][uiWIdx][uiHIdx] = bIntra; 
 }
 Bool  TComPic::getIntra(UInt uiZorder, UInt uiWidth, UInt uiHeight)
 {
   UInt uiWIdx = g_aucConvertToBit[uiWidth];
   UInt uiHIdx = g_aucConvertToBit[uiHeight];
-  return m_bIntra[uiZorder][uiWIdx][uiHIdx];
+#if QTBT_PARALLEL_SPLIT
+  xReadCtuScratch( uiZorder, uiWIdx, uiHIdx, TComCtuScratchReads::INTRA );
+#endif
+  return xGetCtuScratch().m_bIntra[uiZorder][uiWIdx][uiHIdx];
 }
 Void  TComPic::clearAllIntra()
 {
-  memset(m_bIntra, 0, (1<<((MAX_CU_DEPTH-MIN_CU_LOG2)<<1))*(MAX_CU_DEPTH-MIN_CU_LOG2+1)*(MAX_CU_DEPTH-MIN_CU_LOG2+1)*sizeof(Bool));
+  memset(xGetCtuScratch().m_bIntra, 0, (1<<((MAX_CU_DEPTH-MIN_CU_LOG2)<<1))*(MAX_CU_DEPTH-MIN_CU_LOG2+1)*(MAX_CU_DEPTH-MIN_CU_LOG2+1)*sizeof(Bool));
 }
 
 Void  TComPic::setIntMv(UInt uiZorder, UInt uiWidth, UInt uiHeight, RefPicList eRefList, UInt uiRefIdx, TComMv cMv)
 {
   UInt uiWIdx = g_aucConvertToBit[uiWidth];
   UInt uiHIdx = g_aucConvertToBit[uiHeight];
-  m_cIntMv[uiZorder][uiWIdx][uiHIdx][(UInt)eRefList][uiRefIdx] = cMv;
-  m_bSetIntMv[uiZorder][uiWIdx][uiHIdx][(UInt)eRefList][uiRefIdx] = true; 
+#if QTBT_PARALLEL_SPLIT
+  xWriteCtuScratch( uiZorder, uiWIdx, uiHIdx, TComCtuScratchReads::INT_MV << ( (UInt)eRefList*5 + uiRefIdx ) );
+#endif
+  xGetCtuScratch().m_cIntMv[uiZorder][uiWIdx][uiHIdx][(UInt)eRefList][uiRefIdx] = cMv;
+  xGetCtuScratch().m_bSetIntMv[uiZorder][uiWIdx][uiHIdx][(UInt)eRefList][uiRefIdx] = true; 
 }
 
 TComMv  TComPic::getIntMv(UInt uiZorder, UInt uiWidth, UInt uiHeight, RefPicList eRefList, UInt uiRefIdx)
 {
   UInt uiWIdx = g_aucConvertToBit[uiWidth];
   UInt uiHIdx = g_aucConvertToBit[uiHeight];
-  return m_cIntMv[uiZorder][uiWIdx][uiHIdx][(UInt)eRefList][uiRefIdx];
+#if QTBT_PARALLEL_SPLIT
+  xReadCtuScratch( uiZorder, uiWIdx, uiHIdx, TComCtuScratchReads::INT_MV << ( (UInt)eRefList*5 + uiRefIdx ) );
+#endif
+  return xGetCtuScratch().m_cIntMv[uiZorder][uiWIdx][uiHIdx][(UInt)eRefList][uiRefIdx];
 }
 
 Bool  TComPic::IsSetIntMv(UInt uiZorder, UInt uiWidth, UInt uiHeight, RefPicList eRefList, UInt uiRefIdx)
 {
   UInt uiWIdx = g_aucConvertToBit[uiWidth];
   UInt uiHIdx = g_aucConvertToBit[uiHeight];
-  return m_bSetIntMv[uiZorder][uiWIdx][uiHIdx][(UInt)eRefList][uiRefIdx];
+#if QTBT_PARALLEL_SPLIT
+  xReadCtuScratch( uiZorder, uiWIdx, uiHIdx, TComCtuScratchReads::INT_MV << ( (UInt)eRefList*5 + uiRefIdx ) );
+#endif
+  return xGetCtuScratch().m_bSetIntMv[uiZorder][uiWIdx][uiHIdx][(UInt)eRefList][uiRefIdx];
 }
 
 Void  TComPic::clearAllIntMv()
 {
-  memset(m_bSetIntMv, 0, (1<<((MAX_CU_DEPTH-MIN_CU_LOG2)<<1))*(MAX_CU_DEPTH-MIN_CU_LOG2+1)*(MAX_CU_DEPTH-MIN_CU_LOG2+1)*2*5*sizeof(Bool));
+  memset(xGetCtuScratch().m_bSetIntMv, 0, (1<<((MAX_CU_DEPTH-MIN_CU_LOG2)<<1))*(MAX_CU_DEPTH-MIN_CU_LOG2+1)*(MAX_CU_DEPTH-MIN_CU_LOG2+1)*2*5*sizeof(Bool));
+}
+
+#if QTBT_PARALLEL_SPLIT
+Void TComCtuScratch::copyFrom( const TComCtuScratch& rcSrc, UInt uiZorderBegin, UInt uiZorderEnd )
+{
+  memcpy( m_bCodedBlkInCTU, rcSrc.m_bCodedBlkInCTU, sizeof( m_bCodedBlkInCTU ) );
+  m_iCodedArea = rcSrc.m_iCodedArea;
+
+  const UInt uiNum = uiZorderEnd + 1 - uiZorderBegin;
+  memcpy( m_cIntMv   [uiZorderBegin], rcSrc.m_cIntMv   [uiZorderBegin], uiNum * sizeof( *m_cIntMv ) );
+  memcpy( m_bSetIntMv[uiZorderBegin], rcSrc.m_bSetIntMv[uiZorderBegin], uiNum * sizeof( *m_bSetIntMv ) );
+  memcpy( m_bSkiped  [uiZorderBegin], rcSrc.m_bSkiped  [uiZorderBegin], uiNum * sizeof( *m_bSkiped ) );
+  memcpy( m_bInter   [uiZorderBegin], rcSrc.m_bInter   [uiZorderBegin], uiNum * sizeof( *m_bInter ) );
+  memcpy( m_bIntra   [uiZorderBegin], rcSrc.m_bIntra   [uiZorderBegin], uiNum * sizeof( *m_bIntra ) );
+}
+
+Void TComCtuScratchReads::clear( UInt uiZorderBegin, UInt uiZorderEnd )
+{
+  const UInt uiNum = uiZorderEnd + 1 - uiZorderBegin;
+  memset( m_uiRead   [uiZorderBegin], 0, uiNum * sizeof( *m_uiRead ) );
+  memset( m_uiWritten[uiZorderBegin], 0, uiNum * sizeof( *m_uiWritten ) );
+}
+
+Void TComCtuScratchReads::copyWritten( TComCtuScratch& rcDst, const TComCtuScratch& rcSrc, UInt uiZorderBegin, UInt uiZorderEnd ) const
+{
+  const UInt uiNumSizeIdx = MAX_CU_DEPTH-MIN_CU_LOG2+1;
+  for( UInt z = uiZorderBegin; z <= uiZorderEnd; z++ )
+  {
+    for( UInt w = 0; w < uiNumSizeIdx; w++ )
+    {
+      for( UInt h = 0; h < uiNumSizeIdx; h++ )
+      {
+        const UInt uiWritten = m_uiWritten[z][w][h];
+        if( uiWritten == 0 )
+        {
+          continue;
+        }
+        if( uiWritten & SKIPED ) { rcDst.m_bSkiped[z][w][h] = rcSrc.m_bSkiped[z][w][h]; }
+        if( uiWritten & INTER )  { rcDst.m_bInter[z][w][h]  = rcSrc.m_bInter[z][w][h];  }
+        if( uiWritten & INTRA )  { rcDst.m_bIntra[z][w][h]  = rcSrc.m_bIntra[z][w][h];  }
+        for( UInt l = 0; l < 2; l++ )
+        {
+          for( UInt r = 0; r < 5; r++ )
+          {
+            if( uiWritten & ( INT_MV << ( l*5 + r ) ) )
+            {
+              rcDst.m_bSetIntMv[z][w][h][l][r] = rcSrc.m_bSetIntMv[z][w][h][l][r];
+              rcDst.m_cIntMv   [z][w][h][l][r] = rcSrc.m_cIntMv   [z][w][h][l][r];
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+Bool TComCtuScratchReads::readsMatch( const TComCtuScratch& rcA, const TComCtuScratch& rcB, UInt uiZorderBegin, UInt uiZorderEnd ) const
+{
+  const UInt uiNumSizeIdx = MAX_CU_DEPTH-MIN_CU_LOG2+1;
+  for( UInt z = uiZorderBegin; z <= uiZorderEnd; z++ )
+  {
+    for( UInt w = 0; w < uiNumSizeIdx; w++ )
+    {
+      for( UInt h = 0; h < uiNumSizeIdx; h++ )
+      {
+        const UInt uiRead = m_uiRead[z][w][h];
+        if( uiRead == 0 )
+        {
+          continue;
+        }
+        if( ( ( uiRead & SKIPED ) && rcA.m_bSkiped[z][w][h] != rcB.m_bSkiped[z][w][h] )
+         || ( ( uiRead & INTER )  && rcA.m_bInter[z][w][h]  != rcB.m_bInter[z][w][h] )
+         || ( ( uiRead & INTRA )  && rcA.m_bIntra[z][w][h]  != rcB.m_bIntra[z][w][h] ) )
+        {
+          return false;
+        }
+        for( UInt l = 0; l < 2; l++ )
+        {
+          for( UInt r = 0; r < 5; r++ )
+          {
+            const Bool bSet = rcA.m_bSetIntMv[z][w][h][l][r];
+            if( ( uiRead & ( INT_MV << ( l*5 + r ) ) )
+             && ( bSet != rcB.m_bSetIntMv[z][w][h][l][r] || ( bSet && rcA.m_cIntMv[z][w][h][l][r] != rcB.m_cIntMv[z][w][h][l][r] ) ) )
+            {
+              return false;
+            }
+          }
+        }
+      }
+    }
+  }
+  return true;
 }
 #endif
+#endif
 //! \}
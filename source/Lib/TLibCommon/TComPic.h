@@ -43,6 +43,7 @@
 #include "TComPicSym.h"
 #include "TComPicYuv.h"
 #include "TComBitStream.h"
+#include "TComSubPelCache.h"
 
 //! \ingroup TLibCommon
 //! \{
@@ -51,6 +52,47 @@
 // Class definition
 // ====================================================================================================================
 
+#if JVET_C0024_QTBT
+/// coded blocks and encoder decisions of the CTU being coded
+struct TComCtuScratch
+{
+  //for record codec block info.
+  Bool m_bCodedBlkInCTU[MAX_CU_SIZE>>MIN_CU_LOG2][MAX_CU_SIZE>>MIN_CU_LOG2];    //[CTUSize>>MIN_CU_Log2][CTUSize>>MIN_CU_Log2]; [h][w]
+  Int  m_iCodedArea;
+
+  //for encoder speedup
+  TComMv                m_cIntMv[1<<((MAX_CU_DEPTH-MIN_CU_LOG2)<<1)][MAX_CU_DEPTH-MIN_CU_LOG2+1][MAX_CU_DEPTH-MIN_CU_LOG2+1][2][5]; //[zorder][w][h][refList][refIdx]
+  Bool                  m_bSetIntMv[1<<((MAX_CU_DEPTH-MIN_CU_LOG2)<<1)][MAX_CU_DEPTH-MIN_CU_LOG2+1][MAX_CU_DEPTH-MIN_CU_LOG2+1][2][5]; //[zorder][w][h][refList][refIdx]
+  Bool                  m_bSkiped[1<<((MAX_CU_DEPTH-MIN_CU_LOG2)<<1)][MAX_CU_DEPTH-MIN_CU_LOG2+1][MAX_CU_DEPTH-MIN_CU_LOG2+1]; //[zorder][w][h] , if skip mode, not try inter, intra
+  Bool                  m_bInter[1<<((MAX_CU_DEPTH-MIN_CU_LOG2)<<1)][MAX_CU_DEPTH-MIN_CU_LOG2+1][MAX_CU_DEPTH-MIN_CU_LOG2+1]; //[zorder][w][h] , if inter mode, not try intra
+  Bool                  m_bIntra[1<<((MAX_CU_DEPTH-MIN_CU_LOG2)<<1)][MAX_CU_DEPTH-MIN_CU_LOG2+1][MAX_CU_DEPTH-MIN_CU_LOG2+1]; // if intra mode, not try inter
+
+#if QTBT_PARALLEL_SPLIT
+  /// takes the coded blocks and the fast decisions of the z-order range [uiZorderBegin, uiZorderEnd] from rcSrc
+  Void copyFrom( const TComCtuScratch& rcSrc, UInt uiZorderBegin, UInt uiZorderEnd );
+#endif
+};
+
+#if QTBT_PARALLEL_SPLIT
+/// fast decisions of the CTU scratch that a split task read before it set them itself, and the ones it set
+struct TComCtuScratchReads
+{
+  enum { SKIPED = 1<<0, INTER = 1<<1, INTRA = 1<<2, INT_MV = 1<<3 };   ///< bits of a decision, INT_MV << (refList*5+refIdx)
+
+  UShort m_uiRead   [1<<((MAX_CU_DEPTH-MIN_CU_LOG2)<<1)][MAX_CU_DEPTH-MIN_CU_LOG2+1][MAX_CU_DEPTH-MIN_CU_LOG2+1]; //[zorder][w][h]
+  UShort m_uiWritten[1<<((MAX_CU_DEPTH-MIN_CU_LOG2)<<1)][MAX_CU_DEPTH-MIN_CU_LOG2+1][MAX_CU_DEPTH-MIN_CU_LOG2+1]; //[zorder][w][h]
+
+  Void clear( UInt uiZorderBegin, UInt uiZorderEnd );
+  Void read ( UInt uiZorder, UInt uiWIdx, UInt uiHIdx, UInt uiBit ) { m_uiRead[uiZorder][uiWIdx][uiHIdx] |= uiBit & ~m_uiWritten[uiZorder][uiWIdx][uiHIdx]; }
+  Void write( UInt uiZorder, UInt uiWIdx, UInt uiHIdx, UInt uiBit ) { m_uiWritten[uiZorder][uiWIdx][uiHIdx] |= uiBit; }
+  /// takes the decisions written in the z-order range from rcSrc into rcDst
+  Void copyWritten( TComCtuScratch& rcDst, const TComCtuScratch& rcSrc, UInt uiZorderBegin, UInt uiZorderEnd ) const;
+  /// the decisions read in the z-order range have the same values in rcA and rcB
+  Bool readsMatch( const TComCtuScratch& rcA, const TComCtuScratch& rcB, UInt uiZorderBegin, UInt uiZorderEnd ) const;
+};
+#endif
+#endif
+
 /// picture class (symbol + YUV buffers)
 
 class TComPic
@@ -82,19 +124,31 @@ private:
   Int                   m_iNumCuInWidth;
 #endif
 #if JVET_C0024_QTBT
-  //for record codec block info.
-  Bool m_bCodedBlkInCTU[MAX_CU_SIZE>>MIN_CU_LOG2][MAX_CU_SIZE>>MIN_CU_LOG2];    //[CTUSize>>MIN_CU_Log2][CTUSize>>MIN_CU_Log2]; [h][w]
-  Int  m_iCodedArea;
+  TComCtuScratch        m_ctuScratch;
+  static thread_local const TComPic* s_pcThreadScratchPic;     ///< picture whose CTU scratch is replaced for the calling thread
+  static thread_local TComCtuScratch* s_pcThreadScratch;
 
-  //for encoder speedup
-  TComMv                m_cIntMv[1<<((MAX_CU_DEPTH-MIN_CU_LOG2)<<1)][MAX_CU_DEPTH-MIN_CU_LOG2+1][MAX_CU_DEPTH-MIN_CU_LOG2+1][2][5]; //[zorder][w][h][refList][refIdx]
-  Bool                  m_bSetIntMv[1<<((MAX_CU_DEPTH-MIN_CU_LOG2)<<1)][MAX_CU_DEPTH-MIN_CU_LOG2+1][MAX_CU_DEPTH-MIN_CU_LOG2+1][2][5]; //[zorder][w][h][refList][refIdx]
-  Bool                  m_bSkiped[1<<((MAX_CU_DEPTH-MIN_CU_LOG2)<<1)][MAX_CU_DEPTH-MIN_CU_LOG2+1][MAX_CU_DEPTH-MIN_CU_LOG2+1]; //[zorder][w][h] , if skip mode, not try inter, intra
-  Bool                  m_bInter[1<<((MAX_CU_DEPTH-MIN_CU_LOG2)<<1)][MAX_CU_DEPTH-MIN_CU_LOG2+1][MAX_CU_DEPTH-MIN_CU_LOG2+1]; //[zorder][w][h] , if inter mode, not try intra
-  Bool                  m_bIntra[1<<((MAX_CU_DEPTH-MIN_CU_LOG2)<<1)][MAX_CU_DEPTH-MIN_CU_LOG2+1][MAX_CU_DEPTH-MIN_CU_LOG2+1]; // if intra mode, not try inter
+  TComCtuScratch&       xGetCtuScratch()                         { return this == s_pcThreadScratchPic ? *s_pcThreadScratch : m_ctuScratch; }
+#endif
+#if QTBT_PARALLEL_SPLIT
+  static thread_local TComCtuScratchReads* s_pcThreadScratchReads;  ///< reads of the calling thread's scratch, NULL: not recorded
+
+  Void                  xReadCtuScratch ( UInt uiZorder, UInt uiWIdx, UInt uiHIdx, UInt uiBit ) { if( s_pcThreadScratchReads && this == s_pcThreadScratchPic ) { s_pcThreadScratchReads->read ( uiZorder, uiWIdx, uiHIdx, uiBit ); } }
+  Void                  xWriteCtuScratch( UInt uiZorder, UInt uiWIdx, UInt uiHIdx, UInt uiBit ) { if( s_pcThreadScratchReads && this == s_pcThreadScratchPic ) { s_pcThreadScratchReads->write( uiZorder, uiWIdx, uiHIdx, uiBit ); } }
+#endif
+#if QTBT_PARALLEL_SPLIT
+  static thread_local const TComPic* s_pcThreadCtuCopyPic;     ///< picture whose CTU and reconstruction are replaced for the calling thread
+  static thread_local UInt        s_uiThreadCtuCopyAddr;
+  static thread_local TComDataCU* s_pcThreadCtuCopy;
+  static thread_local TComPicYuv* s_pcThreadPicYuvRec;
+  static thread_local TComPicYuv* s_pcThreadPicYuvPred;
 #endif
 
   std::vector<std::vector<TComDataCU*> > m_vSliceCUDataLink;
+#if VCEG_AZ08_INTER_KLT
+  TComSubPelCache       m_subPelCache;            //  Sub-pel luma samples for the inter KLT candidate search
+  TComSubPelCache*      m_apcWorkerSubPelCache[MAX_NUM_CTU_WORKERS]; //  the same for each CTU row worker, created on first use
+#endif
 
   SEIMessages  m_SEIs; ///< Any SEI messages that have been received.  If !NULL we own the object.
 
@@ -103,9 +157,25 @@ public:
   virtual ~TComPic();
 
 #if JVET_C0024_QTBT
+  /// the calling thread codes the CTUs of pcPic with its own scratch (NULL: back to the picture's one)
+  static Void   setThreadCtuScratch(const TComPic* pcPic, TComCtuScratch* pcScratch) { s_pcThreadScratchPic = pcPic; s_pcThreadScratch = pcScratch; }
+#if QTBT_PARALLEL_SPLIT
+  /// scratch of the calling thread
+  TComCtuScratch* getCtuScratch()                                { return &xGetCtuScratch(); }
+  /// records the fast decisions the calling thread reads from its own scratch before it sets them (NULL: stop)
+  static Void   setThreadCtuScratchReads(TComCtuScratchReads* pcReads) { s_pcThreadScratchReads = pcReads; }
+  /** the calling thread compresses a CU of CTU ctuRsAddr of pcPic into copies of the CTU, the reconstruction and the
+   *  prediction, so that the split candidates of the CU can be compressed concurrently (NULL: back to the picture's ones)
+   */
+  static Void   setThreadCtuCopy(const TComPic* pcPic, UInt ctuRsAddr, TComDataCU* pcCtu, TComPicYuv* pcPicYuvRec, TComPicYuv* pcPicYuvPred)
+  {
+    s_pcThreadCtuCopyPic = pcPic; s_uiThreadCtuCopyAddr = ctuRsAddr; s_pcThreadCtuCopy = pcCtu; s_pcThreadPicYuvRec = pcPicYuvRec; s_pcThreadPicYuvPred = pcPicYuvPred;
+  }
+#endif
+
   //to record coded block info.
   Void          setCodedBlkInCTU(Bool bCoded, UInt uiBlkX, UInt uiBlkY, UInt uiWidth, UInt uiHeight);
-  Bool          getCodedBlkInCTU(UInt uiBlkX, UInt uiBlkY) {return m_bCodedBlkInCTU[uiBlkY][uiBlkX];}
+  Bool          getCodedBlkInCTU(UInt uiBlkX, UInt uiBlkY) {return xGetCtuScratch().m_bCodedBlkInCTU[uiBlkY][uiBlkX];}
   Void          setCodedAreaInCTU(Int iArea);
   Void          addCodedAreaInCTU(Int iArea);
   Int           getCodedAreaInCTU();
@@ -147,13 +217,24 @@ public:
   TComPicSym*   getPicSym()           { return  &m_picSym;    }
   TComSlice*    getSlice(Int i)       { return  m_picSym.getSlice(i);  }
   Int           getPOC() const        { return  m_picSym.getSlice(m_uiCurrSliceIdx)->getPOC();  }
+#if QTBT_PARALLEL_SPLIT
+  TComDataCU*   getCtu( UInt ctuRsAddr )           { return  this == s_pcThreadCtuCopyPic && ctuRsAddr == s_uiThreadCtuCopyAddr ? s_pcThreadCtuCopy : m_picSym.getCtu( ctuRsAddr ); }
+  const TComDataCU* getCtu( UInt ctuRsAddr ) const { return  this == s_pcThreadCtuCopyPic && ctuRsAddr == s_uiThreadCtuCopyAddr ? s_pcThreadCtuCopy : m_picSym.getCtu( ctuRsAddr ); }
+#else
   TComDataCU*   getCtu( UInt ctuRsAddr )           { return  m_picSym.getCtu( ctuRsAddr ); }
   const TComDataCU* getCtu( UInt ctuRsAddr ) const { return  m_picSym.getCtu( ctuRsAddr ); }
+#endif
 
   TComPicYuv*   getPicYuvOrg()        { return  m_apcPicYuv[PIC_YUV_ORG]; }
+#if QTBT_PARALLEL_SPLIT
+  TComPicYuv*   getPicYuvRec()        { return  this == s_pcThreadCtuCopyPic ? s_pcThreadPicYuvRec : m_apcPicYuv[PIC_YUV_REC]; }
+
+  TComPicYuv*   getPicYuvPred()       { return  this == s_pcThreadCtuCopyPic ? s_pcThreadPicYuvPred : m_pcPicYuvPred; }
+#else
   TComPicYuv*   getPicYuvRec()        { return  m_apcPicYuv[PIC_YUV_REC]; }
 
   TComPicYuv*   getPicYuvPred()       { return  m_pcPicYuvPred; }
+#endif
   TComPicYuv*   getPicYuvResi()       { return  m_pcPicYuvResi; }
   Void          setPicYuvPred( TComPicYuv* pcPicYuv )       { m_pcPicYuvPred = pcPicYuv; }
   Void          setPicYuvResi( TComPicYuv* pcPicYuv )       { m_pcPicYuvResi = pcPicYuv; }
@@ -226,8 +307,9 @@ public:
   const SEIMessages& getSEIs() const { return m_SEIs; }
 
 #if VCEG_AZ08_INTER_KLT
-  TComPicYuv*   m_apcQuaPicYuv[4][4];     //   quarter pixel reconstructed pictures (fractional pixels); 
-  TComPicYuv*   getPicQuaYuvRec(UInt uiRow, UInt uiCol)     { return  m_apcQuaPicYuv[uiRow][uiCol]; }
+  Void              resetSubPelCache();                        ///< after the reconstruction of the picture
+  /// cache of the encoder (slot 0) or of the CTU row worker slot-1; a cache is used by one thread at a time
+  TComSubPelCache*  getSubPelCache( UInt slot = 0 );
 #endif
 #if JVET_D0033_ADAPTIVE_CLIPPING
   ClipParam m_aclip_prm;
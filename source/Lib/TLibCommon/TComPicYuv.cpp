@@ -222,6 +222,37 @@ Void  TComPicYuv::copyToPic (TComPicYuv*  pcPicYuvDst
   return;
 }
 
+#if QTBT_PARALLEL_SPLIT
+Void TComPicYuv::copyRectToPic( TComPicYuv* pcPicYuvDst, Int iX, Int iY, Int iWidth, Int iHeight ) const
+{
+  assert( m_iPicWidth  == pcPicYuvDst->getWidth(COMPONENT_Y)  );
+  assert( m_iPicHeight == pcPicYuvDst->getHeight(COMPONENT_Y) );
+  assert( getStride(COMPONENT_Y) == pcPicYuvDst->getStride(COMPONENT_Y) );
+
+  for( Int chan = 0; chan < getNumberValidComponents(); chan++ )
+  {
+    const ComponentID ch = ComponentID(chan);
+    const Int iScaleX    = getComponentScaleX( ch );
+    const Int iScaleY    = getComponentScaleY( ch );
+    const Int iLeft      = std::max( iX >> iScaleX, -getMarginX( ch ) );
+    const Int iTop       = std::max( iY >> iScaleY, -getMarginY( ch ) );
+    const Int iRight     = std::min( ( iX + iWidth  ) >> iScaleX, getWidth( ch )  + getMarginX( ch ) );
+    const Int iBottom    = std::min( ( iY + iHeight ) >> iScaleY, getHeight( ch ) + getMarginY( ch ) );
+    if( iLeft >= iRight || iTop >= iBottom )
+    {
+      continue;
+    }
+    const Int  iStride = getStride( ch );
+    const Pel* pSrc    = getAddr( ch ) + iTop * iStride + iLeft;
+    Pel*       pDst    = pcPicYuvDst->getAddr( ch ) + iTop * iStride + iLeft;
+    for( Int y = iTop; y < iBottom; y++, pSrc += iStride, pDst += iStride )
+    {
+      ::memcpy( pDst, pSrc, sizeof( Pel ) * ( iRight - iLeft ) );
+    }
+  }
+}
+#endif
+
 
 Void TComPicYuv::extendPicBorder (
 #if ALF_HM3_REFACTOR
@@ -151,6 +151,10 @@ public:
     , Bool bMarginIncluded = true
 #endif
     ) const ;
+#if QTBT_PARALLEL_SPLIT
+  /// copies the luma rectangle (iX, iY, iWidth, iHeight), clipped to the picture and its margin, and its chroma to the same place of pcPicYuvDst
+  Void          copyRectToPic     ( TComPicYuv* pcPicYuvDst, Int iX, Int iY, Int iWidth, Int iHeight ) const;
+#endif
 
   //  Extend function of picture buffer
   Void          extendPicBorder   (
@@ -44,7 +44,6 @@
 #include <../Lib/TLibEncoder/TEncSearch.h>
 #include <algorithm>
 #include <vector>
-TEncSearch *m_pcPredSearchPIP;
 
 
 #if INBLOCK_FILTER
@@ -53,6 +52,16 @@ bool inblockFilterTest = 0;
 
 #define PIPEncode					1
 
+// the incremental spatial RDOQ only models the default R1 syntax and a zero (NO_CBF) residual
+#define PIP_INCREMENTAL_SRDOQ		(PIPEncode && SRDOQ_INCREMENTAL && FAST_BIT_EST && MULTIPLEPRED && NO_CBF && USE_RDCOST_PIP && CBF2x2 && SIGN_APART && !R1_SIGNPREDICTION && !R1_DIRECTCODING && !R1_PREDICTIVE && !BITPLANE_R1_CODING && !NOISE_MARK && !INBLOCK_FILTER && !PIP_DOWNSAMPLE && !SP_QCHANGE && !SP_COEFFNxN_2 && !R1_CODECOEFFNXN_TEST)
+#if SRDOQ_TIMING
+#include <time.h>
+#endif
+
+// PIP scratch arena: buffers of a PIP block size and of a CU size that live at the same time
+#define PIP_SCRATCH_BLOCK_BUFS		40
+#define PIP_SCRATCH_CU_BUFS			5
+
 float filter10[9][6] =  /* A B C D A' C'*/
 {
 	{ 0.5, 0.5, 0.0, 0.0, 0.0, 0.0 },	// 0.5A+0.5B
@@ -145,15 +154,26 @@ const UChar TComPrediction::m_aucIntraFilter[MAX_NUM_CHANNEL_TYPE][MAX_INTRA_FIL
 TComPrediction::TComPrediction()
 	: m_pLumaRecBuffer(0)
 	, m_iLumaRecStride(0)
+#if PIP
+	, MINRESraw(NULL)
+	, REF(NULL)
+	, ORG(NULL)
+	, m_pcPIPContext(NULL)
+	, m_pcPIPStats(NULL)
+	, m_pcPIPCoderState(NULL)
+	, m_pcPredSearchPIP(NULL)
+#endif
 {
 #if VCEG_AZ05_BIO 
 #define BIO_TEMP_BUFFER_SIZE      (MAX_CU_SIZE+4)*(MAX_CU_SIZE+4) 
+#define BIO_NUM_SUMS              15
 	m_pGradX0 = new Pel[BIO_TEMP_BUFFER_SIZE];
 	m_pGradY0 = new Pel[BIO_TEMP_BUFFER_SIZE];
 	m_pGradX1 = new Pel[BIO_TEMP_BUFFER_SIZE];
 	m_pGradY1 = new Pel[BIO_TEMP_BUFFER_SIZE];
 	m_pPred0 = new Pel[BIO_TEMP_BUFFER_SIZE];
 	m_pPred1 = new Pel[BIO_TEMP_BUFFER_SIZE];
+	m_piBIOSums = new Int64[BIO_NUM_SUMS * BIO_TEMP_BUFFER_SIZE]();
 	iRefListIdx = -1;
 #endif
 #if COM16_C1046_PDPC_INTRA
@@ -182,10 +202,6 @@ TComPrediction::TComPrediction()
 	m_cFRUCRDCost.init();
 #endif
 
-#if VCEG_AZ08_INTER_KLT
-	m_tempPicYuv = NULL;
-#endif
-
 #if JVET_E0077_LM_MF
 	for (Int i = 0; i < LM_FILTER_NUM; i++)
 	{
@@ -211,6 +227,7 @@ Void TComPrediction::destroy()
 	if (m_pGradY1 != NULL)     { delete[] m_pGradY1; m_pGradY1 = NULL; }
 	if (m_pPred0 != NULL)     { delete[] m_pPred0; m_pPred0 = NULL; }
 	if (m_pPred1 != NULL)     { delete[] m_pPred1; m_pPred1 = NULL; }
+	if (m_piBIOSums != NULL)  { delete[] m_piBIOSums; m_piBIOSums = NULL; }
 #endif
 
 #if COM16_C1046_PDPC_INTRA
@@ -251,6 +268,18 @@ Void TComPrediction::destroy()
 	}
 
 	m_cYuvPredTemp.destroy();
+#if PIP
+#if PIP_SCRATCH_STATS
+	if (m_cPIPArena.getSize())
+		printf("PIP scratch arena: %d heap allocations, %d of %d bytes used at most\n", m_cPIPArena.getNumHeapAllocs(), (Int)m_cPIPArena.getPeak(), (Int)m_cPIPArena.getSize());
+#endif
+	m_cPIPArena.destroy();
+	if (REF)
+	{
+		xFree(REF); REF = NULL;
+		xFree(ORG); ORG = NULL;
+	}
+#endif
 
 	if (m_pLumaRecBuffer)
 	{
@@ -304,28 +333,13 @@ Void TComPrediction::destroy()
 	}
 #endif
 #endif
-
-#if VCEG_AZ08_INTER_KLT
-	if (m_tempPicYuv != NULL)
-	{
-		m_tempPicYuv->destroy();
-		delete m_tempPicYuv;
-		m_tempPicYuv = NULL;
-	}
-#endif
 }
 
 #if COM16_C806_LMCHROMA
 Void TComPrediction::initTempBuff(ChromaFormat chromaFormatIDC, Int bitDepthY
-#if VCEG_AZ08_INTER_KLT
-	, bool interKLT, const Int iPicWidth, const Int iPicHeight, const UInt uiMaxCUWidth, const UInt uiMaxCUHeight, const UInt uiMaxCUDepth
-#endif
 	)
 #else
 Void TComPrediction::initTempBuff(ChromaFormat chromaFormatIDC
-#if VCEG_AZ08_INTER_KLT
-	, bool interKLT, const Int iPicWidth, const Int iPicHeight, const UInt uiMaxCUWidth, const UInt uiMaxCUHeight, const UInt uiMaxCUDepth
-#endif
 	)
 #endif
 {
@@ -380,6 +394,11 @@ Void TComPrediction::initTempBuff(ChromaFormat chromaFormatIDC
 #if VCEG_AZ07_FRUC_MERGE
 		m_cYuvPredFrucTemplate[0].create(MAX_CU_SIZE, MAX_CU_SIZE, chromaFormatIDC);
 		m_cYuvPredFrucTemplate[1].create(MAX_CU_SIZE, MAX_CU_SIZE, chromaFormatIDC);
+#endif
+#if PIP
+		// the block buffers of xPredIntraAngPIP and performILRBlock (up to 4x the PIP block each), and the
+		// CU size buffers of the intra search (R1 maps, reconstructions with the stride of the CTU)
+		m_cPIPArena.create(PIP_SCRATCH_BLOCK_BUFS * 4 * CUMAX * CUMAX * sizeof(Int) + PIP_SCRATCH_CU_BUFS * MAX_CU_SIZE * MAX_CU_SIZE * sizeof(Int));
 #endif
 	}
 
@@ -452,19 +471,6 @@ Void TComPrediction::initTempBuff(ChromaFormat chromaFormatIDC
 		m_uiaICShift[i] = ((1 << 15) + i / 2) / i;
 	}
 #endif
-
-#if VCEG_AZ08_INTER_KLT
-	if (interKLT)
-	{
-		if (m_tempPicYuv != NULL)
-		{
-			m_tempPicYuv->destroy();
-			delete m_tempPicYuv;
-		}
-		m_tempPicYuv = new TComPicYuv;
-		m_tempPicYuv->create(iPicWidth, iPicHeight, chromaFormatIDC, uiMaxCUWidth, uiMaxCUHeight, uiMaxCUDepth, true);
-	}
-#endif
 }
 
 // ====================================================================================================================
@@ -570,21 +576,22 @@ Void TComPrediction::xPredIntraAngPIP(Int bitDepth,
 	unsigned int			ruiDist;
 	Double					dSingleCost = MAX_DOUBLE;
 	Double					dBestCost = MAX_DOUBLE, dBestBits = MAX_DOUBLE, dBestDist = MAX_DOUBLE;
+	TComScratchScope		scratchScope(m_cPIPArena); // all the buffers of the block are released on return
 
 
 
-	Pel					*prediction = (Pel*)xMalloc(Pel, width*height*sizeof(Pel));
-	Pel					*predictionLevel = (Pel*)xMalloc(Pel, width*height*sizeof(Pel));
-	Pel					*predictionScan = (Pel*)xMalloc(Pel, width*height*sizeof(Pel));
-	Pel					*predictionPred = (Pel*)xMalloc(Pel, width*height*sizeof(Pel));
-	Pel					*predictionSpQ = (Pel*)xMalloc(Pel, width*height*sizeof(Pel));
-	Pel					*R1 = (Pel*)xMalloc(Pel, width*height*sizeof(Pel));
+	Pel					*prediction = m_cPIPArena.alloc<Pel>(width*height);
+	Pel					*predictionLevel = m_cPIPArena.alloc<Pel>(width*height);
+	Pel					*predictionScan = m_cPIPArena.alloc<Pel>(width*height);
+	Pel					*predictionPred = m_cPIPArena.alloc<Pel>(width*height);
+	Pel					*predictionSpQ = m_cPIPArena.alloc<Pel>(width*height);
+	Pel					*R1 = m_cPIPArena.alloc<Pel>(width*height);
 
 
 #if PIPEncode
-	Pel					*residual = (Pel*)xMalloc(Pel, width*height*sizeof(Pel));
-	Pel					*pReco = (Pel*)xMalloc(Pel, MAX_CU_SIZE * MAX_CU_SIZE);
-	Int					*curMinresPred = (Int*)xMalloc(Int, width*height*sizeof(Int));
+	Pel					*residual = m_cPIPArena.alloc<Pel>(width*height);
+	Pel					*pReco = m_cPIPArena.alloc<Pel>(MAX_CU_SIZE * MAX_CU_SIZE);
+	Int					*curMinresPred = m_cPIPArena.alloc<Int>(width*height);
 	TEncSbac*			pcRDGoOnSbacCoder = m_pcPredSearchPIP[0].m_pcRDGoOnSbacCoder;
 	TComTrQuant*		TrQuant = m_pcPredSearchPIP[0].m_pcTrQuant;
 	TEncSbac****		pppcRDSbacCoder = m_pcPredSearchPIP[0].m_ppppcRDSbacCoder;
@@ -604,25 +611,17 @@ Void TComPrediction::xPredIntraAngPIP(Int bitDepth,
 
 	Pel A, A_prime, B, C, C_prime, D, X, R, qR, iqR;
 	// offset here
-	int offset_temp = 0;
-	if (width == 4 && height == 4)
-		offset_temp = offset4x4;
-	if (width == 4 && height == 8)
-		offset_temp = offset4x8;
-	if (width == 8 && height == 4)
-		offset_temp = offset8x4;
-	if (width == 8 && height == 8)
-		offset_temp = offset8x8;
+	int offset_temp = m_pcPIPContext->getSpQOffset(width, height);
 
 	// int qStep = spQ;
-	int qStep = spQ + offset_temp;
+	int qStep = m_pcPIPContext->getSpQ() + offset_temp;
 
 
 
 	Int stride = width + 1;
-	Pel *predBuffer = (Pel*)xMalloc(Pel, (width + 1)*(height + 1)*sizeof(Pel));
+	Pel *predBuffer = m_cPIPArena.alloc<Pel>((width + 1)*(height + 1));
 
-	int *res = (int*)xMalloc(Pel, width*height*sizeof(int));
+	int *res = m_cPIPArena.alloc<int>(width*height);
 
 	// fill the first row and column with the pixels from the neighbors
 	Int					DC_val = 0; // TEMP
@@ -639,7 +638,7 @@ Void TComPrediction::xPredIntraAngPIP(Int bitDepth,
 
 
 #if INBLOCK_FILTER
-	Pel* buffOrg = (Pel*)xMalloc(Pel, width*height*sizeof(Pel));
+	Pel* buffOrg = m_cPIPArena.alloc<Pel>(width*height);
 	for (int y = 0; y < height; y++)
 		for (int x = 0; x < width; x++)
 			buffOrg[y*width + x] = piOrg[y*dstStrideTrue + x];
@@ -746,41 +745,44 @@ Void TComPrediction::xPredIntraAngPIP(Int bitDepth,
 	int qDepth = 1; // 0 means no search, 1 means only the current pixel, 2 means current pixel and its first neighbor so on
 	Bool RDOQ = 1;
 	// priority: right > bottom > bottom-right
-	int* qLvl = (int*)xMalloc(int, qDepth*sizeof(int));
-	int* qMap = (int*)xMalloc(int, width*height*sizeof(int));	
+	int* qLvl = m_cPIPArena.alloc<int>(qDepth);
+	int* qMap = m_cPIPArena.alloc<int>(width*height);	
 	memset(qMap, -1, width*height*sizeof(int));
 #if NOISE_MARK
-	int* qNoiseMark = (int*)xMalloc(int, width*height*sizeof(int));
+	int* qNoiseMark = m_cPIPArena.alloc<int>(width*height);
 	// memset(qNoiseMark, 1, width*height*sizeof(int));
 	for (int cf = 0; cf < width*height; cf++)
 		qNoiseMark[cf] = 1;
 #endif
-	int* spQR1_Level = (int*)xMalloc(int, width*height*sizeof(int));
-	int* spQR1_Scan = (int*)xMalloc(int, width*height*sizeof(int)); 
-	int* spQR1_Predictor = (int*)xMalloc(int, width*height*sizeof(int));
-	int* spQR1_spQChange = (int*)xMalloc(int, width*height*sizeof(int));
-	int* qBestMap = (int*)xMalloc(int, width*height*sizeof(int)); 
+	int* spQR1_Level = m_cPIPArena.alloc<int>(width*height);
+	int* spQR1_Scan = m_cPIPArena.alloc<int>(width*height); 
+	int* spQR1_Predictor = m_cPIPArena.alloc<int>(width*height);
+	int* spQR1_spQChange = m_cPIPArena.alloc<int>(width*height);
+	int* qBestMap = m_cPIPArena.alloc<int>(width*height); 
 	
 
 	int bestCost;
 
 #if LOG_SPQ_CHANGE
 	int spQchCount = 7;
-	int *costs = (int*)xMalloc(int, spQchCount*sizeof(int));
+	int *costs = m_cPIPArena.alloc<int>(spQchCount);
 #endif
 	
 
 #if PIP_DOWNSAMPLE
 
 	// downsample the original block
-	Pel *piOrg_downsampled = (Pel*)xMalloc(Pel, height / 2 * dstStrideTrue*sizeof(Pel));
+	Pel *piOrg_downsampled = m_cPIPArena.alloc<Pel>(height / 2 * dstStrideTrue);
 	performDownsampling(piOrg, piOrg_downsampled, width, height, dstStrideTrue);
 
 	// downsample the predBuffer
-	Pel *predBuffer_downsampled = (Pel*)xMalloc(Pel, (width/2 + 1)*(height/2 + 1)*sizeof(Pel));
+	Pel *predBuffer_downsampled = m_cPIPArena.alloc<Pel>((width/2 + 1)*(height/2 + 1));
 
 #endif
 
+#if SRDOQ_TIMING
+	clock_t searchStart = clock();
+#endif
 	if (RDOQ)
 	{		
 #if !FULL_RDO_ILR
@@ -792,15 +794,89 @@ Void TComPrediction::xPredIntraAngPIP(Int bitDepth,
 		// Predictor		
 		int bestPredictor = 0;
 		int predictorCount = 1;
-		int* spQR1_cur = (int*)xMalloc(int, width*height*sizeof(int));
+		int* spQR1_cur = m_cPIPArena.alloc<int>(width*height);
+#if PIP_INCREMENTAL_SRDOQ
+		// block with the pixels from the tested one on rounded, and best candidate of the tested pixel
+		int* resRnd = m_cPIPArena.alloc<int>(width*height);
+		int* resBest = m_cPIPArena.alloc<int>(width*height);
+		int* spQR1Rnd = m_cPIPArena.alloc<int>(width*height);
+		int* spQR1Best = m_cPIPArena.alloc<int>(width*height);
+		Pel* predictionRnd = m_cPIPArena.alloc<Pel>(width*height);
+		Pel* predictionBest = m_cPIPArena.alloc<Pel>(width*height);
+		UInt64 fracBitsBase = 0;
+		PIPRateTable rateTableBlk;
+		const PIPRateTable* rateTable = 0;
+		if (m_pcPIPContext->getFastRateEst())
+		{
+			pppcRDSbacCoder[uiWIdx][uiHIdx][CI_PP_TEMP]->initPIPRateTable(pcCU, rateTableBlk);
+			rateTable = &rateTableBlk;
+		}
+#if PIP_RATE_EST_CHECK
+		Int rateEstFirstDiff = MAX_INT;
+#endif
+#endif
 #if MULTIPLEPRED
 		predictorCount = 4;
 		Double bestCost_pred = MAX_DOUBLE;
 		UInt bestRate = MAX_UINT;
 		UInt bestDist = MAX_UINT;
 		memset(spQR1_cur, 0, width*height*sizeof(int));
+#if PIP_INCREMENTAL_SRDOQ && PIP_PARALLEL_PRED && !PIP_RATE_EST_CHECK
+		// the predictors after the first one only read the coder state and fracBitsBase: each one gets its
+		// own buffers and they are evaluated together, then taken in the serial order below
+		const Bool parallelPred = m_cPIPPool.getNumThreads() > 1 && width*height >= PIP_PARALLEL_MIN_SAMPLES;
+		Pel* candPredBuffer[MULTIPLEPRED];
+		int* candRes[MULTIPLEPRED];
+		int* candSpQR1[MULTIPLEPRED];
+		Pel* candPrediction[MULTIPLEPRED];
+		Double candCost[MULTIPLEPRED];
+		UInt candBits[MULTIPLEPRED], candDist[MULTIPLEPRED];
+		for (int predictor = 1; predictor < predictorCount && parallelPred; predictor++)
+		{
+			candPredBuffer[predictor] = m_cPIPArena.alloc<Pel>((width + 1)*(height + 1));
+			candRes[predictor] = m_cPIPArena.alloc<int>(width*height);
+			candSpQR1[predictor] = m_cPIPArena.alloc<int>(width*height);
+			candPrediction[predictor] = m_cPIPArena.alloc<Pel>(width*height);
+			memcpy(candPredBuffer[predictor], predBuffer, (width + 1)*(height + 1)*sizeof(Pel));
+		}
+#endif
 		for (int predictor = 0; predictor < predictorCount; predictor++)
 		{
+#if PIP_INCREMENTAL_SRDOQ && PIP_PARALLEL_PRED && !PIP_RATE_EST_CHECK
+			if (predictor && parallelPred)
+			{
+				if (predictor == 1)
+				{
+					const ClipParam clipParam = g_ClipParam; // per thread, the pool threads take the one of the caller
+					m_cPIPPool.parallelFor(predictorCount - 1, [&](Int task)
+					{
+						g_ClipParam = clipParam;
+						const Int candidate = task + 1;
+						xPIPQuantizeDPCM(candidate, qMap, 0, width*height, width, height, candPredBuffer[candidate], candRes[candidate], candPrediction[candidate], candSpQR1[candidate], piOrg, dstStrideTrue, qStep, 0);
+						candCost[candidate] = xPIPGetRDCostIncremental(rTu, width, height, candPrediction[candidate], candRes[candidate], candSpQR1[candidate], piOrg, dstStrideTrue, bitDepth, fracBitsBase, rateTable, candidate, candBits[candidate], candDist[candidate]);
+					});
+				}
+				memcpy(res, candRes[predictor], width*height*sizeof(int));
+				memcpy(spQR1_cur, candSpQR1[predictor], width*height*sizeof(int));
+				memcpy(prediction, candPrediction[predictor], width*height*sizeof(Pel));
+				dSingleCost = candCost[predictor];
+				Bits = candBits[predictor];
+				ruiDist = candDist[predictor];
+			}
+			else
+#endif
+#if PIP_INCREMENTAL_SRDOQ
+			if (predictor)
+			{
+				xPIPQuantizeDPCM(predictor, qMap, 0, width*height, width, height, predBuffer, res, prediction, spQR1_cur, piOrg, dstStrideTrue, qStep, 0);
+				dSingleCost = xPIPGetRDCostIncremental(rTu, width, height, prediction, res, spQR1_cur, piOrg, dstStrideTrue, bitDepth, fracBitsBase, rateTable, predictor, Bits, ruiDist);
+#if PIP_RATE_EST_CHECK
+				xPIPCheckRateEstimate(rTu, width, height, predBuffer, predictor, qMap, piOrg, dstStrideTrue, bitDepth, qStep, Bits, rateTable != 0, rateEstFirstDiff);
+#endif
+			}
+			else
+			{
+#endif
 			pcRDGoOnSbacCoder->load(pppcRDSbacCoder[uiWIdx][uiHIdx][CI_PP_TEMP]);
 #if PIP_DOWNSAMPLE
 			performILRBlock(0, predictor, qMap, 0, rTu, width/2, height/2, predBuffer_downsampled, res, prediction, spQR1_cur, piOrg_downsampled, dstStrideTrue/2, bitDepth, qStep, Bits, ruiDist, dSingleCost, 0, piOrg);
@@ -813,6 +889,18 @@ Void TComPrediction::xPredIntraAngPIP(Int bitDepth,
 				, qNoiseMark
 #endif
 				);
+#endif
+#if PIP_INCREMENTAL_SRDOQ
+				// everything but the R1 syntax is coded the same way for all the candidates of the block
+				if (rateTable)
+				{
+					// the full pass codes the predictor index left in the CU, the table the tested one
+					fracBitsBase = pcRDGoOnSbacCoder->getNumberOfWrittenFracBits() - TEncSbac::estimatePIPFracBits(*rateTable, spQR1_cur, pcCU->getPIPCBidx(0));
+					dSingleCost = xPIPGetRDCostIncremental(rTu, width, height, prediction, res, spQR1_cur, piOrg, dstStrideTrue, bitDepth, fracBitsBase, rateTable, predictor, Bits, ruiDist);
+				}
+				else
+					fracBitsBase = pcRDGoOnSbacCoder->getNumberOfWrittenFracBits() - pppcRDSbacCoder[uiWIdx][uiHIdx][CI_PP_TEMP]->estimatePIPR1FracBits(pcCU, spQR1_cur);
+			}
 #endif
 			if (dSingleCost < bestCost_pred)
 			{
@@ -821,6 +909,11 @@ Void TComPrediction::xPredIntraAngPIP(Int bitDepth,
 				bestCost_pred = dSingleCost;
 				bestRate = Bits;
 				bestDist = ruiDist;
+#if PIP_INCREMENTAL_SRDOQ
+				memcpy(resRnd, res, width*height*sizeof(int));
+				memcpy(spQR1Rnd, spQR1_cur, width*height*sizeof(int));
+				memcpy(predictionRnd, prediction, width*height*sizeof(Pel));
+#endif
 				/* --> Not necessary as long as there is RDOQ afterward.
 				for (int y = 0; y < height; y++)
 				memcpy(pTrueDst + y*dstStrideTrue, prediction + y*width, width*sizeof(Pel));
@@ -840,14 +933,14 @@ Void TComPrediction::xPredIntraAngPIP(Int bitDepth,
 
 
 #if LOG_SPQ_CHANGE
-		int tmp_spQ = spQ;		
-		for (int spQch = spQ - spQchCount; spQch < spQ + spQchCount + 1; spQch++)
+		int tmp_spQ = m_pcPIPContext->getSpQ();		
+		for (int spQch = m_pcPIPContext->getSpQ() - spQchCount; spQch < m_pcPIPContext->getSpQ() + spQchCount + 1; spQch++)
 		{
 			pcRDGoOnSbacCoder->load(pppcRDSbacCoder[uiWIdx][uiHIdx][CI_PP_TEMP]);
 			qStep = max(spQch,1);
 			performILRBlock(0, bestPredictor, qMap, 0, rTu, width, height, predBuffer, res, prediction, spQR1_cur, piOrg, dstStrideTrue, bitDepth, qStep, Bits, ruiDist, dSingleCost, 0);
 			qStep = tmp_spQ;
-			costs[spQch - (spQ - spQchCount)] = dSingleCost;		
+			costs[spQch - (m_pcPIPContext->getSpQ() - spQchCount)] = dSingleCost;		
 		}
 		
 #endif
@@ -897,17 +990,17 @@ Void TComPrediction::xPredIntraAngPIP(Int bitDepth,
 #endif
 
 		// Quantizer
-		float* qMapCmpRound = (float*)xMalloc(Int, width*height*sizeof(float));
+		float* qMapCmpRound = m_cPIPArena.alloc<float>(width*height);
 		memset(qMapCmpRound, -1, width*height*sizeof(float));
-		Int* qMapTmp = (Int*)xMalloc(Int, width*height*sizeof(Int));
+		Int* qMapTmp = m_cPIPArena.alloc<Int>(width*height);
 		memset(qMapTmp, -1, width*height*sizeof(Int));
 #if NOISE_MARK
-		Int* qNoiseMarkTmp = (Int*)xMalloc(Int, width*height*sizeof(Int));
+		Int* qNoiseMarkTmp = m_cPIPArena.alloc<Int>(width*height);
 		// memset(qNoiseMarkTmp, 1, width*height*sizeof(Int));
 		for (int cf = 0; cf < width*height; cf++)
 			qNoiseMarkTmp[cf] = 1;
 #endif
-		Pel	*prediction_qlvl = (Pel*)xMalloc(Pel, width*height*sizeof(Pel));
+		Pel	*prediction_qlvl = m_cPIPArena.alloc<Pel>(width*height);
 		
 		Double tmpBestCost;
 		UInt bestRateEver = MAX_UINT;
@@ -915,7 +1008,76 @@ Void TComPrediction::xPredIntraAngPIP(Int bitDepth,
 
 		if (SRDOQ)
 		{
-			
+#if PIP_INCREMENTAL_SRDOQ
+			// Pixel cf only depends on the pixels before it, so the candidates of cf are quantized from cf on,
+			// and a candidate giving the same level as the rounded block at cf gives that very block.
+			Double costRnd = bestCost_pred;
+			UInt bitsRnd = bestRate, distRnd = bestDist;
+			for (int cf = 0; cf < width*height; cf++)
+			{
+				Double bestCost_Level = MAX_DOUBLE;
+				Bool bestIsRnd = false;
+
+				memcpy(res, resRnd, cf*sizeof(int));
+				memcpy(spQR1_cur, spQR1Rnd, cf*sizeof(int));
+				for (int ql = 0; ql < 2 + THREE_LEVELS_RDOQ; ql++)
+				{
+					memcpy(qMapTmp, qMap, width*height*sizeof(int));
+					qMapTmp[cf] = ql;
+
+					xPIPQuantizeDPCM(bestPredictor, qMapTmp, cf, cf + 1, width, height, predBuffer, res, prediction, spQR1_cur, piOrg, dstStrideTrue, qStep, qMapCmpRound);
+					Bool isRnd = res[cf] == resRnd[cf];
+					if (isRnd)
+					{
+						dSingleCost = costRnd;
+						Bits = bitsRnd;
+						ruiDist = distRnd;
+					}
+					else
+					{
+						xPIPQuantizeDPCM(bestPredictor, qMapTmp, cf + 1, width*height, width, height, predBuffer, res, prediction, spQR1_cur, piOrg, dstStrideTrue, qStep, qMapCmpRound);
+						dSingleCost = xPIPGetRDCostIncremental(rTu, width, height, prediction, res, spQR1_cur, piOrg, dstStrideTrue, bitDepth, fracBitsBase, rateTable, bestPredictor, Bits, ruiDist);
+#if PIP_RATE_EST_CHECK
+						xPIPCheckRateEstimate(rTu, width, height, predBuffer, bestPredictor, qMapTmp, piOrg, dstStrideTrue, bitDepth, qStep, Bits, rateTable != 0, rateEstFirstDiff);
+#endif
+					}
+
+					if (dSingleCost < bestCost_Level)
+					{
+						tmpBestCost = dSingleCost;
+						bestRateEver = Bits;
+						bestDistEver = ruiDist;
+						bestCost_Level = dSingleCost;
+						qMap[cf] = ql;
+						bestIsRnd = isRnd;
+						if (!isRnd)
+						{
+							memcpy(resBest, res, width*height*sizeof(int));
+							memcpy(spQR1Best, spQR1_cur, width*height*sizeof(int));
+							memcpy(predictionBest, prediction, width*height*sizeof(Pel));
+						}
+					}
+				} // for ql
+
+				// the winner of cf is the rounded block of cf + 1
+				if (!bestIsRnd)
+				{
+					std::swap(resRnd, resBest);
+					std::swap(spQR1Rnd, spQR1Best);
+					std::swap(predictionRnd, predictionBest);
+					costRnd = bestCost_Level;
+					bitsRnd = bestRateEver;
+					distRnd = bestDistEver;
+				}
+			}
+
+			for (int y = 0; y < height; y++)
+				for (int x = 0; x < width; x++)
+				{
+					pTrueDst[y*dstStrideTrue + x] = predictionRnd[y*width + x];
+					spQR1[y*width + x] = spQR1Rnd[y*width + x];
+				}
+#else
 			for (int cf = 0; cf < width*height; cf++)
 			{				
 				Double bestCost_Level = MAX_DOUBLE;
@@ -980,6 +1142,7 @@ Void TComPrediction::xPredIntraAngPIP(Int bitDepth,
 #endif
 				} // for ql
 			}
+#endif
 
   			for (int y = 0; y < height; y++)
 				for (int x = 0; x < width; x++)
@@ -1033,7 +1196,6 @@ Void TComPrediction::xPredIntraAngPIP(Int bitDepth,
 		RefPred[(inblockFilterTest ? 3 : 0) + 1] = (Int)bestRateEver;
 		RefPred[(inblockFilterTest ? 3 : 0) + 2] = (Int)bestDistEver;
 
-		_aligned_free(buffOrg);
 
 
 
@@ -1060,14 +1222,6 @@ Void TComPrediction::xPredIntraAngPIP(Int bitDepth,
 
 			*/
 		
-		_aligned_free(prediction_qlvl);
-  		_aligned_free(qMapCmpRound);
-		_aligned_free(qMapTmp);
-		_aligned_free(spQR1_cur);
-#if NOISE_MARK
-		_aligned_free(qNoiseMark);
-		_aligned_free(qNoiseMarkTmp);
-#endif
 #else
 		int bestCostspQch = MAX_INT;
 		double bestBitsPred = MAX_DOUBLE; 
@@ -1075,7 +1229,7 @@ Void TComPrediction::xPredIntraAngPIP(Int bitDepth,
 		int spQch_best = -1;
 		int predictor_bestPred = -1;
 		pcRDGoOnSbacCoder->store(pppcRDSbacCoder[uiWIdx][uiHIdx][CI_PP_TEMP]);
-		int tmp_spQ = spQ;
+		int tmp_spQ = m_pcPIPContext->getSpQ();
 		int spQloop = 1;
 #if SP_QCHANGE
 #if SP_SIGNLECHANGE
@@ -1087,17 +1241,17 @@ Void TComPrediction::xPredIntraAngPIP(Int bitDepth,
 		for (int spQch = 0; spQch < spQloop; spQch++) 
 		{
 #if SP_QCHANGE
-			spQ = tmp_spQ;
+			m_pcPIPContext->setSpQ(tmp_spQ);
 			int curSpQoffset = 0;
 			if (spQch > 0)
 			{
 #if SP_SIGNLECHANGE
-				spQ += (spQch == 1 ? -1 : 1) * SP_QOFFSET;
-				spQ = max(spQ, 1);
+				m_pcPIPContext->setSpQ(m_pcPIPContext->getSpQ() + (spQch == 1 ? -1 : 1) * SP_QOFFSET);
+				m_pcPIPContext->setSpQ(max(m_pcPIPContext->getSpQ(), 1));
 #else
-				spQ += (spQch % 2 ? -1 : 1) * (floor((spQch - 1) / 2) + 1) * SP_QQUANTIZER;
-				if (spQ < 1)
-					spQ = 1;
+				m_pcPIPContext->setSpQ(m_pcPIPContext->getSpQ() + (spQch % 2 ? -1 : 1) * (floor((spQch - 1) / 2) + 1) * SP_QQUANTIZER);
+				if (m_pcPIPContext->getSpQ() < 1)
+					m_pcPIPContext->setSpQ(1);
 #endif
 			}
 
@@ -1119,7 +1273,7 @@ Void TComPrediction::xPredIntraAngPIP(Int bitDepth,
 #endif
 
 			
-			qStep = spQ;
+			qStep = m_pcPIPContext->getSpQ();
 			int bestCostPred = MAX_INT;
 #if MULTIPLEPRED
 			int predCount2 = 4;
@@ -1216,8 +1370,8 @@ Void TComPrediction::xPredIntraAngPIP(Int bitDepth,
 		} // end loop spQch
 
 
-		spQ = tmp_spQ;
 #if SP_QCHANGE
+		m_pcPIPContext->setSpQ(tmp_spQ);
 		if (spQch_best)
 		{
 			pcCU->setPIPspQIsChangedFlagSubParts(1, 0, 0);
@@ -1247,6 +1401,10 @@ Void TComPrediction::xPredIntraAngPIP(Int bitDepth,
 			MinRes[c] = qBestMap[c];
 #endif
 	}
+#if SRDOQ_TIMING
+	m_pcPIPStats->searchTime[(width > 4) * 2 + (height > 4)] += (Double)(clock() - searchStart) / CLOCKS_PER_SEC;
+	m_pcPIPStats->searchCount[(width > 4) * 2 + (height > 4)]++;
+#endif
 
 	/*
 	for (int x = 0; x < width + 1; x++)
@@ -1277,22 +1435,6 @@ Void TComPrediction::xPredIntraAngPIP(Int bitDepth,
 	
 	pcRDGoOnSbacCoder->load(pppcRDSbacCoder[uiWIdx][uiHIdx][CI_PP_TEMP]);
 
-	_aligned_free(qLvl);
-	_aligned_free(qMap);
-	_aligned_free(qBestMap);
-	_aligned_free(spQR1_Level);
-	_aligned_free(spQR1_Predictor);
-	_aligned_free(spQR1_Scan);
-	_aligned_free(predBuffer);
-	_aligned_free(res);
-	_aligned_free(residual);
-	_aligned_free(pReco);
-	_aligned_free(curMinresPred);
-	_aligned_free(predictionLevel);
-	_aligned_free(predictionPred);
-	_aligned_free(predictionSpQ);
-	_aligned_free(predictionScan);
-	_aligned_free(spQR1_spQChange);
 #else
 	CBidx = pcCU->getPIPCBidx(0);
 	// get the R1 residual from the codebook
@@ -1332,19 +1474,19 @@ Void TComPrediction::xPredIntraAngPIP(Int bitDepth,
 			int A_pred = -1, B_pred = -1, C_pred = -1, D_pred = -1;
 			if (y)
 			{
-				C_res = abs(spQR1[(y - 1)*width + x] / spQ);
+				C_res = abs(spQR1[(y - 1)*width + x] / m_pcPIPContext->getSpQ());
 				C_pred = pTrueDst[(y - 1)*dstStrideTrue + x];
 				if (x)
 				{
-					A_res = abs(spQR1[y*width + x - 1] / spQ);
+					A_res = abs(spQR1[y*width + x - 1] / m_pcPIPContext->getSpQ());
 					A_pred = pTrueDst[y*dstStrideTrue + x - 1];
 					
-					B_res = abs(spQR1[(y - 1)*width + x - 1] / spQ);
+					B_res = abs(spQR1[(y - 1)*width + x - 1] / m_pcPIPContext->getSpQ());
 					B_pred = pTrueDst[(y - 1)*dstStrideTrue + x - 1];
 				}
 				if (x < width - 1)
 				{
-					D_res = abs(spQR1[(y - 1)*width + x + 1] / spQ);
+					D_res = abs(spQR1[(y - 1)*width + x + 1] / m_pcPIPContext->getSpQ());
 					D_pred = pTrueDst[(y - 1)*dstStrideTrue + x + 1];
 				}				
 			}
@@ -1352,7 +1494,7 @@ Void TComPrediction::xPredIntraAngPIP(Int bitDepth,
 			{
 				if (x)
 				{
-					A_res = abs(spQR1[y*width + x - 1]) / spQ;
+					A_res = abs(spQR1[y*width + x - 1]) / m_pcPIPContext->getSpQ();
 					A_pred = pTrueDst[y*dstStrideTrue + x - 1];
 				}
 			}
@@ -1365,8 +1507,6 @@ Void TComPrediction::xPredIntraAngPIP(Int bitDepth,
 
 
 
-	_aligned_free(prediction);
-	_aligned_free(R1);
 }
 
 #if PIP_DOWNSAMPLE
@@ -1463,6 +1603,222 @@ Void TComPrediction::performDownsamplingRef(Pel* srcPredBuffer, Pel* dstPredBuff
 #if PIPEncode
 
 
+/** DPCM prediction and spatial quantization of the pixels [startIdx, endIdx) in raster order.
+ *  predBuffer, res and prediction must already hold the values of the pixels before startIdx,
+ *  which lets the spatial RDOQ re-quantize a block from the tested pixel on.
+ */
+Void TComPrediction::xPIPQuantizeDPCM(int predictor, int* qMap, int startIdx, int endIdx
+	, int width, int height, Pel *predBuffer, int *res, Pel *prediction, int* spQR1, Pel* piOrg, Int dstStrideTrue, int qStep, float* qMapCmp
+#if NOISE_MARK
+	, Int* qNoiseMark
+#endif
+	)
+{
+	Pel A, A_prime, B, C, C_prime, D, X, R, qR, iqR;
+#if NOISE_MARK
+	Bool mark;
+#endif
+
+#if PIP_DPCM_WAVEFRONT && COM16_C806_SIMD_OPT && !NOISE_MARK && !USE_24CLUSTER_PREDICTOR
+	// a range of more than one line spans enough diagonals for the wavefront
+	if (endIdx - startIdx > width && TComPIPDPCM::isPreferred(width, height))
+	{
+#if MULTIPLEPRED
+		const Float* filter = predictor ? filter10[predictor - 1] : NULL;
+#else
+		const Float* filter = NULL;
+#endif
+		TComPIPDPCM::quantize(filter, qMap, startIdx, endIdx, width, height, predBuffer, res, prediction, spQR1, piOrg, dstStrideTrue, qStep, qMapCmp);
+		return;
+	}
+#endif
+
+	const TComSpatialQuant spQuant(qStep);
+	Int stride = width + 1, row = startIdx / width, col = startIdx % width;
+	Int offset = (row + 1)*stride + 1, offsetPP = row*width;
+	for (int pos = startIdx; pos < endIdx; pos++)
+	{
+#if !NOISE_MARK
+		A = predBuffer[offset + col - 1] + (col ? res[offsetPP + col - 1] : 0);
+		B = predBuffer[offset + col - stride - 1] + (col && row ? res[offsetPP + col - width - 1] : 0);
+		C = predBuffer[offset + col - stride] + (row ? res[offsetPP + col - width] : 0);
+		D = C;
+		if (col < width - 1)
+			D = predBuffer[offset + col - stride + 1] + (row ? res[offsetPP + col - width + 1] : 0);
+		A_prime = A;
+		if (col)
+			A_prime = predBuffer[offset + col - 2] + ((col > 1) ? res[offsetPP + col - 2] : 0);
+		C_prime = C;
+		if (row)
+			C_prime = predBuffer[offset + col - 2 * stride] + ((row>1) ? res[offsetPP + col - 2 * width] : 0);
+#else
+		int idx = row*width + col - 1;
+		mark = qNoiseMark[ idx > - 1 ? idx : 0];
+		A = predBuffer[offset + col - 1] + (col ? (mark ? res[offsetPP + col - 1] : res[offsetPP + col - 1] / 2) : 0);
+		idx = (row - 1)*width + col - 1 > -1 ? (row - 1)*width + col - 1 : 0;
+		mark = qNoiseMark[idx];
+		B = predBuffer[offset + col - stride - 1] + (col && row) ? (mark ? res[offsetPP + col - width - 1] : res[offsetPP + col - width - 1] / 2) : 0;
+		idx = (row - 1)*width + col > -1 ? (row - 1)*width + col : 0;
+		mark = qNoiseMark[idx];
+		C = predBuffer[offset + col - stride] + (row ? (mark ? res[offsetPP + col - width] : res[offsetPP + col - width] / 2) : 0);
+		D = C;
+		if (col < width - 1)
+		{
+			idx = (row - 1)*width + col + 1 > -1 ? (row - 1)*width + col + 1 : 0;
+			mark = qNoiseMark[idx];
+			D = predBuffer[offset + col - stride + 1] + (row ? (mark ? res[offsetPP + col - width + 1] : res[offsetPP + col - width + 1] / 2) : 0);
+		}
+		A_prime = A;
+		if (col)
+		{
+			idx = row*width + col - 2 > -1 ? row*width + col - 2 : 0;
+			mark = qNoiseMark[idx];
+			A_prime = predBuffer[offset + col - 2] + ((col > 1 && mark) ? res[offsetPP + col - 2] : 0);
+		}
+		C_prime = C;
+		if (row)
+		{
+			idx = (row - 1)*width + col - 2 > -1 ? (row - 1)*width + col - 2 : 0;
+			mark = qNoiseMark[idx];
+			C_prime = predBuffer[offset + col - 2 * stride] + ((row>1 && mark) ? res[offsetPP + col - 2 * width] : 0);
+		}
+#endif
+
+#if USE_24CLUSTER_PREDICTOR
+		int clIdx = getCluster(A, B, C, D);
+		int filter[4] =
+		{
+			clusterPredictor[clIdx][0],
+			clusterPredictor[clIdx][1],
+			clusterPredictor[clIdx][2],
+			clusterPredictor[clIdx][3]
+		};
+		int sum = filter[0] + filter[1] + filter[2] + filter[3];
+		X = (Pel)((filter[0] * A + filter[1] * B + filter[2] * C + filter[3] * D) / sum);
+#else
+#if MULTIPLEPRED
+		if (!predictor)
+			X = (B >= max(A, C) ? min(A, C) : (B <= min(A, C) ? max(A, C) : (A + C - B)));
+		else
+			X = filter10[predictor - 1][0] * A + filter10[predictor - 1][1] * B + filter10[predictor - 1][2] * C + filter10[predictor - 1][3] * D + filter10[predictor - 1][4] * A_prime + filter10[predictor - 1][5] * C_prime;
+#else
+		X = (B >= max(A, C) ? min(A, C) : (B <= min(A, C) ? max(A, C) : (A + C - B)));
+
+#endif
+#endif
+
+		X = ClipA(X, COMPONENT_Y);
+
+		predBuffer[offset + col] = X;
+		prediction[row * width + col] = X;
+
+		// spatial domain quantization			
+		qR = piOrg[row*dstStrideTrue + col] - X;
+		int curQres = spQuant.level(abs(qR), qMap[row*width + col]);
+
+		// 
+		if (qMapCmp)
+		{
+			int curQresRnd = spQuant.roundLevel(abs(qR));
+			qMapCmp[row*width + col] = ((curQres != curQresRnd) ? 1 : -1) * (float(abs(abs(qR) - abs(curQresRnd)*qStep)) / (float)qStep);
+		}
+
+		if (curQres > COEFF_LIMIT)
+			curQres = COEFF_LIMIT;
+
+#if NOISE_MARK
+		if (curQres <= NOISE_THR)
+			qNoiseMark[row*width + col] = 1;
+#endif
+
+		curQres *= (qR < 0 ? -1 : 1) * qStep;
+
+		res[offsetPP + col] = curQres;
+		spQR1[row*width + col] = res[offsetPP + col];
+
+		if (++col == width) // next line
+		{
+			col = 0;
+			row++;
+			offset += stride;
+			offsetPP += width;
+		}
+	}
+}
+
+
+#if PIP_INCREMENTAL_SRDOQ
+/** RD cost of a block quantized by xPIPQuantizeDPCM, without running the transform and the entropy coder.
+ *  With NO_CBF the reconstruction is prediction + R1, and only the R1 syntax changes between the
+ *  candidates of a block, so the rate is the constant part fracBitsBase (measured once by
+ *  performILRBlock) plus the R1 part given by TEncSbac::estimatePIPR1FracBits.
+ *  With a rate table (PIPFastRate) the variable part comes from TEncSbac::estimatePIPFracBits instead,
+ *  which also counts the index of the tested predictor.
+ */
+Double TComPrediction::xPIPGetRDCostIncremental(TComTU& rTu, int width, int height, Pel *prediction, int *res, int* spQR1, Pel* piOrg, Int dstStrideTrue, Int bitDepth
+	, UInt64 fracBitsBase, const PIPRateTable* rateTable, Int predictor, UInt& Bits, unsigned int& ruiDist)
+{
+	TComDataCU				*pcCU = rTu.getCU();
+	const UInt				uiWIdx = g_aucConvertToBit[pcCU->getWidth(0)];
+	const UInt				uiHIdx = g_aucConvertToBit[pcCU->getHeight(0)];
+	TEncSbac*			pcTempSbacCoder = m_pcPredSearchPIP[0].m_ppppcRDSbacCoder[uiWIdx][uiHIdx][CI_PP_TEMP];
+	TComRdCost*			RdCost = m_pcPredSearchPIP[0].m_pcRdCost;
+
+	Pel pReco[CUMAX*CUMAX];
+	for (int y = 0; y < height; y++)
+		for (int x = 0; x < width; x++)
+			pReco[y*width + x] = Pel(ClipA<Int>(Int(prediction[y*width + x]) + Int(res[y*width + x]), COMPONENT_Y));
+	ruiDist = RdCost->getDistPart(bitDepth, pReco, width, piOrg, dstStrideTrue, width, height, COMPONENT_Y);
+
+	if (rateTable)
+		Bits = UInt((fracBitsBase + TEncSbac::estimatePIPFracBits(*rateTable, spQR1, predictor)) >> 15);
+	else
+		Bits = UInt((fracBitsBase + pcTempSbacCoder->estimatePIPR1FracBits(pcCU, spQR1)) >> 15);
+
+	return RdCost->calcRdCost(Bits, ruiDist);
+}
+
+#if PIP_RATE_EST_CHECK
+/** Rate of one candidate through the full performILRBlock path, compared with the estimate.
+ *  The fast estimate has no context adaptation inside the block and leaves out the syntax that is the
+ *  same for all the candidates, so its deviation is measured from the first candidate of the block.
+ */
+Void TComPrediction::xPIPCheckRateEstimate(TComTU& rTu, int width, int height, Pel *predBuffer, int predictor, int* qMap, Pel* piOrg, Int dstStrideTrue, Int bitDepth, Int qStep
+	, UInt estBits, Bool isFastRate, Int& rFirstDiff)
+{
+	TComDataCU				*pcCU = rTu.getCU();
+	const UInt				uiWIdx = g_aucConvertToBit[pcCU->getWidth(0)];
+	const UInt				uiHIdx = g_aucConvertToBit[pcCU->getHeight(0)];
+	TEncSbac*			pcRDGoOnSbacCoder = m_pcPredSearchPIP[0].m_pcRDGoOnSbacCoder;
+
+	Int		resChk[CUMAX*CUMAX], spQR1Chk[CUMAX*CUMAX], qMapChk[CUMAX*CUMAX];
+	Pel		predictionChk[CUMAX*CUMAX];
+	Pel		predBufferChk[(CUMAX + 1)*(CUMAX + 1)];
+	UInt	fullBits, fullDist;
+	Double	fullCost;
+	memcpy(qMapChk, qMap, width*height*sizeof(Int));
+	memcpy(predBufferChk, predBuffer, (width + 1)*(height + 1)*sizeof(Pel));
+
+	const Int storedIdx = pcCU->getPIPCBidx(0);
+	if (isFastRate)
+		pcCU->setPIPCBidx(0, predictor);
+	pcRDGoOnSbacCoder->load(m_pcPredSearchPIP[0].m_ppppcRDSbacCoder[uiWIdx][uiHIdx][CI_PP_TEMP]);
+	performILRBlock(0, predictor, qMapChk, 0, rTu, width, height, predBufferChk, resChk, predictionChk, spQR1Chk, piOrg, dstStrideTrue, bitDepth, qStep, fullBits, fullDist, fullCost, 0);
+	pcCU->setPIPCBidx(0, storedIdx);
+
+	Int diff = Int(fullBits) - Int(estBits);
+	if (!isFastRate)
+		rFirstDiff = 0;
+	else if (rFirstDiff == MAX_INT)
+		rFirstDiff = diff;
+	const Double dev = abs(diff - rFirstDiff);
+	m_pcPIPStats->rateEstMaxDev = max(m_pcPIPStats->rateEstMaxDev, dev);
+	m_pcPIPStats->rateEstSumDev += dev;
+	m_pcPIPStats->rateEstCount++;
+}
+#endif
+#endif
+
 Void TComPrediction::performILRBlock(int scan, int predictor, int* qMap, int spQch
 	// the remaining inputs
 	, TComTU& rTu, int width, int height, Pel *predBuffer, int *res, Pel *prediction, int* spQR1, Pel* piOrg, Int dstStrideTrue, Int bitDepth, int qStep
@@ -1479,7 +1835,7 @@ Void TComPrediction::performILRBlock(int scan, int predictor, int* qMap, int spQ
 #endif
 	)
 {
-	int tmp_spQ = spQ;
+	int tmp_spQ = m_pcPIPContext->getSpQ();
 	TComDataCU				*pcCU = rTu.getCU();
 	const QpParam			cQP(*pcCU, COMPONENT_Y);
 	const UInt				uiWIdx = g_aucConvertToBit[pcCU->getWidth(0)];
@@ -1498,184 +1854,28 @@ Void TComPrediction::performILRBlock(int scan, int predictor, int* qMap, int spQ
 #endif
 	Int					*RefPred = m_pcPredSearchPIP[0].m_pppcQTTempRefPred[COMPONENT_Y][uiWIdx][uiHIdx];
 	Int					*CurPred = m_pcPredSearchPIP[0].m_pppcQTTempCurPred[COMPONENT_Y][uiWIdx][uiHIdx];
+	TComScratchScope	scratchScope(m_cPIPArena);
 
 #if PIP_DOWNSAMPLE
-	Pel					*residual = (Pel*)xMalloc(Pel, 4*width*height*sizeof(Pel));
+	Pel					*residual = m_cPIPArena.alloc<Pel>(4*width*height);
 	memset(residual, 0, 4*width*height*sizeof(Pel));
 #else
-	Pel					*residual = (Pel*)xMalloc(Pel, width*height*sizeof(Pel));
+	Pel					*residual = m_cPIPArena.alloc<Pel>(width*height);
 	memset(residual, 0, width*height*sizeof(Pel));
 #endif
-	Pel					*pReco = (Pel*)xMalloc(Pel, MAX_CU_SIZE * MAX_CU_SIZE);
-
-	Pel A, A_prime, B, C, C_prime, D, X, R, qR, iqR;
-#if NOISE_MARK
-	Bool mark;
-#endif
+	Pel					*pReco = m_cPIPArena.alloc<Pel>(MAX_CU_SIZE * MAX_CU_SIZE);
 
 	// unsigned int			ruiDist;
 	// Double					dSingleCost = MAX_DOUBLE;
 
 	// PERFORM THE PREDICTION AND QUANTIZATION 
-	Int stride = width + 1, offset = stride + 1, offsetPP = 0, row = 0, col = 0, offsetOrg = 0;
-	while (row < height) // loop over lines
-	{
-		for (col = 0; col < width; col++) // loop over columns
-		{
-
-#if !NOISE_MARK
-			A = predBuffer[offset + col - 1] + (col ? res[offsetPP + col - 1] : 0);
-			B = predBuffer[offset + col - stride - 1] + (col && row ? res[offsetPP + col - width - 1] : 0);
-			C = predBuffer[offset + col - stride] + (row ? res[offsetPP + col - width] : 0);
-			D = C;
-			if (col < width - 1)
-				D = predBuffer[offset + col - stride + 1] + (row ? res[offsetPP + col - width + 1] : 0);
-			A_prime = A;
-			if (col)
-				A_prime = predBuffer[offset + col - 2] + ((col > 1) ? res[offsetPP + col - 2] : 0);
-			C_prime = C;
-			if (row)
-				C_prime = predBuffer[offset + col - 2 * stride] + ((row>1) ? res[offsetPP + col - 2 * width] : 0);
-#else
-			int idx = row*width + col - 1;
-			mark = qNoiseMark[ idx > - 1 ? idx : 0];
-			A = predBuffer[offset + col - 1] + (col ? (mark ? res[offsetPP + col - 1] : res[offsetPP + col - 1] / 2) : 0);
-			idx = (row - 1)*width + col - 1 > -1 ? (row - 1)*width + col - 1 : 0;
-			mark = qNoiseMark[idx];
-			B = predBuffer[offset + col - stride - 1] + (col && row) ? (mark ? res[offsetPP + col - width - 1] : res[offsetPP + col - width - 1] / 2) : 0;
-			idx = (row - 1)*width + col > -1 ? (row - 1)*width + col : 0;
-			mark = qNoiseMark[idx];
-			C = predBuffer[offset + col - stride] + (row ? (mark ? res[offsetPP + col - width] : res[offsetPP + col - width] / 2) : 0);
-			D = C;
-			if (col < width - 1)
-			{
-				idx = (row - 1)*width + col + 1 > -1 ? (row - 1)*width + col + 1 : 0;
-				mark = qNoiseMark[idx];
-				D = predBuffer[offset + col - stride + 1] + (row ? (mark ? res[offsetPP + col - width + 1] : res[offsetPP + col - width + 1] / 2) : 0);
-			}
-			A_prime = A;
-			if (col)
-			{
-				idx = row*width + col - 2 > -1 ? row*width + col - 2 : 0;
-				mark = qNoiseMark[idx];
-				A_prime = predBuffer[offset + col - 2] + ((col > 1 && mark) ? res[offsetPP + col - 2] : 0);
-			}
-			C_prime = C;
-			if (row)
-			{
-				idx = (row - 1)*width + col - 2 > -1 ? (row - 1)*width + col - 2 : 0;
-				mark = qNoiseMark[idx];
-				C_prime = predBuffer[offset + col - 2 * stride] + ((row>1 && mark) ? res[offsetPP + col - 2 * width] : 0);
-			}
-#endif
-
-#if USE_24CLUSTER_PREDICTOR
-			int clIdx = getCluster(A, B, C, D);
-			int filter[4] =
-			{
-				clusterPredictor[clIdx][0],
-				clusterPredictor[clIdx][1],
-				clusterPredictor[clIdx][2],
-				clusterPredictor[clIdx][3]
-			};
-			int sum = filter[0] + filter[1] + filter[2] + filter[3];
-			X = (Pel)((filter[0] * A + filter[1] * B + filter[2] * C + filter[3] * D) / sum);
-#else
-#if MULTIPLEPRED
-			if (!predictor)
-				X = (B >= max(A, C) ? min(A, C) : (B <= min(A, C) ? max(A, C) : (A + C - B)));
-			else
-				X = filter10[predictor - 1][0] * A + filter10[predictor - 1][1] * B + filter10[predictor - 1][2] * C + filter10[predictor - 1][3] * D + filter10[predictor - 1][4] * A_prime + filter10[predictor - 1][5] * C_prime;
-#else
-			X = (B >= max(A, C) ? min(A, C) : (B <= min(A, C) ? max(A, C) : (A + C - B)));
-
-#endif
-#endif
-
-				X = ClipA(X, COMPONENT_Y);
-
-				predBuffer[offset + col] = X;
-				prediction[row * width + col] = X;
-
-				// spatial domain quantization			
-				qR = piOrg[row*dstStrideTrue + col] - X;
-				int curQres;
-
-
-				int curQresRnd = round((double)(abs(qR)) / (double)qStep);
-				/*
-				if (qMap[row*width + col] == -1) // default: round
-					curQres = round((double)(abs(qR)) / (double)qStep);
-				else
-					if (qMap[row*width + col] == 0) // TOP
-						curQres = ceil((double)(abs(qR)) / (double)qStep);
-					else // BOTTOM-M
-						curQres = max(floor((double)(abs(qR)) / (double)qStep) - qMap[row*width + col] + 1, 0.0);*/
-
-				switch (qMap[row*width+col])
-				{
-				case -1: // round
-				{
-					curQres = round((double)(abs(qR)) / (double)qStep);
-					break;
-				}
-				case 0: // TOP
-				{
-					curQres = ceil((double)(abs(qR)) / (double)qStep);
-					break;
-				}
-				case 1: // BOTTOM
-				{
-					curQres = max(floor((double)(abs(qR)) / (double)qStep) - qMap[row*width + col] + 1, 0.0);
-					curQres = floor((double)(abs(qR)) / (double)qStep);
-					curQres = curQres - qMap[row*width + col] + 1;
-					curQres = max(curQres, 0);
-					break;
-				}
-				case 2: // TOP+1 or BOTTOM-1
-				{
-					int r = round((double)(abs(qR)) / (double)qStep);
-					int t = ceil((double)(abs(qR)) / (double)qStep);
-					int b = max(floor((double)(abs(qR)) / (double)qStep), 0.0);
-					// curQres = (r == t) ? t + 1 : max(b - 1, 0);
-					curQres = max(b - 1, 0);
-					break;
-				}
-				default:
-					break;
-				}
-
-
-				// 
-				if (qMapCmp)
-					qMapCmp[row*width + col] = ((curQres != curQresRnd) ? 1 : -1) * (float(abs(abs(qR) - abs(curQresRnd)*qStep)) / (float)qStep);
-
-
-
-
-				if (curQres > COEFF_LIMIT)
-					curQres = COEFF_LIMIT;
-
+	xPIPQuantizeDPCM(predictor, qMap, 0, width*height, width, height, predBuffer, res, prediction, spQR1, piOrg, dstStrideTrue, qStep, qMapCmp
 #if NOISE_MARK
-				if (curQres <= NOISE_THR)
-					qNoiseMark[row*width + col] = 1;
+		, qNoiseMark
 #endif
-
-				curQres *= (qR < 0 ? -1 : 1) * qStep;
-
-				res[offsetPP + col] = curQres;
-				spQR1[row*width + col] = res[offsetPP + col];
-
-
-				// MinRes[row*width + col] = res[offsetPP + col];
-				R1SpQn[row*width + col] = res[offsetPP + col];
-
-		}
-		row++;
-		offset += stride;
-		offsetPP += width;
-		offsetOrg += width;
-	}
+		);
+	for (int cf = 0; cf < width*height; cf++)
+		R1SpQn[cf] = spQR1[cf];
 
 
 #if PIP_DOWNSAMPLE
@@ -1685,7 +1885,7 @@ Void TComPrediction::performILRBlock(int scan, int predictor, int* qMap, int spQ
 		for (int x = 0; x < width; x++)
 			prediction[y*width + x] += res[y*width + x];
 
-	Pel *prediction_temp = (Pel*)xMalloc(Pel, (width * 2)*(height * 2)*sizeof(Pel));
+	Pel *prediction_temp = m_cPIPArena.alloc<Pel>((width * 2)*(height * 2));
 	performUpsampling(prediction, prediction_temp, width, height, width);
 	memcpy(prediction, prediction_temp, (width * 2)*(height * 2)*sizeof(Pel));
 
@@ -1767,16 +1967,16 @@ Void TComPrediction::performILRBlock(int scan, int predictor, int* qMap, int spQ
 
 
 #if SP_COEFFNxN_2
-		SpatialCodeCoeffNxN_2 = true;
+		m_pcPIPCoderState->spatialCodeCoeffNxN2 = true;
 		Bool allZero = true;
 		for (int coef = 0; coef < 16; coef++)
 		{
-			TMPSpR1[coef] = spQR1[coef] / spQ;
+			m_pcPIPCoderState->tmpSpR1[coef] = spQR1[coef] / m_pcPIPContext->getSpQ();
 			allZero &= abs(spQR1[coef]) == 0;
 		}
 		if (!allZero)
 			Bits2 = m_pcPredSearchPIP[0].xGetIntraBitsQT(rTu, true, false, false, spQR1);
-		SpatialCodeCoeffNxN_2 = false;
+		m_pcPIPCoderState->spatialCodeCoeffNxN2 = false;
 		pcRDGoOnSbacCoder->load(pppcRDSbacCoder[uiWIdx][uiHIdx][CI_PP_TEMP]);
 #endif
 
@@ -1840,8 +2040,6 @@ Void TComPrediction::performILRBlock(int scan, int predictor, int* qMap, int spQ
 	else
 		dSingleCost = ruiDist;
 
-	_aligned_free(residual);
-	_aligned_free(pReco);
 }
 #endif
 
@@ -1862,7 +2060,7 @@ Void TComPrediction::performILRBlock_r1CodecoeffNxN(int scan, int predictor, int
 #endif
 	)
 {
-	tmpFlag = true; // during the encoding phase, this flag says that we are in this temporary mode
+	m_pcPIPCoderState->tmpFlag = true; // during the encoding phase, this flag says that we are in this temporary mode
 
 
 	TComDataCU				*pcCU = rTu.getCU();
@@ -1880,11 +2078,12 @@ Void TComPrediction::performILRBlock_r1CodecoeffNxN(int scan, int predictor, int
 	Int					*R1SpQn = m_pcPredSearchPIP[0].m_pppcQTTempR1SpQn[COMPONENT_Y][uiWIdx][uiHIdx];
 	Int					*RefPred = m_pcPredSearchPIP[0].m_pppcQTTempRefPred[COMPONENT_Y][uiWIdx][uiHIdx];
 	Int					*CurPred = m_pcPredSearchPIP[0].m_pppcQTTempCurPred[COMPONENT_Y][uiWIdx][uiHIdx];
+	TComScratchScope	scratchScope(m_cPIPArena);
 
-	Pel					*residual = (Pel*)xMalloc(Pel, width*height*sizeof(Pel));
+	Pel					*residual = m_cPIPArena.alloc<Pel>(width*height);
 	memset(residual, 0, width*height*sizeof(Pel));
 	Pel					residualTmp[16];
-	Pel					*pReco = (Pel*)xMalloc(Pel, MAX_CU_SIZE * MAX_CU_SIZE);
+	Pel					*pReco = m_cPIPArena.alloc<Pel>(MAX_CU_SIZE * MAX_CU_SIZE);
 
 	Pel A, A_prime, B, C, C_prime, D, X, R, qR, iqR;
 
@@ -2022,10 +2221,8 @@ Void TComPrediction::performILRBlock_r1CodecoeffNxN(int scan, int predictor, int
 	// get the RDCost 
 	dSingleCost = RdCost->calcRdCost(Bits, ruiDist);
 
-	_aligned_free(residual);
-	_aligned_free(pReco);
 
-	tmpFlag = false;
+	m_pcPIPCoderState->tmpFlag = false;
 }
 #endif
 Void TComPrediction::DPCMPred(const Pel* pSrc, Pel* res
@@ -2068,10 +2265,11 @@ Void TComPrediction::DPCMPred(const Pel* pSrc, Pel* res
 	Pel *predBuffer;	
 
 	Pel *mPredBuffer;
-	mPredBuffer = (Pel*)xMalloc(Pel, (width + 1)*(height + 1));
+	TComScratchScope scratchScope(m_cPIPArena);
+	mPredBuffer = m_cPIPArena.alloc<Pel>((width + 1)*(height + 1));
 
 	// fill the first row and columd with the pixels from the neighbors
-	predBuffer = (Pel*)xMalloc(Pel, (width + 1)*(height + 1));
+	predBuffer = m_cPIPArena.alloc<Pel>((width + 1)*(height + 1));
 	Int stride = width + 1, offset = stride + 1, offsetPP = 0, row = 0, offsetOrg = 0;
 	for (int x = 0; x < width + 1; x++)
 	{
@@ -2084,6 +2282,14 @@ Void TComPrediction::DPCMPred(const Pel* pSrc, Pel* res
 		mPredBuffer[y*stride] = pSrc[(y - 1)*srcStride - 1];
 	}
 
+#if PIP_DPCM_WAVEFRONT && COM16_C806_SIMD_OPT && !NOISE_MARK
+	if (!isEncode && TComPIPDPCM::isPreferred(width, height))
+	{
+		TComPIPDPCM::predict(f ? filter10[f - 1] : NULL, width, height, predBuffer + 1, predBuffer + stride, stride, res, prediction);
+		return;
+	}
+#endif
+
 	// file the inner pixels of the buffer for the MinRes: only at the encoder
 	if (isEncode)
 		for (int row = 0; row < height; row++)
@@ -2169,10 +2375,6 @@ Void TComPrediction::DPCMPred(const Pel* pSrc, Pel* res
 	}
 
 
-	
-	// Free 
-	_aligned_free(predBuffer);
-	_aligned_free(mPredBuffer);
 }
 #if USE_24CLUSTER_PREDICTOR
 int TComPrediction::getCluster(int A, int B, int C, int D)
@@ -2207,9 +2409,10 @@ int TComPrediction::PIPgetRDCost(TComTU& rTu, Pel *R1, Pel *ref, Pel *org, int w
 	TComDataCU			*pcCU = rTu.getCU();
 	const UInt			uiWIdx = g_aucConvertToBit[pcCU->getWidth(0)];
 	const UInt			uiHIdx = g_aucConvertToBit[pcCU->getHeight(0)];
-	Pel					*prediction = (Pel*)xMalloc(Pel, width*height*sizeof(Pel));
-	Pel					*residual = (Pel*)xMalloc(Pel, width*height*sizeof(Pel));
-	Pel					*pReco = (Pel*)xMalloc(Pel, MAX_CU_SIZE * MAX_CU_SIZE);
+	TComScratchScope	scratchScope(m_cPIPArena);
+	Pel					*prediction = m_cPIPArena.alloc<Pel>(width*height);
+	Pel					*residual = m_cPIPArena.alloc<Pel>(width*height);
+	Pel					*pReco = m_cPIPArena.alloc<Pel>(MAX_CU_SIZE * MAX_CU_SIZE);
 	TEncSbac*			pcRDGoOnSbacCoder = m_pcPredSearchPIP[0].m_pcRDGoOnSbacCoder;
 	TComTrQuant*		TrQuant = m_pcPredSearchPIP[0].m_pcTrQuant;
 	TEncSbac****		pppcRDSbacCoder = m_pcPredSearchPIP[0].m_ppppcRDSbacCoder;
@@ -2228,7 +2431,7 @@ int TComPrediction::PIPgetRDCost(TComTU& rTu, Pel *R1, Pel *ref, Pel *org, int w
 
 	// ------------------- do the prediction
 	int row = 0, col = 0, stride = width + 1, A, B, C, X, offset = stride + 1, offsetPP = 0;
-	int *predBuffer = (int*)xMalloc(int, (width + 1)*(height + 1)*sizeof(int));
+	int *predBuffer = m_cPIPArena.alloc<int>((width + 1)*(height + 1));
 	// Get the RefAbove and RefLeft
 	for (int x = 0; x < width + 1; x++)
 	{
@@ -2293,7 +2496,7 @@ int TComPrediction::PIPgetRDCost(TComTU& rTu, Pel *R1, Pel *ref, Pel *org, int w
 			pReco[dstStrideTrue*y + x] = Pel(ClipA<Int>(Int(prediction[y*width + x]) + Int(R1[y*width + x]) + Int(residual[y*dstStrideTrue + x]), COMPONENT_Y));
 
 	// get the RDCost 
-	int *spQR1dummy = (int*)xMalloc(int, width*height*sizeof(int));
+	int *spQR1dummy = m_cPIPArena.alloc<int>(width*height);
 	memset(spQR1dummy, 0, width*height*sizeof(int));
 	UInt Bits = m_pcPredSearchPIP[0].xGetIntraBitsQT(rTu, true, false, false, spQR1dummy
 #if NOISE_MARK
@@ -2305,11 +2508,6 @@ int TComPrediction::PIPgetRDCost(TComTU& rTu, Pel *R1, Pel *ref, Pel *org, int w
 	if (dSingleCost > SHRT_MAX)
 		dSingleCost = SHRT_MAX;
 
-	_aligned_free(prediction);
-	_aligned_free(residual);
-	_aligned_free(pReco);
-	_aligned_free(predBuffer);
-
 	return (short)dSingleCost;
 #else
 	return 0;
@@ -2437,7 +2635,7 @@ Void TComPrediction::CodebookConstruction(TComTU& rTu, Int dstStrideTrue, Int sr
 		for (int fv = 0; fv < width*height*CBf; fv++)
 		{
 			for (int p = 0; p < width*height; p++)
-				cout << Codebooks[CUSizeCBIdx][fv][p] << ",";
+				cout << m_pcPIPContext->getCodebooks()[CUSizeCBIdx][fv][p] << ",";
 			cout << endl;
 		}
 
@@ -2451,7 +2649,7 @@ Void TComPrediction::CodebookConstruction(TComTU& rTu, Int dstStrideTrue, Int sr
 			int curBestVec = 0;
 			for (int fv = 0; fv < width*height*CBf; fv++)
 			{
-				int dcost = PIPgetRDCost(rTu, (short*)Codebooks[CUSizeCBIdx][fv], REF[s], ORG[s], width, height, dstStrideTrue, bitDepth);
+				int dcost = PIPgetRDCost(rTu, (short*)m_pcPIPContext->getCodebooks()[CUSizeCBIdx][fv], REF[s], ORG[s], width, height, dstStrideTrue, bitDepth);
 				if (dcost < curBestCost)
 				{
 					curBestCost = dcost;
@@ -2547,7 +2745,7 @@ Void TComPrediction::CodebookConstruction(TComTU& rTu, Int dstStrideTrue, Int sr
 						nextVector[y*width + x] = SumMR;
 
 						// update the codebook
-						Codebooks[CUSizeCBIdx][fv][y*width + x] = SumMR;
+						m_pcPIPContext->getCodebooks()[CUSizeCBIdx][fv][y*width + x] = SumMR;
 						LGBCodebook[fv][y*width + x] = SumMR;
 
 						// have another loop over samples to update the reconstructed pixels
@@ -2641,75 +2839,29 @@ Void TComPrediction::CodebookConstruction(TComTU& rTu, Int dstStrideTrue, Int sr
 
 Void TComPrediction::ReadTextFiles(int &sampleCnt, int height, int width, int qp)
 {
-	Bool offlineCost = true;
-	int t0 = time(NULL);
-	string line, token, delimiter = "\t";
-	int chunkSize = 2000, t;
-	char addr[100], buff[20];
-		
-
-	
-	char addr2[100];
-	strcpy(addr2, "../../../CB/Blocks");
-	strcat(addr2, _itoa(height, buff, 10));
-	strcat(addr2, "x");
-	strcat(addr2, _itoa(width, buff, 10));
-	strcat(addr2, "_");
-	strcat(addr2, itoa(qp, buff, 10));
-	strcat(addr2, "_CBf");
-	strcat(addr2, itoa(CBf, buff, 10));
-	strcat(addr2, ".txt");
-	ifstream DataBlocks(addr2, ios::in);
-	if (DataBlocks.is_open())
-	{
-		while (getline(DataBlocks, line)) // Count the number of samples for memory allocation.
-			sampleCnt++;
-		// sampleCnt -= sampleCnt % chunkSize;
-	}
-	else
+	// the blocks stay in the mapped container (or in the text copy of the context): REF and ORG only point to them
+	UInt numBlocks = 0, rowLen = 0;
+	const Short* pBlocks = m_pcPIPContext->getTrainingBlocks(qp, width, height, numBlocks, rowLen);
+	if (!pBlocks || rowLen != width + height + 1 + width * height)
 	{
-		cout << "failed to open " << addr2 << endl;
+		cout << "failed to read the training blocks " << TComPIPCodebookFile::textBlocksName(m_pcPIPContext->getCodebookDir(), qp, width, height) << endl;
 		assert(false);
+		return;
 	}
+	sampleCnt = numBlocks;
 
+	if (REF)
+	{
+		xFree(REF);
+		xFree(ORG);
+	}
 	REF = (short**)xMalloc(short*, sampleCnt*sizeof(short*));
 	ORG = (short**)xMalloc(short*, sampleCnt*sizeof(short*));
 	for (int s = 0; s < sampleCnt; s++)
 	{
-		REF[s] = (short*)xMalloc(short, (width + height + 1)*sizeof(short));
-		ORG[s] = (short*)xMalloc(short, width*height*sizeof(short));
-	}
-
-	int lineCnt = 0;	
-
-	// read VecSet.txt
-	DataBlocks.clear();
-	DataBlocks.seekg(0, ios::beg);
-	lineCnt = 0;
-	while (getline(DataBlocks, line) && lineCnt < sampleCnt)
-	{
-		// parse the block in this order ==>> MinRes.RefAboveLeft.RefAbove.RefLefr.OrgBlock 
-		int tokenCnt = 0;
-		while (tokenCnt < width + height + 1)											// RefAboveLeft.RefAbove.RefLeft
-		{
-			token = line.substr(0, line.find(delimiter));
-			line.erase(0, line.find(delimiter) + 1);
-			t = atoi(token.c_str());
-			// REF[BlocksMap[lineCnt]][tokenCnt] = t;
-			REF[lineCnt][tokenCnt] = t;
-			tokenCnt++;
-		}
-		tokenCnt = 0;
-		while (tokenCnt < width*height)
-		{
-			token = line.substr(0, line.find(delimiter));
-			line.erase(0, line.find(delimiter) + 1);
-			t = atoi(token.c_str());
-			// ORG[BlocksMap[lineCnt]][tokenCnt] = t;
-			ORG[lineCnt][tokenCnt] = t;
-			tokenCnt++;
-		}
-		lineCnt++;
+		// RefAboveLeft.RefAbove.RefLeft.OrgBlock; the training only reads them
+		REF[s] = const_cast<short*>(pBlocks + s * rowLen);
+		ORG[s] = REF[s] + width + height + 1;
 	}
 }
 #endif
@@ -2726,12 +2878,9 @@ Void TComPrediction::spatialQuantization(const Pel* pSrc, Pel* pOrg, UInt height
 	  |   |   |   |
 	*/
 	Bool print = false;
-	FILE *SpatQnt = fopen("SpatialQnt.txt", "a");
-	if (SpatQnt)
-	{
-		// nothing to celebrate
-	}
-	else
+	// the trace file is only opened when it is written, not once per training block
+	FILE *SpatQnt = print ? fopen("SpatialQnt.txt", "a") : NULL;
+	if (print && !SpatQnt)
 	{
 		cout << "Could not open file SpatialQnt.txt" << endl;
 		assert(0);
@@ -2769,6 +2918,7 @@ Void TComPrediction::spatialQuantization(const Pel* pSrc, Pel* pOrg, UInt height
 	{
 		Int stride = width + 1, offset = stride + 1, offsetPP = 0, row = 0, col = 0, offsetOrg = 0;
 		qStep = 1 << q;
+		const TComSpatialQuant spQuant(qStep);
 		while (row < height) // loop over lines
 		{
 			for (col = 0; col < width; col++) // loop over columns
@@ -2781,7 +2931,7 @@ Void TComPrediction::spatialQuantization(const Pel* pSrc, Pel* pOrg, UInt height
 
 				// spatial domain quantization
 				qR = pOrg[row*width + col] - X;
-				qR = (Pel)(round((double)qR / (double)qStep)) * qStep;
+				qR = (Pel)(spQuant.roundSigned(qR)) * qStep;
 				res[offsetPP + col] = qR;
 			}
 			row++;
@@ -2834,7 +2984,8 @@ Void TComPrediction::spatialQuantization(const Pel* pSrc, Pel* pOrg, UInt height
 			fprintf(SpatQnt, "\t\tqStep:%d\n\n", (1 << q));
 		}
 	}
-	fclose(SpatQnt);
+	if (SpatQnt)
+		fclose(SpatQnt);
 	_aligned_free(res);
 	_aligned_free(predBuffer);	
 	_aligned_free(allQ);
@@ -5101,21 +5252,22 @@ Void TComPrediction::xWeightedAverage(TComYuv* pcYuvSrc0, TComYuv* pcYuvSrc1, In
 #if VCEG_AZ05_BIO 
 		if (bBIOapplied)
 		{
-			static Int64 m_piDotProduct1[BIO_TEMP_BUFFER_SIZE];
-			static Int64 m_piDotProduct2[BIO_TEMP_BUFFER_SIZE];
-			static Int64 m_piDotProduct3[BIO_TEMP_BUFFER_SIZE];
-			static Int64 m_piDotProduct5[BIO_TEMP_BUFFER_SIZE];
-			static Int64 m_piDotProduct6[BIO_TEMP_BUFFER_SIZE];
-			static Int64 m_piS1temp[BIO_TEMP_BUFFER_SIZE];
-			static Int64 m_piS2temp[BIO_TEMP_BUFFER_SIZE];
-			static Int64 m_piS3temp[BIO_TEMP_BUFFER_SIZE];
-			static Int64 m_piS5temp[BIO_TEMP_BUFFER_SIZE];
-			static Int64 m_piS6temp[BIO_TEMP_BUFFER_SIZE];
-			static Int64 m_piS1[BIO_TEMP_BUFFER_SIZE];
-			static Int64 m_piS2[BIO_TEMP_BUFFER_SIZE];
-			static Int64 m_piS3[BIO_TEMP_BUFFER_SIZE];
-			static Int64 m_piS5[BIO_TEMP_BUFFER_SIZE];
-			static Int64 m_piS6[BIO_TEMP_BUFFER_SIZE];
+			// gradient products and their window sums, owned by this predictor (not static) so that CTU rows can be predicted concurrently
+			Int64* m_piDotProduct1 = m_piBIOSums + 0 * BIO_TEMP_BUFFER_SIZE;
+			Int64* m_piDotProduct2 = m_piBIOSums + 1 * BIO_TEMP_BUFFER_SIZE;
+			Int64* m_piDotProduct3 = m_piBIOSums + 2 * BIO_TEMP_BUFFER_SIZE;
+			Int64* m_piDotProduct5 = m_piBIOSums + 3 * BIO_TEMP_BUFFER_SIZE;
+			Int64* m_piDotProduct6 = m_piBIOSums + 4 * BIO_TEMP_BUFFER_SIZE;
+			Int64* m_piS1temp = m_piBIOSums + 5 * BIO_TEMP_BUFFER_SIZE;
+			Int64* m_piS2temp = m_piBIOSums + 6 * BIO_TEMP_BUFFER_SIZE;
+			Int64* m_piS3temp = m_piBIOSums + 7 * BIO_TEMP_BUFFER_SIZE;
+			Int64* m_piS5temp = m_piBIOSums + 8 * BIO_TEMP_BUFFER_SIZE;
+			Int64* m_piS6temp = m_piBIOSums + 9 * BIO_TEMP_BUFFER_SIZE;
+			Int64* m_piS1 = m_piBIOSums + 10 * BIO_TEMP_BUFFER_SIZE;
+			Int64* m_piS2 = m_piBIOSums + 11 * BIO_TEMP_BUFFER_SIZE;
+			Int64* m_piS3 = m_piBIOSums + 12 * BIO_TEMP_BUFFER_SIZE;
+			Int64* m_piS5 = m_piBIOSums + 13 * BIO_TEMP_BUFFER_SIZE;
+			Int64* m_piS6 = m_piBIOSums + 14 * BIO_TEMP_BUFFER_SIZE;
 			Int x = 0, y = 0;
 
 			Int iHeightG = iHeight + 4;
@@ -9541,81 +9693,4 @@ void TComPrediction::xReferenceFilter(Int iBlkSize, Int iOrigWeight, Int iFilter
 
 #endif
 
-#if VCEG_AZ08_INTER_KLT
-Void TComPrediction::interpolatePic(TComPic* pcPic)
-{
-	//only perform over luma
-	TComPicYuv *refPic = pcPic->getPicYuvRec();
-
-	Pel *srcPtr;
-	Pel *dstPtr;
-	const ChromaFormat chFmt = pcPic->getChromaFormat();
-	Int bitDepth = pcPic->getSlice(0)->getSPS()->getBitDepth(CHANNEL_TYPE_LUMA);
-
-	TComPicYuv *refPicArray[4][4];
-	pcPic->m_apcQuaPicYuv[0][0] = pcPic->getPicYuvRec();
-	for (UInt uiRow = 0; uiRow < 4; uiRow++)
-	{
-		for (UInt uiCol = 0; uiCol < 4; uiCol++)
-		{
-			refPicArray[uiRow][uiCol] = pcPic->m_apcQuaPicYuv[uiRow][uiCol];
-			refPicArray[uiRow][uiCol]->setBorderExtension(false);
-		}
-	}
-
-	refPic->setBorderExtension(false);
-	refPic->extendPicBorder();
-	Int componentnum = 1;
-	for (UInt comp = COMPONENT_Y; comp < componentnum; comp++)
-	{
-		const ComponentID compID = ComponentID(comp);
-		UInt uiDstStride = refPicArray[0][0]->getStride(compID);
-		UInt uiRefStride = pcPic->getStride(compID);
-		UInt uiWidth = refPic->getWidth(compID);
-		UInt uiHeight = refPic->getHeight(compID);
-		srcPtr = refPic->getAddr(compID);
-
-		//--------------
-		//Interpolation over luma
-		//yFrac = 0 : (0,1)(0,2)(0,3)
-		for (Int xFrac = 1; xFrac <= 3; xFrac++)
-		{
-			dstPtr = refPicArray[0][xFrac]->getAddr(compID);
-			m_if.filterHor(compID, srcPtr, uiRefStride, dstPtr, uiDstStride, uiWidth, uiHeight, xFrac << VCEG_AZ07_MV_ADD_PRECISION_BIT_FOR_STORE, true, chFmt, bitDepth);
-		}
-
-		//xFrac = 0: (1,0)(2,0)(3,0)
-		for (Int yFrac = 1; yFrac <= 3; yFrac++)
-		{
-			dstPtr = refPicArray[yFrac][0]->getAddr(compID);
-			m_if.filterVer(compID, srcPtr, uiRefStride, dstPtr, uiDstStride, uiWidth, uiHeight, yFrac << VCEG_AZ07_MV_ADD_PRECISION_BIT_FOR_STORE, true, true, chFmt, bitDepth);
-		}
-
-		//other positions
-		//(1,1)(2,1)(3,1)
-		//(2,1)(2,2)(2,3)
-		//(3,1)(3,2)(3,3)
-		Pel* tmpPtr = m_tempPicYuv->getAddr(compID);
-		Int tmpStride = m_tempPicYuv->getStride(compID);
-		Int vFilterSize = isLuma(compID) ? NTAPS_LUMA : NTAPS_CHROMA;
-		for (Int xFrac = 1; xFrac <= 3; xFrac++)
-		{
-			for (Int yFrac = 1; yFrac <= 3; yFrac++)
-			{
-				dstPtr = refPicArray[yFrac][xFrac]->getAddr(compID);
-				m_if.filterHor(compID, srcPtr - ((vFilterSize >> 1) - 1)*uiRefStride, uiRefStride, tmpPtr, tmpStride, uiWidth, uiHeight + vFilterSize - 1, xFrac << VCEG_AZ07_MV_ADD_PRECISION_BIT_FOR_STORE, false, chFmt, bitDepth);
-				m_if.filterVer(compID, tmpPtr + ((vFilterSize >> 1) - 1)*tmpStride, tmpStride, dstPtr, uiDstStride, uiWidth, uiHeight, yFrac << VCEG_AZ07_MV_ADD_PRECISION_BIT_FOR_STORE, false, true, chFmt, bitDepth);
-			}
-		}
-	}
-
-	for (Int yFrac = 0; yFrac <= 3; yFrac++)
-	{
-		for (Int xFrac = 0; xFrac <= 3; xFrac++)
-		{
-			refPicArray[yFrac][xFrac]->extendPicBorder();
-		}
-	}
-}
-#endif
 //! \}
@@ -53,10 +53,22 @@
 #if VCEG_AZ08_INTER_KLT
 #include "TComPic.h"
 #endif
+#if PIP
+#include "TComSpatialQuant.h"
+#include "TComScratchArena.h"
+#include "TComPIPDPCM.h"
+#include "TComPIPContext.h"
+#if PIP_PARALLEL_PRED
+#include "TComThreadPool.h"
+#endif
+#endif
 
 // forward declaration
 class TComMv;
 class TComTU; 
+#if SRDOQ_INCREMENTAL
+struct PIPRateTable;
+#endif
 #if VCEG_AZ07_FRUC_MERGE || JVET_C0024_QTBT
 class TComMvField;
 #endif
@@ -104,6 +116,7 @@ protected:
   Pel*   m_pGradY1;
   Pel*   m_pPred0 ;
   Pel*   m_pPred1 ;
+  Int64* m_piBIOSums;                   ///< BIO_NUM_SUMS planes of gradient products and their window sums
   Int    iRefListIdx;
 #endif
 
@@ -144,12 +157,16 @@ protected:
   static const Int m_ICShiftDiff = 12;
 #endif
 
-#if VCEG_AZ08_INTER_KLT
-  TComPicYuv* m_tempPicYuv;  
-#endif
-
 #if PIP // ======================================= PIP Section ===============================================
   short **MINRESraw, **REF, **ORG;
+  TComScratchArena m_cPIPArena; ///< scratch buffers of the PIP prediction, search and reconstruction
+  TComPIPContext*  m_pcPIPContext; ///< PIP state of the owning encoder or decoder
+  TComPIPStats*    m_pcPIPStats;   ///< PIP counters of the thread running this object
+  TComPIPCoderState* m_pcPIPCoderState; ///< flags shared with the entropy coders of the same thread, NULL in the decoder
+  TEncSearch*      m_pcPredSearchPIP; ///< this object as the encoder search, NULL in the decoder
+#if PIP_PARALLEL_PRED
+  TComThreadPool   m_cPIPPool;  ///< workers of the PIP predictor search (encoder)
+#endif
   Void xPredIntraAngPIP(Int bitDepth, const Pel* pSrc, Int srcStride, Pel* pDst, Int dstStride, UInt width, UInt height, 
 #if JVET_D0033_ADAPTIVE_CLIPPING
 	  ComponentID compID,
@@ -196,6 +213,22 @@ protected:
 #endif
 	  );
 
+  Void xPIPQuantizeDPCM(int predictor, int* qMap, int startIdx, int endIdx
+	  , int width, int height, Pel *predBuffer, int *res, Pel *prediction, int* spQR1, Pel* piOrg, Int dstStrideTrue, Int qStep, float* qMapCmp
+#if NOISE_MARK
+	  , Int* qNoiseMark
+#endif
+	  );
+
+#if SRDOQ_INCREMENTAL
+  Double xPIPGetRDCostIncremental(TComTU& rTu, int width, int height, Pel *prediction, int *res, int* spQR1, Pel* piOrg, Int dstStrideTrue, Int bitDepth
+	  , UInt64 fracBitsBase, const PIPRateTable* rateTable, Int predictor, UInt& Bits, unsigned int& ruiDist);
+#if PIP_RATE_EST_CHECK
+  Void xPIPCheckRateEstimate(TComTU& rTu, int width, int height, Pel *predBuffer, int predictor, int* qMap, Pel* piOrg, Int dstStrideTrue, Int bitDepth, Int qStep
+	  , UInt estBits, Bool isFastRate, Int& rFirstDiff);
+#endif
+#endif
+
 #if R1_CODECOEFFNXN_TEST
   void performILRBlock_r1CodecoeffNxN(int scan, int predictor, int* qMap, int spQch
 	  // the remaining inputs
@@ -421,19 +454,18 @@ public:
 #endif
 #if COM16_C806_LMCHROMA
   Void    initTempBuff(ChromaFormat chromaFormatIDC, Int bitDepthY
-#if VCEG_AZ08_INTER_KLT
-    , bool interKLT , const Int iPicWidth, const Int iPicHeight, const UInt uiMaxCUWidth, const UInt uiMaxCUHeight, const UInt uiMaxCUDepth
-#endif
     );
 #else
   Void    initTempBuff(ChromaFormat chromaFormatIDC
-#if VCEG_AZ08_INTER_KLT
-    , bool interKLT , const Int iPicWidth, const Int iPicHeight, const UInt uiMaxCUWidth, const UInt uiMaxCUHeight, const UInt uiMaxCUDepth
-#endif
     );
 #endif
 
   ChromaFormat getChromaFormat() const { return m_cYuvPredTemp.getChromaFormat(); }
+#if PIP
+  Void    setPIPContext( TComPIPContext* pcPIPContext, Int threadId = 0 ) { m_pcPIPContext = pcPIPContext; m_pcPIPStats = pcPIPContext->getThreadStats( threadId ); }
+  TComPIPContext* getPIPContext() { return m_pcPIPContext; }
+  Void    setPIPCoderState( TComPIPCoderState* pcPIPCoderState ) { m_pcPIPCoderState = pcPIPCoderState; }
+#endif
 
   // inter
   Void motionCompensation         ( TComDataCU*  pcCU, TComYuv* pcYuvPred
@@ -510,6 +542,9 @@ public:
   {
     return m_piYuvExt[compID][bUseFilteredPredictions?PRED_BUF_FILTERED:PRED_BUF_UNFILTERED];
   }
+#if PIP
+  TComScratchArena& getPIPArena   ()                    { return m_cPIPArena; }
+#endif
 
   // This function is actually still in TComPattern.cpp
   /// set parameters from CU data for accessing intra data
@@ -528,9 +563,6 @@ public:
                                             );
 
   static Bool UseDPCMForFirstPassIntraEstimation(TComTU &rTu, const UInt uiDirMode);
-#if VCEG_AZ08_INTER_KLT
-  Void interpolatePic(TComPic* pcPic);
-#endif
 };
 
 //! \}
@@ -44,6 +44,7 @@
 #endif
 #include <iomanip>
 #include <assert.h>
+#include <mutex>
 #include "TComDataCU.h"
 #include "Debug.h"
 // ====================================================================================================================
@@ -52,20 +53,16 @@
 
 //! \ingroup TLibCommon
 //! \{
-#if JVET_C0024_AMAX_BT
-UInt g_uiBlkSize[ 10 ];
-UInt g_uiNumBlk[ 10 ];
-#if JVET_C0024_AMAX_BT_FIX
-UInt g_uiPrevISlicePOC = 0;
-Bool g_bInitAMaxBT = false;
-#endif
-#endif
+
+// the tables are shared by all the encoders and decoders of the process: built by the first user, freed by the last
+static std::mutex s_cROMMutex;
+static Int        s_iROMUsers = 0;
 
 #if VCEG_AZ08_KLT_COMMON
-short **g_ppsEigenVector[USE_MORE_BLOCKSIZE_DEPTH_MAX];
+thread_local short **g_ppsEigenVector[USE_MORE_BLOCKSIZE_DEPTH_MAX];
 #define MAX_KLTAREA (1<<(((USE_MORE_BLOCKSIZE_DEPTH_MAX)<<1) + 2))
 #if VCEG_AZ08_INTER_KLT
-Bool g_bEnableCheck = true;
+thread_local Bool g_bEnableCheck = true;
 #endif
 Void reOrderCoeff(TCoeff *pcCoef, const UInt *scan, UInt uiWidth, UInt uiHeight)
 {
@@ -275,6 +272,12 @@ Int g_aiLMCodeWord[LM_SYMBOL_NUM][16];
 // initialize ROM variables
 Void initROM()
 {
+  std::lock_guard<std::mutex> lock( s_cROMMutex );
+  if( s_iROMUsers++ > 0 )
+  {
+    return;
+  }
+
   Int i, c;
 
   // g_aucConvertToBit[ x ]: log2(x/4), if x=4 -> 0, x=8 -> 1, x=16 -> 2, ...
@@ -517,6 +520,12 @@ Void initROM()
 
 Void destroyROM()
 {
+  std::lock_guard<std::mutex> lock( s_cROMMutex );
+  if( s_iROMUsers == 0 || --s_iROMUsers > 0 )
+  {
+    return;
+  }
+
   for(UInt groupTypeIndex = 0; groupTypeIndex < SCAN_NUMBER_OF_GROUP_TYPES; groupTypeIndex++)
   {
     for (UInt scanOrderIndex = 0; scanOrderIndex < SCAN_NUMBER_OF_TYPES; scanOrderIndex++)
@@ -598,6 +607,25 @@ Void initRasterToZscan ( UInt uiMaxCUWidth, UInt uiMaxCUHeight, UInt uiMaxDepth
   }
 }
 
+Void initPartitionOrder ( UInt uiMaxCUWidth, UInt uiMaxCUHeight, UInt uiMaxDepth )
+{
+  static UInt s_auiGeometry[3] = { 0, 0, 0 };
+  std::lock_guard<std::mutex> lock( s_cROMMutex );
+  if( s_auiGeometry[0] == uiMaxCUWidth && s_auiGeometry[1] == uiMaxCUHeight && s_auiGeometry[2] == uiMaxDepth )
+  {
+    return;
+  }
+
+  UInt* piTmp = &g_auiZscanToRaster[0];
+  initZscanToRaster( uiMaxDepth, 1, 0, piTmp );
+  initRasterToZscan( uiMaxCUWidth, uiMaxCUHeight, uiMaxDepth );
+  initRasterToPelXY( uiMaxCUWidth, uiMaxCUHeight, uiMaxDepth );
+
+  s_auiGeometry[0] = uiMaxCUWidth;
+  s_auiGeometry[1] = uiMaxCUHeight;
+  s_auiGeometry[2] = uiMaxDepth;
+}
+
 Void initRasterToPelXY ( UInt uiMaxCUWidth, UInt uiMaxCUHeight, UInt uiMaxDepth )
 {
   UInt    i;
@@ -3433,7 +3461,7 @@ const UInt g_scalingListSizeX  [SCALING_LIST_SIZE_NUM] = { 4, 8, 16,  32
 #endif
 
 #if JVET_D0033_ADAPTIVE_CLIPPING
-ClipParam g_ClipParam;
+thread_local ClipParam g_ClipParam;
 Int ClipParam::nbBitsY;
 Int ClipParam::nbBitsUV;
 Int ClipParam::ibdLuma;
@@ -43,14 +43,14 @@
 #include<stdio.h>
 #include<iostream>
 #if VCEG_AZ08_KLT_COMMON
-extern short **g_ppsEigenVector[USE_MORE_BLOCKSIZE_DEPTH_MAX];
+extern thread_local short **g_ppsEigenVector[USE_MORE_BLOCKSIZE_DEPTH_MAX];
 #endif
 //! \ingroup TLibCommon
 //! \{
 
 #if VCEG_AZ08_KLT_COMMON
 #if VCEG_AZ08_INTER_KLT
-extern Bool g_bEnableCheck;
+extern thread_local Bool g_bEnableCheck;
 #endif
 Void         reOrderCoeff(TCoeff *pcCoef, const UInt *scan, UInt uiWidth, UInt uiHeight);
 Void         recoverOrderCoeff(TCoeff *pcCoef, const UInt *scan, UInt uiWidth, UInt uiHeight);
@@ -69,14 +69,6 @@ Void         destroyROM();
 // ====================================================================================================================
 // Data structure related table & variable
 // ====================================================================================================================
-#if JVET_C0024_AMAX_BT
-extern UInt g_uiBlkSize[ 10 ];
-extern UInt g_uiNumBlk[ 10 ];
-#if JVET_C0024_AMAX_BT_FIX
-extern UInt g_uiPrevISlicePOC;
-extern Bool g_bInitAMaxBT;
-#endif
-#endif
 
 // flexible conversion from relative to absolute index
 extern       UInt   g_auiZscanToRaster[ MAX_NUM_PART_IDXS_IN_CTU_WIDTH*MAX_NUM_PART_IDXS_IN_CTU_WIDTH ];
@@ -96,6 +88,9 @@ extern       UInt   g_auiRasterToPelY[ MAX_NUM_PART_IDXS_IN_CTU_WIDTH*MAX_NUM_PA
 
 Void         initRasterToPelXY ( UInt uiMaxCUWidth, UInt uiMaxCUHeight, UInt uiMaxDepth );
 
+/// the three tables above for a CTU geometry; they are left as they are if already built for it (by another coder)
+Void         initPartitionOrder( UInt uiMaxCUWidth, UInt uiMaxCUHeight, UInt uiMaxDepth );
+
 #if !JVET_C0024_QTBT
 extern const UInt g_auiPUOffset[NUMBER_OF_PART_SIZES];
 #endif
@@ -0,0 +1,177 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2015, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TComScratchArena.h
+    \brief    bump allocator for the per-block scratch buffers of the PIP
+*/
+
+#ifndef __TCOMSCRATCHARENA__
+#define __TCOMSCRATCHARENA__
+
+#include "CommonDef.h"
+#include <vector>
+
+//! \ingroup TLibCommon
+//! \{
+
+/** Bump allocator for the scratch buffers of the PIP prediction and reconstruction.
+ *  A function opens a TComScratchScope, allocates what it needs and everything is released when
+ *  the scope ends, so the nested calls (block search, candidate evaluation) share one buffer that
+ *  is allocated once per TComPrediction. A request that does not fit is served from the heap and
+ *  counted; the buffer then grows to the peak use the next time the arena is empty.
+ */
+class TComScratchArena
+{
+public:
+  TComScratchArena()
+  : m_base( NULL )
+  , m_size( 0 )
+  , m_top( 0 )
+  , m_peak( 0 )
+  , m_numHeapAllocs( 0 )
+  {
+  }
+
+  ~TComScratchArena()                               { destroy(); }
+
+  Void   create       ( size_t size )
+  {
+    if( m_base )
+    {
+      xFree( m_base );
+    }
+    m_size = xAlign( size );
+    m_base = (UChar*)xMalloc( UChar, m_size );
+    m_numHeapAllocs++;
+  }
+
+  Void   destroy      ()
+  {
+    for( size_t i = 0; i < m_overflow.size(); i++ )
+    {
+      xFree( m_overflow[i].ptr );
+    }
+    m_overflow.clear();
+    if( m_base )
+    {
+      xFree( m_base );
+      m_base = NULL;
+    }
+    m_size = 0;
+    m_top  = 0;
+  }
+
+  size_t getMark      ()                      const { return m_top; }
+
+  /// buffer of count elements, 32-byte aligned
+  template<typename T>
+  T*     alloc        ( size_t count )
+  {
+    const size_t bytes = xAlign( count * sizeof( T ) );
+    T* ptr;
+    if( m_top + bytes <= m_size )
+    {
+      ptr = (T*)( m_base + m_top );
+    }
+    else
+    {
+      // past the end: heap block, freed when the arena is released below its offset
+      ptr = (T*)xMalloc( UChar, bytes );
+      m_overflow.push_back( OverflowBlock( m_top, ptr ) );
+      m_numHeapAllocs++;
+    }
+    m_top += bytes;
+    m_peak = std::max( m_peak, m_top );
+    return ptr;
+  }
+
+  /// free everything allocated after mark
+  Void   release      ( size_t mark )
+  {
+    while( !m_overflow.empty() && m_overflow.back().offset >= mark )
+    {
+      xFree( m_overflow.back().ptr );
+      m_overflow.pop_back();
+    }
+    m_top = mark;
+    if( m_top == 0 && m_base && m_peak > m_size )
+    {
+      create( m_peak );
+    }
+  }
+
+  size_t getSize      ()                      const { return m_size; }
+  size_t getPeak      ()                      const { return m_peak; }
+  Int    getNumHeapAllocs()                   const { return m_numHeapAllocs; }
+
+private:
+  struct OverflowBlock
+  {
+    OverflowBlock( size_t o, Void* p ) : offset( o ), ptr( p ) {}
+    size_t offset;
+    Void*  ptr;
+  };
+
+  static size_t xAlign( size_t bytes )              { return ( bytes + 31 ) & ~size_t( 31 ); }
+
+  UChar*                     m_base;
+  size_t                     m_size;
+  size_t                     m_top;
+  size_t                     m_peak;
+  Int                        m_numHeapAllocs;       ///< buffer (re)allocations and overflow blocks
+  std::vector<OverflowBlock> m_overflow;
+};
+
+/// releases the allocations made in the arena during its lifetime, early returns included
+class TComScratchScope
+{
+public:
+  TComScratchScope( TComScratchArena& rArena )
+  : m_rArena( rArena )
+  , m_mark( rArena.getMark() )
+  {
+  }
+
+  ~TComScratchScope()                               { m_rArena.release( m_mark ); }
+
+private:
+  TComScratchScope( const TComScratchScope& );
+  TComScratchScope& operator=( const TComScratchScope& );
+
+  TComScratchArena& m_rArena;
+  size_t            m_mark;
+};
+
+//! \}
+
+#endif // __TCOMSCRATCHARENA__
@@ -45,9 +45,28 @@
 //! \ingroup TLibCommon
 //! \{
 
+#if JVET_C0024_QTBT
+thread_local const TComSlice* TComSlice::s_pcThreadTypeSlice = NULL;
+thread_local ChannelType      TComSlice::s_eThreadType       = CHANNEL_TYPE_LUMA;
+#endif
 #if VCEG_AZ07_FRUC_MERGE
-Bool TComSlice::m_bScaleFactorValid = false;
 Int TComSlice::m_iScaleFactor[256][256];
+
+Bool TComSlice::xInitScaleFactor()
+{
+  for( Int iTDB = -128 ; iTDB <= 127 ; iTDB++ )
+  {
+    for( Int iTDD = -128 ; iTDD <= 127 ; iTDD++ )
+    {
+      if( iTDD == 0 )
+        continue;
+      Int iX        = (0x4000 + abs(iTDD/2)) / iTDD;
+      Int iScale    = Clip3( -4096, 4095, (iTDB * iX + 32) >> 6 );
+      TComSlice::m_iScaleFactor[128+iTDB][128+iTDD] = iScale;
+    }
+  }
+  return true;
+}
 #endif
 
 TComSlice::TComSlice()
@@ -162,21 +181,9 @@ TComSlice::TComSlice()
 #endif
 #if VCEG_AZ07_FRUC_MERGE
   m_bFrucRefIdxPairValid = false;
-  if( TComSlice::m_bScaleFactorValid == false )
-  {
-    for( Int iTDB = -128 ; iTDB <= 127 ; iTDB++ )
-    {
-      for( Int iTDD = -128 ; iTDD <= 127 ; iTDD++ )
-      {
-        if( iTDD == 0 )
-          continue;
-        Int iX        = (0x4000 + abs(iTDD/2)) / iTDD;
-        Int iScale    = Clip3( -4096, 4095, (iTDB * iX + 32) >> 6 );
-        TComSlice::m_iScaleFactor[128+iTDB][128+iTDD] = iScale;
-      }
-    }
-    TComSlice::m_bScaleFactorValid = true;
-  }
+  // built once by the first slice of the process, also when the slices of several coders are constructed concurrently
+  static const Bool bScaleFactorValid = xInitScaleFactor();
+  (Void)bScaleFactorValid;
 #endif
 }
 
@@ -1643,6 +1650,12 @@ TComSPS::TComSPS()
 #if COM16_C983_RSAF
 , m_useRSAF                   (false)
 #endif
+#if PIP_R1_HT_BINARIZATION
+, m_PIPR1HighThroughputFlag   (false)
+#endif
+#if VCEG_AZ08_KLT_COMMON && KLT_DETERMINISTIC_BASIS
+, m_KLTDeterministicBasisFlag (false)
+#endif
 , m_bPCMFilterDisableFlag     (false)
 , m_uiBitsForPOC              (  8)
 , m_numLongTermRefPicSPS      (  0)
@@ -2432,7 +2445,6 @@ Void TComSlice::initStatsGlobal()
     Int iQP = -1,  k;
 #if VCEG_AZ07_INIT_PREVFRAME_FIX
     Bool bIRAP = getRapPicFlag();
-    static Bool bClearPrevFlag = false;
 #endif
     Int uiSliceType = getSliceType();
     Int uiSliceQP   = getSliceQp  ();
@@ -2461,9 +2473,9 @@ Void TComSlice::initStatsGlobal()
     }
     setCtxMapQPIdxforStore(iQP);
 #if VCEG_AZ07_INIT_PREVFRAME_FIX
-    if(bClearPrevFlag== false && getPOC() > pcStats->m_uiLastIPOC)
+    if(pcStats->m_bClearPrevFlag== false && getPOC() > pcStats->m_uiLastIPOC)
     {
-      bClearPrevFlag = true;
+      pcStats->m_bClearPrevFlag = true;
      // pcStats-> aaQPUsed[uiSliceType][k].resetInit ++;
       for(UInt uitype= 0; uitype < 2; uitype++)
       {
@@ -2476,7 +2488,7 @@ Void TComSlice::initStatsGlobal()
     if( bIRAP )
     {
       pcStats->m_uiLastIPOC = this->getPOC();
-      bClearPrevFlag = false;
+      pcStats->m_bClearPrevFlag = false;
     }
 #else
     if( uiSliceType == I_SLICE )
@@ -892,6 +892,12 @@ private:
 #endif
 #if COM16_C983_RSAF
   Bool             m_useRSAF;
+#endif
+#if PIP_R1_HT_BINARIZATION
+  Bool             m_PIPR1HighThroughputFlag;
+#endif
+#if VCEG_AZ08_KLT_COMMON && KLT_DETERMINISTIC_BASIS
+  Bool             m_KLTDeterministicBasisFlag;
 #endif
  // Parameter
   BitDepths        m_bitDepths;
@@ -1179,6 +1185,14 @@ public:
  Bool                   getUseRSAF ()  const                                                       { return m_useRSAF; }
  Void                   setUseRSAF ( Bool b )                                                      { m_useRSAF = b;    }
 #endif
+#if PIP_R1_HT_BINARIZATION
+ Bool                   getPIPR1HighThroughputFlag ()  const                                       { return m_PIPR1HighThroughputFlag; }
+ Void                   setPIPR1HighThroughputFlag ( Bool b )                                      { m_PIPR1HighThroughputFlag = b;    }
+#endif
+#if VCEG_AZ08_KLT_COMMON && KLT_DETERMINISTIC_BASIS
+ Bool                   getKLTDeterministicBasisFlag ()  const                                     { return m_KLTDeterministicBasisFlag; }
+ Void                   setKLTDeterministicBasisFlag ( Bool b )                                    { m_KLTDeterministicBasisFlag = b;    }
+#endif
 
   // KTA tools
 
@@ -1564,7 +1578,7 @@ private:
   Int                        m_iFrucRefIdxPair[2][MAX_NUM_REF+1];
   Bool                       m_bFrucRefIdxPairValid;
   static Int                 m_iScaleFactor[256][256];
-  static Bool                m_bScaleFactorValid;
+  static Bool                xInitScaleFactor();
 #endif
 
 #if JVET_E0023_FAST_ENCODING_SETTING
@@ -1645,6 +1659,8 @@ private:
 #endif
 #if JVET_C0024_QTBT
   ChannelType                m_eType;             ///< The channelType current CTB is coding
+  static thread_local const TComSlice* s_pcThreadTypeSlice; ///< slice whose channelType is kept by the calling thread
+  static thread_local ChannelType      s_eThreadType;
 #endif
 
 public:
@@ -1911,8 +1927,10 @@ public:
 #endif
 
 #if JVET_C0024_QTBT
-  ChannelType   getTextType() const {return m_eType;}
-  Void          setTextType(ChannelType eCType) { m_eType = eCType;}
+  ChannelType   getTextType() const {return this == s_pcThreadTypeSlice ? s_eThreadType : m_eType;}
+  Void          setTextType(ChannelType eCType) { if (this == s_pcThreadTypeSlice) { s_eThreadType = eCType; } else { m_eType = eCType; } }
+  /// the calling thread keeps its own channelType for pcSlice (NULL: back to the slice's one), for CTU rows coded concurrently
+  static Void   setThreadTextType(const TComSlice* pcSlice, ChannelType eCType) { s_pcThreadTypeSlice = pcSlice; s_eThreadType = eCType; }
 #endif
 protected:
   TComPic*                    xGetRefPic        (TComList<TComPic*>& rcListPic, Int poc);
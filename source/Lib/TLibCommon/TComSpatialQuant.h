@@ -0,0 +1,106 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2015, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TComSpatialQuant.h
+    \brief    fixed-point spatial quantizer of the PIP residual
+*/
+
+#ifndef __TCOMSPATIALQUANT__
+#define __TCOMSPATIALQUANT__
+
+#include "CommonDef.h"
+
+//! \ingroup TLibCommon
+//! \{
+
+/// quantizer decisions of the spatial RDOQ (values of qMap)
+enum SpatialQuantMode
+{
+  SPQ_ROUND    = -1,
+  SPQ_TOP      = 0,
+  SPQ_BOTTOM   = 1,
+  SPQ_BOTTOM_1 = 2
+};
+
+/** Quantizer of the PIP residual with one spatial step: the division by the step is a multiply by
+ *  scale = ceil(2^32 / qStep) and a shift. (a * scale) >> 32 is floor(a / qStep) as long as
+ *  a * (scale * qStep - 2^32) < 2^32, which holds for a and qStep below 2^16, so all the levels
+ *  match the former double round/ceil/floor exactly.
+ */
+class TComSpatialQuant
+{
+public:
+  TComSpatialQuant( Int qStep )
+  : m_qStep( qStep )
+  , m_scale( ( ( UInt64( 1 ) << SCALE_SHIFT ) + qStep - 1 ) / qStep )
+  {
+  }
+
+  Int  getQStep     ()                   const { return m_qStep; }
+  /// ceil(2^32 / qStep), for the vector quantizers
+  UInt64 getScale   ()                   const { return m_scale; }
+
+  /// floor(absRes / qStep)
+  Int  floorLevel   ( Int absRes )       const { return Int( ( UInt64( absRes ) * m_scale ) >> SCALE_SHIFT ); }
+
+  /// round(absRes / qStep), halves rounded up
+  Int  roundLevel   ( Int absRes )       const { const Int f = floorLevel( absRes ); return f + ( 2 * ( absRes - f * m_qStep ) >= m_qStep ); }
+
+  /// ceil(absRes / qStep)
+  Int  ceilLevel    ( Int absRes )       const { const Int f = floorLevel( absRes ); return f + ( absRes != f * m_qStep ); }
+
+  /// level of absRes for one qMap decision of the spatial RDOQ
+  Int  level        ( Int absRes, Int mode ) const
+  {
+    switch( mode )
+    {
+    case SPQ_TOP:      return ceilLevel( absRes );
+    case SPQ_BOTTOM:   return floorLevel( absRes );
+    case SPQ_BOTTOM_1: return std::max( floorLevel( absRes ) - 1, 0 );
+    default:           return roundLevel( absRes );
+    }
+  }
+
+  /// round(res / qStep) for a signed residual, halves rounded away from zero
+  Int  roundSigned  ( Int res )          const { return res < 0 ? -roundLevel( -res ) : roundLevel( res ); }
+
+private:
+  static const Int SCALE_SHIFT = 32;
+
+  Int    m_qStep;
+  UInt64 m_scale;
+};
+
+//! \}
+
+#endif // __TCOMSPATIALQUANT__
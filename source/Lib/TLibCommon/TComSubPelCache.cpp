@@ -0,0 +1,288 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2015, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/** \file     TComSubPelCache.cpp
+    \brief    on-demand luma sub-pel planes of a reference picture for the inter KLT
+*/
+
+#include "TComSubPelCache.h"
+#include "TComPicYuv.h"
+
+//! \ingroup TLibCommon
+//! \{
+
+#if VCEG_AZ08_INTER_KLT
+
+static const Int    SUBPEL_REGION_STRIDE = TComSubPelCache::TILE_STRIDE + 8;   ///< filter widths are rounded up to 8
+static const UInt64 SUBPEL_NO_KEY        = ~UInt64( 0 );                       ///< key of a free tile buffer
+
+TComSubPelCache::TComSubPelCache()
+: m_maxTiles ( 0 )
+, m_useClock ( 0 )
+, m_search   ( 0 )
+, m_pcRecYuv ( NULL )
+, m_chFmt    ( CHROMA_420 )
+, m_bitDepth ( 8 )
+, m_region   ( NULL )
+, m_tmp      ( NULL )
+{
+}
+
+TComSubPelCache::~TComSubPelCache()
+{
+  destroy();
+}
+
+Void TComSubPelCache::create( UInt maxTiles )
+{
+  destroy();
+  m_maxTiles = maxTiles;
+  m_region   = ( Pel* )xMalloc( Pel, SUBPEL_REGION_STRIDE * TILE_STRIDE );
+  m_tmp      = ( Pel* )xMalloc( Pel, SUBPEL_REGION_STRIDE * ( TILE_STRIDE + NTAPS_LUMA - 1 ) );
+}
+
+Void TComSubPelCache::destroy()
+{
+  for( size_t i = 0; i < m_tiles.size(); i++ )
+  {
+    xFree( m_tiles[i].samples );
+  }
+  m_tiles.clear();
+  m_index.clear();
+  if( m_region )
+  {
+    xFree( m_region );
+    m_region = NULL;
+  }
+  if( m_tmp )
+  {
+    xFree( m_tmp );
+    m_tmp = NULL;
+  }
+  m_maxTiles = 0;
+  m_pcRecYuv = NULL;
+}
+
+#if JVET_D0033_ADAPTIVE_CLIPPING
+Void TComSubPelCache::setSource( TComPicYuv* pcRecYuv, ChromaFormat chFmt, Int bitDepth, const ClipParam& rcClipParam )
+#else
+Void TComSubPelCache::setSource( TComPicYuv* pcRecYuv, ChromaFormat chFmt, Int bitDepth )
+#endif
+{
+  m_pcRecYuv = pcRecYuv;
+  m_chFmt    = chFmt;
+  m_bitDepth = bitDepth;
+#if JVET_D0033_ADAPTIVE_CLIPPING
+  m_clipParam = rcClipParam;
+#endif
+
+  // the buffers are kept for the next content, up to the budget
+  m_index.clear();
+  while( m_tiles.size() > m_maxTiles )
+  {
+    xFree( m_tiles.back().samples );
+    m_tiles.pop_back();
+  }
+  for( size_t i = 0; i < m_tiles.size(); i++ )
+  {
+    m_tiles[i].key     = SUBPEL_NO_KEY;
+    m_tiles[i].lastUse = 0;
+    m_tiles[i].search  = SUBPEL_NO_KEY;
+  }
+}
+
+Void TComSubPelCache::setSource( const TComSubPelCache& rcCache )
+{
+#if JVET_D0033_ADAPTIVE_CLIPPING
+  setSource( rcCache.m_pcRecYuv, rcCache.m_chFmt, rcCache.m_bitDepth, rcCache.m_clipParam );
+#else
+  setSource( rcCache.m_pcRecYuv, rcCache.m_chFmt, rcCache.m_bitDepth );
+#endif
+}
+
+Void TComSubPelCache::beginSearch()
+{
+  m_search++;
+  while( m_tiles.size() > m_maxTiles )
+  {
+    size_t lru = 0;
+    for( size_t i = 1; i < m_tiles.size(); i++ )
+    {
+      if( m_tiles[i].lastUse < m_tiles[lru].lastUse )
+      {
+        lru = i;
+      }
+    }
+    xRelease( lru );
+  }
+}
+
+const Pel* TComSubPelCache::getSamples( Int yFrac, Int xFrac, Int x, Int y )
+{
+  assert( m_pcRecYuv && ( yFrac || xFrac ) );
+
+  // floor division, the tiles of the border are at negative indices
+  const Int tileX = ( x >= 0 ? x : x - TILE_SIZE + 1 ) / TILE_SIZE;
+  const Int tileY = ( y >= 0 ? y : y - TILE_SIZE + 1 ) / TILE_SIZE;
+  const UInt64 key = xKey( ( yFrac << 2 ) + xFrac, tileX, tileY );
+
+  UInt idx;
+  std::unordered_map<UInt64, UInt>::const_iterator it = m_index.find( key );
+  if( it != m_index.end() )
+  {
+    idx = it->second;
+  }
+  else
+  {
+    // a free buffer, else the least recently used tile not handed out in this search, else one over the budget
+    idx = UInt( m_tiles.size() );
+    for( UInt i = 0; i < m_tiles.size(); i++ )
+    {
+      if( m_tiles[i].search != m_search && ( idx == m_tiles.size() || m_tiles[i].lastUse < m_tiles[idx].lastUse ) )
+      {
+        idx = i;
+      }
+    }
+    if( idx < m_tiles.size() && m_tiles.size() < m_maxTiles && m_tiles[idx].key != SUBPEL_NO_KEY )
+    {
+      idx = UInt( m_tiles.size() );                           // still room: keep the tile
+    }
+    if( idx == m_tiles.size() )
+    {
+      Tile cTile;
+      cTile.key     = SUBPEL_NO_KEY;
+      cTile.samples = ( Pel* )xMalloc( Pel, TILE_STRIDE * TILE_STRIDE );
+      m_tiles.push_back( cTile );
+    }
+    else if( m_tiles[idx].key != SUBPEL_NO_KEY )
+    {
+      m_index.erase( m_tiles[idx].key );
+    }
+    m_tiles[idx].key = key;
+    xFill( m_tiles[idx], yFrac, xFrac, tileX * TILE_SIZE, tileY * TILE_SIZE );
+    m_index[key] = idx;
+  }
+
+  Tile& rcTile  = m_tiles[idx];
+  rcTile.lastUse = ++m_useClock;
+  rcTile.search  = m_search;
+  return rcTile.samples + ( y - tileY * TILE_SIZE ) * TILE_STRIDE + ( x - tileX * TILE_SIZE );
+}
+
+UInt64 TComSubPelCache::xKey( Int phase, Int tileX, Int tileY )
+{
+  return ( UInt64( phase ) << 48 ) | ( UInt64( UInt( tileY + ( 1 << 20 ) ) ) << 24 ) | UInt64( UInt( tileX + ( 1 << 20 ) ) );
+}
+
+/** Interpolates the samples of the tile inside the picture as the full picture pass did (same filters on the
+ *  integer plane with its extended border), then repeats the edge samples over the part outside the picture.
+ */
+Void TComSubPelCache::xFill( Tile& rcTile, Int yFrac, Int xFrac, Int x0, Int y0 )
+{
+  const Int picWidth  = m_pcRecYuv->getWidth ( COMPONENT_Y );
+  const Int picHeight = m_pcRecYuv->getHeight( COMPONENT_Y );
+  const Int cx0 = Clip3( 0, picWidth  - 1, x0 );
+  const Int cx1 = Clip3( 0, picWidth  - 1, x0 + TILE_STRIDE - 1 ) + 1;
+  const Int cy0 = Clip3( 0, picHeight - 1, y0 );
+  const Int cy1 = Clip3( 0, picHeight - 1, y0 + TILE_STRIDE - 1 ) + 1;
+  const Int width  = ( cx1 - cx0 + 7 ) & ~7;
+  const Int height = cy1 - cy0;
+
+  const Int srcStride = m_pcRecYuv->getStride( COMPONENT_Y );
+  Pel*      src       = m_pcRecYuv->getAddr( COMPONENT_Y ) + cy0 * srcStride + cx0;
+
+#if JVET_D0033_ADAPTIVE_CLIPPING
+  const ClipParam cSavedClipParam = g_ClipParam;
+  g_ClipParam = m_clipParam;
+#endif
+  if( yFrac == 0 )
+  {
+    m_if.filterHor( COMPONENT_Y, src, srcStride, m_region, SUBPEL_REGION_STRIDE, width, height, xFrac << VCEG_AZ07_MV_ADD_PRECISION_BIT_FOR_STORE, true, m_chFmt, m_bitDepth );
+  }
+  else if( xFrac == 0 )
+  {
+    m_if.filterVer( COMPONENT_Y, src, srcStride, m_region, SUBPEL_REGION_STRIDE, width, height, yFrac << VCEG_AZ07_MV_ADD_PRECISION_BIT_FOR_STORE, true, true, m_chFmt, m_bitDepth );
+  }
+  else
+  {
+    const Int halfTaps = ( NTAPS_LUMA >> 1 ) - 1;
+    m_if.filterHor( COMPONENT_Y, src - halfTaps * srcStride, srcStride, m_tmp, SUBPEL_REGION_STRIDE, width, height + NTAPS_LUMA - 1, xFrac << VCEG_AZ07_MV_ADD_PRECISION_BIT_FOR_STORE, false, m_chFmt, m_bitDepth );
+    m_if.filterVer( COMPONENT_Y, m_tmp + halfTaps * SUBPEL_REGION_STRIDE, SUBPEL_REGION_STRIDE, m_region, SUBPEL_REGION_STRIDE, width, height, yFrac << VCEG_AZ07_MV_ADD_PRECISION_BIT_FOR_STORE, false, true, m_chFmt, m_bitDepth );
+  }
+#if JVET_D0033_ADAPTIVE_CLIPPING
+  g_ClipParam = cSavedClipParam;
+#endif
+
+  // columns left of, inside and right of the picture
+  const Int left  = std::min( std::max( cx0 - x0, 0 ), Int( TILE_STRIDE ) );
+  const Int right = std::min( std::max( x0 + TILE_STRIDE - cx1, 0 ), Int( TILE_STRIDE ) - left );
+  const Int inner = TILE_STRIDE - left - right;
+  const Int first = x0 + left - cx0;                          // first inner column in the region
+  for( Int j = 0; j < TILE_STRIDE; j++ )
+  {
+    const Pel* regionRow = m_region + ( Clip3( cy0, cy1 - 1, y0 + j ) - cy0 ) * SUBPEL_REGION_STRIDE;
+    Pel*       tileRow   = rcTile.samples + j * TILE_STRIDE;
+    for( Int i = 0; i < left; i++ )
+    {
+      tileRow[i] = regionRow[0];
+    }
+    memcpy( tileRow + left, regionRow + first, inner * sizeof( Pel ) );
+    for( Int i = left + inner; i < TILE_STRIDE; i++ )
+    {
+      tileRow[i] = regionRow[cx1 - cx0 - 1];
+    }
+  }
+}
+
+Void TComSubPelCache::xRelease( size_t idx )
+{
+  if( m_tiles[idx].key != SUBPEL_NO_KEY )
+  {
+    m_index.erase( m_tiles[idx].key );
+  }
+  xFree( m_tiles[idx].samples );
+  if( idx + 1 < m_tiles.size() )
+  {
+    m_tiles[idx] = m_tiles.back();
+    if( m_tiles[idx].key != SUBPEL_NO_KEY )
+    {
+      m_index[m_tiles[idx].key] = UInt( idx );
+    }
+  }
+  m_tiles.pop_back();
+}
+
+#endif
+
+//! \}
@@ -0,0 +1,130 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2015, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/** \file     TComSubPelCache.h
+    \brief    on-demand luma sub-pel planes of a reference picture for the inter KLT (header)
+*/
+
+#ifndef __TCOMSUBPELCACHE__
+#define __TCOMSUBPELCACHE__
+
+#include "CommonDef.h"
+#include "TComInterpolationFilter.h"
+#include <unordered_map>
+#include <vector>
+
+//! \ingroup TLibCommon
+//! \{
+
+#if VCEG_AZ08_INTER_KLT
+
+class TComPicYuv;
+
+/** The 15 quarter-pel phases of the luma plane of one reconstructed picture, interpolated on first use.
+ *
+ *  A phase plane is split into tiles of TILE_SIZE x TILE_SIZE anchor samples. A tile stores its anchors
+ *  and TILE_MARGIN more samples on the right and below, so every area of up to TILE_MARGIN x TILE_MARGIN
+ *  samples is contiguous in the tile of its top-left sample. Samples outside the picture repeat the
+ *  nearest edge sample, as in a plane with an extended border, so the values match a full picture
+ *  interpolation bit by bit. The tiles are evicted in least recently used order beyond the budget;
+ *  the ones handed out since the last beginSearch() are kept. Not thread safe.
+ */
+class TComSubPelCache
+{
+public:
+  static const Int TILE_SIZE   = 64;
+  static const Int TILE_MARGIN = 40;                          ///< >= 32x32 block + 3 template + 1 neighbour samples
+  static const Int TILE_STRIDE = TILE_SIZE + TILE_MARGIN;
+
+  TComSubPelCache();
+  ~TComSubPelCache();
+
+  Void  create       ( UInt maxTiles );
+  Void  destroy      ();
+  Bool  isCreated    ()                         const { return m_maxTiles > 0; }
+
+  /// new content of the reference picture: drops all the tiles
+#if JVET_D0033_ADAPTIVE_CLIPPING
+  Void  setSource    ( TComPicYuv* pcRecYuv, ChromaFormat chFmt, Int bitDepth, const ClipParam& rcClipParam );
+#else
+  Void  setSource    ( TComPicYuv* pcRecYuv, ChromaFormat chFmt, Int bitDepth );
+#endif
+
+  /// the source of rcCache, for the cache of another coding thread
+  Void  setSource    ( const TComSubPelCache& rcCache );
+
+  /// starts a candidate search: the tiles in use may be evicted again, the budget is restored
+  Void  beginSearch  ();
+
+  /// sample (x, y) of phase (yFrac, xFrac) != (0, 0), followed by TILE_MARGIN x TILE_MARGIN samples of stride TILE_STRIDE
+  const Pel* getSamples( Int yFrac, Int xFrac, Int x, Int y );
+
+  UInt  getNumTiles  ()                         const { return UInt( m_tiles.size() ); }
+
+private:
+  struct Tile
+  {
+    UInt64 key;
+    UInt64 lastUse;
+    UInt64 search;                                            ///< beginSearch() count of the last use
+    Pel*   samples;
+  };
+
+  static UInt64 xKey ( Int phase, Int tileX, Int tileY );
+  Void   xFill       ( Tile& rcTile, Int yFrac, Int xFrac, Int x0, Int y0 );
+  Void   xRelease    ( size_t idx );
+
+  UInt                             m_maxTiles;
+  std::vector<Tile>                m_tiles;
+  std::unordered_map<UInt64, UInt> m_index;                   ///< key -> position in m_tiles
+  UInt64                           m_useClock;
+  UInt64                           m_search;
+
+  TComPicYuv*                      m_pcRecYuv;
+  ChromaFormat                     m_chFmt;
+  Int                              m_bitDepth;
+#if JVET_D0033_ADAPTIVE_CLIPPING
+  ClipParam                        m_clipParam;               ///< clipping of the picture, applied by the interpolation
+#endif
+
+  TComInterpolationFilter          m_if;
+  Pel*                             m_region;                  ///< interpolated samples inside the picture
+  Pel*                             m_tmp;                     ///< horizontal pass of the 2-D phases
+};
+
+#endif
+
+//! \}
+
+#endif // __TCOMSUBPELCACHE__
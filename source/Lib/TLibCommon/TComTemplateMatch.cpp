@@ -0,0 +1,240 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2015, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TComTemplateMatch.cpp
+    \brief    template matching distortion of the KLT candidate search
+*/
+
+#include "TComTemplateMatch.h"
+
+#if VCEG_AZ08_KLT_COMMON
+
+#if COM16_C806_SIMD_OPT
+#include <smmintrin.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#endif
+
+//! \ingroup TLibCommon
+//! \{
+
+static inline DistType xSampleDist( Int a, Int b )
+{
+#if VCEG_AZ08_USE_SSD_DISTANCE
+  return ( a - b ) * ( a - b );
+#else
+  return abs( a - b );
+#endif
+}
+
+TComTemplateMatch::TComTemplateMatch()
+: m_tarPatch    ( NULL )
+, m_patchSize   ( 0 )
+, m_tempSize    ( 0 )
+, m_templateOnly( false )
+, m_accumLen    ( 1 )
+{
+}
+
+Void TComTemplateMatch::setTarget( Pel** tarPatch, UInt uiPatchSize, UInt uiTempSize, Bool bTemplateOnly, Int bitDepth )
+{
+  m_tarPatch     = tarPatch;
+  m_patchSize    = Int( uiPatchSize );
+  m_tempSize     = Int( uiTempSize );
+  m_templateOnly = bTemplateOnly;
+  m_accumLen     = std::max( 1, 0xFFFF / ( ( 1 << bitDepth ) - 1 ) );
+}
+
+DistType TComTemplateMatch::diff( const Pel* ref, Int refStride, DistType maxDiff ) const
+{
+  DistType   sum    = 0;
+  const Pel* refRow = ref - m_tempSize * refStride - m_tempSize;
+  for( Int y = 0; y < m_patchSize; y++, refRow += refStride )
+  {
+    const Pel* tarRow = m_tarPatch[y];
+    const Int  width  = xRowWidth( y );
+    Int        x      = 0;
+#if COM16_C806_SIMD_OPT && VCEG_AZ08_USE_SAD_DISTANCE
+    // the block part of a row is a multiple of 4 wide: the columns before it are summed one by one
+    for( const Int head = width & 3; x < head; x++ )
+    {
+      sum += abs( refRow[x] - tarRow[x] );
+    }
+    const __m128i ones = _mm_set1_epi16( 1 );
+    __m128i       acc  = _mm_setzero_si128();
+    for( ; x + 8 <= width; x += 8 )
+    {
+      const __m128i d = _mm_sub_epi16( _mm_loadu_si128( ( const __m128i* )( refRow + x ) ), _mm_loadu_si128( ( const __m128i* )( tarRow + x ) ) );
+      acc = _mm_add_epi32( acc, _mm_madd_epi16( _mm_abs_epi16( d ), ones ) );
+    }
+    if( x + 4 <= width )
+    {
+      const __m128i d = _mm_sub_epi16( _mm_loadl_epi64( ( const __m128i* )( refRow + x ) ), _mm_loadl_epi64( ( const __m128i* )( tarRow + x ) ) );
+      acc = _mm_add_epi32( acc, _mm_madd_epi16( _mm_abs_epi16( d ), ones ) );
+      x  += 4;
+    }
+    acc  = _mm_add_epi32( acc, _mm_srli_si128( acc, 8 ) );
+    acc  = _mm_add_epi32( acc, _mm_srli_si128( acc, 4 ) );
+    sum += _mm_cvtsi128_si32( acc );
+#endif
+    for( ; x < width; x++ )
+    {
+      sum += xSampleDist( refRow[x], tarRow[x] );
+    }
+    if( sum > maxDiff )
+    {
+      return sum;
+    }
+  }
+  return sum;
+}
+
+#if COM16_C806_SIMD_OPT && VCEG_AZ08_USE_SAD_DISTANCE
+/** 8 consecutive positions, one per 16-bit lane: a load at column x of a reference row gives that column for
+ *  all of them. The 16-bit sums are widened every m_accumLen columns.
+ */
+Void TComTemplateMatch::xRowDiff8( const Pel* ref, Int refStride, DistType maxDiff, DistType* pDiffs ) const
+{
+  const __m128i limit  = _mm_set1_epi32( maxDiff );
+  __m128i       acc0   = _mm_setzero_si128();
+  __m128i       acc1   = _mm_setzero_si128();
+  const Pel*    refRow = ref - m_tempSize * refStride - m_tempSize;
+  for( Int y = 0; y < m_patchSize; y++, refRow += refStride )
+  {
+    const Pel* tarRow = m_tarPatch[y];
+    const Int  width  = xRowWidth( y );
+    for( Int x = 0; x < width; )
+    {
+      const Int end = std::min( width, x + m_accumLen );
+      __m128i   sum = _mm_setzero_si128();
+      for( ; x < end; x++ )
+      {
+        const __m128i d = _mm_sub_epi16( _mm_loadu_si128( ( const __m128i* )( refRow + x ) ), _mm_set1_epi16( tarRow[x] ) );
+        sum = _mm_add_epi16( sum, _mm_abs_epi16( d ) );
+      }
+      acc0 = _mm_add_epi32( acc0, _mm_cvtepu16_epi32( sum ) );
+      acc1 = _mm_add_epi32( acc1, _mm_cvtepu16_epi32( _mm_srli_si128( sum, 8 ) ) );
+    }
+    if( _mm_movemask_epi8( _mm_and_si128( _mm_cmpgt_epi32( acc0, limit ), _mm_cmpgt_epi32( acc1, limit ) ) ) == 0xFFFF )
+    {
+      break;
+    }
+  }
+  _mm_storeu_si128( ( __m128i* )( pDiffs     ), acc0 );
+  _mm_storeu_si128( ( __m128i* )( pDiffs + 4 ), acc1 );
+}
+
+#if defined(__AVX2__)
+Void TComTemplateMatch::xRowDiff16( const Pel* ref, Int refStride, DistType maxDiff, DistType* pDiffs ) const
+{
+  const __m256i limit  = _mm256_set1_epi32( maxDiff );
+  __m256i       acc0   = _mm256_setzero_si256();
+  __m256i       acc1   = _mm256_setzero_si256();
+  const Pel*    refRow = ref - m_tempSize * refStride - m_tempSize;
+  for( Int y = 0; y < m_patchSize; y++, refRow += refStride )
+  {
+    const Pel* tarRow = m_tarPatch[y];
+    const Int  width  = xRowWidth( y );
+    for( Int x = 0; x < width; )
+    {
+      const Int end = std::min( width, x + m_accumLen );
+      __m256i   sum = _mm256_setzero_si256();
+      for( ; x < end; x++ )
+      {
+        const __m256i d = _mm256_sub_epi16( _mm256_loadu_si256( ( const __m256i* )( refRow + x ) ), _mm256_set1_epi16( tarRow[x] ) );
+        sum = _mm256_add_epi16( sum, _mm256_abs_epi16( d ) );
+      }
+      acc0 = _mm256_add_epi32( acc0, _mm256_cvtepu16_epi32( _mm256_castsi256_si128( sum ) ) );
+      acc1 = _mm256_add_epi32( acc1, _mm256_cvtepu16_epi32( _mm256_extracti128_si256( sum, 1 ) ) );
+    }
+    if( _mm256_movemask_epi8( _mm256_and_si256( _mm256_cmpgt_epi32( acc0, limit ), _mm256_cmpgt_epi32( acc1, limit ) ) ) == -1 )
+    {
+      break;
+    }
+  }
+  _mm256_storeu_si256( ( __m256i* )( pDiffs     ), acc0 );
+  _mm256_storeu_si256( ( __m256i* )( pDiffs + 8 ), acc1 );
+}
+#endif
+#endif
+
+Void TComTemplateMatch::rowDiff( const Pel* ref, Int refStride, Int numPos, DistType maxDiff, DistType* pDiffs ) const
+{
+  Int i = 0;
+#if COM16_C806_SIMD_OPT && VCEG_AZ08_USE_SAD_DISTANCE
+#if defined(__AVX2__)
+  for( ; i + 16 <= numPos; i += 16 )
+  {
+    xRowDiff16( ref + i, refStride, maxDiff, pDiffs + i );
+  }
+#endif
+  for( ; i + 8 <= numPos; i += 8 )
+  {
+    xRowDiff8( ref + i, refStride, maxDiff, pDiffs + i );
+  }
+#endif
+  for( ; i < numPos; i++ )
+  {
+    pDiffs[i] = diff( ref + i, refStride, maxDiff );
+  }
+}
+
+UInt64 TComTemplateMatch::admit( const DistType* pDiffs, Int num, DistType maxDiff, Bool bSkipZero )
+{
+  assert( num <= 64 );
+  UInt64 mask = 0;
+  Int    i    = 0;
+#if COM16_C806_SIMD_OPT
+  const __m128i limit = _mm_set1_epi32( maxDiff );
+  const __m128i floor = _mm_set1_epi32( bSkipZero ? 0 : -1 );
+  for( ; i + 4 <= num; i += 4 )
+  {
+    const __m128i d = _mm_loadu_si128( ( const __m128i* )( pDiffs + i ) );
+    const __m128i ok = _mm_and_si128( _mm_cmplt_epi32( d, limit ), _mm_cmpgt_epi32( d, floor ) );
+    mask |= UInt64( _mm_movemask_ps( _mm_castsi128_ps( ok ) ) ) << i;
+  }
+#endif
+  for( ; i < num; i++ )
+  {
+    if( pDiffs[i] < maxDiff && ( !bSkipZero || pDiffs[i] > 0 ) )
+    {
+      mask |= UInt64( 1 ) << i;
+    }
+  }
+  return mask;
+}
+
+//! \}
+
+#endif
@@ -0,0 +1,100 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2015, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TComTemplateMatch.h
+    \brief    template matching distortion of the KLT candidate search (header)
+*/
+
+#ifndef __TCOMTEMPLATEMATCH__
+#define __TCOMTEMPLATEMATCH__
+
+#include "CommonDef.h"
+
+//! \ingroup TLibCommon
+//! \{
+
+#if VCEG_AZ08_KLT_COMMON
+
+/** Distortion between the target patch of a block and the reference patches of the KLT candidate search.
+ *
+ *  A patch is the block with the uiTempSize rows above and columns left of it; with bTemplateOnly the block
+ *  itself is not compared (intra KLT). A reference position is the top-left sample of the block in the
+ *  reference. Distortions above the limit given to a call may be partial sums: they only tell that the
+ *  position is not better than the limit.
+ *
+ *  With COM16_C806_SIMD_OPT the SAD of a row of positions is computed across the positions, 8 lanes with
+ *  SSE4.1 or 16 with AVX2 when the compiler targets it, and a group stops as soon as all its lanes exceed the
+ *  limit. Single positions are computed across the columns.
+ */
+class TComTemplateMatch
+{
+public:
+  /// positions of one search row handed to rowDiff() at a time by the callers
+  static const Int ROW_CHUNK = 32;
+
+  TComTemplateMatch();
+
+  /// the rows of tarPatch are read by the next calls, they are not copied
+  Void     setTarget    ( Pel** tarPatch, UInt uiPatchSize, UInt uiTempSize, Bool bTemplateOnly, Int bitDepth );
+
+  /// distortion at ref
+  DistType diff         ( const Pel* ref, Int refStride, DistType maxDiff ) const;
+
+  /// distortions at ref, ref + 1, ..., ref + numPos - 1 into pDiffs
+  Void     rowDiff      ( const Pel* ref, Int refStride, Int numPos, DistType maxDiff, DistType* pDiffs ) const;
+
+  /// bit i set if diff[i] < maxDiff (and, with bSkipZero, diff[i] > 0): the positions that can enter the candidate list
+  static UInt64 admit   ( const DistType* pDiffs, Int num, DistType maxDiff, Bool bSkipZero );
+
+private:
+  /// number of samples of row y of the patch that are compared
+  Int      xRowWidth    ( Int y ) const { return ( m_templateOnly && y >= m_tempSize ) ? m_tempSize : m_patchSize; }
+#if COM16_C806_SIMD_OPT && VCEG_AZ08_USE_SAD_DISTANCE
+  Void     xRowDiff8    ( const Pel* ref, Int refStride, DistType maxDiff, DistType* pDiffs ) const;
+#if defined(__AVX2__)
+  Void     xRowDiff16   ( const Pel* ref, Int refStride, DistType maxDiff, DistType* pDiffs ) const;
+#endif
+#endif
+
+  Pel**    m_tarPatch;
+  Int      m_patchSize;
+  Int      m_tempSize;
+  Bool     m_templateOnly;
+  Int      m_accumLen;                                        ///< 16-bit sums of |diff| that cannot overflow
+};
+
+#endif
+
+//! \}
+
+#endif // __TCOMTEMPLATEMATCH__
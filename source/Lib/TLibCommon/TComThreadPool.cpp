@@ -0,0 +1,167 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2015, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TComThreadPool.cpp
+    \brief    small pool of worker threads for the data-parallel loops of the encoder
+*/
+
+#include "TComThreadPool.h"
+
+//! \ingroup TLibCommon
+//! \{
+
+// yields of an idle worker before it waits on the condition variable, when every thread of the pool has a core
+static const Int THREAD_POOL_SPIN = 64;
+
+TComThreadPool::TComThreadPool()
+: m_task( NULL )
+, m_numTasks( 0 )
+, m_nextTask( 0 )
+, m_pendingTasks( 0 )
+, m_round( 0 )
+, m_activeWorkers( 0 )
+, m_spin( 0 )
+, m_quit( false )
+{
+}
+
+TComThreadPool::~TComThreadPool()
+{
+  destroy();
+}
+
+Void TComThreadPool::create( Int numThreads )
+{
+  destroy();
+  m_quit = false;
+  // on a loaded machine a spinning worker only takes the core of the thread that would give it work
+  m_spin = numThreads <= Int( std::thread::hardware_concurrency() ) ? THREAD_POOL_SPIN : 0;
+  for( Int i = 1; i < numThreads; i++ )
+  {
+    m_workers.push_back( std::thread( &TComThreadPool::xWorker, this ) );
+  }
+}
+
+Void TComThreadPool::destroy()
+{
+  if( m_workers.empty() )
+  {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock( m_mutex );
+    m_quit = true;
+    m_round++;
+  }
+  m_wake.notify_all();
+  for( size_t i = 0; i < m_workers.size(); i++ )
+  {
+    m_workers[i].join();
+  }
+  m_workers.clear();
+}
+
+Void TComThreadPool::parallelFor( Int numTasks, const std::function<Void( Int )>& task )
+{
+  if( m_workers.empty() || numTasks <= 1 )
+  {
+    for( Int i = 0; i < numTasks; i++ )
+    {
+      task( i );
+    }
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock( m_mutex );
+    m_task     = &task;
+    m_numTasks = numTasks;
+    m_nextTask = 0;
+    m_pendingTasks = numTasks;
+    m_round++;
+  }
+  m_wake.notify_all();
+
+  xRunTasks();
+
+  // a worker that joined the loop late must have left it before the next loop resets the counters
+  std::unique_lock<std::mutex> lock( m_mutex );
+  m_done.wait( lock, [this] { return m_pendingTasks == 0 && m_activeWorkers == 0; } );
+  m_task = NULL;
+}
+
+Void TComThreadPool::xRunTasks()
+{
+  for( Int i = m_nextTask++; i < m_numTasks; i = m_nextTask++ )
+  {
+    ( *m_task )( i );
+    m_pendingTasks--;
+  }
+}
+
+Void TComThreadPool::xWorker()
+{
+  UInt round = 0;
+  while( true )
+  {
+    for( Int spin = 0; spin < m_spin && m_round == round; spin++ )
+    {
+      std::this_thread::yield();
+    }
+
+    std::unique_lock<std::mutex> lock( m_mutex );
+    m_wake.wait( lock, [this, round] { return m_round != round; } );
+    round = m_round;
+    if( m_quit )
+    {
+      return;
+    }
+    if( m_task == NULL )
+    {
+      continue;
+    }
+    m_activeWorkers++;
+    lock.unlock();
+
+    xRunTasks();
+
+    lock.lock();
+    m_activeWorkers--;
+    if( m_activeWorkers == 0 && m_pendingTasks == 0 )
+    {
+      m_done.notify_one();
+    }
+  }
+}
+
+//! \}
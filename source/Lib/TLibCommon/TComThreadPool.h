@@ -0,0 +1,95 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2015, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TComThreadPool.h
+    \brief    small pool of worker threads for the data-parallel loops of the encoder
+*/
+
+#ifndef __TCOMTHREADPOOL__
+#define __TCOMTHREADPOOL__
+
+#include "CommonDef.h"
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+//! \ingroup TLibCommon
+//! \{
+
+/** Pool of worker threads running the iterations of one loop at a time. The calling thread takes
+ *  part in the loop and parallelFor returns when every iteration is done, so a loop body may use
+ *  anything the caller set up before the call. The iterations are handed out in order but run
+ *  in any order: a body must only write to the slot of its iteration, and the caller reduces the
+ *  slots afterwards in iteration order to get the same result as the serial loop.
+ *  Idle workers sleep on a condition variable. When every thread of the pool has a core of its own
+ *  they yield a few times first, which saves the wake-up when the loops follow each other closely.
+ *  A wake-up costs microseconds, so a loop should hand out at least that much work per iteration.
+ */
+class TComThreadPool
+{
+public:
+  TComThreadPool();
+  ~TComThreadPool();
+
+  /// numThreads threads in all, the caller included; 1 or less runs the loops serially
+  Void create         ( Int numThreads );
+  Void destroy        ();
+  Int  getNumThreads  () const          { return Int( m_workers.size() ) + 1; }
+
+  /// run task( i ) for i in [0, numTasks)
+  Void parallelFor    ( Int numTasks, const std::function<Void( Int )>& task );
+
+private:
+  Void xWorker        ();
+  Void xRunTasks      ();
+
+  std::vector<std::thread>          m_workers;
+  std::mutex                        m_mutex;
+  std::condition_variable           m_wake;
+  std::condition_variable           m_done;
+  const std::function<Void( Int )>* m_task;
+  Int                               m_numTasks;
+  std::atomic<Int>                  m_nextTask;
+  std::atomic<Int>                  m_pendingTasks;
+  std::atomic<UInt>                 m_round;       ///< incremented by every parallelFor
+  Int                               m_activeWorkers;
+  Int                               m_spin;        ///< yields of an idle worker before it sleeps
+  Bool                              m_quit;
+};
+
+//! \}
+
+#endif // __TCOMTHREADPOOL__
@@ -63,19 +63,12 @@ float InnerProduct_SSE_FLOATXSHORT(float *pa, short *pb, int m);
 int InnerProduct_SSE_SHORT(short *pa, short *pb, int m);
 void scaleMatrix(float **ppx, short **ppout, float scale, int rows, int cols);
 void scaleMatrix(float **ppx, short **ppout, float scale, int rows, int cols);
-int AbsSumOfVector(short *pa, short *pb, int m);
-int AbsSumOfVectorLesseqthan8(short *pa, short *pb, int m);
-
-UInt GetSAD4x4_SSE_U16(I16 **pSrc, I16 *pRef, Int iRefStride, Int iYOffset, Int iXOffset, UInt uiBestSAD);
-UInt GetSAD8x8_SSE_U16(I16 **pSrc, I16 *pRef, Int iRefStride, Int iYOffset, Int iXOffset, UInt uiBestSAD);
-UInt GetSAD16x16_SSE_U16(I16 **pSrc, I16 *pRef, Int iRefStride, Int iYOffset, Int iXOffset, UInt uiBestSAD);
-UInt GetSAD32x32_SSE_U16(I16 **pSrc, I16 *pRef, Int iRefStride, Int iYOffset, Int iXOffset, UInt uiBestSAD);
 #endif
 
 #if VCEG_AZ08_KLT_COMMON //only support 4x4-32x32 now
 UInt g_uiDepth2MaxCandiNum[5] = { MAX_CANDI_NUM, MAX_CANDI_NUM, MAX_CANDI_NUM, MAX_CANDI_NUM, MAX_CANDI_NUM };
 UInt g_uiDepth2MinCandiNum[5] = { 8, 8, 8, 8, 8 };
-Int g_maxValueThre = MAX_INT;
+thread_local Int g_maxValueThre = MAX_INT;
 
 UInt g_uiDepth2Width[5] = { 4, 8, 16, 32, 64 };
 //template size ===========
@@ -269,9 +262,15 @@ TComTrQuant::TComTrQuant()
 #if VCEG_AZ08_KLT_COMMON
   memset( m_pData , 0 , sizeof( m_pData ) );
   m_pppTarPatch = NULL;
+#if VCEG_AZ08_INTER_KLT
+  m_subPelCacheSlot = 0;
+#endif
   m_pCovMatrix = NULL;
   m_pppdTmpEigenVector = NULL;
   m_pppdEigenVector = NULL;
+#if KLT_DETERMINISTIC_BASIS
+  m_deterministicKLTBasis = false;
+#endif
   m_pppsEigenVector = NULL;
 #endif
 }
@@ -506,6 +505,16 @@ Void TComTrQuant::clearSliceARLCnt()
   memset(m_sliceSumC, 0, sizeof(Double)*(LEVEL_RANGE+1));
   memset(m_sliceNsamples, 0, sizeof(Int)*(LEVEL_RANGE+1));
 }
+
+Void TComTrQuant::addSliceARLCnt(const TComTrQuant& rcTrQuant)
+{
+  // the sums are of integer levels, so the totals do not depend on the order they are added in
+  for(Int u=0; u<=LEVEL_RANGE; u++)
+  {
+    m_sliceSumC[u]     += rcTrQuant.m_sliceSumC[u];
+    m_sliceNsamples[u] += rcTrQuant.m_sliceNsamples[u];
+  }
+}
 #endif
 
 
@@ -8432,7 +8441,7 @@ Void TComTrQuant::transformNxN(       TComTU        & rTu,
   if (pcCU->getROTIdx(uiAbsPartIdx) )
 #endif
   {           
-            static Int ROT_MATRIX[16];
+            static thread_local Int ROT_MATRIX[16];
       Int iSubGroupXMax = Clip3 (1,16,(Int)( (uiWidth>>2)));
       Int iSubGroupYMax = Clip3 (1,16,(Int)( (uiHeight>>2)));
 
@@ -8487,13 +8496,13 @@ Void TComTrQuant::transformNxN(       TComTU        & rTu,
 #endif
       {           
 #if JVET_D0120_NSST_IMPROV
-        static Int NSST_MATRIX[64];
+        static thread_local Int NSST_MATRIX[64];
         const  Int iLog2SbSize   = (uiWidth > 4 && uiHeight > 4) ? 3 : 2;
         const  Int iSbSize       = (uiWidth > 4 && uiHeight > 4) ? 8 : 4;
         const  Int iSubGroupXMax = Clip3(1, 8, (Int)uiWidth ) >> iLog2SbSize;
         const  Int iSubGroupYMax = Clip3(1, 8, (Int)uiHeight) >> iLog2SbSize;
 #else
-        static Int NSST_MATRIX[16];
+        static thread_local Int NSST_MATRIX[16];
         Int iSubGroupXMax = Clip3 (1,16,(Int)( (uiWidth>>2)));
         Int iSubGroupYMax = Clip3 (1,16,(Int)( (uiHeight>>2)));
 #endif
@@ -8847,7 +8856,7 @@ Void TComTrQuant::invTransformNxN(      TComTU        &rTu,
 #if !JVET_C0024_QTBT
     Char ucROTIdx = pcCU->getROTIdx(uiAbsPartIdx) ;
 #endif
-       static Int ROT_MATRIX[16];
+       static thread_local Int ROT_MATRIX[16];
       Int iSubGroupXMax = Clip3 (1,16,(Int)( (uiWidth>>2)));
       Int iSubGroupYMax = Clip3 (1,16,(Int)( (uiHeight>>2)));
       Int iOffSetX = 0;
@@ -8900,13 +8909,13 @@ Void TComTrQuant::invTransformNxN(      TComTU        &rTu,
       Char ucNsstIdx = pcCU->getROTIdx(uiAbsPartIdx) ;
 #endif
 #if JVET_D0120_NSST_IMPROV
-      static Int NSST_MATRIX[64];
+      static thread_local Int NSST_MATRIX[64];
       const  Int iLog2SbSize   = (uiWidth > 4 && uiHeight > 4) ? 3 : 2;
       const  Int iSbSize       = (uiWidth > 4 && uiHeight > 4) ? 8 : 4;
       const  Int iSubGroupXMax = Clip3(1, 8, (Int)uiWidth ) >> iLog2SbSize;
       const  Int iSubGroupYMax = Clip3(1, 8, (Int)uiHeight) >> iLog2SbSize;
 #else
-      static Int NSST_MATRIX[16];
+      static thread_local Int NSST_MATRIX[16];
       Int iSubGroupXMax = Clip3 (1,16,(Int)( (uiWidth>>2)));
       Int iSubGroupYMax = Clip3 (1,16,(Int)( (uiHeight>>2)));
 #endif
@@ -13148,6 +13157,15 @@ Bool TComTrQuant::derive1DimKLT(UInt uiBlkSize, UInt uiUseCandiNumber)
 {
     Bool bSucceed = true;
     UInt uiTarDepth = g_aucConvertToBit[uiBlkSize];
+#if KLT_DETERMINISTIC_BASIS
+    if (m_deterministicKLTBasis)
+    {
+        Short **psEigenVector = m_pppsEigenVector[uiTarDepth];
+        g_ppsEigenVector[uiTarDepth] = psEigenVector;
+        m_kltBasis.deriveFromCovariance(m_pData, uiUseCandiNumber, uiBlkSize, psEigenVector);
+        return bSucceed;
+    }
+#endif
     //calculate covariance matrix
     const UInt uiDim = uiBlkSize*uiBlkSize;
     covMatrixType *covMatrix = m_pCovMatrix[uiTarDepth];
@@ -13203,6 +13221,19 @@ Bool TComTrQuant::derive1DimKLT_Fast(UInt uiBlkSize, UInt uiUseCandiNumber)
     covMatrixType *covMatrix = m_pCovMatrix[uiTarDepth];
     UInt uiTargetCandiNum = g_uiDepth2MaxCandiNum[uiTarDepth];
     UInt uiSampleNum = min(uiUseCandiNumber, uiTargetCandiNum);
+#if KLT_DETERMINISTIC_BASIS
+    if (m_deterministicKLTBasis)
+    {
+        Short **psEigenVector = m_pppsEigenVector[uiTarDepth];
+        g_ppsEigenVector[uiTarDepth] = psEigenVector;
+        UInt uiCalcEigNum = uiSampleNum;
+#if VCEG_AZ08_FORCE_USE_GIVENNUM_BASIS
+        uiCalcEigNum = min(uiSampleNum, (UInt)FORCE_BASIS_NUM);
+#endif
+        m_kltBasis.deriveFromGram(m_pData, uiSampleNum, uiBlkSize, uiCalcEigNum, psEigenVector);
+        return bSucceed;
+    }
+#endif
     //calculate covariance matrix
     calcCovMatrixXXt(m_pData, uiSampleNum, covMatrix, uiDim);
     EigenType **pdEigenVector = m_pppdTmpEigenVector;
@@ -13437,6 +13468,7 @@ Void TComTrQuant::candidateSearch(TComDataCU *pcCU, UInt uiPartAddr, UInt uiBlkS
     const Int channelBitDepth = pcCU->getSlice()->getSPS()->getBitDepth(toChannelType(compID));
     //Initialize the library for saving the best candidates
     m_tempLibFast.initDiff(uiPatchSize, channelBitDepth, uiTargetCandiNum);
+    m_templateMatch.setTarget(tarPatch, uiPatchSize, uiTempSize, false, channelBitDepth);
     Short setId = -1; //to record the reference picture.
 
     Int iCurrPOC = pcCU->getPic()->getPOC();
@@ -13508,14 +13540,11 @@ Void TComTrQuant::candidateSearch(TComDataCU *pcCU, UInt uiPartAddr, UInt uiBlkS
             }
 
             TComPic* refPic = pcCU->getSlice()->getRefPic(eRefPicList, iRefIdxTemp);
-            UInt uiRow = 0;
-            UInt uiCol = 0;
-            TComPicYuv *refPicRec = refPic->getPicQuaYuvRec(uiRow, uiCol);
+            TComPicYuv *refPicRec = refPic->getPicYuvRec();
             Pel *ref = refPicRec->getAddr(compID, pcCU->getCtuRsAddr(), pcCU->getZorderIdxInCtu() + uiPartAddr);
             setId++;
-            setRefPicUsed(setId, ref); //to facilitate the access of each candidate point 
+            setRefPicUsed(setId, ref, refPicRec->getStride(compID)); //to facilitate the access of each candidate point 
             setRefPicBuf(setId, refPic);
-            setStride(refPicRec->getStride(compID));
             searchCandidateFromOnePicInteger(pcCU, uiPartAddr, refPicRec, cMv, tarPatch, uiPatchSize, uiTempSize, setId);
         }
     }
@@ -13553,22 +13582,27 @@ Void TComTrQuant::searchCandidateFromOnePicInteger(TComDataCU *pcCU, UInt uiPart
     Int mvXMin = cMvSrchRngLT.getHor();
     Int mvXMax = cMvSrchRngRB.getHor();
 
-    //search
+    //search, ROW_CHUNK positions of a row at a time
     Pel *refMove = ref + mvYMin*refStride + mvXMin;
     DistType *pDiffEnd = &pDiff[uiLibSizeMinusOne];
 
-    DistType diff;
+    DistType rowDiff[TComTemplateMatch::ROW_CHUNK];
     for (Int iYOffset = mvYMin; iYOffset <= mvYMax; iYOffset++)
     {
-        Pel *refCurr = refMove;
-        for (Int iXOffset = mvXMin; iXOffset <= mvXMax; iXOffset++)
+        for (Int iXStart = mvXMin; iXStart <= mvXMax; iXStart += TComTemplateMatch::ROW_CHUNK)
         {
             //The position of the leftup pixel within this block: refCurr = ref + iYOffset*refStride + iXOffset;
-            diff = calcPatchDiff(refCurr, refStride, tarPatch, uiPatchSize, uiTempSize, *pDiffEnd);
-            refCurr++;
-            if (diff > 0 && diff < (*pDiffEnd))//when residual is zero, may not contribute to the distribution.
+            const Int numPos = min(TComTemplateMatch::ROW_CHUNK, mvXMax - iXStart + 1);
+            m_templateMatch.rowDiff(refMove + iXStart - mvXMin, refStride, numPos, *pDiffEnd, rowDiff);
+            //when residual is zero, may not contribute to the distribution.
+            UInt64 admitted = TComTemplateMatch::admit(rowDiff, numPos, *pDiffEnd, true);
+            for (Int i = 0; admitted; i++, admitted >>= 1)
             {
-                insertNode(diff, iXOffset, iYOffset, pDiff, pX, pY, pId, uiLibSizeMinusOne, setId);
+                //the last kept candidate may have improved since rowDiff
+                if ((admitted & 1) && rowDiff[i] < (*pDiffEnd))
+                {
+                    insertNode(rowDiff[i], iXStart + i, iYOffset, pDiff, pX, pY, pId, uiLibSizeMinusOne, setId);
+                }
             }
         }
         refMove += refStride;
@@ -13583,7 +13617,7 @@ Void TComTrQuant::searchCandidateFraBasedOnInteger(TComDataCU *pcCU, Pel **tarPa
     UInt uiTarDepth = g_aucConvertToBit[uiBlkSize];
     UInt uiTargetCandiNum = g_uiDepth2MaxCandiNum[uiTarDepth];
     UInt  uiLibSizeMinusOne = uiTargetCandiNum - 1;
-    Int  refStride = getStride();
+    const Int refStride = TComSubPelCache::TILE_STRIDE;
     Pel *ref;
     UInt setId;
     Int iCandiPosNum = m_uiPartLibSize;
@@ -13605,10 +13639,24 @@ Void TComTrQuant::searchCandidateFraBasedOnInteger(TComDataCU *pcCU, Pel **tarPa
     TComPic* refPic;
     UInt uiIdxAddr = pcCU->getZorderIdxInCtu() + uiPartAddr;
     Short setIdFra = setIdFraStart - 1;
+
+    //luma position of the block; the sub-pel samples come from the tiles of the reference pictures
+    TComPicYuv *curPicRec = pcCU->getPic()->getPicYuvRec();
+    const Int blkOffset = Int(curPicRec->getAddr(compID, pcCU->getCtuRsAddr(), uiIdxAddr) - curPicRec->getAddr(compID));
+    const Int blkPosX = blkOffset % curPicRec->getStride(compID);
+    const Int blkPosY = blkOffset / curPicRec->getStride(compID);
+    const Int iMargin = 1 + uiTempSize;
+    assert(uiPatchSize + 1 <= TComSubPelCache::TILE_MARGIN);
+    for (k = 0; k < iCandiPosNum; k++)
+    {
+        getRefPicBuf(pIdInteger[k])->getSubPelCache(m_subPelCacheSlot)->beginSearch();
+    }
+
     for (k = 0; k < iCandiPosNum; k++)
     {
         setId = pIdInteger[k];
         refPic = getRefPicBuf(setId);
+        TComSubPelCache *subPelCache = refPic->getSubPelCache(m_subPelCacheSlot);
 
         iOffsetY = pYInteger[k];
         iOffsetX = pXInteger[k];
@@ -13619,36 +13667,37 @@ Void TComTrQuant::searchCandidateFraBasedOnInteger(TComDataCU *pcCU, Pel **tarPa
             {
                 if (uiRow != 0 || uiCol != 0)
                 {
-                    TComPicYuv *refPicRec = refPic->getPicQuaYuvRec(uiRow, uiCol);
-                    ref = refPicRec->getAddr(compID, pcCU->getCtuRsAddr(), uiIdxAddr);
+                    //the patches at (iOffsetX-1 .. iOffsetX, iOffsetY-1 .. iOffsetY) are in one tile; ref is the virtual block position in it
+                    const Pel *tile = subPelCache->getSamples(uiRow, uiCol, blkPosX + iOffsetX - iMargin, blkPosY + iOffsetY - iMargin);
+                    ref = const_cast<Pel*>(tile) - (iOffsetY - iMargin)*refStride - (iOffsetX - iMargin);
 
                     setIdFra++;
-                    setRefPicUsed(setIdFra, ref);
+                    setRefPicUsed(setIdFra, ref, refStride);
                     refCenter = ref + iOffsetY*refStride + iOffsetX;
                     //center
                     refCurr = refCenter;
-                    diff = calcPatchDiff(refCurr, refStride, tarPatch, uiPatchSize, uiTempSize, *pDiffEnd);
+                    diff = m_templateMatch.diff(refCurr, refStride, *pDiffEnd);
                     if (diff > 0 && diff < (*pDiffEnd))
                     {
                         insertNode(diff, iOffsetX, iOffsetY, pDiff, pX, pY, pId, uiLibSizeMinusOne, setIdFra);
                     }
                     //left
                     refCurr = refCenter - 1;
-                    diff = calcPatchDiff(refCurr, refStride, tarPatch, uiPatchSize, uiTempSize, *pDiffEnd);
+                    diff = m_templateMatch.diff(refCurr, refStride, *pDiffEnd);
                     if (diff > 0 && diff < (*pDiffEnd))
                     {
                         insertNode(diff, iOffsetX - 1, iOffsetY, pDiff, pX, pY, pId, uiLibSizeMinusOne, setIdFra);
                     }
                     //up
                     refCurr = refCenter - refStride;
-                    diff = calcPatchDiff(refCurr, refStride, tarPatch, uiPatchSize, uiTempSize, *pDiffEnd);
+                    diff = m_templateMatch.diff(refCurr, refStride, *pDiffEnd);
                     if (diff > 0 && diff < (*pDiffEnd))
                     {
                         insertNode(diff, iOffsetX, iOffsetY - 1, pDiff, pX, pY, pId, uiLibSizeMinusOne, setIdFra);
                     }
                     //left-up
                     refCurr = refCenter - refStride - 1;
-                    diff = calcPatchDiff(refCurr, refStride, tarPatch, uiPatchSize, uiTempSize, *pDiffEnd);
+                    diff = m_templateMatch.diff(refCurr, refStride, *pDiffEnd);
                     if (diff > 0 && diff < (*pDiffEnd))
                     {
                         insertNode(diff, iOffsetX - 1, iOffsetY - 1, pDiff, pX, pY, pId, uiLibSizeMinusOne, setIdFra);
@@ -13755,7 +13804,6 @@ Bool TComTrQuant::prepareKLTSamplesInter(UInt uiBlkSize, UInt uiTempSize)
     {
         return false;
     }
-    Int picStride = getStride();
     Pel predBlk[MAX_1DTRANS_LEN];
     Int i = 0;
 
@@ -13786,6 +13834,7 @@ Bool TComTrQuant::prepareKLTSamplesInter(UInt uiBlkSize, UInt uiTempSize)
         iOffsetY = pY[k];
         iOffsetX = pX[k];
         ref = getRefPicUsed(setId);
+        const Int picStride = getRefStride(setId);
         refTarget = ref + iOffsetY*picStride + iOffsetX;
         i = 0;
         for (UInt uiY = 0; uiY < uiHeight; uiY++)
@@ -13880,6 +13929,7 @@ Void TComTrQuant::candidateSearchIntra(TComDataCU *pcCU, UInt uiPartAddr, UInt u
     TComPicYuv *pPicYuv = pPic->getPicYuvRec();
     //Initialize the library for saving the best candidates
     m_tempLibFast.initTemplateDiff(uiPatchSize, uiBlkSize, channelBitDepth, uiTargetCandiNum);
+    m_templateMatch.setTarget(tarPatch, uiPatchSize, uiTempSize, true, channelBitDepth);
     Short setId = 0; //record the reference picture.
     searchCandidateFromOnePicIntra(pcCU, uiPartAddr, pPic, pPicYuv, tarPatch, uiPatchSize, uiTempSize, setId);
 }
@@ -13903,8 +13953,7 @@ Void  TComTrQuant::searchCandidateFromOnePicIntra(TComDataCU *pcCU, UInt uiPartA
     Int     refStride = refPic->getStride(compID);
     Int zOrder = pcCU->getZorderIdxInCtu() + uiPartAddr;
     Pel *ref = refPic->getAddr(compID, pcCU->getCtuRsAddr(), zOrder);
-    setRefPicUsed(setId, ref); //facilitate the access of each candidate point 
-    setStride(refPic->getStride(compID));
+    setRefPicUsed(setId, ref, refPic->getStride(compID)); //facilitate the access of each candidate point 
 
     Int     iSrchRng = SEARCHRANGEINTRA;
     TComMv  cMvSrchRngLT;
@@ -13924,9 +13973,8 @@ Void  TComTrQuant::searchCandidateFromOnePicIntra(TComDataCU *pcCU, UInt uiPartA
     Int offsetLCUX = g_auiRasterToPelX[g_auiZscanToRaster[zOrder]];
 
     Int iYOffset, iXOffset;
-    DistType diff;
     DistType *pDiffEnd = &pDiff[uiLibSizeMinusOne];
-    Pel *refCurr;
+    DistType rowDiff[TComTemplateMatch::ROW_CHUNK];
 
 #define REGION_NUM 3
     Int mvYMins[REGION_NUM];
@@ -13990,21 +14038,28 @@ Void  TComTrQuant::searchCandidateFromOnePicIntra(TComDataCU *pcCU, UInt uiPartA
         }
         for (iYOffset = mvYMax; iYOffset >= mvYMin; iYOffset--)
         {
-            for (iXOffset = mvXMax; iXOffset >= mvXMin; iXOffset--)
+            for (Int iXEnd = mvXMax; iXEnd >= mvXMin; iXEnd -= TComTemplateMatch::ROW_CHUNK)
             {
-                refCurr = ref + iYOffset*refStride + iXOffset;
-                Int iLCUX = iXOffset + combinedX;
-                Int iLCUY = iYOffset + combinedY;
-                Int ZorderTmp = getZorder(iLCUX, iLCUY, NumInRow);
-                if (ZorderTmp >= zOrder)
-                {
-                    //Ignore the blocks that have not been coded.
-                    continue;
-                }
-                diff = calcTemplateDiff(refCurr, refStride, tarPatch, uiPatchSize, uiTempSize, *pDiffEnd);
-                if (diff < (*pDiffEnd))
+                const Int iXStart = max(mvXMin, iXEnd - TComTemplateMatch::ROW_CHUNK + 1);
+                const Int numPos = iXEnd - iXStart + 1;
+                m_templateMatch.rowDiff(ref + iYOffset*refStride + iXStart, refStride, numPos, *pDiffEnd, rowDiff);
+                const UInt64 admitted = TComTemplateMatch::admit(rowDiff, numPos, *pDiffEnd, false);
+                for (Int i = numPos - 1; admitted && i >= 0; i--)
                 {
-                    insertNode(diff, iXOffset, iYOffset, pDiff, pX, pY, pId, uiLibSizeMinusOne, setId);
+                    iXOffset = iXStart + i;
+                    if (!((admitted >> i) & 1) || rowDiff[i] >= (*pDiffEnd))
+                    {
+                        continue;
+                    }
+                    Int iLCUX = iXOffset + combinedX;
+                    Int iLCUY = iYOffset + combinedY;
+                    Int ZorderTmp = getZorder(iLCUX, iLCUY, NumInRow);
+                    if (ZorderTmp >= zOrder)
+                    {
+                        //Ignore the blocks that have not been coded.
+                        continue;
+                    }
+                    insertNode(rowDiff[i], iXOffset, iYOffset, pDiff, pX, pY, pId, uiLibSizeMinusOne, setId);
                 }
             }
         }
@@ -14027,13 +14082,18 @@ Void  TComTrQuant::searchCandidateFromOnePicIntra(TComDataCU *pcCU, UInt uiPartA
         }
         for (iYOffset = mvYMax; iYOffset >= mvYMin; iYOffset--)
         {
-            for (iXOffset = mvXMax; iXOffset >= mvXMin; iXOffset--)
+            for (Int iXEnd = mvXMax; iXEnd >= mvXMin; iXEnd -= TComTemplateMatch::ROW_CHUNK)
             {
-                refCurr = ref + iYOffset*refStride + iXOffset;
-                diff = calcTemplateDiff(refCurr, refStride, tarPatch, uiPatchSize, uiTempSize, *pDiffEnd);
-                if (diff < (*pDiffEnd))
+                const Int iXStart = max(mvXMin, iXEnd - TComTemplateMatch::ROW_CHUNK + 1);
+                const Int numPos = iXEnd - iXStart + 1;
+                m_templateMatch.rowDiff(ref + iYOffset*refStride + iXStart, refStride, numPos, *pDiffEnd, rowDiff);
+                const UInt64 admitted = TComTemplateMatch::admit(rowDiff, numPos, *pDiffEnd, false);
+                for (Int i = numPos - 1; admitted && i >= 0; i--)
                 {
-                    insertNode(diff, iXOffset, iYOffset, pDiff, pX, pY, pId, uiLibSizeMinusOne, setId);
+                    if (((admitted >> i) & 1) && rowDiff[i] < (*pDiffEnd))
+                    {
+                        insertNode(rowDiff[i], iXStart + i, iYOffset, pDiff, pX, pY, pId, uiLibSizeMinusOne, setId);
+                    }
                 }
             }
         }
@@ -14076,7 +14136,6 @@ Bool TComTrQuant::generateTMPrediction(Pel *piPred, UInt uiStride, UInt uiBlkSiz
     Int *pY = m_tempLibFast.getY();
     Short setId;
     Pel *ref;
-    Int picStride = getStride();
     Int iOffsetY, iOffsetX;
     Pel *refTarget;
     UInt uiHeight = uiPatchSize - uiTempSize;
@@ -14089,6 +14148,7 @@ Bool TComTrQuant::generateTMPrediction(Pel *piPred, UInt uiStride, UInt uiBlkSiz
     //collect the candidates
     setId = 0;
     ref = getRefPicUsed(setId);
+    Int picStride = getRefStride(setId);
 
     for (k = 0; k < iCandiNum; k++)
     {
@@ -14171,7 +14231,6 @@ Bool TComTrQuant::prepareKLTSamplesIntra(Pel *piPred, UInt uiStride, UInt uiBlkS
     Int *pY = m_tempLibFast.getY();
     Short setId;
     Pel *ref;
-    Int picStride = getStride();
     Int iOffsetY, iOffsetX;
     Pel *refTarget;
 
@@ -14179,6 +14238,7 @@ Bool TComTrQuant::prepareKLTSamplesIntra(Pel *piPred, UInt uiStride, UInt uiBlkS
     Int iCandiNum = m_uiVaildCandiNum;
     setId = 0;
     ref = getRefPicUsed(setId);
+    Int picStride = getRefStride(setId);
     for (k = 0; k < iCandiNum; k++)
     {
         pData = m_pData[k];
@@ -14210,213 +14270,6 @@ Bool TComTrQuant::prepareKLTSamplesIntra(Pel *piPred, UInt uiStride, UInt uiBlkS
     return true;
 }
 
-#if VCEG_AZ08_USE_SSE_TMP_SAD
-DistType TComTrQuant::calcTemplateDiff(Pel *ref, UInt uiStride, Pel **tarPatch, UInt uiPatchSize, UInt uiTempSize, DistType iMax)
-{
-    Int iY, iX;
-    Int iDiffSum = 0;
-    Pel *refPatchRow = ref - uiTempSize*uiStride - uiTempSize;
-    Pel *tarPatchRow;
-    static int id = 0;
-    id++;
-    for (iY = 0; iY < uiTempSize; iY++)
-    {
-        tarPatchRow = tarPatch[iY];
-#if VCEG_AZ08_USE_SSE_TMP_SAD
-        iDiffSum += AbsSumOfVector(refPatchRow, tarPatchRow, uiPatchSize);
-#else
-        for (iX = 0; iX < uiPatchSize; iX++)
-        {
-            iDiffSum += abs(refPatchRow[iX] - tarPatchRow[iX]);
-        }
-        iDiffSum += tmpDiff2;
-#endif
-        if (iDiffSum > iMax) //for speeding up
-        {
-            return iDiffSum;
-        }
-        refPatchRow += uiStride;
-    }
-
-    if (uiTempSize > 2 && uiTempSize <= 8)
-    {
-        for (iY = uiTempSize; iY < uiPatchSize; iY++)
-        {
-            tarPatchRow = tarPatch[iY];
-#if VCEG_AZ08_USE_SSE_TMP_SAD
-            iDiffSum += AbsSumOfVectorLesseqthan8(refPatchRow, tarPatchRow, uiTempSize);
-#else
-            for (iX = 0; iX < uiTempSize; iX++)
-            {
-                iDiffSum += abs(refPatchRow[iX] - tarPatchRow[iX]);
-            }
-#endif
-            if (iDiffSum > iMax)
-            {
-                return iDiffSum;
-            }
-            refPatchRow += uiStride;
-        }
-    }
-    else
-    {
-        for (iY = uiTempSize; iY < uiPatchSize; iY++)
-        {
-            tarPatchRow = tarPatch[iY];
-            for (iX = 0; iX < uiTempSize; iX++)
-            {
-                iDiffSum += abs(refPatchRow[iX] - tarPatchRow[iX]);
-            }
-            if (iDiffSum > iMax)
-            {
-                return iDiffSum;
-            }
-            refPatchRow += uiStride;
-        }
-    }
-    return iDiffSum;
-}
-#else
-DistType TComTrQuant::calcTemplateDiff(Pel *ref, UInt uiStride, Pel **tarPatch, UInt uiPatchSize, UInt uiTempSize, DistType iMax)
-{
-    Int iY, iX;
-#if VCEG_AZ08_USE_SSD_DISTANCE
-    Int iDiff;
-#endif
-    DistType iDiffSum = 0;
-    Pel *refPatchRow = ref - uiTempSize*uiStride - uiTempSize;
-    Pel *tarPatchRow;
-    for (iY = 0; iY < uiTempSize; iY++)
-    {
-        tarPatchRow = tarPatch[iY];
-        for (iX = 0; iX < uiPatchSize; iX++)
-        {
-#if VCEG_AZ08_USE_SAD_DISTANCE
-            iDiffSum += abs(refPatchRow[iX] - tarPatchRow[iX]);
-#endif
-#if VCEG_AZ08_USE_SSD_DISTANCE
-            iDiff = refPatchRow[iX] - tarPatchRow[iX];
-            iDiffSum += iDiff * iDiff;
-#endif
-        }
-        if (iDiffSum > iMax) //for speeding up
-        {
-            return iDiffSum;
-        }
-        refPatchRow += uiStride;
-    }
-    for (iY = uiTempSize; iY < uiPatchSize; iY++)
-    {
-        tarPatchRow = tarPatch[iY];
-        for (iX = 0; iX < uiTempSize; iX++)
-        {
-#if VCEG_AZ08_USE_SAD_DISTANCE
-            iDiffSum += abs(refPatchRow[iX] - tarPatchRow[iX]);
-#endif
-#if VCEG_AZ08_USE_SSD_DISTANCE
-            iDiff = refPatchRow[iX] - tarPatchRow[iX];
-            iDiffSum += iDiff * iDiff;
-#endif
-        }
-        if (iDiffSum > iMax) //for speeding up
-        {
-            return iDiffSum;
-        }
-        refPatchRow += uiStride;
-    }
-    return iDiffSum;
-}
-#endif
-#endif
-
-#if VCEG_AZ08_INTER_KLT
-DistType TComTrQuant::calcPatchDiff(Pel *ref, UInt uiStride, Pel **tarPatch, UInt uiPatchSize, UInt uiTempSize, DistType iMax)
-{
-#if VCEG_AZ08_USE_SSE_BLK_SAD
-    UInt uiBlkSize = uiPatchSize - uiTempSize;
-    UInt blkDiffSum = 0;
-    switch (uiBlkSize)
-    {
-    case 4:
-    {
-              blkDiffSum = GetSAD4x4_SSE_U16(tarPatch, ref, uiStride, uiTempSize, uiTempSize, iMax);
-              break;
-    }
-    case 8:
-    {
-              blkDiffSum = GetSAD8x8_SSE_U16(tarPatch, ref, uiStride, uiTempSize, uiTempSize, iMax);
-              break;
-    }
-    case 16:
-    {
-               blkDiffSum = GetSAD16x16_SSE_U16(tarPatch, ref, uiStride, uiTempSize, uiTempSize, iMax);
-               break;
-    }
-    case 32:
-    {
-               blkDiffSum = GetSAD32x32_SSE_U16(tarPatch, ref, uiStride, uiTempSize, uiTempSize, iMax);
-               break;
-    }
-    default:
-    {
-               //common calculation rather than using SSE for other cases.
-               Int iY, iX;
-               DistType iDiffSum = 0;
-               Pel *refPatchRow = ref - uiTempSize*uiStride - uiTempSize;
-               Pel *tarPatchRow;
-               for (iY = 0; iY < uiPatchSize; iY++)
-               {
-                   tarPatchRow = tarPatch[iY];
-                   for (iX = 0; iX < uiPatchSize; iX++)
-                   {
-                       iDiffSum += abs(refPatchRow[iX] - tarPatchRow[iX]);
-                   }
-                   if (iDiffSum > iMax) //for speeding up
-                   {
-                       break;
-                   }
-                   refPatchRow += uiStride;
-               }
-    }
-    }
-
-    if (uiTempSize >0 && blkDiffSum < iMax)
-    {
-        Int remainMax = iMax - blkDiffSum;
-        UInt tempDiffSum = calcTemplateDiff(ref, uiStride, tarPatch, uiPatchSize, uiTempSize, remainMax);
-        blkDiffSum += tempDiffSum;
-    }
-    return blkDiffSum;
-#else
-    Int iY, iX;
-#if VCEG_AZ08_USE_SSD_DISTANCE
-    Int iDiff;
-#endif
-    DistType iDiffSum = 0;
-    Pel *refPatchRow = ref - uiTempSize*uiStride - uiTempSize;
-    Pel *tarPatchRow;
-    for (iY = 0; iY < uiPatchSize; iY++)
-    {
-        tarPatchRow = tarPatch[iY];
-        for (iX = 0; iX < uiPatchSize; iX++)
-        {
-#if VCEG_AZ08_USE_SAD_DISTANCE
-            iDiffSum += abs(refPatchRow[iX] - tarPatchRow[iX]);
-#endif
-#if VCEG_AZ08_USE_SSD_DISTANCE
-            iDiff = refPatchRow[iX] - tarPatchRow[iX];
-            iDiffSum += iDiff * iDiff;
-#endif
-        }
-        if (iDiffSum > iMax) //for speeding up
-        {
-            break;
-        }
-        refPatchRow += uiStride;
-    }
-    return iDiffSum;
-#endif
-}
 #endif
 
 
@@ -14550,231 +14403,5 @@ void scaleMatrix(float **ppx, short **ppout, float scale, int rows, int cols)
         scaleVector(ppx[iRow], scaleArray, ppout[iRow], cols);
     }
 }
-
-UInt GetSAD4x4_SSE_U16(I16 **pSrc, I16 *pRef, Int iRefStride, Int iYOffset, Int iXOffset, UInt uiBestSAD)
-{
-    int blkSize = 4;
-    __m128i s0, s1, s2, s3;
-    __m128i r0, r1, r2, r3;
-
-    r0 = _mm_cvtsi64_si128(*(__int64*)(pRef)); //first line
-    r1 = _mm_cvtsi64_si128(*(__int64*)(pRef + iRefStride)); //second line
-    r2 = _mm_or_si128(_mm_slli_si128(r1, 8), r0); //first & second line
-
-    s0 = _mm_cvtsi64_si128(*(__int64*)(pSrc[iYOffset] + iXOffset)); //first line
-    s1 = _mm_cvtsi64_si128(*(__int64*)(pSrc[iYOffset + 1] + iXOffset)); //second line
-    s2 = _mm_or_si128(_mm_slli_si128(s1, 8), s0); //first & second line
-    r2 = _mm_subs_epi16(r2, s2);
-    r2 = _mm_abs_epi16(r2);
-#if USE_SUM
-    UInt sum1 = GetSum(r2);
-#else
-    UInt sum1 = r2.m128i_i16[0] + r2.m128i_i16[1] + r2.m128i_i16[2] + r2.m128i_i16[3] + r2.m128i_i16[4] + r2.m128i_i16[5] + r2.m128i_i16[6] + r2.m128i_i16[7];
-#endif
-    if (sum1 > uiBestSAD)
-    {
-        return sum1;
-    }
-
-    r0 = _mm_cvtsi64_si128(*(__int64*)(pRef + 2 * iRefStride)); //3 line
-    r1 = _mm_cvtsi64_si128(*(__int64*)(pRef + 3 * iRefStride)); //4 line
-    r3 = _mm_or_si128(_mm_slli_si128(r1, 8), r0); //3 & 4 line
-
-    s0 = _mm_cvtsi64_si128(*(__int64*)(pSrc[iYOffset + 2] + iXOffset)); //3 line
-    s1 = _mm_cvtsi64_si128(*(__int64*)(pSrc[iYOffset + 3] + iXOffset)); //4 line
-    s3 = _mm_or_si128(_mm_slli_si128(s1, 8), s0); //3 & 4 line
-
-    r3 = _mm_subs_epi16(r3, s3);
-    r3 = _mm_abs_epi16(r3);
-#if USE_SUM
-    UInt sum2 = GetSum(r3);
-#else
-    UInt sum2 = r3.m128i_i16[0] + r3.m128i_i16[1] + r3.m128i_i16[2] + r3.m128i_i16[3] + r3.m128i_i16[4] + r3.m128i_i16[5] + r3.m128i_i16[6] + r3.m128i_i16[7];
-#endif
-    return sum1 + sum2;
-}
-
-UInt GetSAD8x8_SSE_U16(I16 **pSrc, I16 *pRef, Int iRefStride, Int iYOffset, Int iXOffset, UInt uiBestSAD)
-{
-    int blkSize = 8;
-    __m128i s0, s1;
-    __m128i r0, r1;
-    __m128i diff, diff0, diff1;
-    UInt sumOfRow;
-    UInt sum = 0;
-    for (int row = 0; row < 8; row += 2)
-    {
-        r0 = _mm_loadu_si128((__m128i*) (pRef + iRefStride*row));
-        s0 = _mm_loadu_si128((__m128i*) (pSrc[iYOffset + row] + iXOffset));
-        diff0 = _mm_subs_epi16(r0, s0);
-        diff0 = _mm_abs_epi16(diff0);
-
-        r1 = _mm_loadu_si128((__m128i*) (pRef + iRefStride*(1 + row)));
-        s1 = _mm_loadu_si128((__m128i*) (pSrc[iYOffset + row + 1] + iXOffset));
-        diff1 = _mm_subs_epi16(r1, s1);
-        diff1 = _mm_abs_epi16(diff1);
-
-        diff = _mm_adds_epi16(diff0, diff1);
-#if USE_SUM
-        sumOfRow = GetSum(diff);
-#else
-        sumOfRow = diff.m128i_i16[0] + diff.m128i_i16[1] + diff.m128i_i16[2] + diff.m128i_i16[3] + diff.m128i_i16[4] + diff.m128i_i16[5] + diff.m128i_i16[6] + diff.m128i_i16[7];
-#endif
-        sum += sumOfRow;
-        if (sum > uiBestSAD)
-        {
-            return sum;
-        }
-    }
-    return sum;
-}
-
-UInt GetSAD16x16_SSE_U16(I16 **pSrc, I16 *pRef, Int iRefStride, Int iYOffset, Int iXOffset, UInt uiBestSAD)
-{
-    int blkSize = 16;
-    __m128i s0, s1;
-    __m128i r0, r1;
-    __m128i diff, diff0, diff1;
-    UInt sumOfRow;
-    UInt sum = 0;
-    for (int blkRow = 0; blkRow < 2; blkRow++)
-    {
-        for (int blkCol = 0; blkCol < 2; blkCol++)
-        {
-            Int iRelativeOffset = ((blkRow *iRefStride + blkCol) << 3);
-            I16 *pRefCurr = pRef + iRelativeOffset;
-            Int iYOffsetCurr = iYOffset + (blkRow << 3);
-            Int iXOffsetCurr = iXOffset + (blkCol << 3);
-
-            for (int row = 0; row < 8; row += 2)
-            {
-                r0 = _mm_loadu_si128((__m128i*) (pRefCurr + iRefStride*row));
-                s0 = _mm_loadu_si128((__m128i*) (pSrc[iYOffsetCurr + row] + iXOffsetCurr));
-                diff0 = _mm_subs_epi16(r0, s0);
-                diff0 = _mm_abs_epi16(diff0);
-
-                r1 = _mm_loadu_si128((__m128i*) (pRefCurr + iRefStride*(1 + row)));
-                s1 = _mm_loadu_si128((__m128i*) (pSrc[iYOffsetCurr + row + 1] + iXOffsetCurr));
-                diff1 = _mm_subs_epi16(r1, s1);
-                diff1 = _mm_abs_epi16(diff1);
-
-                diff = _mm_adds_epi16(diff0, diff1);
-#if USE_SUM
-                sumOfRow = GetSum(diff);
-#else
-                sumOfRow = diff.m128i_i16[0] + diff.m128i_i16[1] + diff.m128i_i16[2] + diff.m128i_i16[3] + diff.m128i_i16[4] + diff.m128i_i16[5] + diff.m128i_i16[6] + diff.m128i_i16[7];
-#endif
-                sum += sumOfRow;
-                if (sum > uiBestSAD)
-                {
-                    return sum;
-                }
-            }
-        }
-    }
-    return sum;
-}
-
-UInt GetSAD32x32_SSE_U16(I16 **pSrc, I16 *pRef, Int iRefStride, Int iYOffset, Int iXOffset, UInt uiBestSAD)
-{
-    int blkSize = 32;
-    __m128i s0, s1;
-    __m128i r0, r1;
-    __m128i diff, diff0, diff1;
-    UInt sumOfRow;
-    UInt sum = 0;
-    for (int blkRow = 0; blkRow < 4; blkRow++)
-    {
-        for (int blkCol = 0; blkCol < 4; blkCol++)
-        {
-            Int iRelativeOffset = ((blkRow *iRefStride + blkCol) << 3);
-            I16 *pRefCurr = pRef + iRelativeOffset;
-            Int iYOffsetCurr = iYOffset + (blkRow << 3);
-            Int iXOffsetCurr = iXOffset + (blkCol << 3);
-            for (int row = 0; row < 8; row += 2)
-            {
-                r0 = _mm_loadu_si128((__m128i*) (pRefCurr + iRefStride*row));
-                s0 = _mm_loadu_si128((__m128i*) (pSrc[iYOffsetCurr + row] + iXOffsetCurr));
-                diff0 = _mm_subs_epi16(r0, s0);
-                diff0 = _mm_abs_epi16(diff0);
-
-                r1 = _mm_loadu_si128((__m128i*) (pRefCurr + iRefStride*(1 + row)));
-                s1 = _mm_loadu_si128((__m128i*) (pSrc[iYOffsetCurr + row + 1] + iXOffsetCurr));
-                diff1 = _mm_subs_epi16(r1, s1);
-                diff1 = _mm_abs_epi16(diff1);
-
-                diff = _mm_adds_epi16(diff0, diff1);
-#if USE_SUM
-                sumOfRow = GetSum(diff);
-#else
-                sumOfRow = diff.m128i_i16[0] + diff.m128i_i16[1] + diff.m128i_i16[2] + diff.m128i_i16[3] + diff.m128i_i16[4] + diff.m128i_i16[5] + diff.m128i_i16[6] + diff.m128i_i16[7];
-#endif
-                sum += sumOfRow;
-                if (sum > uiBestSAD)
-                {
-                    return sum;
-                }
-            }
-        }
-    }
-    return sum;
-}
-
-// sum of abs for two vectors of m length
-int AbsSumOfVector(short *pa, short *pb, int m)
-{
-    int sum = 0;
-    int m_int = (m >> 3) << 3;
-    int m_remain = m % 8;
-    int i;
-    __m128i a, b, diff;
-    for (i = 0; i < m_int; i += 8)
-    {
-        a = _mm_loadu_si128((__m128i*) (pa + i));
-        b = _mm_loadu_si128((__m128i*) (pb + i));
-        diff = _mm_subs_epi16(a, b);
-        diff = _mm_abs_epi16(diff);
-        sum += GetSum(diff);
-    }
-    if (m_remain > 0)
-    {
-        i = m_int;
-        a = _mm_loadu_si128((__m128i*) (pa + i));
-        b = _mm_loadu_si128((__m128i*) (pb + i));
-        diff = _mm_subs_epi16(a, b);
-        diff = _mm_abs_epi16(diff);
-        if (m_remain == 3)
-        {
-            sum += (diff.m128i_i16[0] + diff.m128i_i16[1] + diff.m128i_i16[2]);
-        }
-        else
-        {
-            for (i = 0; i < m_remain; i++)
-            {
-                sum += diff.m128i_i16[i];
-            }
-        }
-    }
-    return sum;
-}
-
-// sum of abs for two vectors of m length (m<=8)
-int AbsSumOfVectorLesseqthan8(short *pa, short *pb, int m)
-{
-    //assert(m <= 8);
-    int sum = 0;
-    int i;
-    __m128i a, b, diff;
-
-    a = _mm_loadu_si128((__m128i*) (pa));
-    b = _mm_loadu_si128((__m128i*) (pb));
-    diff = _mm_subs_epi16(a, b);
-    diff = _mm_abs_epi16(diff);
-    for (i = 0; i < m; i++)
-    {
-        sum += diff.m128i_i16[i];
-    }
-    return sum;
-}
 #endif
 //! \}
@@ -43,6 +43,8 @@
 #include "TComDataCU.h"
 #include "TComChromaFormat.h"
 #include "ContextTables.h"
+#include "TComTemplateMatch.h"
+#include "TComKLTBasis.h"
 
 //! \ingroup TLibCommon
 //! \{
@@ -473,6 +475,14 @@ Void InvNsst8x8( Int* src, UInt uiMode, UChar index );
 #if COM16_C806_CR_FROM_CB_LAMBDA_ADJUSTMENT
   Double getlambda () { return m_dLambda; }
 #endif
+  /// takes the RDOQ lambdas of another transform, e.g. the one of the slice encoder for a CTU row worker
+  Void copyLambdas( const TComTrQuant& rcTrQuant )
+  {
+#if RDOQ_CHROMA_LAMBDA
+    setLambdas( rcTrQuant.m_lambdas );
+#endif
+    m_dLambda = rcTrQuant.m_dLambda;
+  }
 
   Void setRDOQOffset( UInt uiRDOQOffset ) { m_uiRDOQOffset = uiRDOQOffset; }
 
@@ -567,6 +577,7 @@ Void InvNsst8x8( Int* src, UInt uiMode, UChar index );
   Void    initSliceQpDelta() ;
   Void    storeSliceQpNext(TComSlice* pcSlice);
   Void    clearSliceARLCnt();
+  Void    addSliceARLCnt(const TComTrQuant& rcTrQuant);  ///< adds the ARL statistics collected by another transform (CTU row worker)
   Int     getQpDelta(Int qp) { return m_qpDelta[qp]; }
   Int*    getSliceNSamples(){ return m_sliceNsamples ;}
   Double* getSliceSumC()    { return m_sliceSumC; }
@@ -577,17 +588,18 @@ Void InvNsst8x8( Int* src, UInt uiMode, UChar index );
 #if VCEG_AZ08_KLT_COMMON
   Void calcCovMatrix(TrainDataType **pData, UInt uiSampleNum, covMatrixType *pCovMatrix, UInt uiDim, DistType *pDiff);
   Void calcCovMatrixXXt(TrainDataType **pData, UInt uiSampleNum, covMatrixType *pCovMatrix, UInt uiDim);
-  DistType calcTemplateDiff(Pel *ref, UInt uiStride, Pel **tarPatch, UInt uiPatchSize, UInt uiTempSize, DistType iMax);
   Void calcCovMatrix(TrainDataType **pData, UInt uiSampleNum, covMatrixType *pCovMatrix, UInt uiDim);
+#if KLT_DETERMINISTIC_BASIS
+  Void setDeterministicKLTBasis(Bool b) { m_deterministicKLTBasis = b; }    ///< klt_deterministic_basis_flag of the active SPS
+#endif
   Bool deriveKLT(UInt uiBlkSize, UInt uiUseCandiNumber);
   Bool derive1DimKLT_Fast(UInt uiBlkSize, UInt uiUseCandiNumber);
   Bool derive1DimKLT(UInt uiBlkSize, UInt uiUseCandiNumber);
   Bool derive2DimKLT(UInt uiBlkSize, DistType *pDiff);
   Pel  **getTargetPatch(UInt uiDepth) { return m_pppTarPatch[uiDepth]; }
   Pel* getRefPicUsed(UInt uiId) { return m_refPicUsed[uiId]; }
-  Void setRefPicUsed(UInt uiId, Pel *ref) { m_refPicUsed[uiId] = ref; }
-  UInt getStride() { return m_uiPicStride; }
-  Void setStride(UInt uiPicStride) { m_uiPicStride = uiPicStride; }
+  Void setRefPicUsed(UInt uiId, Pel *ref, UInt uiStride) { m_refPicUsed[uiId] = ref; m_refStride[uiId] = uiStride; }
+  UInt getRefStride(UInt uiId) { return m_refStride[uiId]; }
 #endif
 #if VCEG_AZ08_INTRA_KLT
   Void searchCandidateFromOnePicIntra(TComDataCU *pcCU, UInt uiPartAddr, TComPic* refPicSrc, TComPicYuv *refPic, Pel **tarPatch, UInt uiPatchSize, UInt uiTempSize, UInt setId);
@@ -607,7 +619,7 @@ Void InvNsst8x8( Int* src, UInt uiMode, UChar index );
   Bool prepareKLTSamplesInter(UInt uiBlkSize, UInt uiTempSize);
   Void setRefPicBuf(UInt uiId, TComPic *refPic) { m_refPicBuf[uiId] = refPic; }
   TComPic* getRefPicBuf(UInt uiId) { return m_refPicBuf[uiId]; }
-  DistType calcPatchDiff(Pel *ref, UInt uiStride, Pel **tarPatch, UInt uiPatchSize, UInt uiTempSize, DistType iMax);
+  Void setSubPelCacheSlot(UInt slot) { m_subPelCacheSlot = slot; }    ///< TComPic::getSubPelCache() slot of the thread using this object
   Void xSetSearchRange(TComDataCU* pcCU, TComMv& cMvPred, Int iSrchRng, TComMv& rcMvSrchRngLT, TComMv& rcMvSrchRngRB);
 #endif
 
@@ -659,21 +671,29 @@ protected:
   TempLibFast m_tempLibFast;
   Pel *m_refPicUsed[MAX_NUM_REF_IDS];
   TComPic *m_refPicBuf[MAX_NUM_REF_IDS];
-  UInt m_uiPicStride;
+  TComTemplateMatch m_templateMatch;
+  UInt m_refStride[MAX_NUM_REF_IDS];                   ///< a candidate set is a picture plane or a sub-pel tile
+#if VCEG_AZ08_INTER_KLT
+  UInt m_subPelCacheSlot;
+#endif
   TrainDataType *m_pData[MAX_CANDI_NUM];
 #if VCEG_AZ08_USE_TRANSPOSE_CANDDIATEARRAY
   TrainDataType *m_pDataT[MAX_1DTRANS_LEN];
 #endif
   UInt m_uiVaildCandiNum;
+#if KLT_DETERMINISTIC_BASIS
+  Bool m_deterministicKLTBasis;
+  TComKLTBasis m_kltBasis;
+#endif
   Double m_pEigenValues[MAX_1DTRANS_LEN];
   Int m_pIDTmp[MAX_1DTRANS_LEN];
   EigenType ***m_pppdEigenVector;
-  Short ***m_pppsEigenVector;
   covMatrixType **m_pCovMatrix;
-  Pel ***m_pppTarPatch;
 #if VCEG_AZ08_FAST_DERIVE_KLT
   EigenType **m_pppdTmpEigenVector;
 #endif
+  Short ***m_pppsEigenVector;
+  Pel ***m_pppTarPatch;
 #endif
 
 private:
@@ -142,6 +142,7 @@
 #define VCEG_AZ08_USE_SAD_DISTANCE                        1  ///< (default 1) If defined, use SAD distance.
 //Speed up
 #define VCEG_AZ08_FAST_DERIVE_KLT                         1  ///< (default 1) If defined, will use fast algorithm to calculate KLT basis
+#define KLT_DETERMINISTIC_BASIS                           1  ///< (default 1) streams with klt_deterministic_basis_flag (SPS, cfg KLTDeterministicBasis) derive the KLT basis with TComKLTBasis (SIMD Gram matrix, fixed-order eigensolver), which is the same on all platforms; other streams keep the Eigen derivation
 #define VCEG_AZ08_USE_SSE_SPEEDUP                         0  ///< (default 0) If defined, will use sse for speeding up (Note: should use x64 compile mode)
 #if VCEG_AZ08_USE_SSE_SPEEDUP
 #define VCEG_AZ08_USE_SSE_SCLAE                           1  ///< (default 1) If defined, will use SSE for calculating the scaling of float to get integer KLT basis
@@ -150,10 +151,6 @@
 #if VCEG_AZ08_USE_SHORTXSHORT_SSE
 #define VCEG_AZ08_USE_TRANSPOSE_CANDDIATEARRAY            1  ///< (default 1) If defined, will use transpose of candidate array to facilitate the vector multiplication
 #endif
-#if VCEG_AZ08_USE_SAD_DISTANCE
-#define VCEG_AZ08_USE_SSE_BLK_SAD                         1  ///< (default 1) If defined, will calculate the block difference use intel SSE 
-#define VCEG_AZ08_USE_SSE_TMP_SAD                         1  ///< (default 1) If defined, will calculate the template difference use intel SSE 
-#endif
 #endif
 
 #define VCEG_AZ08_INTER_KLT_MV_BUGFIXED                   1  /// Fixed the bug related with mv (2016.2.29)
@@ -418,6 +415,11 @@
 
 #define RDOQ_CHROMA_LAMBDA                                1 ///< F386: weighting of chroma for RDOQ
 
+#define WPP_PARALLEL_CTU_ROWS                             1 ///< encoder only: with WaveFrontSynchro, the CTU rows of a slice are compressed on WppThreads threads
+#define TILE_PARALLEL_COMPRESSION                         1 ///< encoder only: the tiles of a slice are compressed on TileThreads threads
+#define FRAME_PARALLEL_GOP                                1 ///< encoder only: the pictures of a GOP that do not reference each other are compressed on FrameThreads threads
+#define QTBT_PARALLEL_SPLIT                               1 ///< encoder only: the BT-V and QT split candidates of large CUs are compressed on SplitThreads threads after BT-H
+
 // This can be enabled by the makefile
 #ifndef RExt__HIGH_BIT_DEPTH_SUPPORT
 #define RExt__HIGH_BIT_DEPTH_SUPPORT                      0 ///< 0 (default) use data type definitions for 8-10 bit video, 1 = use larger data types to allow for up to 16-bit video (originally developed as part of N0188)
@@ -474,6 +476,22 @@
 #error ERROR: cannot enable RExt__HIGH_PRECISION_FORWARD_TRANSFORM without RExt__HIGH_BIT_DEPTH_SUPPORT
 #endif
 
+#if WPP_PARALLEL_CTU_ROWS && !(JVET_C0024_QTBT && FAST_BIT_EST)
+#error ERROR: WPP_PARALLEL_CTU_ROWS needs the QTBT RD coders with FAST_BIT_EST
+#endif
+
+#if TILE_PARALLEL_COMPRESSION && !WPP_PARALLEL_CTU_ROWS
+#error ERROR: TILE_PARALLEL_COMPRESSION uses the CTU workers of WPP_PARALLEL_CTU_ROWS
+#endif
+
+#if FRAME_PARALLEL_GOP && !WPP_PARALLEL_CTU_ROWS
+#error ERROR: FRAME_PARALLEL_GOP uses the CTU workers of WPP_PARALLEL_CTU_ROWS
+#endif
+
+#if QTBT_PARALLEL_SPLIT && !WPP_PARALLEL_CTU_ROWS
+#error ERROR: QTBT_PARALLEL_SPLIT uses the CTU workers of WPP_PARALLEL_CTU_ROWS
+#endif
+
 // ====================================================================================================================
 // Basic type redefinition
 // ====================================================================================================================
@@ -945,6 +963,8 @@ enum SPSExtensionFlagIndex
   SPS_EXT__REXT           = 0,
 //SPS_EXT__MVHEVC         = 1, //for use in future versions
 //SPS_EXT__SHVC           = 2, //for use in future versions
+  SPS_EXT__KLT            = 6, //sps_extension_6bits[4]: KLT basis derivation
+  SPS_EXT__PIP            = 7, //sps_extension_6bits[5]: PIP tool settings
   NUM_SPS_EXTENSION_FLAGS = 8
 };
 
@@ -1227,11 +1247,11 @@ enum ADDITIONAL_CHROMA_MODE
 
 // ----------------- ACTIVE PARAMETERS ---------------------------
 #define CUMAX						4 // Max CU size for PIP 
-extern int offset4x4;
-extern int offset4x8;
-extern int offset8x4;
-extern int offset8x8;
 #define CU_EXCLUSIVE				0
+#define PIP_SCRATCH_STATS			0 // print the heap allocations and the peak use of the PIP scratch arena
+#define PIP_DPCM_WAVEFRONT			0 // SSE4.1 DPCM of the PIP blocks along the anti-diagonals (needs COM16_C806_SIMD_OPT), bit-exact; used for the 8-wide blocks only, so it only applies to CUMAX 8 (4-wide blocks have at most 2 pixels per diagonal and run the scalar loops)
+#define PIP_STATS					1 // count the PIP CUs, flags and bins for the --pip-stats report; 0 compiles all the counters out
+#define PIP_VERBOSE					0 // trace the PIP syntax of every CU to stdout
 
 #define NO_CBF						1
 
@@ -1240,6 +1260,11 @@ extern int offset8x8;
 #define SRDOQ						1 // Spatial RDOQ
 #if SRDOQ
 #define THREE_LEVELS_RDOQ			0
+#define SRDOQ_INCREMENTAL			1 // re-quantize from the tested pixel only and get the rate from the R1 syntax alone
+#define PIP_PARALLEL_PRED			1 // evaluate the MULTIPLEPRED predictors on a pool of PIPThreads threads
+#define PIP_PARALLEL_MIN_SAMPLES	64 // smallest PIP block whose predictors go to the pool: a 4x4 block takes about 25 us to search, too little to pay the wake-up of the workers
+#define SRDOQ_TIMING				0 // print the PIP search time per block size at the end of encoding
+#define PIP_RATE_EST_CHECK			0 // compare the PIP rate estimate with the full xGetIntraBitsQT rate and print the largest deviation
 #endif
 
 #define USE_RDCOST_PIP				1
@@ -1352,10 +1377,15 @@ extern UInt							lookup_table[TOTALNUMOFSITUATIONS];
 
 #define R1_SIGNPREDICTION			0
 
+#define PIP_R1_HT_BINARIZATION		1 // SPS selectable R1 binarization (PIPR1HighThroughput): two context bins, bypass EG0 remainder, grouped bypass signs
+#if PIP_R1_HT_BINARIZATION && (!CBF2x2 || !SIGN_APART || R1_PREDICTIVE || BITPLANE_R1_CODING || R1_DIRECTCODING || R1_SIGNPREDICTION || NOISE_MARK)
+#error PIP_R1_HT_BINARIZATION needs the CBF2x2 / SIGN_APART R1 syntax
+#endif
+#define PIP_R1_HT_SIGN_GROUP		16 // sign bins per encodeBinsEP / decodeBinsEP call
+
 
 
 #define R1_CODECOEFFNXN_TEST		0
-extern Bool tmpFlag;
 
 #define ADOPT_EMT					0
 
@@ -1388,46 +1418,19 @@ extern double**						Buff_PVQ_N;
 
 
 
-extern Int***						Codebooks; // One codebook of size (CBN*W*H) for each pair <W,H>, where W<=CUMAX && H<=CUMAX
-extern Int***						nextCodebooks;
-extern Int**						nextCodebooksCnt;
-extern Char*						InCBDir, OutCBDir;
 extern Char*						MinResAddress;
-extern Int**						PIPStats;
-extern double**						Rates;
-extern TCoeff						TMPSpR1[16];
-extern Int							cbfStats[4];
 
 extern bool							multipred;
-extern int							spQ;
-extern int							spQ22;
-extern int							spQ27;
-extern int							spQ32;
-extern int							spQ37;
-extern int							deltaSQP;
 
 extern Bool							LGB4x8, LGB8x4, LGB8x8, LGB4x4;
 extern Bool							SpatialCodeCoeffNxN;
-extern Bool							SpatialCodeCoeffNxN_2;
 
-extern Double						totalPIPbits;
-extern Double						totalAllbits;
-extern UInt							Bits1, Bits2;
-extern Bool							maxExceeded;
-extern UInt							sigCnt;
 #define MAXDYN						17
 
-
-extern UInt							EMTlog;
-
 // TEMP
-extern Bool							encodeTime;
-extern Bool							verbose;
+static const Bool					verbose = PIP_VERBOSE != 0; // constant, so the traces are compiled out of the coding loops
 extern Bool							txtWrite;
 extern Bool							PIPMap;
-extern Int							AllCUCount;
-extern Int							PIPValudCUCount;
-extern Int							PIPCUcount;
 extern std::string					InputFileName;
 extern Char							InAddr[512];
 extern Char							OutAddr[512];
@@ -1436,17 +1439,6 @@ extern Bool							CBloopEnable;
 
 extern Bool							firstFrate;
 
-
-extern int m_cCUQtCbfSCModelPIP_counter[5];
-extern int m_cCUPIPflag_counter[5];
-extern int m_cCUR1SpGr_counter[16];
-extern int m_cCUR1SpSign_counter;
-
-extern int m_cCUQtCbfSCModelPIP_ones[5];
-extern int m_cCUPIPflag_ones[5];
-extern int m_cCUR1SpGr_ones[16];
-extern int m_cCUR1SpSign_ones;
-
 #if USE_24CLUSTER_PREDICTOR
 #define clusterCnt		24
 extern unsigned clusterOrder[clusterCnt][4];
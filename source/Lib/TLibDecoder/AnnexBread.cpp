@@ -39,8 +39,10 @@
 
 #include <stdint.h>
 #include <cassert>
+#include <iterator>
 #include <vector>
 #include "AnnexBread.h"
+#include "TLibCommon/TComEmulationPrevention.h"
 #if RExt__DECODER_DEBUG_BIT_STATISTICS
 #include "TLibCommon/TComCodingStatistics.h"
 #endif
@@ -196,4 +198,116 @@ byteStreamNALUnit(
   stats.m_numBytesInNALUnit = UInt(nalUnit.size());
   return eof;
 }
+
+Bool InputByteBuffer::open(const std::string& fileName)
+{
+  m_buffer.clear();
+  if (!m_file.open(fileName))
+  {
+    return false;
+  }
+  m_pData = m_file.getData();
+  m_size  = m_file.getSize();
+  m_pos   = 0;
+  return true;
+}
+
+Void InputByteBuffer::read(istream& istream)
+{
+  m_file.close();
+  m_buffer.assign(istreambuf_iterator<char>(istream), istreambuf_iterator<char>());
+  m_pData = m_buffer.empty() ? NULL : &m_buffer.front();
+  m_size  = m_buffer.size();
+  m_pos   = 0;
+}
+
+Void InputByteBuffer::setBuffer(const uint8_t* pData, size_t size)
+{
+  m_file.close();
+  m_buffer.clear();
+  m_pData = pData;
+  m_size  = size;
+  m_pos   = 0;
+}
+
+/**
+ * Parse the AnnexB bytestream held by bs to locate a single NAL unit, with
+ * the same rules as the istream reader above, while accumulating bytestream
+ * statistics into stats.  rpNalUnit points into the stream.
+ *
+ * Returns true if the end of the stream was reached (NB, the NAL unit may be
+ * valid), otherwise false.
+ */
+Bool
+byteStreamNALUnit(
+  InputByteBuffer& bs,
+  const uint8_t*& rpNalUnit,
+  UInt& rNumBytes,
+  AnnexBStats& stats)
+{
+  const uint8_t* pCur = bs.getData() + bs.getPosition();
+  const uint8_t* pEnd = bs.getData() + bs.getSize();
+#if RExt__DECODER_DEBUG_BIT_STATISTICS
+  TComCodingStatistics::SStat &statBits=TComCodingStatistics::GetStatisticEP(STATS__NAL_UNIT_PACKING);
+  TComCodingStatistics::SStat &bodyStats=TComCodingStatistics::GetStatisticEP(STATS__NAL_UNIT_TOTAL_BODY);
+#endif
+
+  rpNalUnit = NULL;
+  rNumBytes = 0;
+
+  /* leading_zero_8bits and zero_byte up to the next start_code_prefix_one_3bytes */
+  const uint8_t* pPrefix = TComEmulationPrevention::findZeroZeroByte(pCur, pEnd, 1);
+  while (pPrefix != pEnd && pPrefix[2] != 0x01)
+  {
+    pPrefix = TComEmulationPrevention::findZeroZeroByte(pPrefix + 1, pEnd, 1);
+  }
+  if (pPrefix == pEnd)
+  {
+    stats.m_numLeadingZero8BitsBytes += UInt(pEnd - pCur);
+#if RExt__DECODER_DEBUG_BIT_STATISTICS
+    statBits.bits += 8*Int(pEnd - pCur); statBits.count += Int(pEnd - pCur);
+#endif
+    bs.setPosition(bs.getSize());
+    stats.m_numBytesInNALUnit = 0;
+    return true;
+  }
+  UInt numLeading = UInt(pPrefix - pCur);
+  if (numLeading > 0)
+  {
+    assert(pPrefix[-1] == 0);
+    stats.m_numZeroByteBytes++;
+    numLeading--;
+  }
+  stats.m_numLeadingZero8BitsBytes += numLeading;
+  stats.m_numStartCodePrefixBytes  += 3;
+
+  /* the NAL unit ends before the next 0x000000, 0x000001 or 0x000002, or at the end of the stream */
+  const uint8_t* pNalUnit = pPrefix + 3;
+  const uint8_t* pNalEnd  = TComEmulationPrevention::findZeroZeroByte(pNalUnit, pEnd, 2);
+  rpNalUnit = pNalUnit;
+  rNumBytes = UInt(pNalEnd - pNalUnit);
+
+  /* trailing_zero_8bits, leaving the zero_byte of the next start code */
+  const uint8_t* pNext = pNalEnd;
+  while (pNext != pEnd && *pNext == 0)
+  {
+    pNext++;
+  }
+  UInt numTrailing = UInt(pNext - pNalEnd);
+  if (pNext != pEnd)
+  {
+    assert(*pNext == 0x01 && numTrailing >= 2);
+    numTrailing = numTrailing >= 3 ? numTrailing - 3 : 0;
+  }
+  stats.m_numTrailingZero8BitsBytes += numTrailing;
+  stats.m_numBytesInNALUnit = rNumBytes;
+#if RExt__DECODER_DEBUG_BIT_STATISTICS
+  const Int numPackingBytes = Int(pPrefix - pCur) + 3 + Int(numTrailing);
+  statBits.bits += 8*numPackingBytes; statBits.count += numPackingBytes;
+  bodyStats.bits += 8*Int(rNumBytes); bodyStats.count += Int(rNumBytes);
+#endif
+
+  bs.setPosition(size_t(pNalEnd + numTrailing - bs.getData()));
+  return bs.isEof();
+}
 //! \}
@@ -43,9 +43,11 @@
 
 #include <stdint.h>
 #include <istream>
+#include <string>
 #include <vector>
 
 #include "TLibCommon/CommonDef.h"
+#include "TLibCommon/TComMappedFile.h"
 
 //! \ingroup TLibDecoder
 //! \{
@@ -170,6 +172,55 @@ private:
   std::istream& m_Input; /* Input stream to read from */
 };
 
+/**
+ * An Annex B bytestream held in memory: a mapped file, the whole content of
+ * an istream, or a buffer of the caller.  NAL units are located with a
+ * vectorised start code scan and returned as pointers into the stream, so
+ * they are not copied.
+ */
+class InputByteBuffer
+{
+public:
+  InputByteBuffer()
+  : m_pData(NULL)
+  , m_size(0)
+  , m_pos(0)
+  {}
+
+  /**
+   * Map the file read-only.  Returns false if it cannot be mapped (a pipe,
+   * an empty file); read() can then be used instead.
+   */
+  Bool open(const std::string& fileName);
+
+  /** Read the remaining content of istream into an internal buffer. */
+  Void read(std::istream& istream);
+
+  /**
+   * Use size bytes of the caller.  The buffer must outlive the
+   * InputByteBuffer and all the NAL units read from it.
+   */
+  Void setBuffer(const uint8_t* pData, size_t size);
+
+  Bool           isEof      () const      { return m_pos >= m_size; }
+  /** byte offset of the next NAL unit, to return to it with setPosition() */
+  size_t         getPosition() const      { return m_pos; }
+  Void           setPosition(size_t pos)  { assert(pos <= m_size); m_pos = pos; }
+
+  const uint8_t* getData    () const      { return m_pData; }
+  size_t         getSize    () const      { return m_size; }
+
+private:
+  InputByteBuffer(const InputByteBuffer&);
+  InputByteBuffer& operator=(const InputByteBuffer&);
+
+  TComMappedFile       m_file;
+  std::vector<uint8_t> m_buffer;
+  const uint8_t*       m_pData;
+  size_t               m_size;
+  size_t               m_pos;
+};
+
 /**
  * Statistics associated with AnnexB bytestreams
  */
@@ -193,6 +244,7 @@ struct AnnexBStats
 };
 
 Bool byteStreamNALUnit(InputByteStream& bs, std::vector<uint8_t>& nalUnit, AnnexBStats& stats);
+Bool byteStreamNALUnit(InputByteBuffer& bs, const uint8_t*& rpNalUnit, UInt& rNumBytes, AnnexBStats& stats);
 
 //! \}
 
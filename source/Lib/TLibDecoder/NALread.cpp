@@ -44,6 +44,7 @@
 #include "NALread.h"
 #include "TLibCommon/NAL.h"
 #include "TLibCommon/TComBitStream.h"
+#include "TLibCommon/TComEmulationPrevention.h"
 #if RExt__DECODER_DEBUG_BIT_STATISTICS
 #include "TLibCommon/TComCodingStatistics.h"
 #endif
@@ -55,44 +56,31 @@ using namespace std;
 
 //! \ingroup TLibDecoder
 //! \{
-static Void convertPayloadToRBSP(vector<uint8_t>& nalUnitBuf, TComInputBitstream *bitstream, Bool isVclNalUnit)
+/**
+ * write the RBSP of the numBytes of the NAL unit at pNalUnit to nalUnitBuf,
+ * which holds numBytes and may hold the NAL unit itself
+ */
+static Void convertPayloadToRBSP(vector<uint8_t>& nalUnitBuf, const uint8_t* pNalUnit, UInt numBytes, TComInputBitstream *bitstream, Bool isVclNalUnit)
 {
-  UInt zeroCount = 0;
-  vector<uint8_t>::iterator it_read, it_write;
-
-  UInt pos = 0;
-  bitstream->clearEmulationPreventionByteLocation();
-  for (it_read = it_write = nalUnitBuf.begin(); it_read != nalUnitBuf.end(); it_read++, it_write++, pos++)
-  {
-    assert(zeroCount < 2 || *it_read >= 0x03);
-    if (zeroCount == 2 && *it_read == 0x03)
-    {
-      bitstream->pushEmulationPreventionByteLocation( pos );
-      pos++;
-      it_read++;
-      zeroCount = 0;
+  assert(nalUnitBuf.size() >= numBytes);
+  vector<UInt> locations;
+  size_t rbspSize = TComEmulationPrevention::removeThreeBytes(&nalUnitBuf[0], pNalUnit, numBytes, locations);
+  bitstream->setEmulationPreventionByteLocation(locations);
 #if RExt__DECODER_DEBUG_BIT_STATISTICS
-      TComCodingStatistics::IncrementStatisticEP(STATS__EMULATION_PREVENTION_3_BYTES, 8, 0);
-#endif
-      if (it_read == nalUnitBuf.end())
-      {
-        break;
-      }
-      assert(*it_read <= 0x03);
-    }
-    zeroCount = (*it_read == 0x00) ? zeroCount+1 : 0;
-    *it_write = *it_read;
+  for (size_t i = 0; i < locations.size(); i++)
+  {
+    TComCodingStatistics::IncrementStatisticEP(STATS__EMULATION_PREVENTION_3_BYTES, 8, 0);
   }
-  assert(zeroCount == 0);
+#endif
 
   if (isVclNalUnit)
   {
     // Remove cabac_zero_word from payload if present
     Int n = 0;
 
-    while (it_write[-1] == 0x00)
+    while (rbspSize > 0 && nalUnitBuf[rbspSize - 1] == 0x00)
     {
-      it_write--;
+      rbspSize--;
       n++;
     }
 
@@ -102,7 +90,7 @@ static Void convertPayloadToRBSP(vector<uint8_t>& nalUnitBuf, TComInputBitstream
     }
   }
 
-  nalUnitBuf.resize(it_write - nalUnitBuf.begin());
+  nalUnitBuf.resize(rbspSize);
 }
 
 #if ENC_DEC_TRACE && DEC_NUH_TRACE
@@ -177,8 +165,50 @@ Void read(InputNALUnit& nalu)
   TComInputBitstream &bitstream = nalu.getBitstream();
   vector<uint8_t>& nalUnitBuf=bitstream.getFifo();
   // perform anti-emulation prevention
-  convertPayloadToRBSP(nalUnitBuf, &bitstream, (nalUnitBuf[0] & 64) == 0);
+  convertPayloadToRBSP(nalUnitBuf, &nalUnitBuf[0], UInt(nalUnitBuf.size()), &bitstream, (nalUnitBuf[0] & 64) == 0);
   bitstream.resetToStart();
   readNalUnitHeader(nalu);
 }
+
+/**
+ * read a NAL unit held in memory owned by the caller.  Without emulation
+ * prevention bytes the payload is already the RBSP and the bitstream reads it
+ * in place; otherwise it is copied and converted as above.
+ */
+Void read(InputNALUnit& nalu, const uint8_t* pNalUnit, UInt numBytes)
+{
+  TComInputBitstream &bitstream = nalu.getBitstream();
+  const uint8_t* pEnd = pNalUnit + numBytes;
+  assert(numBytes > 0);
+
+  if (TComEmulationPrevention::findZeroZeroByte(pNalUnit, pEnd, 0x03) != pEnd)
+  {
+    vector<uint8_t>& nalUnitBuf = bitstream.getFifo();
+    nalUnitBuf.resize(numBytes);
+    convertPayloadToRBSP(nalUnitBuf, pNalUnit, numBytes, &bitstream, (pNalUnit[0] & 64) == 0);
+    bitstream.resetToStart();
+    readNalUnitHeader(nalu);
+    return;
+  }
+
+  bitstream.clearEmulationPreventionByteLocation();
+  if ((pNalUnit[0] & 64) == 0)
+  {
+    // Remove cabac_zero_word from payload if present
+    Int n = 0;
+
+    while (pEnd[-1] == 0x00)
+    {
+      pEnd--;
+      n++;
+    }
+
+    if (n > 0)
+    {
+      printf("\nDetected %d instances of cabac_zero_word\n", n/2);
+    }
+  }
+  bitstream.setView(pNalUnit, UInt(pEnd - pNalUnit));
+  readNalUnitHeader(nalu);
+}
 //! \}
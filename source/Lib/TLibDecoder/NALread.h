@@ -66,6 +66,7 @@ class InputNALUnit : public NALUnit
 };
 
 Void read(InputNALUnit& nalu);
+Void read(InputNALUnit& nalu, const uint8_t* pNalUnit, UInt numBytes);
 Void readNalUnitHeader(InputNALUnit& nalu);
 
 //! \}
@@ -112,10 +112,6 @@ Void TDecBinCABAC::decodeBin( UInt& ruiBin, ContextModel &rcCtxModel )
   UShort uiLPS = TComCABACTables::sm_aucLPSTable[rcCtxModel.getState()>>6][(m_uiRange>>2)-64];
   m_uiRange -= uiLPS;
   UInt scaledRange = m_uiRange << 7;
-#if PIP
-  if (verbose && false)
-	  cout << "(m_uiValue:" << (int)m_uiValue << "/scaledRange:" << (int)scaledRange << ")";
-#endif
   if( m_uiValue < scaledRange )
   {
     // MPS path
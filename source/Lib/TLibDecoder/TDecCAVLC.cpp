@@ -957,6 +957,18 @@ Void TDecCavlc::parseSPS(TComSPS* pcSPS)
               READ_FLAG( uiCode, "cabac_bypass_alignment_enabled_flag");      spsRangeExtension.setCabacBypassAlignmentEnabledFlag  (uiCode != 0);
             }
             break;
+#if VCEG_AZ08_KLT_COMMON && KLT_DETERMINISTIC_BASIS
+          case SPS_EXT__KLT:
+            assert(!bSkipTrailingExtensionBits);
+            READ_FLAG( uiCode, "klt_deterministic_basis_flag");               pcSPS->setKLTDeterministicBasisFlag(uiCode != 0);
+            break;
+#endif
+#if PIP_R1_HT_BINARIZATION
+          case SPS_EXT__PIP:
+            assert(!bSkipTrailingExtensionBits);
+            READ_FLAG( uiCode, "pip_r1_high_throughput_flag");                pcSPS->setPIPR1HighThroughputFlag(uiCode != 0);
+            break;
+#endif
           default:
             bSkipTrailingExtensionBits=true;
             break;
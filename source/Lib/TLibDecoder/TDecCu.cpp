@@ -49,7 +49,6 @@ extern UInt g_uiDepth2IntraTempSize[5];
 #endif
 
 #if PIP
-Bool verbose = false;
 Bool PIPMap = true;
 #endif
 // ====================================================================================================================
@@ -209,13 +208,8 @@ Void TDecCu::create( UInt uiMaxDepth, UInt uiMaxWidth, UInt uiMaxHeight, ChromaF
   m_bDecodeDQP = false;
   m_IsChromaQpAdjCoded = false;
 
-  // initialize partition order.
-  UInt* piTmp = &g_auiZscanToRaster[0];
-  initZscanToRaster(m_uiMaxDepth, 1, 0, piTmp);
-  initRasterToZscan( uiMaxWidth, uiMaxHeight, m_uiMaxDepth );
-
-  // initialize conversion matrix from partition index to pel
-  initRasterToPelXY( uiMaxWidth, uiMaxHeight, m_uiMaxDepth );
+  // initialize partition order and conversion matrix from partition index to pel
+  initPartitionOrder( uiMaxWidth, uiMaxHeight, m_uiMaxDepth );
 }
 
 Void TDecCu::destroy()
@@ -1473,7 +1467,8 @@ TDecCu::xIntraRecBlk(       TComYuv*    pcRecoYuv,
 #if PIP
   //===== fetch R1 from the codebook ====
   Int		CUSizeCBIdx		  = (log2(uiHeight) - 2) * (log2((UInt)CUMAX) - 1) + (log2(uiWidth) - 2);
-  Pel		*R1				  = (Pel*)xMalloc(Pel, uiWidth*uiHeight*sizeof(Pel));
+  TComScratchScope scratchScope(m_pcPrediction->getPIPArena());
+  Pel		*R1				  = m_pcPrediction->getPIPArena().alloc<Pel>(uiWidth*uiHeight);
   if (isPIP)
 	  for (UInt r1j = 0; r1j < uiWidth*uiHeight; r1j++)
 		  R1[r1j] = spQR1[r1j];
@@ -1636,10 +1631,6 @@ TDecCu::xIntraRecBlk(       TComYuv*    pcRecoYuv,
   }
 
 
-#if PIP
-  
-  // _aligned_free(R1);
-#endif
 }
 
 #if VCEG_AZ08_INTRA_KLT
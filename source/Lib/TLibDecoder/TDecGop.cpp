@@ -370,7 +370,7 @@ Void TDecGop::filterPicture(TComPic* pcPic)
   if (pcSlice->getSPS()->getUseInterKLT())
   {
 #endif
-      m_pcSliceDecoder->InterpolatePic(pcPic);
+      pcPic->resetSubPelCache();
 #if VCEG_AZ08_USE_KLT
   }
 #endif
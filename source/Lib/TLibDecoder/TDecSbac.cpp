@@ -142,6 +142,8 @@ TDecSbac::TDecSbac()
 , m_cCUAffineFlagSCModel                     ( 1,             1,               NUM_AFFINE_FLAG_CTX                  , m_contextModels + m_numContextModels,          m_numContextModels)
 // PIP context models
 #if PIP
+, m_pcPIPContext								(NULL)
+, m_pcPIPStats								(NULL)
 , m_cCUQtCbfSCModelPIP						(1, 1, NUM_QT_CBF_CTX_PER_SET, m_contextModels + m_numContextModels, m_numContextModels)
 , m_cCUSigCoeffGroupSCModelPIP				(1, 2, NUM_SIG_CG_FLAG_CTX, m_contextModels + m_numContextModels, m_numContextModels)
 , m_cCUSigSCModelPIP						(1, 1, NUM_SIG_FLAG_CTX, m_contextModels + m_numContextModels, m_numContextModels) // NUM_SIG_FLAG_CTX_LUMA instead of NUM_SIG_FLAG_CTX
@@ -300,26 +302,26 @@ Void TDecSbac::resetEntropy(TComSlice* pSlice)
   /*FILE *fout = fopen("logState.txt", "a");
   if (fout && !firstFrate && false)
   {	  
-	  fprintf(fout, "%1.3f (%6d)\t", (m_cCUQtCbfSCModelPIP_counter[1] ? (float)m_cCUQtCbfSCModelPIP_ones[1] / (float(m_cCUQtCbfSCModelPIP_counter[1])) : 0), m_cCUQtCbfSCModelPIP_counter[1]);
-	  fprintf(fout, "%1.3f (%6d)\t", (m_cCUPIPflag_counter[0] ? (float)m_cCUPIPflag_ones[0] / (float(m_cCUPIPflag_counter[0])) : 0), m_cCUPIPflag_counter[0]);
+	  fprintf(fout, "%1.3f (%6d)\t", (m_pcPIPStats->qtCbfBins[1] ? (float)m_pcPIPStats->qtCbfOnes[1] / (float(m_pcPIPStats->qtCbfBins[1])) : 0), m_pcPIPStats->qtCbfBins[1]);
+	  fprintf(fout, "%1.3f (%6d)\t", (m_pcPIPStats->pipFlagBins[0] ? (float)m_pcPIPStats->pipFlagOnes[0] / (float(m_pcPIPStats->pipFlagBins[0])) : 0), m_pcPIPStats->pipFlagBins[0]);
 
 
 	  for (int c = 0; c < 16; c++)
-		  fprintf(fout, "%1.3f (%6d)\t", (m_cCUR1SpGr_counter[c] ? (float)m_cCUR1SpGr_ones[c] / (float)m_cCUR1SpGr_counter[c] : 0), m_cCUR1SpGr_counter[c]);
+		  fprintf(fout, "%1.3f (%6d)\t", (m_pcPIPStats->r1GrBins[c] ? (float)m_pcPIPStats->r1GrOnes[c] / (float)m_pcPIPStats->r1GrBins[c] : 0), m_pcPIPStats->r1GrBins[c]);
 	  
-	  fprintf(fout, "%1.3f (%6d)\n", (m_cCUR1SpSign_counter ? (float)m_cCUR1SpSign_ones / (float)m_cCUR1SpSign_counter : 0), m_cCUR1SpSign_counter);
+	  fprintf(fout, "%1.3f (%6d)\n", (m_pcPIPStats->r1SignBins ? (float)m_pcPIPStats->r1SignOnes / (float)m_pcPIPStats->r1SignBins : 0), m_pcPIPStats->r1SignBins);
 	  
 	  fclose(fout);
 	  
-	  memset(m_cCUQtCbfSCModelPIP_counter, 0, 5 * sizeof(int));
-	  memset(m_cCUPIPflag_counter, 0, 5 * sizeof(int));
-	  memset(m_cCUR1SpGr_counter, 0, 16 * sizeof(int));
-	  m_cCUR1SpSign_counter = 0;
+	  memset(m_pcPIPStats->qtCbfBins, 0, 5 * sizeof(int));
+	  memset(m_pcPIPStats->pipFlagBins, 0, 5 * sizeof(int));
+	  memset(m_pcPIPStats->r1GrBins, 0, 16 * sizeof(int));
+	  m_pcPIPStats->r1SignBins = 0;
 
-	  memset(m_cCUQtCbfSCModelPIP_ones, 0, 5 * sizeof(int));
-	  memset(m_cCUPIPflag_ones, 0, 5 * sizeof(int));
-	  memset(m_cCUR1SpGr_ones, 0, 16 * sizeof(int));
-	  m_cCUR1SpSign_ones = 0;
+	  memset(m_pcPIPStats->qtCbfOnes, 0, 5 * sizeof(int));
+	  memset(m_pcPIPStats->pipFlagOnes, 0, 5 * sizeof(int));
+	  memset(m_pcPIPStats->r1GrOnes, 0, 16 * sizeof(int));
+	  m_pcPIPStats->r1SignOnes = 0;
   }
   
 
@@ -1443,8 +1445,7 @@ Void TDecSbac::parsePIPflag(TComDataCU* pcCU, UInt uiAbsPartIdx, const UInt uiDe
 	m_pcTDecBinIf->decodeBin(uiSymbol, m_cCUPIPflag.get(0, 0, CtxIdx) RExt__DECODER_DEBUG_BIT_STATISTICS_PASS_OPT_ARG(STATS__CABAC_BITS__PRED_MODE));
 
 	// prob stats
-	m_cCUPIPflag_counter[CtxIdx]++;
-	m_cCUPIPflag_ones[CtxIdx] += uiSymbol;
+	PIPStatsPolicy::addBin(m_pcPIPStats->pipFlagBins[CtxIdx], m_pcPIPStats->pipFlagOnes[CtxIdx], uiSymbol);
 
 	if (verbose)
 		cout << ",PIP:" << (Int)uiSymbol;
@@ -1474,12 +1475,12 @@ Void TDecSbac::parsePIPflag(TComDataCU* pcCU, UInt uiAbsPartIdx, const UInt uiDe
 		}
 #endif
 		// Decode R1 
-		int tmp_spQ = spQ;
+		int tmp_spQ = m_pcPIPContext->getSpQ();
 #if SP_QCHANGE
 		if (spQIsChanged)
 		{
-			spQ += (spQChange == 0 ? -1 : 1) * SP_QOFFSET;
-			spQ = max(spQ, 1);
+			m_pcPIPContext->setSpQ(m_pcPIPContext->getSpQ() + (spQChange == 0 ? -1 : 1) * SP_QOFFSET);
+			m_pcPIPContext->setSpQ(max(m_pcPIPContext->getSpQ(), 1));
 		}
 
 #if SP_QCHANGE
@@ -1502,29 +1503,29 @@ Void TDecSbac::parsePIPflag(TComDataCU* pcCU, UInt uiAbsPartIdx, const UInt uiDe
 #endif
 		int offset_temp = 0;
 #if CBF2x2
-		int *cbfMap = (int*)xMalloc(int, w*h*sizeof(int));
+		int cbfMap[CUMAX*CUMAX];
 		if (w == 4 && h == 4)
 		{
 			memcpy(cbfMap, cbfMap4x4, w*h*sizeof(int));
-			offset_temp = offset4x4;
+			offset_temp = m_pcPIPContext->getSpQOffset(4, 4);
 		}
 		if (w == 4 && h == 8)
 		{
 			memcpy(cbfMap, cbfMap4x8, w*h*sizeof(int));
-			offset_temp = offset4x8;
+			offset_temp = m_pcPIPContext->getSpQOffset(4, 8);
 		}
 		if (w == 8 && h == 4)
 		{
 			memcpy(cbfMap, cbfMap8x4, w*h*sizeof(int));
-			offset_temp = offset8x4;
+			offset_temp = m_pcPIPContext->getSpQOffset(8, 4);
 		}
 		if (w == 8 && h == 8)
 		{
 			memcpy(cbfMap, cbfMap8x8, w*h*sizeof(int));
-			offset_temp = offset8x8;
+			offset_temp = m_pcPIPContext->getSpQOffset(8, 8);
 		}
 
-		int *cbf2x2BlMap = (int*)xMalloc(int, w*h*sizeof(int) / 4);
+		int cbf2x2BlMap[CUMAX*CUMAX];
 		if (w == 4 && h == 4)
 			memcpy(cbf2x2BlMap, cbf2x2BlMap4x4, w*h*sizeof(int));
 		if (w == 4 && h == 8)
@@ -1535,7 +1536,7 @@ Void TDecSbac::parsePIPflag(TComDataCU* pcCU, UInt uiAbsPartIdx, const UInt uiDe
 			memcpy(cbf2x2BlMap, cbf2x2BlMap8x8, w*h*sizeof(int));
 
 		// Bool cbfException[16];
-		Bool *cbfException = (Bool*)xMalloc(Bool, w*h*sizeof(Bool));
+		Bool cbfException[CUMAX*CUMAX];
 		memset(cbfException, 0, w*h * sizeof(Bool));
 
 
@@ -1543,7 +1544,7 @@ Void TDecSbac::parsePIPflag(TComDataCU* pcCU, UInt uiAbsPartIdx, const UInt uiDe
 
 
 		// UInt cbf2x2[4] = { 0, 0, 0, 0};
-		UInt *cbf2x2 = (UInt*)xMalloc(UInt, w*h*sizeof(UInt) / 4);
+		UInt cbf2x2[CUMAX*CUMAX / 4];
 		memset(cbf2x2, 0, w*h*sizeof(UInt) / 4);
 
 		UInt symbolCBF;
@@ -1554,7 +1555,7 @@ Void TDecSbac::parsePIPflag(TComDataCU* pcCU, UInt uiAbsPartIdx, const UInt uiDe
 			cbf2x2[cg] = symbolCBF;
 		}
 #endif
-		int qStep = spQ + offset_temp;
+		int qStep = m_pcPIPContext->getSpQ() + offset_temp;
 		int* spQR1_decode;
 		TComTURecurse rTu(pcCU, uiAbsPartIdx, uiDepth);
 		spQR1_decode = pcCU->getR1SpQn(COMPONENT_Y) + rTu.getCoefficientOffset(COMPONENT_Y);
@@ -1567,6 +1568,15 @@ Void TDecSbac::parsePIPflag(TComDataCU* pcCU, UInt uiAbsPartIdx, const UInt uiDe
 
 
 
+#if PIP_R1_HT_BINARIZATION
+		if (m_pcPIPContext->getR1HighThroughput())
+		{
+			// amplitudes and signs
+			xParseR1HighThroughput(spQR1_decode, w, h, qStep, cbf2x2, cbfMap, cbf2x2BlMap);
+		}
+		else
+		{
+#endif
 #if R1_PREDICTIVE
 		UInt sign = 0;
 		UInt left, top, topleft, sum;
@@ -1581,9 +1591,9 @@ Void TDecSbac::parsePIPflag(TComDataCU* pcCU, UInt uiAbsPartIdx, const UInt uiDe
 					top			= j			? abs(spQR1_decode[(j - 1)*w + i])		: left;
 					topleft		= (i && j)	? abs(spQR1_decode[(j - 1)*w + i - 1])	: left;
 
-					left /= spQ;
-					top /= spQ;
-					topleft /= spQ;
+					left /= m_pcPIPContext->getSpQ();
+					top /= m_pcPIPContext->getSpQ();
+					topleft /= m_pcPIPContext->getSpQ();
 				}
 
 #if CBF2x2
@@ -1661,7 +1671,7 @@ Void TDecSbac::parsePIPflag(TComDataCU* pcCU, UInt uiAbsPartIdx, const UInt uiDe
 #if CBF2x2
 				} // if (cbf2x2[cbfMap4x4[j*w + i]])
 #endif
-				spQR1_decode[j*w + i] = ampl * spQ * (sign ? -1 : 1);
+				spQR1_decode[j*w + i] = ampl * m_pcPIPContext->getSpQ() * (sign ? -1 : 1);
 			}
 
 #else
@@ -1708,8 +1718,7 @@ Void TDecSbac::parsePIPflag(TComDataCU* pcCU, UInt uiAbsPartIdx, const UInt uiDe
 
 						m_pcTDecBinIf->decodeBin(symbol, m_cCUR1SpGr.get(0, 0, ampl));
 						// CABAC prob stats
-						m_cCUR1SpGr_counter[ampl]++;
-						m_cCUR1SpGr_ones[ampl] += symbol;
+						PIPStatsPolicy::addBin(m_pcPIPStats->r1GrBins[ampl], m_pcPIPStats->r1GrOnes[ampl], symbol);
 					}
 					ampl++;
 					
@@ -1729,12 +1738,6 @@ Void TDecSbac::parsePIPflag(TComDataCU* pcCU, UInt uiAbsPartIdx, const UInt uiDe
 #endif // else #if R1_PREDICTIVE
 
 		
-#if CBF2x2
-		_aligned_free(cbfException);
-		_aligned_free(cbfMap);
-		_aligned_free(cbf2x2BlMap);
-		_aligned_free(cbf2x2);
-#endif
 
 #if SIGN_APART
 		int prevSign = 0;
@@ -1765,8 +1768,7 @@ Void TDecSbac::parsePIPflag(TComDataCU* pcCU, UInt uiAbsPartIdx, const UInt uiDe
 				// cout << mark << "\t";
 #endif
 				// CABAC prob stats
-				m_cCUR1SpSign_counter++;
-				m_cCUR1SpSign_ones += sign;
+				PIPStatsPolicy::addBin(m_pcPIPStats->r1SignBins, m_pcPIPStats->r1SignOnes, sign);
 
 				spQR1_decode[p] *= (sign ? -1 : 1);
 			}
@@ -1775,7 +1777,10 @@ Void TDecSbac::parsePIPflag(TComDataCU* pcCU, UInt uiAbsPartIdx, const UInt uiDe
 		
 					
 #endif
-		spQ = tmp_spQ;
+#if PIP_R1_HT_BINARIZATION
+		} // if (m_pcPIPContext->getR1HighThroughput())
+#endif
+		m_pcPIPContext->setSpQ(tmp_spQ);
 		
 #if MULTIPLEPRED
 		int predictor = 0;
@@ -1805,6 +1810,74 @@ Void TDecSbac::parsePIPflag(TComDataCU* pcCU, UInt uiAbsPartIdx, const UInt uiDe
 	
 }
 
+#if PIP_R1_HT_BINARIZATION
+/** R1 of the high-throughput binarization (SPS pip_r1_high_throughput_flag), see TEncSbac::codeR1_highThroughput:
+ *  the greater than 0 / greater than 1 context bins of the block, then the bypass EG0 remainders, then the
+ *  signs of the non-zero samples, read PIP_R1_HT_SIGN_GROUP bins at a time.
+ */
+Void TDecSbac::xParseR1HighThroughput(Int* spQR1, Int w, Int h, Int qStep, const UInt* cbf2x2, const Int* cbfMap, const Int* cbf2x2BlMap)
+{
+	Int ampl[CUMAX*CUMAX];
+	memset(ampl, 0, w*h * sizeof(Int));
+
+	Int numSigns = 0;
+	UInt symbol;
+	for (Int p = 0; p < w*h; p++)
+	{
+		const Int blk2x2 = cbfMap[p];
+		if (!cbf2x2[blk2x2])
+			continue;
+
+		// the greater than 0 bin is derivable for the last sample of a 2x2 group with the other three zero
+		Bool isException = cbf2x2BlMap[blk2x2 * 4 + 3] == p;
+		for (Int cf = 0; cf < 3 && isException; cf++)
+			isException = ampl[cbf2x2BlMap[blk2x2 * 4 + cf]] == 0;
+
+		symbol = 1;
+		if (!isException)
+		{
+			m_pcTDecBinIf->decodeBin(symbol, m_cCUR1SpGr.get(0, 0, 0) RExt__DECODER_DEBUG_BIT_STATISTICS_PASS_OPT_ARG(STATS__CABAC_BITS__PRED_MODE));
+			PIPStatsPolicy::addBin(m_pcPIPStats->r1GrBins[0], m_pcPIPStats->r1GrOnes[0], symbol);
+		}
+		if (symbol)
+		{
+			m_pcTDecBinIf->decodeBin(symbol, m_cCUR1SpGr.get(0, 0, 1) RExt__DECODER_DEBUG_BIT_STATISTICS_PASS_OPT_ARG(STATS__CABAC_BITS__PRED_MODE));
+			PIPStatsPolicy::addBin(m_pcPIPStats->r1GrBins[1], m_pcPIPStats->r1GrOnes[1], symbol);
+			ampl[p] = 1 + symbol;
+			numSigns++;
+		}
+	}
+
+	for (Int p = 0; p < w*h; p++)
+	{
+		if (ampl[p] > 1)
+		{
+			xReadEpExGolomb(symbol, 0 RExt__DECODER_DEBUG_BIT_STATISTICS_PASS_OPT_ARG(STATS__CABAC_BITS__PRED_MODE));
+			ampl[p] += symbol;
+		}
+		spQR1[p] = ampl[p] * qStep;
+	}
+
+	Int p = 0;
+	while (numSigns > 0)
+	{
+		const Int numBins = min(numSigns, PIP_R1_HT_SIGN_GROUP);
+		UInt signBins;
+		m_pcTDecBinIf->decodeBinsEP(signBins, numBins RExt__DECODER_DEBUG_BIT_STATISTICS_PASS_OPT_ARG(STATS__CABAC_BITS__PRED_MODE));
+		for (Int bin = numBins - 1; bin >= 0; bin--, p++)
+		{
+			while (!ampl[p])
+				p++;
+			const UInt sign = (signBins >> bin) & 1;
+			PIPStatsPolicy::addBin(m_pcPIPStats->r1SignBins, m_pcPIPStats->r1SignOnes, sign);
+			if (sign)
+				spQR1[p] = -spQR1[p];
+		}
+		numSigns -= numBins;
+	}
+}
+#endif
+
 
 
 
@@ -2684,8 +2757,7 @@ Void TDecSbac::parseQtCbf( TComTU &rTu, const ComponentID compID, const Bool low
 #else
 		m_pcTDecBinIf->decodeBin(uiCbf, m_cCUQtCbfSCModelPIP.get(0, contextSet, uiCtx) RExt__DECODER_DEBUG_BIT_STATISTICS_PASS_OPT_ARG(TComCodingStatisticsClassType(STATS__CABAC_BITS__QT_CBF, g_aucConvertToBit[rTu.getRect(compID).width] + 2, compID)));
 		// stats
-		m_cCUQtCbfSCModelPIP_counter[uiCtx]++;
-		m_cCUQtCbfSCModelPIP_ones[uiCtx] += uiCbf;
+		PIPStatsPolicy::addBin(m_pcPIPStats->qtCbfBins[uiCtx], m_pcPIPStats->qtCbfOnes[uiCtx], uiCbf);
 #endif
 	}
 	else
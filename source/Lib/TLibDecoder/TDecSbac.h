@@ -49,6 +49,9 @@
 #include "TLibCommon/ContextTables.h"
 #include "TLibCommon/ContextModel.h"
 #include "TLibCommon/ContextModel3DBuffer.h"
+#if PIP
+#include "TLibCommon/TComPIPContext.h"
+#endif
 
 //! \ingroup TLibDecoder
 //! \{
@@ -74,6 +77,9 @@ public:
 
   Void  init                      ( TDecBinIf* p )    { m_pcTDecBinIf = p; }
   Void  uninit                    (              )    { m_pcTDecBinIf = 0; }
+#if PIP
+  Void  setPIPContext             ( TComPIPContext* p, Int threadId = 0 ) { m_pcPIPContext = p; m_pcPIPStats = p->getThreadStats( threadId ); }
+#endif
 
   Void load                       ( const TDecSbac* pSrc );
   Void loadContexts               ( const TDecSbac* pSrc );
@@ -163,6 +169,9 @@ public:
 
 #if PIP
   Void parsePIPflag		  (TComDataCU* pcCU, UInt uiAbsPartIdx, const UInt uiDepth);
+#if PIP_R1_HT_BINARIZATION
+  Void xParseR1HighThroughput(Int* spQR1, Int w, Int h, Int qStep, const UInt* cbf2x2, const Int* cbfMap, const Int* cbf2x2BlMap);
+#endif
 #endif
 
   Void parsePredMode      ( TComDataCU* pcCU, UInt uiAbsPartIdx, UInt uiDepth );
@@ -328,6 +337,8 @@ private:
 #endif
 
 #if PIP // PIP context model separation
+  TComPIPContext*      m_pcPIPContext;
+  TComPIPStats*        m_pcPIPStats;
   ContextModel3DBuffer m_cCUQtCbfSCModelPIP;
   ContextModel3DBuffer m_cCUSigCoeffGroupSCModelPIP;
   ContextModel3DBuffer m_cCUSigSCModelPIP;
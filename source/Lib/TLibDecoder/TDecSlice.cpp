@@ -298,11 +298,4 @@ Void TDecSlice::decompressSlice(TComInputBitstream** ppcSubstreams, TComPic* pcP
   }
 
 }
-
-#if VCEG_AZ08_INTER_KLT
-Void TDecSlice::InterpolatePic(TComPic* pcPic)
-{
-    m_pcCuDecoder->getPointerPrediction()->interpolatePic(pcPic);
-}
-#endif
 //! \}
\ No newline at end of file
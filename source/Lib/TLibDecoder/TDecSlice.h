@@ -81,9 +81,6 @@ public:
     , ALFParam & alfParam
 #endif
     );
-#if VCEG_AZ08_INTER_KLT
-  Void InterpolatePic    ( TComPic* pcPic );
-#endif
 };
 
 //! \}
@@ -133,6 +133,10 @@ Void TDecTop::init()
     &m_cSAO);
   m_cSliceDecoder.init( &m_cEntropyDecoder, &m_cCuDecoder );
   m_cEntropyDecoder.init(&m_cPrediction);
+#if PIP
+  m_cPrediction.setPIPContext( &m_cPIPContext );
+  m_cSbacDecoder.setPIPContext( &m_cPIPContext );
+#endif
 }
 
 Void TDecTop::deletePicBuffer ( )
@@ -228,6 +232,9 @@ Void TDecTop::executeLoopFilters(Int& poc, TComList<TComPic*>*& rpcListPic)
   rpcListPic          = &m_cListPic;
   m_cCuDecoder.destroy();
   m_bFirstSliceInPicture  = true;
+#if PIP
+  m_cPIPContext.mergePictureStats();
+#endif
 
   return;
 }
@@ -364,25 +371,14 @@ Void TDecTop::xActivateParameterSets()
     m_cSAO.create( sps->getPicWidthInLumaSamples(), sps->getPicHeightInLumaSamples(), sps->getChromaFormatIdc(), sps->getMaxCUWidth(), sps->getMaxCUHeight(), sps->getMaxTotalCUDepth(), pps->getPpsRangeExtension().getLog2SaoOffsetScale(CHANNEL_TYPE_LUMA), pps->getPpsRangeExtension().getLog2SaoOffsetScale(CHANNEL_TYPE_CHROMA) );
 #endif
     m_cLoopFilter.create( sps->getMaxTotalCUDepth() );
+#if PIP_R1_HT_BINARIZATION
+    m_cPIPContext.setR1HighThroughput( sps->getPIPR1HighThroughputFlag() );
+#endif
 #if COM16_C806_LMCHROMA
     m_cPrediction.initTempBuff(sps->getChromaFormatIdc(), sps->getBitDepth(CHANNEL_TYPE_LUMA)
-#if VCEG_AZ08_INTER_KLT
-#if JVET_C0024_QTBT
-      , sps->getUseInterKLT() , sps->getPicWidthInLumaSamples() , sps->getPicHeightInLumaSamples() , sps->getCTUSize() , sps->getCTUSize() , sps->getMaxTotalCUDepth()
-#else
-      , sps->getUseInterKLT() , sps->getPicWidthInLumaSamples() , sps->getPicHeightInLumaSamples() , sps->getMaxCUWidth() , sps->getMaxCUHeight() , sps->getMaxTotalCUDepth()
-#endif
-#endif
       );
 #else
     m_cPrediction.initTempBuff(sps->getChromaFormatIdc()
-#if VCEG_AZ08_INTER_KLT
-#if JVET_C0024_QTBT
-      , sps->getUseInterKLT() , sps->getPicWidthInLumaSamples() , sps->getPicHeightInLumaSamples() , sps->getCTUSize() , sps->getCTUSize() , sps->getMaxTotalCUDepth()
-#else
-      , sps->getUseInterKLT() , sps->getPicWidthInLumaSamples() , sps->getPicHeightInLumaSamples() , sps->getMaxCUWidth() , sps->getMaxCUHeight() , sps->getMaxTotalCUDepth()
-#endif
-#endif
       );
 #endif
 
@@ -429,6 +425,9 @@ Void TDecTop::xActivateParameterSets()
 #endif
         );
 #endif
+#if VCEG_AZ08_KLT_COMMON && KLT_DETERMINISTIC_BASIS
+    m_cTrQuant.setDeterministicKLTBasis( sps->getKLTDeterministicBasisFlag() );
+#endif
 
     m_cSliceDecoder.create();
   }
@@ -37,6 +37,7 @@
 
 #include "TLibCommon/NAL.h"
 #include "TLibCommon/TComBitStream.h"
+#include "TLibCommon/TComEmulationPrevention.h"
 #include "NALwrite.h"
 
 using namespace std;
@@ -44,8 +45,6 @@ using namespace std;
 //! \ingroup TLibEncoder
 //! \{
 
-static const Char emulation_prevention_three_byte[] = {3};
-
 Void writeNalUnitHeader(ostream& out, OutputNALUnit& nalu)       // nal_unit_header()
 {
 TComOutputBitstream bsNALUHeader;
@@ -85,40 +84,16 @@ Void write(ostream& out, OutputNALUnit& nalu)
    *  - 0x00000303
    */
   vector<uint8_t>& rbsp   = nalu.m_Bitstream.getFIFO();
-
-  vector<uint8_t> outputBuffer;
-  outputBuffer.resize(rbsp.size()*2+1); //there can never be enough emulation_prevention_three_bytes to require this much space
-  std::size_t outputAmount = 0;
-  Int         zeroCount    = 0;
-  for (vector<uint8_t>::iterator it = rbsp.begin(); it != rbsp.end(); it++)
+  if (rbsp.empty())
   {
-    const uint8_t v=(*it);
-    if (zeroCount==2 && v<=3)
-    {
-      outputBuffer[outputAmount++]=emulation_prevention_three_byte[0];
-      zeroCount=0;
-    }
-
-    if (v==0)
-    {
-      zeroCount++;
-    }
-    else
-    {
-      zeroCount=0;
-    }
-    outputBuffer[outputAmount++]=v;
+    return;
   }
 
-  /* 7.4.1.1
-   * ... when the last byte of the RBSP data is equal to 0x00 (which can
+  /* ... when the last byte of the RBSP data is equal to 0x00 (which can
    * only occur when the RBSP ends in a cabac_zero_word), a final byte equal
-   * to 0x03 is appended to the end of the data.
-   */
-  if (zeroCount>0)
-  {
-    outputBuffer[outputAmount++]=emulation_prevention_three_byte[0];
-  }
+   * to 0x03 is appended to the end of the data (7.4.1.1). */
+  vector<uint8_t> outputBuffer(TComEmulationPrevention::maxInsertSize(rbsp.size()));
+  const std::size_t outputAmount = TComEmulationPrevention::insertThreeBytes(&outputBuffer[0], &rbsp[0], rbsp.size());
   out.write((Char*)&(*outputBuffer.begin()), outputAmount);
 }
 
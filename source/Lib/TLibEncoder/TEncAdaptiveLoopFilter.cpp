@@ -3204,12 +3204,12 @@ Void   TEncAdaptiveLoopFilter::xstoreInBlockMatrix(imgpel* ImgOrg, imgpel* ImgDe
 Void   TEncAdaptiveLoopFilter::xFilteringFrameLuma_qc(imgpel* ImgOrg, imgpel* imgY_pad, imgpel* ImgFilt, ALFParam* ALFp, Int tap, Int Stride, const TComSlice * pSlice)
 {
 #if JVET_C0038_GALF
-  static Double **y_temp, **y_temp9x9;  
-  static Int first = 0;
+  static thread_local Double **y_temp, **y_temp9x9;  
+  static thread_local Int first = 0;
 #endif
 
   int  filtNo,filters_per_fr;
-  static double **ySym, ***ESym;
+  static thread_local double **ySym, ***ESym;
   int lambda_val = (Int) m_dLambdaLuma;
   lambda_val = lambda_val * (1<<(2*m_nBitIncrement));
   if (tap==9)
@@ -3529,9 +3529,9 @@ Void TEncAdaptiveLoopFilter::xfindBestFilterVarPred(Double **ySym, Double ***ESy
  
   Double  error, lambda, lagrangian, lagrangianMin; 
     
-  static Int first = 0;
-  static Double ***E_temp, *pixAcc_temp;
-  static Int **FilterCoeffQuantTemp;
+  static thread_local Int first = 0;
+  static thread_local Double ***E_temp, *pixAcc_temp;
+  static thread_local Int **FilterCoeffQuantTemp;
  
   lambda = lambda_val;
   sqrFiltLength=m_MAX_SQR_FILT_LENGTH;
@@ -3567,7 +3567,7 @@ Void TEncAdaptiveLoopFilter::xfindBestFilterVarPred(Double **ySym, Double ***ESy
 
   Bool forceCoeff0, codedVarBins[m_NO_VAR_BINS];
   Char iFixedFilters = m_tempALFp->iAvailableFilters;
-  static Char usePrevFiltBest[m_NO_VAR_BINS];
+  static thread_local Char usePrevFiltBest[m_NO_VAR_BINS];
   Double errorForce0CoeffTab[m_NO_VAR_BINS][2];
 
   xfindBestFilterPredictor(E_temp, y_temp, pixAcc_temp, filtNo, pSlice, ImgOrg, ImgDec, Stride, &forceCoeff0,
@@ -3641,8 +3641,8 @@ Void TEncAdaptiveLoopFilter::xfindBestFilterVarPred(double **ySym, double ***ESy
   int filters_per_fr, firstFilt, forceCoeff0,
   interval[m_NO_VAR_BINS][2], intervalBest[m_NO_VAR_BINS][2];
   int i, k, varInd;
-  static double ***E_temp, **y_temp, *pixAcc_temp;
-  static int **FilterCoeffQuantTemp;
+  static thread_local double ***E_temp, **y_temp, *pixAcc_temp;
+  static thread_local int **FilterCoeffQuantTemp;
   double  error, lambda, lagrangian, lagrangianMin;
   
   int sqrFiltLength;
@@ -3651,7 +3651,7 @@ Void TEncAdaptiveLoopFilter::xfindBestFilterVarPred(double **ySym, double ***ESy
   double errorForce0CoeffTab[m_NO_VAR_BINS][2];
   int  codedVarBins[m_NO_VAR_BINS], createBistream /*, forceCoeff0 */;
   //int  usePrevFilt[m_NO_VAR_BINS];
-  static int first=0;
+  static thread_local int first=0;
   
   //for (i = 0; i < m_NO_VAR_BINS; i++)
   //  usePrevFiltDefault[i]=usePrevFilt[i]=1;
@@ -4578,8 +4578,8 @@ Void TEncAdaptiveLoopFilter::xMergeFiltersGreedy(Double **yGlobalSeq, Double ***
 {
   Int first, ind, ind1, ind2, noRemaining, i, j, exist, indexList[m_NO_VAR_BINS], indexListTemp[m_NO_VAR_BINS], available[m_NO_VAR_BINS], bestToMerge[2];
   Double error, error1, error2, errorMin;
-  static Double *y_temp, **E_temp, pixAcc_temp;
-  static Int init = 0;
+  static thread_local Double *y_temp, **E_temp, pixAcc_temp;
+  static thread_local Int init = 0;
   if (init == 0)
   {
     initMatrix_double(&E_temp, m_MAX_SQR_FILT_LENGTH, m_MAX_SQR_FILT_LENGTH);
@@ -4707,8 +4707,8 @@ double TEncAdaptiveLoopFilter::mergeFiltersGreedy(double **yGlobalSeq, double **
 {
   int first, ind, ind1, ind2, i, j, bestToMerge ;
   double error, error1, error2, errorMin;
-  static double pixAcc_temp, error_tab[m_NO_VAR_BINS],error_comb_tab[m_NO_VAR_BINS];
-  static int indexList[m_NO_VAR_BINS], available[m_NO_VAR_BINS], noRemaining;
+  static thread_local double pixAcc_temp, error_tab[m_NO_VAR_BINS],error_comb_tab[m_NO_VAR_BINS];
+  static thread_local int indexList[m_NO_VAR_BINS], available[m_NO_VAR_BINS], noRemaining;
   if (noIntervals == m_NO_FILTERS)
   {
     noRemaining=m_NO_VAR_BINS;
@@ -5059,7 +5059,7 @@ Double TEncAdaptiveLoopFilter::findFilterCoeff(Double ***EGlobalSeq, Double **yG
 Double TEncAdaptiveLoopFilter::findFilterCoeff(double ***EGlobalSeq, double **yGlobalSeq, double *pixAccGlobalSeq, int **filterCoeffSeq, int **filterCoeffQuantSeq, int intervalBest[m_NO_VAR_BINS][2], int varIndTab[m_NO_VAR_BINS], int sqrFiltLength, int filters_per_fr, int *weights, int bit_depth, double errorTabForce0Coeff[m_NO_VAR_BINS][2])
 #endif
 {
-  static double pixAcc_temp;
+  static thread_local double pixAcc_temp;
   double error;
   int k, filtNo;
   
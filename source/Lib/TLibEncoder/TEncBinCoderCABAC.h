@@ -80,6 +80,9 @@ public:
   UInt  getBinsCoded              ()              { return m_uiBinsCoded;                }
   Void  setBinCountingEnableFlag  ( Bool bFlag )  { m_binCountIncrement = bFlag ? 1 : 0; }
   Bool  getBinCountingEnableFlag  ()              { return m_binCountIncrement != 0;     }
+#if FAST_BIT_EST
+  UInt64 getFracBits              () const        { return m_fracBits;                   }
+#endif
 #if VCEG_AZ07_BAC_ADAPT_WDOW 
   Void  allocateMemoryforBinStrings  ();  
   Void  freeMemoryforBinStrings      ();  
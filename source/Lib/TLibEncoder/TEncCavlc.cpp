@@ -678,6 +678,12 @@ Void TEncCavlc::codeSPS( const TComSPS* pcSPS )
   sps_extension_flags[SPS_EXT__REXT] = pcSPS->getSpsRangeExtension().settingsDifferFromDefaults();
 
   // Other SPS extension flags checked here.
+#if PIP_R1_HT_BINARIZATION
+  sps_extension_flags[SPS_EXT__PIP] = pcSPS->getPIPR1HighThroughputFlag();
+#endif
+#if VCEG_AZ08_KLT_COMMON && KLT_DETERMINISTIC_BASIS
+  sps_extension_flags[SPS_EXT__KLT] = pcSPS->getKLTDeterministicBasisFlag();
+#endif
 
   for(Int i=0; i<NUM_SPS_EXTENSION_FLAGS; i++)
   {
@@ -725,6 +731,20 @@ Void TEncCavlc::codeSPS( const TComSPS* pcSPS )
             WRITE_FLAG( (spsRangeExtension.getCabacBypassAlignmentEnabledFlag() ? 1 : 0),       "cabac_bypass_alignment_enabled_flag" );
             break;
           }
+#if VCEG_AZ08_KLT_COMMON && KLT_DETERMINISTIC_BASIS
+          case SPS_EXT__KLT:
+          {
+            WRITE_FLAG( (pcSPS->getKLTDeterministicBasisFlag() ? 1 : 0),                        "klt_deterministic_basis_flag" );
+            break;
+          }
+#endif
+#if PIP_R1_HT_BINARIZATION
+          case SPS_EXT__PIP:
+          {
+            WRITE_FLAG( (pcSPS->getPIPR1HighThroughputFlag() ? 1 : 0),                          "pip_r1_high_throughput_flag" );
+            break;
+          }
+#endif
           default:
             assert(sps_extension_flags[i]==false); // Should never get here with an active SPS extension flag.
             break;
@@ -297,6 +297,20 @@ protected:
   std::vector<Int> m_tileRowHeight;
 
   Int       m_iWaveFrontSynchro;
+#if WPP_PARALLEL_CTU_ROWS
+  Int       m_iWppThreads;                                ///< threads compressing the CTU rows of a WPP slice, 1: serial
+  Bool      m_bWppRateCtrlRows;                           ///< CTU level rate control of a WPP slice per CTU row
+#endif
+#if TILE_PARALLEL_COMPRESSION
+  Int       m_iTileThreads;                               ///< threads compressing the tiles of a slice, 1: serial
+#endif
+#if FRAME_PARALLEL_GOP
+  Int       m_iFrameThreads;                              ///< threads compressing the pictures of a GOP, 1: serial
+#endif
+#if QTBT_PARALLEL_SPLIT
+  Int       m_iSplitThreads;                              ///< threads compressing the split candidates of a CU, 1: serial
+  UInt      m_uiSplitTaskMinSize;                         ///< smallest CU size whose split candidates are compressed as tasks
+#endif
 
   Int       m_decodedPictureHashSEIEnabled;              ///< Checksum(3)/CRC(2)/MD5(1)/disable(0) acting on decoded picture hash SEI message
   Int       m_bufferingPeriodSEIEnabled;
@@ -459,6 +473,9 @@ protected:
   Int       m_useInterKLT;
   Int       m_useKLT;
 #endif
+#if VCEG_AZ08_KLT_COMMON && KLT_DETERMINISTIC_BASIS
+  Bool      m_KLTDeterministicBasis;
+#endif
 #if COM16_C806_LARGE_CTU
   Int       m_useFastLCTU;
 #endif
@@ -502,6 +519,21 @@ protected:
 #if JVET_D0033_ADAPTIVE_CLIPPING
   ClipParam m_ClipParam;
 #endif
+#if PIP
+  Int       m_PIPSpQ[4];                                      ///< spatial step of the PIP residual for QP 22, 27, 32, 37
+  Int       m_PIPDeltaSpQ;
+#if SRDOQ_INCREMENTAL
+  Bool      m_PIPFastRateEst;
+#endif
+#if PIP_PARALLEL_PRED
+  Int       m_PIPThreads;
+#endif
+#if PIP_R1_HT_BINARIZATION
+  Bool      m_PIPR1HighThroughput;
+#endif
+  std::string m_PIPCodebookDir;
+  std::string m_PIPCodebookFile;
+#endif
 public:
   TEncCfg()
   : m_tileColumnWidth()
@@ -846,6 +878,26 @@ public:
   Void  xCheckGSParameters();
   Void  setWaveFrontSynchro(Int iWaveFrontSynchro)                   { m_iWaveFrontSynchro = iWaveFrontSynchro; }
   Int   getWaveFrontsynchro()                                        { return m_iWaveFrontSynchro; }
+#if WPP_PARALLEL_CTU_ROWS
+  Void  setWppThreads(Int i)                                         { m_iWppThreads = i; }
+  Int   getWppThreads()                                              { return m_iWppThreads; }
+  Void  setWppRateCtrlRows(Bool b)                                   { m_bWppRateCtrlRows = b; }
+  Bool  getWppRateCtrlRows()                                         { return m_bWppRateCtrlRows; }
+#endif
+#if TILE_PARALLEL_COMPRESSION
+  Void  setTileThreads(Int i)                                        { m_iTileThreads = i; }
+  Int   getTileThreads()                                             { return m_iTileThreads; }
+#endif
+#if FRAME_PARALLEL_GOP
+  Void  setFrameThreads(Int i)                                       { m_iFrameThreads = i; }
+  Int   getFrameThreads()                                            { return m_iFrameThreads; }
+#endif
+#if QTBT_PARALLEL_SPLIT
+  Void  setSplitThreads(Int i)                                       { m_iSplitThreads = i; }
+  Int   getSplitThreads()                                            { return m_iSplitThreads; }
+  Void  setSplitTaskMinSize(UInt u)                                  { m_uiSplitTaskMinSize = u; }
+  UInt  getSplitTaskMinSize()                                        { return m_uiSplitTaskMinSize; }
+#endif
   Void  setDecodedPictureHashSEIEnabled(Int b)                       { m_decodedPictureHashSEIEnabled = b; }
   Int   getDecodedPictureHashSEIEnabled()                            { return m_decodedPictureHashSEIEnabled; }
   Void  setBufferingPeriodSEIEnabled(Int b)                          { m_bufferingPeriodSEIEnabled = b; }
@@ -1181,6 +1233,10 @@ public:
   Void      setUseKLT(Int n)                                         { m_useKLT = n; }
   Int       getUseKLT()                                              { return m_useKLT; }
 #endif
+#if VCEG_AZ08_KLT_COMMON && KLT_DETERMINISTIC_BASIS
+  Void      setKLTDeterministicBasis(Bool b)                         { m_KLTDeterministicBasis = b; }
+  Bool      getKLTDeterministicBasis()                               { return m_KLTDeterministicBasis; }
+#endif
 #if COM16_C806_LARGE_CTU
   Void      setUseFastLCTU(Int n)                                    { m_useFastLCTU = n; }
   Int       getUseFastLCTU()                                         { return m_useFastLCTU;  }
@@ -1229,6 +1285,28 @@ public:
   Bool getUseRSAF()                                             { return m_useRSAF; }
   Void setUseRSAF(Bool b)                                       { m_useRSAF = b;    }
 #endif
+#if PIP
+  Int  getPIPSpQ(Int qpIdx)                                     { return m_PIPSpQ[qpIdx]; }
+  Void setPIPSpQ(Int qpIdx, Int i)                              { m_PIPSpQ[qpIdx] = i; }
+  Int  getPIPDeltaSpQ()                                         { return m_PIPDeltaSpQ; }
+  Void setPIPDeltaSpQ(Int i)                                    { m_PIPDeltaSpQ = i; }
+#if SRDOQ_INCREMENTAL
+  Bool getPIPFastRateEst()                                      { return m_PIPFastRateEst; }
+  Void setPIPFastRateEst(Bool b)                                { m_PIPFastRateEst = b; }
+#endif
+#if PIP_PARALLEL_PRED
+  Int  getPIPThreads()                                          { return m_PIPThreads; }
+  Void setPIPThreads(Int i)                                     { m_PIPThreads = i; }
+#endif
+#if PIP_R1_HT_BINARIZATION
+  Bool getPIPR1HighThroughput()                                 { return m_PIPR1HighThroughput; }
+  Void setPIPR1HighThroughput(Bool b)                           { m_PIPR1HighThroughput = b; }
+#endif
+  const std::string& getPIPCodebookDir()                        { return m_PIPCodebookDir; }
+  Void setPIPCodebookDir(const std::string& s)                  { m_PIPCodebookDir = s; }
+  const std::string& getPIPCodebookFile()                       { return m_PIPCodebookFile; }
+  Void setPIPCodebookFile(const std::string& s)                 { m_PIPCodebookFile = s; }
+#endif
 };
 
 //! \}
@@ -0,0 +1,232 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2015, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TEncCtuWorker.cpp
+    \brief    coding objects of one thread compressing the CTU rows or the tiles of a slice
+*/
+
+#include "TEncCtuWorker.h"
+
+//! \ingroup TLibEncoder
+//! \{
+
+#if WPP_PARALLEL_CTU_ROWS
+
+TEncCtuWorker::TEncCtuWorker()
+: m_uiMaxIdx           ( 0 )
+, m_ppppcRDSbacCoder   ( NULL )
+, m_ppppcBinCoderCABAC ( NULL )
+, m_pcCtuScratch       ( NULL )
+#if ADAPTIVE_QP_SELECTION
+, m_pcArlCoeffBuffer   ( NULL )
+#endif
+#if FRAME_PARALLEL_GOP || QTBT_PARALLEL_SPLIT
+, m_pcPicYuvPred       ( NULL )
+#endif
+#if QTBT_PARALLEL_SPLIT
+, m_pcPicYuvRec        ( NULL )
+, m_pcCtuCopy          ( NULL )
+, m_pcCtuScratchReads  ( NULL )
+#endif
+{
+  m_cRDGoOnSbacCoder.init( &m_cRDGoOnBinCoderCABAC );
+#if JVET_C0024_AMAX_BT
+  clearBlkStats();
+#endif
+}
+
+TEncCtuWorker::~TEncCtuWorker()
+{
+  destroy();
+}
+
+Void TEncCtuWorker::create( UChar uhTotalDepth, UInt uiCTUSize, ChromaFormat chromaFormat )
+{
+  m_cCuEncoder.create( uhTotalDepth, uiCTUSize, uiCTUSize, chromaFormat );
+
+  m_uiMaxIdx = g_aucConvertToBit[uiCTUSize];
+  const UInt uiNumSizeIdx = m_uiMaxIdx + 1;
+
+  m_ppppcRDSbacCoder   = new TEncSbac*** [uiNumSizeIdx];
+  m_ppppcBinCoderCABAC = new TEncBinCABACCounter*** [uiNumSizeIdx];
+  for( UInt w = 0; w < uiNumSizeIdx; w++ )
+  {
+    m_ppppcRDSbacCoder[w]   = new TEncSbac** [uiNumSizeIdx];
+    m_ppppcBinCoderCABAC[w] = new TEncBinCABACCounter** [uiNumSizeIdx];
+    for( UInt h = 0; h < uiNumSizeIdx; h++ )
+    {
+      m_ppppcRDSbacCoder[w][h]   = new TEncSbac* [CI_NUM];
+      m_ppppcBinCoderCABAC[w][h] = new TEncBinCABACCounter* [CI_NUM];
+      for( Int iCIIdx = 0; iCIIdx < CI_NUM; iCIIdx++ )
+      {
+        m_ppppcRDSbacCoder[w][h][iCIIdx]   = new TEncSbac;
+        m_ppppcBinCoderCABAC[w][h][iCIIdx] = new TEncBinCABACCounter;
+        m_ppppcRDSbacCoder[w][h][iCIIdx]->init( m_ppppcBinCoderCABAC[w][h][iCIIdx] );
+      }
+    }
+  }
+
+  m_pcCtuScratch = new TComCtuScratch;
+#if ADAPTIVE_QP_SELECTION
+  m_pcArlCoeffBuffer = new TCoeff[uiCTUSize*uiCTUSize*MAX_NUM_COMPONENT];
+#endif
+}
+
+Void TEncCtuWorker::destroy()
+{
+  if( m_ppppcRDSbacCoder == NULL )
+  {
+    return;
+  }
+  m_cCuEncoder.destroy();                                   // the search is destroyed with the worker
+
+  const UInt uiNumSizeIdx = m_uiMaxIdx + 1;
+  for( UInt w = 0; w < uiNumSizeIdx; w++ )
+  {
+    for( UInt h = 0; h < uiNumSizeIdx; h++ )
+    {
+      for( Int iCIIdx = 0; iCIIdx < CI_NUM; iCIIdx++ )
+      {
+        delete m_ppppcRDSbacCoder[w][h][iCIIdx];
+        delete m_ppppcBinCoderCABAC[w][h][iCIIdx];
+      }
+      delete[] m_ppppcRDSbacCoder[w][h];
+      delete[] m_ppppcBinCoderCABAC[w][h];
+    }
+    delete[] m_ppppcRDSbacCoder[w];
+    delete[] m_ppppcBinCoderCABAC[w];
+  }
+  delete[] m_ppppcRDSbacCoder;
+  delete[] m_ppppcBinCoderCABAC;
+  m_ppppcRDSbacCoder   = NULL;
+  m_ppppcBinCoderCABAC = NULL;
+
+  delete m_pcCtuScratch;
+  m_pcCtuScratch = NULL;
+#if ADAPTIVE_QP_SELECTION
+  delete[] m_pcArlCoeffBuffer;
+  m_pcArlCoeffBuffer = NULL;
+#endif
+#if FRAME_PARALLEL_GOP || QTBT_PARALLEL_SPLIT
+  if( m_pcPicYuvPred )
+  {
+    m_pcPicYuvPred->destroy();
+    delete m_pcPicYuvPred;
+    m_pcPicYuvPred = NULL;
+  }
+#endif
+#if QTBT_PARALLEL_SPLIT
+  if( m_pcPicYuvRec )
+  {
+    m_pcPicYuvRec->destroy();
+    delete m_pcPicYuvRec;
+    m_pcPicYuvRec = NULL;
+  }
+  if( m_pcCtuCopy )
+  {
+    m_pcCtuCopy->destroy();
+    delete m_pcCtuCopy;
+    m_pcCtuCopy = NULL;
+  }
+  delete m_pcCtuScratchReads;
+  m_pcCtuScratchReads = NULL;
+#endif
+}
+
+#if FRAME_PARALLEL_GOP
+Void TEncCtuWorker::createPicYuvPred( Int iWidth, Int iHeight, ChromaFormat chromaFormat, UInt uiMaxCUWidth, UInt uiMaxCUHeight, UChar uhTotalDepth )
+{
+  m_pcPicYuvPred = new TComPicYuv;
+  m_pcPicYuvPred->create( iWidth, iHeight, chromaFormat, uiMaxCUWidth, uiMaxCUHeight, uhTotalDepth, true );
+}
+#endif
+
+#if QTBT_PARALLEL_SPLIT
+Void TEncCtuWorker::createSplitTaskBuffers( Int iWidth, Int iHeight, ChromaFormat chromaFormat, UInt uiCTUSize, UChar uhTotalDepth )
+{
+  if( m_pcPicYuvPred == NULL )
+  {
+    m_pcPicYuvPred = new TComPicYuv;
+    m_pcPicYuvPred->create( iWidth, iHeight, chromaFormat, uiCTUSize, uiCTUSize, uhTotalDepth, true );
+  }
+  m_pcPicYuvRec = new TComPicYuv;
+  m_pcPicYuvRec->create( iWidth, iHeight, chromaFormat, uiCTUSize, uiCTUSize, uhTotalDepth, true );
+
+  // as the CTUs of TComPicSym
+  m_pcCtuCopy = new TComDataCU;
+  m_pcCtuCopy->create( chromaFormat, 1 << ( uhTotalDepth << 1 ), uiCTUSize, uiCTUSize, false, uiCTUSize >> uhTotalDepth
+#if JVET_C0024_QTBT
+                     , uiCTUSize, uiCTUSize
+#endif
+#if ADAPTIVE_QP_SELECTION
+                     , NULL
+#endif
+                     );
+  m_pcCtuScratchReads = new TComCtuScratchReads;
+}
+#endif
+
+#if PIP
+Void TEncCtuWorker::setPIPContext( TComPIPContext* pcPIPContext, Int iThreadId )
+{
+  m_cSearch.setPIPContext( pcPIPContext, iThreadId );
+  m_cSearch.setPIPCoderState( &m_cPIPCoderState );
+  m_cEntropyCoder.setPIPCoderState( &m_cPIPCoderState );
+  m_cRDGoOnSbacCoder.setPIPContext( pcPIPContext, iThreadId );
+  m_cRDGoOnSbacCoder.setPIPCoderState( &m_cPIPCoderState );
+  const UInt uiNumSizeIdx = m_uiMaxIdx + 1;
+  for( UInt w = 0; w < uiNumSizeIdx; w++ )
+  {
+    for( UInt h = 0; h < uiNumSizeIdx; h++ )
+    {
+      for( Int iCIIdx = 0; iCIIdx < CI_NUM; iCIIdx++ )
+      {
+        m_ppppcRDSbacCoder[w][h][iCIIdx]->setPIPContext( pcPIPContext, iThreadId );
+        m_ppppcRDSbacCoder[w][h][iCIIdx]->setPIPCoderState( &m_cPIPCoderState );
+      }
+    }
+  }
+}
+#endif
+
+#if JVET_C0024_AMAX_BT
+Void TEncCtuWorker::clearBlkStats()
+{
+  ::memset( m_auiBlkSize, 0, sizeof( m_auiBlkSize ) );
+  ::memset( m_auiNumBlk,  0, sizeof( m_auiNumBlk ) );
+}
+#endif
+
+#endif
+
+//! \}
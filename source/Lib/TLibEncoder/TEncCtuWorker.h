@@ -0,0 +1,151 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2015, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TEncCtuWorker.h
+    \brief    coding objects of one thread compressing the CTU rows or the tiles of a slice (header)
+*/
+
+#ifndef __TENCCTUWORKER__
+#define __TENCCTUWORKER__
+
+#include "TLibCommon/CommonDef.h"
+#include "TLibCommon/TComTrQuant.h"
+#include "TLibCommon/TComRdCost.h"
+#include "TLibCommon/TComBitCounter.h"
+#include "TLibCommon/TComPic.h"
+#include "TEncCu.h"
+#include "TEncSearch.h"
+#include "TEncEntropy.h"
+#include "TEncSbac.h"
+#include "TEncBinCoderCABACCounter.h"
+
+//! \ingroup TLibEncoder
+//! \{
+
+#if WPP_PARALLEL_CTU_ROWS
+
+/** CU encoder of one CTU row, tile or picture thread with its own search, transform, RD cost and SBAC
+ *  coders. The objects are set up like the ones of TEncTop (TEncTop::xInitCtuWorkers) and take the slice
+ *  state of the slice encoder before every slice, so a CTU is compressed to the same result by any worker.
+ */
+class TEncCtuWorker
+{
+public:
+  TEncCtuWorker();
+  ~TEncCtuWorker();
+
+  Void  create              ( UChar uhTotalDepth, UInt uiCTUSize, ChromaFormat chromaFormat );
+  Void  destroy             ();
+#if FRAME_PARALLEL_GOP
+  /// prediction picture of the pictures compressed by this worker, in place of the one of the slice encoder
+  Void  createPicYuvPred    ( Int iWidth, Int iHeight, ChromaFormat chromaFormat, UInt uiMaxCUWidth, UInt uiMaxCUHeight, UChar uhTotalDepth );
+#endif
+#if QTBT_PARALLEL_SPLIT
+  /// copies of the CTU, the reconstruction and the prediction of the picture, into which a split task compresses a CU
+  Void  createSplitTaskBuffers( Int iWidth, Int iHeight, ChromaFormat chromaFormat, UInt uiCTUSize, UChar uhTotalDepth );
+#endif
+
+#if PIP
+  /// the PIP coders of this worker count into the statistics of thread iThreadId of the context
+  Void  setPIPContext       ( TComPIPContext* pcPIPContext, Int iThreadId );
+  TComPIPCoderState*      getPIPCoderState      () { return &m_cPIPCoderState;    }
+#endif
+
+  TEncCu*                 getCuEncoder          () { return &m_cCuEncoder;        }
+  TEncSearch*             getPredSearch         () { return &m_cSearch;           }
+  TComTrQuant*            getTrQuant            () { return &m_cTrQuant;          }
+  TComRdCost*             getRdCost             () { return &m_cRdCost;           }
+  TEncEntropy*            getEntropyCoder       () { return &m_cEntropyCoder;     }
+  TEncSbac****            getRDSbacCoder        () { return m_ppppcRDSbacCoder;   }
+  TEncSbac*               getRDGoOnSbacCoder    () { return &m_cRDGoOnSbacCoder;  }
+  TEncSbac*               getCurrBestSbacCoder  () { return m_ppppcRDSbacCoder[m_uiMaxIdx][m_uiMaxIdx][CI_CURR_BEST]; }
+  TComBitCounter*         getBitCounter         () { return &m_cBitCounter;       }
+  TComCtuScratch*         getCtuScratch         () { return m_pcCtuScratch;       }
+  TEncSbac*               getSyncContextState   () { return &m_cSyncContextState; }
+#if ADAPTIVE_QP_SELECTION
+  TCoeff*                 getArlCoeffBuffer     () { return m_pcArlCoeffBuffer;   }
+#endif
+#if FRAME_PARALLEL_GOP || QTBT_PARALLEL_SPLIT
+  TComPicYuv*             getPicYuvPred         () { return m_pcPicYuvPred;       }
+#endif
+#if QTBT_PARALLEL_SPLIT
+  TComPicYuv*             getPicYuvRec          () { return m_pcPicYuvRec;        }
+  TComDataCU*             getCtuCopy            () { return m_pcCtuCopy;          }
+  TComCtuScratchReads*    getCtuScratchReads    () { return m_pcCtuScratchReads;  }
+#endif
+
+#if JVET_C0024_AMAX_BT
+  UInt*                   getBlkSize            () { return m_auiBlkSize;         }
+  UInt*                   getNumBlk             () { return m_auiNumBlk;          }
+  Void                    clearBlkStats         ();
+#endif
+
+private:
+  UInt                    m_uiMaxIdx;                     ///< index of the CTU size in the RD coder arrays
+  TEncCu                  m_cCuEncoder;
+  TEncSearch              m_cSearch;
+  TComTrQuant             m_cTrQuant;
+  TComRdCost              m_cRdCost;
+  TEncEntropy             m_cEntropyCoder;
+  TEncSbac****            m_ppppcRDSbacCoder;             ///< SBAC coders of the RD decisions, [w][h][CI_NUM] as in TEncTop
+  TEncBinCABACCounter**** m_ppppcBinCoderCABAC;
+  TEncSbac                m_cRDGoOnSbacCoder;
+  TEncBinCABACCounter     m_cRDGoOnBinCoderCABAC;
+  TComBitCounter          m_cBitCounter;                  ///< counts the bits of the trial and the final encoding of a CTU
+  TComCtuScratch*         m_pcCtuScratch;                 ///< coded blocks and fast decisions of the CTU, in place of the picture's ones
+  TEncSbac                m_cSyncContextState;            ///< contexts after the second CTU of the tile row, for WaveFrontSynchro inside a tile
+#if PIP
+  TComPIPCoderState       m_cPIPCoderState;               ///< PIP flags of the search and the coders of this worker
+#endif
+#if ADAPTIVE_QP_SELECTION
+  TCoeff*                 m_pcArlCoeffBuffer;             ///< ARL coefficients of the CTU being compressed, in place of the picture's shared buffer
+#endif
+#if FRAME_PARALLEL_GOP || QTBT_PARALLEL_SPLIT
+  TComPicYuv*             m_pcPicYuvPred;                 ///< written by the CU encoder while compressing a picture or a split task, NULL without FrameThreads and SplitThreads
+#endif
+#if QTBT_PARALLEL_SPLIT
+  TComPicYuv*             m_pcPicYuvRec;                  ///< reconstruction around the CU of a split task, NULL without SplitThreads
+  TComDataCU*             m_pcCtuCopy;                    ///< CTU of a split task
+  TComCtuScratchReads*    m_pcCtuScratchReads;            ///< fast decisions a split task read from the state it started from
+#endif
+#if JVET_C0024_AMAX_BT
+  UInt                    m_auiBlkSize[10];               ///< AMaxBT statistics of the CTUs of this worker, added to the ones of the GOP encoder at slice end
+  UInt                    m_auiNumBlk[10];
+#endif
+};
+
+#endif
+
+//! \}
+
+#endif // __TENCCTUWORKER__
@@ -40,6 +40,10 @@
 #include "TEncCu.h"
 #include "TEncAnalyze.h"
 #include "TLibCommon/Debug.h"
+#if QTBT_PARALLEL_SPLIT
+#include "TLibCommon/TComThreadPool.h"
+#include "TEncCtuWorker.h"
+#endif
 
 #include <cmath>
 #include <algorithm>
@@ -49,12 +53,10 @@ using namespace std;
 //! \ingroup TLibEncoder
 //! \{
 #if VCEG_AZ08_INTER_KLT
-extern Bool g_bEnableCheck;
+extern thread_local Bool g_bEnableCheck;
 #endif
 
 #if PIP
-Bool encodeTime = false;
-Bool verbose = false;
 Bool txtWrite = false;
 #endif
 // ====================================================================================================================
@@ -283,13 +285,8 @@ Void TEncCu::create(UChar uhTotalDepth, UInt uiMaxWidth, UInt uiMaxHeight, Chrom
   m_cuChromaQpOffsetIdxPlus1       = 0;
   m_bFastDeltaQP                   = false;
 
-  // initialize partition order.
-  UInt* piTmp = &g_auiZscanToRaster[0];
-  initZscanToRaster( m_uhTotalDepth, 1, 0, piTmp);
-  initRasterToZscan( uiMaxWidth, uiMaxHeight, m_uhTotalDepth );
-
-  // initialize conversion matrix from partition index to pel
-  initRasterToPelXY( uiMaxWidth, uiMaxHeight, m_uhTotalDepth );
+  // initialize partition order and conversion matrix from partition index to pel
+  initPartitionOrder( uiMaxWidth, uiMaxHeight, m_uhTotalDepth );
 }
 
 Void TEncCu::destroy()
@@ -766,26 +763,61 @@ Void TEncCu::destroy()
 /** \param    pcEncTop      pointer of encoder class
  */
 Void TEncCu::init( TEncTop* pcEncTop )
+{
+  init( pcEncTop, pcEncTop->getPredSearch(), pcEncTop->getTrQuant(), pcEncTop->getRdCost(), pcEncTop->getEntropyCoder(),
+        pcEncTop->getRDSbacCoder(), pcEncTop->getRDGoOnSbacCoder(), 0 );
+}
+
+/** \param    pcEncTop           pointer of encoder class
+    \param    pcPredSearch       search used for the CTUs
+    \param    pcTrQuant          transform and quantization of the search
+    \param    pcRdCost           RD cost of the search
+    \param    pcEntropyCoder     entropy coder of the search
+    \param    ppppcRDSbacCoder   SBAC coders of the RD decisions
+    \param    pcRDGoOnSbacCoder  go-on SBAC coder
+    \param    iPIPThreadId       set of PIP counters written by this CU encoder
+ */
+Void TEncCu::init( TEncTop* pcEncTop, TEncSearch* pcPredSearch, TComTrQuant* pcTrQuant, TComRdCost* pcRdCost, TEncEntropy* pcEntropyCoder,
+#if JVET_C0024_QTBT
+                   TEncSbac**** ppppcRDSbacCoder,
+#else
+                   TEncSbac*** pppcRDSbacCoder,
+#endif
+                   TEncSbac* pcRDGoOnSbacCoder, Int iPIPThreadId )
 {
   m_pcEncCfg           = pcEncTop;
-  m_pcPredSearch       = pcEncTop->getPredSearch();
+  m_pcPredSearch       = pcPredSearch;
 #if PIP
-  m_pcPredSearchPIP	   = pcEncTop->getPredSearch();
+  m_pcPIPStats         = pcEncTop->getPIPContext().getThreadStats(iPIPThreadId);
 #endif
-  m_pcTrQuant          = pcEncTop->getTrQuant();
-  m_pcRdCost           = pcEncTop->getRdCost();
+  m_pcTrQuant          = pcTrQuant;
+  m_pcRdCost           = pcRdCost;
 
-  m_pcEntropyCoder     = pcEncTop->getEntropyCoder();
+  m_pcEntropyCoder     = pcEntropyCoder;
   m_pcBinCABAC         = pcEncTop->getBinCABAC();
 
 #if JVET_C0024_QTBT
-  m_ppppcRDSbacCoder   = pcEncTop->getRDSbacCoder();
+  m_ppppcRDSbacCoder   = ppppcRDSbacCoder;
 #else
-  m_pppcRDSbacCoder    = pcEncTop->getRDSbacCoder();
+  m_pppcRDSbacCoder    = pppcRDSbacCoder;
 #endif
-  m_pcRDGoOnSbacCoder  = pcEncTop->getRDGoOnSbacCoder();
+  m_pcRDGoOnSbacCoder  = pcRDGoOnSbacCoder;
 
   m_pcRateCtrl         = pcEncTop->getRateCtrl();
+#if WPP_PARALLEL_CTU_ROWS
+  m_iCtuRCQP           = g_RCInvalidQPValue;
+#endif
+#if QTBT_PARALLEL_SPLIT
+  m_pcSplitWorkers     = NULL;
+  m_pcSplitTaskPool    = NULL;
+  m_uiSplitTaskMinSize = 0;
+  m_pbSplitTaskCancel  = NULL;
+  m_bSplitTaskQTValid  = false;
+#endif
+#if JVET_C0024_AMAX_BT
+  m_puiBlkSize         = pcEncTop->getGOPEncoder()->getBlkSize();
+  m_puiNumBlk          = pcEncTop->getGOPEncoder()->getNumBlk();
+#endif
 }
 
 // ====================================================================================================================
@@ -1196,8 +1228,8 @@ Void TEncCu::xCompressCU( TComDataCU*& rpcBestCU, TComDataCU*& rpcTempCU, const
 
   if ( m_pcEncCfg->getUseRateCtrl() )
   {
-    iMinQP = m_pcRateCtrl->getRCQP();
-    iMaxQP = m_pcRateCtrl->getRCQP();
+    iMinQP = xGetRCQP();
+    iMaxQP = xGetRCQP();
   }
 
   // transquant-bypass (TQB) processing loop variable initialisation ---
@@ -2366,8 +2398,8 @@ Void TEncCu::xCompressCU( TComDataCU*& rpcBestCU, TComDataCU*& rpcTempCU, const
 
   if ( m_pcEncCfg->getUseRateCtrl() )
   {
-    iMinQP = m_pcRateCtrl->getRCQP();
-    iMaxQP = m_pcRateCtrl->getRCQP();
+    iMinQP = xGetRCQP();
+    iMaxQP = xGetRCQP();
   }
 
   if ( m_pcEncCfg->getCUTransquantBypassFlagForceValue() )
@@ -2501,126 +2533,19 @@ Void TEncCu::xCompressCU( TComDataCU*& rpcBestCU, TComDataCU*& rpcTempCU, const
     {
       const Bool bIsLosslessMode = false; // False at this level. Next level down may set it to true.
 
-      rpcTempCU->initEstData( uiDepth, iQP, bIsLosslessMode );
-
-      UChar       uhNextDepth         = uiDepth;
-      UInt uiBTWidthIdx = g_aucConvertToBit[uiWidth];   
-      UInt uiBTHeightIdx = g_aucConvertToBit[uiHeight>>1];
-      TComDataCU* pcSubBestPartCU     = m_pppcBestCU[uiBTWidthIdx][uiBTHeightIdx];
-      TComDataCU* pcSubTempPartCU     = m_pppcTempCU[uiBTWidthIdx][uiBTHeightIdx];
-      rpcTempCU->setBTSplitModeSubParts(1, 0, uiWidth, uiHeight);
-#if JVET_C0024_BT_RMV_REDUNDANT
-      uiSplitConstrain = 0;
-#endif
-#if JVET_C0024_DELTA_QP_FIX
-      if( pps.getUseDQP() ) // inherit quantization group info. from parent CU.
-      {
-        pcSubBestPartCU->initSubBT( rpcTempCU, 0, uiDepth, uiWidth, uiHeight>>1, 1, iQP );           
-        pcSubTempPartCU->initSubBT( rpcTempCU, 0, uiDepth, uiWidth, uiHeight>>1, 1, iQP );           // clear sub partition datas or init.
-        pcSubBestPartCU->setCodedQP( lastCodedQP );
-        pcSubTempPartCU->setCodedQP( lastCodedQP );
-        pcSubBestPartCU->setQuPartIdx( rpcTempCU->getQuPartIdx() );
-        pcSubTempPartCU->setQuPartIdx( rpcTempCU->getQuPartIdx() );
-        pcSubBestPartCU->setQuLastCodedQP( rpcTempCU->getQuLastCodedQP() );
-        pcSubTempPartCU->setQuLastCodedQP( rpcTempCU->getQuLastCodedQP() );
-      }
-#endif
-
-      for ( UInt uiPartUnitIdx = 0; uiPartUnitIdx < 2; uiPartUnitIdx++ )
-      {
-        pcSubBestPartCU->initSubBT( rpcTempCU, uiPartUnitIdx, uiDepth, uiWidth, uiHeight>>1, 1, iQP );           
-        pcSubTempPartCU->initSubBT( rpcTempCU, uiPartUnitIdx, uiDepth, uiWidth, uiHeight>>1, 1, iQP );           // clear sub partition datas or init.
-
-#if VCEG_AZ07_IMV && !JVET_C0024_QTBT
-        for( Int size = 0 ; size < NUMBER_OF_PART_SIZES ; size++ )
-        {
-          m_pppcTempCUIMVCache[size][uiBTWidthIdx][uiBTHeightIdx]->initSubBT( rpcTempCU, uiPartUnitIdx, uiDepth, uiWidth, uiHeight>>1, 1, iQP ); 
-        }
-#endif
-#if COM16_C806_OBMC
-        m_pppcTempCUWoOBMC[uiBTWidthIdx][uiBTHeightIdx]->initSubBT( rpcTempCU, uiPartUnitIdx, uiDepth, uiWidth, uiHeight>>1, 1, iQP );  // clear sub partition datas or init.
-#endif
-#if VCEG_AZ07_FRUC_MERGE
-        m_pppcFRUCBufferCU[uiBTWidthIdx][uiBTHeightIdx]->initSubBT( rpcTempCU, uiPartUnitIdx, uiDepth, uiWidth, uiHeight>>1, 1, iQP ); 
-#endif
-        if(( pcSubBestPartCU->getCUPelX() < pcSlice->getSPS()->getPicWidthInLumaSamples() ) && ( pcSubBestPartCU->getCUPelY() < pcSlice->getSPS()->getPicHeightInLumaSamples() ) )
-        {
-          if ( 0 == uiPartUnitIdx) //initialize RD with previous depth buffer
-          {
-            m_ppppcRDSbacCoder[uiWidthIdx][uiHeightIdx-1][CI_CURR_BEST]->load(m_ppppcRDSbacCoder[uiWidthIdx][uiHeightIdx][CI_CURR_BEST]);
-          }
-          else
-          {
-            m_ppppcRDSbacCoder[uiWidthIdx][uiHeightIdx-1][CI_CURR_BEST]->load(m_ppppcRDSbacCoder[uiWidthIdx][uiHeightIdx-1][CI_NEXT_BEST]);
-          }
+      xCheckRDCostBTSplit( rpcTempCU, uiDepth, uiWidth, uiHeight, uiBTSplitMode, 1, iQP,
 #if JVET_C0024_BT_RMV_REDUNDANT
-          xCompressCU( pcSubBestPartCU, pcSubTempPartCU, uiDepth, uiWidth, uiHeight>>1, pcSubBestPartCU->getBTSplitMode(0), uiSplitConstrain );
-          
-          if( uiPartUnitIdx == 0 && pcSubBestPartCU->getBTSplitModeForBTDepth(0, uiBTDepth+1) == 2 && bBTHorRmvEnable )
-          {
-              uiSplitConstrain = 2;
-          }
+                           bBTHorRmvEnable
 #else
-          xCompressCU( pcSubBestPartCU, pcSubTempPartCU, uiDepth, uiWidth, uiHeight>>1, pcSubBestPartCU->getBTSplitMode(0) );
+                           false
 #endif
-          rpcTempCU->copyPartFrom( pcSubBestPartCU, uiPartUnitIdx, uhNextDepth, uiWidth, uiHeight>>1 );         // Keep best part data to current temporary data.
 #if JVET_C0024_DELTA_QP_FIX
-          if( pps.getUseDQP() ) // update coded QP
-          { 
-            rpcTempCU->setCodedQP( pcSubBestPartCU->getCodedQP() ); 
-            pcSubBestPartCU->setCodedQP( rpcTempCU->getCodedQP() );
-            pcSubTempPartCU->setCodedQP( rpcTempCU->getCodedQP() );
-          }
+                           , lastCodedQP
 #endif
-          xCopyYuv2Tmp( pcSubBestPartCU->getZorderIdxInCtu()-rpcTempCU->getZorderIdxInCtu(), uiWidth, uiHeight, 1 );
-        }
-      }
-      m_pcRDGoOnSbacCoder->load(m_ppppcRDSbacCoder[uiWidthIdx][uiHeightIdx-1][CI_NEXT_BEST]);
-      m_pcEntropyCoder->resetBits();
-      if (uiBTSplitMode==0 )
-      {
-        m_pcEntropyCoder->encodeSplitFlag( rpcTempCU, 0, uiDepth, true );
-      }
-      m_pcEntropyCoder->encodeBTSplitMode(rpcTempCU, 0, uiWidth, uiHeight, true);
-
-
-      rpcTempCU->getTotalBits() += m_pcEntropyCoder->getNumberOfWrittenBits(); // split bits
-      rpcTempCU->getTotalBins() += ((TEncBinCABAC *)((TEncSbac*)m_pcEntropyCoder->m_pcEntropyCoderIf)->getEncBinIf())->getBinsCoded();
-
-      rpcTempCU->getTotalCost()  = m_pcRdCost->calcRdCost( rpcTempCU->getTotalBits(), rpcTempCU->getTotalDistortion() );
 #if JVET_D0077_SAVE_LOAD_ENC_INFO
-      if( rpcTempCU->getTotalCost() < dHorSplitCost )
-      {
-        dHorSplitCost = rpcTempCU->getTotalCost();
-      }
-#endif
-#if JVET_C0024_DELTA_QP_FIX
-      if( uiQTBTDepth == uiMaxDQPDepthQTBT && pps.getUseDQP())
-      {
-        Bool foundNonZeroCbf = false;
-        UInt uiFirstNonZeroPartIdx = 0;
-        rpcTempCU->setQPSubCUs( rpcTempCU->getRefQP( 0 ), 0, uiDepth, uiWidth, uiHeight, uiFirstNonZeroPartIdx, foundNonZeroCbf );
-        if ( foundNonZeroCbf )
-        {
-          m_pcEntropyCoder->resetBits();
-          m_pcEntropyCoder->encodeQP( rpcTempCU, uiFirstNonZeroPartIdx, false );
-          rpcTempCU->getTotalBits() += m_pcEntropyCoder->getNumberOfWrittenBits(); // dQP bits
-          rpcTempCU->getTotalBins() += ((TEncBinCABAC *)((TEncSbac*)m_pcEntropyCoder->m_pcEntropyCoderIf)->getEncBinIf())->getBinsCoded();
-          rpcTempCU->getTotalCost()  = m_pcRdCost->calcRdCost( rpcTempCU->getTotalBits(), rpcTempCU->getTotalDistortion() );
-        }
-        else
-        {
-          rpcTempCU->setQPSubParts( rpcTempCU->getRefQP( 0 ), 0, uiWidth, uiHeight ); // set QP to default QP
-#if JVET_C0024_DELTA_QP_FIX
-          if( pps.getUseDQP() ) // update coded QP
-          { 
-            rpcTempCU->setCodedQP( rpcTempCU->getQP( 0 ) ); 
-          }
-#endif
-        }
-      }
+                           , dHorSplitCost
 #endif
-      m_pcRDGoOnSbacCoder->store(m_ppppcRDSbacCoder[uiWidthIdx][uiHeightIdx][CI_TEMP_BEST]);
+                           );
 
       if (rpcBestCU->getTotalCost()!=MAX_DOUBLE)
       {
@@ -2659,6 +2584,27 @@ Void TEncCu::xCompressCU( TComDataCU*& rpcBestCU, TComDataCU*& rpcTempCU, const
     bTestVerSplit = bQTSplit = false;
   }
 
+#if QTBT_PARALLEL_SPLIT
+  // BT-V and QT of a large CU are compressed concurrently from the fast decisions and save/load information left by BT-H,
+  // and taken below in the serial order; QT is compressed again here if BT-V changed what it read
+  const Bool bSplitTasks = m_pcSplitWorkers != NULL && iMinQP == iMaxQP && !bBoundary && uiWidth * uiHeight >= m_uiSplitTaskMinSize * m_uiSplitTaskMinSize
+                        && bTestVerSplit && bQTSplit;
+  if( bSplitTasks )
+  {
+    xCompressSplitTasks( rpcBestCU, rpcTempCU, uiDepth, uiWidth, uiHeight, uiBTSplitMode, iMinQP,
+#if JVET_C0024_BT_RMV_REDUNDANT
+                         bBTVerRmvEnable,
+#else
+                         false,
+#endif
+                         bForceQT, bTestHorSplit, uiMaxBTD
+#if JVET_C0024_DELTA_QP_FIX
+                         , lastCodedQP
+#endif
+                         );
+  }
+#endif
+
   if (bTestVerSplit) 
   {
     // further split
@@ -2666,129 +2612,29 @@ Void TEncCu::xCompressCU( TComDataCU*& rpcBestCU, TComDataCU*& rpcTempCU, const
     {
       const Bool bIsLosslessMode = false; // False at this level. Next level down may set it to true.
 
-      rpcTempCU->initEstData( uiDepth, iQP, bIsLosslessMode );
-
-      UChar       uhNextDepth         = uiDepth;
-      UInt uiBTWidthIdx = g_aucConvertToBit[uiWidth>>1];   
-      UInt uiBTHeightIdx = g_aucConvertToBit[uiHeight];
-      TComDataCU* pcSubBestPartCU     = m_pppcBestCU[uiBTWidthIdx][uiBTHeightIdx];
-      TComDataCU* pcSubTempPartCU     = m_pppcTempCU[uiBTWidthIdx][uiBTHeightIdx];
-      rpcTempCU->setBTSplitModeSubParts(2, 0, uiWidth, uiHeight);
-#if JVET_C0024_BT_RMV_REDUNDANT
-      uiSplitConstrain = 0;
-#endif
-#if JVET_C0024_DELTA_QP_FIX // inherit quantization group info. from parent CU.
-      if( pps.getUseDQP() )
-      {
-        pcSubBestPartCU->initSubBT( rpcTempCU, 0, uiDepth, uiWidth>>1, uiHeight, 2, iQP );           
-        pcSubTempPartCU->initSubBT( rpcTempCU, 0, uiDepth, uiWidth>>1, uiHeight, 2, iQP );           // clear sub partition datas or init.
-        pcSubBestPartCU->setCodedQP( lastCodedQP );
-        pcSubTempPartCU->setCodedQP( lastCodedQP );
-        pcSubBestPartCU->setQuPartIdx( rpcTempCU->getQuPartIdx() );
-        pcSubTempPartCU->setQuPartIdx( rpcTempCU->getQuPartIdx() );
-        pcSubBestPartCU->setQuLastCodedQP( rpcTempCU->getQuLastCodedQP() );
-        pcSubTempPartCU->setQuLastCodedQP( rpcTempCU->getQuLastCodedQP() );
-      }
-#endif
-
-      for ( UInt uiPartUnitIdx = 0; uiPartUnitIdx < 2; uiPartUnitIdx++ )
+#if QTBT_PARALLEL_SPLIT
+      if( bSplitTasks )
       {
-        pcSubBestPartCU->initSubBT( rpcTempCU, uiPartUnitIdx, uiDepth, uiWidth>>1, uiHeight, 2, iQP );           
-        pcSubTempPartCU->initSubBT( rpcTempCU, uiPartUnitIdx, uiDepth, uiWidth>>1, uiHeight, 2, iQP );           // clear sub partition datas or init.
-
-#if VCEG_AZ07_IMV && !JVET_C0024_QTBT
-        for( Int size = 0 ; size < NUMBER_OF_PART_SIZES ; size++ )
-        {
-          m_pppcTempCUIMVCache[size][uiBTWidthIdx][uiBTHeightIdx]->initSubBT( rpcTempCU, uiPartUnitIdx, uiDepth, uiWidth>>1, uiHeight, 2, iQP ); 
-        }
-#endif
-#if COM16_C806_OBMC
-        m_pppcTempCUWoOBMC[uiBTWidthIdx][uiBTHeightIdx]->initSubBT( rpcTempCU, uiPartUnitIdx, uiDepth, uiWidth>>1, uiHeight, 2, iQP );  // clear sub partition datas or init.
+        xTakeSplitTask( rpcTempCU, 2, uiDepth, uiWidth, uiHeight, iQP );
+#if JVET_D0077_SAVE_LOAD_ENC_INFO
+        dVerSplitCost = min( dVerSplitCost, m_adSplitTaskCost[2] );
 #endif
-#if VCEG_AZ07_FRUC_MERGE
-        m_pppcFRUCBufferCU[uiBTWidthIdx][uiBTHeightIdx]->initSubBT( rpcTempCU, uiPartUnitIdx, uiDepth, uiWidth>>1, uiHeight, 2, iQP ); 
+      }
+      else
 #endif
-        if(( pcSubBestPartCU->getCUPelX() < pcSlice->getSPS()->getPicWidthInLumaSamples() ) && ( pcSubBestPartCU->getCUPelY() < pcSlice->getSPS()->getPicHeightInLumaSamples() ) )
-        {
-          if ( 0 == uiPartUnitIdx) //initialize RD with previous depth buffer
-          {
-            m_ppppcRDSbacCoder[uiWidthIdx-1][uiHeightIdx][CI_CURR_BEST]->load(m_ppppcRDSbacCoder[uiWidthIdx][uiHeightIdx][CI_CURR_BEST]);
-          }
-          else
-          {
-            m_ppppcRDSbacCoder[uiWidthIdx-1][uiHeightIdx][CI_CURR_BEST]->load(m_ppppcRDSbacCoder[uiWidthIdx-1][uiHeightIdx][CI_NEXT_BEST]);
-          }
-
+      xCheckRDCostBTSplit( rpcTempCU, uiDepth, uiWidth, uiHeight, uiBTSplitMode, 2, iQP,
 #if JVET_C0024_BT_RMV_REDUNDANT
-          xCompressCU( pcSubBestPartCU, pcSubTempPartCU, uiDepth, uiWidth>>1, uiHeight, pcSubBestPartCU->getBTSplitMode(0), uiSplitConstrain );
-          
-          if( uiPartUnitIdx == 0 && pcSubBestPartCU->getBTSplitModeForBTDepth(0, uiBTDepth+1) == 1 && bBTVerRmvEnable )
-          {
-              uiSplitConstrain = 1;
-          }
+                           bBTVerRmvEnable
 #else
-          xCompressCU( pcSubBestPartCU, pcSubTempPartCU, uiDepth, uiWidth>>1, uiHeight, pcSubBestPartCU->getBTSplitMode(0) );
+                           false
 #endif
-
-          rpcTempCU->copyPartFrom( pcSubBestPartCU, uiPartUnitIdx, uhNextDepth, uiWidth>>1, uiHeight );         // Keep best part data to current temporary data.
 #if JVET_C0024_DELTA_QP_FIX
-          if( pps.getUseDQP() )  // update coded QP
-          { 
-            rpcTempCU->setCodedQP( pcSubBestPartCU->getCodedQP() ); 
-            pcSubBestPartCU->setCodedQP( rpcTempCU->getCodedQP() );
-            pcSubTempPartCU->setCodedQP( rpcTempCU->getCodedQP() );
-          }
+                           , lastCodedQP
 #endif
-          xCopyYuv2Tmp( pcSubBestPartCU->getZorderIdxInCtu()-rpcTempCU->getZorderIdxInCtu(), uiWidth, uiHeight, 2 );
-        }
-      }
-
-      m_pcRDGoOnSbacCoder->load(m_ppppcRDSbacCoder[uiWidthIdx-1][uiHeightIdx][CI_NEXT_BEST]);
-      m_pcEntropyCoder->resetBits();
-      if (uiBTSplitMode==0 )
-      {
-        m_pcEntropyCoder->encodeSplitFlag( rpcTempCU, 0, uiDepth, true );
-      }
-      m_pcEntropyCoder->encodeBTSplitMode(rpcTempCU, 0, uiWidth, uiHeight, true);
-
-
-      rpcTempCU->getTotalBits() += m_pcEntropyCoder->getNumberOfWrittenBits(); // split bits
-      rpcTempCU->getTotalBins() += ((TEncBinCABAC *)((TEncSbac*)m_pcEntropyCoder->m_pcEntropyCoderIf)->getEncBinIf())->getBinsCoded();
-
-      rpcTempCU->getTotalCost()  = m_pcRdCost->calcRdCost( rpcTempCU->getTotalBits(), rpcTempCU->getTotalDistortion() );
 #if JVET_D0077_SAVE_LOAD_ENC_INFO
-      if( rpcTempCU->getTotalCost() < dVerSplitCost )
-      {
-        dVerSplitCost = rpcTempCU->getTotalCost();
-      }
-#endif
-#if JVET_C0024_DELTA_QP_FIX
-      if( uiQTBTDepth == uiMaxDQPDepthQTBT && pps.getUseDQP())
-      {
-        Bool foundNonZeroCbf = false;
-        UInt uiFirstNonZeroPartIdx = 0;
-        rpcTempCU->setQPSubCUs( rpcTempCU->getRefQP( 0 ), 0, uiDepth, uiWidth, uiHeight, uiFirstNonZeroPartIdx, foundNonZeroCbf );
-        if ( foundNonZeroCbf )
-        {
-          m_pcEntropyCoder->resetBits();
-          m_pcEntropyCoder->encodeQP( rpcTempCU, uiFirstNonZeroPartIdx, false );
-          rpcTempCU->getTotalBits() += m_pcEntropyCoder->getNumberOfWrittenBits(); // dQP bits
-          rpcTempCU->getTotalBins() += ((TEncBinCABAC *)((TEncSbac*)m_pcEntropyCoder->m_pcEntropyCoderIf)->getEncBinIf())->getBinsCoded();
-          rpcTempCU->getTotalCost()  = m_pcRdCost->calcRdCost( rpcTempCU->getTotalBits(), rpcTempCU->getTotalDistortion() );
-        }
-        else
-        {
-          rpcTempCU->setQPSubParts( rpcTempCU->getRefQP( 0 ), 0, uiWidth, uiHeight ); // set QP to default QP
-#if JVET_C0024_DELTA_QP_FIX
-          if( pps.getUseDQP() ) // update coded QP
-          { 
-            rpcTempCU->setCodedQP( rpcTempCU->getQP( 0 ) ); 
-          }
+                           , dVerSplitCost
 #endif
-        }
-      }
-#endif
-      m_pcRDGoOnSbacCoder->store(m_ppppcRDSbacCoder[uiWidthIdx][uiHeightIdx][CI_TEMP_BEST]);
+                           );
 
       if (rpcBestCU->getTotalCost()!=MAX_DOUBLE)
       {
@@ -2821,11 +2667,7 @@ Void TEncCu::xCompressCU( TComDataCU*& rpcBestCU, TComDataCU*& rpcTempCU, const
 #endif
   }
 
-  UInt uiZorderBR = g_auiRasterToZscan[((uiHeight>> MIN_CU_LOG2)-1) * (sps.getCTUSize()>> MIN_CU_LOG2) + (uiWidth>> MIN_CU_LOG2)-1];  //bottom-right part.
-
-  if (bQTSplit && ((rpcBestCU->getBTDepth(0)==0 && uiMaxBTD>=(rpcBestCU->getSlice()->isIntra() ? 3: 2) )
-    || (rpcBestCU->getBTDepth(0)==1 && rpcBestCU->getBTDepth(uiZorderBR)==1 && uiMaxBTD>=(rpcBestCU->getSlice()->isIntra()? 4: 3))) 
-    && bTestHorSplit && bTestVerSplit ) 
+  if (bQTSplit && bTestHorSplit && bTestVerSplit && xSkipQTSplit( rpcBestCU, uiWidth, uiHeight, uiMaxBTD ) )
   {
     bQTSplit = false;
   }
@@ -2833,9 +2675,50 @@ Void TEncCu::xCompressCU( TComDataCU*& rpcBestCU, TComDataCU*& rpcTempCU, const
 
 #if JVET_C0024_QTBT
   if( bQTSplit)
+  {
+    // further split
+    for (Int iQP=iMinQP; iQP<=iMaxQP; iQP++)
+    {
+      DEBUG_STRING_NEW(sTempDebug)
+#if QTBT_PARALLEL_SPLIT
+      if( !bSplitTasks || !xTakeSplitTask( rpcTempCU, 0, uiDepth, uiWidth, uiHeight, iQP ) )
+#endif
+      xCheckRDCostQTSplit( rpcTempCU, uiDepth, uiWidth, uiHeight, iQP, bBoundary, bForceQT
+#if JVET_C0024_DELTA_QP_FIX
+                           , lastCodedQP
+#endif
+                           DEBUG_STRING_PASS_INTO(sTempDebug) );
+
+      // If the configuration being tested exceeds the maximum number of bytes for a slice / slice-segment, then
+      // a proper RD evaluation cannot be performed. Therefore, termination of the
+      // slice/slice-segment must be made prior to this CTU.
+      // This can be achieved by forcing the decision to be that of the rpcTempCU.
+      // The exception is each slice / slice-segment must have at least one CTU.
+      if (rpcBestCU->getTotalCost()!=MAX_DOUBLE)
+      {
+        const Bool isEndOfSlice        =    pcSlice->getSliceMode()==FIXED_NUMBER_OF_BYTES
+                                         && ((pcSlice->getSliceBits()+rpcBestCU->getTotalBits())>pcSlice->getSliceArgument()<<3)
+                                         && rpcBestCU->getCtuRsAddr() != pcPic->getPicSym()->getCtuTsToRsAddrMap(pcSlice->getSliceCurStartCtuTsAddr())
+                                         && rpcBestCU->getCtuRsAddr() != pcPic->getPicSym()->getCtuTsToRsAddrMap(pcSlice->getSliceSegmentCurStartCtuTsAddr());
+        const Bool isEndOfSliceSegment =    pcSlice->getSliceSegmentMode()==FIXED_NUMBER_OF_BYTES
+                                         && ((pcSlice->getSliceSegmentBits()+rpcBestCU->getTotalBits()) > pcSlice->getSliceSegmentArgument()<<3)
+                                         && rpcBestCU->getCtuRsAddr() != pcPic->getPicSym()->getCtuTsToRsAddrMap(pcSlice->getSliceSegmentCurStartCtuTsAddr());
+                                             // Do not need to check slice condition for slice-segment since a slice-segment is a subset of a slice.
+        if(isEndOfSlice||isEndOfSliceSegment)
+        {
+          rpcBestCU->getTotalCost()=MAX_DOUBLE;
+        }
+      }
+
+
+      xCheckBestMode( rpcBestCU, rpcTempCU, uiDepth, uiWidth, uiHeight DEBUG_STRING_PASS_INTO(sDebug) DEBUG_STRING_PASS_INTO(sTempDebug) DEBUG_STRING_PASS_INTO(false) ); // RD compare current larger prediction
+      rpcBestCU->getPic()->setCodedBlkInCTU(false, uiPelXInCTU>>MIN_CU_LOG2, uiPelYInCTU>>MIN_CU_LOG2, uiWidth>>MIN_CU_LOG2, uiHeight>>MIN_CU_LOG2 );  
+      rpcBestCU->getPic()->addCodedAreaInCTU(-(Int)uiWidth*uiHeight);
+      // with sub partitioned prediction.
+    }
+  }
 #else
   if( bSubBranch && uiDepth < sps.getLog2DiffMaxMinCodingBlockSize() && (!getFastDeltaQp() || uiWidth > fastDeltaQPCuMaxSize || bBoundary))
-#endif
   {
     // further split
     for (Int iQP=iMinQP; iQP<=iMaxQP; iQP++)
@@ -2845,15 +2728,8 @@ Void TEncCu::xCompressCU( TComDataCU*& rpcBestCU, TComDataCU*& rpcTempCU, const
       rpcTempCU->initEstData( uiDepth, iQP, bIsLosslessMode );
 
       UChar       uhNextDepth         = uiDepth+1;
-#if JVET_C0024_QTBT
-      UInt uiQTWidthIdx = g_aucConvertToBit[uiWidth>>1];  
-      UInt uiQTHeightIdx = g_aucConvertToBit[uiHeight>>1];
-      TComDataCU* pcSubBestPartCU     = m_pppcBestCU[uiQTWidthIdx][uiQTHeightIdx];
-      TComDataCU* pcSubTempPartCU     = m_pppcTempCU[uiQTWidthIdx][uiQTHeightIdx];
-#else
       TComDataCU* pcSubBestPartCU     = m_ppcBestCU[uhNextDepth];
       TComDataCU* pcSubTempPartCU     = m_ppcTempCU[uhNextDepth];
-#endif
       DEBUG_STRING_NEW(sTempDebug)
 #if JVET_C0024_DELTA_QP_FIX // inherit quantization group info. from parent CU.
       if( pps.getUseDQP() )
@@ -2873,42 +2749,20 @@ Void TEncCu::xCompressCU( TComDataCU*& rpcBestCU, TComDataCU*& rpcTempCU, const
       {
         pcSubBestPartCU->initSubCU( rpcTempCU, uiPartUnitIdx, uhNextDepth, iQP );           // clear sub partition datas or init.
         pcSubTempPartCU->initSubCU( rpcTempCU, uiPartUnitIdx, uhNextDepth, iQP );           // clear sub partition datas or init.
-#if VCEG_AZ07_IMV && !JVET_C0024_QTBT
+#if VCEG_AZ07_IMV
         for( Int size = 0 ; size < NUMBER_OF_PART_SIZES ; size++ )
         {
-#if JVET_C0024_QTBT
-            m_pppcTempCUIMVCache[size][uiQTWidthIdx][uiQTHeightIdx]->initSubCU( rpcTempCU, uiPartUnitIdx, uhNextDepth, iQP );
-#else
           m_ppcTempCUIMVCache[size][uhNextDepth]->initSubCU( rpcTempCU, uiPartUnitIdx, uhNextDepth, iQP );
-#endif
         }
 #endif
 #if COM16_C806_OBMC
-#if JVET_C0024_QTBT
-          m_pppcTempCUWoOBMC[uiQTWidthIdx][uiQTHeightIdx]->initSubCU( rpcTempCU, uiPartUnitIdx, uhNextDepth, iQP ); // clear sub partition datas or init.
-#else
         m_ppcTempCUWoOBMC[uhNextDepth]->initSubCU( rpcTempCU, uiPartUnitIdx, uhNextDepth, iQP ); // clear sub partition datas or init.
 #endif
-#endif
 #if VCEG_AZ07_FRUC_MERGE
-#if JVET_C0024_QTBT
-          m_pppcFRUCBufferCU[uiQTWidthIdx][uiQTHeightIdx]->initSubCU( rpcTempCU, uiPartUnitIdx, uhNextDepth, iQP ); 
-#else
         m_ppcFRUCBufferCU[uhNextDepth]->initSubCU( rpcTempCU, uiPartUnitIdx, uhNextDepth, iQP ); 
-#endif
 #endif
         if( ( pcSubBestPartCU->getCUPelX() < sps.getPicWidthInLumaSamples() ) && ( pcSubBestPartCU->getCUPelY() < sps.getPicHeightInLumaSamples() ) )
         {
-#if JVET_C0024_QTBT
-            if ( 0 == uiPartUnitIdx) //initialize RD with previous depth buffer
-            {
-              m_ppppcRDSbacCoder[uiQTWidthIdx][uiQTHeightIdx][CI_CURR_BEST]->load(m_ppppcRDSbacCoder[uiWidthIdx][uiHeightIdx][CI_CURR_BEST]);
-            }
-            else
-            {
-              m_ppppcRDSbacCoder[uiQTWidthIdx][uiQTHeightIdx][CI_CURR_BEST]->load(m_ppppcRDSbacCoder[uiQTWidthIdx][uiQTHeightIdx][CI_NEXT_BEST]);
-            }
-#else
           if ( 0 == uiPartUnitIdx) //initialize RD with previous depth buffer
           {
             m_pppcRDSbacCoder[uhNextDepth][CI_CURR_BEST]->load(m_pppcRDSbacCoder[uiDepth][CI_CURR_BEST]);
@@ -2917,13 +2771,9 @@ Void TEncCu::xCompressCU( TComDataCU*& rpcBestCU, TComDataCU*& rpcTempCU, const
           {
             m_pppcRDSbacCoder[uhNextDepth][CI_CURR_BEST]->load(m_pppcRDSbacCoder[uhNextDepth][CI_NEXT_BEST]);
           }
-#endif
 
 #if AMP_ENC_SPEEDUP
           DEBUG_STRING_NEW(sChild)
-#if JVET_C0024_QTBT
-              xCompressCU( pcSubBestPartCU, pcSubTempPartCU, uhNextDepth, uiWidth>>1, uiHeight>>1 DEBUG_STRING_PASS_INTO(sChild), SIZE_2Nx2N );
-#else
           if ( !(rpcBestCU->getTotalCost()!=MAX_DOUBLE && rpcBestCU->isInter(0)) )
           {
             xCompressCU( pcSubBestPartCU, pcSubTempPartCU, uhNextDepth DEBUG_STRING_PASS_INTO(sChild), NUMBER_OF_PART_SIZES );
@@ -2933,54 +2783,25 @@ Void TEncCu::xCompressCU( TComDataCU*& rpcBestCU, TComDataCU*& rpcTempCU, const
 
             xCompressCU( pcSubBestPartCU, pcSubTempPartCU, uhNextDepth DEBUG_STRING_PASS_INTO(sChild), rpcBestCU->getPartitionSize(0) );
           }
-#endif
           DEBUG_STRING_APPEND(sTempDebug, sChild)
 #else
           xCompressCU( pcSubBestPartCU, pcSubTempPartCU, uhNextDepth );
 #endif
 
-#if JVET_C0024_QTBT
-            rpcTempCU->copyPartFrom( pcSubBestPartCU, uiPartUnitIdx, uhNextDepth, uiWidth>>1, uiHeight>>1 );         // Keep best part data to current temporary data.
-#if JVET_C0024_DELTA_QP_FIX
-            if( pps.getUseDQP() )  // update coded QP
-            { 
-              rpcTempCU->setCodedQP( pcSubBestPartCU->getCodedQP() ); 
-              pcSubBestPartCU->setCodedQP( rpcTempCU->getCodedQP() );
-              pcSubTempPartCU->setCodedQP( rpcTempCU->getCodedQP() );
-            }
-#endif
-            assert(pcSubBestPartCU->getTotalNumPart()*uiPartUnitIdx == pcSubBestPartCU->getZorderIdxInCtu()-rpcTempCU->getZorderIdxInCtu());       
-            xCopyYuv2Tmp( pcSubBestPartCU->getTotalNumPart()*uiPartUnitIdx, uiWidth, uiHeight );
-#else
           rpcTempCU->copyPartFrom( pcSubBestPartCU, uiPartUnitIdx, uhNextDepth );         // Keep best part data to current temporary data.
           xCopyYuv2Tmp( pcSubBestPartCU->getTotalNumPart()*uiPartUnitIdx, uhNextDepth );
-#endif
         }
         else
         {
-#if JVET_C0024_QTBT
-            pcSubBestPartCU->copyToPic( uhNextDepth, uiWidth>>1, uiHeight>>1 );
-            rpcTempCU->copyPartFrom( pcSubBestPartCU, uiPartUnitIdx, uhNextDepth, uiWidth>>1, uiHeight>>1 );
-
-            rpcBestCU->getPic()->addCodedAreaInCTU(uiWidth*uiHeight>>2);
-#else
           pcSubBestPartCU->copyToPic( uhNextDepth );
           rpcTempCU->copyPartFrom( pcSubBestPartCU, uiPartUnitIdx, uhNextDepth );
-#endif
         }
       }
 
-#if JVET_C0024_QTBT
-        m_pcRDGoOnSbacCoder->load(m_ppppcRDSbacCoder[uiQTWidthIdx][uiQTHeightIdx][CI_NEXT_BEST]);
-#else
       m_pcRDGoOnSbacCoder->load(m_pppcRDSbacCoder[uhNextDepth][CI_NEXT_BEST]);
-#endif
       if( !bBoundary )
       {
         m_pcEntropyCoder->resetBits();
-#if JVET_C0024_QTBT
-        if( !bForceQT )
-#endif
         m_pcEntropyCoder->encodeSplitFlag( rpcTempCU, 0, uiDepth, true );
 
         rpcTempCU->getTotalBits() += m_pcEntropyCoder->getNumberOfWrittenBits(); // split bits
@@ -3072,11 +2893,7 @@ Void TEncCu::xCompressCU( TComDataCU*& rpcBestCU, TComDataCU*& rpcTempCU, const
         }
       }
 
-#if JVET_C0024_QTBT
-        m_pcRDGoOnSbacCoder->store(m_ppppcRDSbacCoder[uiWidthIdx][uiHeightIdx][CI_TEMP_BEST]);
-#else
       m_pcRDGoOnSbacCoder->store(m_pppcRDSbacCoder[uiDepth][CI_TEMP_BEST]);
-#endif
 
       // If the configuration being tested exceeds the maximum number of bytes for a slice / slice-segment, then
       // a proper RD evaluation cannot be performed. Therefore, termination of the
@@ -3100,16 +2917,11 @@ Void TEncCu::xCompressCU( TComDataCU*& rpcBestCU, TComDataCU*& rpcTempCU, const
       }
 
 
-#if JVET_C0024_QTBT
-        xCheckBestMode( rpcBestCU, rpcTempCU, uiDepth, uiWidth, uiHeight DEBUG_STRING_PASS_INTO(sDebug) DEBUG_STRING_PASS_INTO(sTempDebug) DEBUG_STRING_PASS_INTO(false) ); // RD compare current larger prediction
-        rpcBestCU->getPic()->setCodedBlkInCTU(false, uiPelXInCTU>>MIN_CU_LOG2, uiPelYInCTU>>MIN_CU_LOG2, uiWidth>>MIN_CU_LOG2, uiHeight>>MIN_CU_LOG2 );  
-        rpcBestCU->getPic()->addCodedAreaInCTU(-(Int)uiWidth*uiHeight);
-#else
       xCheckBestMode( rpcBestCU, rpcTempCU, uiDepth DEBUG_STRING_PASS_INTO(sDebug) DEBUG_STRING_PASS_INTO(sTempDebug) DEBUG_STRING_PASS_INTO(false) ); // RD compare current larger prediction
-#endif
         // with sub partitioned prediction.
     }
   }
+#endif
 
   DEBUG_STRING_APPEND(sDebug_, sDebug);
 
@@ -3162,6 +2974,560 @@ Void TEncCu::xCompressCU( TComDataCU*& rpcBestCU, TComDataCU*& rpcTempCU, const
 #endif
 }
 
+#if JVET_C0024_QTBT
+/** Compresses the two halves of the CU of rpcTempCU split horizontally (uiSplitMethod 1) or vertically (2) into rpcTempCU
+ *  and the temporary YUV of its size, adds the bits of the split and stores the contexts after it to CI_TEMP_BEST.
+ *  With bRmvEnable the second half is not split as the first one in the other direction.
+ */
+Void TEncCu::xCheckRDCostBTSplit( TComDataCU*& rpcTempCU, const UInt uiDepth, UInt uiWidth, UInt uiHeight, UInt uiBTSplitMode, UInt uiSplitMethod, Int iQP, Bool bRmvEnable
+#if JVET_C0024_DELTA_QP_FIX
+                                , const Char lastCodedQP
+#endif
+#if JVET_D0077_SAVE_LOAD_ENC_INFO
+                                , Double& rdSplitCost
+#endif
+                                )
+{
+  const TComPPS &pps = *(rpcTempCU->getSlice()->getPPS());
+  const TComSPS &sps = *(rpcTempCU->getSlice()->getSPS());
+  const UInt uiWidthIdx  = g_aucConvertToBit[uiWidth];
+  const UInt uiHeightIdx = g_aucConvertToBit[uiHeight];
+  const UInt uiSubWidth  = uiSplitMethod == 2 ? uiWidth >> 1 : uiWidth;
+  const UInt uiSubHeight = uiSplitMethod == 1 ? uiHeight >> 1 : uiHeight;
+  const UInt uiQTSize    = sps.getCTUSize() >> uiDepth;
+  const UInt uiBTDepth   = g_aucConvertToBit[uiQTSize]-g_aucConvertToBit[uiWidth] + g_aucConvertToBit[uiQTSize]-g_aucConvertToBit[uiHeight];
+#if JVET_C0024_DELTA_QP_FIX
+  const UInt uiQTBTDepth = (uiDepth<<1) + uiBTDepth;
+  const UInt uiMaxDQPDepthQTBT = pps.getMaxCuDQPDepth() << 1;
+#endif
+
+  const Bool bIsLosslessMode = false; // False at this level. Next level down may set it to true.
+
+  rpcTempCU->initEstData( uiDepth, iQP, bIsLosslessMode );
+
+  UChar       uhNextDepth         = uiDepth;
+  UInt uiBTWidthIdx = g_aucConvertToBit[uiSubWidth];
+  UInt uiBTHeightIdx = g_aucConvertToBit[uiSubHeight];
+  TComDataCU* pcSubBestPartCU     = m_pppcBestCU[uiBTWidthIdx][uiBTHeightIdx];
+  TComDataCU* pcSubTempPartCU     = m_pppcTempCU[uiBTWidthIdx][uiBTHeightIdx];
+  rpcTempCU->setBTSplitModeSubParts(uiSplitMethod, 0, uiWidth, uiHeight);
+#if JVET_C0024_BT_RMV_REDUNDANT
+  UInt uiSplitConstrain = 0;
+#endif
+#if JVET_C0024_DELTA_QP_FIX
+  if( pps.getUseDQP() ) // inherit quantization group info. from parent CU.
+  {
+    pcSubBestPartCU->initSubBT( rpcTempCU, 0, uiDepth, uiSubWidth, uiSubHeight, uiSplitMethod, iQP );
+    pcSubTempPartCU->initSubBT( rpcTempCU, 0, uiDepth, uiSubWidth, uiSubHeight, uiSplitMethod, iQP );           // clear sub partition datas or init.
+    pcSubBestPartCU->setCodedQP( lastCodedQP );
+    pcSubTempPartCU->setCodedQP( lastCodedQP );
+    pcSubBestPartCU->setQuPartIdx( rpcTempCU->getQuPartIdx() );
+    pcSubTempPartCU->setQuPartIdx( rpcTempCU->getQuPartIdx() );
+    pcSubBestPartCU->setQuLastCodedQP( rpcTempCU->getQuLastCodedQP() );
+    pcSubTempPartCU->setQuLastCodedQP( rpcTempCU->getQuLastCodedQP() );
+  }
+#endif
+
+  for ( UInt uiPartUnitIdx = 0; uiPartUnitIdx < 2; uiPartUnitIdx++ )
+  {
+    pcSubBestPartCU->initSubBT( rpcTempCU, uiPartUnitIdx, uiDepth, uiSubWidth, uiSubHeight, uiSplitMethod, iQP );
+    pcSubTempPartCU->initSubBT( rpcTempCU, uiPartUnitIdx, uiDepth, uiSubWidth, uiSubHeight, uiSplitMethod, iQP );           // clear sub partition datas or init.
+#if COM16_C806_OBMC
+    m_pppcTempCUWoOBMC[uiBTWidthIdx][uiBTHeightIdx]->initSubBT( rpcTempCU, uiPartUnitIdx, uiDepth, uiSubWidth, uiSubHeight, uiSplitMethod, iQP );  // clear sub partition datas or init.
+#endif
+#if VCEG_AZ07_FRUC_MERGE
+    m_pppcFRUCBufferCU[uiBTWidthIdx][uiBTHeightIdx]->initSubBT( rpcTempCU, uiPartUnitIdx, uiDepth, uiSubWidth, uiSubHeight, uiSplitMethod, iQP );
+#endif
+    if(( pcSubBestPartCU->getCUPelX() < sps.getPicWidthInLumaSamples() ) && ( pcSubBestPartCU->getCUPelY() < sps.getPicHeightInLumaSamples() ) )
+    {
+      if ( 0 == uiPartUnitIdx) //initialize RD with previous depth buffer
+      {
+        m_ppppcRDSbacCoder[uiBTWidthIdx][uiBTHeightIdx][CI_CURR_BEST]->load(m_ppppcRDSbacCoder[uiWidthIdx][uiHeightIdx][CI_CURR_BEST]);
+      }
+      else
+      {
+        m_ppppcRDSbacCoder[uiBTWidthIdx][uiBTHeightIdx][CI_CURR_BEST]->load(m_ppppcRDSbacCoder[uiBTWidthIdx][uiBTHeightIdx][CI_NEXT_BEST]);
+      }
+#if JVET_C0024_BT_RMV_REDUNDANT
+      xCompressCU( pcSubBestPartCU, pcSubTempPartCU, uiDepth, uiSubWidth, uiSubHeight, pcSubBestPartCU->getBTSplitMode(0), uiSplitConstrain );
+
+      // the first half split in the other direction: the second one may not repeat it
+      if( uiPartUnitIdx == 0 && pcSubBestPartCU->getBTSplitModeForBTDepth(0, uiBTDepth+1) == 3-uiSplitMethod && bRmvEnable )
+      {
+        uiSplitConstrain = 3-uiSplitMethod;
+      }
+#else
+      xCompressCU( pcSubBestPartCU, pcSubTempPartCU, uiDepth, uiSubWidth, uiSubHeight, pcSubBestPartCU->getBTSplitMode(0) );
+#endif
+      rpcTempCU->copyPartFrom( pcSubBestPartCU, uiPartUnitIdx, uhNextDepth, uiSubWidth, uiSubHeight );         // Keep best part data to current temporary data.
+#if JVET_C0024_DELTA_QP_FIX
+      if( pps.getUseDQP() ) // update coded QP
+      { 
+        rpcTempCU->setCodedQP( pcSubBestPartCU->getCodedQP() ); 
+        pcSubBestPartCU->setCodedQP( rpcTempCU->getCodedQP() );
+        pcSubTempPartCU->setCodedQP( rpcTempCU->getCodedQP() );
+      }
+#endif
+      xCopyYuv2Tmp( pcSubBestPartCU->getZorderIdxInCtu()-rpcTempCU->getZorderIdxInCtu(), uiWidth, uiHeight, uiSplitMethod );
+    }
+  }
+  m_pcRDGoOnSbacCoder->load(m_ppppcRDSbacCoder[uiBTWidthIdx][uiBTHeightIdx][CI_NEXT_BEST]);
+  m_pcEntropyCoder->resetBits();
+  if (uiBTSplitMode==0 )
+  {
+    m_pcEntropyCoder->encodeSplitFlag( rpcTempCU, 0, uiDepth, true );
+  }
+  m_pcEntropyCoder->encodeBTSplitMode(rpcTempCU, 0, uiWidth, uiHeight, true);
+
+
+  rpcTempCU->getTotalBits() += m_pcEntropyCoder->getNumberOfWrittenBits(); // split bits
+  rpcTempCU->getTotalBins() += ((TEncBinCABAC *)((TEncSbac*)m_pcEntropyCoder->m_pcEntropyCoderIf)->getEncBinIf())->getBinsCoded();
+
+  rpcTempCU->getTotalCost()  = m_pcRdCost->calcRdCost( rpcTempCU->getTotalBits(), rpcTempCU->getTotalDistortion() );
+#if JVET_D0077_SAVE_LOAD_ENC_INFO
+  if( rpcTempCU->getTotalCost() < rdSplitCost )
+  {
+    rdSplitCost = rpcTempCU->getTotalCost();
+  }
+#endif
+#if JVET_C0024_DELTA_QP_FIX
+  if( uiQTBTDepth == uiMaxDQPDepthQTBT && pps.getUseDQP())
+  {
+    Bool foundNonZeroCbf = false;
+    UInt uiFirstNonZeroPartIdx = 0;
+    rpcTempCU->setQPSubCUs( rpcTempCU->getRefQP( 0 ), 0, uiDepth, uiWidth, uiHeight, uiFirstNonZeroPartIdx, foundNonZeroCbf );
+    if ( foundNonZeroCbf )
+    {
+      m_pcEntropyCoder->resetBits();
+      m_pcEntropyCoder->encodeQP( rpcTempCU, uiFirstNonZeroPartIdx, false );
+      rpcTempCU->getTotalBits() += m_pcEntropyCoder->getNumberOfWrittenBits(); // dQP bits
+      rpcTempCU->getTotalBins() += ((TEncBinCABAC *)((TEncSbac*)m_pcEntropyCoder->m_pcEntropyCoderIf)->getEncBinIf())->getBinsCoded();
+      rpcTempCU->getTotalCost()  = m_pcRdCost->calcRdCost( rpcTempCU->getTotalBits(), rpcTempCU->getTotalDistortion() );
+    }
+    else
+    {
+      rpcTempCU->setQPSubParts( rpcTempCU->getRefQP( 0 ), 0, uiWidth, uiHeight ); // set QP to default QP
+      if( pps.getUseDQP() ) // update coded QP
+      { 
+        rpcTempCU->setCodedQP( rpcTempCU->getQP( 0 ) ); 
+      }
+    }
+  }
+#endif
+  m_pcRDGoOnSbacCoder->store(m_ppppcRDSbacCoder[uiWidthIdx][uiHeightIdx][CI_TEMP_BEST]);
+}
+
+/** Compresses the four quarters of the CU of rpcTempCU into rpcTempCU and the temporary YUV of its size, adds the bits of
+ *  the split and stores the contexts after it to CI_TEMP_BEST. The quarters outside the picture of a boundary CU are not coded.
+ */
+Void TEncCu::xCheckRDCostQTSplit( TComDataCU*& rpcTempCU, const UInt uiDepth, UInt uiWidth, UInt uiHeight, Int iQP, Bool bBoundary, Bool bForceQT
+#if JVET_C0024_DELTA_QP_FIX
+                                , const Char lastCodedQP
+#endif
+                                DEBUG_STRING_FN_DECLARE(sTempDebug) )
+{
+  const TComPPS &pps = *(rpcTempCU->getSlice()->getPPS());
+  const TComSPS &sps = *(rpcTempCU->getSlice()->getSPS());
+  const UInt uiWidthIdx  = g_aucConvertToBit[uiWidth];
+  const UInt uiHeightIdx = g_aucConvertToBit[uiHeight];
+  const UInt numberValidComponents = rpcTempCU->getPic()->getNumberValidComponents();
+#if JVET_C0024_DELTA_QP_FIX
+  const UInt uiQTSize    = sps.getCTUSize() >> uiDepth;
+  const UInt uiBTDepth   = g_aucConvertToBit[uiQTSize]-g_aucConvertToBit[uiWidth] + g_aucConvertToBit[uiQTSize]-g_aucConvertToBit[uiHeight];
+  const UInt uiQTBTDepth = (uiDepth<<1) + uiBTDepth;
+  const UInt uiMaxDQPDepthQTBT = pps.getMaxCuDQPDepth() << 1;
+#endif
+
+  const Bool bIsLosslessMode = false; // False at this level. Next level down may set it to true.
+#if QTBT_PARALLEL_SPLIT
+  // the QT task stops between the sub CUs of its CU only, the nested candidates run to completion
+  const std::atomic<Bool>* pbCancel = m_pbSplitTaskCancel;
+  m_pbSplitTaskCancel = NULL;
+#endif
+
+  rpcTempCU->initEstData( uiDepth, iQP, bIsLosslessMode );
+
+  UChar       uhNextDepth         = uiDepth+1;
+  UInt uiQTWidthIdx = g_aucConvertToBit[uiWidth>>1];  
+  UInt uiQTHeightIdx = g_aucConvertToBit[uiHeight>>1];
+  TComDataCU* pcSubBestPartCU     = m_pppcBestCU[uiQTWidthIdx][uiQTHeightIdx];
+  TComDataCU* pcSubTempPartCU     = m_pppcTempCU[uiQTWidthIdx][uiQTHeightIdx];
+#if JVET_C0024_DELTA_QP_FIX // inherit quantization group info. from parent CU.
+  if( pps.getUseDQP() )
+  {
+    pcSubBestPartCU->initSubCU( rpcTempCU, 0, uhNextDepth, iQP );           // clear sub partition datas or init.
+    pcSubTempPartCU->initSubCU( rpcTempCU, 0, uhNextDepth, iQP );           // clear sub partition datas or init.
+    pcSubBestPartCU->setCodedQP( lastCodedQP );
+    pcSubTempPartCU->setCodedQP( lastCodedQP );
+    pcSubBestPartCU->setQuPartIdx( rpcTempCU->getQuPartIdx() );
+    pcSubTempPartCU->setQuPartIdx( rpcTempCU->getQuPartIdx() );
+    pcSubBestPartCU->setQuLastCodedQP( rpcTempCU->getQuLastCodedQP() );
+    pcSubTempPartCU->setQuLastCodedQP( rpcTempCU->getQuLastCodedQP() );
+  }
+#endif
+
+  for ( UInt uiPartUnitIdx = 0; uiPartUnitIdx < 4; uiPartUnitIdx++ )
+  {
+#if QTBT_PARALLEL_SPLIT
+    if( pbCancel != NULL && pbCancel->load( std::memory_order_relaxed ) )
+    {
+      return;   // the QT task is dropped, rpcTempCU keeps the cost of initEstData()
+    }
+#endif
+    pcSubBestPartCU->initSubCU( rpcTempCU, uiPartUnitIdx, uhNextDepth, iQP );           // clear sub partition datas or init.
+    pcSubTempPartCU->initSubCU( rpcTempCU, uiPartUnitIdx, uhNextDepth, iQP );           // clear sub partition datas or init.
+#if COM16_C806_OBMC
+    m_pppcTempCUWoOBMC[uiQTWidthIdx][uiQTHeightIdx]->initSubCU( rpcTempCU, uiPartUnitIdx, uhNextDepth, iQP ); // clear sub partition datas or init.
+#endif
+#if VCEG_AZ07_FRUC_MERGE
+    m_pppcFRUCBufferCU[uiQTWidthIdx][uiQTHeightIdx]->initSubCU( rpcTempCU, uiPartUnitIdx, uhNextDepth, iQP ); 
+#endif
+    if( ( pcSubBestPartCU->getCUPelX() < sps.getPicWidthInLumaSamples() ) && ( pcSubBestPartCU->getCUPelY() < sps.getPicHeightInLumaSamples() ) )
+    {
+      if ( 0 == uiPartUnitIdx) //initialize RD with previous depth buffer
+      {
+        m_ppppcRDSbacCoder[uiQTWidthIdx][uiQTHeightIdx][CI_CURR_BEST]->load(m_ppppcRDSbacCoder[uiWidthIdx][uiHeightIdx][CI_CURR_BEST]);
+      }
+      else
+      {
+        m_ppppcRDSbacCoder[uiQTWidthIdx][uiQTHeightIdx][CI_CURR_BEST]->load(m_ppppcRDSbacCoder[uiQTWidthIdx][uiQTHeightIdx][CI_NEXT_BEST]);
+      }
+
+#if AMP_ENC_SPEEDUP
+      DEBUG_STRING_NEW(sChild)
+      xCompressCU( pcSubBestPartCU, pcSubTempPartCU, uhNextDepth, uiWidth>>1, uiHeight>>1 DEBUG_STRING_PASS_INTO(sChild), SIZE_2Nx2N );
+      DEBUG_STRING_APPEND(sTempDebug, sChild)
+#else
+      xCompressCU( pcSubBestPartCU, pcSubTempPartCU, uhNextDepth );
+#endif
+
+      rpcTempCU->copyPartFrom( pcSubBestPartCU, uiPartUnitIdx, uhNextDepth, uiWidth>>1, uiHeight>>1 );         // Keep best part data to current temporary data.
+#if JVET_C0024_DELTA_QP_FIX
+      if( pps.getUseDQP() )  // update coded QP
+      { 
+        rpcTempCU->setCodedQP( pcSubBestPartCU->getCodedQP() ); 
+        pcSubBestPartCU->setCodedQP( rpcTempCU->getCodedQP() );
+        pcSubTempPartCU->setCodedQP( rpcTempCU->getCodedQP() );
+      }
+#endif
+      assert(pcSubBestPartCU->getTotalNumPart()*uiPartUnitIdx == pcSubBestPartCU->getZorderIdxInCtu()-rpcTempCU->getZorderIdxInCtu());       
+      xCopyYuv2Tmp( pcSubBestPartCU->getTotalNumPart()*uiPartUnitIdx, uiWidth, uiHeight );
+    }
+    else
+    {
+      pcSubBestPartCU->copyToPic( uhNextDepth, uiWidth>>1, uiHeight>>1 );
+      rpcTempCU->copyPartFrom( pcSubBestPartCU, uiPartUnitIdx, uhNextDepth, uiWidth>>1, uiHeight>>1 );
+
+      rpcTempCU->getPic()->addCodedAreaInCTU(uiWidth*uiHeight>>2);
+    }
+  }
+
+  m_pcRDGoOnSbacCoder->load(m_ppppcRDSbacCoder[uiQTWidthIdx][uiQTHeightIdx][CI_NEXT_BEST]);
+  if( !bBoundary )
+  {
+    m_pcEntropyCoder->resetBits();
+    if( !bForceQT )
+    {
+      m_pcEntropyCoder->encodeSplitFlag( rpcTempCU, 0, uiDepth, true );
+    }
+
+    rpcTempCU->getTotalBits() += m_pcEntropyCoder->getNumberOfWrittenBits(); // split bits
+    rpcTempCU->getTotalBins() += ((TEncBinCABAC *)((TEncSbac*)m_pcEntropyCoder->m_pcEntropyCoderIf)->getEncBinIf())->getBinsCoded();
+  }
+  rpcTempCU->getTotalCost()  = m_pcRdCost->calcRdCost( rpcTempCU->getTotalBits(), rpcTempCU->getTotalDistortion() );
+
+#if JVET_C0024_DELTA_QP_FIX
+  if( uiQTBTDepth == uiMaxDQPDepthQTBT && pps.getUseDQP())
+#else
+  if( uiDepth == pps.getMaxCuDQPDepth() && pps.getUseDQP())
+#endif
+  {
+    Bool hasResidual = false;
+    for( UInt uiBlkIdx = 0; uiBlkIdx < rpcTempCU->getTotalNumPart(); uiBlkIdx ++)
+    {
+#if JVET_C0024_DELTA_QP_FIX
+      if( rpcTempCU->getSlice()->isIntra() )
+      {
+        if( rpcTempCU->getTextType() == CHANNEL_TYPE_LUMA )
+        {
+          if( rpcTempCU->getCbf(uiBlkIdx, COMPONENT_Y) )
+          {
+            hasResidual = true;
+          }
+        }
+        else
+        {
+          if(  (rpcTempCU->getCbf(uiBlkIdx, COMPONENT_Cb) && (numberValidComponents > COMPONENT_Cb)) ||
+               (rpcTempCU->getCbf(uiBlkIdx, COMPONENT_Cr) && (numberValidComponents > COMPONENT_Cr)) )
+          {
+            hasResidual = true;
+          }
+        }
+      }
+      else
+#endif
+      if( (     rpcTempCU->getCbf(uiBlkIdx, COMPONENT_Y)
+            || (rpcTempCU->getCbf(uiBlkIdx, COMPONENT_Cb) && (numberValidComponents > COMPONENT_Cb))
+            || (rpcTempCU->getCbf(uiBlkIdx, COMPONENT_Cr) && (numberValidComponents > COMPONENT_Cr)) ) )
+      {
+        hasResidual = true;
+        break;
+      }
+    }
+
+    if ( hasResidual )
+    {
+#if JVET_C0024_DELTA_QP_FIX
+      Bool foundNonZeroCbf = false;
+      UInt uiFirstNonZeroPartIdx = 0;
+
+      rpcTempCU->setQPSubCUs( rpcTempCU->getRefQP( 0 ), 0, uiDepth, uiWidth, uiHeight, uiFirstNonZeroPartIdx, foundNonZeroCbf );
+      
+      m_pcEntropyCoder->resetBits();
+#if FIX_TICKET39
+      m_pcEntropyCoder->encodeQP( rpcTempCU, uiFirstNonZeroPartIdx, false );
+#else
+      m_pcEntropyCoder->encodeQP( rpcTempCU, 0, false );
+#endif
+      rpcTempCU->getTotalBits() += m_pcEntropyCoder->getNumberOfWrittenBits(); // dQP bits
+      rpcTempCU->getTotalBins() += ((TEncBinCABAC *)((TEncSbac*)m_pcEntropyCoder->m_pcEntropyCoderIf)->getEncBinIf())->getBinsCoded();
+      rpcTempCU->getTotalCost()  = m_pcRdCost->calcRdCost( rpcTempCU->getTotalBits(), rpcTempCU->getTotalDistortion() );
+#else
+      m_pcEntropyCoder->resetBits();
+      m_pcEntropyCoder->encodeQP( rpcTempCU, 0, false );
+      rpcTempCU->getTotalBits() += m_pcEntropyCoder->getNumberOfWrittenBits(); // dQP bits
+      rpcTempCU->getTotalBins() += ((TEncBinCABAC *)((TEncSbac*)m_pcEntropyCoder->m_pcEntropyCoderIf)->getEncBinIf())->getBinsCoded();
+      rpcTempCU->getTotalCost()  = m_pcRdCost->calcRdCost( rpcTempCU->getTotalBits(), rpcTempCU->getTotalDistortion() );
+
+      Bool foundNonZeroCbf = false;
+      rpcTempCU->setQPSubCUs( rpcTempCU->getRefQP( 0 ), 0, uiDepth, foundNonZeroCbf );
+#endif
+      assert( foundNonZeroCbf );
+    }
+    else
+    {
+#if JVET_C0024_DELTA_QP_FIX
+      rpcTempCU->setQPSubParts( rpcTempCU->getRefQP( 0 ), 0, uiWidth, uiHeight ); // set QP to default QP
+#else
+      rpcTempCU->setQPSubParts( rpcTempCU->getRefQP( 0 ), 0, uiDepth ); // set QP to default QP
+#endif
+#if JVET_C0024_DELTA_QP_FIX
+      if( pps.getUseDQP() ) // update coded QP
+      { 
+        rpcTempCU->setCodedQP( rpcTempCU->getQP( 0 ) ); 
+      }
+#endif
+    }
+  }
+
+  m_pcRDGoOnSbacCoder->store(m_ppppcRDSbacCoder[uiWidthIdx][uiHeightIdx][CI_TEMP_BEST]);
+}
+#endif
+
+#if QTBT_PARALLEL_SPLIT
+/// z-order index of the bottom right minimum block of the uiWidth x uiHeight CU at uiZorderIdx
+static UInt getZorderIdxBR( UInt uiZorderIdx, UInt uiWidth, UInt uiHeight, UInt uiCTUSize )
+{
+  return g_auiRasterToZscan[g_auiZscanToRaster[uiZorderIdx] + ((uiHeight>>MIN_CU_LOG2)-1) * (uiCTUSize>>MIN_CU_LOG2) + (uiWidth>>MIN_CU_LOG2)-1];
+}
+
+/** BT-V and QT are compressed on their workers, into copies of the CTU, the reconstruction around the CU and the scratch
+ *  of the CTU, starting from the contexts, RD cost, dQP state, fast decisions and save/load information of this encoder
+ *  after BT-H. Each task records the fast decisions and save/load tags it reads before setting them; the QT result is
+ *  only valid if BT-V left these as they were, since serially QT starts after BT-V.
+ */
+Void TEncCu::xCompressSplitTasks( TComDataCU* pcBestCU, TComDataCU* pcTempCU, const UInt uiDepth, UInt uiWidth, UInt uiHeight, UInt uiBTSplitMode, Int iQP, Bool bVerRmvEnable, Bool bForceQT
+                                , Bool bTestHorSplit, UInt uiMaxBTD
+#if JVET_C0024_DELTA_QP_FIX
+                                , const Char lastCodedQP
+#endif
+                                )
+{
+  TComPic*              pcPic          = pcTempCU->getPic();
+  TComSlice*            pcSlice        = pcTempCU->getSlice();
+  const UInt            uiCtuRsAddr    = pcTempCU->getCtuRsAddr();
+  TComDataCU*           pcCtu          = pcPic->getCtu( uiCtuRsAddr );
+  TComPicYuv*           pcPicYuvRec    = pcPic->getPicYuvRec();
+  const TComCtuScratch* pcScratch      = pcPic->getCtuScratch();
+  const UInt            uiWidthIdx     = g_aucConvertToBit[uiWidth];
+  const UInt            uiHeightIdx    = g_aucConvertToBit[uiHeight];
+  const UInt            uiZorderBegin  = pcTempCU->getZorderIdxInCtu();
+  const UInt            uiZorderEnd    = getZorderIdxBR( uiZorderBegin, uiWidth, uiHeight, pcSlice->getSPS()->getCTUSize() );
+  const Int             iMargin        = Int( max( uiWidth, uiHeight ) ) + SEARCHRANGEINTRA;   // neighbours and templates of the sub CUs, intra KLT search
+  const ClipParam       clipParam      = g_ClipParam;                                          // per thread, the pool threads take the one of the caller
+  const ChannelType     eTextType      = pcSlice->getTextType();
+#if VCEG_AZ08_INTER_KLT
+  const Bool            bEnableCheck   = g_bEnableCheck;
+#endif
+
+  const UInt auiSplitMethod[2] = { 2, 0 };
+  m_bSplitTaskCancel = false;
+
+  m_pcSplitTaskPool->parallelFor( 2, [&]( Int iTask )
+  {
+    const UInt     uiSplitMethod = auiSplitMethod[iTask];
+    TEncCtuWorker& rcWorker      = xGetSplitWorker( uiSplitMethod );
+    TEncCu*        pcCuEncoder   = rcWorker.getCuEncoder();
+    TEncSbac*      pcRDGoOnSbac  = rcWorker.getRDGoOnSbacCoder();
+
+    g_ClipParam = clipParam;
+    TComSlice::setThreadTextType( pcSlice, eTextType );
+    TComPic::setThreadCtuScratch( pcPic, rcWorker.getCtuScratch() );
+    rcWorker.getCtuScratch()->copyFrom( *pcScratch, uiZorderBegin, uiZorderEnd );
+    rcWorker.getCtuScratchReads()->clear( uiZorderBegin, uiZorderEnd );
+    TComPic::setThreadCtuScratchReads( rcWorker.getCtuScratchReads() );
+    pcPicYuvRec->copyRectToPic( rcWorker.getPicYuvRec(), pcTempCU->getCUPelX() - iMargin, pcTempCU->getCUPelY() - iMargin, uiWidth + 2 * iMargin, uiHeight + 2 * iMargin );
+    rcWorker.getCtuCopy()->copyCUFrom( pcCtu );
+    TComPic::setThreadCtuCopy( pcPic, uiCtuRsAddr, rcWorker.getCtuCopy(), rcWorker.getPicYuvRec(), rcWorker.getPicYuvPred() );
+#if VCEG_AZ08_INTER_KLT
+    g_bEnableCheck = bEnableCheck;
+#endif
+
+    *rcWorker.getRdCost() = *m_pcRdCost;
+    rcWorker.getTrQuant()->copyLambdas( *m_pcTrQuant );
+#if ADAPTIVE_QP_SELECTION
+    rcWorker.getTrQuant()->clearSliceARLCnt();
+#endif
+    pcCuEncoder->setdQPFlag( getdQPFlag() );
+    pcCuEncoder->setCodeChromaQpAdjFlag( getCodeChromaQpAdjFlag() );
+    pcCuEncoder->m_cuChromaQpOffsetIdxPlus1 = m_cuChromaQpOffsetIdxPlus1;
+    pcCuEncoder->setFastDeltaQp( getFastDeltaQp() );
+#if JVET_D0077_SAVE_LOAD_ENC_INFO
+    rcWorker.getPredSearch()->copySaveLoadInfo( m_pcPredSearch );
+    rcWorker.getPredSearch()->startSaveLoadReads();
+#endif
+    pcCuEncoder->m_ppppcRDSbacCoder[uiWidthIdx][uiHeightIdx][CI_CURR_BEST]->load( m_ppppcRDSbacCoder[uiWidthIdx][uiHeightIdx][CI_CURR_BEST] );
+    pcCuEncoder->m_pcEntropyCoder->setEntropyCoder( pcRDGoOnSbac );
+    pcCuEncoder->m_pcEntropyCoder->setBitstream( rcWorker.getBitCounter() );
+    rcWorker.getBitCounter()->resetBits();
+    ((TEncBinCABAC*)pcRDGoOnSbac->getEncBinIf())->setBinCountingEnableFlag( true );
+
+    TComDataCU* pcTaskCU = pcCuEncoder->m_pppcTempCU[uiWidthIdx][uiHeightIdx];
+    pcTaskCU->copyCUFrom( pcTempCU );
+    if( uiSplitMethod == 0 )
+    {
+      DEBUG_STRING_NEW(sTaskDebug)
+      pcCuEncoder->m_pbSplitTaskCancel = &m_bSplitTaskCancel;   // taken and cleared by xCheckRDCostQTSplit()
+      pcCuEncoder->xCheckRDCostQTSplit( pcTaskCU, uiDepth, uiWidth, uiHeight, iQP, false, bForceQT
+#if JVET_C0024_DELTA_QP_FIX
+                                      , lastCodedQP
+#endif
+                                      DEBUG_STRING_PASS_INTO(sTaskDebug) );
+    }
+    else
+    {
+#if JVET_D0077_SAVE_LOAD_ENC_INFO
+      m_adSplitTaskCost[uiSplitMethod] = MAX_DOUBLE;
+#endif
+      pcCuEncoder->xCheckRDCostBTSplit( pcTaskCU, uiDepth, uiWidth, uiHeight, uiBTSplitMode, uiSplitMethod, iQP, bVerRmvEnable
+#if JVET_C0024_DELTA_QP_FIX
+                                      , lastCodedQP
+#endif
+#if JVET_D0077_SAVE_LOAD_ENC_INFO
+                                      , m_adSplitTaskCost[uiSplitMethod]
+#endif
+                                      );
+      // the best CU after BT-V, as xCheckBestMode() will take it; split tasks are not used with byte-limited slices
+      if( bTestHorSplit && xSkipQTSplit( pcTaskCU->getTotalCost() < pcBestCU->getTotalCost() ? pcTaskCU : pcBestCU, uiWidth, uiHeight, uiMaxBTD ) )
+      {
+        m_bSplitTaskCancel = true;
+      }
+    }
+#if VCEG_AZ08_INTER_KLT
+    m_abSplitTaskEnableCheck[uiSplitMethod] = g_bEnableCheck;
+#endif
+#if JVET_D0077_SAVE_LOAD_ENC_INFO
+    rcWorker.getPredSearch()->stopSaveLoadReads();
+#endif
+
+    pcRDGoOnSbac->setBitstream( NULL );
+    TComPic::setThreadCtuCopy( NULL, 0, NULL, NULL, NULL );
+    TComPic::setThreadCtuScratchReads( NULL );
+    TComPic::setThreadCtuScratch( NULL, NULL );
+    TComSlice::setThreadTextType( NULL, CHANNEL_TYPE_LUMA );
+  } );
+
+  TEncCtuWorker& rcVerWorker = xGetSplitWorker( 2 );
+  TEncCtuWorker& rcQTWorker  = xGetSplitWorker( 0 );
+  m_bSplitTaskQTValid = !m_bSplitTaskCancel
+                     && rcQTWorker.getCtuScratchReads()->readsMatch( *rcVerWorker.getCtuScratch(), *pcScratch, uiZorderBegin, uiZorderEnd )
+#if JVET_D0077_SAVE_LOAD_ENC_INFO
+                     && rcQTWorker.getPredSearch()->saveLoadReadsMatch( rcVerWorker.getPredSearch(), m_pcPredSearch )
+#endif
+                     ;
+}
+
+TEncCtuWorker& TEncCu::xGetSplitWorker( UInt uiSplitMethod )
+{
+  return m_pcSplitWorkers[uiSplitMethod == 0 ? 0 : 1];
+}
+
+Bool TEncCu::xTakeSplitTask( TComDataCU*& rpcTempCU, UInt uiSplitMethod, const UInt uiDepth, UInt uiWidth, UInt uiHeight, Int iQP )
+{
+  if( uiSplitMethod == 0 && !m_bSplitTaskQTValid )
+  {
+    return false;
+  }
+
+  TEncCtuWorker& rcWorker    = xGetSplitWorker( uiSplitMethod );
+  TEncCu*        pcCuEncoder = rcWorker.getCuEncoder();
+  const UInt     uiWidthIdx  = g_aucConvertToBit[uiWidth];
+  const UInt     uiHeightIdx = g_aucConvertToBit[uiHeight];
+  TComDataCU*    pcTaskCU    = pcCuEncoder->m_pppcTempCU[uiWidthIdx][uiHeightIdx];
+  TComPic*       pcPic       = rpcTempCU->getPic();
+
+  rpcTempCU->initEstData( uiDepth, iQP, false );
+  rpcTempCU->copyPartFrom( pcTaskCU, 0, uiDepth, uiWidth, uiHeight );
+  // copyPartFrom() adds the cost to the MAX_DOUBLE of initEstData()
+  rpcTempCU->getTotalCost()       = pcTaskCU->getTotalCost();
+  rpcTempCU->getTotalBits()       = pcTaskCU->getTotalBits();
+  rpcTempCU->getTotalDistortion() = pcTaskCU->getTotalDistortion();
+  rpcTempCU->getTotalBins()       = pcTaskCU->getTotalBins();
+#if JVET_C0024_DELTA_QP_FIX
+  rpcTempCU->setCodedQP( pcTaskCU->getCodedQP() );
+#endif
+  pcCuEncoder->m_pppcRecoYuvTemp[uiWidthIdx][uiHeightIdx]->copyToPartYuv( m_pppcRecoYuvTemp[uiWidthIdx][uiHeightIdx], 0 );
+#if FIX_TICKET37
+  pcCuEncoder->m_pppcPredYuvTemp[uiWidthIdx][uiHeightIdx]->copyToPartYuv( m_pppcPredYuvTemp[uiWidthIdx][uiHeightIdx], 0 );
+#else
+  pcCuEncoder->m_pppcPredYuvBest[uiWidthIdx][uiHeightIdx]->copyToPartYuv( m_pppcPredYuvBest[uiWidthIdx][uiHeightIdx], 0 );
+#endif
+  m_ppppcRDSbacCoder[uiWidthIdx][uiHeightIdx][CI_TEMP_BEST]->load( pcCuEncoder->m_ppppcRDSbacCoder[uiWidthIdx][uiHeightIdx][CI_TEMP_BEST] );
+
+  // the sub CUs were coded into the scratch of the worker; as after a serial candidate, the caller clears them again
+  const UInt uiPelXInCTU = rpcTempCU->getCUPelX() - pcPic->getCtu( rpcTempCU->getCtuRsAddr() )->getCUPelX();
+  const UInt uiPelYInCTU = rpcTempCU->getCUPelY() - pcPic->getCtu( rpcTempCU->getCtuRsAddr() )->getCUPelY();
+  pcPic->setCodedBlkInCTU( true, uiPelXInCTU>>MIN_CU_LOG2, uiPelYInCTU>>MIN_CU_LOG2, uiWidth>>MIN_CU_LOG2, uiHeight>>MIN_CU_LOG2 );
+  pcPic->addCodedAreaInCTU( uiWidth*uiHeight );
+
+  // side effects of the candidate on the state the next one starts from
+  const UInt uiZorderBegin = rpcTempCU->getZorderIdxInCtu();
+  rcWorker.getCtuScratchReads()->copyWritten( *pcPic->getCtuScratch(), *rcWorker.getCtuScratch(), uiZorderBegin, getZorderIdxBR( uiZorderBegin, uiWidth, uiHeight, rpcTempCU->getSlice()->getSPS()->getCTUSize() ) );
+#if JVET_D0077_SAVE_LOAD_ENC_INFO
+  m_pcPredSearch->copySaveLoadWrites( rcWorker.getPredSearch() );
+#endif
+#if ADAPTIVE_QP_SELECTION
+  m_pcTrQuant->addSliceARLCnt( *rcWorker.getTrQuant() );
+#endif
+#if VCEG_AZ08_INTER_KLT
+  g_bEnableCheck = m_abSplitTaskEnableCheck[uiSplitMethod];
+#endif
+  return true;
+}
+#endif
+
+#if JVET_C0024_QTBT
+Bool TEncCu::xSkipQTSplit( TComDataCU* pcBestCU, UInt uiWidth, UInt uiHeight, UInt uiMaxBTD )
+{
+  const UInt uiCTUSize   = pcBestCU->getSlice()->getSPS()->getCTUSize();
+  const UInt uiZorderBR  = g_auiRasterToZscan[((uiHeight>> MIN_CU_LOG2)-1) * (uiCTUSize>> MIN_CU_LOG2) + (uiWidth>> MIN_CU_LOG2)-1];  //bottom-right part.
+  const Bool bIntra      = pcBestCU->getSlice()->isIntra();
+
+  return ( pcBestCU->getBTDepth(0)==0 && uiMaxBTD>=(bIntra ? 3: 2) )
+      || ( pcBestCU->getBTDepth(0)==1 && pcBestCU->getBTDepth(uiZorderBR)==1 && uiMaxBTD>=(bIntra ? 4: 3) );
+}
+#endif
+
 /** finish encoding a cu and handle end-of-slice conditions
  * \param pcCU
  * \param uiAbsPartIdx
@@ -3469,8 +3835,8 @@ Void TEncCu::xEncodeCU( TComDataCU* pcCU, UInt uiAbsPartIdx, UInt uiDepth )
 #if JVET_C0024_AMAX_BT
   if (!pcCU->getSlice()->isIntra())
   {
-    g_uiBlkSize[pcCU->getSlice()->getDepth()] += uiWidth*uiHeight;
-    g_uiNumBlk[pcCU->getSlice()->getDepth()]++;
+    m_puiBlkSize[pcCU->getSlice()->getDepth()] += uiWidth*uiHeight;
+    m_puiNumBlk[pcCU->getSlice()->getDepth()]++;
   }
 #endif
 #if JVET_C0024_DELTA_QP_FIX
@@ -3548,8 +3914,10 @@ Void TEncCu::xEncodeCU( TComDataCU* pcCU, UInt uiAbsPartIdx, UInt uiDepth )
   {
 	  int w = pcCU->getWidth(uiAbsPartIdx);
 	  int h = pcCU->getHeight(uiAbsPartIdx);
-	  TComYuv* pcOrgYuv_tmp		= m_pppcOrigYuv[g_aucConvertToBit[128]][g_aucConvertToBit[128]];
-	  TComYuv* pcPredYuv_tmp	= m_pppcPredYuvTemp[g_aucConvertToBit[128]][g_aucConvertToBit[128]];	  
+	  // the CTU buffers: the CTU size is reduced below 128 for small pictures
+	  const UInt uiCtuIdx		= g_aucConvertToBit[pcCU->getSlice()->getSPS()->getCTUSize()];
+	  TComYuv* pcOrgYuv_tmp		= m_pppcOrigYuv[uiCtuIdx][uiCtuIdx];
+	  TComYuv* pcPredYuv_tmp	= m_pppcPredYuvTemp[uiCtuIdx][uiCtuIdx];
 	  m_pcEntropyCoder->encodePIPflag(pcCU, uiAbsPartIdx, pcCU->getR1SpQn(COMPONENT_Y)
 #if NOISE_MARK
 		  , pcCU->getR1NoiseMark(COMPONENT_Y)
@@ -3659,19 +4027,19 @@ Void TEncCu::xEncodeCU( TComDataCU* pcCU, UInt uiAbsPartIdx, UInt uiDepth )
 	  if (uiWidth <= CUMAX && uiHeight <= CUMAX)
 	  {
 		  int idx = base * ((uiHeight >> 2) - 1) + (uiWidth >> 2) - 1;
-		  PIPStats[0][idx]++;
-		  PIPStats[1][idx] += pcCU->getPIPflag(uiAbsPartIdx) == 1;
+		  PIPStatsPolicy::inc(m_pcPIPStats->sizeStats[0][idx]);
+		  PIPStatsPolicy::add(m_pcPIPStats->sizeStats[1][idx], (Int)(pcCU->getPIPflag(uiAbsPartIdx) == 1));
 
 		  if (pcCU->getPIPflag(uiAbsPartIdx))
-			  PIPCUcount++;
-		  PIPValudCUCount++;
+			  PIPStatsPolicy::inc(m_pcPIPStats->pipCUCount);
+		  PIPStatsPolicy::inc(m_pcPIPStats->validCUCount);
 
 		  // new stats
 
 	  }
-	  PIPStats[0][1 << base]++;
-	  PIPStats[1][1 << base] += pcCU->getPIPflag(uiAbsPartIdx) == 1;
-	  AllCUCount++;	  
+	  PIPStatsPolicy::inc(m_pcPIPStats->sizeStats[0][1 << base]);
+	  PIPStatsPolicy::add(m_pcPIPStats->sizeStats[1][1 << base], (Int)(pcCU->getPIPflag(uiAbsPartIdx) == 1));
+	  PIPStatsPolicy::inc(m_pcPIPStats->allCUCount);	  
   }
   
 #endif
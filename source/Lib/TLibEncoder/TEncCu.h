@@ -52,6 +52,9 @@
 #if VCEG_AZ07_IMV
 #include <set>
 #endif
+#if QTBT_PARALLEL_SPLIT
+#include <atomic>
+#endif
 //! \ingroup TLibEncoder
 //! \{
 
@@ -59,9 +62,9 @@ class TEncTop;
 class TEncSbac;
 class TEncCavlc;
 class TEncSlice;
-
-#if PIP
-extern TEncSearch*             m_pcPredSearchPIP;
+#if QTBT_PARALLEL_SPLIT
+class TEncCtuWorker;
+class TComThreadPool;
 #endif
 
 // ====================================================================================================================
@@ -152,6 +155,9 @@ private:
 
   TEncEntropy*            m_pcEntropyCoder;
   TEncBinCABAC*           m_pcBinCABAC;
+#if PIP
+  TComPIPStats*           m_pcPIPStats;                 ///< PIP counters of this CU encoder
+#endif
 
   // SBAC RD
 #if !PIP
@@ -164,6 +170,13 @@ private:
   TEncSbac*               m_pcRDGoOnSbacCoder;
 #endif
   TEncRateCtrl*           m_pcRateCtrl;
+#if WPP_PARALLEL_CTU_ROWS
+  Int                     m_iCtuRCQP;                   ///< rate control QP of the CTU on a CTU row worker, g_RCInvalidQPValue: the one of m_pcRateCtrl
+#endif
+#if JVET_C0024_AMAX_BT
+  UInt*                   m_puiBlkSize;                 ///< AMaxBT block size sums per temporal layer: the ones of the GOP encoder, or of a CTU row worker
+  UInt*                   m_puiNumBlk;                  ///< AMaxBT block counts per temporal layer
+#endif
 
 #if COM16_C806_VCEG_AZ10_SUB_PU_TMVP
   //ATMVP 
@@ -175,6 +188,20 @@ private:
   UChar        * m_phInterDirSP[2];
 #endif
 #endif
+#if QTBT_PARALLEL_SPLIT
+  TEncCtuWorker*          m_pcSplitWorkers;             ///< workers of the QT and BT-V split tasks; NULL: serial
+  TComThreadPool*         m_pcSplitTaskPool;
+  UInt                    m_uiSplitTaskMinSize;         ///< the CUs of at least m_uiSplitTaskMinSize^2 samples are split as tasks
+  Bool                    m_bSplitTaskQTValid;          ///< the QT task read the same fast decisions and save/load information as after BT-V
+  std::atomic<Bool>       m_bSplitTaskCancel;           ///< BT-V showed that QT is not tested, the QT task stops
+  const std::atomic<Bool>* m_pbSplitTaskCancel;         ///< of the encoder whose QT task this encoder is about to compress, NULL otherwise
+#if JVET_D0077_SAVE_LOAD_ENC_INFO
+  Double                  m_adSplitTaskCost[3];         ///< cost of the split, as dVerSplitCost
+#endif
+#if VCEG_AZ08_INTER_KLT
+  Bool                    m_abSplitTaskEnableCheck[3];  ///< g_bEnableCheck after the task
+#endif
+#endif
 
 public:
 	
@@ -191,6 +218,14 @@ public:
 
   /// copy parameters from encoder class
   Void  init                ( TEncTop* pcEncTop );
+  /// copy parameters from encoder class, with the search, transform, RD and entropy coding objects of a CTU row worker
+  Void  init                ( TEncTop* pcEncTop, TEncSearch* pcPredSearch, TComTrQuant* pcTrQuant, TComRdCost* pcRdCost, TEncEntropy* pcEntropyCoder,
+#if JVET_C0024_QTBT
+                              TEncSbac**** ppppcRDSbacCoder,
+#else
+                              TEncSbac*** pppcRDSbacCoder,
+#endif
+                              TEncSbac* pcRDGoOnSbacCoder, Int iPIPThreadId );
 
   /// create internal buffers
   Void  create              ( UChar uhTotalDepth, UInt iMaxWidth, UInt iMaxHeight, ChromaFormat chromaFormat );
@@ -209,8 +244,24 @@ public:
   Int   updateCtuDataISlice ( TComDataCU* pCtu, Int width, Int height );
 
   Void setFastDeltaQp       ( Bool b)                 { m_bFastDeltaQP = b;         }
+#if WPP_PARALLEL_CTU_ROWS
+  Void setCtuRCQP           ( Int iQP )               { m_iCtuRCQP = iQP;           }
+  Int  getCtuRCQP           ()                        { return m_iCtuRCQP;          }
+#endif
+#if JVET_C0024_AMAX_BT
+  Void setBlkStats          ( UInt* puiBlkSize, UInt* puiNumBlk ) { m_puiBlkSize = puiBlkSize; m_puiNumBlk = puiNumBlk; }
+#endif
+#if QTBT_PARALLEL_SPLIT
+  /// the split candidates of the CUs of at least uiMinSize x uiMinSize samples are compressed by pcWorkers[0..1] on pcPool (NULL: serially)
+  Void setSplitTasks        ( TEncCtuWorker* pcWorkers, TComThreadPool* pcPool, UInt uiMinSize ) { m_pcSplitWorkers = pcWorkers; m_pcSplitTaskPool = pcPool; m_uiSplitTaskMinSize = uiMinSize; }
+#endif
 
 protected:
+#if WPP_PARALLEL_CTU_ROWS
+  Int   xGetRCQP            ()                        { return m_iCtuRCQP > g_RCInvalidQPValue ? m_iCtuRCQP : m_pcRateCtrl->getRCQP(); }
+#else
+  Int   xGetRCQP            ()                        { return m_pcRateCtrl->getRCQP(); }
+#endif
   Void  finishCU            ( TComDataCU*  pcCU, UInt uiAbsPartIdx );
 #if AMP_ENC_SPEEDUP
 #if JVET_C0024_QTBT
@@ -234,6 +285,45 @@ protected:
   Void  xCheckBestMode      ( TComDataCU*& rpcBestCU, TComDataCU*& rpcTempCU, UInt uiDepth DEBUG_STRING_FN_DECLARE(sParent) DEBUG_STRING_FN_DECLARE(sTest) DEBUG_STRING_PASS_INTO(Bool bAddSizeInfo=true));
 #endif
 
+#if JVET_C0024_QTBT
+  /// compresses the CU of rpcTempCU split horizontally (uiSplitMethod 1) or vertically (2) into rpcTempCU, and stores the contexts after it to CI_TEMP_BEST
+  Void  xCheckRDCostBTSplit ( TComDataCU*& rpcTempCU, const UInt uiDepth, UInt uiWidth, UInt uiHeight, UInt uiBTSplitMode, UInt uiSplitMethod, Int iQP, Bool bRmvEnable
+#if JVET_C0024_DELTA_QP_FIX
+                              , const Char lastCodedQP
+#endif
+#if JVET_D0077_SAVE_LOAD_ENC_INFO
+                              , Double& rdSplitCost
+#endif
+                              );
+  /// compresses the CU of rpcTempCU split into four into rpcTempCU, and stores the contexts after it to CI_TEMP_BEST
+  Void  xCheckRDCostQTSplit ( TComDataCU*& rpcTempCU, const UInt uiDepth, UInt uiWidth, UInt uiHeight, Int iQP, Bool bBoundary, Bool bForceQT
+#if JVET_C0024_DELTA_QP_FIX
+                              , const Char lastCodedQP
+#endif
+                              DEBUG_STRING_FN_DECLARE(sDebug) );
+#endif
+#if QTBT_PARALLEL_SPLIT
+  /** compresses the split candidates 2 (BT-V) and 0 (QT) concurrently, each on its worker, from the state of this encoder
+   *  after BT-H; with bTestHorSplit BT-V stops QT when xSkipQTSplit() will drop it
+   */
+  Void  xCompressSplitTasks ( TComDataCU* pcBestCU, TComDataCU* pcTempCU, const UInt uiDepth, UInt uiWidth, UInt uiHeight, UInt uiBTSplitMode, Int iQP, Bool bVerRmvEnable, Bool bForceQT
+                            , Bool bTestHorSplit, UInt uiMaxBTD
+#if JVET_C0024_DELTA_QP_FIX
+                            , const Char lastCodedQP
+#endif
+                            );
+  /** takes the result of the task of uiSplitMethod into rpcTempCU and the temporary YUV and contexts, and its side effects on
+   *  the fast decisions, the save/load information and the statistics, as if compressed here; false: compress it here
+   */
+  Bool  xTakeSplitTask      ( TComDataCU*& rpcTempCU, UInt uiSplitMethod, const UInt uiDepth, UInt uiWidth, UInt uiHeight, Int iQP );
+  /// the worker of the QT (0) or the BT-V (2) task
+  TEncCtuWorker& xGetSplitWorker( UInt uiSplitMethod );
+#endif
+#if JVET_C0024_QTBT
+  /// encoder speedup: the QT split of a CU whose BT-H and BT-V split were tested is not tested after pcBestCU
+  Bool  xSkipQTSplit        ( TComDataCU* pcBestCU, UInt uiWidth, UInt uiHeight, UInt uiMaxBTD );
+#endif
+
   Void  xCheckRDCostMerge2Nx2N( TComDataCU*& rpcBestCU, TComDataCU*& rpcTempCU DEBUG_STRING_FN_DECLARE(sDebug), Bool *earlyDetectionSkipMode );
 #if VCEG_AZ07_FRUC_MERGE
   Void  xCheckRDCostMerge2Nx2NFRUC( TComDataCU*& rpcBestCU, TComDataCU*& rpcTempCU , Bool *earlyDetectionSkipMode );
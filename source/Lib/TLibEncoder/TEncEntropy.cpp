@@ -273,10 +273,7 @@ Void TEncEntropy::encodePredMode( TComDataCU* pcCU, UInt uiAbsPartIdx, Bool bRD
 {
 
 #if PIP
-	if (encodeTime && false)
-		Bits1 = getNumberOfWrittenBits();
-
-	if (encodeTime && false)
+	if (m_pcPIPCoderState->encodeTime && false)
 	{
 
 
@@ -414,7 +411,7 @@ Void TEncEntropy::encodeIPCMInfo( TComDataCU* pcCU, UInt uiAbsPartIdx, Bool bRD
 Void TEncEntropy::xEncodeTransform( Bool& bCodeDQP, Bool& codeChromaQpAdj, TComTU &rTu, ComponentID compID)
 {
 #if PIP
-	if (encodeTime && verbose)
+	if (m_pcPIPCoderState->encodeTime && verbose)
 		cout << "Transform:";
 	
 #endif
@@ -1149,7 +1146,7 @@ Void TEncEntropy::encodeCoeff( TComDataCU* pcCU, UInt uiAbsPartIdx, UInt uiDepth
   )
 {
 #if PIP
-	if (encodeTime && verbose)
+	if (m_pcPIPCoderState->encodeTime && verbose)
 		cout << ",Coeff:";
 
 	
@@ -1263,7 +1260,7 @@ Void TEncEntropy::encodeCoeff( TComDataCU* pcCU, UInt uiAbsPartIdx, UInt uiDepth
     const UInt uiHeight        = rRect.height;
 
 #if PIP
-	if (isLuma(pcCU->getTextType()) && encodeTime && false)
+	if (isLuma(pcCU->getTextType()) && m_pcPIPCoderState->encodeTime && false)
 	{
 		for (int c = 0; c < uiWidth*uiHeight; c++)
 			cout << pcCoef[c] << ",";
@@ -49,6 +49,9 @@
 #if ALF_HM3_REFACTOR
 #include "TLibCommon//TComAdaptiveLoopFilter.h"
 #endif
+#if PIP
+#include "TLibCommon/TComPIPContext.h"
+#endif
 
 class TEncSbac;
 class TEncCavlc;
@@ -236,9 +239,16 @@ class TEncEntropy
 private:
   TComStats*                      m_pcStats;
 #endif
+#if PIP
+private:
+  TComPIPCoderState*              m_pcPIPCoderState;
+#endif
 
 public:
   Void    setEntropyCoder           ( TEncEntropyIf* e );
+#if PIP
+  Void    setPIPCoderState          ( TComPIPCoderState* p )  { m_pcPIPCoderState = p; }
+#endif
   Void    setBitstream              ( TComBitIf* p )          { m_pcEntropyCoderIf->setBitstream(p);  }
   Void    resetBits                 ()                        { m_pcEntropyCoderIf->resetBits();      }
   UInt    getNumberOfWrittenBits    ()                        { return m_pcEntropyCoderIf->getNumberOfWrittenBits(); }
@@ -185,6 +185,21 @@ TEncGOP::TEncGOP()
   m_bufferingPeriodSEIPresentInAU = false;
   m_associatedIRAPType = NAL_UNIT_CODED_SLICE_IDR_N_LP;
   m_associatedIRAPPOC  = 0;
+#if ALF_HM3_REFACTOR && COM16_C806_ALF_TEMPPRED_NUM
+#if JVET_E0104_ALF_TEMP_SCALABILITY
+  ::memset(m_iStoredAlfParaNum, 0, sizeof(m_iStoredAlfParaNum));
+#else
+  m_iStoredAlfParaNum = 0;
+#endif
+#endif
+#if JVET_C0024_AMAX_BT
+  ::memset(m_auiBlkSize, 0, sizeof(m_auiBlkSize));
+  ::memset(m_auiNumBlk, 0, sizeof(m_auiNumBlk));
+#if JVET_C0024_AMAX_BT_FIX
+  m_uiPrevISlicePOC = 0;
+  m_bInitAMaxBT     = false;
+#endif
+#endif
   return;
 }
 
@@ -192,14 +207,6 @@ TEncGOP::~TEncGOP()
 {
 }
 
-#if COM16_C806_ALF_TEMPPRED_NUM
-#if JVET_E0104_ALF_TEMP_SCALABILITY
-Int TEncGOP::m_iStoredAlfParaNum[JVET_E0104_ALF_MAX_TEMPLAYERID] = { 0, 0, 0, 0, 0 };
-#else
-Int TEncGOP::m_iStoredAlfParaNum = 0;
-#endif
-#endif
-
 /** Create list to contain pointers to CTU start addresses of slice.
  */
 Void  TEncGOP::create()
@@ -1161,6 +1168,11 @@ Void TEncGOP::compressGOP( Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rc
   AccessUnit::iterator  itLocationToPushSliceHeaderNALU; // used to store location where NALU containing slice header is to be inserted
 
   xInitGOP( iPOCLast, iNumPicRcvd, isField );
+#if FRAME_PARALLEL_GOP
+  std::vector<Int> waveStart, waveEnd;
+  xGetFrameWaves( iPOCLast, iNumPicRcvd, isField, waveStart, waveEnd );
+  std::vector<TEncGOPFrame> framesToFinish;
+#endif
 
 #if ALF_HM3_REFACTOR
   ALFParam cAlfParam;
@@ -1417,16 +1429,16 @@ Void TEncGOP::compressGOP( Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rc
       Int refLayer=pcSlice->getDepth();
       if( refLayer>9) refLayer=9; // Max layer is 10  
 #if JVET_C0024_AMAX_BT_FIX
-      if( g_bInitAMaxBT && pcSlice->getPOC() > g_uiPrevISlicePOC )
+      if( m_bInitAMaxBT && pcSlice->getPOC() > m_uiPrevISlicePOC )
       {
-        ::memset( g_uiBlkSize, 0, sizeof(g_uiBlkSize) );
-        ::memset( g_uiNumBlk, 0, sizeof(g_uiNumBlk) );
-        g_bInitAMaxBT = false;
+        ::memset( m_auiBlkSize, 0, sizeof(m_auiBlkSize) );
+        ::memset( m_auiNumBlk, 0, sizeof(m_auiNumBlk) );
+        m_bInitAMaxBT = false;
       }
 #endif
-      if (refLayer >= 0 && g_uiNumBlk[refLayer] != 0) 
+      if (refLayer >= 0 && m_auiNumBlk[refLayer] != 0) 
       {
-        Double dBlkSize = sqrt((Double)g_uiBlkSize[refLayer]/g_uiNumBlk[refLayer]);
+        Double dBlkSize = sqrt((Double)m_auiBlkSize[refLayer]/m_auiNumBlk[refLayer]);
         if (dBlkSize < AMAXBT_TH32)
         {
           pcSlice->setMaxBTSize(32>MAX_BT_SIZE_INTER ? MAX_BT_SIZE_INTER: 32);
@@ -1443,22 +1455,22 @@ Void TEncGOP::compressGOP( Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rc
         printf("\n previous layer=%d, avg blk size = %3.2f, current max BT set to %d\n", refLayer, dBlkSize, pcSlice->getMaxBTSize());
 #endif
 
-        g_uiBlkSize[refLayer] = 0;
-        g_uiNumBlk[refLayer] = 0;
+        m_auiBlkSize[refLayer] = 0;
+        m_auiNumBlk[refLayer] = 0;
       }
     }
 #if JVET_C0024_AMAX_BT_FIX
     else
     {
 #if JVET_C0024_AMAX_BT_FIX_TICKET23
-      if( g_bInitAMaxBT  )
+      if( m_bInitAMaxBT  )
       {
-        ::memset( g_uiBlkSize, 0, sizeof(g_uiBlkSize) );
-        ::memset( g_uiNumBlk, 0, sizeof(g_uiNumBlk) );
+        ::memset( m_auiBlkSize, 0, sizeof(m_auiBlkSize) );
+        ::memset( m_auiNumBlk, 0, sizeof(m_auiNumBlk) );
       }
 #endif
-      g_uiPrevISlicePOC = pcSlice->getPOC();
-      g_bInitAMaxBT = true;
+      m_uiPrevISlicePOC = pcSlice->getPOC();
+      m_bInitAMaxBT = true;
     }
 #endif
 #endif
@@ -1724,6 +1736,34 @@ Void TEncGOP::compressGOP( Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rc
         }
         g_ClipParam =pcPic->m_aclip_prm; // set the global for access from clipBD
 
+#endif
+#if FRAME_PARALLEL_GOP
+    const TEncGOPFrame cFrame = { iGOPid, pcPic, pcPicYuvRecOut, &accessUnit, iBeforeTime, pcSlice->isReferenced() };
+    framesToFinish.push_back( cFrame );
+    if ( waveStart[iGOPid] != waveEnd[iGOPid] )
+    {
+      // the picture is compressed with the other pictures of its wave, after the set up of the last one
+      pcSlice->setSliceCurStartCtuTsAddr( 0 );
+      pcSlice->setSliceSegmentCurStartCtuTsAddr( 0 );
+#if VCEG_AZ07_BAC_ADAPT_WDOW || VCEG_AZ07_INIT_PREVFRAME
+      pcSlice->setStatsHandle( m_apcStats );
+      pcSlice->initStatsGlobal( );
+#endif
+      for ( Int iList = 0; iList < NUM_REF_PIC_LIST_01; iList++ )
+      {
+        for ( Int iRefIdx = 0; iRefIdx < pcSlice->getNumRefIdx( RefPicList( iList ) ); iRefIdx++ )
+        {
+          assert( pcSlice->getRefPic( RefPicList( iList ), iRefIdx )->getReconMark() );
+        }
+      }
+      m_pcSliceEncoder->queuePicture( pcPic );
+      if ( iGOPid != waveEnd[iGOPid] )
+      {
+        continue;
+      }
+      m_pcSliceEncoder->compressQueuedPictures();
+    }
+    else
 #endif
     // now compress (trial encode) the various slice segments (slices, and dependent slices)
     {
@@ -1773,6 +1813,19 @@ Void TEncGOP::compressGOP( Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rc
       }
     }
 
+#if FRAME_PARALLEL_GOP
+    // loop filters, writing and PSNR of the compressed pictures, in coding order
+    for ( size_t iFrame = 0; iFrame < framesToFinish.size(); iFrame++ )
+    {
+    iGOPid         = framesToFinish[iFrame].iGOPid;
+    pcPic          = framesToFinish[iFrame].pcPic;
+    pcPicYuvRecOut = framesToFinish[iFrame].pcPicYuvRecOut;
+    iBeforeTime    = framesToFinish[iFrame].iBeforeTime;
+    AccessUnit& accessUnit = *framesToFinish[iFrame].pcAccessUnit;
+#if JVET_D0033_ADAPTIVE_CLIPPING
+    g_ClipParam    = pcPic->m_aclip_prm;
+#endif
+#endif
     duData.clear();
     pcSlice = pcPic->getSlice(0);
 
@@ -1954,6 +2007,14 @@ Void TEncGOP::compressGOP( Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rc
 
       pcSlice->setEncCABACTableIdx(m_pcSliceEncoder->getEncCABACTableIdx());
 
+#if FRAME_PARALLEL_GOP && ( VCEG_AZ07_BAC_ADAPT_WDOW || VCEG_AZ07_INIT_PREVFRAME )
+      if ( waveStart[iGOPid] != waveEnd[iGOPid] )
+      {
+        // the statistics indices were taken when the wave was set up, before the earlier pictures of the
+        // wave stored their statistics; the decoder takes them in coding order
+        pcSlice->initStatsGlobal( );
+      }
+#endif
       tmpBitsBeforeWriting = m_pcEntropyCoder->getNumberOfWrittenBits();
       m_pcEntropyCoder->encodeSliceHeader(pcSlice);
 #if VCEG_AZ07_BAC_ADAPT_WDOW || VCEG_AZ07_INIT_PREVFRAME
@@ -2055,7 +2116,15 @@ Void TEncGOP::compressGOP( Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rc
     xWriteTrailingSEIMessages(trailingSeiMessages, accessUnit, pcSlice->getTLayer(), pcSlice->getSPS());
     m_pcCfg->setEncodedFlag(iGOPid, true);
 
+#if FRAME_PARALLEL_GOP
+    // the picture is reported as it was when it was coded, not as marked by the later pictures of its wave
+    const Bool bReferenced = pcPic->getSlice(0)->isReferenced();
+    pcPic->getSlice(0)->setReferenced( framesToFinish[iFrame].bReferenced );
+#endif
     xCalculateAddPSNRs( isField, isTff, iGOPid, pcPic, accessUnit, rcListPic, dEncTime, snr_conversion, printFrameMSE );
+#if FRAME_PARALLEL_GOP
+    pcPic->getSlice(0)->setReferenced( bReferenced );
+#endif
     if (!digestStr.empty())
     {
       if(m_pcCfg->getDecodedPictureHashSEIEnabled() == 1)
@@ -2109,7 +2178,7 @@ Void TEncGOP::compressGOP( Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rc
     if (pcSlice->getSPS()->getUseInterKLT())
     {
 #endif
-        m_pcSliceEncoder->InterpolatePic(pcPic);
+        pcPic->resetSubPelCache();
 #if VCEG_AZ08_USE_KLT
     }
 #endif
@@ -2120,6 +2189,10 @@ Void TEncGOP::compressGOP( Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rc
     /* logging: insert a newline at end of picture period */
     printf("\n");
     fflush(stdout);
+#if FRAME_PARALLEL_GOP
+    }
+    framesToFinish.clear();
+#endif
 
     if (m_pcCfg->getEfficientFieldIRAPEnabled())
     {
@@ -2322,6 +2395,82 @@ Void TEncGOP::xInitGOP( Int iPOCLast, Int iNumPicRcvd, Bool isField )
   return;
 }
 
+#if FRAME_PARALLEL_GOP
+/** A wave is a run of consecutive pictures in coding order of which none is referenced by another one,
+ *  according to the RPS of the GOP entries. The pictures of a wave are compressed concurrently; every
+ *  picture is its own wave with FrameThreads 1 and when a tool keeps state between the pictures.
+ *  The waves do not depend on the number of threads, so neither does the bitstream. The pictures of a
+ *  wave are compressed from the previous-frame CABAC statistics (VCEG_AZ07_INIT_PREVFRAME) stored before
+ *  the wave, where the serial encoder would start a picture from the statistics of the one coded before it.
+ *  Their slices are then coded in coding order, with the statistics indices taken again before each one.
+ */
+Void TEncGOP::xGetFrameWaves( Int iPOCLast, Int iNumPicRcvd, Bool isField, std::vector<Int>& rWaveStart, std::vector<Int>& rWaveEnd )
+{
+  rWaveStart.resize( m_iGopSize );
+  rWaveEnd  .resize( m_iGopSize );
+  for ( Int iGOPid = 0; iGOPid < m_iGopSize; iGOPid++ )
+  {
+    rWaveStart[iGOPid] = rWaveEnd[iGOPid] = iGOPid;
+  }
+
+  if ( m_pcCfg->getFrameThreads() < 2 || m_pcEncTop->getNumCtuWorkers() < 2 || iPOCLast == 0
+    || isField || m_pcCfg->getUseRateCtrl() || m_pcCfg->getDeltaQpRD() > 0
+    || m_pcCfg->getSliceMode() != NO_SLICES || m_pcCfg->getSliceSegmentMode() != NO_SLICES
+#if ADAPTIVE_QP_SELECTION
+    || m_pcCfg->getUseAdaptQpSelect()
+#endif
+     )
+  {
+    return;
+  }
+
+  std::vector<Int> wavePOCs;
+  std::vector<Int> waveGOPids;
+  for ( Int iGOPid = 0; iGOPid <= m_iGopSize; iGOPid++ )
+  {
+    Bool bClose = iGOPid == m_iGopSize;
+    Bool bSingleton = false;
+    Int  pocCurr = 0;
+    if ( !bClose )
+    {
+      pocCurr = iPOCLast - iNumPicRcvd + m_pcCfg->getGOPEntry(iGOPid).m_POC;
+      if ( pocCurr >= m_pcCfg->getFramesToBeEncoded() )
+      {
+        continue;
+      }
+      const NalUnitType eNalUnitType = getNalUnitType( pocCurr, m_iLastIDR, isField );
+      bSingleton = eNalUnitType >= NAL_UNIT_CODED_SLICE_BLA_W_LP && eNalUnitType <= NAL_UNIT_CODED_SLICE_CRA;
+
+      const GOPEntry& rcEntry = m_pcCfg->getGOPEntry( m_pcEncTop->getReferencePictureSetIdxForSOP( pocCurr, iGOPid ) );
+      for ( Int j = 0; j < rcEntry.m_numRefPics && !bClose; j++ )
+      {
+        if ( rcEntry.m_usedByCurrPic[j] )
+        {
+          bClose = std::find( wavePOCs.begin(), wavePOCs.end(), pocCurr + rcEntry.m_referencePics[j] ) != wavePOCs.end();
+        }
+      }
+      bClose = bClose || bSingleton;
+    }
+
+    if ( bClose && !waveGOPids.empty() )
+    {
+      for ( size_t i = 0; i < waveGOPids.size(); i++ )
+      {
+        rWaveStart[waveGOPids[i]] = waveGOPids.front();
+        rWaveEnd  [waveGOPids[i]] = waveGOPids.back();
+      }
+      wavePOCs  .clear();
+      waveGOPids.clear();
+    }
+    if ( iGOPid < m_iGopSize && !bSingleton )
+    {
+      wavePOCs  .push_back( pocCurr );
+      waveGOPids.push_back( iGOPid );
+    }
+  }
+}
+#endif
+
 
 Void TEncGOP::xGetBuffer( TComList<TComPic*>&      rcListPic,
                          TComList<TComPicYuv*>&    rcListPicYuvRecOut,
@@ -2578,6 +2727,14 @@ Void TEncGOP::xCalculateAddPSNR( TComPic* pcPic, TComPicYuv* pcPicD, const Acces
     c += 32;
   }
 
+#if PIP
+  // picture end: fold the counters of the coding threads into the totals of the encoder
+  TComPIPContext& rcPIPContext = m_pcEncTop->getPIPContext();
+  rcPIPContext.mergePictureStats();
+  TComPIPStats& rcPIPStats = rcPIPContext.getTotalStats();
+  PIPStatsPolicy::add(rcPIPStats.totalAllbits, (Double)uibits);
+#endif
+
 #if ADAPTIVE_QP_SELECTION
   printf("POC %4d TId: %1d ( %c-SLICE, nQP %d QP %d ) %10d bits",
          pcSlice->getPOC(),
@@ -2591,8 +2748,7 @@ Void TEncGOP::xCalculateAddPSNR( TComPic* pcPic, TComPicYuv* pcPicD, const Acces
   FILE* fout = fopen("log2.txt", "a");
   if (fout)
   {
-	  totalAllbits += uibits;
-	  fprintf(fout, "\n%10d\t%10d", (Int)totalPIPbits, (Int)totalAllbits);
+	  fprintf(fout, "\n%10d\t%10d", (Int)rcPIPStats.totalPIPbits, (Int)rcPIPStats.totalAllbits);
 	  fclose(fout);
   }
 #endif
@@ -41,6 +41,7 @@
 #include <list>
 
 #include <stdlib.h>
+#include <time.h>
 
 #include "TLibCommon/TComList.h"
 #include "TLibCommon/TComPic.h"
@@ -84,6 +85,19 @@ class TEncGOP
     Int accumNalsDU;
   };
 
+#if FRAME_PARALLEL_GOP
+  /// compressed picture of a wave, waiting for its loop filters, writing and PSNR
+  struct TEncGOPFrame
+  {
+    Int         iGOPid;
+    TComPic*    pcPic;
+    TComPicYuv* pcPicYuvRecOut;
+    AccessUnit* pcAccessUnit;
+    clock_t     iBeforeTime;
+    Bool        bReferenced;      ///< before the RPS of the later pictures of the wave is applied
+  };
+#endif
+
 private:
 
   TEncAnalyze             m_gcAnalyzeAll;
@@ -144,15 +158,25 @@ private:
   TEncAdaptiveLoopFilter* m_pcAdaptiveLoopFilter;
 #if COM16_C806_ALF_TEMPPRED_NUM
 #if JVET_E0104_ALF_TEMP_SCALABILITY
-  static Int           m_iStoredAlfParaNum[JVET_E0104_ALF_MAX_TEMPLAYERID];
+  Int                  m_iStoredAlfParaNum[JVET_E0104_ALF_MAX_TEMPLAYERID];
   ALFParam             m_acStoredAlfPara[JVET_E0104_ALF_MAX_TEMPLAYERID][COM16_C806_ALF_TEMPPRED_NUM];
 #else
-  static Int           m_iStoredAlfParaNum;
+  Int                  m_iStoredAlfParaNum;
   ALFParam             m_acStoredAlfPara[COM16_C806_ALF_TEMPPRED_NUM];
 #endif
 #endif
 #endif
 
+#if JVET_C0024_AMAX_BT
+  // block size statistics of the previous picture of each temporal layer, for the maximum BT size
+  UInt                    m_auiBlkSize[10];
+  UInt                    m_auiNumBlk[10];
+#if JVET_C0024_AMAX_BT_FIX
+  UInt                    m_uiPrevISlicePOC;
+  Bool                    m_bInitAMaxBT;
+#endif
+#endif
+
 public:
   TEncGOP();
   virtual ~TEncGOP();
@@ -174,6 +198,11 @@ public:
 
   TComList<TComPic*>*   getListPic()      { return m_pcListPic; }
 
+#if JVET_C0024_AMAX_BT
+  UInt* getBlkSize()          { return m_auiBlkSize; }
+  UInt* getNumBlk()           { return m_auiNumBlk;  }
+#endif
+
 #if JVET_D0134_PSNR
   Void  printOutSummary      ( UInt uiNumAllPicCoded, Bool isField, const Bool printMSEBasedSNR, const Bool printSequenceMSE, const Bool trueBitdepthPSNR, const BitDepths &bitDepths );
 #else
@@ -199,6 +228,10 @@ protected:
 protected:
 
   Void  xInitGOP          ( Int iPOCLast, Int iNumPicRcvd, Bool isField );
+#if FRAME_PARALLEL_GOP
+  /// groups the GOP pictures that do not reference each other into waves of consecutive pictures in coding order
+  Void  xGetFrameWaves    ( Int iPOCLast, Int iNumPicRcvd, Bool isField, std::vector<Int>& rWaveStart, std::vector<Int>& rWaveEnd );
+#endif
   Void  xGetBuffer        ( TComList<TComPic*>& rcListPic, TComList<TComPicYuv*>& rcListPicYuvRecOut, Int iNumPicRcvd, Int iTimeOffset, TComPic*& rpcPic, TComPicYuv*& rpcPicYuvRecOut, Int pocCurr, Bool isField );
 
   Void  xCalculateAddPSNRs         ( const Bool isField, const Bool isFieldTopFieldFirst, const Int iGOPid, TComPic* pcPic, const AccessUnit&accessUnit, TComList<TComPic*> &rcListPic, Double dEncTime, const InputColourSpaceConversion snr_conversion, const Bool printFrameMSE );
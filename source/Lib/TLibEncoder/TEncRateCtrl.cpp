@@ -485,6 +485,10 @@ TEncRCPic::TEncRCPic()
   m_picActualBits       = 0;
   m_picQP               = 0;
   m_picLambda           = 0.0;
+#if WPP_PARALLEL_CTU_ROWS
+  m_ctuRowWidth         = 1;
+  m_ctuRowsIntra        = false;
+#endif
 }
 
 TEncRCPic::~TEncRCPic()
@@ -612,6 +616,10 @@ Void TEncRCPic::create( TEncRCSeq* encRCSeq, TEncRCGOP* encRCGOP, Int frameLevel
   m_picActualBits       = 0;
   m_picQP               = 0;
   m_picLambda           = 0.0;
+#if WPP_PARALLEL_CTU_ROWS
+  m_ctuRows.clear();
+  m_ctuRowWidth         = picWidthInLCU;
+#endif
 }
 
 Void TEncRCPic::destroy()
@@ -758,12 +766,18 @@ Int TEncRCPic::estimatePicQP( Double lambda, list<TEncRCPic*>& listPreviousPictu
   return QP;
 }
 
-Double TEncRCPic::getLCUTargetBpp(SliceType eSliceType)
+Double TEncRCPic::getLCUTargetBpp(SliceType eSliceType, Int LCUIdx)
 {
-  Int   LCUIdx    = getLCUCoded();
   Double bpp      = -1.0;
   Int avgBits     = 0;
 
+#if WPP_PARALLEL_CTU_ROWS
+  if ( !m_ctuRows.empty() )
+  {
+    avgBits = xGetCtuRowTargetBits( eSliceType, LCUIdx );
+  }
+  else
+#endif
   if (eSliceType == I_SLICE)
   {
     Int noOfLCUsLeft = m_numberOfLCU - LCUIdx + 1;
@@ -803,9 +817,8 @@ Double TEncRCPic::getLCUTargetBpp(SliceType eSliceType)
   return bpp;
 }
 
-Double TEncRCPic::getLCUEstLambda( Double bpp )
+Double TEncRCPic::getLCUEstLambda( Double bpp, Int LCUIdx )
 {
-  Int   LCUIdx = getLCUCoded();
   Double alpha;
   Double beta;
   if ( m_encRCSeq->getUseLCUSeparateModel() )
@@ -825,13 +838,10 @@ Double TEncRCPic::getLCUEstLambda( Double bpp )
 
   //for Lambda clip, LCU level clip
   Double clipNeighbourLambda = -1.0;
-  for ( Int i=LCUIdx - 1; i>=0; i-- )
+  Int neighbourLCU = xGetClipNeighbourLCU( LCUIdx, false );
+  if ( neighbourLCU >= 0 )
   {
-    if ( m_LCUs[i].m_lambda > 0 )
-    {
-      clipNeighbourLambda = m_LCUs[i].m_lambda;
-      break;
-    }
+    clipNeighbourLambda = m_LCUs[neighbourLCU].m_lambda;
   }
 
   if ( clipNeighbourLambda > 0.0 )
@@ -856,20 +866,16 @@ Double TEncRCPic::getLCUEstLambda( Double bpp )
   return estLambda;
 }
 
-Int TEncRCPic::getLCUEstQP( Double lambda, Int clipPicQP )
+Int TEncRCPic::getLCUEstQP( Double lambda, Int clipPicQP, Int LCUIdx )
 {
-  Int LCUIdx = getLCUCoded();
   Int estQP = Int( 4.2005 * log( lambda ) + 13.7122 + 0.5 );
 
   //for Lambda clip, LCU level clip
   Int clipNeighbourQP = g_RCInvalidQPValue;
-  for ( Int i=LCUIdx - 1; i>=0; i-- )
+  Int neighbourLCU = xGetClipNeighbourLCU( LCUIdx, true );
+  if ( neighbourLCU >= 0 )
   {
-    if ( (getLCU(i)).m_QP > g_RCInvalidQPValue )
-    {
-      clipNeighbourQP = getLCU(i).m_QP;
-      break;
-    }
+    clipNeighbourQP = getLCU(neighbourLCU).m_QP;
   }
 
   if ( clipNeighbourQP > g_RCInvalidQPValue )
@@ -882,6 +888,39 @@ Int TEncRCPic::getLCUEstQP( Double lambda, Int clipPicQP )
   return estQP;
 }
 
+/** The CTU whose lambda (bQP: QP) clips the one of LCUIdx: the last CTU before it with a valid one. On CTU
+ *  rows only the CTUs left of it in its row and the CTU above are taken, which are coded before it whatever
+ *  the order of the rows.
+ */
+Int TEncRCPic::xGetClipNeighbourLCU( Int LCUIdx, Bool bQP )
+{
+  Int firstLCU = 0;
+#if WPP_PARALLEL_CTU_ROWS
+  if ( !m_ctuRows.empty() )
+  {
+    firstLCU = LCUIdx - LCUIdx % m_ctuRowWidth;
+  }
+#endif
+  for ( Int i=LCUIdx - 1; i>=firstLCU; i-- )
+  {
+    if ( bQP ? m_LCUs[i].m_QP > g_RCInvalidQPValue : m_LCUs[i].m_lambda > 0 )
+    {
+      return i;
+    }
+  }
+#if WPP_PARALLEL_CTU_ROWS
+  if ( !m_ctuRows.empty() && LCUIdx >= m_ctuRowWidth )
+  {
+    Int i = LCUIdx - m_ctuRowWidth;
+    if ( bQP ? m_LCUs[i].m_QP > g_RCInvalidQPValue : m_LCUs[i].m_lambda > 0 )
+    {
+      return i;
+    }
+  }
+#endif
+  return -1;
+}
+
 Void TEncRCPic::updateAfterCTU( Int LCUIdx, Int bits, Int QP, Double lambda, Bool updateLCUParameter )
 {
   m_LCUs[LCUIdx].m_actualBits = bits;
@@ -943,6 +982,121 @@ Void TEncRCPic::updateAfterCTU( Int LCUIdx, Int bits, Int QP, Double lambda, Boo
 
 }
 
+#if WPP_PARALLEL_CTU_ROWS
+/** Shares the bits left to the picture between the CTU rows of the slice [firstLCU, endLCU), as
+ *  getLCUTargetBpp shares them between the CTUs left, so the CTUs of a row take their bits from the bits
+ *  left to their row only and the rows can be coded in any order. The rows are merged back into the
+ *  picture by mergeCtuRows.
+ */
+Void TEncRCPic::initCtuRows( Int firstLCU, Int endLCU, Int picWidthInLCU, SliceType eSliceType )
+{
+  m_ctuRowWidth  = picWidthInLCU;
+  m_ctuRowsIntra = eSliceType == I_SLICE;
+  m_ctuRows.clear();
+
+  Double totalWeight = 0.0;
+  for ( Int i=firstLCU; i<m_numberOfLCU; i++ )
+  {
+    totalWeight += m_ctuRowsIntra ? m_LCUs[i].m_costIntra : m_LCUs[i].m_bitWeight;
+  }
+
+  Double weightBefore = 0.0;
+  for ( Int rowLCU=firstLCU; rowLCU<endLCU; rowLCU+=picWidthInLCU )
+  {
+    TRCCtuRow row;
+    row.m_firstLCU           = rowLCU;
+    row.m_numberOfLCU        = min( picWidthInLCU, endLCU - rowLCU );
+    row.m_LCULeft            = row.m_numberOfLCU;
+    row.m_remainingCostIntra = 0.0;
+
+    Double rowWeight = 0.0;
+    for ( Int i=rowLCU; i<rowLCU+row.m_numberOfLCU; i++ )
+    {
+      rowWeight += m_ctuRowsIntra ? m_LCUs[i].m_costIntra : m_LCUs[i].m_bitWeight;
+      row.m_remainingCostIntra += m_LCUs[i].m_costIntra;
+    }
+
+    if ( totalWeight > 0.1 )
+    {
+      row.m_bitsLeft = Int( m_bitsLeft * ( weightBefore + rowWeight ) / totalWeight + 0.5 ) - Int( m_bitsLeft * weightBefore / totalWeight + 0.5 );
+    }
+    else
+    {
+      row.m_bitsLeft = Int( (Double)m_bitsLeft * row.m_numberOfLCU / m_LCULeft );
+    }
+    weightBefore += rowWeight;
+    m_ctuRows.push_back( row );
+  }
+}
+
+/// the target bits of CTU LCUIdx from the bits left to its row, as getLCUTargetBpp from the bits left to the picture
+Int TEncRCPic::xGetCtuRowTargetBits( SliceType eSliceType, Int LCUIdx )
+{
+  TRCCtuRow& row = xGetCtuRow( LCUIdx );
+  const Int endLCU = row.m_firstLCU + row.m_numberOfLCU;
+  Int avgBits = 0;
+
+  if (eSliceType == I_SLICE)
+  {
+    Int noOfLCUsLeft = endLCU - LCUIdx + 1;
+    Int bitrateWindow = min(4,noOfLCUsLeft);
+    Double MAD      = getLCU(LCUIdx).m_costIntra;
+    Int targetBitsLeft = getLCU(LCUIdx).m_targetBitsLeft - ( endLCU < m_numberOfLCU ? getLCU(endLCU).m_targetBitsLeft : 0 );
+
+    if (row.m_remainingCostIntra > 0.1 )
+    {
+      Double weightedBitsLeft = (row.m_bitsLeft*bitrateWindow+(row.m_bitsLeft-targetBitsLeft)*noOfLCUsLeft)/(Double)bitrateWindow;
+      avgBits = Int( MAD*weightedBitsLeft/row.m_remainingCostIntra );
+    }
+    else
+    {
+      avgBits = Int( row.m_bitsLeft / row.m_LCULeft );
+    }
+    row.m_remainingCostIntra -= MAD;
+  }
+  else
+  {
+    Double totalWeight = 0;
+    for ( Int i=LCUIdx; i<endLCU; i++ )
+    {
+      totalWeight += m_LCUs[i].m_bitWeight;
+    }
+    Int realInfluenceLCU = min( g_RCLCUSmoothWindowSize, row.m_LCULeft );
+    avgBits = (Int)( m_LCUs[LCUIdx].m_bitWeight - ( totalWeight - row.m_bitsLeft ) / realInfluenceLCU + 0.5 );
+  }
+  return avgBits;
+}
+
+/// updateAfterCTU of a CTU on the CTU rows: the picture is updated by mergeCtuRows
+Void TEncRCPic::updateCtuRow( Int LCUIdx, Int bits, Int QP, Double lambda )
+{
+  m_LCUs[LCUIdx].m_actualBits = bits;
+  m_LCUs[LCUIdx].m_QP         = QP;
+  m_LCUs[LCUIdx].m_lambda     = lambda;
+
+  TRCCtuRow& row = xGetCtuRow( LCUIdx );
+  row.m_LCULeft--;
+  row.m_bitsLeft -= bits;
+}
+
+/// updates the picture with the coded CTUs of the rows in CTU order, as updateAfterCTU after every CTU
+Void TEncRCPic::mergeCtuRows( Bool updateLCUParameter )
+{
+  for ( Int r=0; r<(Int)m_ctuRows.size(); r++ )
+  {
+    for ( Int i=m_ctuRows[r].m_firstLCU; i<m_ctuRows[r].m_firstLCU+m_ctuRows[r].m_numberOfLCU; i++ )
+    {
+      if ( m_ctuRowsIntra )
+      {
+        m_remainingCostIntra -= m_LCUs[i].m_costIntra;
+      }
+      updateAfterCTU( i, m_LCUs[i].m_actualBits, m_LCUs[i].m_QP, m_LCUs[i].m_lambda, updateLCUParameter );
+    }
+  }
+  m_ctuRows.clear();
+}
+#endif
+
 Double TEncRCPic::calAverageQP()
 {
   Int totalQPs = 0;
@@ -1116,10 +1270,8 @@ Void TEncRCPic::getLCUInitTargetBits()
 }
 
 
-Double TEncRCPic::getLCUEstLambdaAndQP(Double bpp, Int clipPicQP, Int *estQP)
+Double TEncRCPic::getLCUEstLambdaAndQP(Double bpp, Int clipPicQP, Int *estQP, Int LCUIdx)
 {
-  Int   LCUIdx = getLCUCoded();
-
   Double   alpha = m_encRCSeq->getPicPara( m_frameLevel ).m_alpha;
   Double   beta  = m_encRCSeq->getPicPara( m_frameLevel ).m_beta;
 
@@ -1128,13 +1280,10 @@ Double TEncRCPic::getLCUEstLambdaAndQP(Double bpp, Int clipPicQP, Int *estQP)
   Double estLambda = calculateLambdaIntra(alpha, beta, costPerPixel, bpp);
 
   Int clipNeighbourQP = g_RCInvalidQPValue;
-  for (Int i=LCUIdx-1; i>=0; i--)
+  Int neighbourLCU = xGetClipNeighbourLCU( LCUIdx, true );
+  if ( neighbourLCU >= 0 )
   {
-    if ((getLCU(i)).m_QP > g_RCInvalidQPValue)
-    {
-      clipNeighbourQP = getLCU(i).m_QP;
-      break;
-    }
+    clipNeighbourQP = getLCU(neighbourLCU).m_QP;
   }
 
   Int minQP = clipPicQP - 2;
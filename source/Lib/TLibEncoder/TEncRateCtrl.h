@@ -88,6 +88,18 @@ struct TRCLCU
   Int m_targetBitsLeft;
 };
 
+#if WPP_PARALLEL_CTU_ROWS
+/// bits of one CTU row of the slice when CTU level rate control runs on CTU rows compressed concurrently
+struct TRCCtuRow
+{
+  Int m_firstLCU;
+  Int m_numberOfLCU;
+  Int m_LCULeft;
+  Int m_bitsLeft;
+  Double m_remainingCostIntra;
+};
+#endif
+
 struct TRCParameter
 {
   Double m_alpha;
@@ -231,12 +243,22 @@ public:
 
   Void   updateAlphaBetaIntra(Double *alpha, Double *beta);
 
-  Double getLCUTargetBpp(SliceType eSliceType);
-  Double getLCUEstLambdaAndQP(Double bpp, Int clipPicQP, Int *estQP);
-  Double getLCUEstLambda( Double bpp );
-  Int    getLCUEstQP( Double lambda, Int clipPicQP );
+  Double getLCUTargetBpp(SliceType eSliceType)                          { return getLCUTargetBpp( eSliceType, getLCUCoded() ); }
+  Double getLCUEstLambdaAndQP(Double bpp, Int clipPicQP, Int *estQP)     { return getLCUEstLambdaAndQP( bpp, clipPicQP, estQP, getLCUCoded() ); }
+  Double getLCUEstLambda( Double bpp )                                   { return getLCUEstLambda( bpp, getLCUCoded() ); }
+  Int    getLCUEstQP( Double lambda, Int clipPicQP )                     { return getLCUEstQP( lambda, clipPicQP, getLCUCoded() ); }
+  Double getLCUTargetBpp(SliceType eSliceType, Int LCUIdx);
+  Double getLCUEstLambdaAndQP(Double bpp, Int clipPicQP, Int *estQP, Int LCUIdx);
+  Double getLCUEstLambda( Double bpp, Int LCUIdx );
+  Int    getLCUEstQP( Double lambda, Int clipPicQP, Int LCUIdx );
 
   Void updateAfterCTU( Int LCUIdx, Int bits, Int QP, Double lambda, Bool updateLCUParameter = true );
+#if WPP_PARALLEL_CTU_ROWS
+  Void initCtuRows( Int firstLCU, Int endLCU, Int picWidthInLCU, SliceType eSliceType );
+  Void updateCtuRow( Int LCUIdx, Int bits, Int QP, Double lambda );
+  Void mergeCtuRows( Bool updateLCUParameter );
+  Bool getUseCtuRows()                                    { return !m_ctuRows.empty(); }
+#endif
   Void updateAfterPicture( Int actualHeaderBits, Int actualTotalBits, Double averageQP, Double averageLambda, SliceType eSliceType);
 
   Void addToPictureLsit( list<TEncRCPic*>& listPreviousPictures );
@@ -246,6 +268,11 @@ public:
 private:
   Int xEstPicTargetBits( TEncRCSeq* encRCSeq, TEncRCGOP* encRCGOP );
   Int xEstPicHeaderBits( list<TEncRCPic*>& listPreviousPictures, Int frameLevel );
+  Int xGetClipNeighbourLCU( Int LCUIdx, Bool bQP );
+#if WPP_PARALLEL_CTU_ROWS
+  Int xGetCtuRowTargetBits( SliceType eSliceType, Int LCUIdx );
+  TRCCtuRow& xGetCtuRow( Int LCUIdx )                     { return m_ctuRows[LCUIdx / m_ctuRowWidth - m_ctuRows[0].m_firstLCU / m_ctuRowWidth]; }
+#endif
 
 public:
   TEncRCSeq*      getRCSequence()                         { return m_encRCSeq; }
@@ -299,6 +326,11 @@ private:
   Int m_picActualBits;          // the whole picture, including header
   Int m_picQP;                  // in integer form
   Double m_picLambda;
+#if WPP_PARALLEL_CTU_ROWS
+  vector<TRCCtuRow> m_ctuRows;  // the CTU rows of the slice, each given its share of the bits left; empty for the serial model
+  Int m_ctuRowWidth;
+  Bool m_ctuRowsIntra;
+#endif
 };
 
 class TEncRateCtrl
@@ -146,6 +146,9 @@ TEncSbac::TEncSbac()
 , m_cCUAffineFlagSCModel               ( 1,             1,               NUM_AFFINE_FLAG_CTX           , m_contextModels + m_numContextModels, m_numContextModels)
 // PIP context models
 #if PIP
+, m_pcPIPContext                       ( NULL )
+, m_pcPIPStats                         ( NULL )
+, m_pcPIPCoderState                    ( NULL )
 , m_cCUQtCbfSCModelPIP				   ( 1,             1,			     NUM_QT_CBF_CTX_PER_SET        , m_contextModels + m_numContextModels, m_numContextModels)
 , m_cCUSigCoeffGroupSCModelPIP		   ( 1,             2,               NUM_SIG_CG_FLAG_CTX		   , m_contextModels + m_numContextModels, m_numContextModels)
 , m_cCUSigSCModelPIP				   ( 1,             1,               NUM_SIG_FLAG_CTX	           , m_contextModels + m_numContextModels, m_numContextModels) // NUM_SIG_FLAG_CTX_LUMA instead of NUM_SIG_FLAG_CTX
@@ -831,7 +834,7 @@ Void TEncSbac::codePIPflag(TComDataCU* pcCU, UInt uiAbsPartIdx, int *spQR1
 	m_pcBinIf->encodeBin(f, m_cCUPIPflag.get(0, 0, CtxIdx));
 
 	
-	if (encodeTime && verbose)
+	if (m_pcPIPCoderState->encodeTime && verbose)
 		cout << ",PIP:" << (Int)f;
 			
 
@@ -840,14 +843,14 @@ Void TEncSbac::codePIPflag(TComDataCU* pcCU, UInt uiAbsPartIdx, int *spQR1
 	w /= 2;
 #endif
 
-	if (encodeTime)
+	if (m_pcPIPCoderState->encodeTime)
 	{
-		cbfStats[f]++;
-		cbfStats[f + 2] += (Int)pcCU->getCbf(uiAbsPartIdx, COMPONENT_Y);				
+		PIPStatsPolicy::inc(m_pcPIPStats->cbfStats[f]);
+		PIPStatsPolicy::add(m_pcPIPStats->cbfStats[f + 2], (Int)pcCU->getCbf(uiAbsPartIdx, COMPONENT_Y));				
 	}
 	if (f
 #if R1_CODECOEFFNXN_TEST
-		&& !tmpFlag
+		&& !m_pcPIPCoderState->tmpFlag
 #endif
 		)
 	{		
@@ -859,7 +862,7 @@ Void TEncSbac::codePIPflag(TComDataCU* pcCU, UInt uiAbsPartIdx, int *spQR1
 
 		
 #if SP_QCHANGE
-		int tmp_spQ = spQ;
+		int tmp_spQ = m_pcPIPContext->getSpQ();
 		int spQIsChanged = pcCU->getPIPspQIsChangedFlag(uiAbsPartIdx);
 		int spQChange = 0;
 #if SP_SIGNLECHANGE
@@ -885,17 +888,17 @@ Void TEncSbac::codePIPflag(TComDataCU* pcCU, UInt uiAbsPartIdx, int *spQR1
 		if (spQIsChanged)
 		{
 #if SP_SIGNLECHANGE
-			spQ += (spQChange == 0 ? -1 : 1) * SP_QOFFSET;
-			spQ = max(spQ, 1);
+			m_pcPIPContext->setSpQ(m_pcPIPContext->getSpQ() + (spQChange == 0 ? -1 : 1) * SP_QOFFSET);
+			m_pcPIPContext->setSpQ(max(m_pcPIPContext->getSpQ(), 1));
 #else
-			spQ += (spQChange % 2 ? -1 : 1) * (floor((spQChange - 1) / 2) + 1) * SP_QQUANTIZER;
-			if (spQ < 1)
-				spQ = 1;
+			m_pcPIPContext->setSpQ(m_pcPIPContext->getSpQ() + (spQChange % 2 ? -1 : 1) * (floor((spQChange - 1) / 2) + 1) * SP_QQUANTIZER);
+			if (m_pcPIPContext->getSpQ() < 1)
+				m_pcPIPContext->setSpQ(1);
 #endif
 		}
 
 #if SP_QCHANGE
-		if (encodeTime)
+		if (m_pcPIPCoderState->encodeTime)
 		{
 			spQall++;
 			spQisChanged_stat += spQIsChanged;
@@ -917,10 +920,10 @@ Void TEncSbac::codePIPflag(TComDataCU* pcCU, UInt uiAbsPartIdx, int *spQR1
 // ==============================
 // --------------- encode 2x2cbf
 		// Bool cbfException[16];
-		Bool *cbfException = (Bool*)xMalloc(Bool, w*h*sizeof(Bool));
+		Bool cbfException[CUMAX*CUMAX];
 		memset(cbfException, 0, w*h * sizeof(Bool));
 		// UInt cbf2x2[4] = { 0, 0, 0, 0 };
-		UInt *cbf2x2 = (UInt*)xMalloc(UInt, w*h*sizeof(UInt) / 4);
+		UInt cbf2x2[CUMAX*CUMAX / 4];
 		memset(cbf2x2, 0, w*h*sizeof(UInt) / 4);
 		codeR1CBF(spQR1, cbf2x2, cbfException, w, h);
 
@@ -938,6 +941,15 @@ Void TEncSbac::codePIPflag(TComDataCU* pcCU, UInt uiAbsPartIdx, int *spQR1
 // --------------- encode amplitudes 
 				int sign;
 				int bin=0;
+#if PIP_R1_HT_BINARIZATION
+				if (m_pcPIPContext->getR1HighThroughput())
+				{
+					// amplitudes and signs
+					codeR1_highThroughput(spQR1, w, h, cbfException, cbf2x2);
+				}
+				else
+				{
+#endif
 #if BITPLANE_R1_CODING
 				codeR1_bitplane(spQR1, cbf2x2, cbfException, w, h);
 
@@ -973,10 +985,6 @@ Void TEncSbac::codePIPflag(TComDataCU* pcCU, UInt uiAbsPartIdx, int *spQR1
 
 #endif 	
 				
-#if CBF2x2
-				_aligned_free(cbfException);
-				_aligned_free(cbf2x2);
-#endif
 				
 				
 				int b2 = m_pcBinIf->getNumWrittenBits();
@@ -1007,15 +1015,18 @@ Void TEncSbac::codePIPflag(TComDataCU* pcCU, UInt uiAbsPartIdx, int *spQR1
 #endif
 #if NOISE_MARK
 							int mark = spQR1NoiseMark[j*w + i];
-							if (spQR1[j*w+i]/spQ >= NOISE_THR)
+							if (spQR1[j*w+i]/m_pcPIPContext->getSpQ() >= NOISE_THR)
 								m_pcBinIf->encodeBin(mark, m_cCUPIPNoiseMark.get(0, 0, 0));
-							if (encodeTime)
-								fprintf(stdout, "%2d\t%d\n", spQR1[j*w + i] / spQ, spQR1NoiseMark[j*w + i]);
+							if (m_pcPIPCoderState->encodeTime)
+								fprintf(stdout, "%2d\t%d\n", spQR1[j*w + i] / m_pcPIPContext->getSpQ(), spQR1NoiseMark[j*w + i]);
 
 #endif
 						}
 #endif
-				if (encodeTime && false)
+#if PIP_R1_HT_BINARIZATION
+				} // if (m_pcPIPContext->getR1HighThroughput())
+#endif
+				if (m_pcPIPCoderState->encodeTime && false)
 				{
 					fprintf(stdout, "\n");
 				}
@@ -1053,7 +1064,7 @@ Void TEncSbac::codePIPflag(TComDataCU* pcCU, UInt uiAbsPartIdx, int *spQR1
 
 #if SP_QCHANGE
 		if (spQIsChanged)
-			spQ = tmp_spQ;
+			m_pcPIPContext->setSpQ(tmp_spQ);
 #endif
 		
 	}
@@ -1069,29 +1080,29 @@ Void TEncSbac::codeR1_regular(int *spQR1, int w, int h
 	// offset here	
 	int offset_temp = 0;
 #if CBF2x2	
-	int *cbfMap = (int*)xMalloc(int, w*h*sizeof(int));
+	int cbfMap[CUMAX*CUMAX];
 	if (w == 4 && h == 4)
 	{
 		memcpy(cbfMap, cbfMap4x4, w*h*sizeof(int));
-		offset_temp = offset4x4;
+		offset_temp = m_pcPIPContext->getSpQOffset(4, 4);
 	}
 	if (w == 4 && h == 8)
 	{
 		memcpy(cbfMap, cbfMap4x8, w*h*sizeof(int));
-		offset_temp = offset4x8;
+		offset_temp = m_pcPIPContext->getSpQOffset(4, 8);
 	}
 	if (w == 8 && h == 4)
 	{
 		memcpy(cbfMap, cbfMap8x4, w*h*sizeof(int));
-		offset_temp = offset8x4;
+		offset_temp = m_pcPIPContext->getSpQOffset(8, 4);
 	}
 	if (w == 8 && h == 8)
 	{
 		memcpy(cbfMap, cbfMap8x8, w*h*sizeof(int));
-		offset_temp = offset8x8;
+		offset_temp = m_pcPIPContext->getSpQOffset(8, 8);
 	}
 #endif
-	int qStep = spQ + offset_temp;
+	int qStep = m_pcPIPContext->getSpQ() + offset_temp;
 	
 	for (int j = 0; j < h; j++)
 		for (int i = 0; i < w; i++)
@@ -1121,11 +1132,56 @@ Void TEncSbac::codeR1_regular(int *spQR1, int w, int h
 #endif
 		}
 
-#if CBF2x2
-	_aligned_free(cbfMap);
-#endif
 }
 
+#if PIP_R1_HT_BINARIZATION
+/** R1 of the high-throughput binarization (SPS pip_r1_high_throughput_flag), in three passes over the block:
+ *  - at most two context bins per sample: greater than 0 on the amplitude context 0 (not coded when
+ *    derivable from CBF2x2) and greater than 1 on the amplitude context 1,
+ *  - the remainders ampl-2 as bypass EG0 codes,
+ *  - the signs of the non-zero samples as bypass bins, PIP_R1_HT_SIGN_GROUP per call.
+ *  The bypass bins of a block are contiguous, so the decoder reads them in runs.
+ */
+Void TEncSbac::codeR1_highThroughput(int *spQR1, int w, int h, Bool *cbfException, UInt *cbf2x2)
+{
+	const int* cbfMap = w == 8 ? (h == 8 ? cbfMap8x8 : cbfMap8x4) : (h == 8 ? cbfMap4x8 : cbfMap4x4);
+	const int qStep = m_pcPIPContext->getQStep(w, h);
+
+	int ampl[CUMAX*CUMAX];
+	for (int p = 0; p < w*h; p++)
+	{
+		ampl[p] = abs(spQR1[p]) / qStep;
+		if (!cbf2x2[cbfMap[p]])
+			continue;
+		if (!cbfException[p])
+			m_pcBinIf->encodeBin(ampl[p] > 0, m_cCUR1SpGr.get(0, 0, 0));
+		if (ampl[p])
+			m_pcBinIf->encodeBin(ampl[p] > 1, m_cCUR1SpGr.get(0, 0, 1));
+	}
+
+	for (int p = 0; p < w*h; p++)
+		if (ampl[p] > 1)
+			xWriteEpExGolomb(ampl[p] - 2, 0);
+
+	UInt signBins = 0;
+	Int numSignBins = 0;
+	for (int p = 0; p < w*h; p++)
+	{
+		if (!ampl[p])
+			continue;
+		signBins = (signBins << 1) | (spQR1[p] < 0);
+		if (++numSignBins == PIP_R1_HT_SIGN_GROUP)
+		{
+			m_pcBinIf->encodeBinsEP(signBins, numSignBins);
+			signBins = 0;
+			numSignBins = 0;
+		}
+	}
+	if (numSignBins)
+		m_pcBinIf->encodeBinsEP(signBins, numSignBins);
+}
+#endif
+
 #if R1_DIRECTCODING
 Void TEncSbac::codeR1_DirectCoding(int *spQR1, int w, int h
 #if CBF2x2
@@ -1175,29 +1231,29 @@ Void TEncSbac::codeR1_DirectCoding(int *spQR1, int w, int h
 	};
 
 #if CBF2x2	
-	int *cbfMap = (int*)xMalloc(int, w*h*sizeof(int));
+	int cbfMap[CUMAX*CUMAX];
 	if (w == 4 && h == 4)
 	{
 		memcpy(cbfMap, cbfMap4x4, w*h*sizeof(int));
-		offset_temp = offset4x4;
+		offset_temp = m_pcPIPContext->getSpQOffset(4, 4);
 	}
 	if (w == 4 && h == 8)
 	{
 		memcpy(cbfMap, cbfMap4x8, w*h*sizeof(int));
-		offset_temp = offset4x8;
+		offset_temp = m_pcPIPContext->getSpQOffset(4, 8);
 	}
 	if (w == 8 && h == 4)
 	{
 		memcpy(cbfMap, cbfMap8x4, w*h*sizeof(int));
-		offset_temp = offset8x4;
+		offset_temp = m_pcPIPContext->getSpQOffset(8, 4);
 	}
 	if (w == 8 && h == 8)
 	{
 		memcpy(cbfMap, cbfMap8x8, w*h*sizeof(int));
-		offset_temp = offset8x8;
+		offset_temp = m_pcPIPContext->getSpQOffset(8, 8);
 	}
 #endif
-	int qStep = spQ + offset_temp;
+	int qStep = m_pcPIPContext->getSpQ() + offset_temp;
 	int bin, ctx;
 	for (int j = 0; j < h; j++)
 		for (int i = 0; i < w; i++)
@@ -1220,23 +1276,20 @@ Void TEncSbac::codeR1_DirectCoding(int *spQR1, int w, int h
 #endif
 		}
 
-#if CBF2x2
-	_aligned_free(cbfMap);
-#endif
 }
 #endif
 
 #if R1_PREDICTIVE
 Void TEncSbac::codeR1_predictive(int *spQR1, UInt *cbf2x2, Bool *cbfException, int w, int h)
 {
-	if (encodeTime && false)
+	if (m_pcPIPCoderState->encodeTime && false)
 		cout << endl;
 	UInt left, top, topleft, sum, bin;
 	for (int j = 0; j < h; j++)
 		for (int i = 0; i < w; i++)
 		{
-			int ampl = abs(spQR1[j*w + i]) / spQ;
-			if (encodeTime && false)
+			int ampl = abs(spQR1[j*w + i]) / m_pcPIPContext->getSpQ();
+			if (m_pcPIPCoderState->encodeTime && false)
 				cout << j*w + i << " --> " << ampl << ":\t";
 #if CBF2x2
 			if (cbf2x2[cbfMap4x4[j*w + i]])
@@ -1248,9 +1301,9 @@ Void TEncSbac::codeR1_predictive(int *spQR1, UInt *cbf2x2, Bool *cbfException, i
 					top		= j				? abs(spQR1[(j - 1)*w + i])		: left;
 					topleft = (i && j)		? abs(spQR1[(j - 1)*w + i - 1]) : left;
 
-					left /= spQ;
-					top /= spQ;
-					topleft /= spQ;
+					left /= m_pcPIPContext->getSpQ();
+					top /= m_pcPIPContext->getSpQ();
+					topleft /= m_pcPIPContext->getSpQ();
 				}
 #endif
 				for (int a = 0; a < ampl; a++)
@@ -1267,7 +1320,7 @@ Void TEncSbac::codeR1_predictive(int *spQR1, UInt *cbf2x2, Bool *cbfException, i
 						if (!j && !i)
 						{
 							m_pcBinIf->encodeBinEP(1);
-							if (encodeTime && false)
+							if (m_pcPIPCoderState->encodeTime && false)
 								cout << "EP 1     \t";
 						}
 						else
@@ -1294,7 +1347,7 @@ Void TEncSbac::codeR1_predictive(int *spQR1, UInt *cbf2x2, Bool *cbfException, i
 								bin = 1 - bin;
 							}
 							m_pcBinIf->encodeBin(bin, m_cCUR1SpGr.get(0, 0, a));
-							if (encodeTime && false)
+							if (m_pcPIPCoderState->encodeTime && false)
 								cout << "Pr 1:e" << bin << ",s" << sum << "\t";
 						}
 #if CBF2x2
@@ -1309,7 +1362,7 @@ Void TEncSbac::codeR1_predictive(int *spQR1, UInt *cbf2x2, Bool *cbfException, i
 					if (!i && !j)
 					{
 						m_pcBinIf->encodeBinEP(0);
-						if (encodeTime && false)
+						if (m_pcPIPCoderState->encodeTime && false)
 							cout << "EP 0" << endl;
 					}
 					else
@@ -1336,7 +1389,7 @@ Void TEncSbac::codeR1_predictive(int *spQR1, UInt *cbf2x2, Bool *cbfException, i
 						}
 
 						m_pcBinIf->encodeBin(bin, m_cCUR1SpGr.get(0, 0, ampl));
-						if (encodeTime && false)
+						if (m_pcPIPCoderState->encodeTime && false)
 							cout << "Pr 0:e" << bin << ",s" << sum << endl;
 					}
 				}
@@ -1344,7 +1397,7 @@ Void TEncSbac::codeR1_predictive(int *spQR1, UInt *cbf2x2, Bool *cbfException, i
 			}
 			else
 			{
-				if (encodeTime && false)
+				if (m_pcPIPCoderState->encodeTime && false)
 					cout << "CBF0" << endl;
 			}
 #endif
@@ -1359,33 +1412,33 @@ Void TEncSbac::codeR1_bitplane(int *spQR1, UInt *cbf2x2, Bool *cbfException, int
 	// UInt outbl[MAXDYN - 1][4][4];
 	UInt *vector = new UInt[16];
 	for (int cf = 0; cf < 16; cf++)
-		vector[cf] = abs(spQR1[cf]) / spQ;
+		vector[cf] = abs(spQR1[cf]) / m_pcPIPContext->getSpQ();
 	convertToBitLayers_Unary(vector, 16, outbl);
 	Int situations[MAXDYN - 1][4][4];
 	computeSituationsFromBitLayers_Unary(outbl, situations);
 
 	int offset_temp = 0;
 #if CBF2x2	
-	int *cbfMap = (int*)xMalloc(int, w*h*sizeof(int));
+	int cbfMap[CUMAX*CUMAX];
 	if (w == 4 && h == 4)
 	{
 		memcpy(cbfMap, cbfMap4x4, w*h*sizeof(int));
-		offset_temp = offset4x4;
+		offset_temp = m_pcPIPContext->getSpQOffset(4, 4);
 	}
 	if (w == 4 && h == 8)
 	{
 		memcpy(cbfMap, cbfMap4x8, w*h*sizeof(int));
-		offset_temp = offset4x8;
+		offset_temp = m_pcPIPContext->getSpQOffset(4, 8);
 	}
 	if (w == 8 && h == 4)
 	{
 		memcpy(cbfMap, cbfMap8x4, w*h*sizeof(int));
-		offset_temp = offset8x4;
+		offset_temp = m_pcPIPContext->getSpQOffset(8, 4);
 	}
 	if (w == 8 && h == 8)
 	{
 		memcpy(cbfMap, cbfMap8x8, w*h*sizeof(int));
-		offset_temp = offset8x8;
+		offset_temp = m_pcPIPContext->getSpQOffset(8, 8);
 	}
 #endif
 
@@ -1414,7 +1467,7 @@ Void TEncSbac::codeR1_bitplane(int *spQR1, UInt *cbf2x2, Bool *cbfException, int
 Void TEncSbac::codeR1CBF(int* spQR1, UInt *cbf2x2, Bool *cbfException, int w, int h)
 {
 
-	int *cbf2x2BlMap = (int*)xMalloc(int, w*h*sizeof(int) / 4);
+	int cbf2x2BlMap[CUMAX*CUMAX];
 	if (w == 4 && h == 4)
 		memcpy(cbf2x2BlMap, cbf2x2BlMap4x4, w*h*sizeof(int));
 	if (w == 4 && h == 8)
@@ -1424,7 +1477,7 @@ Void TEncSbac::codeR1CBF(int* spQR1, UInt *cbf2x2, Bool *cbfException, int w, in
 	if (w == 8 && h == 8)
 		memcpy(cbf2x2BlMap, cbf2x2BlMap8x8, w*h*sizeof(int));
 
-	int *cbfMap = (int*)xMalloc(int, w*h*sizeof(int));
+	int cbfMap[CUMAX*CUMAX];
 	if (w == 4 && h == 4)
 		memcpy(cbfMap, cbfMap4x4, w*h*sizeof(int));
 	if (w == 4 && h == 8)
@@ -1462,8 +1515,258 @@ Void TEncSbac::codeR1CBF(int* spQR1, UInt *cbf2x2, Bool *cbfException, int w, in
 		
 		
 
-	_aligned_free(cbf2x2BlMap);
-	_aligned_free(cbfMap);
+}
+#endif
+
+#if SRDOQ_INCREMENTAL && CBF2x2
+/// same bit count and context update as TEncBinCABACCounter::encodeBin
+static inline Int xCountBin(UInt binValue, ContextModel& rcCtxModel)
+{
+	const Int fracBits = rcCtxModel.getEntropyBits(binValue);
+#if VCEG_AZ07_BAC_ADAPT_WDOW || VCEG_AZ05_MULTI_PARAM_CABAC
+	if (binValue == 0)
+		rcCtxModel.updateLPS();
+	else
+		rcCtxModel.updateMPS();
+#else
+	rcCtxModel.update(binValue);
+#endif
+	return fracBits;
+}
+
+#if PIP_R1_HT_BINARIZATION
+/// bins of xWriteEpExGolomb(symbol, 0)
+static inline Int xEpExGolomb0Length(UInt symbol)
+{
+	Int numBins = 1;
+	for (UInt count = 0; symbol >= (1u << count); count++)
+	{
+		symbol -= 1u << count;
+		numBins += 2;
+	}
+	return numBins;
+}
+#endif
+
+/// CBF2x2 / position maps of a PIP block size
+static Void xGetR1Maps(Int w, Int h, const int*& cbfMap, const int*& cbf2x2BlMap)
+{
+	cbfMap = cbfMap4x4;
+	cbf2x2BlMap = cbf2x2BlMap4x4;
+	if (w == 4 && h == 8)
+	{
+		cbfMap = cbfMap4x8;
+		cbf2x2BlMap = cbf2x2BlMap4x8;
+	}
+	if (w == 8 && h == 4)
+	{
+		cbfMap = cbfMap8x4;
+		cbf2x2BlMap = cbf2x2BlMap8x4;
+	}
+	if (w == 8 && h == 8)
+	{
+		cbfMap = cbfMap8x8;
+		cbf2x2BlMap = cbf2x2BlMap8x8;
+	}
+}
+
+/// CBF2x2 flags and derivable first amplitude bins, as in codeR1CBF
+static Void xDeriveR1CBF(const Int* spQR1, Int w, Int h, const int* cbfMap, const int* cbf2x2BlMap, UInt* cbf2x2, Bool* cbfException)
+{
+	memset(cbf2x2, 0, w*h / 4 * sizeof(UInt));
+	memset(cbfException, 0, w*h * sizeof(Bool));
+	for (int cf = 0; cf < w*h; cf++)
+		if (spQR1[cf] != 0)
+			cbf2x2[cbfMap[cf]] = 1;
+
+	for (int blk2x2 = 0; blk2x2 < w*h / 4; blk2x2++)
+	{
+		if (cbf2x2[blk2x2])
+		{
+			Bool isException = true;
+			for (int cf = 0; cf < 3; cf++)
+				if (spQR1[cbf2x2BlMap[blk2x2 * 4 + cf]] != 0)
+					isException = false;
+			cbfException[cbf2x2BlMap[blk2x2 * 4 + 3]] = isException;
+		}
+	}
+}
+
+/** Rate of the R1 part of the PIP syntax (CBF2x2 flags, amplitudes and signs) in 1/32768 bit units.
+ *  It follows codeR1CBF/codeR1_regular and the sign loop of codePIPflag bin by bin, but on copies of
+ *  the context models, so the coder state is not touched. The other PIP syntax elements do not depend
+ *  on R1, which lets the spatial RDOQ get the rate of a candidate without a full xGetIntraBitsQT pass.
+ */
+UInt64 TEncSbac::estimatePIPR1FracBits(TComDataCU* pcCU, const Int* spQR1)
+{
+	const Int w = pcCU->getWidth(0);
+	const Int h = pcCU->getHeight(0);
+#if CU_EXCLUSIVE
+	if (w != CUMAX || h != CUMAX || !pcCU->getPIPflag(0))
+#else
+	if (w > CUMAX || h > CUMAX || !pcCU->getPIPflag(0))
+#endif
+		return 0;
+
+	const int *cbfMap, *cbf2x2BlMap;
+	xGetR1Maps(w, h, cbfMap, cbf2x2BlMap);
+	const int qStep = m_pcPIPContext->getQStep(w, h);
+
+	UInt cbf2x2[CUMAX*CUMAX / 4];
+	Bool cbfException[CUMAX*CUMAX];
+	xDeriveR1CBF(spQR1, w, h, cbfMap, cbf2x2BlMap, cbf2x2, cbfException);
+
+	UInt64 fracBits = 0;
+	for (int cg = 0; cg < w*h / 4; cg++)
+	{
+		ContextModel cbfCtx = m_cCUPIPR1Cbf.get(0, 0, cg); // one context per 2x2 group, used once
+		fracBits += xCountBin(cbf2x2[cg], cbfCtx);
+	}
+
+#if PIP_R1_HT_BINARIZATION
+	if (m_pcPIPContext->getR1HighThroughput())
+	{
+		// as codeR1_highThroughput: two adaptive bins per sample, the remainders and the signs are bypass bins
+		ContextModel gt0Ctx = m_cCUR1SpGr.get(0, 0, 0);
+		ContextModel gt1Ctx = m_cCUR1SpGr.get(0, 0, 1);
+		for (int cf = 0; cf < w*h; cf++)
+		{
+			if (!cbf2x2[cbfMap[cf]])
+				continue;
+			const int ampl = abs(spQR1[cf]) / qStep;
+			if (!cbfException[cf])
+				fracBits += xCountBin(ampl > 0, gt0Ctx);
+			if (ampl)
+				fracBits += xCountBin(ampl > 1, gt1Ctx) + (UInt64(1 + (ampl > 1 ? xEpExGolomb0Length(ampl - 2) : 0)) << 15);
+		}
+		return fracBits;
+	}
+#endif
+
+	// amplitudes: unary on m_cCUR1SpGr, the contexts adapt from bin to bin
+	ContextModel grCtx[COEFF_LIMIT + 1];
+	for (int a = 0; a <= COEFF_LIMIT; a++)
+		grCtx[a] = m_cCUR1SpGr.get(0, 0, a);
+	for (int cf = 0; cf < w*h; cf++)
+	{
+		if (!cbf2x2[cbfMap[cf]])
+			continue;
+		const int ampl = abs(spQR1[cf]) / qStep;
+		for (int a = 0; a < ampl; a++)
+		{
+			if (!a && cbfException[cf])
+				continue;
+			fracBits += xCountBin(1, grCtx[a]);
+		}
+		if (ampl < COEFF_LIMIT)
+			fracBits += xCountBin(0, grCtx[ampl]);
+	}
+
+	// signs
+	ContextModel signCtx = m_cCUR1SpSign.get(0, 0, 0);
+	for (int cf = 0; cf < w*h; cf++)
+		if (spQR1[cf] != 0)
+			fracBits += xCountBin(spQR1[cf] < 0, signCtx);
+
+	return fracBits;
+}
+
+/** Fill the bit table of the fast PIP rate estimate from the current context states.
+ *  The table ignores the adaptation of the contexts inside the block, so one amplitude or sign
+ *  costs the same wherever it is in the block.
+ */
+Void TEncSbac::initPIPRateTable(TComDataCU* pcCU, PIPRateTable& rTable)
+{
+	rTable.width = pcCU->getWidth(0);
+	rTable.height = pcCU->getHeight(0);
+#if CU_EXCLUSIVE
+	rTable.isCoded = rTable.width == CUMAX && rTable.height == CUMAX;
+#else
+	rTable.isCoded = rTable.width <= CUMAX && rTable.height <= CUMAX;
+#endif
+	if (!rTable.isCoded)
+		return;
+
+	const int *cbfMap, *cbf2x2BlMap;
+	xGetR1Maps(rTable.width, rTable.height, cbfMap, cbf2x2BlMap);
+	rTable.qStep = m_pcPIPContext->getQStep(rTable.width, rTable.height);
+
+	const UInt CtxIdx = (log2(rTable.width) - 2) * (log2((UInt)CUMAX) - 1) + (log2(rTable.height) - 2);
+	rTable.flagBits = m_cCUPIPflag.get(0, 0, CtxIdx).getEntropyBits(1);
+
+	for (int cg = 0; cg < rTable.width*rTable.height / 4; cg++)
+		for (int bin = 0; bin < 2; bin++)
+			rTable.cbfBits[cg][bin] = m_cCUPIPR1Cbf.get(0, 0, cg).getEntropyBits(bin);
+
+#if PIP_R1_HT_BINARIZATION
+	if (m_pcPIPContext->getR1HighThroughput())
+	{
+		// greater than 0 / greater than 1 bins, then bypass bins
+		ContextModel& gt0Ctx = m_cCUR1SpGr.get(0, 0, 0);
+		ContextModel& gt1Ctx = m_cCUR1SpGr.get(0, 0, 1);
+		for (int ampl = 0; ampl <= COEFF_LIMIT; ampl++)
+		{
+			const Int restBits = ampl ? gt1Ctx.getEntropyBits(ampl > 1) + (ampl > 1 ? xEpExGolomb0Length(ampl - 2) << 15 : 0) : 0;
+			rTable.levelBits[0][ampl] = gt0Ctx.getEntropyBits(ampl > 0) + restBits;
+			rTable.levelBits[1][ampl] = restBits;
+		}
+		rTable.signBits[0] = rTable.signBits[1] = 1 << 15;
+	}
+	else
+#endif
+	{
+		Int onesBits = 0;
+		for (int ampl = 0; ampl <= COEFF_LIMIT; ampl++)
+		{
+			const Int zeroBits = ampl < COEFF_LIMIT ? m_cCUR1SpGr.get(0, 0, ampl).getEntropyBits(0) : 0;
+			rTable.levelBits[0][ampl] = onesBits + zeroBits;
+			rTable.levelBits[1][ampl] = onesBits + zeroBits - (ampl ? m_cCUR1SpGr.get(0, 0, 0).getEntropyBits(1) : 0);
+			if (ampl < COEFF_LIMIT)
+				onesBits += m_cCUR1SpGr.get(0, 0, ampl).getEntropyBits(1);
+		}
+
+		for (int sign = 0; sign < 2; sign++)
+			rTable.signBits[sign] = m_cCUR1SpSign.get(0, 0, 0).getEntropyBits(sign);
+	}
+
+#if MULTIPLEPRED
+	for (int idx = 0; idx < MULTIPLEPRED; idx++)
+	{
+		// same binarization as codePIPflag
+		rTable.predictorBits[idx] = m_cCUPIPPredictors.get(0, 0, 0).getEntropyBits(idx >= 2)
+			+ m_cCUPIPPredictors.get(0, 0, idx < 2 ? 1 : 2).getEntropyBits(idx & 1);
+	}
+#else
+	rTable.predictorBits[0] = 0;
+#endif
+}
+
+/// fast rate of the PIP syntax (flag, R1 and predictor index) of a block, in 1/32768 bit units
+UInt64 TEncSbac::estimatePIPFracBits(const PIPRateTable& rTable, const Int* spQR1, Int predictor)
+{
+	if (!rTable.isCoded)
+		return 0;
+
+	const Int w = rTable.width, h = rTable.height;
+	const int *cbfMap, *cbf2x2BlMap;
+	xGetR1Maps(w, h, cbfMap, cbf2x2BlMap);
+
+	UInt cbf2x2[CUMAX*CUMAX / 4];
+	Bool cbfException[CUMAX*CUMAX];
+	xDeriveR1CBF(spQR1, w, h, cbfMap, cbf2x2BlMap, cbf2x2, cbfException);
+
+	UInt64 fracBits = rTable.flagBits + rTable.predictorBits[MULTIPLEPRED ? predictor : 0];
+	for (int cg = 0; cg < w*h / 4; cg++)
+		fracBits += rTable.cbfBits[cg][cbf2x2[cg]];
+	for (int cf = 0; cf < w*h; cf++)
+	{
+		if (!cbf2x2[cbfMap[cf]])
+			continue;
+		fracBits += rTable.levelBits[cbfException[cf]][abs(spQR1[cf]) / rTable.qStep];
+		if (spQR1[cf] != 0)
+			fracBits += rTable.signBits[spQR1[cf] < 0];
+	}
+	return fracBits;
 }
 #endif
 
@@ -1504,7 +1807,7 @@ Void TEncSbac::codeOBMCFlag( TComDataCU* pcCU, UInt uiAbsPartIdx )
   m_pcBinIf->encodeBin( uiSymbol, m_cCUOBMCFlagSCModel.get( 0, 0, 0 ) );
 
 #if PIP
-  if (encodeTime && verbose)
+  if (m_pcPIPCoderState->encodeTime && verbose)
 	  cout << ",OBMC:" << (Int)uiSymbol;
 #endif
   
@@ -1528,7 +1831,7 @@ Void TEncSbac::codeICFlag( TComDataCU* pcCU, UInt uiAbsPartIdx )
   m_pcBinIf->encodeBin( uiSymbol, m_cCUICFlagSCModel.get( 0, 0, 0 ) );
 
 #if PIP
-  if (encodeTime && verbose)
+  if (m_pcPIPCoderState->encodeTime && verbose)
 	  cout << ",IC:" << (Int)uiSymbol;
 #endif
 
@@ -1603,7 +1906,7 @@ Void TEncSbac::codeMPIIdx(TComDataCU* pcCU, UInt uiAbsPartIdx)
  Void TEncSbac::codePDPCIdx(TComDataCU* pcCU, UInt uiAbsPartIdx)
  {
 #if PIP
-	 if (encodeTime && verbose)
+	 if (m_pcPIPCoderState->encodeTime && verbose)
 		 cout << ",PDPC:";
 #endif
   if (!pcCU->getSlice()->getSPS()->getUsePDPC()) return;
@@ -1622,7 +1925,7 @@ Void TEncSbac::codeMPIIdx(TComDataCU* pcCU, UInt uiAbsPartIdx)
       const UInt uiSymbol0 = (idxPDPC >> 1);
       const UInt uiSymbol1 = (idxPDPC % 2);
 #if PIP
-	  if (encodeTime && verbose)
+	  if (m_pcPIPCoderState->encodeTime && verbose)
 		  cout << (Int)uiSymbol0 << (Int)uiSymbol1;
 #endif
       m_pcBinIf->encodeBin(uiSymbol0, m_cPDPCIdxSCModel.get(0, 0, 0));
@@ -1634,7 +1937,7 @@ Void TEncSbac::codeMPIIdx(TComDataCU* pcCU, UInt uiAbsPartIdx)
       const UInt uiSymbol = idxPDPC;
       m_pcBinIf->encodeBin(uiSymbol, m_cPDPCIdxSCModel.get(0, 0, 0));
 #if PIP
-	  if (encodeTime && verbose)
+	  if (m_pcPIPCoderState->encodeTime && verbose)
 		  cout << (Int)uiSymbol;
 #endif
     }
@@ -1646,7 +1949,7 @@ Void TEncSbac::codeMPIIdx(TComDataCU* pcCU, UInt uiAbsPartIdx)
 Void TEncSbac::codeROTIdx ( TComDataCU* pcCU, UInt uiAbsPartIdx,UInt uiDepth  )
 {
 #if PIP
-	if (encodeTime && verbose)
+	if (m_pcPIPCoderState->encodeTime && verbose)
 		cout << ",ROT:";
 #endif
 #if COM16_C1044_NSST
@@ -1692,7 +1995,7 @@ Void TEncSbac::codeROTIdx ( TComDataCU* pcCU, UInt uiAbsPartIdx,UInt uiDepth  )
 #if JVET_C0042_UNIFIED_BINARIZATION
             m_pcBinIf->encodeBin(  idxROT ? 1 : 0 , m_cROTidxSCModel.get(0,0, 1) );
 #if PIP
-			if (encodeTime && verbose)
+			if (m_pcPIPCoderState->encodeTime && verbose)
 				cout << (Int)(idxROT ? 1 : 0);
 #endif
             if( idxROT )
@@ -1700,7 +2003,7 @@ Void TEncSbac::codeROTIdx ( TComDataCU* pcCU, UInt uiAbsPartIdx,UInt uiDepth  )
                    if(idxROT ==1) m_pcBinIf->encodeBin( 0 , m_cROTidxSCModel.get(0,0, 3) );
                    else m_pcBinIf->encodeBin( 1 , m_cROTidxSCModel.get(0,0, 3) );
 #if PIP
-				   if (encodeTime && verbose)
+				   if (m_pcPIPCoderState->encodeTime && verbose)
 					   cout << 1;
 #endif
             } 
@@ -1726,14 +2029,14 @@ Void TEncSbac::codeROTIdx ( TComDataCU* pcCU, UInt uiAbsPartIdx,UInt uiDepth  )
 #if JVET_C0042_UNIFIED_BINARIZATION
             m_pcBinIf->encodeBin(  idxROT ? 1 : 0 , m_cROTidxSCModel.get(0,0, 0) );
 #if PIP
-			if (encodeTime && verbose)
+			if (m_pcPIPCoderState->encodeTime && verbose)
 				cout << (Int)(idxROT ? 1 : 0);
 #endif
             if( idxROT )
             {
                      m_pcBinIf->encodeBin( (idxROT-1) ? 1 : 0 , m_cROTidxSCModel.get(0,0, 2) );
 #if PIP
-					 if (encodeTime && verbose)
+					 if (m_pcPIPCoderState->encodeTime && verbose)
 						 cout << (Int)((idxROT - 1) ? 1 : 0);
 #endif
 
@@ -1741,7 +2044,7 @@ Void TEncSbac::codeROTIdx ( TComDataCU* pcCU, UInt uiAbsPartIdx,UInt uiDepth  )
                     {
                         m_pcBinIf->encodeBin( (idxROT-2) ? 1 : 0, m_cROTidxSCModel.get(0,0, 4) );
 #if PIP
-						if (encodeTime && verbose)
+						if (m_pcPIPCoderState->encodeTime && verbose)
 							cout << (Int)((idxROT - 2) ? 1 : 0);
 #endif
                     }
@@ -1760,7 +2063,7 @@ Void TEncSbac::codeROTIdx ( TComDataCU* pcCU, UInt uiAbsPartIdx,UInt uiDepth  )
 Void TEncSbac::codeROTIdxChroma ( TComDataCU* pcCU, UInt uiAbsPartIdx,UInt uiDepth  )
 {
 #if PIP
-	if (encodeTime && verbose)
+	if (m_pcPIPCoderState->encodeTime && verbose)
 		cout << "ROTCH:";
 #endif
 #if COM16_C1044_NSST
@@ -1819,7 +2122,7 @@ Void TEncSbac::codeROTIdxChroma ( TComDataCU* pcCU, UInt uiAbsPartIdx,UInt uiDep
 #if JVET_C0042_UNIFIED_BINARIZATION
       m_pcBinIf->encodeBin(  idxROT ? 1 : 0 , m_cROTidxSCModel.get(0,0, 1) );
 #if PIP
-	  if (encodeTime && verbose)
+	  if (m_pcPIPCoderState->encodeTime && verbose)
 		  cout << (Int)(idxROT ? 1 : 0);
 #endif
             if( idxROT )
@@ -1827,7 +2130,7 @@ Void TEncSbac::codeROTIdxChroma ( TComDataCU* pcCU, UInt uiAbsPartIdx,UInt uiDep
                    if(idxROT ==1) m_pcBinIf->encodeBin( 0 , m_cROTidxSCModel.get(0,0, 3) );
                    else m_pcBinIf->encodeBin( 1 , m_cROTidxSCModel.get(0,0, 3) );
 #if PIP
-				   if (encodeTime && verbose)
+				   if (m_pcPIPCoderState->encodeTime && verbose)
 					   cout << (idxROT == 1 ? 0 : 1);
 #endif
             } 
@@ -1847,21 +2150,21 @@ Void TEncSbac::codeROTIdxChroma ( TComDataCU* pcCU, UInt uiAbsPartIdx,UInt uiDep
 #if JVET_C0042_UNIFIED_BINARIZATION
       m_pcBinIf->encodeBin(  idxROT ? 1 : 0 , m_cROTidxSCModel.get(0,0, 0) );
 #if PIP
-	  if (encodeTime && verbose)
+	  if (m_pcPIPCoderState->encodeTime && verbose)
 		  cout << (Int)(idxROT ? 1 : 0);
 #endif
             if( idxROT )
             {
                      m_pcBinIf->encodeBin( (idxROT-1) ? 1 : 0 , m_cROTidxSCModel.get(0,0, 2) );
 #if PIP
-					 if (encodeTime && verbose)
+					 if (m_pcPIPCoderState->encodeTime && verbose)
 						 cout << (Int)((idxROT - 1) ? 1 : 0);
 #endif
                     if(idxROT >1 )
                     {
                         m_pcBinIf->encodeBin( (idxROT-2) ? 1 : 0, m_cROTidxSCModel.get(0,0, 4) );
 #if PIP
-						if (encodeTime && verbose)
+						if (m_pcPIPCoderState->encodeTime && verbose)
 							cout << (Int)((idxROT - 2) ? 1 : 0);
 #endif
                     }
@@ -2042,7 +2345,7 @@ Void TEncSbac::codeIntraDirLumaAng( TComDataCU* pcCU, UInt absPartIdx, Bool isMu
                                    )
 {
 #if PIP
-	if (encodeTime && verbose)
+	if (m_pcPIPCoderState->encodeTime && verbose)
 		cout << ",DirLuma:";
 #endif
   UInt dir[4],j;
@@ -2082,7 +2385,7 @@ Void TEncSbac::codeIntraDirLumaAng( TComDataCU* pcCU, UInt absPartIdx, Bool isMu
     dir[j] = pcCU->getIntraDir( CHANNEL_TYPE_LUMA, absPartIdx+partOffset*j );
 
 #if PIP
-	if (encodeTime && false)
+	if (m_pcPIPCoderState->encodeTime && false)
 	{
 		FILE* fout = fopen("log.txt", "a");
 		fprintf(fout, "%2d\n", dir[j]);
@@ -2114,7 +2417,7 @@ Void TEncSbac::codeIntraDirLumaAng( TComDataCU* pcCU, UInt absPartIdx, Bool isMu
     }
     m_pcBinIf->encodeBin((predIdx[j] != -1)? 1 : 0, m_cCUIntraPredSCModel.get( 0, 0, 0 ) );
 #if PIP
-	if (encodeTime && verbose)
+	if (m_pcPIPCoderState->encodeTime && verbose)
 		cout << (Int)((predIdx[j] != -1) ? 1 : 0);
 #endif
   }
@@ -2125,7 +2428,7 @@ Void TEncSbac::codeIntraDirLumaAng( TComDataCU* pcCU, UInt absPartIdx, Bool isMu
 #if JVET_C0055_INTRA_MPM
       m_pcBinIf->encodeBin( predIdx[j] ? 1 : 0, m_cCUIntraPredSCModel.get( 0, 0, mpmContext[preds[j][0]] ) );
 #if PIP
-	  if (encodeTime && verbose)
+	  if (m_pcPIPCoderState->encodeTime && verbose)
 			  cout << (Int)(predIdx[j] ? 1 : 0);
 #endif
 #elif VCEG_AZ07_INTRA_65ANG_MODES
@@ -2139,14 +2442,14 @@ Void TEncSbac::codeIntraDirLumaAng( TComDataCU* pcCU, UInt absPartIdx, Bool isMu
 #if JVET_C0055_INTRA_MPM
         m_pcBinIf->encodeBin( (predIdx[j]-1) ? 1 : 0, m_cCUIntraPredSCModel.get( 0, 0, mpmContext[preds[j][1]] ) );
 #if PIP
-		if (encodeTime && verbose)
+		if (m_pcPIPCoderState->encodeTime && verbose)
 			cout << (Int)((predIdx[j] - 1) ? 1 : 0);
 #endif
         if ( (predIdx[j]-1) )
         {
           m_pcBinIf->encodeBin( (predIdx[j]-2) ? 1 : 0, m_cCUIntraPredSCModel.get( 0, 0, mpmContext[preds[j][2]] ) );
 #if PIP
-		  if (encodeTime && verbose)
+		  if (m_pcPIPCoderState->encodeTime && verbose)
 			  cout << (Int)((predIdx[j] - 2) ? 1 : 0);
 #endif
 #else
@@ -2160,14 +2463,14 @@ Void TEncSbac::codeIntraDirLumaAng( TComDataCU* pcCU, UInt absPartIdx, Bool isMu
           {
             m_pcBinIf->encodeBinEP( (predIdx[j]-3) ? 1 : 0 );
 #if PIP
-			if (encodeTime && verbose)
+			if (m_pcPIPCoderState->encodeTime && verbose)
 				cout << (Int)((predIdx[j] - 3) ? 1 : 0);
 #endif
             if (predIdx[j]-3)
             {
               m_pcBinIf->encodeBinEP( (predIdx[j]-4) ? 1 : 0 );
 #if PIP
-			  if (encodeTime && verbose)
+			  if (m_pcPIPCoderState->encodeTime && verbose)
 				  cout << (Int)((predIdx[j] - 4) ? 1 : 0);
 #endif
             }
@@ -2212,7 +2515,7 @@ Void TEncSbac::codeIntraDirLumaAng( TComDataCU* pcCU, UInt absPartIdx, Bool isMu
 #if JVET_C0024_BT_FIX_TICKET22
       m_pcBinIf->encodeBin(( (dir[j]%4) ==0 ) ? 1 : 0, m_cCUIntraPredSCModel.get( 0, 0, 9 ) ); // flag to indicate if it is selected mode or non-selected mode
 #if PIP
-	  if (encodeTime && verbose)
+	  if (m_pcPIPCoderState->encodeTime && verbose)
 		  cout << (Int)(((dir[j] % 4) == 0) ? 1 : 0);
 #endif
 #else
@@ -2225,7 +2528,7 @@ Void TEncSbac::codeIntraDirLumaAng( TComDataCU* pcCU, UInt absPartIdx, Bool isMu
       {
         m_pcBinIf->encodeBinsEP( dir[j]>>2, 4 );  // selected mode is 4-bit FLC coded
 #if PIP
-		if (encodeTime && verbose)
+		if (m_pcPIPCoderState->encodeTime && verbose)
 			cout << (Int)((dir[j]>>2));
 #endif
       }
@@ -2235,7 +2538,7 @@ Void TEncSbac::codeIntraDirLumaAng( TComDataCU* pcCU, UInt absPartIdx, Bool isMu
         dir[j] --;     
         xWriteTruncBinCode(dir[j] , 45);  // Non-selected mode is truncated binary coded
 #if PIP
-		if (encodeTime && verbose)
+		if (m_pcPIPCoderState->encodeTime && verbose)
 			cout << ",Trunc:" << (Int)dir[j];
 #endif
       }
@@ -2279,7 +2582,7 @@ Void TEncSbac::codeLMModes(TComDataCU* pcCU, UInt uiAbsPartIdx, Int iMode)
 Void TEncSbac::codeIntraDirChroma( TComDataCU* pcCU, UInt uiAbsPartIdx )
 {
 #if PIP
-	if (encodeTime && verbose)
+	if (m_pcPIPCoderState->encodeTime && verbose)
 		cout << ",DirChroma:";
 #endif
   UInt uiIntraDirChroma = pcCU->getIntraDir( CHANNEL_TYPE_CHROMA, uiAbsPartIdx );
@@ -2315,7 +2618,7 @@ Void TEncSbac::codeIntraDirChroma( TComDataCU* pcCU, UInt uiAbsPartIdx )
   {
     m_pcBinIf->encodeBin( 0, m_cCUChromaPredSCModel.get( 0, 0, 0 ) );   
 #if PIP
-	if (encodeTime && verbose)
+	if (m_pcPIPCoderState->encodeTime && verbose)
 		cout << 0;
 #endif
 #if JVET_E0077_ENHANCED_LM
@@ -2326,7 +2629,7 @@ Void TEncSbac::codeIntraDirChroma( TComDataCU* pcCU, UInt uiAbsPartIdx )
             UInt uiFlag = uiIntraDirChroma == MMLM_CHROMA_IDX;
             m_pcBinIf->encodeBin(uiFlag, m_cCUChromaPredSCModel.get(0, 0, iCtx++));
 #if PIP
-			if (encodeTime && verbose)
+			if (m_pcPIPCoderState->encodeTime && verbose)
 				cout << (Int)uiFlag;
 #endif
         }
@@ -2340,7 +2643,7 @@ Void TEncSbac::codeIntraDirChroma( TComDataCU* pcCU, UInt uiAbsPartIdx )
             {
                 m_pcBinIf->encodeBin(uiIntraDirChroma == LM_CHROMA_IDX, m_cCUChromaPredSCModel.get(0, 0, iCtx++));
 #if PIP
-				if (encodeTime && verbose)
+				if (m_pcPIPCoderState->encodeTime && verbose)
 					cout << (Int)(uiIntraDirChroma == LM_CHROMA_IDX);
 #endif
 
@@ -2350,7 +2653,7 @@ Void TEncSbac::codeIntraDirChroma( TComDataCU* pcCU, UInt uiAbsPartIdx )
                     m_pcBinIf->encodeBin((iLable >> 1) & 1, m_cCUChromaPredSCModel.get(0, 0, iCtx++));
                     m_pcBinIf->encodeBin(iLable & 1, m_cCUChromaPredSCModel.get(0, 0, iCtx++));
 #if PIP
-					if (encodeTime && verbose)
+					if (m_pcPIPCoderState->encodeTime && verbose)
 						cout << (Int)((iLable >> 1) & 1) << (iLable & 1);
 #endif
                 }
@@ -2380,7 +2683,7 @@ Void TEncSbac::codeIntraDirChroma( TComDataCU* pcCU, UInt uiAbsPartIdx )
     {
       m_pcBinIf->encodeBin( 1, m_cCUChromaPredSCModel.get( 0, 0, 0 ) );
 #if PIP
-	  if (encodeTime && verbose)
+	  if (m_pcPIPCoderState->encodeTime && verbose)
 		  cout << 1;
 #endif
     }
@@ -2389,7 +2692,7 @@ Void TEncSbac::codeIntraDirChroma( TComDataCU* pcCU, UInt uiAbsPartIdx )
     UInt ictxIdx = 1;
     m_pcBinIf->encodeBin(iDMIdx ? 1 : 0, m_cCUChromaPredSCModel.get(0, 0, ictxIdx));
 #if PIP
-	if (encodeTime && verbose)
+	if (m_pcPIPCoderState->encodeTime && verbose)
 		cout << (Int)(iDMIdx ? 1 : 0);
 #endif
     UInt uiMaxSymbol = NUM_DM_MODES;
@@ -2401,7 +2704,7 @@ Void TEncSbac::codeIntraDirChroma( TComDataCU* pcCU, UInt uiAbsPartIdx )
         ictxIdx++;
         m_pcBinIf->encodeBin(1, m_cCUChromaPredSCModel.get(0, 0, ictxIdx));
 #if PIP
-		if (encodeTime && verbose)
+		if (m_pcPIPCoderState->encodeTime && verbose)
 			cout << 1;
 #endif
       }
@@ -2410,7 +2713,7 @@ Void TEncSbac::codeIntraDirChroma( TComDataCU* pcCU, UInt uiAbsPartIdx )
         ictxIdx++;
         m_pcBinIf->encodeBin(0, m_cCUChromaPredSCModel.get(0, 0, ictxIdx));
 #if PIP
-		if (encodeTime && verbose)
+		if (m_pcPIPCoderState->encodeTime && verbose)
 			cout << 0;
 #endif
       }
@@ -2804,7 +3107,7 @@ Void TEncSbac::codeQtCbf( TComTU &rTu, const ComponentID compID, const Bool lowe
 	else
 		m_pcBinIf->encodeBin(uiCbf, m_cCUQtCbfSCModel.get(0, contextSet, uiCtx));
 
-	if (encodeTime && verbose)
+	if (m_pcPIPCoderState->encodeTime && verbose)
 		cout << ",cbf:" << (Int)uiCbf;
 #else
     m_pcBinIf->encodeBin( uiCbf , m_cCUQtCbfSCModel.get( 0, contextSet, uiCtx ) );
@@ -2907,7 +3210,7 @@ Void TEncSbac::codeTransformSkipFlags (TComTU &rTu, ComponentID component )
 Void TEncSbac::codeIPCMInfo( TComDataCU* pcCU, UInt uiAbsPartIdx )
 {
 #if PIP
-	if (encodeTime && verbose)
+	if (m_pcPIPCoderState->encodeTime && verbose)
 		cout << ",IPCM:";
 #endif
   UInt uiIPCM = (pcCU->getIPCMFlag(uiAbsPartIdx) == true)? 1 : 0;
@@ -2916,7 +3219,7 @@ Void TEncSbac::codeIPCMInfo( TComDataCU* pcCU, UInt uiAbsPartIdx )
 
   m_pcBinIf->encodeBinTrm (uiIPCM);
 #if PIP
-  if (encodeTime && verbose)
+  if (m_pcPIPCoderState->encodeTime && verbose)
 	  cout << (Int)uiIPCM;
 #endif
 
@@ -2941,7 +3244,7 @@ Void TEncSbac::codeIPCMInfo( TComDataCU* pcCU, UInt uiAbsPartIdx )
           UInt sample = pPCMSample[x];
           m_pcBinIf->xWritePCMCode(sample, sampleBits);
 #if PIP
-		  if (encodeTime && verbose)
+		  if (m_pcPIPCoderState->encodeTime && verbose)
 			  cout << (Int)sample;
 #endif
         }
@@ -2959,7 +3262,7 @@ Void TEncSbac::codeQtRootCbf( TComDataCU* pcCU, UInt uiAbsPartIdx )
   UInt uiCtx = 0;
   m_pcBinIf->encodeBin( uiCbf , m_cCUQtRootCbfSCModel.get( 0, 0, uiCtx ) );
 #if PIP
-  if (encodeTime && verbose)
+  if (m_pcPIPCoderState->encodeTime && verbose)
 	  cout << ",QtRoot:" << (Int)uiCbf;
 #endif
   DTRACE_CABAC_VL( g_nSymbolCounter++ )
@@ -3010,7 +3313,7 @@ Void TEncSbac::codeLastSignificantXY( UInt uiPosX, UInt uiPosY, Int width, Int h
 #if PIP
 
 #if SP_COEFFNxN_2
-	if (SpatialCodeCoeffNxN_2)
+	if (m_pcPIPCoderState->spatialCodeCoeffNxN2)
 	{
 		uiPosX = 3 - uiPosX;
 		uiPosY = 3 - uiPosY;
@@ -3018,10 +3321,10 @@ Void TEncSbac::codeLastSignificantXY( UInt uiPosX, UInt uiPosY, Int width, Int h
 #endif
 
 	UInt bits1 = m_pcBinIf->getNumWrittenBits();
-	if (encodeTime && false)
+	if (m_pcPIPCoderState->encodeTime && false)
 		fprintf(stdout, "LastX:%d/%d,LastY:%d/%d", uiPosX, width, uiPosY, height);
 
-	if (encodeTime && verbose)
+	if (m_pcPIPCoderState->encodeTime && verbose)
 		cout << ",LastXY,X:";
 #endif
   // swap
@@ -3106,7 +3409,7 @@ Void TEncSbac::codeLastSignificantXY( UInt uiPosX, UInt uiPosY, Int width, Int h
   {
     m_pcBinIf->encodeBin( 1, *( pCtxX + blkSizeOffsetX + (uiCtxLast >>shiftX) ) );
 #if PIP
-	if (encodeTime && verbose)
+	if (m_pcPIPCoderState->encodeTime && verbose)
 		cout << 1;
 #endif
   }
@@ -3114,21 +3417,21 @@ Void TEncSbac::codeLastSignificantXY( UInt uiPosX, UInt uiPosY, Int width, Int h
   {
     m_pcBinIf->encodeBin( 0, *( pCtxX + blkSizeOffsetX + (uiCtxLast >>shiftX) ) );
 #if PIP
-	if (encodeTime && verbose)
+	if (m_pcPIPCoderState->encodeTime && verbose)
 		cout << 0;
 #endif
   }
 
   // posY
 #if PIP
-  if (encodeTime && verbose)
+  if (m_pcPIPCoderState->encodeTime && verbose)
 	  cout << "Y:";
 #endif
   for( uiCtxLast = 0; uiCtxLast < uiGroupIdxY; uiCtxLast++ )
   {
     m_pcBinIf->encodeBin( 1, *( pCtxY + blkSizeOffsetY + (uiCtxLast >>shiftY) ) );
 #if PIP
-	if (encodeTime && verbose)
+	if (m_pcPIPCoderState->encodeTime && verbose)
 		cout << 1;
 #endif
   }
@@ -3136,7 +3439,7 @@ Void TEncSbac::codeLastSignificantXY( UInt uiPosX, UInt uiPosY, Int width, Int h
   {
     m_pcBinIf->encodeBin( 0, *( pCtxY + blkSizeOffsetY + (uiCtxLast >>shiftY) ) );
 #if PIP
-	if (encodeTime && verbose)
+	if (m_pcPIPCoderState->encodeTime && verbose)
 		cout << 0;
 #endif
   }
@@ -3150,7 +3453,7 @@ Void TEncSbac::codeLastSignificantXY( UInt uiPosX, UInt uiPosY, Int width, Int h
     {
       m_pcBinIf->encodeBinEP( ( uiPosX >> i ) & 1 );
 #if PIP
-	  if (encodeTime && verbose)
+	  if (m_pcPIPCoderState->encodeTime && verbose)
 		  cout << (Int)((uiPosX >> i) & 1);
 #endif
     }
@@ -3163,16 +3466,16 @@ Void TEncSbac::codeLastSignificantXY( UInt uiPosX, UInt uiPosY, Int width, Int h
     {
       m_pcBinIf->encodeBinEP( ( uiPosY >> i ) & 1 );
 #if PIP
-	  if (encodeTime && verbose)
+	  if (m_pcPIPCoderState->encodeTime && verbose)
 		  cout << (Int)((uiPosY >> i) & 1);
 #endif
     }
   }
 #if PIP
   UInt bits2 = m_pcBinIf->getNumWrittenBits();
-  if (encodeTime && false)
+  if (m_pcPIPCoderState->encodeTime && false)
 	  fprintf(stdout, "\t\t(Bits:%d)\n", bits2 - bits1); 
-  if (verbose && encodeTime)
+  if (verbose && m_pcPIPCoderState->encodeTime)
 	  cout << ",";
 #endif
 }
@@ -3198,9 +3501,13 @@ Void TEncSbac::codeCoeffNxN( TComTU &rTu, TCoeff* pcCoef, const ComponentID comp
 
 #if PIP
   Bool isPIP = pcCU->getPIPflag(uiAbsPartIdx) && isLuma(compID);
-  
+  // bit log of the 4x4 luma blocks
+  UInt Bits1 = 0, Bits2 = 0;
+  UInt sigCnt = 0;
+  UInt EMTlog = 0;
+  Bool maxExceeded = false;
 
-  if (encodeTime)
+  if (m_pcPIPCoderState->encodeTime)
   {
 	  if (uiWidth == 4 && uiHeight == 4 && isLuma(compID))
 	  {
@@ -3236,10 +3543,10 @@ Void TEncSbac::codeCoeffNxN( TComTU &rTu, TCoeff* pcCoef, const ComponentID comp
 
 #if SP_COEFFNxN_2
   TCoeff* TMP_pcCoef = (TCoeff*)xMalloc(TCoeff, uiWidth*uiHeight*sizeof(TCoeff));
-  if (SpatialCodeCoeffNxN_2)
+  if (m_pcPIPCoderState->spatialCodeCoeffNxN2)
   {
 	  memcpy(TMP_pcCoef, pcCoef, uiWidth*uiHeight*sizeof(TCoeff));
-	  memcpy(pcCoef, TMPSpR1, uiWidth*uiHeight*sizeof(TCoeff));
+	  memcpy(pcCoef, m_pcPIPCoderState->tmpSpR1, uiWidth*uiHeight*sizeof(TCoeff));
   }
 #endif
 
@@ -3426,7 +3733,7 @@ Void TEncSbac::codeCoeffNxN( TComTU &rTu, TCoeff* pcCoef, const ComponentID comp
   memset(reordered_spR1, 0, uiWidth*uiHeight*sizeof(Int));
   if (isPIP && SpatialCodeCoeffNxN)
   {	  
-	  if (encodeTime) // TEMP
+	  if (m_pcPIPCoderState->encodeTime) // TEMP
 	  {
 		  for (int c = 0; c < uiWidth*uiHeight; c++)
 			  fprintf(stdout, "%4d\t", spQR1_encode[c]);
@@ -3741,7 +4048,7 @@ Void TEncSbac::codeCoeffNxN( TComTU &rTu, TCoeff* pcCoef, const ComponentID comp
 #endif
 		  m_pcBinIf->encodeBin(uiSigCoeffGroup, baseCoeffGroupCtx[uiCtxSig]);
 #if PIP
-		  if (encodeTime && verbose)
+		  if (m_pcPIPCoderState->encodeTime && verbose)
 			  cout << "A:" << (Int)uiSigCoeffGroup;
 #if SP_COEFFNxX
 	  }
@@ -3986,7 +4293,7 @@ Void TEncSbac::codeCoeffNxN( TComTU &rTu, TCoeff* pcCoef, const ComponentID comp
       {
         m_pcBinIf->encodeBinsEP( coeffSigns, numNonZero );
 #if PIP
-		if (encodeTime && verbose)
+		if (m_pcPIPCoderState->encodeTime && verbose)
 			cout << "G:"<<(Int)(coeffSigns);
 #endif
       }
@@ -4000,7 +4307,7 @@ Void TEncSbac::codeCoeffNxN( TComTU &rTu, TCoeff* pcCoef, const ComponentID comp
 #if COM16_C806_EMT
 
 #if PIP
-  if (encodeTime && pcCU->getWidth(uiAbsPartIdx) == 4 && pcCU->getHeight(uiAbsPartIdx) == 4 && isLuma(compID))
+  if (m_pcPIPCoderState->encodeTime && pcCU->getWidth(uiAbsPartIdx) == 4 && pcCU->getHeight(uiAbsPartIdx) == 4 && isLuma(compID))
   {
 	  if (!pcCU->getEmtCuFlag(uiAbsPartIdx))
 		  EMTlog = 0;
@@ -4014,14 +4321,14 @@ Void TEncSbac::codeCoeffNxN( TComTU &rTu, TCoeff* pcCoef, const ComponentID comp
 #if PIP
   UInt bits2 = getNumberOfWrittenBits();
   Bits2 = getNumberOfWrittenBits();
-  if (encodeTime && uiWidth == 4 && uiHeight == 4 && isLuma(compID))
+  if (m_pcPIPCoderState->encodeTime && uiWidth == 4 && uiHeight == 4 && isLuma(compID))
   {
 	  if (!maxExceeded || true)
 	  {
 		  FILE* fout = fopen("log.txt", "a");
 		  fprintf(fout, "%4d\t%d\t%2d\n", Bits2 - Bits1 - sigCnt, EMTlog, pcCU->getIntraDir(toChannelType(compID), uiAbsPartIdx));
 		  sigCnt = 0;
-		  totalPIPbits += Bits2 - Bits1;
+		  PIPStatsPolicy::add(m_pcPIPStats->totalPIPbits, (Double)(Bits2 - Bits1));
 		  fclose(fout);
 	  }
 	  maxExceeded = false;
@@ -4054,7 +4361,7 @@ Void TEncSbac::codeCoeffNxN( TComTU &rTu, TCoeff* pcCoef, const ComponentID comp
   }
 #endif
 #if SP_COEFFNxN_2
-  if (SpatialCodeCoeffNxN_2)
+  if (m_pcPIPCoderState->spatialCodeCoeffNxN2)
   {
 	  memcpy(pcCoef, TMP_pcCoef, uiWidth*uiHeight*sizeof(TCoeff));
   }
@@ -4723,7 +5030,7 @@ Void  TEncSbac::loadContextsFromPrev (TComStats* apcStats, SliceType eSliceType,
 Void TEncSbac::codeExplicitRdpcmMode( TComTU &rTu, const ComponentID compID )
 {
 #if PIP
-	if (encodeTime && verbose)
+	if (m_pcPIPCoderState->encodeTime && verbose)
 		cout << ",RDPCM:";
 #endif
   TComDataCU *cu = rTu.getCU();
@@ -4745,7 +5052,7 @@ Void TEncSbac::codeExplicitRdpcmMode( TComTU &rTu, const ComponentID compID )
   {
     m_pcBinIf->encodeBin (0, m_explicitRdpcmFlagSCModel.get (0, toChannelType(compID), 0));
 #if PIP
-	if (encodeTime && verbose)
+	if (m_pcPIPCoderState->encodeTime && verbose)
 		cout << 0;
 #endif
   }
@@ -4753,14 +5060,14 @@ Void TEncSbac::codeExplicitRdpcmMode( TComTU &rTu, const ComponentID compID )
   {
     m_pcBinIf->encodeBin (1, m_explicitRdpcmFlagSCModel.get (0, toChannelType(compID), 0));
 #if PIP
-	if (encodeTime && verbose)
+	if (m_pcPIPCoderState->encodeTime && verbose)
 		cout << 1;
 #endif
     if(explicitRdpcmMode == RDPCM_HOR)
     {
       m_pcBinIf->encodeBin ( 0, m_explicitRdpcmDirSCModel.get(0, toChannelType(compID), 0));
 #if PIP
-	  if (encodeTime && verbose)
+	  if (m_pcPIPCoderState->encodeTime && verbose)
 		  cout << 0;
 #endif
     }
@@ -4768,7 +5075,7 @@ Void TEncSbac::codeExplicitRdpcmMode( TComTU &rTu, const ComponentID compID )
     {
       m_pcBinIf->encodeBin ( 1, m_explicitRdpcmDirSCModel.get(0, toChannelType(compID), 0));
 #if PIP
-	  if (encodeTime && verbose)
+	  if (m_pcPIPCoderState->encodeTime && verbose)
 		  cout << 1;
 #endif
     }
@@ -5007,7 +5314,7 @@ Void TEncSbac::codeEmtCuFlag( TComDataCU* pcCU, UInt uiAbsPartIdx, UInt uiDepth,
     UChar ucCuFlag = pcCU->getEmtCuFlag( uiAbsPartIdx );
     m_pcBinIf->encodeBin( ucCuFlag, m_cEmtCuFlagSCModel.get(0, 0, uiDepth));
 #if PIP
-	if (encodeTime && verbose)
+	if (m_pcPIPCoderState->encodeTime && verbose)
 		cout << (Int)ucCuFlag;
 #endif
   }
@@ -5021,7 +5328,7 @@ Void TEncSbac::codeEmtCuFlag( TComDataCU* pcCU, UInt uiAbsPartIdx, UInt uiDepth,
     UChar ucCuFlag = pcCU->getEmtCuFlag( uiAbsPartIdx );
     m_pcBinIf->encodeBin( ucCuFlag, m_cEmtCuFlagSCModel.get(0, 0, uiDepth));
 #if PIP
-	if (encodeTime && verbose)
+	if (m_pcPIPCoderState->encodeTime && verbose)
 		cout << (Int)ucCuFlag;
 #endif
   }
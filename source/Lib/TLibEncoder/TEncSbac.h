@@ -62,6 +62,22 @@ class TEncTop;
 // Class definition
 // ====================================================================================================================
 
+#if SRDOQ_INCREMENTAL && CBF2x2
+/// bits (1/32768 units) of the PIP syntax elements for the context states at the start of a block
+struct PIPRateTable
+{
+  Int   width;
+  Int   height;
+  Int   qStep;
+  Bool  isCoded;                                    ///< PIP flag and R1 are coded for this CU
+  Int   flagBits;
+  Int   cbfBits[CUMAX*CUMAX / 4][2];
+  Int   levelBits[2][COEFF_LIMIT + 1];              ///< [first bin derived from CBF2x2][amplitude]
+  Int   signBits[2];
+  Int   predictorBits[MULTIPLEPRED > 0 ? MULTIPLEPRED : 1];
+};
+#endif
+
 /// SBAC encoder class
 class TEncSbac : public TEncEntropyIf
 {
@@ -71,6 +87,10 @@ public:
 
   Void  init                   ( TEncBinIf* p )  { m_pcBinIf = p; }
   Void  uninit                 ()                { m_pcBinIf = 0; }
+#if PIP
+  Void  setPIPContext          ( TComPIPContext* p, Int threadId = 0 ) { m_pcPIPContext = p; m_pcPIPStats = p->getThreadStats( threadId ); }
+  Void  setPIPCoderState       ( TComPIPCoderState* p )                 { m_pcPIPCoderState = p; }
+#endif
 
   //  Virtual list
   Void  resetEntropy           (const TComSlice *pSlice);
@@ -83,6 +103,9 @@ public:
   Void  loadContexts           ( const TEncSbac* pSrc  );
   Void  resetBits              ()                { m_pcBinIf->resetBits(); m_pcBitIf->resetBits(); }
   UInt  getNumberOfWrittenBits ()                { return m_pcBinIf->getNumWrittenBits(); }
+#if FAST_BIT_EST
+  UInt64 getNumberOfWrittenFracBits ()          { return (UInt64(m_pcBitIf->getNumberOfWrittenBits()) << 15) + m_pcBinIf->getTEncBinCABAC()->getFracBits(); }
+#endif
   //--SBAC RD
 
   Void  codeVPS                ( const TComVPS* pcVPS );
@@ -196,6 +219,9 @@ public:
 	  , UInt *cbf2x2
 #endif
 	  );
+#if PIP_R1_HT_BINARIZATION
+  Void codeR1_highThroughput(int *spQR1, int w, int h, Bool *cbfException, UInt *cbf2x2);
+#endif
 
 #if R1_DIRECTCODING
   Void codeR1_DirectCoding(int *spQR1, int w, int h
@@ -217,6 +243,11 @@ public:
 #if CBF2x2
   Void TEncSbac::codeR1CBF(int* spQR1, UInt *cbf2x2, Bool *cbfException, int w, int h);
 #endif
+#if SRDOQ_INCREMENTAL && CBF2x2
+  UInt64 estimatePIPR1FracBits(TComDataCU* pcCU, const Int* spQR1);
+  Void   initPIPRateTable     (TComDataCU* pcCU, PIPRateTable& rTable);
+  static UInt64 estimatePIPFracBits(const PIPRateTable& rTable, const Int* spQR1, Int predictor);
+#endif
 #if SPR1_ClUSTER
   Void codeAmplCluster	 (Int ampl, Bool firstCluster);
 #endif
@@ -431,6 +462,9 @@ private:
 #endif
 
 #if PIP // PIP context model separation
+  TComPIPContext*      m_pcPIPContext;
+  TComPIPStats*        m_pcPIPStats;
+  TComPIPCoderState*   m_pcPIPCoderState;
   ContextModel3DBuffer m_cCUQtCbfSCModelPIP;
   ContextModel3DBuffer m_cCUSigCoeffGroupSCModelPIP;
   ContextModel3DBuffer m_cCUSigSCModelPIP;
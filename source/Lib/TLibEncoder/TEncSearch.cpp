@@ -49,7 +49,7 @@
 //! \{
 
 #if VCEG_AZ08_KLT_COMMON
-extern short **g_ppsEigenVector[USE_MORE_BLOCKSIZE_DEPTH_MAX];
+extern thread_local short **g_ppsEigenVector[USE_MORE_BLOCKSIZE_DEPTH_MAX];
 #endif
 
 #if JVET_D0033_ADAPTIVE_CLIPPING_ENC_METHOD
@@ -71,8 +71,8 @@ Int average(const std::vector<Pel> &r,Int i0,Int j0,Int uiHeight,Int uiWidth) {
 
 void smoothResidual(const Bound prm,const std::vector<Pel> &org,std::vector<Pel> &res,UInt uiHeight,UInt uiWidth) {
     // find boundaries of the res
-    static std::vector<char> bmM;
-    static std::vector<Pel> r;
+    static thread_local std::vector<char> bmM;
+    static thread_local std::vector<Pel> r;
     r=res;
     bmM.resize(uiHeight*uiWidth); // avoir realloc
 
@@ -114,7 +114,7 @@ void smoothResidual(const ComponentID compID,const Pel *piOrg,Pel *piResi,UInt u
     default: assert(false);
     }
 
-    static std::vector<Pel> org; // avoid realloc
+    static thread_local std::vector<Pel> org; // avoid realloc
     org.resize(uiHeight*uiWidth);
 
     Bool activate=false;
@@ -126,7 +126,7 @@ void smoothResidual(const ComponentID compID,const Pel *piOrg,Pel *piResi,UInt u
 
 
     if (activate) {
-        static std::vector<Pel> r; // avoid realloc
+        static thread_local std::vector<Pel> r; // avoid realloc
         r.resize(uiHeight*uiWidth);
         for(Int i=0,k=0;i<uiHeight;++i)
             for(Int j=0;j<uiWidth;++j,++k) {
@@ -753,19 +753,16 @@ Void TEncSearch::init(TEncCfg*      pcEncCfg,
 #if COM16_C806_LMCHROMA
   const Int bitDepth = pcEncCfg->getBitDepth(CHANNEL_TYPE_LUMA);
   initTempBuff(cform, bitDepth
-#if VCEG_AZ08_INTER_KLT
-    , pcEncCfg->getUseInterKLT() , pcEncCfg->getSourceWidth() , pcEncCfg->getSourceHeight() , maxCUWidth , maxCUHeight , maxTotalCUDepth 
-#endif
     );
 #else
   initTempBuff(cform
-#if VCEG_AZ08_INTER_KLT
-    , pcEncCfg->getUseInterKLT() , pcEncCfg->getSourceWidth() , pcEncCfg->getSourceHeight() , maxCUWidth , maxCUHeight , maxTotalCUDepth 
-#endif
     );
 #endif
 
   m_pTempPel = new Pel[maxCUWidth*maxCUHeight];
+#if PIP
+  m_pcPredSearchPIP = this;
+#endif
 
 #if JVET_C0024_QTBT
   const UInt uiNumLayersToAllocate = g_aucConvertToBit[pcEncCfg->getCTUSize()] + 1;
@@ -977,6 +974,11 @@ Void TEncSearch::init(TEncCfg*      pcEncCfg,
 #endif
 
 #if JVET_D0077_SAVE_LOAD_ENC_INFO
+#if QTBT_PARALLEL_SPLIT
+  m_bTrackSaveLoadReads = false;
+  memset( m_SaveLoadTagSet, 0, sizeof( m_SaveLoadTagSet ) );
+  memset( m_SaveLoadSplitSet, 0, sizeof( m_SaveLoadSplitSet ) );
+#endif
   for( UInt uiWIdx = 0; uiWIdx <= MAX_CU_DEPTH-MIN_CU_LOG2; uiWIdx++ )
   {
     for( UInt uiHIdx = 0; uiHIdx <= MAX_CU_DEPTH-MIN_CU_LOG2; uiHIdx++ )
@@ -1015,6 +1017,122 @@ Void TEncSearch::init(TEncCfg*      pcEncCfg,
   m_isInitialized = true;
 }
 
+#if JVET_D0077_SAVE_LOAD_ENC_INFO && QTBT_PARALLEL_SPLIT
+Void TEncSearch::copySaveLoadInfo( const TEncSearch* pcSrc )
+{
+  for( UInt uiWIdx = 0; uiWIdx <= MAX_CU_DEPTH-MIN_CU_LOG2; uiWIdx++ )
+  {
+    for( UInt uiHIdx = 0; uiHIdx <= MAX_CU_DEPTH-MIN_CU_LOG2; uiHIdx++ )
+    {
+      xCopySaveLoadInfo( pcSrc, uiWIdx, uiHIdx );
+    }
+  }
+}
+
+Void TEncSearch::copySaveLoadWrites( const TEncSearch* pcSrc )
+{
+  for( UInt uiWIdx = 0; uiWIdx <= MAX_CU_DEPTH-MIN_CU_LOG2; uiWIdx++ )
+  {
+    for( UInt uiHIdx = 0; uiHIdx <= MAX_CU_DEPTH-MIN_CU_LOG2; uiHIdx++ )
+    {
+      const UChar ucSplit = m_SaveLoadSplit[uiWIdx][uiHIdx];
+      if( pcSrc->m_SaveLoadTagSet[uiWIdx][uiHIdx] )
+      {
+        xCopySaveLoadInfo( pcSrc, uiWIdx, uiHIdx );
+      }
+      m_SaveLoadSplit[uiWIdx][uiHIdx] = pcSrc->m_SaveLoadSplitSet[uiWIdx][uiHIdx] ? pcSrc->m_SaveLoadSplit[uiWIdx][uiHIdx] : ucSplit;
+    }
+  }
+}
+
+Void TEncSearch::startSaveLoadReads()
+{
+  memset( m_SaveLoadTagSet, 0, sizeof( m_SaveLoadTagSet ) );
+  memset( m_SaveLoadSplitSet, 0, sizeof( m_SaveLoadSplitSet ) );
+  m_SaveLoadReads.clear();
+  m_bTrackSaveLoadReads = true;
+}
+
+Bool TEncSearch::saveLoadReadsMatch( const TEncSearch* pcA, const TEncSearch* pcB ) const
+{
+  for( size_t i = 0; i < m_SaveLoadReads.size(); i++ )
+  {
+    const UInt uiPartIdx = m_SaveLoadReads[i] >> 8;
+    const UInt uiWIdx    = ( m_SaveLoadReads[i] >> 4 ) & 0xf;
+    const UInt uiHIdx    = m_SaveLoadReads[i] & 0xf;
+    const UChar ucTagA   = uiPartIdx == pcA->m_SaveLoadPartIdx[uiWIdx][uiHIdx] ? pcA->m_SaveLoadTag[uiWIdx][uiHIdx] : SAVE_LOAD_INIT;
+    const UChar ucTagB   = uiPartIdx == pcB->m_SaveLoadPartIdx[uiWIdx][uiHIdx] ? pcB->m_SaveLoadTag[uiWIdx][uiHIdx] : SAVE_LOAD_INIT;
+    if( ucTagA != ucTagB || ( ucTagA == LOAD_ENC_INFO && pcA->xSaveLoadInfoDiffers( pcB, uiWIdx, uiHIdx ) ) )
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+Bool TEncSearch::xSaveLoadInfoDiffers( const TEncSearch* pcSrc, UInt uiWIdx, UInt uiHIdx ) const
+{
+  return m_SaveLoadPartIdx[uiWIdx][uiHIdx]    != pcSrc->m_SaveLoadPartIdx[uiWIdx][uiHIdx]
+      || m_SaveLoadTag[uiWIdx][uiHIdx]        != pcSrc->m_SaveLoadTag[uiWIdx][uiHIdx]
+#if COM16_C806_EMT
+      || m_SaveLoadEmtFlag[uiWIdx][uiHIdx]    != pcSrc->m_SaveLoadEmtFlag[uiWIdx][uiHIdx]
+      || m_SaveLoadEmtIdx[uiWIdx][uiHIdx]     != pcSrc->m_SaveLoadEmtIdx[uiWIdx][uiHIdx]
+#endif
+#if VCEG_AZ05_ROT_TR || COM16_C1044_NSST
+      || m_SaveLoadRotIdx[uiWIdx][uiHIdx]     != pcSrc->m_SaveLoadRotIdx[uiWIdx][uiHIdx]
+#endif
+#if COM16_C1046_PDPC_INTRA
+      || m_SaveLoadPdpcIdx[uiWIdx][uiHIdx]    != pcSrc->m_SaveLoadPdpcIdx[uiWIdx][uiHIdx]
+#endif
+#if VCEG_AZ07_FRUC_MERGE
+      || m_SaveLoadFrucMode[uiWIdx][uiHIdx]   != pcSrc->m_SaveLoadFrucMode[uiWIdx][uiHIdx]
+#endif
+#if VCEG_AZ07_IMV
+      || m_SaveLoadIMVFlag[uiWIdx][uiHIdx]    != pcSrc->m_SaveLoadIMVFlag[uiWIdx][uiHIdx]
+#endif
+#if VCEG_AZ06_IC
+      || m_SaveLoadICFlag[uiWIdx][uiHIdx]     != pcSrc->m_SaveLoadICFlag[uiWIdx][uiHIdx]
+#endif
+#if COM16_C1016_AFFINE
+      || m_SaveLoadAffineFlag[uiWIdx][uiHIdx] != pcSrc->m_SaveLoadAffineFlag[uiWIdx][uiHIdx]
+#endif
+      || m_SaveLoadMergeFlag[uiWIdx][uiHIdx]  != pcSrc->m_SaveLoadMergeFlag[uiWIdx][uiHIdx]
+      || m_SaveLoadInterDir[uiWIdx][uiHIdx]   != pcSrc->m_SaveLoadInterDir[uiWIdx][uiHIdx]
+      || m_SaveLoadSplit[uiWIdx][uiHIdx]      != pcSrc->m_SaveLoadSplit[uiWIdx][uiHIdx];
+}
+
+Void TEncSearch::xCopySaveLoadInfo( const TEncSearch* pcSrc, UInt uiWIdx, UInt uiHIdx )
+{
+  m_SaveLoadPartIdx[uiWIdx][uiHIdx]    = pcSrc->m_SaveLoadPartIdx[uiWIdx][uiHIdx];
+  m_SaveLoadTag[uiWIdx][uiHIdx]        = pcSrc->m_SaveLoadTag[uiWIdx][uiHIdx];
+#if COM16_C806_EMT
+  m_SaveLoadEmtFlag[uiWIdx][uiHIdx]    = pcSrc->m_SaveLoadEmtFlag[uiWIdx][uiHIdx];
+  m_SaveLoadEmtIdx[uiWIdx][uiHIdx]     = pcSrc->m_SaveLoadEmtIdx[uiWIdx][uiHIdx];
+#endif
+#if VCEG_AZ05_ROT_TR || COM16_C1044_NSST
+  m_SaveLoadRotIdx[uiWIdx][uiHIdx]     = pcSrc->m_SaveLoadRotIdx[uiWIdx][uiHIdx];
+#endif
+#if COM16_C1046_PDPC_INTRA
+  m_SaveLoadPdpcIdx[uiWIdx][uiHIdx]    = pcSrc->m_SaveLoadPdpcIdx[uiWIdx][uiHIdx];
+#endif
+#if VCEG_AZ07_FRUC_MERGE
+  m_SaveLoadFrucMode[uiWIdx][uiHIdx]   = pcSrc->m_SaveLoadFrucMode[uiWIdx][uiHIdx];
+#endif
+#if VCEG_AZ07_IMV
+  m_SaveLoadIMVFlag[uiWIdx][uiHIdx]    = pcSrc->m_SaveLoadIMVFlag[uiWIdx][uiHIdx];
+#endif
+#if VCEG_AZ06_IC
+  m_SaveLoadICFlag[uiWIdx][uiHIdx]     = pcSrc->m_SaveLoadICFlag[uiWIdx][uiHIdx];
+#endif
+#if COM16_C1016_AFFINE
+  m_SaveLoadAffineFlag[uiWIdx][uiHIdx] = pcSrc->m_SaveLoadAffineFlag[uiWIdx][uiHIdx];
+#endif
+  m_SaveLoadMergeFlag[uiWIdx][uiHIdx]  = pcSrc->m_SaveLoadMergeFlag[uiWIdx][uiHIdx];
+  m_SaveLoadInterDir[uiWIdx][uiHIdx]   = pcSrc->m_SaveLoadInterDir[uiWIdx][uiHIdx];
+  m_SaveLoadSplit[uiWIdx][uiHIdx]      = pcSrc->m_SaveLoadSplit[uiWIdx][uiHIdx];
+}
+#endif
+
 #define TZ_SEARCH_CONFIGURATION                                                                                 \
 const Int  iRaster                  = 5;  /* TZ soll von aussen ?ergeben werden */                            \
 const Bool bTestOtherPredictedMV    = 0;                                                                      \
@@ -2110,7 +2228,8 @@ Void TEncSearch::xIntraCodingTUBlock(       TComYuv*    pcOrgYuv,
 #if PIP
   Bool tmpFilter;
 
-  Pel	*R1 = (Pel*)xMalloc(Pel, uiWidth*uiHeight*sizeof(Pel));
+  TComScratchScope scratchScope(m_cPIPArena);
+  Pel *R1 = m_cPIPArena.alloc<Pel>(uiWidth*uiHeight);
 #if CU_EXCLUSIVE
   Bool	isPIP = (uiWidth == CUMAX) && (uiHeight == CUMAX) && isLuma(compID) && pcCU->getPIPflag(0);
 #else
@@ -2652,9 +2771,6 @@ Void TEncSearch::xIntraCodingTUBlock(       TComYuv*    pcOrgYuv,
   //===== update distortion =====
   ruiDist += m_pcRdCost->getDistPart( bitDepth, piReco, uiStride, piOrg, uiStride, uiWidth, uiHeight, compID );
 
-#if PIP
-  _aligned_free(R1);
-#endif
 }
 
 #if VCEG_AZ08_INTRA_KLT
@@ -3033,10 +3149,11 @@ TEncSearch::xRecurIntraCodingLumaQT_RSAF(TComYuv*    pcOrgYuv,
         Bool    bSingleFilter = false;
 
 #if PIP
-		int *spQR1 = (int*)xMalloc(int, uiWidth*uiHeight*sizeof(int));
+		TComScratchScope scratchScope(m_cPIPArena);
+		int *spQR1 = m_cPIPArena.alloc<int>(uiWidth*uiHeight);
 		memset(spQR1, 0, uiWidth*uiHeight*sizeof(int));
 #if NOISE_MARK
-		int *spQR1NoiseMark = (int*)xMalloc(int, uiWidth*uiHeight*sizeof(int));
+		int *spQR1NoiseMark = m_cPIPArena.alloc<int>(uiWidth*uiHeight);
 		memset(spQR1NoiseMark, 0, uiWidth*uiHeight*sizeof(int));
 #endif
 #endif
@@ -3134,7 +3251,7 @@ if (rTu.getRect(COMPONENT_Y).width==4) //RSAF is not applied to 4x4 TUs.
   UInt    uiInitTrDepth     = pcCU->getPartitionSize(0) == SIZE_2Nx2N ? 0 : 1;
   UChar   ucSavedEmtTrIdx   = 0;
   Bool    bCheckInitTrDepth = false;
-  static UInt uiInitAbsPartIdx;
+  static thread_local UInt uiInitAbsPartIdx;
   if ( uiTrDepth==uiInitTrDepth )
   {
     uiInitAbsPartIdx = uiAbsPartIdx;
@@ -3808,12 +3925,6 @@ if (rTu.getRect(COMPONENT_Y).width==4) //RSAF is not applied to 4x4 TUs.
 
   dRDCost  += dSingleCost;
 
-#if PIP
-  _aligned_free(spQR1);
-#if NOISE_MARK
-  _aligned_free(spQR1NoiseMark);
-#endif
-#endif
 }
 
 #endif
@@ -3859,10 +3970,11 @@ TEncSearch::xRecurIntraCodingLumaQT(TComYuv*    pcOrgYuv,
 #else
   Bool	isPIP = (uiWidth <= CUMAX) && (uiHeight <= CUMAX) && pcCU->getPIPflag(0);
 #endif
-  int *spQR1 = (int*)xMalloc(int, uiWidth*uiHeight*sizeof(int));
+  TComScratchScope scratchScope(m_cPIPArena);
+  int *spQR1 = m_cPIPArena.alloc<int>(uiWidth*uiHeight);
   memset(spQR1, 0, uiWidth*uiHeight*sizeof(int));
 #if NOISE_MARK
-  int *spQR1NoiseMark = (int*)xMalloc(int, uiWidth*uiHeight*sizeof(int));
+  int *spQR1NoiseMark = m_cPIPArena.alloc<int>(uiWidth*uiHeight);
   memset(spQR1NoiseMark, 0, uiWidth*uiHeight*sizeof(int));
 #endif
 #endif
@@ -3936,7 +4048,7 @@ TEncSearch::xRecurIntraCodingLumaQT(TComYuv*    pcOrgYuv,
 #endif
   UChar   ucSavedEmtTrIdx   = 0;
   Bool    bCheckInitTrDepth = false;
-  static UInt uiInitAbsPartIdx;
+  static thread_local UInt uiInitAbsPartIdx;
   if ( uiTrDepth==uiInitTrDepth )
   {
     uiInitAbsPartIdx = uiAbsPartIdx;
@@ -4807,12 +4919,6 @@ TEncSearch::xRecurIntraCodingLumaQT(TComYuv*    pcOrgYuv,
   ruiDistY += uiSingleDistLuma;
   dRDCost  += dSingleCost;
 
-#if PIP
-  _aligned_free(spQR1);
-#if NOISE_MARK
-  _aligned_free(spQR1NoiseMark);
-#endif
-#endif
 }
 
 
@@ -5353,7 +5459,8 @@ TEncSearch::xRecurIntraChromaCodingQT(TComYuv*    pcOrgYuv,
 #endif
 
 #if PIP
-			int *spQR1dummy = (int*)xMalloc(int, pcCU->getWidth(0)*pcCU->getHeight(0)*sizeof(int));
+			TComScratchScope scratchScope(m_cPIPArena);
+			int *spQR1dummy = m_cPIPArena.alloc<int>(pcCU->getWidth(0)*pcCU->getHeight(0));
 			memset(spQR1dummy, 0, pcCU->getWidth(0)*pcCU->getHeight(0)*sizeof(int));
 #endif
             xIntraCodingTUBlock( pcOrgYuv, pcPredYuv, pcResiYuv, resiLuma, (crossCPredictionModeId != 0), singleDistCTmp, compID, TUIterator DEBUG_STRING_PASS_INTO(sDebugMode)
@@ -5367,9 +5474,6 @@ TEncSearch::xRecurIntraChromaCodingQT(TComYuv*    pcOrgYuv,
 #endif
 				, default0Save1Load2);
 
-#if PIP
-			_aligned_free(spQR1dummy);
-#endif
 
             singleCbfCTmp = pcCU->getCbf( subTUAbsPartIdx, compID, uiTrDepth);
 
@@ -5623,7 +5727,8 @@ TEncSearch::estIntraPredLumaQT(TComDataCU* pcCU,
 		Channel: Only lume
 		Conflict with other tools: PDPC not allowed,
 		*/
-		int *spQR1 = (int*)xMalloc(int, uiWidth*uiHeight*sizeof(int));
+		TComScratchScope scratchScope(m_cPIPArena);
+		int *spQR1 = m_cPIPArena.alloc<int>(uiWidth*uiHeight);
 		memset(spQR1, 0, uiWidth*uiHeight*sizeof(int));
 
 #if CU_EXCLUSIVE
@@ -5722,8 +5827,8 @@ TEncSearch::estIntraPredLumaQT(TComDataCU* pcCU,
 #endif
       ;
 #endif
-  static UInt   uiSavedRdModeListNSST[35], uiSavedNumRdModesNSST, uiSavedHadModeListNSST[35];
-  static Double dSavedModeCostNSST[35], dSavedHadListNSST[FAST_UDI_MAX_RDMODE_NUM];
+  static thread_local UInt   uiSavedRdModeListNSST[35], uiSavedNumRdModesNSST, uiSavedHadModeListNSST[35];
+  static thread_local Double dSavedModeCostNSST[35], dSavedHadListNSST[FAST_UDI_MAX_RDMODE_NUM];
 #if JVET_C0024_PBINTRA_FAST
   UInt uiHadModeList[67];
 #endif
@@ -5731,13 +5836,13 @@ TEncSearch::estIntraPredLumaQT(TComDataCU* pcCU,
 
 #if COM16_C806_EMT
 #if JVET_C0024_QTBT
-  static Double dBestModeCostStore; // RD cost of the best mode for each PU using DCT2
-  static Double dModeCostStore[35]; // RD cost of each mode for each PU using DCT2
-  static UInt   uiSavedRdModeList[35], uiSavedNumRdModes;
+  static thread_local Double dBestModeCostStore; // RD cost of the best mode for each PU using DCT2
+  static thread_local Double dModeCostStore[35]; // RD cost of each mode for each PU using DCT2
+  static thread_local UInt   uiSavedRdModeList[35], uiSavedNumRdModes;
 #else
-  static Double dBestModeCostStore[4]; // RD cost of the best mode for each PU using DCT2
-  static Double dModeCostStore[4][35]; // RD cost of each mode for each PU using DCT2
-  static UInt   uiSavedRdModeList[4][35], uiSavedNumRdModes[4];
+  static thread_local Double dBestModeCostStore[4]; // RD cost of the best mode for each PU using DCT2
+  static thread_local Double dModeCostStore[4][35]; // RD cost of each mode for each PU using DCT2
+  static thread_local UInt   uiSavedRdModeList[4][35], uiSavedNumRdModes[4];
 #endif
 
   // Marking EMT usage for faster EMT
@@ -6917,9 +7022,6 @@ TEncSearch::estIntraPredLumaQT(TComDataCU* pcCU,
   //===== set distortion (rate and r-d costs are determined later) =====
   pcCU->getTotalDistortion() = uiOverallDistY;
 
-#if PIP  
-  _aligned_free(spQR1);
-#endif
 }
 
 
@@ -7254,7 +7356,8 @@ TEncSearch::estIntraPredChromaQT(TComDataCU* pcCU,
 #endif
           }
 #if PIP
-		  int *spQR1dummy = (int*)xMalloc(int, pcCU->getWidth(0)*pcCU->getHeight(0)*sizeof(int));
+		  TComScratchScope scratchScope(m_cPIPArena);
+		  int *spQR1dummy = m_cPIPArena.alloc<int>(pcCU->getWidth(0)*pcCU->getHeight(0));
 		  memset(spQR1dummy, 0, pcCU->getWidth(0)*pcCU->getHeight(0)*sizeof(int));
 #endif
           UInt    uiBits = xGetIntraBitsQT( tuRecurseWithPU, false, true, false 
@@ -7266,9 +7369,6 @@ TEncSearch::estIntraPredChromaQT(TComDataCU* pcCU,
 #endif
 			  );
 
-#if PIP
-		  _aligned_free(spQR1dummy);
-#endif
           Double  dCost  = m_pcRdCost->calcRdCost( uiBits, uiDist );
 
 
@@ -7478,7 +7578,8 @@ Void TEncSearch::IPCMSearch( TComDataCU* pcCU, TComYuv* pcOrgYuv, TComYuv* pcPre
   m_pcEntropyCoder->resetBits();
 
 #if PIP
-  int *spQR1dummy = (int*)xMalloc(int, pcCU->getWidth(0)*pcCU->getHeight(0)*sizeof(int));
+  TComScratchScope scratchScope(m_cPIPArena);
+  int *spQR1dummy = m_cPIPArena.alloc<int>(pcCU->getWidth(0)*pcCU->getHeight(0));
   memset(spQR1dummy, 0, pcCU->getWidth(0)*pcCU->getHeight(0)*sizeof(int));
 #endif
 
@@ -7491,9 +7592,6 @@ Void TEncSearch::IPCMSearch( TComDataCU* pcCU, TComYuv* pcOrgYuv, TComYuv* pcPre
 #endif 
 	  );
 
-#if PIP
-  _aligned_free(spQR1dummy);
-#endif
   uiBits = m_pcEntropyCoder->getNumberOfWrittenBits();
 
   dCost = m_pcRdCost->calcRdCost( uiBits, uiDistortion );
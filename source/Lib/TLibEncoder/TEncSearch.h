@@ -197,6 +197,12 @@ private:
   Bool            m_SaveLoadMergeFlag[MAX_CU_DEPTH-MIN_CU_LOG2+1][MAX_CU_DEPTH-MIN_CU_LOG2+1];
   UChar           m_SaveLoadInterDir[MAX_CU_DEPTH-MIN_CU_LOG2+1][MAX_CU_DEPTH-MIN_CU_LOG2+1];
   UChar           m_SaveLoadSplit[MAX_CU_DEPTH-MIN_CU_LOG2+1][MAX_CU_DEPTH-MIN_CU_LOG2+1];
+#if QTBT_PARALLEL_SPLIT
+  Bool            m_bTrackSaveLoadReads;                                                      ///< a split task records the tags it reads before it sets them
+  Bool            m_SaveLoadTagSet[MAX_CU_DEPTH-MIN_CU_LOG2+1][MAX_CU_DEPTH-MIN_CU_LOG2+1];   ///< the task set the tag of the block size
+  Bool            m_SaveLoadSplitSet[MAX_CU_DEPTH-MIN_CU_LOG2+1][MAX_CU_DEPTH-MIN_CU_LOG2+1]; ///< the task set the split decision of the block size
+  std::vector<UInt> m_SaveLoadReads;                                                          ///< (uiPartIdx << 8) | (uiWIdx << 4) | uiHIdx of the tags read
+#endif
 #endif
 
 
@@ -313,9 +319,20 @@ public:
 
   Void destroy();
 
+#if PIP_PARALLEL_PRED
+  /// threads of the PIP predictor search of this search, the caller included; set by the encoder after init().
+  /// No thread is started when no PIP block reaches PIP_PARALLEL_MIN_SAMPLES
+  Void setPIPThreads( Int iNumThreads )                   { m_cPIPPool.create( CUMAX * CUMAX >= PIP_PARALLEL_MIN_SAMPLES ? iNumThreads : 1 ); }
+#endif
+
 #if JVET_D0077_SAVE_LOAD_ENC_INFO
+#if QTBT_PARALLEL_SPLIT
+  UChar getSaveLoadTag( UInt uiPartIdx, UInt uiWIdx, UInt uiHIdx ) {  if( m_bTrackSaveLoadReads && !m_SaveLoadTagSet[uiWIdx][uiHIdx] ) { m_SaveLoadReads.push_back( ( uiPartIdx << 8 ) | ( uiWIdx << 4 ) | uiHIdx ); } return uiPartIdx == m_SaveLoadPartIdx[uiWIdx][uiHIdx] ? m_SaveLoadTag[uiWIdx][uiHIdx] : SAVE_LOAD_INIT; };
+  Void  setSaveLoadTag( UInt uiPartIdx, UInt uiWIdx, UInt uiHIdx, UChar c ) { m_SaveLoadTagSet[uiWIdx][uiHIdx] = true; m_SaveLoadPartIdx[uiWIdx][uiHIdx] = uiPartIdx; m_SaveLoadTag[uiWIdx][uiHIdx] = c; };
+#else
   UChar getSaveLoadTag( UInt uiPartIdx, UInt uiWIdx, UInt uiHIdx ) {  return uiPartIdx == m_SaveLoadPartIdx[uiWIdx][uiHIdx] ? m_SaveLoadTag[uiWIdx][uiHIdx] : SAVE_LOAD_INIT; };
   Void  setSaveLoadTag( UInt uiPartIdx, UInt uiWIdx, UInt uiHIdx, UChar c ) { m_SaveLoadPartIdx[uiWIdx][uiHIdx] = uiPartIdx; m_SaveLoadTag[uiWIdx][uiHIdx] = c; };
+#endif
 #if COM16_C806_EMT
   UChar getSaveLoadEmtFlag( UInt uiWIdx, UInt uiHIdx ) {  return m_SaveLoadEmtFlag[uiWIdx][uiHIdx]; }; 
   Void  setSaveLoadEmtFlag( UInt uiWIdx, UInt uiHIdx, UChar c ) { m_SaveLoadEmtFlag[uiWIdx][uiHIdx] = c; };
@@ -356,10 +373,29 @@ public:
   UChar getSaveLoadInterDir( UInt uiWIdx, UInt uiHIdx ) {  return m_SaveLoadInterDir[uiWIdx][uiHIdx]; }; 
   Void  setSaveLoadInterDir( UInt uiWIdx, UInt uiHIdx, UChar c ) { m_SaveLoadInterDir[uiWIdx][uiHIdx] = c; };
   UChar getSaveLoadSplit( UInt uiWIdx, UInt uiHIdx ) {  return m_SaveLoadSplit[uiWIdx][uiHIdx]; }; 
+#if QTBT_PARALLEL_SPLIT
+  Void  setSaveLoadSplit( UInt uiWIdx, UInt uiHIdx, UChar c ) { m_SaveLoadSplitSet[uiWIdx][uiHIdx] = true; m_SaveLoadSplit[uiWIdx][uiHIdx] = c; };
+#else
   Void  setSaveLoadSplit( UInt uiWIdx, UInt uiHIdx, UChar c ) { m_SaveLoadSplit[uiWIdx][uiHIdx] = c; };
 #endif
+#if QTBT_PARALLEL_SPLIT
+  /// takes the save/load information of all the block sizes from pcSrc
+  Void  copySaveLoadInfo ( const TEncSearch* pcSrc );
+  /// takes the tags, with the information saved with them, and the split decisions pcSrc set since startSaveLoadReads()
+  Void  copySaveLoadWrites( const TEncSearch* pcSrc );
+  /// records the tags read before they are set, and the ones set, until stopSaveLoadReads(); the loaded information comes with its tag
+  Void  startSaveLoadReads();
+  Void  stopSaveLoadReads()                               { m_bTrackSaveLoadReads = false; }
+  /// the tags read, and the information of the ones that load, are the same in pcA and pcB
+  Bool  saveLoadReadsMatch( const TEncSearch* pcA, const TEncSearch* pcB ) const;
+#endif
+#endif
 
 protected:
+#if JVET_D0077_SAVE_LOAD_ENC_INFO && QTBT_PARALLEL_SPLIT
+  Bool  xSaveLoadInfoDiffers( const TEncSearch* pcSrc, UInt uiWIdx, UInt uiHIdx ) const;
+  Void  xCopySaveLoadInfo   ( const TEncSearch* pcSrc, UInt uiWIdx, UInt uiHIdx );
+#endif
 
   /// sub-function for motion vector refinement used in fractional-pel accuracy
   Distortion  xPatternRefinement( TComPattern* pcPatternKey,
@@ -38,6 +38,7 @@
 #include "TEncTop.h"
 #include "TEncSlice.h"
 #include <math.h>
+#include <algorithm>
 
 //! \ingroup TLibEncoder
 //! \{
@@ -55,6 +56,11 @@ TEncSlice::TEncSlice()
   m_pdRdPicLambda = NULL;
   m_pdRdPicQp     = NULL;
   m_piRdPicQp     = NULL;
+#if WPP_PARALLEL_CTU_ROWS
+  m_pcCtuWorkers           = NULL;
+  m_iNumCtuWorkers         = 0;
+  m_pcRowSyncContextStates = NULL;
+#endif
 }
 
 TEncSlice::~TEncSlice()
@@ -112,6 +118,14 @@ Void TEncSlice::destroy()
     xFree( m_piRdPicQp );
     m_piRdPicQp = NULL;
   }
+#if WPP_PARALLEL_CTU_ROWS
+  m_cCtuWorkerPool.destroy();
+#if QTBT_PARALLEL_SPLIT
+  m_cSplitTaskPool.destroy();
+#endif
+  delete [] m_pcRowSyncContextStates;
+  m_pcRowSyncContextStates = NULL;
+#endif
 }
 
 Void TEncSlice::init( TEncTop* pcEncTop )
@@ -127,6 +141,9 @@ Void TEncSlice::init( TEncTop* pcEncTop )
   m_pcSbacCoder       = pcEncTop->getSbacCoder();
   m_pcBinCABAC        = pcEncTop->getBinCABAC();
   m_pcTrQuant         = pcEncTop->getTrQuant();
+#if PIP
+  m_pcPIPCoderState   = pcEncTop->getPIPCoderState();
+#endif
 
   m_pcRdCost          = pcEncTop->getRdCost();
 #if JVET_C0024_QTBT
@@ -141,6 +158,23 @@ Void TEncSlice::init( TEncTop* pcEncTop )
   m_pdRdPicQp         = (Double*)xMalloc( Double, m_pcCfg->getDeltaQpRD() * 2 + 1 );
   m_piRdPicQp         = (Int*   )xMalloc( Int,    m_pcCfg->getDeltaQpRD() * 2 + 1 );
   m_pcRateCtrl        = pcEncTop->getRateCtrl();
+
+#if WPP_PARALLEL_CTU_ROWS
+  m_pcCtuWorkers      = pcEncTop->getCtuWorkers();
+  m_iNumCtuWorkers    = pcEncTop->getNumCtuWorkers();
+  if( m_iNumCtuWorkers > 0 )
+  {
+    const UInt frameHeightInCtus = ( m_pcCfg->getSourceHeight() + m_pcCfg->getCTUSize() - 1 ) / m_pcCfg->getCTUSize();
+    m_cCtuWorkerPool.create( pcEncTop->getNumCtuThreads() );
+    m_pcRowSyncContextStates = new TEncSbac[frameHeightInCtus];
+  }
+#endif
+#if QTBT_PARALLEL_SPLIT
+  if( m_pcCfg->getSplitThreads() > 1 )
+  {
+    m_cSplitTaskPool.create( m_pcCfg->getSplitThreads() );
+  }
+#endif
 }
 
 
@@ -562,6 +596,17 @@ Void TEncSlice::resetQP( TComPic* pic, Int sliceQP, Double lambda )
 // ====================================================================================================================
 
 Void TEncSlice::setSearchRange( TComSlice* pcSlice )
+{
+  xSetSearchRange( m_pcPredSearch, pcSlice );
+#if WPP_PARALLEL_CTU_ROWS
+  for( Int i = 0; i < m_iNumCtuWorkers; i++ )
+  {
+    xSetSearchRange( m_pcCtuWorkers[i].getPredSearch(), pcSlice );
+  }
+#endif
+}
+
+Void TEncSlice::xSetSearchRange( TEncSearch* pcPredSearch, TComSlice* pcSlice )
 {
   Int iCurrPOC = pcSlice->getPOC();
   Int iRefPOC;
@@ -578,7 +623,7 @@ Void TEncSlice::setSearchRange( TComSlice* pcSlice )
     {
       iRefPOC = pcSlice->getRefPic(e, iRefIdx)->getPOC();
       Int iNewSR = Clip3(8, iMaxSR, (iMaxSR*ADAPT_SR_SCALE*abs(iCurrPOC - iRefPOC)+iOffset)/iGOPSize);
-      m_pcPredSearch->setAdaptiveSearchRange(iDir, iRefIdx, iNewSR);
+      pcPredSearch->setAdaptiveSearchRange(iDir, iRefIdx, iNewSR);
     }
   }
 }
@@ -717,6 +762,64 @@ Void TEncSlice::calCostSliceI(TComPic* pcPic) // TODO: this only analyses the fi
   m_pcRateCtrl->getRCPic()->setTotalIntraCost(iSumHadSlice);
 }
 
+/** Weighted prediction, adaptive QP selection and illumination compensation decisions of the slice,
+ *  made before its CTUs are compressed.
+ */
+Void TEncSlice::xInitSliceTools( TComSlice* pcSlice )
+{
+  //------------------------------------------------------------------------------
+  //  Weighted Prediction parameters estimation.
+  //------------------------------------------------------------------------------
+  // calculate AC/DC values for current picture
+  if( pcSlice->getPPS()->getUseWP() || pcSlice->getPPS()->getWPBiPred() )
+  {
+    xCalcACDCParamSlice(pcSlice);
+  }
+
+  const Bool bWp_explicit = (pcSlice->getSliceType()==P_SLICE && pcSlice->getPPS()->getUseWP()) || (pcSlice->getSliceType()==B_SLICE && pcSlice->getPPS()->getWPBiPred());
+
+  if ( bWp_explicit )
+  {
+    //------------------------------------------------------------------------------
+    //  Weighted Prediction implemented at Slice level. SliceMode=2 is not supported yet.
+    //------------------------------------------------------------------------------
+    if ( pcSlice->getSliceMode()==FIXED_NUMBER_OF_BYTES || pcSlice->getSliceSegmentMode()==FIXED_NUMBER_OF_BYTES )
+    {
+      printf("Weighted Prediction is not supported with slice mode determined by max number of bins.\n"); exit(0);
+    }
+
+    xEstimateWPParamSlice( pcSlice );
+    pcSlice->initWpScaling(pcSlice->getSPS());
+
+    // check WP on/off
+    xCheckWPEnable( pcSlice );
+  }
+
+#if ADAPTIVE_QP_SELECTION
+  if( m_pcCfg->getUseAdaptQpSelect() && !(pcSlice->getDependentSliceSegmentFlag()))
+  {
+    // TODO: this won't work with dependent slices: they do not have their own QP. Check fix to mask clause execution with && !(pcSlice->getDependentSliceSegmentFlag())
+    m_pcTrQuant->clearSliceARLCnt(); // TODO: this looks wrong for multiple slices - the results of all but the last slice will be cleared before they are used (all slices compressed, and then all slices encoded)
+    if(pcSlice->getSliceType()!=I_SLICE)
+    {
+      Int qpBase = pcSlice->getSliceQpBase();
+      pcSlice->setSliceQp(qpBase + m_pcTrQuant->getQpDelta(qpBase));
+    }
+  }
+#endif
+
+#if VCEG_AZ06_IC
+  if ( m_pcCfg->getUseIC() )
+  {
+#if VCEG_AZ06_IC_SPEEDUP || JVET_C0024_QTBT
+    pcSlice->xSetApplyIC();
+#else
+    pcSlice->setApplyIC( pcSlice->isIntra() ? false : true );
+#endif
+  }
+#endif
+}
+
 /** \param pcPic   picture class
  */
 Void TEncSlice::compressSlice( TComPic* pcPic, const Bool bCompressEntireSlice, const Bool bFastDeltaQP )
@@ -774,57 +877,7 @@ Void TEncSlice::compressSlice( TComPic* pcPic, const Bool bCompressEntireSlice,
   m_pcEntropyCoder->setMaxAlfCtrlDepth(0); //unnecessary
 #endif
 
-  //------------------------------------------------------------------------------
-  //  Weighted Prediction parameters estimation.
-  //------------------------------------------------------------------------------
-  // calculate AC/DC values for current picture
-  if( pcSlice->getPPS()->getUseWP() || pcSlice->getPPS()->getWPBiPred() )
-  {
-    xCalcACDCParamSlice(pcSlice);
-  }
-
-  const Bool bWp_explicit = (pcSlice->getSliceType()==P_SLICE && pcSlice->getPPS()->getUseWP()) || (pcSlice->getSliceType()==B_SLICE && pcSlice->getPPS()->getWPBiPred());
-
-  if ( bWp_explicit )
-  {
-    //------------------------------------------------------------------------------
-    //  Weighted Prediction implemented at Slice level. SliceMode=2 is not supported yet.
-    //------------------------------------------------------------------------------
-    if ( pcSlice->getSliceMode()==FIXED_NUMBER_OF_BYTES || pcSlice->getSliceSegmentMode()==FIXED_NUMBER_OF_BYTES )
-    {
-      printf("Weighted Prediction is not supported with slice mode determined by max number of bins.\n"); exit(0);
-    }
-
-    xEstimateWPParamSlice( pcSlice );
-    pcSlice->initWpScaling(pcSlice->getSPS());
-
-    // check WP on/off
-    xCheckWPEnable( pcSlice );
-  }
-
-#if ADAPTIVE_QP_SELECTION
-  if( m_pcCfg->getUseAdaptQpSelect() && !(pcSlice->getDependentSliceSegmentFlag()))
-  {
-    // TODO: this won't work with dependent slices: they do not have their own QP. Check fix to mask clause execution with && !(pcSlice->getDependentSliceSegmentFlag())
-    m_pcTrQuant->clearSliceARLCnt(); // TODO: this looks wrong for multiple slices - the results of all but the last slice will be cleared before they are used (all slices compressed, and then all slices encoded)
-    if(pcSlice->getSliceType()!=I_SLICE)
-    {
-      Int qpBase = pcSlice->getSliceQpBase();
-      pcSlice->setSliceQp(qpBase + m_pcTrQuant->getQpDelta(qpBase));
-    }
-  }
-#endif
-
-#if VCEG_AZ06_IC
-  if ( m_pcCfg->getUseIC() )
-  {
-#if VCEG_AZ06_IC_SPEEDUP || JVET_C0024_QTBT
-    pcSlice->xSetApplyIC();
-#else
-    pcSlice->setApplyIC( pcSlice->isIntra() ? false : true );
-#endif
-  }
-#endif
+  xInitSliceTools( pcSlice );
 
   // Adjust initial state if this is the start of a dependent slice.
   {
@@ -848,6 +901,44 @@ Void TEncSlice::compressSlice( TComPic* pcPic, const Bool bCompressEntireSlice,
 
   // for every CTU in the slice segment (may terminate sooner if there is a byte limit on the slice-segment)
 
+#if QTBT_PARALLEL_SPLIT
+  // the CTUs compressed by this encoder hand the split candidates of their large CUs to the first two CTU workers
+  if( m_pcCfg->getSplitThreads() > 1 && m_iNumCtuWorkers >= 2 && xCanUseCtuWorkers( pcPic, pcSlice ) )
+  {
+#if VCEG_AZ07_FRUC_MERGE
+    if( pcSlice->isInterB() )
+    {
+      pcSlice->getRefIdx4MVPair( REF_PIC_LIST_0, 0 );
+    }
+#endif
+    for( Int i = 0; i < 2; i++ )
+    {
+      xPrepareCtuWorker( m_pcCtuWorkers[i], pcSlice, bFastDeltaQP );
+    }
+    m_pcCuEncoder->setSplitTasks( m_pcCtuWorkers, &m_cSplitTaskPool, m_pcCfg->getSplitTaskMinSize() );
+  }
+#endif
+
+#if WPP_PARALLEL_CTU_ROWS
+  const Bool bCtuRowRateCtrl = xUseCtuRowRateCtrl( pcPic, pcSlice, startCtuTsAddr );
+  if( bCtuRowRateCtrl )
+  {
+    m_pcRateCtrl->getRCPic()->initCtuRows( startCtuTsAddr, boundingCtuTsAddr, frameWidthInCtus, pcSlice->getSliceType() );
+  }
+
+  if( xUseCtuRowWorkers( pcPic, pcSlice, startCtuTsAddr, boundingCtuTsAddr ) )
+  {
+    xCompressCtuRows( pcPic, pcSlice, startCtuTsAddr, boundingCtuTsAddr, bFastDeltaQP );
+  }
+  else
+#if TILE_PARALLEL_COMPRESSION
+  if( xUseTileWorkers( pcPic, pcSlice, startCtuTsAddr, boundingCtuTsAddr ) )
+  {
+    xCompressTiles( pcPic, pcSlice, startCtuTsAddr, boundingCtuTsAddr, bFastDeltaQP );
+  }
+  else
+#endif
+#endif
   for( UInt ctuTsAddr = startCtuTsAddr; ctuTsAddr < boundingCtuTsAddr; ++ctuTsAddr )
   {
     const UInt ctuRsAddr = pcPic->getPicSym()->getCtuTsToRsAddrMap(ctuTsAddr);
@@ -929,6 +1020,12 @@ Void TEncSlice::compressSlice( TComPic* pcPic, const Bool bCompressEntireSlice,
       {
         estQP = pcSlice->getSliceQp();
       }
+#if WPP_PARALLEL_CTU_ROWS
+      else if ( bCtuRowRateCtrl )
+      {
+        estQP = xEstimateCtuRowQP( pcPic, pcSlice, ctuRsAddr, m_pcRdCost, m_pcTrQuant );
+      }
+#endif
       else
       {
         bpp = m_pcRateCtrl->getRCPic()->getLCUTargetBpp(pcSlice->getSliceType());
@@ -992,7 +1089,7 @@ Void TEncSlice::compressSlice( TComPic* pcPic, const Bool bCompressEntireSlice,
     pRDSbacCoder->setBinsCoded( 0 );
 
 #if PIP
-	encodeTime = true;
+	m_pcPIPCoderState->encodeTime = true;
 #endif
     // encode CTU and calculate the true bit counters.
     m_pcCuEncoder->encodeCtu( pCtu );
@@ -1000,7 +1097,7 @@ Void TEncSlice::compressSlice( TComPic* pcPic, const Bool bCompressEntireSlice,
 #if PIP
 	if (verbose)
 		cout << endl;
-	encodeTime = false;
+	m_pcPIPCoderState->encodeTime = false;
 #endif
     pRDSbacCoder->setBinCountingEnableFlag( false );
 
@@ -1065,6 +1162,13 @@ Void TEncSlice::compressSlice( TComPic* pcPic, const Bool bCompressEntireSlice,
         actualQP = pCtu->getQP( 0 );
       }
       m_pcRdCost->setLambda(oldLambda, pcSlice->getSPS()->getBitDepths());
+#if WPP_PARALLEL_CTU_ROWS
+      if ( bCtuRowRateCtrl )
+      {
+        m_pcRateCtrl->getRCPic()->updateCtuRow( ctuRsAddr, actualBits, actualQP, actualLambda );
+      }
+      else
+#endif
       m_pcRateCtrl->getRCPic()->updateAfterCTU( m_pcRateCtrl->getRCPic()->getLCUCoded(), actualBits, actualQP, actualLambda,
                                                 pCtu->getSlice()->getSliceType() == I_SLICE ? 0 : m_pcCfg->getLCULevelRC() );
     }
@@ -1073,6 +1177,15 @@ Void TEncSlice::compressSlice( TComPic* pcPic, const Bool bCompressEntireSlice,
     m_dPicRdCost     += pCtu->getTotalCost();
     m_uiPicDist      += pCtu->getTotalDistortion();
   }
+#if QTBT_PARALLEL_SPLIT
+  m_pcCuEncoder->setSplitTasks( NULL, NULL, 0 );
+#endif
+#if WPP_PARALLEL_CTU_ROWS
+  if( bCtuRowRateCtrl )
+  {
+    m_pcRateCtrl->getRCPic()->mergeCtuRows( pcSlice->getSliceType() == I_SLICE ? 0 : m_pcCfg->getLCULevelRC() );
+  }
+#endif
 
   // store context state at the end of this slice-segment, in case the next slice is a dependent slice and continues using the CABAC contexts.
   if( pcSlice->getPPS()->getDependentSliceSegmentsEnabledFlag() )
@@ -1103,6 +1216,681 @@ Void TEncSlice::compressSlice( TComPic* pcPic, const Bool bCompressEntireSlice,
   //}
 }
 
+#if WPP_PARALLEL_CTU_ROWS
+/** The CTU rows of the slice segment can be compressed concurrently when each of them starts at the left
+ *  picture boundary from the contexts of the row above, and nothing decided inside the row depends on the
+ *  bits of the CTUs coded before it in other rows (byte limited slices; CTU level rate control only on the
+ *  bits of the row, see xUseCtuRowRateCtrl).
+ */
+Bool TEncSlice::xUseCtuRowWorkers( TComPic* pcPic, TComSlice* pcSlice, const UInt startCtuTsAddr, const UInt boundingCtuTsAddr )
+{
+  const UInt frameWidthInCtus = pcPic->getPicSym()->getFrameWidthInCtus();
+
+  if( m_iNumCtuWorkers < 2 || m_pcCfg->getWppThreads() < 2 || !m_pcCfg->getWaveFrontsynchro() )
+  {
+    return false;
+  }
+  if( !xCanUseCtuWorkers( pcPic, pcSlice ) && !xUseCtuRowRateCtrl( pcPic, pcSlice, startCtuTsAddr ) )
+  {
+    return false;
+  }
+  if( pcPic->getPicSym()->getNumTiles() > 1 || pcSlice->getDependentSliceSegmentFlag() || startCtuTsAddr % frameWidthInCtus != 0 )
+  {
+    return false;
+  }
+  return boundingCtuTsAddr > startCtuTsAddr + frameWidthInCtus;
+}
+
+/// the CTUs of the slice do not depend on the bits of the CTUs compressed before them
+Bool TEncSlice::xCanUseCtuWorkers( TComPic* pcPic, TComSlice* pcSlice )
+{
+  if( pcSlice->getSliceMode() == FIXED_NUMBER_OF_BYTES || pcSlice->getSliceSegmentMode() == FIXED_NUMBER_OF_BYTES )
+  {
+    return false;
+  }
+  return !m_pcCfg->getUseRateCtrl() || ( pcPic->getSlice( 0 )->getSliceType() == I_SLICE && m_pcCfg->getForceIntraQP() ) || !m_pcCfg->getLCULevelRC();
+}
+
+/** With WppRateCtrlRows, CTU level rate control of a WaveFrontSynchro slice shares the bits of the slice
+ *  between its CTU rows (TEncRCPic::initCtuRows) whatever the number of WppThreads, so the rows can be
+ *  compressed concurrently with the same result as the serial loop. It needs rows that start at the left
+ *  picture boundary. Otherwise the CTUs take their bits from the picture as before, and the rows stay serial.
+ */
+Bool TEncSlice::xUseCtuRowRateCtrl( TComPic* pcPic, TComSlice* pcSlice, const UInt startCtuTsAddr )
+{
+  if( !m_pcCfg->getWppRateCtrlRows() )
+  {
+    return false;
+  }
+  if( !m_pcCfg->getUseRateCtrl() || !m_pcCfg->getLCULevelRC() || ( pcPic->getSlice( 0 )->getSliceType() == I_SLICE && m_pcCfg->getForceIntraQP() ) )
+  {
+    return false;
+  }
+  if( !m_pcCfg->getWaveFrontsynchro() || pcSlice->getSliceMode() == FIXED_NUMBER_OF_BYTES || pcSlice->getSliceSegmentMode() == FIXED_NUMBER_OF_BYTES )
+  {
+    return false;
+  }
+  return pcPic->getPicSym()->getNumTiles() == 1 && !pcSlice->getDependentSliceSegmentFlag() && startCtuTsAddr % pcPic->getPicSym()->getFrameWidthInCtus() == 0;
+}
+
+/** Estimates the lambda and QP of a CTU from the bits left to its CTU row, as the serial loop of
+ *  compressSlice from the bits left to the picture, and sets the lambda to pcRdCost and pcTrQuant.
+ */
+Int TEncSlice::xEstimateCtuRowQP( TComPic* pcPic, TComSlice* pcSlice, const UInt ctuRsAddr, TComRdCost* pcRdCost, TComTrQuant* pcTrQuant )
+{
+  TEncRCPic* pcRCPic = m_pcRateCtrl->getRCPic();
+  Int    estQP       = pcSlice->getSliceQp();
+  Double estLambda   = -1.0;
+  Double bpp         = pcRCPic->getLCUTargetBpp( pcSlice->getSliceType(), ctuRsAddr );
+
+  if ( pcPic->getSlice( 0 )->getSliceType() == I_SLICE )
+  {
+    estLambda = pcRCPic->getLCUEstLambdaAndQP( bpp, pcSlice->getSliceQp(), &estQP, ctuRsAddr );
+  }
+  else
+  {
+    estLambda = pcRCPic->getLCUEstLambda( bpp, ctuRsAddr );
+    estQP     = pcRCPic->getLCUEstQP    ( estLambda, pcSlice->getSliceQp(), ctuRsAddr );
+  }
+
+  estQP = Clip3( -pcSlice->getSPS()->getQpBDOffset(CHANNEL_TYPE_LUMA), MAX_QP, estQP );
+
+  pcRdCost->setLambda( estLambda, pcSlice->getSPS()->getBitDepths() );
+#if RDOQ_CHROMA_LAMBDA
+  const Double chromaLambda = estLambda / pcRdCost->getChromaWeight();
+  const Double lambdaArray[MAX_NUM_COMPONENT] = { estLambda, chromaLambda, chromaLambda };
+  pcTrQuant->setLambdas( lambdaArray );
+#else
+  pcTrQuant->setLambda( estLambda );
+#endif
+  return estQP;
+}
+
+/** Hands the state of the slice encoder to the CTU workers: RD cost, lambdas, entropy coder statistics
+ *  and the slice contexts, and clears the statistics they gather over the slice.
+ */
+Void TEncSlice::xPrepareCtuWorkers( TComSlice* pcSlice, const Bool bFastDeltaQP )
+{
+  // the QP of the CTUs is the slice QP here, or set per CTU by xCompressCtuOnWorker (see xUseCtuRowRateCtrl)
+  if( m_pcCfg->getUseRateCtrl() )
+  {
+    m_pcRateCtrl->setRCQP( pcSlice->getSliceQp() );
+#if ADAPTIVE_QP_SELECTION
+    pcSlice->setSliceQpBase( pcSlice->getSliceQp() );
+#endif
+  }
+#if VCEG_AZ07_FRUC_MERGE
+  // the FRUC reference pairs of the slice are derived on first use, not by the workers concurrently
+  if( pcSlice->isInterB() )
+  {
+    pcSlice->getRefIdx4MVPair( REF_PIC_LIST_0, 0 );
+  }
+#endif
+
+  for( Int i = 0; i < m_iNumCtuWorkers; i++ )
+  {
+    xPrepareCtuWorker( m_pcCtuWorkers[i], pcSlice, bFastDeltaQP );
+  }
+}
+
+Void TEncSlice::xPrepareCtuWorker( TEncCtuWorker& rcWorker, TComSlice* pcSlice, const Bool bFastDeltaQP )
+{
+  *rcWorker.getRdCost() = *m_pcRdCost;
+  rcWorker.getTrQuant()->copyLambdas( *m_pcTrQuant );
+#if ADAPTIVE_QP_SELECTION
+  rcWorker.getTrQuant()->clearSliceARLCnt();
+#endif
+#if JVET_C0024_AMAX_BT
+  rcWorker.clearBlkStats();
+#endif
+  rcWorker.getCuEncoder()->setFastDeltaQp( bFastDeltaQP );
+  rcWorker.getCuEncoder()->setCtuRCQP( g_RCInvalidQPValue );
+#if VCEG_AZ07_BAC_ADAPT_WDOW || VCEG_AZ07_INIT_PREVFRAME
+  rcWorker.getEntropyCoder()->setStatsHandle( pcSlice->getStatsHandle() );
+#endif
+  // as for the coders of this encoder: hands the statistics of the slice to the current best coder
+  rcWorker.getEntropyCoder()->setEntropyCoder( rcWorker.getCurrBestSbacCoder() );
+  rcWorker.getEntropyCoder()->resetEntropy( pcSlice );
+#if ALF_HM3_REFACTOR
+  rcWorker.getEntropyCoder()->setAlfCtrl( false );
+  rcWorker.getEntropyCoder()->setMaxAlfCtrlDepth( 0 );
+#endif
+}
+
+/// sets the per thread state of the calling pool thread for compressing CTUs of the slice on pcWorker
+Void TEncSlice::xBeginCtuWorkerTask( TEncCtuWorker* pcWorker, TComPic* pcPic, TComSlice* pcSlice, const ClipParam& rcClipParam )
+{
+  g_ClipParam = rcClipParam;
+  TComSlice::setThreadTextType( pcSlice, pcSlice->getTextType() );
+  TComPic::setThreadCtuScratch( pcPic, pcWorker->getCtuScratch() );
+
+  TEncBinCABAC* pRDSbacCoder = (TEncBinCABAC*)pcWorker->getCurrBestSbacCoder()->getEncBinIf();
+  pRDSbacCoder->setBinCountingEnableFlag( false );
+  pRDSbacCoder->setBinsCoded( 0 );
+}
+
+Void TEncSlice::xEndCtuWorkerTask( TEncCtuWorker* pcWorker )
+{
+  pcWorker->getCurrBestSbacCoder()->setBitstream( NULL );
+  pcWorker->getRDGoOnSbacCoder()->setBitstream( NULL );
+  TComSlice::setThreadTextType( NULL, CHANNEL_TYPE_LUMA );
+  TComPic::setThreadCtuScratch( NULL, NULL );
+}
+
+/** Compresses and encodes one CTU on a worker as the serial loop of compressSlice does, and returns its
+ *  bits. With WaveFrontSynchro a tile row starts from pcSyncIn, the contexts stored to pcSyncOut after the
+ *  second CTU of the tile row above. bInitCtu is false when the CTU was initialized before the tasks started.
+ */
+UInt TEncSlice::xCompressCtuOnWorker( TEncCtuWorker* pcWorker, TComPic* pcPic, TComSlice* pcSlice, const UInt ctuTsAddr, const TEncSbac* pcSyncIn, TEncSbac* pcSyncOut, const Bool bInitCtu )
+{
+  TEncCu*         pcCuEncoder       = pcWorker->getCuEncoder();
+  TEncEntropy*    pcEntropyCoder    = pcWorker->getEntropyCoder();
+  TEncSbac*       pcCurrBestCoder   = pcWorker->getCurrBestSbacCoder();
+  TEncSbac*       pcRDGoOnSbacCoder = pcWorker->getRDGoOnSbacCoder();
+  TEncBinCABAC*   pRDSbacCoder      = (TEncBinCABAC*)pcCurrBestCoder->getEncBinIf();
+  TComBitCounter* pcBitCounter      = pcWorker->getBitCounter();
+  const UInt      frameWidthInCtus  = pcPic->getPicSym()->getFrameWidthInCtus();
+  const UInt      ctuRsAddr         = pcPic->getPicSym()->getCtuTsToRsAddrMap( ctuTsAddr );
+
+  TComDataCU* pCtu = pcPic->getCtu( ctuRsAddr );
+#if ADAPTIVE_QP_SELECTION
+  // the CTUs of the picture share one ARL buffer
+  pCtu->setArlCoeffBuffer( pcWorker->getArlCoeffBuffer(), pcPic->getChromaFormat(), pcSlice->getSPS()->getCTUSize(), pcSlice->getSPS()->getCTUSize() );
+#endif
+  if( bInitCtu )
+  {
+    pCtu->initCtu( pcPic, ctuRsAddr );
+  }
+#if ADAPTIVE_QP_SELECTION
+  else
+  {
+    ::memset( pcWorker->getArlCoeffBuffer(), 0, sizeof( TCoeff ) * pcSlice->getSPS()->getCTUSize() * pcSlice->getSPS()->getCTUSize() * MAX_NUM_COMPONENT );
+  }
+#endif
+
+  const UInt firstCtuRsAddrOfTile = pcPic->getPicSym()->getTComTile( pcPic->getPicSym()->getTileIdxMap( ctuRsAddr ) )->getFirstCtuRsAddr();
+  const UInt tileXPosInCtus       = firstCtuRsAddrOfTile % frameWidthInCtus;
+  const UInt ctuXPosInCtus        = ctuRsAddr % frameWidthInCtus;
+
+  if( ctuRsAddr == firstCtuRsAddrOfTile )
+  {
+    pcCurrBestCoder->resetEntropy( pcSlice );
+  }
+  else if( ctuXPosInCtus == tileXPosInCtus && m_pcCfg->getWaveFrontsynchro() )
+  {
+    pcCurrBestCoder->resetEntropy( pcSlice );
+    if( pCtu->getCtuAbove() && ctuXPosInCtus + 1 < frameWidthInCtus )
+    {
+      TComDataCU* pCtuTR = pcPic->getCtu( ctuRsAddr - frameWidthInCtus + 1 );
+      if( pCtu->CUIsFromSameSliceAndTile( pCtuTR ) )
+      {
+        pcCurrBestCoder->loadContexts( pcSyncIn );
+      }
+    }
+  }
+
+  pcEntropyCoder->setEntropyCoder( pcRDGoOnSbacCoder );
+  pcEntropyCoder->setBitstream( pcBitCounter );
+  pcBitCounter->resetBits();
+
+#if VCEG_AZ07_INIT_PREVFRAME
+  if( pcSlice->getSliceType() != I_SLICE && ctuTsAddr == 0 )
+  {
+    pcCurrBestCoder->loadContextsFromPrev( pcSlice->getStatsHandle(), pcSlice->getSliceType(), pcSlice->getCtxMapQPIdx(), true, pcSlice->getCtxMapQPIdxforStore(), (pcSlice->getPOC() >  pcSlice->getStatsHandle()->m_uiLastIPOC) );
+  }
+#endif
+  pcRDGoOnSbacCoder->load( pcCurrBestCoder );
+  ((TEncBinCABAC*)pcRDGoOnSbacCoder->getEncBinIf())->setBinCountingEnableFlag( true );
+
+  const Bool bCtuRowRateCtrl = m_pcCfg->getUseRateCtrl() && m_pcRateCtrl->getRCPic()->getUseCtuRows();
+  if( bCtuRowRateCtrl )
+  {
+    pcCuEncoder->setCtuRCQP( xEstimateCtuRowQP( pcPic, pcSlice, ctuRsAddr, pcWorker->getRdCost(), pcWorker->getTrQuant() ) );
+  }
+
+  pcCuEncoder->compressCtu( pCtu );
+
+  pcEntropyCoder->setEntropyCoder( pcCurrBestCoder );
+  pcEntropyCoder->setBitstream( pcBitCounter );
+  pRDSbacCoder->setBinCountingEnableFlag( true );
+  pcCurrBestCoder->resetBits();
+  pRDSbacCoder->setBinsCoded( 0 );
+
+#if PIP
+  pcWorker->getPIPCoderState()->encodeTime = true;
+#endif
+  pcCuEncoder->encodeCtu( pCtu );
+#if PIP
+  pcWorker->getPIPCoderState()->encodeTime = false;
+#endif
+  pRDSbacCoder->setBinCountingEnableFlag( false );
+
+  if( ctuXPosInCtus == tileXPosInCtus + 1 && m_pcCfg->getWaveFrontsynchro() )
+  {
+    pcSyncOut->loadContexts( pcCurrBestCoder );
+  }
+
+  if( bCtuRowRateCtrl )
+  {
+    m_pcRateCtrl->getRCPic()->updateCtuRow( ctuRsAddr, pCtu->getTotalBits(), xGetRateCtrlQP( pcPic, pCtu ), pcWorker->getRdCost()->getLambda() );
+  }
+  return pcEntropyCoder->getNumberOfWrittenBits();
+}
+
+/// the QP rate control takes for a compressed CTU: g_RCInvalidQPValue when all of it is skipped
+Int TEncSlice::xGetRateCtrlQP( TComPic* pcPic, TComDataCU* pCtu )
+{
+  for( Int idx = 0; idx < pcPic->getNumPartitionsInCtu(); idx++ )
+  {
+    if( pCtu->getPredictionMode( idx ) != NUMBER_OF_PREDICTION_MODES && !pCtu->isSkipped( idx ) )
+    {
+      return pCtu->getQP( 0 );
+    }
+  }
+  return g_RCInvalidQPValue;
+}
+
+/** Gathers the results of the CTU workers in CTU order, as the serial loop of compressSlice does after
+ *  every CTU, and continues from the contexts of the worker that compressed the last CTU. pcLastWorker is
+ *  NULL when these contexts were loaded already.
+ */
+Void TEncSlice::xFinishCtuWorkers( TComPic* pcPic, TComSlice* pcSlice, const UInt startCtuTsAddr, const UInt boundingCtuTsAddr, const UInt uiBits, TEncCtuWorker* pcLastWorker, const ChannelType eLastTextType )
+{
+  pcSlice->setTextType( eLastTextType );
+  pcSlice->setSliceBits( (UInt)( pcSlice->getSliceBits() + uiBits ) );
+  pcSlice->setSliceSegmentBits( pcSlice->getSliceSegmentBits() + uiBits );
+
+  for( UInt ctuTsAddr = startCtuTsAddr; ctuTsAddr < boundingCtuTsAddr; ctuTsAddr++ )
+  {
+    TComDataCU* pCtu = pcPic->getCtu( pcPic->getPicSym()->getCtuTsToRsAddrMap( ctuTsAddr ) );
+
+    if( m_pcCfg->getUseRateCtrl() && !m_pcRateCtrl->getRCPic()->getUseCtuRows() )
+    {
+      m_pcRateCtrl->getRCPic()->updateAfterCTU( m_pcRateCtrl->getRCPic()->getLCUCoded(), pCtu->getTotalBits(), xGetRateCtrlQP( pcPic, pCtu ), m_pcRdCost->getLambda(),
+                                                pcSlice->getSliceType() == I_SLICE ? 0 : m_pcCfg->getLCULevelRC() );
+    }
+
+    m_uiPicTotalBits += pCtu->getTotalBits();
+    m_dPicRdCost     += pCtu->getTotalCost();
+    m_uiPicDist      += pCtu->getTotalDistortion();
+  }
+
+  for( Int i = 0; i < m_iNumCtuWorkers; i++ )
+  {
+#if ADAPTIVE_QP_SELECTION
+    if( m_pcCfg->getUseAdaptQpSelect() )
+    {
+      m_pcTrQuant->addSliceARLCnt( *m_pcCtuWorkers[i].getTrQuant() );
+    }
+#endif
+#if JVET_C0024_AMAX_BT
+    for( Int k = 0; k < 10; k++ )
+    {
+      m_pcGOPEncoder->getBlkSize()[k] += m_pcCtuWorkers[i].getBlkSize()[k];
+      m_pcGOPEncoder->getNumBlk() [k] += m_pcCtuWorkers[i].getNumBlk()[k];
+    }
+#endif
+  }
+
+  if( pcLastWorker )
+  {
+    const UInt uiMaxIdx = g_aucConvertToBit[pcSlice->getSPS()->getCTUSize()];
+    m_ppppcRDSbacCoder[uiMaxIdx][uiMaxIdx][CI_CURR_BEST]->loadContexts( pcLastWorker->getCurrBestSbacCoder() );
+  }
+}
+
+/** Compresses the CTU rows of the slice segment on the CTU workers, as the serial loop of compressSlice
+ *  does with WaveFrontSynchro. A row starts from the contexts stored after the second CTU of the row above
+ *  and stays behind the row above by the CTUs its prediction reads from there, so every CTU sees the same
+ *  reconstruction and contexts as in the serial loop. The bits, costs and rate control updates are
+ *  gathered in CTU order afterwards.
+ */
+Void TEncSlice::xCompressCtuRows( TComPic* pcPic, TComSlice* pcSlice, const UInt startCtuTsAddr, const UInt boundingCtuTsAddr, const Bool bFastDeltaQP )
+{
+  const UInt frameWidthInCtus = pcPic->getPicSym()->getFrameWidthInCtus();
+  const UInt firstRow         = startCtuTsAddr / frameWidthInCtus;
+  const Int  numRows          = Int( ( boundingCtuTsAddr - 1 ) / frameWidthInCtus - firstRow + 1 );
+
+  // CTUs a row stays behind the row above: one for the above-right neighbours, more when the intra KLT
+  // template search reaches into the CTUs to the right of the row above
+  UInt uiLag = 1;
+#if VCEG_AZ08_INTRA_KLT && VCEG_AZ08_USE_KLT
+  if( pcSlice->getSPS()->getUseIntraKLT() )
+  {
+    uiLag = 1 + ( SEARCHRANGEINTRA - 1 ) / pcSlice->getSPS()->getCTUSize();
+  }
+#endif
+
+  xPrepareCtuWorkers( pcSlice, bFastDeltaQP );
+
+  std::mutex                  cMutex;
+  std::condition_variable     cRowProgress;
+  std::vector<UInt>           ctusDone( numRows, 0 );          ///< compressed CTUs of each row, under cMutex
+  std::vector<TEncCtuWorker*> freeWorkers;                     ///< under cMutex
+  std::vector<UInt>           rowBits( numRows, 0 );
+  ChannelType                 eLastTextType = pcSlice->getTextType();
+  TEncCtuWorker*              pcLastWorker  = NULL;
+  const ClipParam             clipParam     = g_ClipParam;     // per thread, the pool threads take the one of the caller
+
+  for( Int i = m_iNumCtuWorkers - 1; i >= 0; i-- )
+  {
+    freeWorkers.push_back( &m_pcCtuWorkers[i] );
+  }
+
+  m_cCtuWorkerPool.parallelFor( numRows, [&]( Int iRow )
+  {
+    TEncCtuWorker* pcWorker;
+    {
+      std::lock_guard<std::mutex> cLock( cMutex );
+      pcWorker = freeWorkers.back();
+      freeWorkers.pop_back();
+    }
+    xBeginCtuWorkerTask( pcWorker, pcPic, pcSlice, clipParam );
+
+    const UInt ctuRow          = firstRow + iRow;
+    const UInt rowEndCtuTsAddr = std::min( boundingCtuTsAddr, ( ctuRow + 1 ) * frameWidthInCtus );
+
+    for( UInt ctuTsAddr = ctuRow * frameWidthInCtus; ctuTsAddr < rowEndCtuTsAddr; ctuTsAddr++ )
+    {
+      const UInt ctuXPosInCtus = ctuTsAddr % frameWidthInCtus;
+      if( iRow > 0 )
+      {
+        const UInt uiNeeded = std::min( ctuXPosInCtus + uiLag + 1, frameWidthInCtus );
+        std::unique_lock<std::mutex> cLock( cMutex );
+        cRowProgress.wait( cLock, [&]{ return ctusDone[iRow - 1] >= uiNeeded; } );
+      }
+
+      rowBits[iRow] += xCompressCtuOnWorker( pcWorker, pcPic, pcSlice, ctuTsAddr, ctuRow > 0 ? &m_pcRowSyncContextStates[ctuRow - 1] : NULL, &m_pcRowSyncContextStates[ctuRow], true );
+
+      {
+        std::lock_guard<std::mutex> cLock( cMutex );
+        ctusDone[iRow] = ctuXPosInCtus + 1;
+      }
+      cRowProgress.notify_all();
+    }
+
+    if( iRow == numRows - 1 )
+    {
+      // the last row is the last task, the worker is not taken again
+      eLastTextType = pcSlice->getTextType();
+      pcLastWorker  = pcWorker;
+    }
+    xEndCtuWorkerTask( pcWorker );
+    {
+      std::lock_guard<std::mutex> cLock( cMutex );
+      freeWorkers.push_back( pcWorker );
+    }
+  } );
+
+  UInt uiBits = 0;
+  for( Int iRow = 0; iRow < numRows; iRow++ )
+  {
+    uiBits += rowBits[iRow];
+  }
+  xFinishCtuWorkers( pcPic, pcSlice, startCtuTsAddr, boundingCtuTsAddr, uiBits, pcLastWorker, eLastTextType );
+
+  if( m_pcCfg->getUseRateCtrl() && m_pcRateCtrl->getRCPic()->getUseCtuRows() )
+  {
+    // the serial loop leaves the quantizer with the rate control of the last CTU
+    m_pcTrQuant->copyLambdas( *pcLastWorker->getTrQuant() );
+#if ADAPTIVE_QP_SELECTION
+    pcSlice->setSliceQpBase( pcLastWorker->getCuEncoder()->getCtuRCQP() );
+#endif
+  }
+
+  // continue from the last stored second CTU, as after the serial loop
+  for( Int iRow = numRows - 1; iRow >= 0; iRow-- )
+  {
+    if( std::min( boundingCtuTsAddr, ( firstRow + iRow + 1 ) * frameWidthInCtus ) - ( firstRow + iRow ) * frameWidthInCtus >= 2 )
+    {
+      m_entropyCodingSyncContextState.loadContexts( &m_pcRowSyncContextStates[firstRow + iRow] );
+      break;
+    }
+  }
+}
+
+#if TILE_PARALLEL_COMPRESSION
+/** The tiles of the slice can be compressed concurrently when the slice segment covers whole tiles and
+ *  starts its own contexts: a CTU predicts only from its own tile, and the contexts are reset at the first
+ *  CTU of every tile. The KLT template searches read the reconstruction across the tile boundaries.
+ */
+Bool TEncSlice::xUseTileWorkers( TComPic* pcPic, TComSlice* pcSlice, const UInt startCtuTsAddr, const UInt boundingCtuTsAddr )
+{
+  TComPicSym* pcPicSym = pcPic->getPicSym();
+
+  if( m_iNumCtuWorkers < 2 || m_pcCfg->getTileThreads() < 2 || pcPicSym->getNumTiles() < 2 || !xCanUseCtuWorkers( pcPic, pcSlice ) )
+  {
+    return false;
+  }
+  if( pcSlice->getDependentSliceSegmentFlag() )
+  {
+    return false;
+  }
+#if VCEG_AZ08_USE_KLT
+  if( pcSlice->getSPS()->getUseIntraKLT() || pcSlice->getSPS()->getUseInterKLT() )
+  {
+    return false;
+  }
+#elif VCEG_AZ08_KLT_COMMON
+  return false;
+#endif
+  const UInt startCtuRsAddr = pcPicSym->getCtuTsToRsAddrMap( startCtuTsAddr );
+  if( pcPicSym->getTComTile( pcPicSym->getTileIdxMap( startCtuRsAddr ) )->getFirstCtuRsAddr() != startCtuRsAddr )
+  {
+    return false;
+  }
+  if( boundingCtuTsAddr < pcPicSym->getNumberOfCtusInFrame() )
+  {
+    const UInt boundingCtuRsAddr = pcPicSym->getCtuTsToRsAddrMap( boundingCtuTsAddr );
+    if( pcPicSym->getTComTile( pcPicSym->getTileIdxMap( boundingCtuRsAddr ) )->getFirstCtuRsAddr() != boundingCtuRsAddr )
+    {
+      return false;
+    }
+  }
+  return pcPicSym->getTileIdxMap( startCtuRsAddr ) != pcPicSym->getTileIdxMap( pcPicSym->getCtuTsToRsAddrMap( boundingCtuTsAddr - 1 ) );
+}
+
+/** Compresses the tiles of the slice segment on the CTU workers, one tile per task in the CTU order of
+ *  the serial loop of compressSlice, with the wavefront contexts of a tile kept by its worker. The tasks
+ *  are handed out largest tile first, which shortens the tail when there are more tiles than threads.
+ *  The bits, costs and rate control updates are gathered in CTU order afterwards.
+ */
+Void TEncSlice::xCompressTiles( TComPic* pcPic, TComSlice* pcSlice, const UInt startCtuTsAddr, const UInt boundingCtuTsAddr, const Bool bFastDeltaQP )
+{
+  TComPicSym* pcPicSym = pcPic->getPicSym();
+
+  // CTU address of the first CTU of every tile, and the bounding address
+  std::vector<UInt> tileStartCtuTsAddr;
+  for( UInt ctuTsAddr = startCtuTsAddr; ctuTsAddr < boundingCtuTsAddr; ctuTsAddr++ )
+  {
+    const UInt ctuRsAddr = pcPicSym->getCtuTsToRsAddrMap( ctuTsAddr );
+    if( pcPicSym->getTComTile( pcPicSym->getTileIdxMap( ctuRsAddr ) )->getFirstCtuRsAddr() == ctuRsAddr )
+    {
+      tileStartCtuTsAddr.push_back( ctuTsAddr );
+    }
+  }
+  const Int numTiles = Int( tileStartCtuTsAddr.size() );
+  tileStartCtuTsAddr.push_back( boundingCtuTsAddr );
+
+  // the uniform spacing leaves the last tile rows and columns up to one CTU larger
+  std::vector<Int> taskTiles( numTiles );
+  for( Int iTile = 0; iTile < numTiles; iTile++ )
+  {
+    taskTiles[iTile] = iTile;
+  }
+  std::stable_sort( taskTiles.begin(), taskTiles.end(), [&]( Int a, Int b )
+  {
+    return tileStartCtuTsAddr[a + 1] - tileStartCtuTsAddr[a] > tileStartCtuTsAddr[b + 1] - tileStartCtuTsAddr[b];
+  } );
+
+  // the slice and tile checks of a CTU read the neighbouring CTUs of the other tiles, so all the CTUs are
+  // initialized before the tiles are compressed
+  for( UInt ctuTsAddr = startCtuTsAddr; ctuTsAddr < boundingCtuTsAddr; ctuTsAddr++ )
+  {
+    const UInt ctuRsAddr = pcPicSym->getCtuTsToRsAddrMap( ctuTsAddr );
+    pcPic->getCtu( ctuRsAddr )->initCtu( pcPic, ctuRsAddr );
+  }
+
+  xPrepareCtuWorkers( pcSlice, bFastDeltaQP );
+
+  std::mutex                  cMutex;
+  std::vector<TEncCtuWorker*> freeWorkers;                     ///< under cMutex
+  std::vector<UInt>           tileBits( numTiles, 0 );
+  ChannelType                 eLastTextType = pcSlice->getTextType();
+  const ClipParam             clipParam     = g_ClipParam;
+  const UInt                  uiMaxIdx      = g_aucConvertToBit[pcSlice->getSPS()->getCTUSize()];
+
+  for( Int i = m_iNumCtuWorkers - 1; i >= 0; i-- )
+  {
+    freeWorkers.push_back( &m_pcCtuWorkers[i] );
+  }
+
+  m_cCtuWorkerPool.parallelFor( numTiles, [&]( Int iTask )
+  {
+    const Int      iTile = taskTiles[iTask];
+    TEncCtuWorker* pcWorker;
+    {
+      std::lock_guard<std::mutex> cLock( cMutex );
+      pcWorker = freeWorkers.back();
+      freeWorkers.pop_back();
+    }
+    xBeginCtuWorkerTask( pcWorker, pcPic, pcSlice, clipParam );
+
+    for( UInt ctuTsAddr = tileStartCtuTsAddr[iTile]; ctuTsAddr < tileStartCtuTsAddr[iTile + 1]; ctuTsAddr++ )
+    {
+      tileBits[iTile] += xCompressCtuOnWorker( pcWorker, pcPic, pcSlice, ctuTsAddr, pcWorker->getSyncContextState(), pcWorker->getSyncContextState(), false );
+    }
+
+    if( iTile == numTiles - 1 )
+    {
+      // the worker may take another tile, so its contexts are kept before it is released
+      eLastTextType = pcSlice->getTextType();
+      m_ppppcRDSbacCoder[uiMaxIdx][uiMaxIdx][CI_CURR_BEST]->loadContexts( pcWorker->getCurrBestSbacCoder() );
+      if( m_pcCfg->getWaveFrontsynchro() )
+      {
+        m_entropyCodingSyncContextState.loadContexts( pcWorker->getSyncContextState() );
+      }
+    }
+    xEndCtuWorkerTask( pcWorker );
+    {
+      std::lock_guard<std::mutex> cLock( cMutex );
+      freeWorkers.push_back( pcWorker );
+    }
+  } );
+
+  UInt uiBits = 0;
+  for( Int iTile = 0; iTile < numTiles; iTile++ )
+  {
+    uiBits += tileBits[iTile];
+  }
+  xFinishCtuWorkers( pcPic, pcSlice, startCtuTsAddr, boundingCtuTsAddr, uiBits, NULL, eLastTextType );
+}
+#endif
+
+#if FRAME_PARALLEL_GOP
+/** Runs the part of compressSlice before the CTU loop for a picture set up by initEncSlice and the GOP
+ *  encoder, and keeps the RD cost and clipping state of its slice for compressQueuedPictures. The slice
+ *  encoder may set up further pictures before they are compressed.
+ */
+Void TEncSlice::queuePicture( TComPic* pcPic )
+{
+  TComSlice* const pcSlice = pcPic->getSlice( getSliceIdx() );
+  QueuedPicture    cQueued;
+
+  pcSlice->setSliceSegmentBits( 0 );
+  xDetermineStartAndBoundingCtuTsAddr( cQueued.startCtuTsAddr, cQueued.boundingCtuTsAddr, pcPic );
+#if VCEG_AZ08_KLT_COMMON
+  pcPic->getPicYuvRec()->fillPicRecBoundary( pcSlice->getSPS()->getBitDepths() );
+#endif
+  xInitSliceTools( pcSlice );
+
+  cQueued.pcPic      = pcPic;
+  cQueued.cRdCost    = *m_pcRdCost;
+  cQueued.cClipParam = g_ClipParam;
+  m_cQueuedPictures.push_back( cQueued );
+}
+
+/** Compresses the queued pictures concurrently, each of them on one CTU worker in the CTU order of the
+ *  serial loop of compressSlice. The pictures must not reference each other, and their slices must not
+ *  depend on the bits of the slices compressed before them (see TEncGOP::xGetFrameWaves). The AMaxBT
+ *  statistics are gathered in queue order afterwards.
+ */
+Void TEncSlice::compressQueuedPictures()
+{
+  const Int                   numPictures = Int( m_cQueuedPictures.size() );
+  std::mutex                  cMutex;
+  std::vector<TEncCtuWorker*> freeWorkers;                     ///< under cMutex
+
+  for( Int i = m_iNumCtuWorkers - 1; i >= 0; i-- )
+  {
+    freeWorkers.push_back( &m_pcCtuWorkers[i] );
+  }
+
+  m_cCtuWorkerPool.parallelFor( numPictures, [&]( Int iPic )
+  {
+    QueuedPicture&   rcQueued = m_cQueuedPictures[iPic];
+    TComPic* const   pcPic    = rcQueued.pcPic;
+    TComSlice* const pcSlice  = pcPic->getSlice( 0 );
+    TEncCtuWorker*   pcWorker;
+    {
+      std::lock_guard<std::mutex> cLock( cMutex );
+      pcWorker = freeWorkers.back();
+      freeWorkers.pop_back();
+    }
+
+    // the slice encoder holds the state of the last picture set up, the worker takes the one of its picture
+    xPrepareCtuWorker( *pcWorker, pcSlice, false );
+    *pcWorker->getRdCost() = rcQueued.cRdCost;
+#if RDOQ_CHROMA_LAMBDA
+    pcWorker->getTrQuant()->setLambdas( pcSlice->getLambdas() );
+#else
+    pcWorker->getTrQuant()->setLambda( pcSlice->getLambdas()[0] );
+#endif
+    if( m_pcCfg->getUseASR() )
+    {
+      xSetSearchRange( pcWorker->getPredSearch(), pcSlice );
+    }
+    xBeginCtuWorkerTask( pcWorker, pcPic, pcSlice, rcQueued.cClipParam );
+    pcPic->setPicYuvPred( pcWorker->getPicYuvPred() );
+
+    UInt uiBits = 0;
+    for( UInt ctuTsAddr = rcQueued.startCtuTsAddr; ctuTsAddr < rcQueued.boundingCtuTsAddr; ctuTsAddr++ )
+    {
+      uiBits += xCompressCtuOnWorker( pcWorker, pcPic, pcSlice, ctuTsAddr, pcWorker->getSyncContextState(), pcWorker->getSyncContextState(), true );
+    }
+    const ChannelType eLastTextType = pcSlice->getTextType();
+
+#if JVET_C0024_AMAX_BT
+    ::memcpy( rcQueued.auiBlkSize, pcWorker->getBlkSize(), sizeof( rcQueued.auiBlkSize ) );
+    ::memcpy( rcQueued.auiNumBlk,  pcWorker->getNumBlk(),  sizeof( rcQueued.auiNumBlk  ) );
+#endif
+    pcPic->setPicYuvPred( m_apcPicYuvPred );
+    xEndCtuWorkerTask( pcWorker );
+    {
+      std::lock_guard<std::mutex> cLock( cMutex );
+      freeWorkers.push_back( pcWorker );
+    }
+
+    pcSlice->setTextType( eLastTextType );
+    pcSlice->setSliceBits( (UInt)( pcSlice->getSliceBits() + uiBits ) );
+    pcSlice->setSliceSegmentBits( pcSlice->getSliceSegmentBits() + uiBits );
+  } );
+
+#if JVET_C0024_AMAX_BT
+  for( Int iPic = 0; iPic < numPictures; iPic++ )
+  {
+    for( Int k = 0; k < 10; k++ )
+    {
+      m_pcGOPEncoder->getBlkSize()[k] += m_cQueuedPictures[iPic].auiBlkSize[k];
+      m_pcGOPEncoder->getNumBlk() [k] += m_cQueuedPictures[iPic].auiNumBlk[k];
+    }
+  }
+#endif
+  m_cQueuedPictures.clear();
+}
+#endif
+#endif
+
 Void TEncSlice::encodeSlice   ( TComPic* pcPic, TComOutputBitstream* pcSubstreams, UInt &numBinsCoded 
 #if ALF_HM3_REFACTOR
   , ALFParam & alfParam
@@ -1611,11 +2399,4 @@ Void TEncSlice::xGenUpdateMap (UInt uiSliceType, Int iQP,  TComStats* apcStats)
 
 }
 #endif
-
-#if VCEG_AZ08_INTER_KLT
-Void TEncSlice::InterpolatePic(TComPic* pcPic)
-{
-    m_pcPredSearch->interpolatePic(pcPic);
-}
-#endif
 //! \}
\ No newline at end of file
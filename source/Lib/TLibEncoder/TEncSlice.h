@@ -46,6 +46,10 @@
 #include "TEncCu.h"
 #include "WeightPredAnalysis.h"
 #include "TEncRateCtrl.h"
+#if WPP_PARALLEL_CTU_ROWS
+#include "TLibCommon/TComThreadPool.h"
+#include "TEncCtuWorker.h"
+#endif
 
 //! \ingroup TLibEncoder
 //! \{
@@ -81,6 +85,9 @@ private:
   TEncEntropy*            m_pcEntropyCoder;                     ///< entropy encoder
   TEncSbac*               m_pcSbacCoder;                        ///< SBAC encoder
   TEncBinCABAC*           m_pcBinCABAC;                         ///< Bin encoder CABAC  
+#if PIP
+  TComPIPCoderState*      m_pcPIPCoderState;                    ///< PIP flags of the coders of the encoder (CTU workers have their own)
+#endif
 
   
 #if !PIP
@@ -108,6 +115,31 @@ private:
 #if PARALLEL_ENCODING_RAS_CABAC_INIT_PRESENT  
   NalUnitType             m_eLastNALUType;
 #endif
+#if WPP_PARALLEL_CTU_ROWS
+  TEncCtuWorker*          m_pcCtuWorkers;                       ///< coding objects of the CTU row and tile threads (owned by TEncTop)
+  Int                     m_iNumCtuWorkers;
+  TComThreadPool          m_cCtuWorkerPool;                     ///< threads compressing the CTU rows of a WPP slice or the tiles of a slice
+  TEncSbac*               m_pcRowSyncContextStates;             ///< state of the contexts after the second CTU of each CTU row
+#endif
+#if QTBT_PARALLEL_SPLIT
+  TComThreadPool          m_cSplitTaskPool;                     ///< threads compressing the split candidates of a CU on the first two CTU workers
+#endif
+#if FRAME_PARALLEL_GOP
+  /// picture waiting for compressQueuedPictures, with the state of the slice encoder after its set up
+  struct QueuedPicture
+  {
+    TComPic*              pcPic;
+    UInt                  startCtuTsAddr;
+    UInt                  boundingCtuTsAddr;
+    TComRdCost            cRdCost;                              ///< lambda and distortion weights of the slice
+    ClipParam             cClipParam;
+#if JVET_C0024_AMAX_BT
+    UInt                  auiBlkSize[10];                       ///< AMaxBT statistics of the picture
+    UInt                  auiNumBlk[10];
+#endif
+  };
+  std::vector<QueuedPicture> m_cQueuedPictures;
+#endif
 
   Void     setUpLambda(TComSlice* slice, const Double dLambda, Int iQP);
   Void     calculateBoundingCtuTsAddrForSlice(UInt &startCtuTSAddrSlice, UInt &boundingCtuTSAddrSlice, Bool &haveReachedTileBoundary, TComPic* pcPic, const Int sliceMode, const Int sliceArgument);
@@ -146,6 +178,12 @@ public:
 #endif
     );
 
+#if FRAME_PARALLEL_GOP
+  // compress several pictures of a GOP concurrently, each of them set up by initEncSlice and the GOP encoder before
+  Void    queuePicture            ( TComPic* pcPic );                                   ///< analysis stage of the slice before its CTUs
+  Void    compressQueuedPictures  ();                                                   ///< compresses the queued pictures on the CTU workers
+#endif
+
   // misc. functions
   Void    setSearchRange      ( TComSlice* pcSlice  );                                  ///< set ME range adaptively
 
@@ -168,11 +206,28 @@ public:
   Void xContextWdowSizeUpdateDecision (TEncSbac* pTestEncSbac, UInt &uiCtxStartPos, ContextModel* pSliceCtx, Bool *uiCtxMap, UChar *uiCtxCodeIdx, Bool** pCodedBinStr, Int* pCounter);
 #endif
 #endif
-#if VCEG_AZ08_INTER_KLT
-  Void   InterpolatePic(TComPic* pcPic);
-#endif
 private:
   Double  xGetQPValueAccordingToLambda ( Double lambda );
+  Void    xSetSearchRange     ( TEncSearch* pcPredSearch, TComSlice* pcSlice );
+  Void    xInitSliceTools     ( TComSlice* pcSlice );
+#if WPP_PARALLEL_CTU_ROWS
+  Bool    xCanUseCtuWorkers   ( TComPic* pcPic, TComSlice* pcSlice );
+  Bool    xUseCtuRowRateCtrl  ( TComPic* pcPic, TComSlice* pcSlice, const UInt startCtuTsAddr );
+  Int     xEstimateCtuRowQP   ( TComPic* pcPic, TComSlice* pcSlice, const UInt ctuRsAddr, TComRdCost* pcRdCost, TComTrQuant* pcTrQuant );
+  Void    xPrepareCtuWorkers  ( TComSlice* pcSlice, const Bool bFastDeltaQP );
+  Void    xPrepareCtuWorker   ( TEncCtuWorker& rcWorker, TComSlice* pcSlice, const Bool bFastDeltaQP );
+  Void    xBeginCtuWorkerTask ( TEncCtuWorker* pcWorker, TComPic* pcPic, TComSlice* pcSlice, const ClipParam& rcClipParam );
+  Void    xEndCtuWorkerTask   ( TEncCtuWorker* pcWorker );
+  UInt    xCompressCtuOnWorker( TEncCtuWorker* pcWorker, TComPic* pcPic, TComSlice* pcSlice, const UInt ctuTsAddr, const TEncSbac* pcSyncIn, TEncSbac* pcSyncOut, const Bool bInitCtu );
+  Int     xGetRateCtrlQP      ( TComPic* pcPic, TComDataCU* pCtu );
+  Void    xFinishCtuWorkers   ( TComPic* pcPic, TComSlice* pcSlice, const UInt startCtuTsAddr, const UInt boundingCtuTsAddr, const UInt uiBits, TEncCtuWorker* pcLastWorker, const ChannelType eLastTextType );
+  Bool    xUseCtuRowWorkers   ( TComPic* pcPic, TComSlice* pcSlice, const UInt startCtuTsAddr, const UInt boundingCtuTsAddr );
+  Void    xCompressCtuRows    ( TComPic* pcPic, TComSlice* pcSlice, const UInt startCtuTsAddr, const UInt boundingCtuTsAddr, const Bool bFastDeltaQP );
+#if TILE_PARALLEL_COMPRESSION
+  Bool    xUseTileWorkers     ( TComPic* pcPic, TComSlice* pcSlice, const UInt startCtuTsAddr, const UInt boundingCtuTsAddr );
+  Void    xCompressTiles      ( TComPic* pcPic, TComSlice* pcSlice, const UInt startCtuTsAddr, const UInt boundingCtuTsAddr, const Bool bFastDeltaQP );
+#endif
+#endif
 };
 
 //! \}
@@ -42,6 +42,9 @@
 #if FAST_BIT_EST
 #include "TLibCommon/ContextModel.h"
 #endif
+#if PIP
+#include <mutex>
+#endif
 
 //! \ingroup TLibEncoder
 //! \{
@@ -63,6 +66,11 @@ TEncTop::TEncTop()
   m_pppcBinCoderCABAC =  NULL;
 #endif
   m_cRDGoOnSbacCoder.init( &m_cRDGoOnBinCoderCABAC );
+#if WPP_PARALLEL_CTU_ROWS
+  m_pcCtuWorkers      = NULL;
+  m_iNumCtuWorkers    = 0;
+  m_iNumCtuThreads    = 0;
+#endif
 #if ENC_DEC_TRACE
   if (g_hTrace == NULL)
   {
@@ -186,6 +194,49 @@ Void TEncTop::create ()
   }
 #endif
 
+#if WPP_PARALLEL_CTU_ROWS
+  // one worker per thread: a CTU row, a tile or a picture is compressed by any free worker
+  Int iNumThreads = m_iWaveFrontSynchro ? m_iWppThreads : 1;
+#if TILE_PARALLEL_COMPRESSION
+  if( m_iNumColumnsMinus1 > 0 || m_iNumRowsMinus1 > 0 )
+  {
+    iNumThreads = std::max( iNumThreads, m_iTileThreads );
+  }
+#endif
+#if FRAME_PARALLEL_GOP
+  iNumThreads = std::max( iNumThreads, m_iFrameThreads );
+#endif
+  m_iNumCtuThreads = iNumThreads;
+#if QTBT_PARALLEL_SPLIT
+  // the split candidates BT-V and QT of a CU are compressed on the first two workers
+  if( m_iSplitThreads > 1 )
+  {
+    iNumThreads = std::max( iNumThreads, 2 );
+  }
+#endif
+  if( iNumThreads > 1 )
+  {
+    m_iNumCtuWorkers = iNumThreads;
+    m_pcCtuWorkers   = new TEncCtuWorker[m_iNumCtuWorkers];
+    for( Int i = 0; i < m_iNumCtuWorkers; i++ )
+    {
+      m_pcCtuWorkers[i].create( m_maxTotalCUDepth, m_CTUSize, m_chromaFormatIDC );
+#if FRAME_PARALLEL_GOP
+      if( m_iFrameThreads > 1 )
+      {
+        m_pcCtuWorkers[i].createPicYuvPred( getSourceWidth(), getSourceHeight(), m_chromaFormatIDC, m_CTUSize, m_CTUSize, m_maxTotalCUDepth );
+      }
+#endif
+#if QTBT_PARALLEL_SPLIT
+      if( m_iSplitThreads > 1 && i < 2 )
+      {
+        m_pcCtuWorkers[i].createSplitTaskBuffers( getSourceWidth(), getSourceHeight(), m_chromaFormatIDC, m_CTUSize, m_maxTotalCUDepth );
+      }
+#endif
+    }
+  }
+#endif
+
 #if ALF_HM3_REFACTOR
   if( m_useALF )
   {
@@ -234,6 +285,12 @@ Void TEncTop::destroy ()
   m_cLoopFilter.        destroy();
   m_cRateCtrl.          destroy();
   m_cSearch.            destroy();
+#if WPP_PARALLEL_CTU_ROWS
+  delete[] m_pcCtuWorkers;
+  m_pcCtuWorkers   = NULL;
+  m_iNumCtuWorkers = 0;
+  m_iNumCtuThreads = 0;
+#endif
 #if ALF_HM3_REFACTOR
   if(m_useALF)
   {
@@ -301,6 +358,56 @@ Void TEncTop::init(Bool isFieldCoding)
 
   xInitPPSforTiles();
 
+#if PIP
+  // hand the PIP state of this encoder to the search and the entropy coders
+#if WPP_PARALLEL_CTU_ROWS
+  m_cPIPContext.createThreadStats( m_iNumCtuWorkers + 1 );  // set 0 for this encoder, set i+1 for CTU worker i
+#endif
+#if SRDOQ_INCREMENTAL
+  m_cPIPContext.setFastRateEst( m_PIPFastRateEst );
+#endif
+#if PIP_R1_HT_BINARIZATION
+  m_cPIPContext.setR1HighThroughput( m_PIPR1HighThroughput );
+#endif
+  m_cPIPContext.setCodebookDir( m_PIPCodebookDir );
+  if( !m_PIPCodebookFile.empty() && !m_cPIPContext.openCodebookFile( m_PIPCodebookFile ) )
+  {
+    fprintf( stderr, "Unable to map the PIP codebook file `%s'\n", m_PIPCodebookFile.c_str() );
+    exit( EXIT_FAILURE );
+  }
+  m_cSearch.setPIPContext( &m_cPIPContext );
+  m_cSearch.setPIPCoderState( &m_cPIPCoderState );
+  m_cEntropyCoder.setPIPCoderState( &m_cPIPCoderState );
+  m_cSbacCoder.setPIPContext( &m_cPIPContext );
+  m_cSbacCoder.setPIPCoderState( &m_cPIPCoderState );
+  m_cRDGoOnSbacCoder.setPIPContext( &m_cPIPContext );
+  m_cRDGoOnSbacCoder.setPIPCoderState( &m_cPIPCoderState );
+#if JVET_C0024_QTBT
+  const UInt uiNumWidthIdx  = g_aucConvertToBit[m_CTUSize] + 1;
+  const UInt uiNumHeightIdx = g_aucConvertToBit[m_CTUSize] + 1;
+  for( UInt w = 0; w < uiNumWidthIdx; w++ )
+  {
+    for( UInt h = 0; h < uiNumHeightIdx; h++ )
+    {
+      for( Int iCIIdx = 0; iCIIdx < CI_NUM; iCIIdx++ )
+      {
+        m_ppppcRDSbacCoder[w][h][iCIIdx]->setPIPContext( &m_cPIPContext );
+        m_ppppcRDSbacCoder[w][h][iCIIdx]->setPIPCoderState( &m_cPIPCoderState );
+      }
+    }
+  }
+#else
+  for( Int iDepth = 0; iDepth < m_maxTotalCUDepth + 1; iDepth++ )
+  {
+    for( Int iCIIdx = 0; iCIIdx < CI_NUM; iCIIdx++ )
+    {
+      m_pppcRDSbacCoder[iDepth][iCIIdx]->setPIPContext( &m_cPIPContext );
+      m_pppcRDSbacCoder[iDepth][iCIIdx]->setPIPCoderState( &m_cPIPCoderState );
+    }
+  }
+#endif
+#endif
+
   // initialize processing unit classes
   m_cGOPEncoder.  init( this );
   m_cSliceEncoder.init( this );
@@ -328,6 +435,9 @@ Void TEncTop::init(Bool isFieldCoding)
                   ,m_bUseAdaptQpSelect
 #endif
                   );
+#if VCEG_AZ08_KLT_COMMON && KLT_DETERMINISTIC_BASIS
+  m_cTrQuant.setDeterministicKLTBasis( m_KLTDeterministicBasis );
+#endif
 
   // initialize encoder search class
 #if JVET_C0024_QTBT
@@ -336,9 +446,17 @@ Void TEncTop::init(Bool isFieldCoding)
   m_cSearch.init( this, &m_cTrQuant, m_iSearchRange, m_bipredSearchRange, m_iFastSearch, m_maxCUWidth, m_maxCUHeight, m_maxTotalCUDepth, &m_cEntropyCoder, &m_cRdCost, getRDSbacCoder(), getRDGoOnSbacCoder() );
 #endif
 
+#if PIP_PARALLEL_PRED
+  // the CTU workers only run while this search is idle, so it has all the PIP threads
+  m_cSearch.setPIPThreads( m_PIPThreads );
+#endif
+
   m_iMaxRefPicNum = 0;
 
   xInitScalingLists();
+#if WPP_PARALLEL_CTU_ROWS
+  xInitCtuWorkers();
+#endif
 }
 
 Void TEncTop::xInitScalingLists()
@@ -402,6 +520,79 @@ Void TEncTop::xInitScalingLists()
   }
 }
 
+#if WPP_PARALLEL_CTU_ROWS
+Void TEncTop::xInitCtuWorkers()
+{
+  const Int maxLog2TrDynamicRange[MAX_NUM_CHANNEL_TYPE] =
+  {
+      m_cSPS.getMaxLog2TrDynamicRange(CHANNEL_TYPE_LUMA),
+      m_cSPS.getMaxLog2TrDynamicRange(CHANNEL_TYPE_CHROMA)
+  };
+
+#if PIP_PARALLEL_PRED
+  // the workers search concurrently, so they share the PIP threads instead of multiplying them
+  Int iNumConcurrentWorkers = m_iNumCtuThreads;
+#if QTBT_PARALLEL_SPLIT
+  iNumConcurrentWorkers = std::max( iNumConcurrentWorkers, std::min( m_iSplitThreads, 2 ) );
+#endif
+  const Int iWorkerPIPThreads = std::max( 1, m_PIPThreads / std::max( 1, iNumConcurrentWorkers ) );
+#endif
+
+  for( Int i = 0; i < m_iNumCtuWorkers; i++ )
+  {
+    TEncCtuWorker& rcWorker = m_pcCtuWorkers[i];
+#if PIP
+    rcWorker.setPIPContext( &m_cPIPContext, i + 1 );
+#endif
+
+    // the same set-up as the transform and the search of this encoder
+    TComTrQuant* pcTrQuant = rcWorker.getTrQuant();
+    pcTrQuant->init( m_cSPS.getCTUSize(),
+#if VCEG_AZ08_USE_KLT
+                     m_useKLT,
+#endif
+                     m_useRDOQ,
+                     m_useRDOQTS,
+#if T0196_SELECTIVE_RDOQ
+                     m_useSelectiveRDOQ,
+#endif
+                     true
+                    ,m_useTransformSkipFast
+#if ADAPTIVE_QP_SELECTION
+                    ,m_bUseAdaptQpSelect
+#endif
+                    );
+#if VCEG_AZ08_INTER_KLT
+    pcTrQuant->setSubPelCacheSlot( i + 1 );
+#endif
+#if VCEG_AZ08_KLT_COMMON && KLT_DETERMINISTIC_BASIS
+    pcTrQuant->setDeterministicKLTBasis( m_KLTDeterministicBasis );
+#endif
+    if( getUseScalingListId() == SCALING_LIST_OFF )
+    {
+      pcTrQuant->setFlatScalingList( maxLog2TrDynamicRange, m_cSPS.getBitDepths() );
+      pcTrQuant->setUseScalingList( false );
+    }
+    else
+    {
+      pcTrQuant->setScalingList( &(m_cSPS.getScalingList()), maxLog2TrDynamicRange, m_cSPS.getBitDepths() );
+      pcTrQuant->setUseScalingList( true );
+    }
+
+    rcWorker.getPredSearch()->init( this, pcTrQuant, m_iSearchRange, m_bipredSearchRange, m_iFastSearch, m_CTUSize, m_CTUSize, m_maxTotalCUDepth,
+                                    rcWorker.getEntropyCoder(), rcWorker.getRdCost(), rcWorker.getRDSbacCoder(), rcWorker.getRDGoOnSbacCoder() );
+#if PIP_PARALLEL_PRED
+    rcWorker.getPredSearch()->setPIPThreads( iWorkerPIPThreads );
+#endif
+    rcWorker.getCuEncoder()->init( this, rcWorker.getPredSearch(), pcTrQuant, rcWorker.getRdCost(), rcWorker.getEntropyCoder(),
+                                   rcWorker.getRDSbacCoder(), rcWorker.getRDGoOnSbacCoder(), i + 1 );
+#if JVET_C0024_AMAX_BT
+    rcWorker.getCuEncoder()->setBlkStats( rcWorker.getBlkSize(), rcWorker.getNumBlk() );
+#endif
+  }
+}
+#endif
+
 // ====================================================================================================================
 // Public member functions
 // ====================================================================================================================
@@ -473,7 +664,12 @@ Void TEncTop::encode( Bool flush, TComPicYuv* pcPicYuvOrg, TComPicYuv* pcPicYuvT
   UInt base = log2((UInt)CUMAX) - 1, w, h;
   if (!iNumEncoded)
   {
-	  Char commonIn[100], commonOut[100], buf[20];
+	  // the codebook names are built in process globals (CBiter, InputFileName, InAddr, OutAddr), which the
+	  // encoders of the parallel segments set one at a time
+	  static std::mutex s_cCodebookNameMutex;
+	  std::lock_guard<std::mutex> cCodebookNameLock(s_cCodebookNameMutex);
+
+	  Char commonIn[512], commonOut[512], buf[20];
 	  CBloopEnable = CBiter > 0; // for the first iteration we use the iTQ codebook (read from the txt file)
 	  if (!CBloopEnable && txtWrite)
 	  {
@@ -486,9 +682,10 @@ Void TEncTop::encode( Bool flush, TComPicYuv* pcPicYuvOrg, TComPicYuv* pcPicYuvT
 		  fclose(minresFile);
 	  }
 
+	  Int spQ = 20;
 	  if (m_iQP == 22)
 	  {
-		  spQ = spQ22; // spQ = 8;
+		  spQ = getPIPSpQ(0); // spQ = 8;
 #if SP_QCHANGE
 		  SP_QOFFSET = 2;
 #endif
@@ -496,7 +693,7 @@ Void TEncTop::encode( Bool flush, TComPicYuv* pcPicYuvOrg, TComPicYuv* pcPicYuvT
 	  else
 		  if (m_iQP == 27)
 		  {
-			  spQ = spQ27; // spQ = 16;
+			  spQ = getPIPSpQ(1); // spQ = 16;
 #if SP_QCHANGE
 			  SP_QOFFSET = 5;
 #endif
@@ -504,7 +701,7 @@ Void TEncTop::encode( Bool flush, TComPicYuv* pcPicYuvOrg, TComPicYuv* pcPicYuvT
 		  else
 			  if (m_iQP == 32)
 			  {
-				  spQ = spQ32; // spQ = 16;
+				  spQ = getPIPSpQ(2); // spQ = 16;
 #if SP_QCHANGE
 				  SP_QOFFSET = 8;
 #endif
@@ -512,64 +709,27 @@ Void TEncTop::encode( Bool flush, TComPicYuv* pcPicYuvOrg, TComPicYuv* pcPicYuvT
 			  else
 				  if (m_iQP == 37)
 				  {
-					  spQ = spQ37; // spQ = 32;
+					  spQ = getPIPSpQ(3); // spQ = 32;
 #if SP_QCHANGE
 					  SP_QOFFSET = 10;
 #endif
-				  }				  
+				  }
 #if SP_QCHANGE
 	  // SP_QOFFSET = 1; // TEMP
 #endif
-	  spQ += deltaSQP;
-	  
+	  spQ += getPIPDeltaSpQ();
 
 	  if (getBitDepth(CHANNEL_TYPE_LUMA) == 10)
 		  spQ *= 4;
 
 	  cout << "spQ=" << spQ << endl;
-// ----------------------
-#if CUMAX == 8
-	  if (m_iQP == 22)
-	  {
-		  offset4x4 = 2;
-		  offset4x8 = 1;
-		  offset8x4 = 2;
-		  offset8x8 = 1;
-	  }
-
-	  if (m_iQP == 27)
-	  {
-		  offset4x4 = -1;
-		  offset4x8 = -1;
-		  offset8x4 = -2;
-		  offset8x8 = -2;
-	  }
-	  
-	  if (m_iQP == 32)
-	  {
-		  offset4x4 = 2;
-		  offset4x8 = 1;
-		  offset8x4 = -2;
-		  offset8x8 = 2;
-	  }
-
-	  if (m_iQP == 37)
-	  {
-		  offset4x4 = 1;
-		  offset4x8 = 2;
-		  offset8x4 = 2;
-		  offset8x8 = 1;
-	  }
-#endif
-// ----------------------
+	  m_cPIPContext.setSpQ(spQ);
+	  m_cPIPContext.setSpQOffsets(m_iQP);
 
 	  int tmpCBiter = CBiter; // TEMP: I need the codebook of CB0iTQ somewhere in the TComPrediction
 	  CBiter = 0;
 
-	  UInt codebookCnt = base * base;
-	  Codebooks = new Int**[codebookCnt];
-	  nextCodebooks = new Int**[codebookCnt];
-	  nextCodebooksCnt = new Int*[codebookCnt];
+	  m_cPIPContext.createCodebooks();
 
 
 	  // parse the file name
@@ -580,7 +740,7 @@ Void TEncTop::encode( Bool flush, TComPicYuv* pcPicYuvOrg, TComPicYuv* pcPicYuvT
 
 
 	  // common parts of the txt file names
-	  strcpy(commonIn, InCBDir); strcat(commonIn, _itoa(CBiter, buf, 10));
+	  strcpy(commonIn, m_cPIPContext.getCodebookDir().c_str()); strcat(commonIn, "CB"); strcat(commonIn, _itoa(CBiter, buf, 10));
 	  if (true)
 		  strcat(commonIn, "iTQ/");
 	  else
@@ -592,7 +752,7 @@ Void TEncTop::encode( Bool flush, TComPicYuv* pcPicYuvOrg, TComPicYuv* pcPicYuvT
 		  strcat(commonIn, "22");
 	  strcat(commonIn, "_CBf"); strcat(commonIn, _itoa(CBf, buf, 10)); strcat(commonIn, "_");
 
-	  strcpy(commonOut, InCBDir); strcat(commonOut, _itoa(CBiter + 1, buf, 10));
+	  strcpy(commonOut, m_cPIPContext.getCodebookDir().c_str()); strcat(commonOut, "CB"); strcat(commonOut, _itoa(CBiter + 1, buf, 10));
 	  if (true)
 		  strcat(commonOut, "iTQ/");
 	  else
@@ -614,99 +774,22 @@ Void TEncTop::encode( Bool flush, TComPicYuv* pcPicYuvOrg, TComPicYuv* pcPicYuvT
 				  strcat(InAddr, "_"); strcat(InAddr, seqName.c_str());
 			  }
 			  strcat(InAddr, ".txt");
-
-
-			  Codebooks[base*i + j] = new Int*[h*w*CBf];
-			  nextCodebooks[base*i + j] = new Int*[h*w*CBf];
-			  nextCodebooksCnt[base*i + j] = new Int[h*w*CBf];
-			  for (UInt CBi = 0; CBi < h*w*CBf; CBi++)
-			  {
-				  Codebooks[base*i + j][CBi] = new Int[w*h];
-				  nextCodebooks[base*i + j][CBi] = new Int[w*h];
-			  }
-
-			  ifstream inCB(InAddr, ios::in);
-			  if (!CBloopEnable && false)
-			  {
-				  if (inCB.is_open())
-				  {
-					  string line;
-					  string delimiter = ",", token;
-					  int vCnt = 0;
-					  while (getline(inCB, line))
-					  {
-						  int pCnt = 0;
-						  int p;
-						  while (pCnt < w*h)
-						  {
-							  token = line.substr(0, line.find(delimiter));
-							  int l = token.length();
-							  line.erase(0, line.find(delimiter) + 1);
-							  p = atoi(token.c_str());
-							  if (true) // TEMP: impact of the initial codebook 
-								  Codebooks[base*i + j][vCnt][pCnt] = p;
-							  else
-								  Codebooks[base*i + j][vCnt][pCnt] = 0;
-
-
-							  nextCodebooks[base*i + j][vCnt][pCnt] = 0;
-							  pCnt++;
-						  }
-						  nextCodebooksCnt[base*i + j][vCnt] = 0;
-						  vCnt++;
-					  }
-					  inCB.close();
-					  // cout << endl << "Read: Successfully read the codebook at: " << InAddr << endl;
-				  }
-				  else
-				  {
-					  cout << "Read: Error reading inCB file: " << InAddr << endl;
-					  assert(false);
-				  }
-			  }
 		  }
 
-	  CBiter = tmpCBiter; // TEMP: I need the codebook of CB0iTQ somewhere in the TComPrediction
-
-	  // Stats
-	  PIPStats = new Int*[2];
-	  PIPStats[0] = new Int[(1 << base) + 1];
-	  PIPStats[1] = new Int[(1 << base) + 1];
-	  for (int s = 0; s < (1 << base) + 1; s++)
+	  // the iTQ codebooks of the text layout or of the mapped container
+	  if (!CBloopEnable && false)
 	  {
-		  PIPStats[0][s] = 0;
-		  PIPStats[1][s] = 0;
+		  if (!m_cPIPContext.loadCodebooks(m_iQP))
+		  {
+			  cout << "Read: Error reading the codebooks of QP " << m_iQP << " from " << m_cPIPContext.getCodebookDir() << endl;
+			  assert(false);
+		  }
 	  }
 
+	  CBiter = tmpCBiter; // TEMP: I need the codebook of CB0iTQ somewhere in the TComPrediction
 
 	  // Read rates 
-	  Rates = new double*[9];
-	  for (int q = 0; q < 9; q++)
-		  Rates[q] = new double[1 << (q + 1)];
-  
-	  ifstream inRates("rates.txt", ios::in);
-	  if (inRates.is_open())
-	  {
-		  string line, delimiter = "\t", token;
-		  double p = 0;
-		  int qCnt = 0;
-		  while (getline(inRates, line))
-		  {		
-			  int rCnt = 0;
-			  while (rCnt < (1 << (qCnt + 1)))
-			  {
-				  int cnt = 0;
-				  token = line.substr(0, line.find(delimiter));
-				  int l = token.length();
-				  line.erase(0, line.find(delimiter) + 1);
-				  p = atof(token.c_str());
-				  Rates[qCnt][rCnt] = p;
-				  rCnt++;
-			  }
-			  qCnt++;
-		  }
-	  }
-
+	  m_cPIPContext.loadRates("rates.txt");
   }  
 #endif
 
@@ -736,12 +819,10 @@ Void separateFields(Pel* org, Pel* dstField, UInt stride, UInt width, UInt heigh
   {
     org += stride;
   }
+  // every second frame line is a line of the field
   for (Int y = 0; y < height>>1; y++)
   {
-    for (Int x = 0; x < width; x++)
-    {
-      dstField[x] = org[x];
-    }
+    ::memcpy(dstField, org, width * sizeof(Pel));
 
     dstField += stride;
     org += stride*2;
@@ -1117,6 +1198,9 @@ Void TEncTop::xInitSPS()
   m_cSPS.setUseInterKLT   ( m_useInterKLT);
   m_cSPS.setUseKLT        ( m_useKLT);
 #endif
+#if VCEG_AZ08_KLT_COMMON && KLT_DETERMINISTIC_BASIS
+  m_cSPS.setKLTDeterministicBasisFlag( m_KLTDeterministicBasis );
+#endif
 #if COM16_C806_LMCHROMA
   m_cSPS.setUseLMChroma   ( m_useLMChroma      );  
 #endif
@@ -1144,6 +1228,9 @@ Void TEncTop::xInitSPS()
 #if COM16_C983_RSAF
   m_cSPS.setUseRSAF( m_useRSAF );
 #endif
+#if PIP_R1_HT_BINARIZATION
+  m_cSPS.setPIPR1HighThroughputFlag( m_PIPR1HighThroughput );
+#endif
 }
 
 Void TEncTop::xInitHrdParameters()
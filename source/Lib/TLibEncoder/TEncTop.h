@@ -57,6 +57,9 @@
 #include "TEncSampleAdaptiveOffset.h"
 #include "TEncPreanalyzer.h"
 #include "TEncRateCtrl.h"
+#if WPP_PARALLEL_CTU_ROWS
+#include "TEncCtuWorker.h"
+#endif
 //! \ingroup TLibEncoder
 //! \{
 
@@ -91,6 +94,10 @@ private:
   TEncGOP                 m_cGOPEncoder;                  ///< GOP encoder
   TEncSlice               m_cSliceEncoder;                ///< slice encoder
   TEncCu                  m_cCuEncoder;                   ///< CU encoder
+#if PIP
+  TComPIPContext          m_cPIPContext;                  ///< PIP state of this encoder
+  TComPIPCoderState       m_cPIPCoderState;               ///< PIP flags of the search and the coders of this encoder
+#endif
   // SPS
   TComSPS                 m_cSPS;                         ///< SPS. This is the base value. This is copied to TComPicSym
   TComPPS                 m_cPPS;                         ///< PPS. This is the base value. This is copied to TComPicSym
@@ -125,6 +132,11 @@ private:
 #if ALF_HM3_REFACTOR
   TEncAdaptiveLoopFilter  m_cAdaptiveLoopFilter;          ///< adaptive loop filter class
 #endif
+#if WPP_PARALLEL_CTU_ROWS
+  TEncCtuWorker*          m_pcCtuWorkers;                 ///< coding objects of the threads compressing CTU rows or tiles
+  Int                     m_iNumCtuWorkers;
+  Int                     m_iNumCtuThreads;               ///< threads compressing CTU rows, tiles or pictures; with SplitThreads there may be more workers
+#endif
 
 protected:
   Void  xGetNewPicBuffer  ( TComPic*& rpcPic );           ///< get picture buffer which will be processed
@@ -132,6 +144,9 @@ protected:
   Void  xInitSPS          ();                             ///< initialize SPS from encoder options
   Void  xInitPPS          ();                             ///< initialize PPS from encoder options
   Void  xInitScalingLists ();                             ///< initialize scaling lists
+#if WPP_PARALLEL_CTU_ROWS
+  Void  xInitCtuWorkers   ();                             ///< initialize the CTU workers like the search, transform and CU encoder
+#endif
   Void  xInitHrdParameters();                             ///< initialize HRD parameters
 
   Void  xInitPPSforTiles  ();
@@ -182,6 +197,15 @@ public:
 #endif
   TEncSbac*               getRDGoOnSbacCoder    () { return  &m_cRDGoOnSbacCoder;     }
   TEncRateCtrl*           getRateCtrl           () { return &m_cRateCtrl;             }
+#if PIP
+  TComPIPContext&         getPIPContext         () { return  m_cPIPContext;           }
+  TComPIPCoderState*      getPIPCoderState      () { return &m_cPIPCoderState;        }
+#endif
+#if WPP_PARALLEL_CTU_ROWS
+  TEncCtuWorker*          getCtuWorkers         () { return  m_pcCtuWorkers;          }
+  Int                     getNumCtuWorkers      () { return  m_iNumCtuWorkers;        }
+  Int                     getNumCtuThreads      () { return  m_iNumCtuThreads;        }
+#endif
   Void selectReferencePictureSet(TComSlice* slice, Int POCCurr, Int GOPid );
   Int getReferencePictureSetIdxForSOP(Int POCCurr, Int GOPid );
   // -------------------------------------------------------------------------------------------------------------------
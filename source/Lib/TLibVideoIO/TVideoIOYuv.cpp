@@ -36,22 +36,292 @@
 */
 
 #include <cstdlib>
+#include <cstring>
 #include <fcntl.h>
 #include <assert.h>
 #include <sys/stat.h>
 #include <fstream>
 #include <iostream>
 #include <memory.h>
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 
 #include "TLibCommon/TComRom.h"
 #include "TVideoIOYuv.h"
 
+#if COM16_C806_SIMD_OPT && !RExt__HIGH_BIT_DEPTH_SUPPORT && ( defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64) )
+#include <smmintrin.h>
+#define YUV_IO_SIMD 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define YUV_IO_SSE41
+#else
+// the SSE4.1 kernels are built for SSE4.1 whatever the flags of this file; they only run when the CPU has it
+#define YUV_IO_SSE41 __attribute__((target("sse4.1")))
+#endif
+#else
+#define YUV_IO_SIMD 0
+#endif
+
 using namespace std;
 
 // ====================================================================================================================
 // Local Functions
 // ====================================================================================================================
 
+/// line kernels of the plane conversions; the SIMD ones are bit-exact with the scalar ones
+struct YuvIOKernels
+{
+  Void (*unpackLine8      )(Pel* dst, const UChar* src, const UInt width);
+  Void (*unpackLine16     )(Pel* dst, const UChar* src, const UInt width);
+  Void (*packLine8        )(UChar* dst, const Pel* src, const UInt width);
+  Void (*packLine16       )(UChar* dst, const Pel* src, const UInt width);
+  Void (*scaleLineUp      )(Pel* img, const UInt width, const Int shiftbits);
+  Void (*scaleLineDown    )(Pel* img, const UInt width, const Int shiftbits, const Pel minval, const Pel maxval);
+  Void (*interleaveLines8 )(UChar* dst, const Pel* first, const Pel* second, const UInt width);
+  Void (*interleaveLines16)(UChar* dst, const Pel* first, const Pel* second, const UInt width);
+};
+
+/// dst[x] = src[x]: a line of 8 bit file samples to Pel
+static Void unpackLine8_C(Pel* dst, const UChar* src, const UInt width)
+{
+  for (UInt x = 0; x < width; x++)
+  {
+    dst[x] = src[x];
+  }
+}
+
+/// dst[x] = src[2x] | src[2x+1]<<8: a line of 16 bit little-endian file samples to Pel
+static Void unpackLine16_C(Pel* dst, const UChar* src, const UInt width)
+{
+  for (UInt x = 0; x < width; x++)
+  {
+    dst[x] = Pel(src[2*x+0]) | (Pel(src[2*x+1])<<8);
+  }
+}
+
+/// dst[x] = low byte of src[x]: a line of Pel to 8 bit file samples
+static Void packLine8_C(UChar* dst, const Pel* src, const UInt width)
+{
+  for (UInt x = 0; x < width; x++)
+  {
+    dst[x] = (UChar)(src[x]);
+  }
+}
+
+/// dst[2x], dst[2x+1] = low and high byte of src[x]: a line of Pel to 16 bit little-endian file samples
+static Void packLine16_C(UChar* dst, const Pel* src, const UInt width)
+{
+  for (UInt x = 0; x < width; x++)
+  {
+    dst[2*x  ] = (src[x]>>0) & 0xff;
+    dst[2*x+1] = (src[x]>>8) & 0xff;
+  }
+}
+
+/// img[x] <<= shiftbits
+static Void scaleLineUp_C(Pel* img, const UInt width, const Int shiftbits)
+{
+  for (UInt x = 0; x < width; x++)
+  {
+    img[x] <<= shiftbits;
+  }
+}
+
+/// img[x] = clip((img[x] + rounding) >> shiftbits)
+static Void scaleLineDown_C(Pel* img, const UInt width, const Int shiftbits, const Pel minval, const Pel maxval)
+{
+  const Pel rounding = 1 << (shiftbits-1);
+  for (UInt x = 0; x < width; x++)
+  {
+    img[x] = Clip3(minval, maxval, Pel((img[x] + rounding) >> shiftbits));
+  }
+}
+
+/// a line of each field to two consecutive 8 bit frame lines: dst[x] = first[x], dst[width+x] = second[x]
+static Void interleaveLines8_C(UChar* dst, const Pel* first, const Pel* second, const UInt width)
+{
+  for (UInt x = 0; x < width; x++)
+  {
+    dst[x]       = (UChar)(first[x]);
+    dst[width+x] = (UChar)(second[x]);
+  }
+}
+
+/// a line of each field to two consecutive 16 bit little-endian frame lines
+static Void interleaveLines16_C(UChar* dst, const Pel* first, const Pel* second, const UInt width)
+{
+  UChar* dst2 = dst + 2 * width;
+  for (UInt x = 0; x < width; x++)
+  {
+    dst [2*x  ] = (first [x]>>0) & 0xff;
+    dst [2*x+1] = (first [x]>>8) & 0xff;
+    dst2[2*x  ] = (second[x]>>0) & 0xff;
+    dst2[2*x+1] = (second[x]>>8) & 0xff;
+  }
+}
+
+#if YUV_IO_SIMD
+YUV_IO_SSE41
+static Void unpackLine8_SSE41(Pel* dst, const UChar* src, const UInt width)
+{
+  UInt x = 0;
+  for (; x + 16 <= width; x += 16)
+  {
+    const __m128i v = _mm_loadu_si128((const __m128i*)(src + x));
+    _mm_storeu_si128((__m128i*)(dst + x),     _mm_cvtepu8_epi16(v));
+    _mm_storeu_si128((__m128i*)(dst + x + 8), _mm_cvtepu8_epi16(_mm_srli_si128(v, 8)));
+  }
+  unpackLine8_C(dst + x, src + x, width - x);
+}
+
+YUV_IO_SSE41
+static Void unpackLine16_SSE41(Pel* dst, const UChar* src, const UInt width)
+{
+  UInt x = 0;
+  // x86 is little-endian: the file samples are the Pel bit patterns
+  for (; x + 8 <= width; x += 8)
+  {
+    _mm_storeu_si128((__m128i*)(dst + x), _mm_loadu_si128((const __m128i*)(src + 2 * x)));
+  }
+  unpackLine16_C(dst + x, src + 2 * x, width - x);
+}
+
+YUV_IO_SSE41
+static Void packLine8_SSE41(UChar* dst, const Pel* src, const UInt width)
+{
+  UInt x = 0;
+  const __m128i vMask = _mm_set1_epi16(0xff);
+  for (; x + 16 <= width; x += 16)
+  {
+    const __m128i v0 = _mm_and_si128(_mm_loadu_si128((const __m128i*)(src + x)),     vMask);
+    const __m128i v1 = _mm_and_si128(_mm_loadu_si128((const __m128i*)(src + x + 8)), vMask);
+    _mm_storeu_si128((__m128i*)(dst + x), _mm_packus_epi16(v0, v1));
+  }
+  packLine8_C(dst + x, src + x, width - x);
+}
+
+YUV_IO_SSE41
+static Void packLine16_SSE41(UChar* dst, const Pel* src, const UInt width)
+{
+  UInt x = 0;
+  for (; x + 8 <= width; x += 8)
+  {
+    _mm_storeu_si128((__m128i*)(dst + 2 * x), _mm_loadu_si128((const __m128i*)(src + x)));
+  }
+  packLine16_C(dst + 2 * x, src + x, width - x);
+}
+
+YUV_IO_SSE41
+static Void scaleLineUp_SSE41(Pel* img, const UInt width, const Int shiftbits)
+{
+  UInt x = 0;
+  // the 16 bit shift keeps the low 16 bits of the result, as the assignment to Pel does
+  const __m128i vShift = _mm_cvtsi32_si128(shiftbits);
+  for (; x + 8 <= width; x += 8)
+  {
+    const __m128i v = _mm_loadu_si128((const __m128i*)(img + x));
+    _mm_storeu_si128((__m128i*)(img + x), _mm_sll_epi16(v, vShift));
+  }
+  scaleLineUp_C(img + x, width - x, shiftbits);
+}
+
+YUV_IO_SSE41
+static Void scaleLineDown_SSE41(Pel* img, const UInt width, const Int shiftbits, const Pel minval, const Pel maxval)
+{
+  UInt x = 0;
+  const __m128i vRound = _mm_set1_epi32(1 << (shiftbits-1));
+  const __m128i vShift = _mm_cvtsi32_si128(shiftbits);
+  const __m128i vMin   = _mm_set1_epi16(minval);
+  const __m128i vMax   = _mm_set1_epi16(maxval);
+  // the sum is formed in 32 bits; shifted right by at least one it fits 16 bits again
+  for (; x + 8 <= width; x += 8)
+  {
+    const __m128i v  = _mm_loadu_si128((const __m128i*)(img + x));
+    const __m128i lo = _mm_sra_epi32(_mm_add_epi32(_mm_cvtepi16_epi32(v), vRound), vShift);
+    const __m128i hi = _mm_sra_epi32(_mm_add_epi32(_mm_cvtepi16_epi32(_mm_srli_si128(v, 8)), vRound), vShift);
+    const __m128i r  = _mm_min_epi16(_mm_max_epi16(_mm_packs_epi32(lo, hi), vMin), vMax);
+    _mm_storeu_si128((__m128i*)(img + x), r);
+  }
+  scaleLineDown_C(img + x, width - x, shiftbits, minval, maxval);
+}
+
+YUV_IO_SSE41
+static Void interleaveLines8_SSE41(UChar* dst, const Pel* first, const Pel* second, const UInt width)
+{
+  UInt x = 0;
+  const __m128i vMask = _mm_set1_epi16(0xff);
+  for (; x + 16 <= width; x += 16)
+  {
+    const __m128i f0 = _mm_and_si128(_mm_loadu_si128((const __m128i*)(first  + x)),     vMask);
+    const __m128i f1 = _mm_and_si128(_mm_loadu_si128((const __m128i*)(first  + x + 8)), vMask);
+    const __m128i s0 = _mm_and_si128(_mm_loadu_si128((const __m128i*)(second + x)),     vMask);
+    const __m128i s1 = _mm_and_si128(_mm_loadu_si128((const __m128i*)(second + x + 8)), vMask);
+    _mm_storeu_si128((__m128i*)(dst + x),         _mm_packus_epi16(f0, f1));
+    _mm_storeu_si128((__m128i*)(dst + width + x), _mm_packus_epi16(s0, s1));
+  }
+  for (; x < width; x++)
+  {
+    dst[x]       = (UChar)(first[x]);
+    dst[width+x] = (UChar)(second[x]);
+  }
+}
+
+YUV_IO_SSE41
+static Void interleaveLines16_SSE41(UChar* dst, const Pel* first, const Pel* second, const UInt width)
+{
+  UInt x = 0;
+  UChar* dst2 = dst + 2 * width;
+  for (; x + 8 <= width; x += 8)
+  {
+    _mm_storeu_si128((__m128i*)(dst  + 2 * x), _mm_loadu_si128((const __m128i*)(first  + x)));
+    _mm_storeu_si128((__m128i*)(dst2 + 2 * x), _mm_loadu_si128((const __m128i*)(second + x)));
+  }
+  for (; x < width; x++)
+  {
+    dst [2*x  ] = (first [x]>>0) & 0xff;
+    dst [2*x+1] = (first [x]>>8) & 0xff;
+    dst2[2*x  ] = (second[x]>>0) & 0xff;
+    dst2[2*x+1] = (second[x]>>8) & 0xff;
+  }
+}
+
+static Bool cpuHasSSE41()
+{
+#if defined(_MSC_VER)
+  Int info[4];
+  __cpuid(info, 1);
+  return (info[2] & (1 << 19)) != 0;
+#else
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("sse4.1") != 0;
+#endif
+}
+#endif
+
+static YuvIOKernels selectYuvIOKernels()
+{
+  YuvIOKernels k = { unpackLine8_C, unpackLine16_C, packLine8_C, packLine16_C, scaleLineUp_C, scaleLineDown_C, interleaveLines8_C, interleaveLines16_C };
+#if YUV_IO_SIMD
+  if (cpuHasSSE41())
+  {
+    YuvIOKernels s = { unpackLine8_SSE41, unpackLine16_SSE41, packLine8_SSE41, packLine16_SSE41, scaleLineUp_SSE41, scaleLineDown_SSE41, interleaveLines8_SSE41, interleaveLines16_SSE41 };
+    k = s;
+  }
+#endif
+  return k;
+}
+
+/// the kernels of this CPU, selected on first use
+static const YuvIOKernels& getYuvIOKernels()
+{
+  static const YuvIOKernels kernels = selectYuvIOKernels();
+  return kernels;
+}
+
 /**
  * Scale all pixels in img depending upon sign of shiftbits by a factor of
  * 2<sup>shiftbits</sup>.
@@ -69,36 +339,273 @@ using namespace std;
  */
 static Void scalePlane(Pel* img, const UInt stride, const UInt width, const UInt height, Int shiftbits, Pel minval, Pel maxval)
 {
+  const YuvIOKernels& k = getYuvIOKernels();
   if (shiftbits > 0)
   {
     for (UInt y = 0; y < height; y++, img+=stride)
     {
-      for (UInt x = 0; x < width; x++)
+      k.scaleLineUp(img, width, shiftbits);
+    }
+  }
+  else if (shiftbits < 0)
+  {
+    for (UInt y = 0; y < height; y++, img+=stride)
+    {
+      k.scaleLineDown(img, width, -shiftbits, minval, maxval);
+    }
+  }
+}
+
+
+/**
+ * Skip numBytes of the input: seek where possible, read through otherwise
+ * (pipes and other streams that cannot seek).
+ */
+static Bool skipBytes(istream& fd, streamoff numBytes)
+{
+  if (!!fd.seekg(numBytes, ios::cur))
+  {
+    return true;
+  }
+  fd.clear();
+
+  Char buf[4096];
+  while (numBytes > 0 && fd.good())
+  {
+    const streamsize n = streamsize(std::min<streamoff>(numBytes, sizeof(buf)));
+    fd.read(buf, n);
+    numBytes -= n;
+  }
+  return !fd.fail();
+}
+
+static const Char   Y4M_MAGIC[]     = "YUV4MPEG2";
+static const size_t Y4M_MAGIC_SIZE  = sizeof(Y4M_MAGIC) - 1;
+
+/// parses the W, H, F and C parameters of a Y4M stream header line
+static Bool parseY4MHeader(const std::string& line, TVideoIOYuv::Y4MHeader& rHeader)
+{
+  rHeader.width        = 0;
+  rHeader.height       = 0;
+  rHeader.frameRateNum = 0;
+  rHeader.frameRateDen = 1;
+  rHeader.chromaFormat = CHROMA_420;
+  rHeader.bitDepth     = 8;
+
+  size_t pos = Y4M_MAGIC_SIZE;
+  while (pos < line.size())
+  {
+    const size_t end = std::min(line.find(' ', pos), line.size());
+    const std::string param = line.substr(pos, end - pos);
+    pos = end + 1;
+    if (param.empty())
+    {
+      continue;
+    }
+    const Char* value = param.c_str() + 1;
+    switch (param[0])
+    {
+    case 'W':
+      rHeader.width = atoi(value);
+      break;
+    case 'H':
+      rHeader.height = atoi(value);
+      break;
+    case 'F':
+      if (sscanf(value, "%d:%d", &rHeader.frameRateNum, &rHeader.frameRateDen) != 2 || rHeader.frameRateDen <= 0)
       {
-        img[x] <<= shiftbits;
+        rHeader.frameRateNum = 0;
+        rHeader.frameRateDen = 1;
+      }
+      break;
+    case 'C':
+      {
+        const Char* depth = value + 3;
+        if (!strncmp(value, "mono", 4))
+        {
+          rHeader.chromaFormat = CHROMA_400;
+          depth = value + 4;
+        }
+        else if (!strncmp(value, "420", 3))
+        {
+          rHeader.chromaFormat = CHROMA_420;
+        }
+        else if (!strncmp(value, "422", 3))
+        {
+          rHeader.chromaFormat = CHROMA_422;
+        }
+        else if (!strncmp(value, "444", 3) && strcmp(value, "444alpha"))
+        {
+          rHeader.chromaFormat = CHROMA_444;
+        }
+        else
+        {
+          fprintf(stderr, "\nunsupported Y4M colour space C%s\n", value);
+          return false;
+        }
+        // 420jpeg, 420paldv, 420mpeg2 and the plain names are 8 bit; 420p10, mono12 etc. give the bit depth
+        if (*depth == 'p')
+        {
+          depth++;
+        }
+        rHeader.bitDepth = (*depth >= '0' && *depth <= '9') ? atoi(depth) : 8;
       }
+      break;
+    default:
+      // interlacing, aspect ratio and the X parameters are not used
+      break;
     }
   }
-  else if (shiftbits < 0)
+  return rHeader.width > 0 && rHeader.height > 0;
+}
+
+/// stdin, shared by the readers of "-"
+static TVideoIOPipeBuf& getStdinBuf()
+{
+  static TVideoIOPipeBuf s_stdinBuf;
+  if (!s_stdinBuf.getFile())
   {
-    shiftbits=-shiftbits;
+#if defined(_WIN32)
+    _setmode(_fileno(stdin), _O_BINARY);
+#endif
+    s_stdinBuf.attach(stdin);
+  }
+  return s_stdinBuf;
+}
 
-    Pel rounding = 1 << (shiftbits-1);
-    for (UInt y = 0; y < height; y++, img+=stride)
+/// stdin is read once: the header of a Y4M stream on it is kept for all the readers
+static Bool getStdinY4MHeader(TVideoIOYuv::Y4MHeader& rHeader)
+{
+  static Bool                   s_bChecked = false;
+  static Bool                   s_bY4M     = false;
+  static TVideoIOYuv::Y4MHeader s_header;
+
+  if (!s_bChecked)
+  {
+    s_bChecked = true;
+    TVideoIOPipeBuf& rcBuf = getStdinBuf();
+    Char magic[Y4M_MAGIC_SIZE];
+    if (rcBuf.peek(magic, Y4M_MAGIC_SIZE) == streamsize(Y4M_MAGIC_SIZE) && !memcmp(magic, Y4M_MAGIC, Y4M_MAGIC_SIZE))
     {
-      for (UInt x = 0; x < width; x++)
+      istream cStdin(&rcBuf);
+      std::string line;
+      getline(cStdin, line);
+      s_bY4M = parseY4MHeader(line, s_header);
+      if (!s_bY4M)
       {
-        img[x] = Clip3(minval, maxval, Pel((img[x] + rounding) >> shiftbits));
+        fprintf(stderr, "\ninvalid Y4M header on stdin\n");
+        exit(EXIT_FAILURE);
       }
     }
   }
+  rHeader = s_header;
+  return s_bY4M;
 }
 
+// ====================================================================================================================
+// Pipe stream buffer
+// ====================================================================================================================
+
+std::streamsize TVideoIOPipeBuf::peek( Char* dst, std::streamsize n )
+{
+  assert( n <= std::streamsize( sizeof( m_buffer ) ) );
+  std::streamsize avail = egptr() - gptr();
+  if( avail < n )
+  {
+    // move the unread bytes to the front and fill up behind them
+    memmove( m_buffer, gptr(), avail );
+    while( avail < n )
+    {
+      const size_t got = fread( m_buffer + avail, 1, sizeof( m_buffer ) - avail, m_pFile );
+      if( got == 0 )
+      {
+        break;
+      }
+      avail += got;
+    }
+    setg( m_buffer, m_buffer, m_buffer + avail );
+  }
+  n = std::min( n, avail );
+  memcpy( dst, gptr(), n );
+  return n;
+}
+
+TVideoIOPipeBuf::int_type TVideoIOPipeBuf::underflow()
+{
+  if( gptr() == egptr() )
+  {
+    const size_t got = fread( m_buffer, 1, sizeof( m_buffer ), m_pFile );
+    if( got == 0 )
+    {
+      return traits_type::eof();
+    }
+    setg( m_buffer, m_buffer, m_buffer + got );
+  }
+  return traits_type::to_int_type( *gptr() );
+}
+
+std::streamsize TVideoIOPipeBuf::xsgetn( char_type* s, std::streamsize n )
+{
+  std::streamsize done = 0;
+  while( done < n )
+  {
+    std::streamsize avail = egptr() - gptr();
+    if( avail == 0 )
+    {
+      // large reads go to the destination directly
+      if( n - done >= std::streamsize( sizeof( m_buffer ) ) )
+      {
+        const size_t got = fread( s + done, 1, size_t( n - done ), m_pFile );
+        done += got;
+        break;
+      }
+      if( underflow() == traits_type::eof() )
+      {
+        break;
+      }
+      avail = egptr() - gptr();
+    }
+    const std::streamsize k = std::min( n - done, avail );
+    memcpy( s + done, gptr(), k );
+    gbump( Int( k ) );
+    done += k;
+  }
+  return done;
+}
+
+TVideoIOPipeBuf::int_type TVideoIOPipeBuf::overflow( int_type c )
+{
+  if( traits_type::eq_int_type( c, traits_type::eof() ) )
+  {
+    return traits_type::not_eof( c );
+  }
+  return fputc( c, m_pFile ) == EOF ? traits_type::eof() : c;
+}
+
+std::streamsize TVideoIOPipeBuf::xsputn( const char_type* s, std::streamsize n )
+{
+  return fwrite( s, 1, size_t( n ), m_pFile );
+}
+
+int TVideoIOPipeBuf::sync()
+{
+  return m_pFile && fflush( m_pFile ) ? -1 : 0;
+}
 
 // ====================================================================================================================
 // Public member functions
 // ====================================================================================================================
 
+TVideoIOYuv::TVideoIOYuv()
+: m_cHandle          ( NULL )
+, m_bY4M             ( false )
+, m_bY4MHeaderPending( false )
+, m_dataStart        ( 0 )
+{
+  m_y4mFrameRate[0] = 25;
+  m_y4mFrameRate[1] = 1;
+}
+
 /**
  * Open file for reading/writing Y'CbCr frames.
  *
@@ -138,19 +645,60 @@ Void TVideoIOYuv::open( Char* pchFile, Bool bWriteMode, const Int fileBitDepth[M
     }
   }
 
+  const Bool bPipe = !strcmp( pchFile, "-" );
+  m_bY4M            = false;
+  m_bY4MHeaderPending = false;
+
   if ( bWriteMode )
   {
-    m_cHandle.open( pchFile, ios::binary | ios::out );
+    if ( bPipe )
+    {
+      m_cPipeBuf.attach( takeStdout() );
+      m_cHandle.rdbuf( m_cPipeBuf.getFile() ? &m_cPipeBuf : NULL );
+    }
+    else
+    {
+      m_cHandle.rdbuf( m_cFileBuf.open( pchFile, ios::binary | ios::out ) ? &m_cFileBuf : NULL );
+    }
 
     if( m_cHandle.fail() )
     {
       printf("\nfailed to write reconstructed YUV file\n");
       exit(0);
     }
+
+    const size_t len = strlen( pchFile );
+    m_bY4M = len >= 4 && ( !strcmp( pchFile + len - 4, ".y4m" ) || !strcmp( pchFile + len - 4, ".Y4M" ) );
+    m_bY4MHeaderPending = m_bY4M;
   }
   else
   {
-    m_cHandle.open( pchFile, ios::binary | ios::in );
+    if ( bPipe )
+    {
+      Y4MHeader cHeader;
+      m_bY4M = getStdinY4MHeader( cHeader );
+      m_cHandle.rdbuf( &getStdinBuf() );
+    }
+    else
+    {
+      m_cHandle.rdbuf( m_cFileBuf.open( pchFile, ios::binary | ios::in ) ? &m_cFileBuf : NULL );
+      if( !m_cHandle.fail() )
+      {
+        // a Y4M stream header is taken; any other file is read from its start
+        Char magic[Y4M_MAGIC_SIZE];
+        m_bY4M = m_cFileBuf.sgetn( magic, Y4M_MAGIC_SIZE ) == streamsize( Y4M_MAGIC_SIZE ) && !memcmp( magic, Y4M_MAGIC, Y4M_MAGIC_SIZE );
+        if( m_bY4M )
+        {
+          std::string line;
+          getline( m_cHandle, line );
+        }
+        else
+        {
+          m_cFileBuf.pubseekpos( 0, ios::in );
+        }
+        m_dataStart = m_cHandle.tellg();
+      }
+    }
 
     if( m_cHandle.fail() )
     {
@@ -164,7 +712,17 @@ Void TVideoIOYuv::open( Char* pchFile, Bool bWriteMode, const Int fileBitDepth[M
 
 Void TVideoIOYuv::close()
 {
-  m_cHandle.close();
+  if ( m_cHandle.rdbuf() == &m_cFileBuf )
+  {
+    m_cFileBuf.close();
+  }
+  else if ( m_cHandle.rdbuf() == &m_cPipeBuf )
+  {
+    // stdout stays open for a later writer
+    m_cPipeBuf.pubsync();
+    m_cPipeBuf.attach( NULL );
+  }
+  m_cHandle.rdbuf( NULL );
 }
 
 Bool TVideoIOYuv::isEof()
@@ -177,6 +735,92 @@ Bool TVideoIOYuv::isFail()
   return m_cHandle.fail();
 }
 
+FILE* TVideoIOYuv::takeStdout()
+{
+  static FILE* s_pStdout = NULL;
+  if ( !s_pStdout )
+  {
+    fflush( stdout );
+#if defined(_WIN32)
+    const Int fd = _dup( _fileno( stdout ) );
+    _dup2( _fileno( stderr ), _fileno( stdout ) );
+    _setmode( fd, _O_BINARY );
+    s_pStdout = _fdopen( fd, "wb" );
+#else
+    const Int fd = dup( fileno( stdout ) );
+    dup2( fileno( stderr ), fileno( stdout ) );
+    s_pStdout = fdopen( fd, "wb" );
+#endif
+  }
+  return s_pStdout;
+}
+
+Bool TVideoIOYuv::readY4MHeader( const std::string& fileName, Y4MHeader& rHeader )
+{
+  if ( fileName == "-" )
+  {
+    return getStdinY4MHeader( rHeader );
+  }
+
+  ifstream cFile( fileName.c_str(), ios::binary | ios::in );
+  Char magic[Y4M_MAGIC_SIZE];
+  if ( !cFile.read( magic, Y4M_MAGIC_SIZE ) || memcmp( magic, Y4M_MAGIC, Y4M_MAGIC_SIZE ) )
+  {
+    return false;
+  }
+  std::string line;
+  getline( cFile, line );
+  return parseY4MHeader( Y4M_MAGIC + line, rHeader );
+}
+
+/**
+ * Take the header of the next Y4M frame ("FRAME" and any parameters).
+ * \return false at the end of the stream
+ */
+Bool TVideoIOYuv::xReadY4MFrameHeader()
+{
+  std::string line;
+  if ( !getline( m_cHandle, line ) )
+  {
+    return false;
+  }
+  if ( line.compare( 0, 5, "FRAME" ) )
+  {
+    fprintf( stderr, "\nY4M frame header expected\n" );
+    m_cHandle.setstate( ios::failbit );
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Write the Y4M frame header, preceded by the stream header before the first frame.
+ * \param interlace  'p' for frames, 't' or 'b' for fields written top or bottom first
+ */
+Bool TVideoIOYuv::xWriteY4MFrameHeader( UInt width444, UInt height444, ChromaFormat format, Char interlace )
+{
+  if ( m_bY4MHeaderPending )
+  {
+    m_bY4MHeaderPending = false;
+    const Int bitDepth = m_fileBitdepth[CHANNEL_TYPE_LUMA];
+    const Char* colourSpace = format == CHROMA_400 ? "mono" : format == CHROMA_420 ? "420" : format == CHROMA_422 ? "422" : "444";
+    Char suffix[16] = "";
+    if ( bitDepth > 8 )
+    {
+      sprintf( suffix, format == CHROMA_400 ? "%d" : "p%d", bitDepth );
+    }
+    else if ( format == CHROMA_420 )
+    {
+      strcpy( suffix, "jpeg" );
+    }
+    Char header[128];
+    sprintf( header, "%s W%u H%u F%d:%d I%c A1:1 C%s%s\n", Y4M_MAGIC, width444, height444, m_y4mFrameRate[0], m_y4mFrameRate[1], interlace, colourSpace, suffix );
+    m_cHandle.write( header, strlen( header ) );
+  }
+  m_cHandle.write( "FRAME\n", 6 );
+  return !m_cHandle.fail();
+}
+
 /**
  * Skip numFrames in input.
  *
@@ -206,23 +850,40 @@ Void TVideoIOYuv::skipFrames(UInt numFrames, UInt width, UInt height, ChromaForm
   frameSize *= wordsize;
   //------------------
 
-  const streamoff offset = frameSize * numFrames;
+  if (m_bY4M)
+  {
+    for (UInt i = 0; i < numFrames; i++)
+    {
+      if (!xReadY4MFrameHeader() || !skipBytes(m_cHandle, frameSize))
+      {
+        return;
+      }
+    }
+    return;
+  }
+
+  /* seek, or consume the input where it cannot seek */
+  skipBytes(m_cHandle, frameSize * numFrames);
+}
 
-  /* attempt to seek */
-  if (!!m_cHandle.seekg(offset, ios::cur))
+/**
+ * Position the input at a frame, counted from the first frame of the file. Y4M frames are
+ * skipped one by one from the first frame (their headers may differ in length).
+ * \return false if the input cannot seek (stdin)
+ */
+Bool TVideoIOYuv::seekFrame(UInt frame, UInt width, UInt height, ChromaFormat format)
+{
+  if (m_cHandle.rdbuf() != &m_cFileBuf)
   {
-    return; /* success */
+    return false;
   }
   m_cHandle.clear();
-
-  /* fall back to consuming the input */
-  Char buf[512];
-  const streamoff offset_mod_bufsize = offset % sizeof(buf);
-  for (streamoff i = 0; i < offset - offset_mod_bufsize; i += sizeof(buf))
+  if (!m_cHandle.seekg(m_dataStart))
   {
-    m_cHandle.read(buf, sizeof(buf));
+    return false;
   }
-  m_cHandle.read(buf, offset_mod_bufsize);
+  skipFrames(frame, width, height, format);
+  return true;
 }
 
 /**
@@ -272,6 +933,7 @@ static Bool readPlane(Pel* dst,
   const UInt full_height_dest = height_dest+pad_y_dest;
 
   const UInt stride_file      = (width444 * (is16bit ? 2 : 1)) >> csx_file;
+  const YuvIOKernels& kernels = getYuvIOKernels();
 
   UChar  *buf   = new UChar[stride_file];
 
@@ -293,8 +955,7 @@ static Bool readPlane(Pel* dst,
     if (fileFormat!=CHROMA_400)
     {
       const UInt height_file      = height444>>csy_file;
-      fd.seekg(height_file*stride_file, ios::cur);
-      if (fd.eof() || fd.fail() )
+      if (!skipBytes(fd, streamoff(height_file)*stride_file))
       {
         delete[] buf;
         return false;
@@ -344,7 +1005,18 @@ static Bool readPlane(Pel* dst,
         {
           // eg file is 422, dest is 444.
           const UInt sx=csx_file-csx_dest;
-          if (!is16bit)
+          if (sx == 0)
+          {
+            if (!is16bit)
+            {
+              kernels.unpackLine8(dst, buf, width_dest);
+            }
+            else
+            {
+              kernels.unpackLine16(dst, buf, width_dest);
+            }
+          }
+          else if (!is16bit)
           {
             for (UInt x = 0; x < width_dest; x++)
             {
@@ -417,6 +1089,7 @@ static Bool writePlane(ostream& fd, Pel* src, Bool is16bit,
   const UInt stride_file      = (width444 * (is16bit ? 2 : 1)) >> csx_file;
   const UInt width_file       = width444 >>csx_file;
   const UInt height_file      = height444>>csy_file;
+  const YuvIOKernels& kernels = getYuvIOKernels();
 
   UChar  *buf   = new UChar[stride_file];
 
@@ -488,7 +1161,18 @@ static Bool writePlane(ostream& fd, Pel* src, Bool is16bit,
         {
           // eg file is 422, src is 444.
           const UInt sx=csx_file-csx_src;
-          if (!is16bit)
+          if (sx == 0)
+          {
+            if (!is16bit)
+            {
+              kernels.packLine8(buf, src, width_file);
+            }
+            else
+            {
+              kernels.packLine16(buf, src, width_file);
+            }
+          }
+          else if (!is16bit)
           {
             for (UInt x = 0; x < width_file; x++)
             {
@@ -542,6 +1226,7 @@ static Bool writeField(ostream& fd, Pel* top, Pel* bottom, Bool is16bit,
   const UInt stride_file      = (width444 * (is16bit ? 2 : 1)) >> csx_file;
   const UInt width_file       = width444 >>csx_file;
   const UInt height_file      = height444>>csy_file;
+  const YuvIOKernels& kernels = getYuvIOKernels();
 
   UChar  *buf   = new UChar[stride_file * 2];
 
@@ -593,49 +1278,66 @@ static Bool writeField(ostream& fd, Pel* top, Pel* bottom, Bool is16bit,
     {
       if ((y444&mask_y_file)==0)
       {
-        for (UInt field = 0; field < 2; field++)
+        if (csx_file == csx_src)
         {
-          UChar *fieldBuffer = buf + (field * stride_file);
-          Pel   *src         = (((field == 0) && isTff) || ((field == 1) && (!isTff))) ? top : bottom;
-
-          // write a new line
-          if (csx_file < csx_src)
+          // the lines of the two fields become two consecutive frame lines
+          const Pel *first  = isTff ? top    : bottom;
+          const Pel *second = isTff ? bottom : top;
+          if (!is16bit)
           {
-            // eg file is 444, source is 422.
-            const UInt sx=csx_src-csx_file;
-            if (!is16bit)
-            {
-              for (UInt x = 0; x < width_file; x++)
-              {
-                fieldBuffer[x] = (UChar)(src[x>>sx]);
-              }
-            }
-            else
-            {
-              for (UInt x = 0; x < width_file; x++)
-              {
-                fieldBuffer[2*x  ] = (src[x>>sx]>>0) & 0xff;
-                fieldBuffer[2*x+1] = (src[x>>sx]>>8) & 0xff;
-              }
-            }
+            kernels.interleaveLines8(buf, first, second, width_file);
           }
           else
           {
-            // eg file is 422, src is 444.
-            const UInt sx=csx_file-csx_src;
-            if (!is16bit)
+            kernels.interleaveLines16(buf, first, second, width_file);
+          }
+        }
+        else
+        {
+          for (UInt field = 0; field < 2; field++)
+          {
+            UChar *fieldBuffer = buf + (field * stride_file);
+            Pel   *src         = (((field == 0) && isTff) || ((field == 1) && (!isTff))) ? top : bottom;
+
+            // write a new line
+            if (csx_file < csx_src)
             {
-              for (UInt x = 0; x < width_file; x++)
+              // eg file is 444, source is 422.
+              const UInt sx=csx_src-csx_file;
+              if (!is16bit)
               {
-                fieldBuffer[x] = (UChar)(src[x<<sx]);
+                for (UInt x = 0; x < width_file; x++)
+                {
+                  fieldBuffer[x] = (UChar)(src[x>>sx]);
+                }
+              }
+              else
+              {
+                for (UInt x = 0; x < width_file; x++)
+                {
+                  fieldBuffer[2*x  ] = (src[x>>sx]>>0) & 0xff;
+                  fieldBuffer[2*x+1] = (src[x>>sx]>>8) & 0xff;
+                }
               }
             }
             else
             {
-              for (UInt x = 0; x < width_file; x++)
+              // eg file is 422, src is 444.
+              const UInt sx=csx_file-csx_src;
+              if (!is16bit)
+              {
+                for (UInt x = 0; x < width_file; x++)
+                {
+                  fieldBuffer[x] = (UChar)(src[x<<sx]);
+                }
+              }
+              else
               {
-                fieldBuffer[2*x  ] = (src[x<<sx]>>0) & 0xff;
-                fieldBuffer[2*x+1] = (src[x<<sx]>>8) & 0xff;
+                for (UInt x = 0; x < width_file; x++)
+                {
+                  fieldBuffer[2*x  ] = (src[x<<sx]>>0) & 0xff;
+                  fieldBuffer[2*x+1] = (src[x<<sx]>>8) & 0xff;
+                }
               }
             }
           }
@@ -684,6 +1386,10 @@ Bool TVideoIOYuv::read ( TComPicYuv*  pPicYuvUser, TComPicYuv* pPicYuvTrueOrg, c
   {
     return false;
   }
+  if ( m_bY4M && !xReadY4MFrameHeader() )
+  {
+    return false;
+  }
   TComPicYuv *pPicYuv=pPicYuvTrueOrg;
   if (format>=NUM_CHROMA_FORMAT)
   {
@@ -821,6 +1527,11 @@ Bool TVideoIOYuv::write( TComPicYuv* pPicYuvUser, const InputColourSpaceConversi
     dstPicYuv = pPicYuv;
   }
 
+  if (m_bY4M)
+  {
+    retval = xWriteY4MFrameHeader(width444, height444, format, 'p');
+  }
+
   for(UInt comp=0; retval && comp<dstPicYuv->getNumberValidComponents(); comp++)
   {
     const ComponentID compID = ComponentID(comp);
@@ -918,6 +1629,11 @@ Bool TVideoIOYuv::write( TComPicYuv* pPicYuvUserTop, TComPicYuv* pPicYuvUserBott
 
   Bool retval = true;
 
+  if (m_bY4M)
+  {
+    retval = xWriteY4MFrameHeader(dstPicYuvTop->getWidth(COMPONENT_Y) - (confLeft + confRight), 2 * (dstPicYuvTop->getHeight(COMPONENT_Y) - (confTop + confBottom)), format, isTff ? 't' : 'b');
+  }
+
   assert(dstPicYuvTop->getNumberValidComponents() == dstPicYuvBottom->getNumberValidComponents());
   assert(dstPicYuvTop->getChromaFormat()          == dstPicYuvBottom->getChromaFormat()         );
   assert(dstPicYuvTop->getWidth(COMPONENT_Y)      == dstPicYuvBottom->getWidth(COMPONENT_Y)    );
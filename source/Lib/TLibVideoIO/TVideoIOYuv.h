@@ -41,6 +41,7 @@
 #include <stdio.h>
 #include <fstream>
 #include <iostream>
+#include <string>
 #include "TLibCommon/CommonDef.h"
 #include "TLibCommon/TComPicYuv.h"
 
@@ -50,23 +51,81 @@ using namespace std;
 // Class definition
 // ====================================================================================================================
 
-/// YUV file I/O class
+/// buffered stream over stdin or stdout; it cannot seek, so skipping reads the bytes
+class TVideoIOPipeBuf : public std::streambuf
+{
+public:
+  TVideoIOPipeBuf() : m_pFile( NULL ) {}
+
+  Void  attach ( FILE* pFile )                              { m_pFile = pFile; setg( m_buffer, m_buffer, m_buffer ); }
+  FILE* getFile() const                                     { return m_pFile; }
+  /// copies up to n bytes of the input without taking them, returns the bytes copied (fewer at the end of the stream)
+  std::streamsize peek( Char* dst, std::streamsize n );
+
+protected:
+  virtual int_type        underflow();
+  virtual std::streamsize xsgetn   ( char_type* s, std::streamsize n );
+  virtual int_type        overflow ( int_type c );
+  virtual std::streamsize xsputn   ( const char_type* s, std::streamsize n );
+  virtual int             sync     ();
+
+private:
+  FILE* m_pFile;
+  Char  m_buffer[1 << 16];
+};
+
+/** YUV file I/O class. A file name of "-" reads stdin or writes stdout; while stdout carries the
+ *  pictures, the messages printed to it go to stderr. Y4M input is recognized by its header; the
+ *  output is Y4M if the file name ends in ".y4m".
+ */
 class TVideoIOYuv
 {
+public:
+  /// format of a Y4M stream, from its header
+  struct Y4MHeader
+  {
+    Int          width;
+    Int          height;
+    Int          frameRateNum;                              ///< 0 if the header has no frame rate
+    Int          frameRateDen;
+    ChromaFormat chromaFormat;
+    Int          bitDepth;
+  };
+
 private:
-  fstream   m_cHandle;                                      ///< file handle
+  std::filebuf    m_cFileBuf;                               ///< file, when not a pipe
+  TVideoIOPipeBuf m_cPipeBuf;                               ///< stdout
+  iostream  m_cHandle;                                      ///< file handle
   Int       m_fileBitdepth[MAX_NUM_CHANNEL_TYPE]; ///< bitdepth of input/output video file
   Int       m_MSBExtendedBitDepth[MAX_NUM_CHANNEL_TYPE];  ///< bitdepth after addition of MSBs (with value 0)
   Int       m_bitdepthShift[MAX_NUM_CHANNEL_TYPE];  ///< number of bits to increase or decrease image by before/after write/read
 
+  Bool      m_bY4M;                                         ///< the frames are Y4M frames
+  Bool      m_bY4MHeaderPending;                            ///< the Y4M stream header is written with the first frame
+  Int       m_y4mFrameRate[2];                              ///< frame rate written to the Y4M header
+  streampos m_dataStart;                                    ///< position of the first frame of an input file
+
+  Bool  xReadY4MFrameHeader ();
+  Bool  xWriteY4MFrameHeader( UInt width444, UInt height444, ChromaFormat format, Char interlace );
+
 public:
-  TVideoIOYuv()           {}
+  TVideoIOYuv();
   virtual ~TVideoIOYuv()  {}
 
   Void  open  ( Char* pchFile, Bool bWriteMode, const Int fileBitDepth[MAX_NUM_CHANNEL_TYPE], const Int MSBExtendedBitDepth[MAX_NUM_CHANNEL_TYPE], const Int internalBitDepth[MAX_NUM_CHANNEL_TYPE] ); ///< open or create file
   Void  close ();                                           ///< close file
 
   Void skipFrames(UInt numFrames, UInt width, UInt height, ChromaFormat format);
+  /// positions an input file (not a pipe) at a frame counted from its first one; false if it cannot seek
+  Bool seekFrame (UInt frame, UInt width, UInt height, ChromaFormat format);
+
+  /// moves stdout to a new descriptor for the pictures and sends what is printed to stdout to stderr; returns the new stream
+  static FILE* takeStdout();
+  /// true if the file ("-": stdin) is a Y4M stream, whose header is then returned; the file is not kept open
+  static Bool readY4MHeader( const std::string& fileName, Y4MHeader& rHeader );
+  Bool  isY4M () const                                      { return m_bY4M; }
+  /// frame rate of the written Y4M header (default 25:1)
+  Void  setY4MFrameRate( Int num, Int den )                 { m_y4mFrameRate[0] = num; m_y4mFrameRate[1] = den; }
 
   // if fileFormat<NUM_CHROMA_FORMAT, the format of the file is that format specified, else it is the format of the TComPicYuv.
 
@@ -0,0 +1,203 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2015, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TVideoIOYuvPrefetch.cpp
+    \brief    reading of the input YUV file ahead of the encoder
+*/
+
+#include <assert.h>
+#include "TVideoIOYuvPrefetch.h"
+
+// ====================================================================================================================
+// Constructor / destructor
+// ====================================================================================================================
+
+TVideoIOYuvPrefetch::TVideoIOYuvPrefetch()
+: m_pcFile      ( NULL )
+, m_pcFileMutex ( NULL )
+, m_nextFrame   ( 0 )
+, m_picturesLeft( 0 )
+, m_readSlot    ( 0 )
+, m_getSlot     ( 0 )
+, m_numRead     ( 0 )
+, m_numBusy     ( 0 )
+, m_bReaderDone ( true )
+, m_bQuit       ( false )
+{
+}
+
+TVideoIOYuvPrefetch::~TVideoIOYuvPrefetch()
+{
+  stop();
+}
+
+// ====================================================================================================================
+// Public member functions
+// ====================================================================================================================
+
+Void TVideoIOYuvPrefetch::start( TVideoIOYuv* pcFile, Int numPictures, const ReadParams& rcParams,
+                                 const std::vector<TComPicYuv*>& rcOrg, const std::vector<TComPicYuv*>& rcTrueOrg,
+                                 std::mutex* pcFileMutex, UInt firstFrame )
+{
+  assert( !rcOrg.empty() && rcOrg.size() == rcTrueOrg.size() );
+  stop();
+
+  m_pcFile       = pcFile;
+  m_pcFileMutex  = pcFileMutex;
+  m_nextFrame    = firstFrame;
+  m_params       = rcParams;
+  m_org          = rcOrg;
+  m_trueOrg      = rcTrueOrg;
+  m_eof.assign( rcOrg.size(), false );
+  m_picturesLeft = numPictures;
+  m_readSlot     = 0;
+  m_getSlot      = 0;
+  m_numRead      = 0;
+  m_numBusy      = 0;
+  m_bReaderDone  = numPictures <= 0;
+  m_bQuit        = false;
+
+  if( m_org.size() > 1 && !m_bReaderDone )
+  {
+    m_reader = std::thread( &TVideoIOYuvPrefetch::xReader, this );
+  }
+}
+
+Void TVideoIOYuvPrefetch::stop()
+{
+  if( m_reader.joinable() )
+  {
+    {
+      std::lock_guard<std::mutex> lock( m_mutex );
+      m_bQuit = true;
+    }
+    m_freed.notify_all();
+    m_reader.join();
+  }
+  m_pcFile = NULL;
+}
+
+Bool TVideoIOYuvPrefetch::getPicture( TComPicYuv*& rpcPicYuvOrg, TComPicYuv*& rpcPicYuvTrueOrg )
+{
+  const Int slot = m_getSlot;
+  Bool bEof;
+  if( m_reader.joinable() )
+  {
+    std::unique_lock<std::mutex> lock( m_mutex );
+    m_read.wait( lock, [this]{ return m_numRead > 0 || m_bReaderDone; } );
+    assert( m_numRead > 0 );                                ///< no more pictures are asked for than start() allowed
+    m_numRead--;
+    bEof = m_eof[slot] != 0;
+  }
+  else
+  {
+    assert( m_picturesLeft > 0 );
+    m_picturesLeft--;
+    bEof = xRead( slot );
+  }
+  rpcPicYuvOrg     = m_org[slot];
+  rpcPicYuvTrueOrg = m_trueOrg[slot];
+  return !bEof;
+}
+
+Void TVideoIOYuvPrefetch::releasePicture()
+{
+  {
+    std::lock_guard<std::mutex> lock( m_mutex );
+    m_getSlot = ( m_getSlot + 1 ) % Int( m_org.size() );
+    if( m_reader.joinable() )
+    {
+      m_numBusy--;
+    }
+  }
+  m_freed.notify_one();
+}
+
+// ====================================================================================================================
+// Private member functions
+// ====================================================================================================================
+
+Bool TVideoIOYuvPrefetch::xRead( Int slot )
+{
+  if( m_pcFileMutex )
+  {
+    std::lock_guard<std::mutex> lock( *m_pcFileMutex );
+    m_pcFile->seekFrame( m_nextFrame, m_params.skipWidth, m_params.skipHeight, m_params.fileFormat );
+    m_pcFile->read( m_org[slot], m_trueOrg[slot], m_params.ipCSC, m_params.aiPad, m_params.fileFormat, m_params.bClipToRec709 );
+    m_nextFrame += 1 + m_params.skipFrames;
+    return m_pcFile->isEof();
+  }
+
+  m_pcFile->read( m_org[slot], m_trueOrg[slot], m_params.ipCSC, m_params.aiPad, m_params.fileFormat, m_params.bClipToRec709 );
+  const Bool bEof = m_pcFile->isEof();
+  if( !bEof && m_params.skipFrames )
+  {
+    m_pcFile->skipFrames( m_params.skipFrames, m_params.skipWidth, m_params.skipHeight, m_params.fileFormat );
+  }
+  return bEof;
+}
+
+Void TVideoIOYuvPrefetch::xReader()
+{
+  const Int numSlots = Int( m_org.size() );
+  for( ;; )
+  {
+    Int slot;
+    {
+      std::unique_lock<std::mutex> lock( m_mutex );
+      m_freed.wait( lock, [this, numSlots]{ return m_numBusy < numSlots || m_bQuit; } );
+      if( m_bQuit )
+      {
+        break;
+      }
+      slot = m_readSlot;
+    }
+
+    // the slot is neither read nor held, so it is written without the lock
+    const Bool bEof = xRead( slot );
+
+    {
+      std::lock_guard<std::mutex> lock( m_mutex );
+      m_eof[slot] = bEof;
+      m_readSlot  = ( m_readSlot + 1 ) % numSlots;
+      m_numRead++;
+      m_numBusy++;
+      m_bReaderDone = bEof || --m_picturesLeft == 0;
+    }
+    m_read.notify_one();
+    if( m_bReaderDone )
+    {
+      break;
+    }
+  }
+}
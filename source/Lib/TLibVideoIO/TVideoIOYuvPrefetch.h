@@ -0,0 +1,118 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2015, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TVideoIOYuvPrefetch.h
+    \brief    reading of the input YUV file ahead of the encoder (header)
+*/
+
+#ifndef __TVIDEOIOYUVPREFETCH__
+#define __TVIDEOIOYUVPREFETCH__
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "TVideoIOYuv.h"
+
+// ====================================================================================================================
+// Class definition
+// ====================================================================================================================
+
+/** Reads the pictures of a TVideoIOYuv on a thread of its own, ahead of the caller, into a ring of
+ *  picture pairs (original and true original) created by the caller. With n pairs the reader is at
+ *  most n-1 pictures ahead of the one the caller holds, so the memory is bounded by the ring; with
+ *  one pair the pictures are read in getPicture() on the calling thread. The pictures, the end of
+ *  file and the frames skipped in between are the same as with the reads in file order.
+ *  A file shared with other readers is read under their common mutex, each read seeking to its frame.
+ */
+class TVideoIOYuvPrefetch
+{
+public:
+  /// parameters of TVideoIOYuv::read and skipFrames
+  struct ReadParams
+  {
+    InputColourSpaceConversion ipCSC;
+    Int                        aiPad[2];
+    ChromaFormat               fileFormat;
+    Bool                       bClipToRec709;
+    UInt                       skipFrames;                  ///< frames skipped after each picture (temporal subsampling)
+    UInt                       skipWidth;
+    UInt                       skipHeight;
+  };
+
+  TVideoIOYuvPrefetch();
+  ~TVideoIOYuvPrefetch();
+
+  /** reads up to numPictures pictures of pcFile into the pairs; the thread starts with more than one pair.
+   *  With pcFileMutex the file is shared: the reads start at frame firstFrame of the file and seek to each frame.
+   */
+  Void start         ( TVideoIOYuv* pcFile, Int numPictures, const ReadParams& rcParams,
+                       const std::vector<TComPicYuv*>& rcOrg, const std::vector<TComPicYuv*>& rcTrueOrg,
+                       std::mutex* pcFileMutex = NULL, UInt firstFrame = 0 );
+  /// waits for the reader and leaves the file to the caller
+  Void stop          ();
+
+  /** The next picture in file order, held until releasePicture(). Returns false if its read hit the
+   *  end of the file, like TVideoIOYuv::isEof() after the read.
+   */
+  Bool getPicture    ( TComPicYuv*& rpcPicYuvOrg, TComPicYuv*& rpcPicYuvTrueOrg );
+  /// hands the picture of the last getPicture() back to the reader
+  Void releasePicture();
+
+private:
+  Bool xRead         ( Int slot );                          ///< reads one picture into the pair of the slot, returns the end of file
+  Void xReader       ();
+
+  TVideoIOYuv*              m_pcFile;
+  std::mutex*               m_pcFileMutex;                  ///< lock of a shared file, NULL if the file is read by this reader only
+  UInt                      m_nextFrame;                    ///< frame of a shared file read next
+  ReadParams                m_params;
+  std::vector<TComPicYuv*>  m_org;
+  std::vector<TComPicYuv*>  m_trueOrg;
+  std::vector<Int>          m_eof;                          ///< end of file was hit by the read of the slot
+
+  Int                       m_picturesLeft;                 ///< pictures still to be read
+  Int                       m_readSlot;                     ///< slot of the next read
+  Int                       m_getSlot;                      ///< slot of the next getPicture()
+  Int                       m_numRead;                      ///< slots read and not yet taken
+  Int                       m_numBusy;                      ///< slots read or held by the caller
+  Bool                      m_bReaderDone;
+  Bool                      m_bQuit;
+
+  std::thread               m_reader;
+  std::mutex                m_mutex;
+  std::condition_variable   m_read;                         ///< a slot was read
+  std::condition_variable   m_freed;                        ///< a slot was released
+};
+
+#endif // __TVIDEOIOYUVPREFETCH__
@@ -0,0 +1,263 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2015, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TVideoIOYuvWriter.cpp
+    \brief    writing of the output pictures and bitstream on a writer thread
+*/
+
+#include <assert.h>
+#include <string.h>
+#include "TVideoIOYuvWriter.h"
+
+// ====================================================================================================================
+// Constructor / destructor
+// ====================================================================================================================
+
+TVideoIOYuvWriter::TVideoIOYuvWriter()
+: m_numJobs( 0 )
+, m_bBusy  ( false )
+, m_bQuit  ( false )
+{
+}
+
+TVideoIOYuvWriter::~TVideoIOYuvWriter()
+{
+  stop();
+}
+
+// ====================================================================================================================
+// Public member functions
+// ====================================================================================================================
+
+Void TVideoIOYuvWriter::start( Int numJobs )
+{
+  stop();
+
+  m_numJobs = numJobs;
+  m_bQuit   = false;
+  if( m_numJobs > 0 )
+  {
+    m_writer = std::thread( &TVideoIOYuvWriter::xWriter, this );
+  }
+}
+
+Void TVideoIOYuvWriter::stop()
+{
+  if( m_writer.joinable() )
+  {
+    flush();
+    {
+      std::unique_lock<std::mutex> lock( m_mutex );
+      m_bQuit = true;
+    }
+    m_queued.notify_all();
+    m_writer.join();
+  }
+  for( size_t i = 0; i < m_pool.size(); i++ )
+  {
+    m_pool[i]->destroy();
+    delete m_pool[i];
+  }
+  m_pool.clear();
+  m_numJobs = 0;
+}
+
+Void TVideoIOYuvWriter::flush()
+{
+  std::unique_lock<std::mutex> lock( m_mutex );
+  while( !m_queue.empty() || m_bBusy )
+  {
+    m_done.wait( lock );
+  }
+}
+
+Void TVideoIOYuvWriter::write( TVideoIOYuv* pcFile, const TComPicYuv* pcPicYuv, const WriteParams& rcParams )
+{
+  Job cJob;
+  cJob.pcFile   = pcFile;
+  cJob.pcPic[0] = m_numJobs > 0 ? xGetBuffer( pcPicYuv ) : const_cast<TComPicYuv*>( pcPicYuv );
+  cJob.pcPic[1] = NULL;
+  cJob.params   = rcParams;
+  cJob.isTff    = false;
+  xPush( cJob );
+}
+
+Void TVideoIOYuvWriter::write( TVideoIOYuv* pcFile, const TComPicYuv* pcPicYuvTop, const TComPicYuv* pcPicYuvBottom,
+                               const WriteParams& rcParams, Bool isTff )
+{
+  Job cJob;
+  cJob.pcFile   = pcFile;
+  cJob.pcPic[0] = m_numJobs > 0 ? xGetBuffer( pcPicYuvTop )    : const_cast<TComPicYuv*>( pcPicYuvTop );
+  cJob.pcPic[1] = m_numJobs > 0 ? xGetBuffer( pcPicYuvBottom ) : const_cast<TComPicYuv*>( pcPicYuvBottom );
+  cJob.params   = rcParams;
+  cJob.isTff    = isTff;
+  xPush( cJob );
+}
+
+Void TVideoIOYuvWriter::post( const std::function<Void()>& task )
+{
+  Job cJob;
+  cJob.pcFile   = NULL;
+  cJob.pcPic[0] = NULL;
+  cJob.pcPic[1] = NULL;
+  cJob.isTff    = false;
+  cJob.task     = task;
+  xPush( cJob );
+}
+
+// ====================================================================================================================
+// Private member functions
+// ====================================================================================================================
+
+TComPicYuv* TVideoIOYuvWriter::xGetBuffer( const TComPicYuv* pcSrc )
+{
+  TComPicYuv* pcDst = NULL;
+  {
+    std::unique_lock<std::mutex> lock( m_mutex );
+    if( !m_pool.empty() )
+    {
+      pcDst = m_pool.back();
+      m_pool.pop_back();
+    }
+  }
+
+  // the buffer has the layout of the source, margins included, so TVideoIOYuv::write sees the same strides
+  const Int marginX = pcSrc->getMarginX( COMPONENT_Y ) - 16;
+  const Int marginY = pcSrc->getMarginY( COMPONENT_Y ) - 16;
+  if( pcDst && ( pcDst->getWidth( COMPONENT_Y ) != pcSrc->getWidth( COMPONENT_Y ) || pcDst->getHeight( COMPONENT_Y ) != pcSrc->getHeight( COMPONENT_Y ) ||
+                 pcDst->getChromaFormat() != pcSrc->getChromaFormat() ||
+                 pcDst->getMarginX( COMPONENT_Y ) != pcSrc->getMarginX( COMPONENT_Y ) || pcDst->getMarginY( COMPONENT_Y ) != pcSrc->getMarginY( COMPONENT_Y ) ) )
+  {
+    pcDst->destroy();
+    delete pcDst;
+    pcDst = NULL;
+  }
+  if( !pcDst )
+  {
+    pcDst = new TComPicYuv;
+    if( marginX > 0 && marginY > 0 )
+    {
+      pcDst->create( pcSrc->getWidth( COMPONENT_Y ), pcSrc->getHeight( COMPONENT_Y ), pcSrc->getChromaFormat(), marginX, marginY, 0, true );
+    }
+    else
+    {
+      pcDst->create( pcSrc->getWidth( COMPONENT_Y ), pcSrc->getHeight( COMPONENT_Y ), pcSrc->getChromaFormat(), pcSrc->getWidth( COMPONENT_Y ), pcSrc->getHeight( COMPONENT_Y ), 0, false );
+    }
+  }
+
+  for( UInt comp = 0; comp < pcSrc->getNumberValidComponents(); comp++ )
+  {
+    const ComponentID compID  = ComponentID( comp );
+    const Pel*        pSrc    = pcSrc->getAddr( compID );
+    Pel*              pDst    = pcDst->getAddr( compID );
+    const Int         iStride = pcSrc->getStride( compID );
+    const size_t      rowSize = pcSrc->getWidth( compID ) * sizeof( Pel );
+    for( Int y = 0; y < pcSrc->getHeight( compID ); y++, pSrc += iStride, pDst += iStride )
+    {
+      memcpy( pDst, pSrc, rowSize );
+    }
+  }
+  return pcDst;
+}
+
+Void TVideoIOYuvWriter::xPush( const Job& rcJob )
+{
+  if( m_numJobs == 0 )
+  {
+    xRun( rcJob );
+    return;
+  }
+  {
+    std::unique_lock<std::mutex> lock( m_mutex );
+    while( Int( m_queue.size() ) >= m_numJobs )
+    {
+      m_done.wait( lock );
+    }
+    m_queue.push_back( rcJob );
+  }
+  m_queued.notify_one();
+}
+
+Void TVideoIOYuvWriter::xRun( const Job& rcJob )
+{
+  if( rcJob.task )
+  {
+    rcJob.task();
+  }
+  else if( rcJob.pcPic[1] )
+  {
+    rcJob.pcFile->write( rcJob.pcPic[0], rcJob.pcPic[1], rcJob.params.ipCSC, rcJob.params.confLeft, rcJob.params.confRight,
+                         rcJob.params.confTop, rcJob.params.confBottom, rcJob.params.format, rcJob.isTff, rcJob.params.bClipToRec709 );
+  }
+  else
+  {
+    rcJob.pcFile->write( rcJob.pcPic[0], rcJob.params.ipCSC, rcJob.params.confLeft, rcJob.params.confRight,
+                         rcJob.params.confTop, rcJob.params.confBottom, rcJob.params.format, rcJob.params.bClipToRec709 );
+  }
+
+  if( m_numJobs > 0 && rcJob.pcPic[0] )
+  {
+    std::unique_lock<std::mutex> lock( m_mutex );
+    m_pool.push_back( rcJob.pcPic[0] );
+    if( rcJob.pcPic[1] )
+    {
+      m_pool.push_back( rcJob.pcPic[1] );
+    }
+  }
+}
+
+Void TVideoIOYuvWriter::xWriter()
+{
+  std::unique_lock<std::mutex> lock( m_mutex );
+  for( ;; )
+  {
+    while( m_queue.empty() && !m_bQuit )
+    {
+      m_queued.wait( lock );
+    }
+    if( m_queue.empty() )
+    {
+      break;
+    }
+    Job cJob = m_queue.front();
+    m_queue.pop_front();
+    m_bBusy = true;
+
+    lock.unlock();
+    xRun( cJob );
+    lock.lock();
+
+    m_bBusy = false;
+    m_done.notify_all();
+  }
+}
@@ -0,0 +1,119 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2015, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TVideoIOYuvWriter.h
+    \brief    writing of the output pictures and bitstream on a writer thread (header)
+*/
+
+#ifndef __TVIDEOIOYUVWRITER__
+#define __TVIDEOIOYUVWRITER__
+
+#include <deque>
+#include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "TVideoIOYuv.h"
+
+// ====================================================================================================================
+// Class definition
+// ====================================================================================================================
+
+/** Writes the output of the coder on a thread of its own. A picture is copied into a buffer of the
+ *  writer's pool and queued, so the coder can reuse its picture at once; the buffer goes back to the
+ *  pool once written. Other output (the access units of the encoder) is queued as tasks and runs in
+ *  order with the pictures. At most numJobs writes are queued: a further one waits for the writer.
+ *  With numJobs 0 everything is written on the calling thread, as without the writer.
+ */
+class TVideoIOYuvWriter
+{
+public:
+  /// parameters of TVideoIOYuv::write
+  struct WriteParams
+  {
+    InputColourSpaceConversion ipCSC;
+    Int                        confLeft;
+    Int                        confRight;
+    Int                        confTop;
+    Int                        confBottom;
+    ChromaFormat               format;
+    Bool                       bClipToRec709;
+  };
+
+  TVideoIOYuvWriter();
+  ~TVideoIOYuvWriter();
+
+  /// starts the writer thread if numJobs is not 0
+  Void start         ( Int numJobs );
+  /// writes all the queued output, stops the thread and frees the pool
+  Void stop          ();
+  /// returns once all the queued output is written
+  Void flush         ();
+
+  /// writes a frame to pcFile
+  Void write         ( TVideoIOYuv* pcFile, const TComPicYuv* pcPicYuv, const WriteParams& rcParams );
+  /// writes the two fields of a frame to pcFile
+  Void write         ( TVideoIOYuv* pcFile, const TComPicYuv* pcPicYuvTop, const TComPicYuv* pcPicYuvBottom,
+                       const WriteParams& rcParams, Bool isTff );
+  /// runs a task on the writer thread, after the output queued before it
+  Void post          ( const std::function<Void()>& task );
+
+private:
+  struct Job
+  {
+    TVideoIOYuv*          pcFile;
+    TComPicYuv*           pcPic[2];                         ///< frame, or top and bottom field
+    WriteParams           params;
+    Bool                  isTff;
+    std::function<Void()> task;
+  };
+
+  TComPicYuv* xGetBuffer ( const TComPicYuv* pcSrc );       ///< a pool buffer holding a copy of pcSrc
+  Void        xPush      ( const Job& rcJob );
+  Void        xRun       ( const Job& rcJob );              ///< writes the job and returns its buffers to the pool
+  Void        xWriter    ();
+
+  Int                       m_numJobs;                      ///< queue depth, 0: synchronous
+  std::deque<Job>           m_queue;
+  std::vector<TComPicYuv*>  m_pool;                         ///< free buffers
+  Bool                      m_bBusy;                        ///< the writer is running a job
+  Bool                      m_bQuit;
+
+  std::thread               m_writer;
+  std::mutex                m_mutex;
+  std::condition_variable   m_queued;                       ///< a job was queued
+  std::condition_variable   m_done;                         ///< a job was written
+};
+
+#endif // __TVIDEOIOYUVWRITER__